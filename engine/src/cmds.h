@@ -905,6 +905,7 @@ class MCAccept : public MCStatement
 	Boolean datagram;
 	Boolean secure;
 	Boolean secureverify;
+	Boolean http;
 	MCExpression *certificate;
 public:
 	MCAccept()
@@ -912,6 +913,7 @@ public:
 		port = message = NULL;
 		datagram = False;
 		secure = False;
+		http = False;
 		certificate = NULL;
 		secureverify = False;
 	}
@@ -1325,6 +1327,7 @@ class MCExport : public MCStatement
 	MCChunk *image;
 	MCChunk *dest;
 	MCExpression *size;
+	MCExpression *objects;
 	bool with_effects : 1;
     // MERG-2014-07-11: metadata array
     MCExpression *metadata;
@@ -1345,6 +1348,7 @@ public:
 		palette_color_count = NULL;
 		with_effects = false;
 		size = NULL;
+		objects = NULL;
         // MERG-2014-07-11: metadata array
         metadata = NULL;
 	}
@@ -69,6 +69,9 @@ Parse_stat MCAccept::parse(MCScriptPoint &sp)
 	else if (sp.skip_token(SP_ACCEPT, TT_UNDEFINED, AC_DATAGRAM) == PS_NORMAL)
 		datagram = True;
 	
+	if (!datagram && sp.skip_token(SP_ACCEPT, TT_UNDEFINED, AC_HTTP) == PS_NORMAL)
+		http = True;
+	
 	Parse_stat t_stat = PS_NORMAL;
 	
 	if (PS_NORMAL == t_stat)
@@ -130,6 +133,10 @@ void MCAccept::exec_ctxt(MCExecContext &ctxt)
     
     if (datagram)
 		MCNetworkExecAcceptDatagramConnectionsOnPort(ctxt, uint16_t(t_port), *t_message);
+	else if (http && secure)
+		MCNetworkExecAcceptSecureHttpConnectionsOnPort(ctxt, uint16_t(t_port), *t_message, secureverify == True);
+	else if (http)
+		MCNetworkExecAcceptHttpConnectionsOnPort(ctxt, uint16_t(t_port), *t_message);
 	else if (secure)
 		MCNetworkExecAcceptSecureConnectionsOnPort(ctxt, uint16_t(t_port), *t_message, secureverify == True);
 	else
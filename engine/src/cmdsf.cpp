@@ -407,6 +407,7 @@ MCExport::~MCExport()
 	delete palette_color_count;
 	delete palette_color_list;
 	delete size;
+	delete objects;
     // MERG-2014-07-11: metadata array
     delete metadata;
 }
@@ -527,6 +528,26 @@ Parse_stat MCExport::parse(MCScriptPoint &sp)
 			}
 		}
 	}
+	else if (sformat == EX_SNAPSHOTS)
+	{
+		// export snapshots from <objects> [at size <size>] to files <files>
+		if (sp.skip_token(SP_FACTOR, TT_FROM) != PS_NORMAL ||
+			sp.parseexp(False, True, &objects) != PS_NORMAL)
+		{
+			MCperror->add(PE_EXPORT_BADOBJECTS, sp);
+			return PS_ERROR;
+		}
+
+		if (sp . skip_token(SP_FACTOR, TT_PREP, PT_AT) == PS_NORMAL)
+		{
+			if (sp . skip_token(SP_FACTOR, TT_PROPERTY, P_SIZE) != PS_NORMAL ||
+				sp . parseexp(False, True, &size) != PS_NORMAL)
+			{
+				MCperror -> add(PE_IMPORT_BADFILENAME, sp);
+				return PS_ERROR;
+			}
+		}
+	}
     
     // MERG-2014-07-11: [[ ImageMetadata ]] metadata array
     bool t_is_image;
@@ -561,7 +582,20 @@ Parse_stat MCExport::parse(MCScriptPoint &sp)
     }
     else
     {
-        if (sp.skip_token(SP_OPEN, TT_UNDEFINED) == PS_NORMAL)
+        if (sformat == EX_SNAPSHOTS)
+        {
+            if (sp.skip_token(SP_FACTOR, TT_FUNCTION, F_FILES) != PS_NORMAL)
+            {
+                MCperror->add(PE_EXPORT_NOFILE, sp);
+                return PS_ERROR;
+            }
+            if (sp.parseexp(False, True, &fname) != PS_NORMAL)
+            {
+                MCperror->add(PE_EXPORT_BADFILENAME, sp);
+                return PS_ERROR;
+            }
+        }
+        else if (sp.skip_token(SP_OPEN, TT_UNDEFINED) == PS_NORMAL)
         {
             if (sp.parseexp(False, True, &fname) != PS_NORMAL)
             {
@@ -579,7 +613,8 @@ Parse_stat MCExport::parse(MCScriptPoint &sp)
             }
         }
 
-        if (sp.skip_token(SP_REPEAT, TT_UNDEFINED, RF_WITH) == PS_NORMAL)
+        if (sformat != EX_SNAPSHOTS &&
+            sp.skip_token(SP_REPEAT, TT_UNDEFINED, RF_WITH) == PS_NORMAL)
         {
             if (sp.skip_token(SP_EXPORT, TT_UNDEFINED) != PS_NORMAL)
             {
@@ -795,7 +830,76 @@ void MCExport::exec_ctxt(MCExecContext &ctxt)
     
     bool t_success;
     t_success = true;
-    if (sformat == EX_SNAPSHOT)
+    if (sformat == EX_SNAPSHOTS)
+    {
+        MCPoint t_size;
+        MCPoint *t_size_ptr;
+        t_size_ptr = &t_size;
+        t_success = ctxt . EvalOptionalExprAsPoint(size, nil, EE_EXPORT_NOSELECTED, t_size_ptr);
+
+        MCAutoStringRef t_objects;
+        if (t_success)
+            t_success = ctxt . EvalExprAsStringRef(objects, EE_EXPORT_BADOBJECTS, &t_objects);
+
+        // The objects and the files to export them to are given one per line.
+        MCAutoArrayRef t_object_lines, t_file_lines;
+        if (t_success &&
+            (!MCStringSplit(*t_objects, kMCLineEndString, nil, kMCStringOptionCompareExact, &t_object_lines) ||
+             !MCStringSplit(*t_filename, kMCLineEndString, nil, kMCStringOptionCompareExact, &t_file_lines)))
+        {
+            ctxt . LegacyThrow(EE_NO_MEMORY);
+            t_success = false;
+        }
+
+        uindex_t t_count;
+        t_count = 0;
+        if (t_success)
+        {
+            t_count = MCArrayGetCount(*t_object_lines);
+            if (MCArrayGetCount(*t_file_lines) != t_count)
+            {
+                ctxt . LegacyThrow(EE_EXPORT_FILECOUNT);
+                t_success = false;
+            }
+        }
+
+        MCObjectHandle *t_targets = nil;
+        MCStringRef *t_filenames = nil;
+        if (t_success &&
+            (!MCMemoryNewArrayInit(t_count, t_targets) ||
+             !MCMemoryNewArray(t_count, t_filenames)))
+        {
+            ctxt . LegacyThrow(EE_NO_MEMORY);
+            t_success = false;
+        }
+
+        for (uindex_t i = 0; t_success && i < t_count; i++)
+        {
+            MCValueRef t_object_line, t_file_line;
+            /* UNCHECKED */ MCArrayFetchValueAtIndex(*t_object_lines, i + 1, t_object_line);
+            /* UNCHECKED */ MCArrayFetchValueAtIndex(*t_file_lines, i + 1, t_file_line);
+
+            MCObjectPtr t_object;
+            if (!MCInterfaceTryToResolveObject(ctxt, (MCStringRef)t_object_line, t_object))
+            {
+                ctxt . LegacyThrow(EE_EXPORT_BADOBJECTS, t_object_line);
+                t_success = false;
+            }
+            else
+            {
+                t_targets[i] = t_object . object;
+                t_filenames[i] = (MCStringRef)t_file_line;
+            }
+        }
+
+        if (t_success)
+            MCInterfaceExecExportSnapshotsOfObjectsToFiles(ctxt, t_targets, t_filenames, t_count, t_size_ptr, format, t_settings_ptr, &t_metadata);
+
+        if (t_targets != nil)
+            MCMemoryDeleteArray(t_targets, t_count);
+        MCMemoryDeleteArray(t_filenames);
+    }
+    else if (sformat == EX_SNAPSHOT)
     {
         MCRectangle *t_rect_ptr;
         MCRectangle t_rect;
@@ -66,6 +66,7 @@ MCPropertyInfo MCControl::kProperties[] =
 	DEFINE_RW_OBJ_PROPERTY(P_TOOL_TIP, String, MCControl, ToolTip)
 	DEFINE_RW_OBJ_PROPERTY(P_UNICODE_TOOL_TIP, BinaryString, MCControl, UnicodeToolTip)
     DEFINE_RW_OBJ_PROPERTY(P_LAYER_CLIP_RECT, OptionalRectangle, MCControl, LayerClipRect)
+    DEFINE_RW_OBJ_PROPERTY(P_LAYER_CACHE, Bool, MCControl, LayerCache)
 	DEFINE_RW_OBJ_NON_EFFECTIVE_ENUM_PROPERTY(P_LAYER_MODE, InterfaceLayerMode, MCControl, LayerMode)
 	DEFINE_RO_OBJ_EFFECTIVE_ENUM_PROPERTY(P_LAYER_MODE, InterfaceLayerMode, MCControl, LayerMode)
     
@@ -104,6 +105,8 @@ MCControl::MCControl()
 	m_layer_mode_hint = kMCLayerModeHintStatic;
     m_layer_has_clip_rect = false;
     m_layer_clip_rect = kMCEmptyRectangle;
+    m_layer_use_cache = false;
+    m_layer_cache = nil;
 }
 
 MCControl::MCControl(const MCControl &cref) : MCObject(cref)
@@ -128,6 +131,8 @@ MCControl::MCControl(const MCControl &cref) : MCObject(cref)
 	m_layer_mode_hint = cref . m_layer_mode_hint;
     m_layer_has_clip_rect = cref.m_layer_has_clip_rect;
     m_layer_clip_rect = cref.m_layer_clip_rect;
+    m_layer_use_cache = cref.m_layer_use_cache;
+    m_layer_cache = nil;
 }
 
 MCControl::~MCControl()
@@ -139,6 +144,8 @@ MCControl::~MCControl()
 
 	// MW-2009-06-11: [[ Bitmap Effects ]] Destroy the bitmap effects
 	MCBitmapEffectsFinalize(m_bitmap_effects);
+
+	layer_discardcache();
 }
 
 void MCControl::open()
@@ -165,6 +172,11 @@ void MCControl::close()
     {
         focused = nullptr;
     }
+
+	// Cached renderings are only kept while the control is open.
+	if (opened == 1)
+		layer_discardcache();
+
 	MCObject::close();
 }
 
@@ -841,7 +853,8 @@ void MCControl::redraw(MCDC *dc, const MCRectangle &dirty)
         
 		// MW-2011-09-06: [[ Redraw ] Make sure we draw the control normally (not
 		//   as a sprite).
-		draw(dc, trect, false, false);
+		if (!m_layer_use_cache || !layer_drawcached(dc))
+			draw(dc, trect, false, false);
 		
 		dc->restore();
 	}
@@ -653,6 +653,15 @@ public:
         
         return buf.st_size;
     }
+
+    virtual bool IsRegularFile(void)
+    {
+        struct stat64 buf;
+        if (fstat64(fileno(m_fptr), &buf))
+            return false;
+
+        return S_ISREG(buf.st_mode);
+    }
     
     virtual bool TakeBuffer(void*& r_buffer, size_t& r_length)
     {
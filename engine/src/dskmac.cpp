@@ -1651,6 +1651,14 @@ public:
 			return 0;
 		return t_info . st_size;
 	}
+
+	virtual bool IsRegularFile(void)
+	{
+		struct stat t_info;
+		if (fstat(fileno(m_stream), &t_info) != 0)
+			return false;
+		return S_ISREG(t_info . st_mode);
+	}
 	
 	virtual void *GetFilePointer(void)
 	{
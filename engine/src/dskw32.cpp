@@ -1163,6 +1163,12 @@ struct MCMemoryMappedFileHandle: public MCMemoryFileHandle
 		MCMemoryFileHandle::Close();
 	}
 
+	// Only regular files are mapped into memory.
+	virtual bool IsRegularFile(void)
+	{
+		return true;
+	}
+
 private:
 	MCWinSysHandle m_handle;
 };
@@ -1456,6 +1462,13 @@ struct MCStdioFileHandle: public MCSystemFileHandle
 
 		return 0;
 	}
+
+	virtual bool IsRegularFile(void)
+	{
+		// Pipes and character devices (such as COM ports and the console)
+		// don't report FILE_TYPE_DISK.
+		return !m_is_pipe && GetFileType(m_handle) == FILE_TYPE_DISK;
+	}
     
     virtual bool TakeBuffer(void*& r_buffer, size_t& r_length)
 	{
@@ -777,10 +777,736 @@ void MCArraysExecDifference(MCExecContext& ctxt, MCValueRef p_dst, MCValueRef p_
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+
+// The indexed array encoding used by arrayEncode for the version "indexed". It
+// is written into, and decoded from, a single contiguous buffer. All integers
+// are little-endian:
+//
+//     u8  kMCEncodedValueTypeIndexedArray
+//     u32 key count, then for each key: u32 byte length, UTF-8 bytes
+//     value
+//
+// Each value is a tag byte followed by the payload for that tag. Strings are
+// stored as raw chars when they are ASCII so that they decode with a single
+// copy. Arrays store their element count and the byte size of their elements -
+// allowing a reader to skip a nested array without decoding it - and refer to
+// keys by index into the key table, so that each distinct key is only created
+// once however often it is used.
+
+enum MCIndexedEncodingTag
+{
+    kMCIndexedEncodingTagNull,
+    kMCIndexedEncodingTagFalse,
+    kMCIndexedEncodingTagTrue,
+    kMCIndexedEncodingTagInteger,
+    kMCIndexedEncodingTagReal,
+    kMCIndexedEncodingTagEmptyName,
+    kMCIndexedEncodingTagName,
+    kMCIndexedEncodingTagEmptyString,
+    kMCIndexedEncodingTagNativeString,
+    kMCIndexedEncodingTagUTF8String,
+    kMCIndexedEncodingTagEmptyData,
+    kMCIndexedEncodingTagData,
+    kMCIndexedEncodingTagEmptyArray,
+    kMCIndexedEncodingTagSequence,
+    kMCIndexedEncodingTagMap,
+    kMCIndexedEncodingTagEmptyList,
+    kMCIndexedEncodingTagList,
+};
+
+// The maximum nesting of arrays and lists accepted by the decoder.
+#define kMCIndexedEncodingMaxDepth 1024
+
+static bool MCIndexedEncodingIsASCII(const char_t *p_chars, uindex_t p_length)
+{
+    for(uindex_t i = 0; i < p_length; i++)
+        if (p_chars[i] >= 0x80)
+            return false;
+    return true;
+}
+
+class MCIndexedArrayEncoder
+{
+public:
+    MCIndexedArrayEncoder(void)
+        : m_bytes(nil), m_length(0), m_capacity(0),
+          m_keys(nil), m_key_count(0), m_key_capacity(0), m_key_slots(nil), m_key_slot_count(0)
+    {
+    }
+    
+    ~MCIndexedArrayEncoder(void)
+    {
+        MCMemoryDeallocate(m_bytes);
+        for(uindex_t i = 0; i < m_key_count; i++)
+            MCValueRelease(m_keys[i]);
+        MCMemoryDeleteArray(m_keys);
+        MCMemoryDeleteArray(m_key_slots);
+    }
+    
+    // Encode p_array, returning the complete encoding.
+    bool Encode(MCArrayRef p_array, MCDataRef& r_encoding)
+    {
+        // The values are written first, as they determine the key table.
+        if (!WriteValue(p_array))
+            return false;
+        
+        size_t t_size;
+        t_size = 1 + 4;
+        MCAutoArray<char *> t_key_chars;
+        MCAutoArray<uindex_t> t_key_lengths;
+        if (!t_key_chars . New(m_key_count) ||
+            !t_key_lengths . New(m_key_count))
+            return false;
+        
+        bool t_success;
+        t_success = true;
+        for(uindex_t i = 0; t_success && i < m_key_count; i++)
+        {
+            t_success = MCStringConvertToUTF8(MCNameGetString(m_keys[i]), t_key_chars[i], t_key_lengths[i]);
+            if (t_success)
+                t_size += 4 + t_key_lengths[i];
+        }
+        
+        t_size += m_length;
+        
+        byte_t *t_bytes;
+        t_bytes = nil;
+        if (t_success && t_size > UINDEX_MAX)
+            t_success = false;
+        if (t_success)
+            t_success = MCMemoryAllocate(t_size, t_bytes);
+        
+        if (t_success)
+        {
+            byte_t *t_ptr;
+            t_ptr = t_bytes;
+            *t_ptr++ = kMCEncodedValueTypeIndexedArray;
+            t_ptr = Store32(t_ptr, m_key_count);
+            for(uindex_t i = 0; i < m_key_count; i++)
+            {
+                t_ptr = Store32(t_ptr, t_key_lengths[i]);
+                MCMemoryCopy(t_ptr, t_key_chars[i], t_key_lengths[i]);
+                t_ptr += t_key_lengths[i];
+            }
+            MCMemoryCopy(t_ptr, m_bytes, m_length);
+            
+            t_success = MCDataCreateWithBytesAndRelease(t_bytes, (uindex_t)t_size, r_encoding);
+            if (!t_success)
+                MCMemoryDeallocate(t_bytes);
+        }
+        
+        for(uindex_t i = 0; i < m_key_count; i++)
+            MCMemoryDeleteArray(t_key_chars[i]);
+        
+        return t_success;
+    }
+    
+private:
+    static byte_t *Store32(byte_t *p_ptr, uint32_t p_value)
+    {
+        p_ptr[0] = (byte_t)p_value;
+        p_ptr[1] = (byte_t)(p_value >> 8);
+        p_ptr[2] = (byte_t)(p_value >> 16);
+        p_ptr[3] = (byte_t)(p_value >> 24);
+        return p_ptr + 4;
+    }
+    
+    bool Reserve(size_t p_amount)
+    {
+        if (m_capacity - m_length >= p_amount)
+            return true;
+        
+        size_t t_new_capacity;
+        t_new_capacity = m_capacity != 0 ? m_capacity : 4096;
+        while(t_new_capacity - m_length < p_amount)
+            t_new_capacity *= 2;
+        
+        if (!MCMemoryReallocate(m_bytes, t_new_capacity, m_bytes))
+            return false;
+        
+        m_capacity = t_new_capacity;
+        return true;
+    }
+    
+    bool WriteU8(uint8_t p_value)
+    {
+        if (!Reserve(1))
+            return false;
+        m_bytes[m_length++] = p_value;
+        return true;
+    }
+    
+    bool WriteU32(uint32_t p_value)
+    {
+        if (!Reserve(4))
+            return false;
+        Store32(m_bytes + m_length, p_value);
+        m_length += 4;
+        return true;
+    }
+    
+    bool WriteU64(uint64_t p_value)
+    {
+        return WriteU32((uint32_t)p_value) &&
+                WriteU32((uint32_t)(p_value >> 32));
+    }
+    
+    bool WriteBytes(uint8_t p_tag, const void *p_bytes, uindex_t p_length)
+    {
+        if (!Reserve(1 + 4 + (size_t)p_length))
+            return false;
+        m_bytes[m_length++] = p_tag;
+        Store32(m_bytes + m_length, p_length);
+        m_length += 4;
+        MCMemoryCopy(m_bytes + m_length, p_bytes, p_length);
+        m_length += p_length;
+        return true;
+    }
+    
+    bool WriteString(uint8_t p_native_tag, uint8_t p_utf8_tag, MCStringRef p_string)
+    {
+        const char_t *t_chars;
+        t_chars = MCStringGetNativeCharPtr(p_string);
+        if (t_chars != nil &&
+            MCIndexedEncodingIsASCII(t_chars, MCStringGetLength(p_string)))
+            return WriteBytes(p_native_tag, t_chars, MCStringGetLength(p_string));
+        
+        char *t_utf8;
+        uindex_t t_utf8_length;
+        if (!MCStringConvertToUTF8(p_string, t_utf8, t_utf8_length))
+            return false;
+        
+        bool t_success;
+        t_success = WriteBytes(p_utf8_tag, t_utf8, t_utf8_length);
+        MCMemoryDeleteArray(t_utf8);
+        return t_success;
+    }
+    
+    // Begin a container, leaving space for the byte size of its elements which
+    // is filled in by EndContainer.
+    bool BeginContainer(uint8_t p_tag, uindex_t p_count, size_t& r_size_offset)
+    {
+        if (!Reserve(1 + 4 + 4))
+            return false;
+        m_bytes[m_length++] = p_tag;
+        Store32(m_bytes + m_length, p_count);
+        r_size_offset = m_length + 4;
+        m_length += 8;
+        return true;
+    }
+    
+    bool EndContainer(size_t p_size_offset)
+    {
+        size_t t_size;
+        t_size = m_length - (p_size_offset + 4);
+        if (t_size > UINT32_MAX)
+            return false;
+        Store32(m_bytes + p_size_offset, (uint32_t)t_size);
+        return true;
+    }
+    
+    // Fetch the index of p_key in the key table, adding it if necessary. Names
+    // are unique, so the table is keyed on the name's identity.
+    bool LookupKey(MCNameRef p_key, uint32_t& r_index)
+    {
+        if (m_key_count * 2 >= m_key_slot_count)
+        {
+            uindex_t t_new_slot_count;
+            t_new_slot_count = m_key_slot_count != 0 ? m_key_slot_count * 2 : 64;
+            
+            uint32_t *t_new_slots;
+            if (!MCMemoryNewArray(t_new_slot_count, t_new_slots))
+                return false;
+            
+            for(uindex_t i = 0; i < m_key_count; i++)
+            {
+                uindex_t t_slot;
+                t_slot = MCHashPointer(m_keys[i]) & (t_new_slot_count - 1);
+                while(t_new_slots[t_slot] != 0)
+                    t_slot = (t_slot + 1) & (t_new_slot_count - 1);
+                t_new_slots[t_slot] = i + 1;
+            }
+            
+            MCMemoryDeleteArray(m_key_slots);
+            m_key_slots = t_new_slots;
+            m_key_slot_count = t_new_slot_count;
+            
+            if (!MCMemoryResizeArray(t_new_slot_count / 2, m_keys, m_key_capacity))
+                return false;
+        }
+        
+        // Slots hold the key index plus one, so that zero marks an empty slot.
+        uindex_t t_slot;
+        t_slot = MCHashPointer(p_key) & (m_key_slot_count - 1);
+        while(m_key_slots[t_slot] != 0)
+        {
+            if (m_keys[m_key_slots[t_slot] - 1] == p_key)
+            {
+                r_index = m_key_slots[t_slot] - 1;
+                return true;
+            }
+            t_slot = (t_slot + 1) & (m_key_slot_count - 1);
+        }
+        
+        r_index = m_key_count;
+        m_keys[m_key_count++] = MCValueRetain(p_key);
+        m_key_slots[t_slot] = m_key_count;
+        return true;
+    }
+    
+    bool WriteValue(MCValueRef p_value)
+    {
+        switch(MCValueGetTypeCode(p_value))
+        {
+            case kMCValueTypeCodeNull:
+                return WriteU8(kMCIndexedEncodingTagNull);
+                
+            case kMCValueTypeCodeBoolean:
+                return WriteU8(p_value == kMCFalse ? kMCIndexedEncodingTagFalse : kMCIndexedEncodingTagTrue);
+                
+            case kMCValueTypeCodeNumber:
+                if (MCNumberIsInteger((MCNumberRef)p_value))
+                    return WriteU8(kMCIndexedEncodingTagInteger) &&
+                            WriteU32((uint32_t)MCNumberFetchAsInteger((MCNumberRef)p_value));
+                else
+                {
+                    double t_real;
+                    t_real = MCNumberFetchAsReal((MCNumberRef)p_value);
+                    
+                    uint64_t t_bits;
+                    MCMemoryCopy(&t_bits, &t_real, sizeof(t_bits));
+                    return WriteU8(kMCIndexedEncodingTagReal) &&
+                            WriteU64(t_bits);
+                }
+                
+            case kMCValueTypeCodeName:
+                if (MCNameIsEmpty((MCNameRef)p_value))
+                    return WriteU8(kMCIndexedEncodingTagEmptyName);
+                return WriteString(kMCIndexedEncodingTagName, kMCIndexedEncodingTagName, MCNameGetString((MCNameRef)p_value));
+                
+            case kMCValueTypeCodeString:
+                if (MCStringIsEmpty((MCStringRef)p_value))
+                    return WriteU8(kMCIndexedEncodingTagEmptyString);
+                return WriteString(kMCIndexedEncodingTagNativeString, kMCIndexedEncodingTagUTF8String, (MCStringRef)p_value);
+                
+            case kMCValueTypeCodeData:
+                if (MCDataIsEmpty((MCDataRef)p_value))
+                    return WriteU8(kMCIndexedEncodingTagEmptyData);
+                return WriteBytes(kMCIndexedEncodingTagData, MCDataGetBytePtr((MCDataRef)p_value), MCDataGetLength((MCDataRef)p_value));
+                
+            case kMCValueTypeCodeArray:
+            {
+                MCArrayRef t_array;
+                t_array = (MCArrayRef)p_value;
+                
+                if (MCArrayIsEmpty(t_array))
+                    return WriteU8(kMCIndexedEncodingTagEmptyArray);
+                
+                size_t t_size_offset;
+                if (MCArrayIsSequence(t_array))
+                {
+                    uindex_t t_count;
+                    t_count = MCArrayGetCount(t_array);
+                    if (!BeginContainer(kMCIndexedEncodingTagSequence, t_count, t_size_offset))
+                        return false;
+                    
+                    for(uindex_t i = 1; i <= t_count; i++)
+                    {
+                        MCValueRef t_element;
+                        if (!MCArrayFetchValueAtIndex(t_array, i, t_element) ||
+                            !WriteValue(t_element))
+                            return false;
+                    }
+                }
+                else
+                {
+                    if (!BeginContainer(kMCIndexedEncodingTagMap, MCArrayGetCount(t_array), t_size_offset))
+                        return false;
+                    
+                    uintptr_t t_iterator;
+                    MCNameRef t_key;
+                    MCValueRef t_element;
+                    t_iterator = 0;
+                    while(MCArrayIterate(t_array, t_iterator, t_key, t_element))
+                    {
+                        uint32_t t_key_index;
+                        if (!LookupKey(t_key, t_key_index) ||
+                            !WriteU32(t_key_index) ||
+                            !WriteValue(t_element))
+                            return false;
+                    }
+                }
+                
+                return EndContainer(t_size_offset);
+            }
+                
+            case kMCValueTypeCodeProperList:
+            {
+                MCProperListRef t_list;
+                t_list = (MCProperListRef)p_value;
+                
+                if (MCProperListIsEmpty(t_list))
+                    return WriteU8(kMCIndexedEncodingTagEmptyList);
+                
+                size_t t_size_offset;
+                if (!BeginContainer(kMCIndexedEncodingTagList, MCProperListGetLength(t_list), t_size_offset))
+                    return false;
+                
+                for(uindex_t i = 0; i < MCProperListGetLength(t_list); i++)
+                    if (!WriteValue(MCProperListFetchElementAtIndex(t_list, i)))
+                        return false;
+                
+                return EndContainer(t_size_offset);
+            }
+                
+            default:
+                MCAssert(false);
+                return false;
+        }
+    }
+    
+    byte_t *m_bytes;
+    size_t m_length;
+    size_t m_capacity;
+    
+    MCNameRef *m_keys;
+    uindex_t m_key_count;
+    uindex_t m_key_capacity;
+    uint32_t *m_key_slots;
+    uindex_t m_key_slot_count;
+};
+
+class MCIndexedArrayDecoder
+{
+public:
+    MCIndexedArrayDecoder(void)
+        : m_ptr(nil), m_limit(nil), m_depth(0)
+    {
+    }
+    
+    // Decode the encoding in p_bytes, which must begin with the type byte.
+    bool Decode(const byte_t *p_bytes, uindex_t p_length, MCArrayRef& r_array)
+    {
+        m_ptr = p_bytes;
+        m_limit = p_bytes + p_length;
+        
+        uint8_t t_type;
+        if (!ReadU8(t_type) ||
+            t_type != kMCEncodedValueTypeIndexedArray)
+            return false;
+        
+        uint32_t t_key_count;
+        if (!ReadU32(t_key_count) ||
+            t_key_count > (uint32_t)(m_limit - m_ptr) / 4 ||
+            !m_keys . New(t_key_count))
+            return false;
+        
+        for(uindex_t i = 0; i < t_key_count; i++)
+        {
+            const byte_t *t_chars;
+            uint32_t t_length;
+            if (!ReadBytes(t_chars, t_length))
+                return false;
+            
+            if (MCIndexedEncodingIsASCII(t_chars, t_length))
+            {
+                if (!MCNameCreateWithNativeChars(t_chars, t_length, m_keys[i]))
+                    return false;
+            }
+            else
+            {
+                MCAutoStringRef t_string;
+                if (!MCStringCreateWithBytes(t_chars, t_length, kMCStringEncodingUTF8, false, &t_string) ||
+                    !MCNameCreate(*t_string, m_keys[i]))
+                    return false;
+            }
+        }
+        
+        MCAutoValueRef t_value;
+        if (!ReadValue(&t_value) ||
+            m_ptr != m_limit ||
+            MCValueGetTypeCode(*t_value) != kMCValueTypeCodeArray)
+            return false;
+        
+        r_array = (MCArrayRef)t_value . Take();
+        return true;
+    }
+    
+private:
+    bool ReadU8(uint8_t& r_value)
+    {
+        if (m_ptr == m_limit)
+            return false;
+        r_value = *m_ptr++;
+        return true;
+    }
+    
+    bool ReadU32(uint32_t& r_value)
+    {
+        if (m_limit - m_ptr < 4)
+            return false;
+        r_value = (uint32_t)m_ptr[0] |
+                    ((uint32_t)m_ptr[1] << 8) |
+                    ((uint32_t)m_ptr[2] << 16) |
+                    ((uint32_t)m_ptr[3] << 24);
+        m_ptr += 4;
+        return true;
+    }
+    
+    bool ReadU64(uint64_t& r_value)
+    {
+        uint32_t t_low, t_high;
+        if (!ReadU32(t_low) ||
+            !ReadU32(t_high))
+            return false;
+        r_value = (uint64_t)t_low | ((uint64_t)t_high << 32);
+        return true;
+    }
+    
+    // Fetch a length-prefixed run of bytes, which remain in the source buffer.
+    bool ReadBytes(const byte_t*& r_bytes, uint32_t& r_length)
+    {
+        if (!ReadU32(r_length) ||
+            r_length > (uint32_t)(m_limit - m_ptr))
+            return false;
+        r_bytes = m_ptr;
+        m_ptr += r_length;
+        return true;
+    }
+    
+    // Read the header of a container, checking that its elements lie within
+    // the buffer. Each element takes at least one byte, which bounds the count.
+    bool ReadContainer(uint32_t& r_count, const byte_t*& r_end)
+    {
+        uint32_t t_size;
+        if (!ReadU32(r_count) ||
+            !ReadU32(t_size) ||
+            t_size > (uint32_t)(m_limit - m_ptr) ||
+            r_count > t_size)
+            return false;
+        r_end = m_ptr + t_size;
+        return true;
+    }
+    
+    bool ReadArray(bool p_is_sequence, MCValueRef& r_value)
+    {
+        uint32_t t_count;
+        const byte_t *t_end;
+        if (!ReadContainer(t_count, t_end))
+            return false;
+        
+        MCAutoArrayRef t_array;
+        if (!MCArrayCreateMutable(&t_array))
+            return false;
+        
+        for(uint32_t i = 0; i < t_count; i++)
+        {
+            MCNameRef t_key;
+            t_key = nil;
+            if (!p_is_sequence)
+            {
+                uint32_t t_key_index;
+                if (!ReadU32(t_key_index) ||
+                    t_key_index >= m_keys . Size())
+                    return false;
+                t_key = m_keys[t_key_index];
+            }
+            
+            MCAutoValueRef t_element;
+            if (!ReadValue(&t_element))
+                return false;
+            
+            if (p_is_sequence)
+            {
+                if (!MCArrayStoreValueAtIndex(*t_array, i + 1, *t_element))
+                    return false;
+            }
+            else
+            {
+                if (!MCArrayStoreValue(*t_array, true, t_key, *t_element))
+                    return false;
+            }
+        }
+        
+        if (m_ptr != t_end ||
+            !t_array . MakeImmutable())
+            return false;
+        
+        r_value = t_array . Take();
+        return true;
+    }
+    
+    bool ReadList(MCValueRef& r_value)
+    {
+        uint32_t t_count;
+        const byte_t *t_end;
+        if (!ReadContainer(t_count, t_end))
+            return false;
+        
+        MCAutoProperListRef t_list;
+        if (!MCProperListCreateMutable(&t_list))
+            return false;
+        
+        for(uint32_t i = 0; i < t_count; i++)
+        {
+            MCAutoValueRef t_element;
+            if (!ReadValue(&t_element) ||
+                !MCProperListPushElementOntoBack(*t_list, *t_element))
+                return false;
+        }
+        
+        if (m_ptr != t_end ||
+            !t_list . MakeImmutable())
+            return false;
+        
+        r_value = t_list . Take();
+        return true;
+    }
+    
+    bool ReadValue(MCValueRef& r_value)
+    {
+        uint8_t t_tag;
+        if (!ReadU8(t_tag))
+            return false;
+        
+        switch(t_tag)
+        {
+            case kMCIndexedEncodingTagNull:
+                r_value = MCValueRetain(kMCNull);
+                return true;
+                
+            case kMCIndexedEncodingTagFalse:
+                r_value = MCValueRetain(kMCFalse);
+                return true;
+                
+            case kMCIndexedEncodingTagTrue:
+                r_value = MCValueRetain(kMCTrue);
+                return true;
+                
+            case kMCIndexedEncodingTagInteger:
+            {
+                uint32_t t_integer;
+                return ReadU32(t_integer) &&
+                        MCNumberCreateWithInteger((integer_t)t_integer, (MCNumberRef&)r_value);
+            }
+                
+            case kMCIndexedEncodingTagReal:
+            {
+                uint64_t t_bits;
+                if (!ReadU64(t_bits))
+                    return false;
+                
+                double t_real;
+                MCMemoryCopy(&t_real, &t_bits, sizeof(t_real));
+                return MCNumberCreateWithReal(t_real, (MCNumberRef&)r_value);
+            }
+                
+            case kMCIndexedEncodingTagEmptyName:
+                r_value = MCValueRetain(kMCEmptyName);
+                return true;
+                
+            case kMCIndexedEncodingTagName:
+            {
+                const byte_t *t_bytes;
+                uint32_t t_length;
+                MCAutoStringRef t_string;
+                return ReadBytes(t_bytes, t_length) &&
+                        MCStringCreateWithBytes(t_bytes, t_length, kMCStringEncodingUTF8, false, &t_string) &&
+                        MCNameCreate(*t_string, (MCNameRef&)r_value);
+            }
+                
+            case kMCIndexedEncodingTagEmptyString:
+                r_value = MCValueRetain(kMCEmptyString);
+                return true;
+                
+            case kMCIndexedEncodingTagNativeString:
+            {
+                const byte_t *t_bytes;
+                uint32_t t_length;
+                return ReadBytes(t_bytes, t_length) &&
+                        MCIndexedEncodingIsASCII(t_bytes, t_length) &&
+                        MCStringCreateWithNativeChars(t_bytes, t_length, (MCStringRef&)r_value);
+            }
+                
+            case kMCIndexedEncodingTagUTF8String:
+            {
+                const byte_t *t_bytes;
+                uint32_t t_length;
+                return ReadBytes(t_bytes, t_length) &&
+                        MCStringCreateWithBytes(t_bytes, t_length, kMCStringEncodingUTF8, false, (MCStringRef&)r_value);
+            }
+                
+            case kMCIndexedEncodingTagEmptyData:
+                r_value = MCValueRetain(kMCEmptyData);
+                return true;
+                
+            case kMCIndexedEncodingTagData:
+            {
+                const byte_t *t_bytes;
+                uint32_t t_length;
+                return ReadBytes(t_bytes, t_length) &&
+                        MCDataCreateWithBytes(t_bytes, t_length, (MCDataRef&)r_value);
+            }
+                
+            case kMCIndexedEncodingTagEmptyArray:
+                r_value = MCValueRetain(kMCEmptyArray);
+                return true;
+                
+            case kMCIndexedEncodingTagSequence:
+            case kMCIndexedEncodingTagMap:
+            case kMCIndexedEncodingTagList:
+            {
+                if (m_depth == kMCIndexedEncodingMaxDepth)
+                    return false;
+                
+                m_depth += 1;
+                bool t_success;
+                if (t_tag == kMCIndexedEncodingTagList)
+                    t_success = ReadList(r_value);
+                else
+                    t_success = ReadArray(t_tag == kMCIndexedEncodingTagSequence, r_value);
+                m_depth -= 1;
+                
+                return t_success;
+            }
+                
+            case kMCIndexedEncodingTagEmptyList:
+                r_value = MCValueRetain(kMCEmptyProperList);
+                return true;
+                
+            default:
+                return false;
+        }
+    }
+    
+    const byte_t *m_ptr;
+    const byte_t *m_limit;
+    uindex_t m_depth;
+    MCAutoNameRefArray m_keys;
+};
+
+// Returns true if p_version requests the indexed encoding. As engines before
+// 9.7 can't decode it, it is only used when asked for by name rather than for
+// a version number, so that arrayEncode(tArray, the version) keeps producing
+// arrays which older engines can read.
+static bool MCArraysIsIndexedEncodingVersion(MCStringRef p_version)
+{
+    return MCStringIsEqualToCString(p_version, "indexed", kMCStringOptionCompareCaseless);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 void MCArraysEvalArrayEncode(MCExecContext& ctxt, MCArrayRef p_array, MCStringRef p_version, MCDataRef& r_encoding)
 {
+    if (p_version != nil && MCArraysIsIndexedEncodingVersion(p_version))
+    {
+        MCIndexedArrayEncoder t_encoder;
+        if (!t_encoder . Encode(p_array, r_encoding))
+            ctxt . Throw();
+        return;
+    }
+    
 	bool t_success;
 	t_success = true;
 
@@ -862,6 +1588,15 @@ void MCArraysEvalArrayEncode(MCExecContext& ctxt, MCArrayRef p_array, MCStringRe
 
 void MCArraysEvalArrayDecode(MCExecContext& ctxt, MCDataRef p_encoding, MCArrayRef& r_array)
 {
+    if (MCDataGetLength(p_encoding) != 0 &&
+        MCDataGetByteAtIndex(p_encoding, 0) == kMCEncodedValueTypeIndexedArray)
+    {
+        MCIndexedArrayDecoder t_decoder;
+        if (!t_decoder . Decode(MCDataGetBytePtr(p_encoding), MCDataGetLength(p_encoding), r_array))
+            ctxt . Throw();
+        return;
+    }
+    
 	bool t_success;
 	t_success = true;
 
@@ -1139,41 +1874,205 @@ inline real64_t& MCMatrixEntry(matrix_t *m, integer_t r, integer_t c)
 	return m->values[r * m->columns + c];
 }
 
+inline bool MCMatrixCopy(const matrix_t *p_matrix, matrix_t*& r_matrix)
+{
+	if (!MCMatrixNew(p_matrix->rows, p_matrix->columns, p_matrix->row_offset, p_matrix->column_offset, r_matrix))
+		return false;
 
-#define extent_size(x) (x.max - x.min + 1)
-bool MCArraysCopyMatrix(MCExecContext& ctxt, MCArrayRef self, matrix_t*& r_matrix)
+	MCMemoryCopy(r_matrix->values, p_matrix->values, sizeof(real64_t) * p_matrix->rows * p_matrix->columns);
+	return true;
+}
+
+// Matrices are converted to and from arrays with keys of the form "r,c". As
+// converting to a matrix is costly, the arrays most recently created from a
+// matrix are kept along with the matrix itself, so that results passed back
+// in (e.g. chains of matrixMultiply calls) are not converted again. The arrays
+// are retained, so can't be freed (or, being immutable, changed) while they
+// are in the cache. Only matrices of up to kMCMatrixCacheMaxCells cells are
+// cached, which bounds the memory the cache holds on to until it is evicted.
+#define kMCMatrixCacheSize 2
+#define kMCMatrixCacheMaxCells 65536
+
+struct matrix_cache_entry_t
 {
-	MCAutoArray<array_extent_t> t_extents;
-	if (!MCArraysCopyExtents(self, t_extents.PtrRef(), t_extents.SizeRef()) ||
-		t_extents.Size() != 2)
+	MCArrayRef array;
+	matrix_t *matrix;
+};
+
+static matrix_cache_entry_t s_matrix_cache[kMCMatrixCacheSize];
+
+static void MCMatrixCacheAdd(MCArrayRef p_array, matrix_t *p_matrix)
+{
+	// Large matrices (and their arrays) are not kept alive by the cache, they
+	// are converted again if they are passed back in.
+	if ((uint64_t)p_matrix->rows * p_matrix->columns > kMCMatrixCacheMaxCells)
+		return;
+
+	matrix_t *t_matrix;
+	if (!MCMatrixCopy(p_matrix, t_matrix))
+		return;
+
+	// Evict the oldest entry - the newest is always first.
+	if (s_matrix_cache[kMCMatrixCacheSize - 1].array != nil)
+	{
+		MCValueRelease(s_matrix_cache[kMCMatrixCacheSize - 1].array);
+		MCMemoryDelete(s_matrix_cache[kMCMatrixCacheSize - 1].matrix);
+	}
+
+	for (uindex_t i = kMCMatrixCacheSize - 1; i > 0; i--)
+		s_matrix_cache[i] = s_matrix_cache[i - 1];
+
+	s_matrix_cache[0].array = MCValueRetain(p_array);
+	s_matrix_cache[0].matrix = t_matrix;
+}
+
+static const matrix_t *MCMatrixCacheFind(MCArrayRef p_array)
+{
+	for (uindex_t i = 0; i < kMCMatrixCacheSize; i++)
+		if (s_matrix_cache[i].array == p_array)
+			return s_matrix_cache[i].matrix;
+
+	return nil;
+}
+
+void MCArraysFinalize(void)
+{
+	for (uindex_t i = 0; i < kMCMatrixCacheSize; i++)
+	{
+		MCValueRelease(s_matrix_cache[i].array);
+		MCMemoryDelete(s_matrix_cache[i].matrix);
+		s_matrix_cache[i].array = nil;
+		s_matrix_cache[i].matrix = nil;
+	}
+}
+
+// Parse a key of the form "r,c" with r and c integers formatted as "%d" would
+// format them. Keys written in any other way can't be matrix keys, as matrix
+// cells are always looked up using keys formatted by "%d,%d".
+static bool MCArraysParseMatrixKey(MCNameRef p_key, integer_t& r_row, integer_t& r_column)
+{
+	MCStringRef t_string = MCNameGetString(p_key);
+	uindex_t t_length = MCStringGetLength(t_string);
+
+	// Keys are almost always native, but may not be.
+	char_t t_buffer[24];
+	const char_t *t_chars;
+	if (MCStringIsNative(t_string))
+		t_chars = MCStringGetNativeCharPtr(t_string);
+	else if (t_length <= sizeof(t_buffer))
+	{
+		for (uindex_t i = 0; i < t_length; i++)
+		{
+			unichar_t t_char = MCStringGetCharAtIndex(t_string, i);
+			t_buffer[i] = t_char < 128 ? (char_t)t_char : 0;
+		}
+		t_chars = t_buffer;
+	}
+	else
+		return false;
+
+	uindex_t t_offset = 0;
+	integer_t t_values[2];
+	for (uindex_t i = 0; i < 2; i++)
+	{
+		if (i == 1)
+		{
+			if (t_offset >= t_length || t_chars[t_offset] != ',')
+				return false;
+			t_offset++;
+		}
+
+		bool t_negative = false;
+		if (t_offset < t_length && t_chars[t_offset] == '-')
+		{
+			t_negative = true;
+			t_offset++;
+		}
+
+		uindex_t t_start = t_offset;
+		int64_t t_value = 0;
+		while (t_offset < t_length && t_chars[t_offset] >= '0' && t_chars[t_offset] <= '9')
+		{
+			t_value = t_value * 10 + (t_chars[t_offset] - '0');
+			if (t_value > INT32_MAX)
+				return false;
+			t_offset++;
+		}
+
+		// Reject empty numbers, leading zeros and "-0".
+		if (t_offset == t_start ||
+			(t_chars[t_start] == '0' && (t_offset - t_start > 1 || t_negative)))
+			return false;
+
+		t_values[i] = (integer_t)(t_negative ? -t_value : t_value);
+	}
+
+	if (t_offset != t_length)
 		return false;
 
-	integer_t t_rows = extent_size(t_extents[0]);
-	integer_t t_cols = extent_size(t_extents[1]);
+	r_row = t_values[0];
+	r_column = t_values[1];
+	return true;
+}
+
+static bool MCArraysCreateMatrixKey(integer_t p_row, integer_t p_column, MCNameRef& r_key)
+{
+	char t_buffer[24];
+	int t_length = sprintf(t_buffer, "%d,%d", p_row, p_column);
+	return MCNameCreateWithNativeChars((const char_t *)t_buffer, t_length, r_key);
+}
+
+bool MCArraysCopyMatrix(MCExecContext& ctxt, MCArrayRef self, matrix_t*& r_matrix)
+{
+	const matrix_t *t_cached = MCMatrixCacheFind(self);
+	if (t_cached != nil)
+		return MCMatrixCopy(t_cached, r_matrix);
+
+	// Find the extents of the matrix by parsing each key once.
+	integer_t t_min_row = 0, t_max_row = 0, t_min_col = 0, t_max_col = 0;
+	uintptr_t t_index = 0;
+	MCNameRef t_key;
+	MCValueRef t_value;
+	bool t_first = true;
+	while (MCArrayIterate(self, t_index, t_key, t_value))
+	{
+		integer_t t_row, t_col;
+		if (!MCArraysParseMatrixKey(t_key, t_row, t_col))
+			return false;
+
+		if (t_first || t_row < t_min_row)
+			t_min_row = t_row;
+		if (t_first || t_row > t_max_row)
+			t_max_row = t_row;
+		if (t_first || t_col < t_min_col)
+			t_min_col = t_col;
+		if (t_first || t_col > t_max_col)
+			t_max_col = t_col;
+		t_first = false;
+	}
+
+	if (t_first)
+		return false;
 
-	integer_t t_row_offset = t_extents[0].min;
-	integer_t t_col_offset = t_extents[1].min;
+	integer_t t_rows = t_max_row - t_min_row + 1;
+	integer_t t_cols = t_max_col - t_min_col + 1;
 
+	// As the keys are distinct, there is one for every cell if there are as
+	// many keys as cells.
 	if (MCArrayGetCount(self) != (uindex_t) t_rows * t_cols)
 		return false;
 
 	MCAutoPointer<matrix_t> t_matrix;
-	if (!MCMatrixNew(t_rows, t_cols, t_row_offset, t_col_offset, &t_matrix))
+	if (!MCMatrixNew(t_rows, t_cols, t_min_row, t_min_col, &t_matrix))
 		return false;
 
-	for (integer_t row = 0; row < t_rows; row++)
+	t_index = 0;
+	while (MCArrayIterate(self, t_index, t_key, t_value))
 	{
-		for (integer_t col = 0; col < t_cols; col++)
-		{
-			MCAutoStringRef t_string;
-			MCNewAutoNameRef t_name;
-			MCValueRef t_value;
-			if (!MCStringFormat(&t_string, "%d,%d", row + t_row_offset, col + t_col_offset) ||
-				!MCNameCreate(*t_string, &t_name) ||
-				!MCArrayFetchValue(self, true, *t_name, t_value) ||
-				!ctxt.ConvertToReal(t_value, MCMatrixEntry(*t_matrix, row, col)))
-				return false;
-		}
+		integer_t t_row, t_col;
+		/* UNCHECKED */ MCArraysParseMatrixKey(t_key, t_row, t_col);
+		if (!ctxt.ConvertToReal(t_value, MCMatrixEntry(*t_matrix, t_row - t_min_row, t_col - t_min_col)))
+			return false;
 	}
 
 	t_matrix.Take(r_matrix);
@@ -1190,18 +2089,34 @@ bool MCArraysCreateWithMatrix(matrix_t *p_matrix, MCArrayRef& r_array)
 	{
 		for (integer_t c = 0; c < p_matrix->columns; c++)
 		{
-			MCAutoStringRef t_string;
 			MCNewAutoNameRef t_key;
 			MCAutoNumberRef t_value;
-			if (!MCStringFormat(&t_string, "%d,%d", r + p_matrix->row_offset, c + p_matrix->column_offset) ||
-				!MCNameCreate(*t_string, &t_key) ||
+			if (!MCArraysCreateMatrixKey(r + p_matrix->row_offset, c + p_matrix->column_offset, &t_key) ||
 				!MCNumberCreateWithReal(MCMatrixEntry(p_matrix, r, c), &t_value) ||
 				!MCArrayStoreValue(*t_array, true, *t_key, *t_value))
 				return false;
 		}
 	}
 
-	return MCArrayCopy(*t_array, r_array);
+	if (!MCArrayCopy(*t_array, r_array))
+		return false;
+
+	MCMatrixCacheAdd(r_array, p_matrix);
+	return true;
+}
+
+// The block sizes for the multiply are chosen so that a block of rows of the
+// right matrix stays in cache while it is used for each row of the left.
+#define kMCMatrixBlockRows 64
+#define kMCMatrixBlockDepth 128
+#define kMCMatrixBlockColumns 512
+
+// Compute r_c[j] += p_a * p_b[j], written so that it can be vectorized by the
+// compiler.
+static inline void MCMatrixMultiplyRow(real64_t *__restrict r_c, real64_t p_a, const real64_t *__restrict p_b, index_t p_count)
+{
+	for (index_t j = 0; j < p_count; j++)
+		r_c[j] += p_a * p_b[j];
 }
 
 bool MCMatrixMultiply(matrix_t *p_a, matrix_t *p_b, matrix_t*& r_c)
@@ -1215,14 +2130,28 @@ bool MCMatrixMultiply(matrix_t *p_a, matrix_t *p_b, matrix_t*& r_c)
 	if (!MCMatrixNew(p_a->rows, p_b->columns, p_a->row_offset, p_a->column_offset, &t_c))
 		return false;
 
-	for (index_t i = 0; i < p_a->rows; i++)
+	// The product is accumulated a block at a time. Each entry of the result
+	// still sums its terms in order of k, so the result is the same as that
+	// of the naive algorithm.
+	index_t t_rows = p_a->rows;
+	index_t t_depth = p_a->columns;
+	index_t t_columns = p_b->columns;
+	for (index_t i0 = 0; i0 < t_rows; i0 += kMCMatrixBlockRows)
 	{
-		for (index_t j = 0; j < p_b->columns; j++)
+		index_t i1 = MCMin(i0 + kMCMatrixBlockRows, t_rows);
+		for (index_t k0 = 0; k0 < t_depth; k0 += kMCMatrixBlockDepth)
 		{
-			real64_t t_total = 0;
-			for (index_t k = 0; k < p_a->columns; k++)
-				t_total += MCMatrixEntry(p_a, i, k) * MCMatrixEntry(p_b, k, j);
-			MCMatrixEntry(*t_c, i, j) = t_total;
+			index_t k1 = MCMin(k0 + kMCMatrixBlockDepth, t_depth);
+			for (index_t j0 = 0; j0 < t_columns; j0 += kMCMatrixBlockColumns)
+			{
+				index_t t_count = MCMin(j0 + kMCMatrixBlockColumns, t_columns) - j0;
+				for (index_t i = i0; i < i1; i++)
+				{
+					real64_t *t_c_row = &MCMatrixEntry(*t_c, i, j0);
+					for (index_t k = k0; k < k1; k++)
+						MCMatrixMultiplyRow(t_c_row, MCMatrixEntry(p_a, i, k), &MCMatrixEntry(p_b, k, j0), t_count);
+				}
+			}
 		}
 	}
 
@@ -1285,16 +2214,48 @@ void MCArraysEvalVectorDotProduct(MCExecContext& ctxt, MCArrayRef p_left, MCArra
 
 bool MCArraysCopyTransposed(MCArrayRef self, MCArrayRef& r_transposed)
 {
-	MCAutoArray<array_extent_t> t_extents;
-	if (!MCArraysCopyExtents(self, t_extents.PtrRef(), t_extents.SizeRef()) ||
-		t_extents.Size() != 2)
-		return false;
+	// If the array came from a matrix then transpose the matrix itself.
+	const matrix_t *t_cached = MCMatrixCacheFind(self);
+	if (t_cached != nil)
+	{
+		MCAutoPointer<matrix_t> t_matrix;
+		if (!MCMatrixNew(t_cached->columns, t_cached->rows, t_cached->column_offset, t_cached->row_offset, &t_matrix))
+			return false;
+
+		for (integer_t r = 0; r < t_cached->rows; r++)
+			for (integer_t c = 0; c < t_cached->columns; c++)
+				MCMatrixEntry(*t_matrix, c, r) = MCMatrixEntry(const_cast<matrix_t *>(t_cached), r, c);
+
+		return MCArraysCreateWithMatrix(*t_matrix, r_transposed);
+	}
+
+	integer_t t_min_row = 0, t_max_row = 0, t_min_col = 0, t_max_col = 0;
+	uintptr_t t_index = 0;
+	MCNameRef t_key;
+	MCValueRef t_value;
+	bool t_first = true;
+	while (MCArrayIterate(self, t_index, t_key, t_value))
+	{
+		integer_t t_row, t_col;
+		if (!MCArraysParseMatrixKey(t_key, t_row, t_col))
+			return false;
+
+		if (t_first || t_row < t_min_row)
+			t_min_row = t_row;
+		if (t_first || t_row > t_max_row)
+			t_max_row = t_row;
+		if (t_first || t_col < t_min_col)
+			t_min_col = t_col;
+		if (t_first || t_col > t_max_col)
+			t_max_col = t_col;
+		t_first = false;
+	}
 
-	integer_t t_rows = extent_size(t_extents[0]);
-	integer_t t_cols = extent_size(t_extents[1]);
+	if (t_first)
+		return false;
 
-	integer_t t_row_end = t_extents[0].min + t_rows;
-	integer_t t_col_end = t_extents[1].min + t_cols;
+	integer_t t_rows = t_max_row - t_min_row + 1;
+	integer_t t_cols = t_max_col - t_min_col + 1;
 
 	if (MCArrayGetCount(self) != (uindex_t) t_rows * t_cols)
 		return false;
@@ -1303,23 +2264,16 @@ bool MCArraysCopyTransposed(MCArrayRef self, MCArrayRef& r_transposed)
 	if (!MCArrayCreateMutable(&t_transposed))
 		return false;
 
-	for (integer_t r = t_extents[0].min; r < t_row_end; r++)
+	t_index = 0;
+	while (MCArrayIterate(self, t_index, t_key, t_value))
 	{
-		for (integer_t c = t_extents[1].min; c < t_col_end; c++)
-		{
-			MCAutoStringRef t_src_string, t_dst_string;
-			MCNewAutoNameRef t_src_name, t_dst_name;
-			MCValueRef t_value;
-			if (!MCStringFormat(&t_src_string, "%d,%d", r, c) ||
-				!MCStringFormat(&t_dst_string, "%d,%d", c, r))
-				return false;
-			if (!MCNameCreate(*t_src_string, &t_src_name) ||
-				!MCNameCreate(*t_dst_string, &t_dst_name))
-				return false;
-			if (!MCArrayFetchValue(self, true, *t_src_name, t_value) ||
-				!MCArrayStoreValue(*t_transposed, true, *t_dst_name, t_value))
-				return false;
-		}
+		integer_t t_row, t_col;
+		/* UNCHECKED */ MCArraysParseMatrixKey(t_key, t_row, t_col);
+
+		MCNewAutoNameRef t_dst_name;
+		if (!MCArraysCreateMatrixKey(t_col, t_row, &t_dst_name) ||
+			!MCArrayStoreValue(*t_transposed, true, *t_dst_name, t_value))
+			return false;
 	}
 
 	return MCArrayCopy(*t_transposed, r_transposed);
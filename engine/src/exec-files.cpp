@@ -25,13 +25,19 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 #include "globals.h"
 #include "osspec.h"
+#include "system.h"
 
 #include "securemode.h"
+#include "chunk.h"
 #include "exec.h"
 #include "util.h"
 #include "uidc.h"
 #include "mcerror.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 
 static MCExecEnumTypeElementInfo _kMCFilesEofEnumElementInfo[] =
@@ -842,6 +848,21 @@ void MCFilesExecPerformOpen(MCExecContext& ctxt, MCNameRef p_name, int p_mode, i
 		return;
     }
 
+    // Regular files are read through a buffer, so that text can be decoded in
+    // bulk. Devices, FIFOs and pipes may block when read ahead, so are read
+    // directly as before.
+    if (istream != NULL && !p_is_driver && istream -> IsRegularFile())
+    {
+        MCBufferedFileHandle *t_buffered;
+        t_buffered = new (nothrow) MCBufferedFileHandle(istream);
+        if (t_buffered != NULL)
+        {
+            if (ostream == istream)
+                ostream = t_buffered;
+            istream = t_buffered;
+        }
+    }
+
 	MCU_realloc((char **)&MCfiles, MCnfiles, MCnfiles + 1, sizeof(Streamnode));
 	MCfiles[MCnfiles].name = (MCNameRef)MCValueRetain(p_name);
     MCfiles[MCnfiles].mode = (Open_mode)p_mode;
@@ -1519,6 +1540,805 @@ bool MCFilesExecPerformReadChunk(MCExecContext &ctxt, int4 p_index, intenum_t p_
     return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+// Text in native, UTF-8 and UTF-16 files is decoded in bulk from the
+// read-ahead buffer of the file's handle, rather than a code unit at a time.
+
+static bool MCFilesIsBufferedTextEncoding(intenum_t p_encoding)
+{
+    switch (p_encoding)
+    {
+        case kMCFileEncodingNative:
+        case kMCFileEncodingUTF8:
+        case kMCFileEncodingUTF16:
+        case kMCFileEncodingUTF16LE:
+        case kMCFileEncodingUTF16BE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static uindex_t MCFilesTextUnitSize(intenum_t p_encoding)
+{
+    if (p_encoding == kMCFileEncodingNative || p_encoding == kMCFileEncodingUTF8)
+        return 1;
+    return 2;
+}
+
+// Fetch a UTF-16 code unit, which is stored in host order unless the
+// encoding is big-endian.
+static inline unichar_t MCFilesFetchUTF16Unit(intenum_t p_encoding, const byte_t *p_bytes)
+{
+    unichar_t t_unit;
+    memcpy(&t_unit, p_bytes, sizeof(unichar_t));
+    if (p_encoding == kMCFileEncodingUTF16BE)
+        t_unit = MCSwapInt16BigToHost(t_unit);
+    return t_unit;
+}
+
+static inline unichar_t MCFilesFetchTextUnit(intenum_t p_encoding, const byte_t *p_bytes)
+{
+    if (MCFilesTextUnitSize(p_encoding) == 1)
+        return *p_bytes;
+    return MCFilesFetchUTF16Unit(p_encoding, p_bytes);
+}
+
+static bool MCFilesBytesAreASCII(const byte_t *p_bytes, uindex_t p_count)
+{
+    uindex_t i = 0;
+#if defined(__SSE2__)
+    __m128i t_bits = _mm_setzero_si128();
+    for (; i + 16 <= p_count; i += 16)
+        t_bits = _mm_or_si128(t_bits, _mm_loadu_si128((const __m128i *)(p_bytes + i)));
+    if (_mm_movemask_epi8(t_bits) != 0)
+        return false;
+#endif
+    for (; i < p_count; i++)
+        if (p_bytes[i] >= 0x80)
+            return false;
+    return true;
+}
+
+// Decode UTF-8 or UTF-16 bytes into r_chars, which must have room for
+// p_count + 1 chars. Decoding stops after p_max_codepoints codepoints, or at
+// an incomplete sequence unless p_at_end (when there are no more bytes to
+// come). Unless p_pair_surrogates, each UTF-16 code unit is counted as a
+// codepoint.
+//
+// As when reading a code unit at a time, invalid UTF-8 sequences become
+// U+FFFD and stray continuation bytes are skipped.
+//
+// Returns the number of bytes decoded.
+static uindex_t MCFilesDecodeText(intenum_t p_encoding, const byte_t *p_bytes, uindex_t p_count, bool p_at_end, uindex_t p_max_codepoints, bool p_pair_surrogates, unichar_t *r_chars, uindex_t& r_char_count, uindex_t& r_codepoint_count)
+{
+    static const codepoint_t kMinimumValues[] = { 0, 0x80, 0x800, 0x10000 };
+    
+    uindex_t t_used, t_chars, t_codepoints;
+    t_used = 0;
+    t_chars = 0;
+    t_codepoints = 0;
+    
+    if (p_encoding == kMCFileEncodingUTF8)
+    {
+        while (t_used < p_count && t_codepoints < p_max_codepoints)
+        {
+            byte_t t_lead;
+            t_lead = p_bytes[t_used];
+            if (t_lead < 0x80)
+            {
+                r_chars[t_chars++] = t_lead;
+                t_used += 1;
+                t_codepoints += 1;
+                continue;
+            }
+            
+            uindex_t t_trail_count;
+            if (t_lead < 0xC0 || t_lead >= 0xFE)
+            {
+                t_used += 1;
+                continue;
+            }
+            else if (t_lead < 0xE0)
+                t_trail_count = 1;
+            else if (t_lead < 0xF0)
+                t_trail_count = 2;
+            else if (t_lead < 0xF8)
+                t_trail_count = 3;
+            else if (t_lead < 0xFC)
+                t_trail_count = 4;
+            else
+                t_trail_count = 5;
+            
+            uindex_t t_length;
+            t_length = 1;
+            while (t_length <= t_trail_count && t_used + t_length < p_count &&
+                   (p_bytes[t_used + t_length] & 0xC0) == 0x80)
+                t_length += 1;
+            
+            // Wait for the rest of a sequence which is cut short by the end
+            // of the bytes.
+            if (t_length <= t_trail_count && t_used + t_length == p_count && !p_at_end)
+                break;
+            
+            codepoint_t t_codepoint;
+            t_codepoint = 0xFFFD;
+            if (t_length == t_trail_count + 1 && t_trail_count <= 3)
+            {
+                codepoint_t t_value;
+                t_value = t_lead & (0x3F >> t_trail_count);
+                for (uindex_t i = 1; i < t_length; i++)
+                    t_value = (t_value << 6) | (p_bytes[t_used + i] & 0x3F);
+                
+                if (t_value >= kMinimumValues[t_trail_count] && t_value <= 0x10FFFF &&
+                    (t_value < 0xD800 || t_value > 0xDFFF))
+                    t_codepoint = t_value;
+            }
+            
+            if (t_codepoint >= 0x10000)
+            {
+                t_codepoint -= 0x10000;
+                r_chars[t_chars++] = 0xD800 + (t_codepoint >> 10);
+                r_chars[t_chars++] = 0xDC00 + (t_codepoint & 0x3FF);
+            }
+            else
+                r_chars[t_chars++] = t_codepoint;
+            
+            t_used += t_length;
+            t_codepoints += 1;
+        }
+    }
+    else
+    {
+        while (t_codepoints < p_max_codepoints)
+        {
+            if (t_used + 2 > p_count)
+            {
+                // A lone byte at the end is read as the low byte of a code unit.
+                if (p_at_end && t_used < p_count)
+                {
+                    byte_t t_last[2] = { p_bytes[t_used], 0 };
+                    r_chars[t_chars++] = MCFilesFetchUTF16Unit(p_encoding, t_last);
+                    t_used += 1;
+                    t_codepoints += 1;
+                }
+                break;
+            }
+            
+            unichar_t t_unit;
+            t_unit = MCFilesFetchUTF16Unit(p_encoding, p_bytes + t_used);
+            if (p_pair_surrogates && MCUnicodeCodepointIsHighSurrogate(t_unit))
+            {
+                if (t_used + 4 <= p_count)
+                {
+                    unichar_t t_trail;
+                    t_trail = MCFilesFetchUTF16Unit(p_encoding, p_bytes + t_used + 2);
+                    if (MCUnicodeCodepointIsLowSurrogate(t_trail))
+                    {
+                        r_chars[t_chars++] = t_unit;
+                        r_chars[t_chars++] = t_trail;
+                        t_used += 4;
+                        t_codepoints += 1;
+                        continue;
+                    }
+                }
+                else if (!p_at_end)
+                    break;
+            }
+            
+            r_chars[t_chars++] = t_unit;
+            t_used += 2;
+            t_codepoints += 1;
+        }
+    }
+    
+    r_char_count = t_chars;
+    r_codepoint_count = t_codepoints;
+    return t_used;
+}
+
+// Decode the first p_count bytes in the buffer onto x_output, consuming
+// them. An incomplete sequence at the end is left in the buffer unless
+// p_at_end.
+static bool MCFilesAppendBufferedText(MCBufferedFileHandle *p_stream, intenum_t p_encoding, uindex_t p_count, bool p_at_end, MCStringRef x_output)
+{
+    const byte_t *t_bytes;
+    t_bytes = p_stream -> GetBytes();
+    
+    if (p_encoding == kMCFileEncodingNative ||
+        (p_encoding == kMCFileEncodingUTF8 && MCFilesBytesAreASCII(t_bytes, p_count)))
+    {
+        if (!MCStringAppendNativeChars(x_output, t_bytes, p_count))
+            return false;
+        p_stream -> Consume(p_count);
+        return true;
+    }
+    
+    MCAutoArray<unichar_t> t_chars;
+    if (!t_chars . New(p_count + 1))
+        return false;
+    
+    uindex_t t_used, t_char_count, t_codepoint_count;
+    t_used = MCFilesDecodeText(p_encoding, t_bytes, p_count, p_at_end, UINDEX_MAX, true, t_chars . Ptr(), t_char_count, t_codepoint_count);
+    if (!MCStringAppendChars(x_output, t_chars . Ptr(), t_char_count))
+        return false;
+    
+    p_stream -> Consume(t_used);
+    return true;
+}
+
+static uindex_t MCFilesFindLineEnd(const byte_t *p_bytes, uindex_t p_count)
+{
+    uindex_t i = 0;
+#if defined(__SSE2__)
+    const __m128i t_lf = _mm_set1_epi8('\n');
+    const __m128i t_cr = _mm_set1_epi8('\r');
+    for (; i + 16 <= p_count; i += 16)
+    {
+        __m128i t_block;
+        t_block = _mm_loadu_si128((const __m128i *)(p_bytes + i));
+        
+        int t_mask;
+        t_mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(t_block, t_lf), _mm_cmpeq_epi8(t_block, t_cr)));
+        if (t_mask != 0)
+            return i + __builtin_ctz(t_mask);
+    }
+#endif
+    for (; i < p_count; i++)
+        if (p_bytes[i] == '\n' || p_bytes[i] == '\r')
+            return i;
+    return p_count;
+}
+
+// Find the offset of the first complete occurrence of the encoded sentinel
+// in p_bytes, or of the first LF or CR if p_line_end. Returns p_count if
+// there is none.
+static uindex_t MCFilesFindSentinel(intenum_t p_encoding, const byte_t *p_bytes, uindex_t p_count, const byte_t *p_sentinel, uindex_t p_sentinel_size, bool p_line_end)
+{
+    if (MCFilesTextUnitSize(p_encoding) == 1)
+    {
+        if (p_line_end)
+            return MCFilesFindLineEnd(p_bytes, p_count);
+        
+        const byte_t *t_from, *t_end;
+        t_from = p_bytes;
+        t_end = p_bytes + p_count;
+        while (t_end - t_from >= (ptrdiff_t)p_sentinel_size)
+        {
+            const byte_t *t_match;
+            t_match = (const byte_t *)memchr(t_from, p_sentinel[0], t_end - t_from - p_sentinel_size + 1);
+            if (t_match == nil)
+                break;
+            if (memcmp(t_match, p_sentinel, p_sentinel_size) == 0)
+                return t_match - p_bytes;
+            t_from = t_match + 1;
+        }
+        return p_count;
+    }
+    
+    for (uindex_t i = 0; i + 2 <= p_count; i += 2)
+    {
+        if (p_line_end)
+        {
+            unichar_t t_unit;
+            t_unit = MCFilesFetchUTF16Unit(p_encoding, p_bytes + i);
+            if (t_unit == '\n' || t_unit == '\r')
+                return i;
+        }
+        else if (i + p_sentinel_size <= p_count &&
+                 memcmp(p_bytes + i, p_sentinel, p_sentinel_size) == 0)
+            return i;
+    }
+    return p_count;
+}
+
+// A sentinel can be found by searching the bytes read when it is made of
+// ASCII chars which no other char normalizes to. Sentinels which start with
+// return (other than return itself) also match a lone CR, which is left to
+// the code unit reader. So are longer sentinels in UTF-8 files, as the
+// invalid bytes which decoding skips may fall between their chars.
+static bool MCFilesIsBufferedSentinel(MCStringRef p_sentinel, intenum_t p_encoding)
+{
+    uindex_t t_length;
+    t_length = MCStringGetLength(p_sentinel);
+    if (t_length > 1 &&
+        (p_encoding == kMCFileEncodingUTF8 || MCStringGetCharAtIndex(p_sentinel, 0) == '\n'))
+        return false;
+    
+    for (uindex_t i = 0; i < t_length; i++)
+    {
+        unichar_t t_char;
+        t_char = MCStringGetCharAtIndex(p_sentinel, i);
+        if (t_char >= 0x80 || t_char == 'K' || t_char == ';' || t_char == '`')
+            return false;
+    }
+    return true;
+}
+
+// Read text from a buffered file up to and including the p_count'th
+// occurrence of p_sentinel, or whatever is available if the sentinel is
+// empty. As with the code unit reader, a CR or CR LF ends a line when the
+// sentinel is return, and a CR LF is read as a return.
+static void MCFilesExecPerformBufferedReadTextUntil(MCExecContext& ctxt, MCBufferedFileHandle *p_stream, int4 p_index, uint4 p_count, MCStringRef p_sentinel, real8 p_duration, intenum_t p_encoding, MCStringRef x_output, IO_stat& r_stat)
+{
+    uindex_t t_unit_size;
+    t_unit_size = MCFilesTextUnitSize(p_encoding);
+    
+    bool t_line_end;
+    t_line_end = MCStringIsEqualToCString(p_sentinel, "\n", kMCStringOptionCompareExact);
+    
+    // Encode the sentinel as it appears in the file.
+    uindex_t t_sentinel_size;
+    t_sentinel_size = MCStringGetLength(p_sentinel) * t_unit_size;
+    
+    MCAutoByteArray t_sentinel;
+    if (!t_sentinel . New(t_sentinel_size))
+    {
+        r_stat = IO_ERROR;
+        return;
+    }
+    for (uindex_t i = 0; i < MCStringGetLength(p_sentinel); i++)
+    {
+        unichar_t t_char;
+        t_char = MCStringGetCharAtIndex(p_sentinel, i);
+        if (t_unit_size == 1)
+            t_sentinel . Bytes()[i] = (byte_t)t_char;
+        else
+        {
+            if (p_encoding == kMCFileEncodingUTF16BE)
+                t_char = MCSwapInt16HostToBig(t_char);
+            memcpy(t_sentinel . Bytes() + i * 2, &t_char, 2);
+        }
+    }
+    
+    IO_stat t_stat;
+    t_stat = IO_NORMAL;
+    
+    bool t_at_end, t_looked_ahead, t_success;
+    t_at_end = false;
+    t_looked_ahead = false;
+    t_success = true;
+    while (t_success && p_count != 0)
+    {
+        const byte_t *t_bytes;
+        uindex_t t_available;
+        t_bytes = p_stream -> GetBytes();
+        t_available = p_stream -> GetByteCount();
+        
+        uindex_t t_found;
+        t_found = t_available;
+        if (t_sentinel_size != 0)
+            t_found = MCFilesFindSentinel(p_encoding, t_bytes, t_available, t_sentinel . Bytes(), t_sentinel_size, t_line_end);
+        
+        // The text before a sentinel is always followed by an ASCII char,
+        // so any incomplete sequence at its end is decoded as it stands.
+        if (t_found != t_available)
+        {
+            uindex_t t_end;
+            t_end = t_found + t_sentinel_size;
+            if (t_line_end && MCFilesFetchTextUnit(p_encoding, t_bytes + t_found) == '\r')
+            {
+                if (t_end + t_unit_size > t_available && !t_at_end && !t_looked_ahead)
+                {
+                    // Look for an LF following the CR, without waiting for
+                    // one.
+                    t_success = MCFilesAppendBufferedText(p_stream, p_encoding, t_found, true, x_output);
+                    
+                    uint32_t t_read;
+                    p_stream -> Fill(t_read);
+                    if (t_read == 0)
+                    {
+                        t_at_end = p_stream -> IsExhausted();
+                        t_looked_ahead = true;
+                    }
+                    continue;
+                }
+                
+                if (t_end + t_unit_size <= t_available &&
+                    MCFilesFetchTextUnit(p_encoding, t_bytes + t_end) == '\n')
+                {
+                    t_success = MCFilesAppendBufferedText(p_stream, p_encoding, t_found, true, x_output) &&
+                                MCStringAppendNativeChar(x_output, '\n');
+                    p_stream -> Consume(2 * t_unit_size);
+                }
+                else
+                    t_success = MCFilesAppendBufferedText(p_stream, p_encoding, t_end, true, x_output);
+            }
+            else
+                t_success = MCFilesAppendBufferedText(p_stream, p_encoding, t_end, true, x_output);
+            
+            t_looked_ahead = false;
+            p_count -= 1;
+            continue;
+        }
+        
+        // Decode everything except for bytes which might start a sentinel.
+        uindex_t t_keep;
+        t_keep = 0;
+        if (!t_at_end && t_sentinel_size > t_unit_size)
+            t_keep = t_sentinel_size - t_unit_size;
+        if (t_available > t_keep)
+            t_success = MCFilesAppendBufferedText(p_stream, p_encoding, t_available - t_keep, t_at_end, x_output);
+        
+        if (t_at_end)
+        {
+            t_stat = IO_EOF;
+            break;
+        }
+        
+        uint32_t t_read;
+        bool t_filled;
+        t_filled = p_stream -> Fill(t_read);
+        if (t_read != 0)
+            continue;
+        
+        if (p_stream -> IsExhausted())
+        {
+            t_at_end = true;
+            continue;
+        }
+        
+        // Reading until empty stops when there is nothing more to read.
+        if (t_sentinel_size == 0)
+            break;
+        
+        if (!t_filled)
+            t_stat = IO_ERROR;
+        MCFilesExecPerformWait(ctxt, p_index, p_duration, t_stat);
+        if (t_stat != IO_NORMAL)
+            break;
+    }
+    
+    if (!t_success)
+        t_stat = IO_ERROR;
+    
+    r_stat = t_stat;
+}
+
+// Read p_count code units, codepoints or chars from a buffered UTF-8 or
+// UTF-16 file. As with the code unit reader, a code unit of a UTF-8 file is
+// a whole codepoint.
+static void MCFilesExecPerformBufferedReadUnicodeFor(MCExecContext& ctxt, MCBufferedFileHandle *p_stream, int4 p_index, int p_unit_type, uint4 p_count, real8 p_duration, intenum_t p_encoding, MCStringRef x_output, IO_stat& r_stat)
+{
+    IO_stat t_stat;
+    t_stat = IO_NORMAL;
+    
+    bool t_pair_surrogates;
+    t_pair_surrogates = p_unit_type != FU_CODEUNIT || p_encoding == kMCFileEncodingUTF8;
+    
+    bool t_at_end, t_success;
+    t_at_end = false;
+    t_success = true;
+    
+    uindex_t t_remaining;
+    t_remaining = p_count;
+    while (t_success && t_remaining != 0)
+    {
+        uindex_t t_available;
+        t_available = p_stream -> GetByteCount();
+        if (t_available != 0)
+        {
+            MCAutoArray<unichar_t> t_chars;
+            if (!t_chars . New(t_available + 1))
+            {
+                t_success = false;
+                break;
+            }
+            
+            uindex_t t_used, t_char_count, t_taken;
+            if (p_unit_type == FU_CHARACTER)
+            {
+                uindex_t t_codepoint_count;
+                MCFilesDecodeText(p_encoding, p_stream -> GetBytes(), t_available, t_at_end, UINDEX_MAX, true, t_chars . Ptr(), t_char_count, t_codepoint_count);
+                
+                MCAutoStringRef t_text;
+                MCRange t_range;
+                if (!MCStringCreateWithChars(t_chars . Ptr(), t_char_count, &t_text) ||
+                    !MCStringUnmapIndices(*t_text, kMCCharChunkTypeGrapheme, MCRangeMake(0, t_char_count), t_range))
+                {
+                    t_success = false;
+                    break;
+                }
+                
+                // The last char may continue in bytes still to come, unless
+                // it fills the buffer by itself.
+                t_taken = t_range . length;
+                if (!t_at_end && t_taken != 0 && !(t_taken == 1 && p_stream -> IsFull()))
+                    t_taken -= 1;
+                t_taken = MCMin(t_taken, t_remaining);
+                
+                if (!MCStringMapIndices(*t_text, kMCCharChunkTypeGrapheme, MCRangeMake(0, t_taken), t_range))
+                {
+                    t_success = false;
+                    break;
+                }
+                
+                // Decode again, up to the last codepoint of the chars taken,
+                // to find how many bytes they use.
+                t_codepoint_count = 0;
+                for (uindex_t i = 0; i < t_range . length; i++)
+                    if (!MCUnicodeCodepointIsLowSurrogate(t_chars[i]) ||
+                        i == 0 || !MCUnicodeCodepointIsHighSurrogate(t_chars[i - 1]))
+                        t_codepoint_count += 1;
+                
+                t_used = MCFilesDecodeText(p_encoding, p_stream -> GetBytes(), t_available, t_at_end, t_codepoint_count, true, t_chars . Ptr(), t_char_count, t_codepoint_count);
+            }
+            else
+                t_used = MCFilesDecodeText(p_encoding, p_stream -> GetBytes(), t_available, t_at_end, t_remaining, t_pair_surrogates, t_chars . Ptr(), t_char_count, t_taken);
+            
+            if (!MCStringAppendChars(x_output, t_chars . Ptr(), t_char_count))
+            {
+                t_success = false;
+                break;
+            }
+            
+            p_stream -> Consume(t_used);
+            t_remaining -= t_taken;
+            if (t_taken != 0)
+                continue;
+        }
+        
+        if (t_at_end)
+        {
+            t_stat = IO_EOF;
+            break;
+        }
+        
+        uint32_t t_read;
+        bool t_filled;
+        t_filled = p_stream -> Fill(t_read);
+        if (t_read != 0)
+            continue;
+        
+        if (p_stream -> IsExhausted())
+        {
+            t_at_end = true;
+            continue;
+        }
+        
+        if (!t_filled)
+            t_stat = IO_ERROR;
+        MCFilesExecPerformWait(ctxt, p_index, p_duration, t_stat);
+        if (t_stat != IO_NORMAL)
+            break;
+    }
+    
+    if (!t_success)
+        t_stat = IO_ERROR;
+    
+    r_stat = t_stat;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// The text of a file which is iterated over by 'repeat for each line' is
+// decoded and has its line endings normalized as when it is fetched with
+// url "file:", but a block at a time. The window of decoded text holds the
+// chunks which have not yet been handed out.
+
+MCTextChunkIterator_File::MCTextChunkIterator_File(MCSystemFileHandle *p_stream, intenum_t p_encoding, MCChunkType p_chunk_type, MCStringRef p_delimiter)
+    : MCTextChunkIterator_Delimited(kMCEmptyString, p_chunk_type, p_delimiter)
+{
+    m_stream = p_stream;
+    m_encoding = p_encoding;
+    m_at_end = false;
+    m_pending_return = false;
+    m_failed = false;
+    m_search_offset = 0;
+    
+    // The window is filled on the first call to Next().
+    m_exhausted = false;
+    
+    MCStringRef t_window;
+    if (MCStringCreateMutable(0, t_window))
+        MCValueAssignAndRelease(m_text, t_window);
+    else
+        m_failed = true;
+}
+
+MCTextChunkIterator_File::~MCTextChunkIterator_File()
+{
+    if (m_stream != nil)
+        m_stream -> Close();
+}
+
+// Drop the first p_consumed chars of the window, and append the next block
+// of the file's text to it.
+bool MCTextChunkIterator_File::Refill(uindex_t p_consumed)
+{
+    if (p_consumed != 0 && !MCStringRemove(m_text, MCRangeMake(0, p_consumed)))
+        return false;
+    
+    m_range = MCRangeMake(0, 0);
+    m_first_chunk = true;
+    
+    MCBufferedFileHandle *t_buffer;
+    t_buffer = m_stream -> GetReadBuffer();
+    
+    uint32_t t_read;
+    t_buffer -> Fill(t_read);
+    if (t_read == 0)
+    {
+        if (!t_buffer -> IsExhausted())
+            return false;
+        m_at_end = true;
+    }
+    
+    MCAutoStringRef t_block;
+    if (!MCStringCreateMutable(0, &t_block))
+        return false;
+    
+    if (m_pending_return && !MCStringAppendNativeChar(*t_block, '\r'))
+        return false;
+    m_pending_return = false;
+    
+    uindex_t t_count;
+    t_count = t_buffer -> GetByteCount();
+    if (MCFilesIsBufferedTextEncoding(m_encoding))
+    {
+        if (!MCFilesAppendBufferedText(t_buffer, m_encoding, t_count, m_at_end, *t_block))
+            return false;
+    }
+    else
+    {
+        // UTF-32 text is decoded a whole code unit at a time.
+        if (!m_at_end)
+            t_count -= t_count % 4;
+        
+        MCAutoStringRef t_text;
+        if (!MCStringCreateWithBytes(t_buffer -> GetBytes(), t_count, MCS_file_to_string_encoding((MCFileEncodingType)m_encoding), false, &t_text) ||
+            !MCStringAppend(*t_block, *t_text))
+            return false;
+        t_buffer -> Consume(t_count);
+    }
+    
+    // Hold back a return at the end of the block, as it may be the first
+    // half of a CRLF.
+    uindex_t t_length;
+    t_length = MCStringGetLength(*t_block);
+    if (!m_at_end && t_length != 0 && MCStringGetCharAtIndex(*t_block, t_length - 1) == '\r')
+    {
+        if (!MCStringRemove(*t_block, MCRangeMake(t_length - 1, 1)))
+            return false;
+        m_pending_return = true;
+    }
+    
+    MCAutoStringRef t_normalized;
+    if (!MCStringNormalizeLineEndings(*t_block,
+                                      kMCStringLineEndingStyleLF,
+                                      kMCStringLineEndingOptionNormalizePSToLineEnding |
+                                      kMCStringLineEndingOptionNormalizeLSToVT,
+                                      &t_normalized,
+                                      nullptr) ||
+        !MCStringAppend(m_text, *t_normalized))
+        return false;
+    
+    m_length = MCStringGetLength(m_text);
+    return true;
+}
+
+bool MCTextChunkIterator_File::Next()
+{
+    while (!m_failed)
+    {
+        uindex_t t_offset = m_range . offset + m_range . length;
+        
+        if (!m_first_chunk)
+            t_offset += m_delimiter_length;
+        
+        // The text which was searched before the last refill does not
+        // contain the delimiter, so is not searched again.
+        uindex_t t_search_offset;
+        t_search_offset = MCMax(t_offset, m_search_offset);
+        
+        MCRange t_found_range;
+        bool t_found;
+        t_found = t_search_offset < m_length &&
+                  MCStringFind(m_text, MCRangeMakeMinMax(t_search_offset, m_length), m_delimiter, m_options, &t_found_range);
+        
+        // Until the end of the file has been read, a chunk is only handed
+        // out once there is text after its delimiter, so that whether it is
+        // the last chunk is known.
+        if (!m_at_end &&
+            (!t_found || t_found_range . offset + t_found_range . length == m_length))
+        {
+            // Resume the search at the delimiter found, or far enough back
+            // from the end of the window to find one which is split across
+            // the refill.
+            uindex_t t_resume;
+            if (t_found)
+                t_resume = t_found_range . offset;
+            else
+                t_resume = m_length - MCMin(m_length, MCStringGetLength(m_delimiter));
+            t_resume = MCMax(t_resume, t_offset);
+            
+            if (!Refill(t_offset))
+                m_failed = true;
+            m_search_offset = t_resume - t_offset;
+            continue;
+        }
+        
+        if (t_offset >= m_length)
+            return false;
+        
+        m_range . offset = t_offset;
+        m_first_chunk = false;
+        m_search_offset = 0;
+        
+        if (!t_found)
+        {
+            m_range . length = m_length - m_range . offset;
+            m_exhausted = true;
+        }
+        else
+        {
+            m_range . length = t_found_range . offset - m_range . offset;
+            m_delimiter_length = t_found_range . length;
+            
+            if (t_found_range . offset + t_found_range . length == m_length)
+                m_exhausted = true;
+        }
+        
+        return true;
+    }
+    
+    return false;
+}
+
+MCTextChunkIterator_File *MCFilesTextChunkIteratorCreate(MCExecContext& ctxt, MCStringRef p_filename, Chunk_term p_chunk_type)
+{
+    if (!MCSecureModeCanAccessDisk())
+    {
+        ctxt . LegacyThrow(EE_DISK_NOPERM);
+        return nil;
+    }
+    
+    // The file is read rather than mapped, so that only a block of it is in
+    // memory at a time.
+    IO_handle t_stream;
+    t_stream = MCS_open(p_filename, kMCOpenFileModeRead, False, False, 0);
+    if (t_stream == nil)
+    {
+        ctxt . LegacyThrow(EE_REPEAT_BADFILE, p_filename);
+        return nil;
+    }
+    
+    MCBufferedFileHandle *t_buffer;
+    t_buffer = new (nothrow) MCBufferedFileHandle(t_stream);
+    if (t_buffer == nil)
+    {
+        MCS_close(t_stream);
+        ctxt . LegacyThrow(EE_NO_MEMORY);
+        return nil;
+    }
+    
+    // Text files are native unless they start with a byte order mark.
+    uint32_t t_read;
+    do
+        t_buffer -> Fill(t_read);
+    while (t_read != 0 && t_buffer -> GetByteCount() < 4);
+    
+    uint32_t t_bom_size;
+    MCFileEncodingType t_encoding;
+    t_encoding = MCS_resolve_BOM_from_bytes(const_cast<byte_t *>(t_buffer -> GetBytes()), t_buffer -> GetByteCount(), t_bom_size);
+    t_buffer -> Consume(t_bom_size);
+    
+    MCStringRef t_delimiter;
+    t_delimiter = p_chunk_type == CT_LINE ? ctxt . GetLineDelimiter() : ctxt . GetItemDelimiter();
+    
+    MCTextChunkIterator_File *t_iterator;
+    t_iterator = new (nothrow) MCTextChunkIterator_File(t_buffer, t_encoding, MCChunkTypeFromChunkTerm(p_chunk_type), t_delimiter);
+    if (t_iterator == nil)
+    {
+        t_buffer -> Close();
+        ctxt . LegacyThrow(EE_NO_MEMORY);
+        return nil;
+    }
+    
+    return t_iterator;
+}
+
 /*
  *  This function comes to read an unpredictable amount of bytes for the number of units asked,
  *  depending of the encoding in use and of the way the characters are encoded
@@ -1548,6 +2368,17 @@ void MCFilesExecPerformReadUnicodeFor(MCExecContext& ctxt, IO_handle p_stream, i
     MCAutoStringRef t_output;
     MCStringCreateMutable(0, &t_output);
 
+    // Text in UTF-8 and UTF-16 files is decoded in bulk.
+    MCBufferedFileHandle *t_buffer;
+    t_buffer = p_stream != NULL ? p_stream -> GetReadBuffer() : nil;
+    if (t_buffer != nil && p_encoding != kMCFileEncodingNative && MCFilesIsBufferedTextEncoding(p_encoding))
+    {
+        MCFilesExecPerformBufferedReadUnicodeFor(ctxt, t_buffer, p_index, p_unit_type, p_count, t_duration, p_encoding, *t_output, r_stat);
+        if (!MCStringCopy(*t_output, r_output))
+            r_stat = IO_ERROR;
+        return;
+    }
+
     uint4 t_last_char_boundary = 0;
     uint4 t_progress = 0;
     IO_stat t_stat;
@@ -1598,6 +2429,20 @@ void MCFilesExecPerformReadTextUntil(MCExecContext& ctxt, IO_handle p_stream, in
         return;
     }
 
+    // Text in native, UTF-8 and UTF-16 files is decoded in bulk, and the
+    // sentinel searched for in the bytes read, when the sentinel does not
+    // need to be compared with normalized text.
+    MCBufferedFileHandle *t_buffer;
+    t_buffer = p_stream != NULL ? p_stream -> GetReadBuffer() : nil;
+    if (t_buffer != nil && !words && MCFilesIsBufferedTextEncoding(p_encoding) &&
+        MCFilesIsBufferedSentinel(p_sentinel, p_encoding))
+    {
+        MCFilesExecPerformBufferedReadTextUntil(ctxt, t_buffer, p_index, p_count, p_sentinel, t_duration, p_encoding, *t_output, r_stat);
+        if (!MCStringCopy(*t_output, r_output))
+            r_stat = IO_ERROR;
+        return;
+    }
+
     uint4 t_last_char_boundary = 0;
     Boolean doingspace = True;
     IO_stat t_stat = IO_NORMAL;
@@ -73,166 +73,40 @@ bool MCFiltersMacToIso(MCDataRef p_source, MCDataRef &r_result)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-static const char * const url_table[256] =
-    {
-        "%00", "%01", "%02", "%03", "%04", "%05", "%06", "%07", "%08", "%09",
-        "%0D%0A", "%0B", "%0C", "%0D", "%0E", "%0F", "%10", "%11", "%12",
-        "%13", "%14", "%15", "%16", "%17", "%18", "%19", "%1A", "%1B", "%1C",
-        "%1D", "%1E", "%1F", "+", "%21", "%22", "%23", "%24", "%25", "%26",
-        "%27", "%28", "%29", "*", "%2B", "%2C", "-", ".", "%2F", "0", "1",
-        "2", "3", "4", "5", "6", "7", "8", "9", "%3A", "%3B", "%3C", "%3D",
-        "%3E", "%3F", "%40", "A", "B", "C", "D", "E", "F", "G", "H", "I", "J",
-        "K", "L", "M", "N", "O", "P", "Q", "R", "S", "T", "U", "V", "W", "X",
-        "Y", "Z", "%5B", "%5C", "%5D", "%5E", "_", "%60", "a", "b", "c", "d",
-        "e", "f", "g", "h", "i", "j", "k", "l", "m", "n", "o", "p", "q", "r",
-        "s", "t", "u", "v", "w", "x", "y", "z", "%7B", "%7C", "%7D", "%7E",
-        "%7F", "%80", "%81", "%82", "%83", "%84", "%85", "%86", "%87", "%88",
-        "%89", "%8A", "%8B", "%8C", "%8D", "%8E", "%8F", "%90", "%91", "%92",
-        "%93", "%94", "%95", "%96", "%97", "%98", "%99", "%9A", "%9B", "%9C",
-        "%9D", "%9E", "%9F", "%A0", "%A1", "%A2", "%A3", "%A4", "%A5", "%A6",
-        "%A7", "%A8", "%A9", "%AA", "%AB", "%AC", "%AD", "%AE", "%AF", "%B0",
-        "%B1", "%B2", "%B3", "%B4", "%B5", "%B6", "%B7", "%B8", "%B9", "%BA",
-        "%BB", "%BC", "%BD", "%BE", "%BF", "%C0", "%C1", "%C2", "%C3", "%C4",
-        "%C5", "%C6", "%C7", "%C8", "%C9", "%CA", "%CB", "%CC", "%CD", "%CE",
-        "%CF", "%D0", "%D1", "%D2", "%D3", "%D4", "%D5", "%D6", "%D7", "%D8",
-        "%D9", "%DA", "%DB", "%DC", "%DD", "%DE", "%DF", "%E0", "%E1", "%E2",
-        "%E3", "%E4", "%E5", "%E6", "%E7", "%E8", "%E9", "%EA", "%EB", "%EC",
-        "%ED", "%EE", "%EF", "%F0", "%F1", "%F2", "%F3", "%F4", "%F5", "%F6",
-        "%F7", "%F8", "%F9", "%FA", "%FB", "%FC", "%FD", "%FE", "%FF"
-    };
-
 bool MCFiltersUrlEncode(MCStringRef p_source, bool p_use_utf8, MCStringRef& r_result)
 {
-    char *t_chars;
-    uint4 l;
-    int4 size;
-
     // SN-2014-11-13: [[ Bug 14015 ]] If specified, we don't want to nativise the string,
     // but rather to encode it in UTF-8 and write the bytes (a '%' will be added).
     if (p_use_utf8)
     {
-        if (!MCStringConvertToUTF8(p_source, t_chars, l))
+        MCAutoStringRefAsUTF8String t_utf8_string;
+        if (!t_utf8_string . Lock(p_source))
             return false;
 
-        size = l + 1;
+        return MCFiltersUrlEncodeBytes((const byte_t *)*t_utf8_string, t_utf8_string . Size(), r_result);
     }
-    else
-    {
-        if (!MCStringConvertToNative(p_source, (char_t*&)t_chars, l))
-            return false;
-        size = strlen(t_chars);
-    }
-
-    // AL-2015-02-13: [[ Bug 14602 ]] Use copy of t_chars ptr for iteration so it can be freed properly.
-    const char *t_chars_iter = t_chars;
-    size = l + 1;
-    size += size / 4;
 
-    bool t_success;
-    t_success = true;
-    
-	MCAutoNativeCharArray buffer;
-    t_success = buffer . New(size);
-
-    if (t_success)
-    {
-        char_t *dptr;
-        dptr = buffer . Chars();
-        while (l--)
-        {
-            if (dptr - buffer . Chars() + 7 > size)
-            {
-                uint4 newsize = size + size / 4 + 7;
-                uint4 offset = dptr - buffer . Chars();
-                if (!buffer . Extend(newsize))
-                {
-                    t_success = false;
-                    break;
-                }
-                
-                dptr = buffer . Chars() + offset;
-                size = newsize;
-            }
-            const char_t *sptr = (const char_t *)url_table[(uint1)*t_chars_iter++];
-            do
-            {
-                *dptr++ = *sptr++;
-            }
-            while (*sptr);
-        }
-        buffer . Shrink(dptr - buffer . Chars());
-    }
-
-    MCMemoryDeleteArray(t_chars);
-    if (!t_success)
+    MCAutoStringRefAsNativeChars t_native;
+    const char_t *t_chars;
+    uindex_t t_length;
+    if (!t_native . Lock(p_source, t_chars, t_length))
         return false;
-    
-	return buffer . CreateStringAndRelease(r_result);
+
+    return MCFiltersUrlEncodeBytes(t_chars, t_length, r_result);
 }
 
 bool MCFiltersUrlDecode(MCStringRef p_source, bool p_use_utf8, MCStringRef& r_result)
 {
     // SN-2014-11-13: [[ Bug 14015 ]] If specified, we don't want to use a nativised string, but
     // bytes, as we can get UTF-8 characters (now usable in 7.0)
-    MCAutoByteArray t_buffer;
-    char_t *t_srcptr;
-    uindex_t t_srclen;
-
-    if (!MCStringConvertToNative(p_source, t_srcptr, t_srclen))
-        return false;
-
-    if (!t_buffer . New(t_srclen))
-    {
-        MCMemoryDeleteArray(t_srcptr);
+    MCAutoStringRefAsNativeChars t_native;
+    const char_t *t_chars;
+    uindex_t t_length;
+    if (!t_native . Lock(p_source, t_chars, t_length))
         return false;
-    }
-
-	const uint1 *sptr = (uint1 *)t_srcptr;
-    const uint1 *eptr = sptr + t_srclen;
-    uint1 *dptr = (uint1*)t_buffer . Bytes();
-	while (sptr < eptr)
-	{
-		if (*sptr == '%')
-		{
-            uint1 source = MCS_toupper(*++sptr);
-			uint1 value = 0;
-			if (isdigit(source))
-				value = (source - '0') << 4;
-			else
-				if (source >= 'A' && source <= 'F')
-					value = (source - 'A' + 10) << 4;
-			source = MCS_toupper(*++sptr);
-			if (isdigit(source))
-				value += source - '0';
-			else
-				if (source >= 'A' && source <= 'F')
-					value += source - 'A' + 10;
-			if (value != 13)
-				*dptr++ = value;
-		}
-		else
-			if (*sptr == '+')
-				*dptr++ = ' ';
-			else
-				if (*sptr == '\r')
-				{
-					if (*(sptr + 1) == '\n')
-						sptr++;
-					*dptr++ = '\n';
-				}
-				else
-					*dptr++ = *sptr;
-		sptr++;
-	}
-    t_buffer.Shrink(dptr - t_buffer.Bytes());
-
-    MCMemoryDeleteArray(t_srcptr);
 
     // SN-2014-11-13: [[ Bug 14015 ]] The string might be explicitely UTF-8 encoded.
-    if (p_use_utf8)
-        return MCStringCreateWithBytes(t_buffer . Bytes(), t_buffer.ByteCount(), kMCStringEncodingUTF8, false, r_result);
-    else
-        return MCStringCreateWithBytes(t_buffer . Bytes(), t_buffer.ByteCount(), kMCStringEncodingNative, false, r_result);
+    return MCFiltersUrlDecodeChars(t_chars, t_length, p_use_utf8 ? kMCStringEncodingUTF8 : kMCStringEncodingNative, r_result);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -243,6 +117,19 @@ void MCFiltersEvalCompress(MCExecContext& ctxt, MCDataRef p_source, MCDataRef& r
 		ctxt.LegacyThrow(EE_COMPRESS_ERROR);
 }
 
+void MCFiltersEvalCompressWithLevel(MCExecContext& ctxt, MCDataRef p_source, integer_t p_level, MCDataRef& r_result)
+{
+	if (p_level != kMCFiltersCompressionLevelDefault &&
+		(p_level < 0 || p_level > kMCFiltersCompressionLevelMax))
+	{
+		ctxt.LegacyThrow(EE_COMPRESS_BADLEVEL);
+		return;
+	}
+
+	if (!MCFiltersCompressWithLevel(p_source, p_level, r_result))
+		ctxt.LegacyThrow(EE_COMPRESS_ERROR);
+}
+
 void MCFiltersEvalDecompress(MCExecContext& ctxt, MCDataRef p_source, MCDataRef& r_result)
 {
 	if (!MCFiltersIsCompressed(p_source))
@@ -381,6 +381,21 @@ void MCControl::SetLayerClipRect(MCExecContext& ctxt, MCRectangle* p_layer_clip_
     }
 }
 
+void MCControl::GetLayerCache(MCExecContext& ctxt, bool& r_setting)
+{
+    r_setting = m_layer_use_cache;
+}
+
+void MCControl::SetLayerCache(MCExecContext& ctxt, bool p_setting)
+{
+    if (m_layer_use_cache == p_setting)
+        return;
+    
+    m_layer_use_cache = p_setting;
+    if (!m_layer_use_cache)
+        layer_discardcache();
+}
+
 void MCControl::SetMargins(MCExecContext& ctxt, const MCInterfaceMargins& p_margins)
 {
     if (p_margins . type == kMCInterfaceMarginsTypeSingle)
@@ -40,6 +40,7 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 #include "exec-interface.h"
 #include "graphics_util.h"
+#include "pixelkernels.h"
 #include "module-canvas.h"
 
 //////////
@@ -482,16 +483,8 @@ void MCImage::GetImageData(MCExecContext& ctxt, MCDataRef& r_data)
             
             if (t_success)
             {
-                MCMemoryCopy(t_data_ptr, t_bitmap->data, t_data_size);
                 // IM-2013-09-16: [[ RefactorGraphics ]] [[ Bug 11185 ]] Use correct pixel format (xrgb) for imagedata
-#if (kMCGPixelFormatNative != kMCGPixelFormatARGB)
-                while (t_pixel_count--)
-                {
-                    uint8_t t_r, t_g, t_b, t_a;
-                    MCGPixelUnpackNative(*t_data_ptr, t_r, t_g, t_b, t_a);
-                    *t_data_ptr++ = MCGPixelPack(kMCGPixelFormatARGB, t_r, t_g, t_b, t_a);
-                }
-#endif
+                MCPixelRowSwizzle(t_bitmap->data, kMCGPixelFormatNative, t_data_ptr, kMCGPixelFormatARGB, t_pixel_count);
             }
             
             if (m_rep->GetType() == kMCImageRepMutable)
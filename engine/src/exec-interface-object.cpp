@@ -1289,6 +1289,10 @@ MCExecEnumTypeInfo *kMCInterfaceScriptStatusTypeInfo = &_kMCInterfaceScriptStatu
 
 void MCObject::Redraw(void)
 {
+	// The controls within this object may inherit the property which changed,
+	// so must not be drawn from their layer caches.
+	MCRedrawFlushLayerCachesWithin(this);
+	
 	if (!opened)
 		return;
 	
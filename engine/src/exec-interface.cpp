@@ -3810,6 +3810,24 @@ void MCInterfaceExecImportObjectFromArray(MCExecContext& ctxt, MCArrayRef p_arra
 
 ////////////////////////////////////////////////////////////////////////////////
 
+static MCImagePaletteSettings *MCInterfaceGetImagePaletteSettings(MCInterfaceImagePaletteSettings *p_palette, MCImagePaletteSettings& r_settings)
+{
+	if (p_palette == nil)
+		return nil;
+
+	r_settings . type = p_palette -> type;
+	if (p_palette -> type == kMCImagePaletteTypeCustom)
+	{
+		r_settings . colors = p_palette -> custom . colors;
+		r_settings . ncolors = p_palette -> custom . count;
+	}
+	else if (p_palette -> type == kMCImagePaletteTypeOptimal)
+		r_settings . ncolors = p_palette -> optimal . palette_size;
+	else
+		r_settings . ncolors = 0;
+	return &r_settings;
+}
+
 void MCInterfaceExportBitmap(MCExecContext &ctxt, MCImageBitmap *p_bitmap, int p_format, MCInterfaceImagePaletteSettings *p_palette, bool p_dither, MCImageMetadata* p_metadata, MCDataRef &r_data)
 {
     if (p_bitmap == nil)
@@ -3818,21 +3836,8 @@ void MCInterfaceExportBitmap(MCExecContext &ctxt, MCImageBitmap *p_bitmap, int p
 	bool t_success = true;
 	
 	MCImagePaletteSettings t_palette_settings;
-	MCImagePaletteSettings *t_ps_ptr = nil;
-	if (p_palette != nil)
-	{
-		t_palette_settings . type = p_palette -> type;
-		if (p_palette -> type == kMCImagePaletteTypeCustom)
-		{
-			t_palette_settings . colors = p_palette -> custom . colors;
-			t_palette_settings . ncolors = p_palette -> custom . count;
-		}
-		else if (p_palette -> type == kMCImagePaletteTypeOptimal)
-			t_palette_settings . ncolors = p_palette -> optimal . palette_size;
-		else
-			t_palette_settings . ncolors = 0;
-		t_ps_ptr = &t_palette_settings;
-	}
+	MCImagePaletteSettings *t_ps_ptr;
+	t_ps_ptr = MCInterfaceGetImagePaletteSettings(p_palette, t_palette_settings);
 	
 	IO_handle t_stream = nil;
 	t_stream = MCS_fakeopenwrite();
@@ -3896,21 +3901,8 @@ void MCInterfaceExportBitmapToFile(MCExecContext& ctxt, MCImageBitmap *p_bitmap,
 	}
 	
 	MCImagePaletteSettings t_palette_settings;
-	MCImagePaletteSettings *t_ps_ptr = nil;
-	if (p_palette != nil)
-	{
-		t_palette_settings . type = p_palette -> type;
-		if (p_palette -> type == kMCImagePaletteTypeCustom)
-		{
-			t_palette_settings . colors = p_palette -> custom . colors;
-			t_palette_settings . ncolors = p_palette -> custom . count;
-		}
-		else if (p_palette -> type == kMCImagePaletteTypeOptimal)
-			t_palette_settings . ncolors = p_palette -> optimal . palette_size;
-		else
-			t_palette_settings . ncolors = 0;
-		t_ps_ptr = &t_palette_settings;
-	}
+	MCImagePaletteSettings *t_ps_ptr;
+	t_ps_ptr = MCInterfaceGetImagePaletteSettings(p_palette, t_palette_settings);
 	
 	bool t_delete_file = false;
 	if (!MCImageExport(p_bitmap, (Export_format)p_format, t_ps_ptr, p_dither, p_metadata, t_fstream, t_mstream))
@@ -4048,6 +4040,126 @@ void MCInterfaceExecExportSnapshotOfObjectToFile(MCExecContext& ctxt, MCObject *
         MCInterfaceExportBitmapToFileAndRelease(ctxt, t_bitmap, p_format, p_palette, MCInterfaceGetDitherImage(nil), p_metadata, p_filename, p_mask_filename);
 }
 
+static bool MCInterfaceWriteExportedImage(MCExecContext& ctxt, MCStringRef p_filename, const MCImageEncodeJob& p_job)
+{
+	if (!p_job . success)
+	{
+		ctxt . LegacyThrow(EE_EXPORT_CANTWRITE);
+		return false;
+	}
+
+	IO_handle t_stream;
+	if ((t_stream = MCS_open(p_filename, kMCOpenFileModeWrite, False, False, 0)) == nil)
+	{
+		ctxt . LegacyThrow(EE_EXPORT_CANTOPEN);
+		return false;
+	}
+
+	bool t_success;
+	t_success = MCS_write(p_job . data, 1, p_job . size, t_stream) == IO_NORMAL;
+	MCS_close(t_stream);
+
+	if (!t_success)
+	{
+		MCS_unlink(p_filename);
+		ctxt . LegacyThrow(EE_EXPORT_CANTWRITE);
+	}
+
+	return t_success;
+}
+
+void MCInterfaceExecExportSnapshotsOfObjectsToFiles(MCExecContext& ctxt, MCObjectHandle *p_targets, MCStringRef *p_filenames, uindex_t p_count, MCPoint *p_at_size, int p_format, MCInterfaceImagePaletteSettings *p_palette, MCImageMetadata* p_metadata)
+{
+	if (!ctxt . EnsureDiskAccessIsAllowed())
+		return;
+
+	MCImagePaletteSettings t_palette_settings;
+	MCImagePaletteSettings *t_ps_ptr;
+	t_ps_ptr = MCInterfaceGetImagePaletteSettings(p_palette, t_palette_settings);
+
+	bool t_dither;
+	t_dither = MCInterfaceGetDitherImage(nil);
+
+	// Snapshots are taken on this thread a wave at a time. Each wave is encoded
+	// on worker threads while the next one is being taken, and its files are
+	// written once the encoding has finished. So there are never more than two
+	// waves of bitmaps in memory.
+	uindex_t t_wave_size;
+	t_wave_size = MCImageEncodeJobsGetConcurrency();
+
+	MCAutoArray<MCImageEncodeJob> t_jobs;
+	if (!t_jobs . New(2 * t_wave_size))
+	{
+		ctxt . LegacyThrow(EE_NO_MEMORY);
+		return;
+	}
+
+	MCImageEncodeJob *t_encoding = nil;
+	uindex_t t_encoding_start = 0;
+	uindex_t t_encoding_count = 0;
+
+	bool t_success;
+	t_success = true;
+
+	uindex_t t_next;
+	t_next = 0;
+	for(;;)
+	{
+		MCImageEncodeJob *t_wave;
+		t_wave = t_jobs . Ptr() + (t_encoding == t_jobs . Ptr() ? t_wave_size : 0);
+
+		uindex_t t_wave_start, t_wave_count;
+		t_wave_start = t_next;
+		t_wave_count = 0;
+		while (t_success && t_wave_count < t_wave_size && t_next < p_count)
+		{
+			MCImageBitmap *t_bitmap = nil;
+			if (!p_targets[t_next] . IsValid())
+				ctxt . LegacyThrow(EE_EXPORT_NOSELECTED);
+			else
+				t_bitmap = MCInterfaceGetSnapshotOfObjectBitmap(ctxt, p_targets[t_next], nil, false, p_at_size);
+
+			if (t_bitmap == nil)
+			{
+				t_success = false;
+				break;
+			}
+
+			MCImageEncodeJob& t_job = t_wave[t_wave_count++];
+			t_job . bitmap = t_bitmap;
+			t_job . format = (Export_format)p_format;
+			t_job . palette_settings = t_ps_ptr;
+			t_job . dither = t_dither;
+			t_job . metadata = p_metadata;
+			t_next++;
+		}
+
+		if (t_encoding_count > 0)
+		{
+			MCImageEncodeJobsFinish(t_encoding, t_encoding_count);
+			for(uindex_t i = 0; i < t_encoding_count; i++)
+			{
+				if (t_success)
+					t_success = MCInterfaceWriteExportedImage(ctxt, p_filenames[t_encoding_start + i], t_encoding[i]);
+				free(t_encoding[i] . data);
+				MCImageFreeBitmap(t_encoding[i] . bitmap);
+			}
+		}
+
+		if (!t_success || t_wave_count == 0)
+		{
+			for(uindex_t i = 0; i < t_wave_count; i++)
+				MCImageFreeBitmap(t_wave[i] . bitmap);
+			break;
+		}
+
+		MCImageEncodeJobsStart(t_wave, t_wave_count);
+		t_encoding = t_wave;
+		t_encoding_start = t_wave_start;
+		t_encoding_count = t_wave_count;
+	}
+}
+
 MCImage* MCInterfaceExecExportSelectImage(MCExecContext& ctxt)
 {
 	MCObject *optr = MCselected->getfirst();
@@ -404,6 +404,42 @@ static MCExecEnumTypeInfo _kMCInterfacePaintCompressionTypeInfo =
 
 //////////
 
+static MCExecEnumTypeElementInfo _kMCInterfacePngFilterElementInfo[] =
+{
+	{ "default", kMCImagePNGFilterDefault, false },
+	{ "none", kMCImagePNGFilterNone, false },
+	{ "sub", kMCImagePNGFilterSub, false },
+	{ "up", kMCImagePNGFilterUp, false },
+	{ "average", kMCImagePNGFilterAverage, false },
+	{ "paeth", kMCImagePNGFilterPaeth, false },
+	{ "adaptive", kMCImagePNGFilterAdaptive, false },
+};
+
+static MCExecEnumTypeInfo _kMCInterfacePngFilterTypeInfo =
+{
+	"Interface.PngFilter",
+	sizeof(_kMCInterfacePngFilterElementInfo) / sizeof(MCExecEnumTypeElementInfo),
+	_kMCInterfacePngFilterElementInfo,
+};
+
+//////////
+
+static MCExecEnumTypeElementInfo _kMCInterfaceJpegChromaSubsamplingElementInfo[] =
+{
+	{ "4:2:0", kMCImageJPEGSubsampling420, false },
+	{ "4:2:2", kMCImageJPEGSubsampling422, false },
+	{ "4:4:4", kMCImageJPEGSubsampling444, false },
+};
+
+static MCExecEnumTypeInfo _kMCInterfaceJpegChromaSubsamplingTypeInfo =
+{
+	"Interface.JpegChromaSubsampling",
+	sizeof(_kMCInterfaceJpegChromaSubsamplingElementInfo) / sizeof(MCExecEnumTypeElementInfo),
+	_kMCInterfaceJpegChromaSubsamplingElementInfo,
+};
+
+//////////
+
 static MCExecEnumTypeElementInfo _kMCInterfaceProcessTypeElementInfo[] =
 {
 	{ "background", 0, false },
@@ -453,6 +489,8 @@ MCExecEnumTypeInfo *kMCInterfaceLookAndFeelTypeInfo = &_kMCInterfaceLookAndFeelT
 MCExecCustomTypeInfo *kMCInterfaceBackdropTypeInfo = &_kMCInterfaceBackdropTypeInfo;
 MCExecCustomTypeInfo *kMCInterfaceNamedColorTypeInfo = &_kMCInterfaceNamedColorTypeInfo;
 MCExecEnumTypeInfo *kMCInterfacePaintCompressionTypeInfo = &_kMCInterfacePaintCompressionTypeInfo;
+MCExecEnumTypeInfo *kMCInterfacePngFilterTypeInfo = &_kMCInterfacePngFilterTypeInfo;
+MCExecEnumTypeInfo *kMCInterfaceJpegChromaSubsamplingTypeInfo = &_kMCInterfaceJpegChromaSubsamplingTypeInfo;
 MCExecEnumTypeInfo *kMCInterfaceProcessTypeTypeInfo = &_kMCInterfaceProcessTypeTypeInfo;
 MCExecEnumTypeInfo *kMCInterfaceSelectionModeTypeInfo = &_kMCInterfaceSelectionModeTypeInfo;
 MCExecCustomTypeInfo *kMCInterfaceStackFileVersionTypeInfo = &_kMCInterfaceStackFileVersionTypeInfo;
@@ -1755,6 +1793,46 @@ void MCInterfaceSetJpegQuality(MCExecContext& ctxt, uinteger_t p_value)
 	MCjpegquality = MCU_min(p_value, (uint4)100);
 }
 
+void MCInterfaceGetJpegProgressive(MCExecContext& ctxt, bool& r_value)
+{
+	r_value = MCjpegprogressive == True;
+}
+
+void MCInterfaceSetJpegProgressive(MCExecContext& ctxt, bool p_value)
+{
+	MCjpegprogressive = p_value ? True : False;
+}
+
+void MCInterfaceGetJpegChromaSubsampling(MCExecContext& ctxt, intenum_t& r_value)
+{
+	r_value = MCjpegchromasubsampling;
+}
+
+void MCInterfaceSetJpegChromaSubsampling(MCExecContext& ctxt, intenum_t p_value)
+{
+	MCjpegchromasubsampling = (MCImageJPEGSubsampling)p_value;
+}
+
+void MCInterfaceGetPngCompressionLevel(MCExecContext& ctxt, uinteger_t& r_value)
+{
+	r_value = MCpngcompressionlevel;
+}
+
+void MCInterfaceSetPngCompressionLevel(MCExecContext& ctxt, uinteger_t p_value)
+{
+	MCpngcompressionlevel = MCU_min(p_value, (uint4)9);
+}
+
+void MCInterfaceGetPngFilter(MCExecContext& ctxt, intenum_t& r_value)
+{
+	r_value = MCpngfilter;
+}
+
+void MCInterfaceSetPngFilter(MCExecContext& ctxt, intenum_t p_value)
+{
+	MCpngfilter = (MCImagePNGFilter)p_value;
+}
+
 void MCInterfaceGetRelayerGroupedControls(MCExecContext& ctxt, bool& r_value)
 {
 	r_value = MCrelayergrouped == True;
@@ -635,6 +635,53 @@ void MCKeywordsExecRepeatFor(MCExecContext& ctxt, MCStatement *statements, MCExp
     }
 }
 
+void MCKeywordsExecRepeatForEachInFile(MCExecContext& ctxt, MCStatement *statements, MCExpression *filename, MCVarref *loopvar, File_unit each, uint2 line, uint2 pos)
+{
+    MCAutoValueRef t_condition;
+    MCAutoStringRef t_filename;
+    if (!ctxt . TryToEvaluateExpression(filename, line, pos, EE_REPEAT_BADFORCOND, &t_condition) ||
+        !ctxt . ConvertToString(*t_condition, &t_filename))
+        return;
+    
+    MCAutoPointer<MCTextChunkIterator_File> tci;
+    tci = MCFilesTextChunkIteratorCreate(ctxt, *t_filename, each == FU_ITEM ? CT_ITEM : CT_LINE);
+    if (!tci)
+        return;
+    
+    bool done;
+    done = false;
+    
+    while (!done)
+    {
+        MCAutoStringRef t_unit;
+        if (!MCStringsTextChunkIteratorNext(ctxt, *tci))
+        {
+            if (tci -> HasFailed())
+            {
+                ctxt . LegacyThrow(EE_REPEAT_FILEREAD, *t_filename);
+                return;
+            }
+            
+            loopvar -> set(ctxt, kMCEmptyString);
+            break;
+        }
+        
+        bool endnext;
+        endnext = tci -> IsExhausted();
+        
+        tci -> CopyString(&t_unit);
+        loopvar -> set(ctxt, *t_unit);
+        
+        MCKeywordsExecuteRepeatStatements(ctxt, statements, line, pos, done);
+        
+        // Reset the loop variable to whatever the value was in the last iteration.
+        if (endnext)
+            loopvar -> set(ctxt, *t_unit);
+        
+        done = done || endnext;
+    }
+}
+
 void MCKeywordsExecRepeatWith(MCExecContext& ctxt, MCStatement *statements, MCExpression *step, MCExpression *startcond, MCExpression *endcond, MCVarref *loopvar, real8 stepval, uint2 line, uint2 pos)
 {
     real8 endn = 0.0;
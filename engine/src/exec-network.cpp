@@ -557,7 +557,7 @@ void MCNetworkExecCloseSocket(MCExecContext& ctxt, MCNameRef p_socket)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void MCNetworkExecPerformAcceptConnections(MCExecContext& ctxt, uint2 p_port, MCNameRef p_message, bool p_datagram, bool p_secure, bool p_with_verification)
+void MCNetworkExecPerformAcceptConnections(MCExecContext& ctxt, uint2 p_port, MCNameRef p_message, bool p_datagram, bool p_secure, bool p_with_verification, bool p_http = false)
 {
 	// MW-2005-01-28: Fix bug 2412 - accept doesn't clear the result.
 	MCresult -> clear();
@@ -569,6 +569,9 @@ void MCNetworkExecPerformAcceptConnections(MCExecContext& ctxt, uint2 p_port, MC
 	MCSocket *s = MCS_accept(p_port, ctxt . GetObject(), p_message, p_datagram ? True : False, p_secure ? True : False, p_with_verification ? True : False, kMCEmptyString);
 	if (s != NULL)
     {
+        // Connections accepted on an http socket parse requests natively,
+        // sending the message once for each complete request.
+        s -> http = p_http ? True : False;
         MCSocketsAppendToSocketList(s);
         ctxt . SetItToValue(s -> name);
     }
@@ -589,6 +592,16 @@ void MCNetworkExecAcceptSecureConnectionsOnPort(MCExecContext& ctxt, uint2 p_por
 	MCNetworkExecPerformAcceptConnections(ctxt, p_port, p_message, false, true, p_with_verification);
 }
 
+void MCNetworkExecAcceptHttpConnectionsOnPort(MCExecContext& ctxt, uint2 p_port, MCNameRef p_message)
+{
+	MCNetworkExecPerformAcceptConnections(ctxt, p_port, p_message, false, false, false, true);
+}
+
+void MCNetworkExecAcceptSecureHttpConnectionsOnPort(MCExecContext& ctxt, uint2 p_port, MCNameRef p_message, bool p_with_verification)
+{
+	MCNetworkExecPerformAcceptConnections(ctxt, p_port, p_message, false, true, p_with_verification, true);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 void MCNetworkExecReadFromSocket(MCExecContext& ctxt, MCNameRef p_socket, uint4 p_count, MCStringRef p_sentinel, MCNameRef p_message)
@@ -36,9 +36,11 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 #include "chunk.h"
 #include "date.h"
+#include "sort.h"
 
 #include "foundation-chunk.h"
 #include "patternmatcher.h"
+#include "linediff.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -1876,6 +1878,14 @@ void MCStringsEvalByteOffset(MCExecContext& ctxt, MCDataRef p_chunk, MCDataRef p
     r_result = t_result;
 }
 
+void MCStringsEvalLineDiff(MCExecContext& ctxt, MCStringRef p_from, MCStringRef p_to, MCStringRef& r_edits)
+{
+    if (MCLineDiffCompare(p_from, p_to, r_edits))
+        return;
+
+    ctxt.Throw();
+}
+
 void MCStringsEvalOffset(MCExecContext& ctxt, MCStringRef p_chunk, MCStringRef p_string, uindex_t p_start_offset, uindex_t& r_result)
 {
 	MCStringOptions t_options = ctxt.GetStringComparisonType();
@@ -2055,90 +2065,84 @@ void MCStringsEvalIsNotAscii(MCExecContext& ctxt, MCValueRef p_value, bool& r_re
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void MCStringsDoSort(MCSortnode *b, uint4 n, MCSortnode *t, Sort_type form, bool reverse, MCStringOptions p_options)
+void MCStringsSort(MCSortnode *p_items, uint4 nitems, Sort_type p_dir, Sort_type p_form, MCStringOptions p_options)
 {
-    if (n <= 1)
-		return;
-    
-	uint4 n1 = n / 2;
-	uint4 n2 = n - n1;
-	MCSortnode *b1 = b;
-	MCSortnode *b2 = b + n1;
+    if (nitems <= 1)
+        return;
     
-	MCStringsDoSort(b1, n1, t, form, reverse, p_options);
-	MCStringsDoSort(b2, n2, t, form, reverse, p_options);
+    // NOTE:
+    //
+    // This code assumes the types in the MCSortnodes are correct for the
+    // requested sort type. Bad things will happen if this isn't true...
+    MCSortKeys t_keys;
+    bool t_success;
+    t_success = t_keys . Initialize(nitems, p_form != ST_INTERNATIONAL && p_form != ST_TEXT && p_form != ST_BINARY);
     
-	MCSortnode *tmp = t;
-	while (n1 > 0 && n2 > 0)
-	{
-		// NOTE:
-		//
-		// This code assumes the types in the MCSortnodes are correct for the
-		// requested sort type. Bad things will happen if this isn't true...
-		bool first;
-		switch (form)
-		{
-            case ST_INTERNATIONAL:
-			{
-                const unichar_t *t1, *t2;
-                t1 = MCStringGetCharPtr(b1->svalue);
-                t2 = MCStringGetCharPtr(b2->svalue);
-                
-                compare_t result = MCUnicodeCollate(kMCSystemLocale, MCUnicodeCollateOptionFromCompareOption((MCUnicodeCompareOption)p_options), t1, MCStringGetLength(b1->svalue), t2, MCStringGetLength(b2->svalue));
-				first = reverse ? result >= 0 : result <= 0;
-				break;
-			}
-                
-            case ST_TEXT:
-			{
-				// This mode performs the comparison in a locale-independent,
-                // case-sensitive manner. The strings are sorted by order of
-                // codepoint values rather than any lexical sorting order.
-                compare_t result = MCStringCompareTo(b1->svalue, b2->svalue, kMCStringOptionCompareExact);
-                
-				first = reverse ? result >= 0 : result <= 0;
-				break;
-			}
-            case ST_BINARY:
-            {
-                compare_t result = MCDataCompareTo(b1->dvalue, b2->dvalue);
-                
-				first = reverse ? result >= 0 : result <= 0;
-				break;
-            }
-            default:
-			{
-				first = reverse
-                ? MCNumberFetchAsReal(b1->nvalue) >= MCNumberFetchAsReal(b2->nvalue)
-                : MCNumberFetchAsReal(b1->nvalue) <= MCNumberFetchAsReal(b2->nvalue);
-				break;
-			}
+    switch (p_form)
+    {
+        case ST_INTERNATIONAL:
+        {
+            MCUnicodeCollatorRef t_collator;
+            t_collator = nil;
+            if (t_success)
+                t_success = MCUnicodeCreateCollator(kMCSystemLocale, MCUnicodeCollateOptionFromCompareOption((MCUnicodeCompareOption)p_options), t_collator);
+            
+            for (uindex_t i = 0; t_success && i < nitems; i++)
+                t_success = t_keys . SetCollationKey(i, t_collator, p_items[i] . svalue);
+            
+            if (t_collator != nil)
+                MCUnicodeDestroyCollator(t_collator);
+            break;
         }
-		if (first)
-		{
-			*tmp++ = *b1++;
-			n1--;
-		}
-		else
-		{
-			*tmp++ = *b2++;
-			n2--;
-		}
-	}
+            
+        case ST_TEXT:
+            // This mode performs the comparison in a locale-independent,
+            // case-sensitive manner. The strings are sorted by order of
+            // codepoint values rather than any lexical sorting order.
+            for (uindex_t i = 0; t_success && i < nitems; i++)
+                t_success = t_keys . SetString(i, p_items[i] . svalue);
+            break;
+            
+        case ST_BINARY:
+            for (uindex_t i = 0; t_success && i < nitems; i++)
+                t_keys . SetBytes(i, MCDataGetBytePtr(p_items[i] . dvalue), MCDataGetLength(p_items[i] . dvalue));
+            break;
+            
+        default:
+            for (uindex_t i = 0; t_success && i < nitems; i++)
+                t_keys . SetNumber(i, MCNumberFetchAsReal(p_items[i] . nvalue));
+            break;
+    }
     
-	for (uindex_t i = 0; i < n1; i++)
-		tmp[i] = b1[i];
-	for (uindex_t i = 0; i < (n - n2); i++)
-		b[i] = t[i];
-}
-
-void MCStringsSort(MCSortnode *p_items, uint4 nitems, Sort_type p_dir, Sort_type p_form, MCStringOptions p_options)
-{
-    if (nitems > 1)
+    MCAutoArray<uindex_t> t_order;
+    if (t_success)
+        t_success = t_order . New(nitems);
+    
+    if (t_success)
+        t_success = t_keys . Sort(p_dir == ST_DESCENDING, t_order . Ptr());
+    
+    // If the sort could not be done, the items are left as they are.
+    if (!t_success)
+        return;
+    
+    // Permute the nodes into sorted order - ownership of the values moves
+    // with them, so there is no need to retain or release.
+    MCAutoArray<MCValueRef> t_values;
+    MCAutoArray<const void *> t_datas;
+    if (!t_values . New(nitems) ||
+        !t_datas . New(nitems))
+        return;
+    
+    for (uindex_t i = 0; i < nitems; i++)
+    {
+        t_values[i] = p_items[t_order[i]] . svalue;
+        t_datas[i] = p_items[t_order[i]] . data;
+    }
+    
+    for (uindex_t i = 0; i < nitems; i++)
     {
-        MCSortnode *tmp = new (nothrow) MCSortnode[nitems];
-        MCStringsDoSort(p_items, nitems, tmp, p_form, p_dir == ST_DESCENDING, p_options);
-        delete[] tmp;
+        p_items[i] . svalue = (MCStringRef)t_values[i];
+        p_items[i] . data = t_datas[i];
     }
 }
 
@@ -2244,111 +2248,6 @@ void MCStringsSortAddItem(MCExecContext &ctxt, MCSortnode *items, uint4 &nitems,
 
 ////////////////////////////////////////////////////////////////////////////////
 
-typedef bool (*comparator_t)(void *context, uindex_t left, uindex_t right);
-typedef void (*freer_t)(void *keys, uindex_t count);
-
-static void MCStringsDoSortIndirect(uindex_t *b, uint4 n, uindex_t *t, comparator_t is_less_or_equal, void *context)
-{
-    if (n <= 1)
-		return;
-    
-	uint4 n1 = n / 2;
-	uint4 n2 = n - n1;
-	uindex_t *b1 = b;
-	uindex_t *b2 = b + n1;
-    
-	MCStringsDoSortIndirect(b1, n1, t, is_less_or_equal, context);
-	MCStringsDoSortIndirect(b2, n2, t, is_less_or_equal, context);
-    
-	uindex_t *tmp = t;
-	while (n1 > 0 && n2 > 0)
-	{
-		if (is_less_or_equal(context, *b1, *b2))
-		{
-			*tmp++ = *b1++;
-			n1--;
-		}
-		else
-		{
-			*tmp++ = *b2++;
-			n2--;
-		}
-	}
-    
-	for (uindex_t i = 0; i < n1; i++)
-		tmp[i] = b1[i];
-	for (uindex_t i = 0; i < (n - n2); i++)
-		b[i] = t[i];
-}
-
-static void MCStringsSortIndirect(uindex_t *p_items, uint4 nitems, comparator_t is_less_or_equal, void *context)
-{
-    if (nitems == 0)
-        return;
-    
-    uindex_t *tmp = new (nothrow) uindex_t[nitems];
-    MCStringsDoSortIndirect(p_items, nitems, tmp, is_less_or_equal, context);
-    delete[] tmp;
-}
-
-static bool double_comparator_fwd(void *p_context, uindex_t p_left, uindex_t p_right)
-{
-    double *t_keys;
-    t_keys = (double *)p_context;
-    return t_keys[p_left] <= t_keys[p_right];
-}
-
-static bool double_comparator_rev(void *p_context, uindex_t p_left, uindex_t p_right)
-{
-    double *t_keys;
-    t_keys = (double *)p_context;
-    return t_keys[p_left] >= t_keys[p_right];
-}
-
-static void double_freer(void *keys, uindex_t count)
-{
-    double *t_doubles;
-    t_doubles = (double *)keys;
-    delete[] t_doubles;
-}
-
-static bool data_comparator_fwd(void *p_context, uindex_t p_left, uindex_t p_right)
-{
-    MCDataRef *t_keys;
-    t_keys = (MCDataRef *)p_context;
-    return MCDataCompareTo(t_keys[p_left], t_keys[p_right]) <= 0;
-}
-
-static bool data_comparator_rev(void *p_context, uindex_t p_left, uindex_t p_right)
-{
-    MCDataRef *t_keys;
-    t_keys = (MCDataRef *)p_context;
-    return MCDataCompareTo(t_keys[p_left], t_keys[p_right]) >= 0;
-}
-
-static bool string_comparator_fwd(void *p_context, uindex_t p_left, uindex_t p_right)
-{
-    MCStringRef *t_keys;
-    t_keys = (MCStringRef *)p_context;
-    return MCStringCompareTo(t_keys[p_left], t_keys[p_right], kMCStringOptionCompareExact) <= 0;
-}
-
-static bool string_comparator_rev(void *p_context, uindex_t p_left, uindex_t p_right)
-{
-    MCStringRef *t_keys;
-    t_keys = (MCStringRef *)p_context;
-    return MCStringCompareTo(t_keys[p_left], t_keys[p_right], kMCStringOptionCompareExact) >= 0;
-}
-
-static void valueref_freer(void *keys, uindex_t count)
-{
-    MCValueRef *t_values;
-    t_values = (MCValueRef *)keys;
-    for(uindex_t i = 0; i < count; i++)
-        MCValueRelease(t_values[i]);
-    delete[] t_values;
-}
-
 static bool MCStringCopyFoldedAndRelease(MCStringRef p_string, MCStringOptions p_options, MCStringRef& r_folded_string)
 {
     if (p_options == kMCStringOptionCompareExact)
@@ -2377,6 +2276,15 @@ void MCStringsExecSort(MCExecContext& ctxt, Sort_type p_dir, Sort_type p_form, M
     if (p_count == 0)
         return;
     
+    // The keys are allocated before anything else, so there is nothing to
+    // clean up if there is not enough memory for them.
+    MCSortKeys t_keys;
+    if (!t_keys . Initialize(p_count, p_form == ST_DATETIME || p_form == ST_NUMERIC))
+    {
+        ctxt . LegacyThrow(EE_NO_MEMORY);
+        return;
+    }
+    
     // Indicates if all items are stringrefs.
     bool t_all_strings;
     t_all_strings = true;
@@ -2403,108 +2311,83 @@ void MCStringsExecSort(MCExecContext& ctxt, Sort_type p_dir, Sort_type p_form, M
     else
         t_items = (MCValueRef *)p_items;
     
-    // Build the vector of indicies to sort.
-    uindex_t *t_indicies;
-    t_indicies = new (nothrow) uindex_t[p_count];
-    for(uindex_t i = 0; i < p_count; i++)
-        t_indicies[i] = i;
-    
     // Now generate the sort keys - what type these are will depend on the
-    // type of sort.
-    void *t_sort_keys;
-    comparator_t t_sort_compare;
-    freer_t t_sort_freer;
+    // type of sort. Any values the keys refer to are held in t_key_values
+    // until the sort is done.
+    MCAutoValueRefArray t_key_values;
     
     switch(p_form)
     {
         case ST_DATETIME:
         {
             // DateTime is sorted by seconds.
-            double *t_seconds;
-            t_seconds = new (nothrow) double[p_count];
             for(uindex_t i = 0; i < p_count; i++)
             {
                 MCDateTime t_datetime;
+                double t_seconds;
                 if (!MCD_convert_to_datetime(ctxt, t_items[i], CF_UNDEFINED, CF_UNDEFINED, t_datetime) ||
-                    !MCS_datetimetoseconds(t_datetime, t_seconds[i]))
-                    t_seconds[i] = -MAXREAL8;
+                    !MCS_datetimetoseconds(t_datetime, t_seconds))
+                    t_seconds = -MAXREAL8;
+                t_keys . SetNumber(i, t_seconds);
             }
-            
-            t_sort_keys = t_seconds;
-            t_sort_compare = p_dir == ST_ASCENDING ? double_comparator_fwd : double_comparator_rev;
-            t_sort_freer = double_freer;
         }
         break;
             
         case ST_NUMERIC:
         {
-            double *t_numbers;
-            t_numbers = new (nothrow) double[p_count];
             for(uindex_t i = 0; i < p_count; i++)
             {
+                double t_number;
                 if (MCValueIsEmpty(t_items[i]))
-                {
-                    t_numbers[i] = -MAXREAL8;
-                    continue;
-                }
-                
-                if (!ctxt . ConvertToReal(t_items[i], t_numbers[i]))
+                    t_number = -MAXREAL8;
+                else if (!ctxt . ConvertToReal(t_items[i], t_number))
                 {
                     MCAutoStringRef t_string;
                     if (!ctxt . ConvertToString(t_items[i], &t_string))
+                        t_number = -MAXREAL8;
+                    else
                     {
-                        t_numbers[i] = -MAXREAL8;
-                        continue;
-                    }
-                    
-                    uindex_t t_start, t_end, t_length;
-                    t_length = MCStringGetLength(*t_string);
-                    t_start = 0;
-                    
-                    // if there are consecutive spaces at the beginning, skip them
-                    while (t_start < t_length && MCUnicodeIsWhitespace(MCStringGetCharAtIndex(*t_string, t_start)))
-                        t_start++;
-                    
-                    t_end = t_start;
-                    while (t_end < t_length)
-                    {
-                        char_t t_char = MCStringGetNativeCharAtIndex(*t_string, t_end);
-                        if (!isdigit((uint1)t_char) && t_char != '.' && t_char != '-' && t_char != '+')
-                            break;
+                        uindex_t t_start, t_end, t_length;
+                        t_length = MCStringGetLength(*t_string);
+                        t_start = 0;
                         
-                        t_end++;
-                    }
-                    
-                    MCAutoStringRef t_numeric_part;
-                    if (t_end == t_start ||
-                        !MCStringCopySubstring(*t_string, MCRangeMakeMinMax(t_start, t_end), &t_numeric_part) ||
-                        !ctxt . ConvertToReal(*t_numeric_part, t_numbers[i]))
-                    {
-                        t_numbers[i] = -MAXREAL8;
-                        continue;
+                        // if there are consecutive spaces at the beginning, skip them
+                        while (t_start < t_length && MCUnicodeIsWhitespace(MCStringGetCharAtIndex(*t_string, t_start)))
+                            t_start++;
+                        
+                        t_end = t_start;
+                        while (t_end < t_length)
+                        {
+                            char_t t_char = MCStringGetNativeCharAtIndex(*t_string, t_end);
+                            if (!isdigit((uint1)t_char) && t_char != '.' && t_char != '-' && t_char != '+')
+                                break;
+                            
+                            t_end++;
+                        }
+                        
+                        MCAutoStringRef t_numeric_part;
+                        if (t_end == t_start ||
+                            !MCStringCopySubstring(*t_string, MCRangeMakeMinMax(t_start, t_end), &t_numeric_part) ||
+                            !ctxt . ConvertToReal(*t_numeric_part, t_number))
+                            t_number = -MAXREAL8;
                     }
                 }
+                t_keys . SetNumber(i, t_number);
             }
-            
-            t_sort_keys = t_numbers;
-            t_sort_compare = p_dir == ST_ASCENDING ? double_comparator_fwd : double_comparator_rev;;
-            t_sort_freer = double_freer;
         }
         break;
             
         case ST_BINARY:
         {
-            MCDataRef *t_datas;
-            t_datas = new (nothrow) MCDataRef[p_count];
+            /* UNCHECKED */ t_key_values . New(p_count);
             for(uindex_t i = 0; i < p_count; i++)
             {
-                if (!ctxt . ConvertToData(t_items[i], t_datas[i]))
-                    t_datas[i] = MCValueRetain(kMCEmptyData);
+                MCDataRef t_data;
+                if (!ctxt . ConvertToData(t_items[i], t_data))
+                    t_data = MCValueRetain(kMCEmptyData);
+                t_key_values[i] = t_data;
+                t_keys . SetBytes(i, MCDataGetBytePtr(t_data), MCDataGetLength(t_data));
             }
-            
-            t_sort_keys = t_datas;
-            t_sort_compare = p_dir == ST_ASCENDING ? data_comparator_fwd : data_comparator_rev;
-            t_sort_freer = valueref_freer;
         }
         break;
         
@@ -2515,24 +2398,21 @@ void MCStringsExecSort(MCExecContext& ctxt, Sort_type p_dir, Sort_type p_form, M
             if (t_options == kMCStringOptionCompareExact &&
                 t_all_strings)
             {
-                t_sort_keys = t_items;
-                t_sort_compare = p_dir == ST_ASCENDING ? string_comparator_fwd : string_comparator_rev;
-                t_sort_freer = nil;
+                for(uindex_t i = 0; i < p_count; i++)
+                    /* UNCHECKED */ t_keys . SetString(i, (MCStringRef)t_items[i]);
             }
             else
             {
-                MCStringRef *t_strings;
-                t_strings = new (nothrow) MCStringRef[p_count];
+                /* UNCHECKED */ t_key_values . New(p_count);
                 for(uindex_t i = 0; i < p_count; i++)
                 {
-                    if (!ctxt . ConvertToString(t_items[i], t_strings[i]) ||
-                        !MCStringCopyFoldedAndRelease(t_strings[i], t_options, t_strings[i]))
-                        t_strings[i] = MCValueRetain(kMCEmptyString);
+                    MCStringRef t_string;
+                    if (!ctxt . ConvertToString(t_items[i], t_string) ||
+                        !MCStringCopyFoldedAndRelease(t_string, t_options, t_string))
+                        t_string = MCValueRetain(kMCEmptyString);
+                    t_key_values[i] = t_string;
+                    /* UNCHECKED */ t_keys . SetString(i, t_string);
                 }
-                
-                t_sort_keys = t_strings;
-                t_sort_compare = p_dir == ST_ASCENDING ? string_comparator_fwd : string_comparator_rev;
-                t_sort_freer = valueref_freer;
             }
         }
         break;
@@ -2545,50 +2425,29 @@ void MCStringsExecSort(MCExecContext& ctxt, Sort_type p_dir, Sort_type p_form, M
             MCUnicodeCollatorRef t_collator;
             /* UNCHECKED */ MCUnicodeCreateCollator(kMCSystemLocale, t_options, t_collator);
             
-            MCDataRef *t_datas;
-            t_datas = new (nothrow) MCDataRef[p_count];
             for(uindex_t i = 0; i < p_count; i++)
             {
                 MCAutoStringRef t_string;
-                if (!ctxt . ConvertToString(t_items[i], &t_string))
-                {
-                    t_datas[i] = MCValueRetain(kMCEmptyData);
-                    continue;
-                }
-                
-                byte_t *t_key;
-                uindex_t t_key_length;
-                if (!MCUnicodeCreateSortKeyWithCollator(t_collator, MCStringGetCharPtr(*t_string), MCStringGetLength(*t_string), t_key, t_key_length))
-                {
-                    t_datas[i] = MCValueRetain(kMCEmptyData);
-                    continue;
-                }
-                
-                if (!MCDataCreateWithBytesAndRelease(t_key, t_key_length, t_datas[i]))
-                {
-                    free(t_key);
-                    t_datas[i] = MCValueRetain(kMCEmptyData);
-                    continue;
-                }
+                if (ctxt . ConvertToString(t_items[i], &t_string))
+                    /* UNCHECKED */ t_keys . SetCollationKey(i, t_collator, *t_string);
             }
             
             MCUnicodeDestroyCollator(t_collator);
-            
-            t_sort_keys = t_datas;
-            t_sort_compare = p_dir == ST_ASCENDING ? data_comparator_fwd : data_comparator_rev;
-            t_sort_freer = valueref_freer;
         }
         break;
             
         default:
-            delete[] t_indicies;
             MCUnreachableReturn();
     }
     
-    MCStringsSortIndirect(t_indicies, p_count, t_sort_compare, t_sort_keys);
-    
-    if (t_sort_freer != nil)
-        t_sort_freer(t_sort_keys, p_count);
+    // Build the vector of indicies in sorted order.
+    MCAutoArray<uindex_t> t_indicies;
+    /* UNCHECKED */ t_indicies . New(p_count);
+    if (!t_keys . Sort(p_dir == ST_DESCENDING, t_indicies . Ptr()))
+    {
+        for(uindex_t i = 0; i < p_count; i++)
+            t_indicies[i] = i;
+    }
     
     if (t_temp_items != nil)
     {
@@ -2601,8 +2460,6 @@ void MCStringsExecSort(MCExecContext& ctxt, Sort_type p_dir, Sort_type p_form, M
     for (uindex_t i = 0; i < p_count; i++)
         t_sorted . Push((MCStringRef)p_items[t_indicies[i]]);
     t_sorted . Take(r_sorted_array, r_sorted_count);
-    
-    delete[] t_indicies;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1790,6 +1790,7 @@ void MCKeywordsExecSwitch(MCExecContext& ctxt, MCExpression *condition, MCExpres
 void MCKeywordsExecIf(MCExecContext& ctxt, MCExpression *condition, MCStatement *thenstatements, MCStatement *elsestatements, uint2 line, uint2 pos);
 void MCKeywordsExecRepeatCount(MCExecContext& ctxt, MCStatement *statements, MCExpression *endcond, uint2 line, uint2 pos);
 void MCKeywordsExecRepeatFor(MCExecContext& ctxt, MCStatement *statements, MCExpression *endcond, MCVarref *loopvar, File_unit each, uint2 line, uint2 pos);
+void MCKeywordsExecRepeatForEachInFile(MCExecContext& ctxt, MCStatement *statements, MCExpression *filename, MCVarref *loopvar, File_unit each, uint2 line, uint2 pos);
 void MCKeywordsExecRepeatWith(MCExecContext& ctxt, MCStatement *statements, MCExpression *step, MCExpression *startcond, MCExpression *endcond, MCVarref *loopvar, real8 stepval, uint2 line, uint2 pos);
 void MCKeywordsExecRepeatForever(MCExecContext& ctxt, MCStatement *statements, uint2 line, uint2 pos);
 void MCKeywordsExecRepeatUntil(MCExecContext& ctxt, MCStatement *statements, MCExpression *endcond, uint2 line, uint2 pos);
@@ -1824,6 +1825,8 @@ void MCLogicEvalIsNotABoolean(MCExecContext& ctxt, MCValueRef p_value, bool& r_r
 
 ///////////
 
+void MCArraysFinalize(void);
+
 void MCArraysEvalKeys(MCExecContext& ctxt, MCArrayRef p_array, MCStringRef& r_string);
 void MCArraysEvalExtents(MCExecContext& ctxt, MCArrayRef p_array, MCStringRef& r_string);
 void MCArraysExecCombine(MCExecContext& ctxt, MCArrayRef p_array, MCStringRef p_element_delimiter, MCStringRef p_key_delimiter, MCStringRef& r_string);
@@ -1963,6 +1966,7 @@ void MCFiltersEvalBase64Decode(MCExecContext& ctxt, MCStringRef p_source, MCData
 void MCFiltersEvalBinaryEncode(MCExecContext& ctxt, MCStringRef p_format, MCValueRef *p_params, uindex_t p_param_count, MCDataRef& r_string);
 void MCFiltersEvalBinaryDecode(MCExecContext& ctxt, MCStringRef p_format, MCDataRef p_data, MCValueRef *r_results, uindex_t p_result_count, integer_t& r_done);
 void MCFiltersEvalCompress(MCExecContext& ctxt, MCDataRef p_source, MCDataRef& r_result);
+void MCFiltersEvalCompressWithLevel(MCExecContext& ctxt, MCDataRef p_source, integer_t p_level, MCDataRef& r_result);
 void MCFiltersEvalDecompress(MCExecContext& ctxt, MCDataRef p_source, MCDataRef& r_result);
 void MCFiltersEvalIsoToMac(MCExecContext& ctxt, MCDataRef p_source, MCDataRef& r_result);
 void MCFiltersEvalMacToIso(MCExecContext& ctxt, MCDataRef p_source, MCDataRef& r_result);
@@ -1973,6 +1977,8 @@ void MCFiltersEvalUniDecodeToNative(MCExecContext& ctxt, MCDataRef p_input, MCSt
 void MCFiltersEvalUniEncodeFromEncoding(MCExecContext& ctxt, MCDataRef p_src, MCNameRef p_lang, MCDataRef& r_dest);
 void MCFiltersEvalUniDecodeToEncoding(MCExecContext& ctxt, MCDataRef p_src, MCNameRef p_lang, MCDataRef& r_dest);
 void MCFiltersEvalMessageDigest(MCExecContext& ctxt, MCDataRef p_data, MCNameRef p_digest_name, MCDataRef &r_digest);
+void MCFiltersEvalMessageDigestOfArray(MCExecContext& ctxt, MCArrayRef p_data, MCNameRef p_digest_name, MCArrayRef &r_digests);
+void MCFiltersEvalFileMessageDigest(MCExecContext& ctxt, MCStringRef p_path, MCNameRef p_digest_name, MCDataRef &r_digest);
 void MCFiltersEvalMD5Digest(MCExecContext& ctxt, MCDataRef p_src, MCDataRef& r_digest);
 void MCFiltersEvalSHA1Digest(MCExecContext& ctxt, MCDataRef p_src, MCDataRef& r_digest);
 
@@ -2052,6 +2058,7 @@ void MCStringsEvalCodepointOffset(MCExecContext& ctxt, MCStringRef p_chunk, MCSt
 void MCStringsEvalCodeunitOffset(MCExecContext& ctxt, MCStringRef p_chunk, MCStringRef p_string, uindex_t p_start_offset, uindex_t& r_result);
 void MCStringsEvalByteOffset(MCExecContext& ctxt, MCDataRef p_chunk, MCDataRef p_string, uindex_t p_start_offset, uindex_t& r_result);
 void MCStringsEvalOffset(MCExecContext& ctxt, MCStringRef p_chunk, MCStringRef p_string, uindex_t p_start_offset, uindex_t& r_result);
+void MCStringsEvalLineDiff(MCExecContext& ctxt, MCStringRef p_from, MCStringRef p_to, MCStringRef& r_edits);
 
 void MCStringsExecReplace(MCExecContext& ctxt, MCStringRef p_pattern, MCStringRef p_replacement, MCStringRef p_target);
 
@@ -2170,6 +2177,8 @@ struct MCInterfaceStackFileVersion;
 
 extern MCExecCustomTypeInfo *kMCInterfaceNamedColorTypeInfo;
 extern MCExecEnumTypeInfo *kMCInterfacePaintCompressionTypeInfo;
+extern MCExecEnumTypeInfo *kMCInterfacePngFilterTypeInfo;
+extern MCExecEnumTypeInfo *kMCInterfaceJpegChromaSubsamplingTypeInfo;
 extern MCExecEnumTypeInfo *kMCInterfaceLookAndFeelTypeInfo;
 extern MCExecCustomTypeInfo *kMCInterfaceBackdropTypeInfo;
 extern MCExecEnumTypeInfo *kMCInterfaceProcessTypeTypeInfo;
@@ -2438,6 +2447,7 @@ void MCInterfaceExecExportSnapshotOfStack(MCExecContext& ctxt, MCStringRef p_sta
 void MCInterfaceExecExportSnapshotOfStackToFile(MCExecContext& ctxt, MCStringRef p_stack, MCStringRef p_display, MCRectangle *p_region, MCPoint *p_size, int format, MCInterfaceImagePaletteSettings *p_palette, MCImageMetadata* p_metadata, MCStringRef p_filename, MCStringRef p_mask_filename);
 void MCInterfaceExecExportSnapshotOfObject(MCExecContext& ctxt, MCObject *p_target, MCRectangle *p_region, bool p_with_effects, MCPoint *p_at_size, int format, MCInterfaceImagePaletteSettings *p_palette, MCImageMetadata* p_metadata, MCDataRef &r_data);
 void MCInterfaceExecExportSnapshotOfObjectToFile(MCExecContext& ctxt, MCObject *p_target, MCRectangle *p_region, bool p_with_effects, MCPoint *p_at_size, int format, MCInterfaceImagePaletteSettings *p_palette, MCImageMetadata* p_metadata, MCStringRef p_filename, MCStringRef p_mask_filename);
+void MCInterfaceExecExportSnapshotsOfObjectsToFiles(MCExecContext& ctxt, MCObjectHandle *p_targets, MCStringRef *p_filenames, uindex_t p_count, MCPoint *p_at_size, int format, MCInterfaceImagePaletteSettings *p_palette, MCImageMetadata* p_metadata);
 void MCInterfaceExecExportImage(MCExecContext& ctxt, MCImage *p_target, int p_format, MCInterfaceImagePaletteSettings *p_palette, MCImageMetadata* p_metadata, MCDataRef &r_data);
 void MCInterfaceExecExportImageToFile(MCExecContext& ctxt, MCImage *p_target, int p_format, MCInterfaceImagePaletteSettings *p_palette, MCImageMetadata* p_metadata, MCStringRef p_filename, MCStringRef p_mask_filename);
 void MCInterfaceExecExportObjectToArray(MCExecContext& ctxt, MCObject *p_container, MCArrayRef& r_array);
@@ -2653,6 +2663,14 @@ void MCInterfaceGetWindowBoundingRect(MCExecContext& ctxt, MCRectangle& r_value)
 void MCInterfaceSetWindowBoundingRect(MCExecContext& ctxt, MCRectangle p_value);
 void MCInterfaceGetJpegQuality(MCExecContext& ctxt, uinteger_t& r_value);
 void MCInterfaceSetJpegQuality(MCExecContext& ctxt, uinteger_t p_value);
+void MCInterfaceGetJpegProgressive(MCExecContext& ctxt, bool& r_value);
+void MCInterfaceSetJpegProgressive(MCExecContext& ctxt, bool p_value);
+void MCInterfaceGetJpegChromaSubsampling(MCExecContext& ctxt, intenum_t& r_value);
+void MCInterfaceSetJpegChromaSubsampling(MCExecContext& ctxt, intenum_t p_value);
+void MCInterfaceGetPngCompressionLevel(MCExecContext& ctxt, uinteger_t& r_value);
+void MCInterfaceSetPngCompressionLevel(MCExecContext& ctxt, uinteger_t p_value);
+void MCInterfaceGetPngFilter(MCExecContext& ctxt, intenum_t& r_value);
+void MCInterfaceSetPngFilter(MCExecContext& ctxt, intenum_t p_value);
 void MCInterfaceGetRelayerGroupedControls(MCExecContext& ctxt, bool& r_value);
 void MCInterfaceSetRelayerGroupedControls(MCExecContext& ctxt, bool p_value);
 
@@ -3274,6 +3292,10 @@ void MCFilesGetDetailedFiles(MCExecContext& ctxt, MCStringRef& r_value);
 void MCFilesGetFolders(MCExecContext& ctxt, MCStringRef& r_value);
 void MCFilesGetDetailedFolders(MCExecContext& ctxt, MCStringRef& r_value);
 
+class MCTextChunkIterator_File;
+
+MCTextChunkIterator_File *MCFilesTextChunkIteratorCreate(MCExecContext& ctxt, MCStringRef p_filename, Chunk_term p_chunk_type);
+
 ///////////
 
 struct MCMultimediaRecordFormat;
@@ -3379,6 +3401,8 @@ void MCNetworkExecPostToUrl(MCExecContext& ctxt, MCValueRef p_data, MCStringRef
 void MCNetworkExecAcceptConnectionsOnPort(MCExecContext& ctxt, uint2 p_port, MCNameRef p_message);
 void MCNetworkExecAcceptDatagramConnectionsOnPort(MCExecContext& ctxt, uint2 p_port, MCNameRef p_message);
 void MCNetworkExecAcceptSecureConnectionsOnPort(MCExecContext& ctxt, uint2 p_port, MCNameRef p_message, bool p_with_verification);
+void MCNetworkExecAcceptHttpConnectionsOnPort(MCExecContext& ctxt, uint2 p_port, MCNameRef p_message);
+void MCNetworkExecAcceptSecureHttpConnectionsOnPort(MCExecContext& ctxt, uint2 p_port, MCNameRef p_message, bool p_with_verification);
 
 void MCNetworkExecReadFromSocketFor(MCExecContext& ctxt, MCNameRef p_socket, uint4 p_count, int p_unit_type, MCNameRef p_message);
 void MCNetworkExecReadFromSocketUntil(MCExecContext& ctxt, MCNameRef p_socket, MCStringRef p_sentinel, MCNameRef p_message);
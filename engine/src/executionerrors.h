@@ -2778,7 +2778,31 @@ enum Exec_errors
     EE_BAD_PERMISSION_NAME,
     
     // {EE-0910} Property: value is not a data
-    EE_PROPERTY_NOTADATA
+    EE_PROPERTY_NOTADATA,
+
+    // {EE-0911} compress: level is not an integer from 0 to 9
+    EE_COMPRESS_BADLEVEL,
+
+    // {EE-0912} fileMessageDigest: error in file path parameter
+    EE_FILEMESSAGEDIGEST_BADPATH,
+
+    // {EE-0913} lineDiff: error in source text parameter
+    EE_LINEDIFF_BADFROM,
+
+    // {EE-0914} lineDiff: error in destination text parameter
+    EE_LINEDIFF_BADTO,
+
+    // {EE-0915} repeat: can't open file
+    EE_REPEAT_BADFILE,
+
+    // {EE-0916} repeat: error reading file
+    EE_REPEAT_FILEREAD,
+
+    // {EE-0917} export: error in object list
+    EE_EXPORT_BADOBJECTS,
+
+    // {EE-0918} export: number of files does not match number of objects
+    EE_EXPORT_FILECOUNT,
     
 };
 
@@ -62,6 +62,8 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 #include "resolution.h"
 
+#include "foundation-filters.h"
+
 ////////////////////////////////////////////////////////////////////////////////
 
 Parse_stat MCFunction::parse(MCScriptPoint &sp, Boolean the)
@@ -457,6 +459,37 @@ void MCCommandName::eval_ctxt(MCExecContext& ctxt, MCExecValue& r_value)
     r_value.type = kMCExecValueTypeStringRef;
 }
 
+MCCompress::~MCCompress()
+{
+	delete source;
+	delete level;
+}
+
+Parse_stat MCCompress::parse(MCScriptPoint &sp, Boolean the)
+{
+	if (get1or2params(sp, &source, &level, the) != PS_NORMAL)
+	{
+		MCperror->add(PE_COMPRESS_BADPARAM, sp);
+		return PS_ERROR;
+	}
+	return PS_NORMAL;
+}
+
+void MCCompress::eval_ctxt(MCExecContext& ctxt, MCExecValue& r_value)
+{
+    MCAutoDataRef t_source;
+    if (!ctxt . EvalExprAsDataRef(source, EE_COMPRESS_BADSOURCE, &t_source))
+        return;
+
+    integer_t t_level;
+    if (!ctxt . EvalOptionalExprAsInt(level, kMCFiltersCompressionLevelDefault, EE_COMPRESS_BADLEVEL, t_level))
+        return;
+
+    MCFiltersEvalCompressWithLevel(ctxt, *t_source, t_level, r_value . dataref_value);
+
+    if (!ctxt . HasError())
+        r_value . type = kMCExecValueTypeDataRef;
+}
 
 MCDriverNames::~MCDriverNames()
 {
@@ -2523,9 +2556,31 @@ MCMessageDigestFunc::eval_ctxt(MCExecContext &ctxt,
     MCNewAutoNameRef t_name;
     if (!ctxt.EvalExprAsNameRef(m_type.Get(), EE_MESSAGEDIGEST_BADTYPE, &t_name))
         return;
+    MCAutoValueRef t_value;
+    if (!ctxt.EvalExprAsValueRef(m_data.Get(), EE_MESSAGEDIGEST_BADDATA, &t_value))
+        return;
+
+    /* A non-empty array digests each element, giving an array of
+     * digests with the same keys. */
+    if (MCValueGetTypeCode(*t_value) == kMCValueTypeCodeArray &&
+        !MCArrayIsEmpty((MCArrayRef)*t_value))
+    {
+        MCAutoArrayRef t_digests;
+        MCFiltersEvalMessageDigestOfArray(ctxt, (MCArrayRef)*t_value, *t_name, &t_digests);
+        if (!ctxt.HasError())
+        {
+            r_value.arrayref_value = t_digests.Take();
+            r_value.type = kMCExecValueTypeArrayRef;
+        }
+        return;
+    }
+
     MCAutoDataRef t_data;
-    if (!ctxt.EvalExprAsDataRef(m_data.Get(), EE_MESSAGEDIGEST_BADDATA, &t_data))
+    if (!ctxt.ConvertToData(*t_value, &t_data))
+    {
+        ctxt.LegacyThrow(EE_MESSAGEDIGEST_BADDATA);
         return;
+    }
     MCAutoDataRef t_digest;
     MCFiltersEvalMessageDigest(ctxt, *t_data, *t_name, &t_digest);
     if (!ctxt.HasError())
@@ -2537,6 +2592,90 @@ MCMessageDigestFunc::eval_ctxt(MCExecContext &ctxt,
 
 ///////////////////////////////////////////////////////////////////////////////
 
+Parse_stat
+MCFileMessageDigestFunc::parse(MCScriptPoint &sp,
+                               Boolean the)
+{
+    MCExpression *t_params[MAX_EXP];
+    uint2 t_param_count = 0;
+
+    if (getexps(sp, t_params, t_param_count) != PS_NORMAL ||
+        (t_param_count != 2))
+    {
+        freeexps(t_params, t_param_count);
+
+        MCperror->add(PE_FILEMESSAGEDIGEST_BADPARAM, sp);
+        return PS_ERROR;
+    }
+
+    m_path.Reset(t_params[0]);
+    m_type.Reset(t_params[1]);
+    return PS_NORMAL;
+}
+
+void
+MCFileMessageDigestFunc::eval_ctxt(MCExecContext &ctxt,
+                                   MCExecValue &r_value)
+{
+    MCNewAutoNameRef t_name;
+    if (!ctxt.EvalExprAsNameRef(m_type.Get(), EE_MESSAGEDIGEST_BADTYPE, &t_name))
+        return;
+    MCAutoStringRef t_path;
+    if (!ctxt.EvalExprAsStringRef(m_path.Get(), EE_FILEMESSAGEDIGEST_BADPATH, &t_path))
+        return;
+    MCAutoDataRef t_digest;
+    MCFiltersEvalFileMessageDigest(ctxt, *t_path, *t_name, &t_digest);
+    if (!ctxt.HasError())
+    {
+        r_value.dataref_value = t_digest.Take();
+        r_value.type = kMCExecValueTypeDataRef;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+Parse_stat
+MCLineDiffFunc::parse(MCScriptPoint &sp,
+                      Boolean the)
+{
+    MCExpression *t_params[MAX_EXP];
+    uint2 t_param_count = 0;
+
+    if (getexps(sp, t_params, t_param_count) != PS_NORMAL ||
+        (t_param_count != 2))
+    {
+        freeexps(t_params, t_param_count);
+
+        MCperror->add(PE_LINEDIFF_BADPARAM, sp);
+        return PS_ERROR;
+    }
+
+    m_from.Reset(t_params[0]);
+    m_to.Reset(t_params[1]);
+    return PS_NORMAL;
+}
+
+void
+MCLineDiffFunc::eval_ctxt(MCExecContext &ctxt,
+                          MCExecValue &r_value)
+{
+    MCAutoStringRef t_from;
+    if (!ctxt.EvalExprAsStringRef(m_from.Get(), EE_LINEDIFF_BADFROM, &t_from))
+        return;
+    MCAutoStringRef t_to;
+    if (!ctxt.EvalExprAsStringRef(m_to.Get(), EE_LINEDIFF_BADTO, &t_to))
+        return;
+    MCAutoStringRef t_edits;
+    MCStringsEvalLineDiff(ctxt, *t_from, *t_to, &t_edits);
+    if (!ctxt.HasError())
+    {
+        r_value.stringref_value = t_edits.Take();
+        r_value.type = kMCExecValueTypeStringRef;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 #ifdef _TEST
 #include "test.h"
 
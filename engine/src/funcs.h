@@ -321,11 +321,19 @@ class MCClipboardFunc : public MCConstantFunctionCtxt<MCNameRef, MCPasteboardEva
 public:
 };
 
-class MCCompress : public MCUnaryFunctionCtxt<MCDataRef, MCDataRef, MCFiltersEvalCompress, EE_COMPRESS_BADSOURCE, PE_COMPRESS_BADPARAM>
+class MCCompress : public MCFunction
 {
+    MCExpression *source;
+    MCExpression *level;
 public:
-    MCCompress(){}
-    virtual ~MCCompress(){}
+    MCCompress()
+    {
+        source = level = NULL;
+    }
+
+    virtual ~MCCompress();
+    virtual Parse_stat parse(MCScriptPoint &, Boolean the);
+	virtual void eval_ctxt(MCExecContext &, MCExecValue &);
 };
 
 class MCConstantNames : public MCConstantFunctionCtxt<MCStringRef, MCEngineEvalConstantNames>
@@ -352,6 +360,17 @@ public:
 	}
 };
 
+class MCLineDiffFunc: public MCFunction
+{
+	MCAutoPointer<MCExpression> m_from;
+	MCAutoPointer<MCExpression> m_to;
+
+public:
+	virtual ~MCLineDiffFunc(void) {};
+	virtual Parse_stat parse(MCScriptPoint &sp, Boolean the);
+    virtual void eval_ctxt(MCExecContext &ctxt, MCExecValue &r_value);
+};
+
 class MCOffset : public MCChunkOffset
 {
 public:
@@ -2091,6 +2110,17 @@ public:
     virtual void eval_ctxt(MCExecContext &ctxt, MCExecValue &r_value);
 };
 
+class MCFileMessageDigestFunc: public MCFunction
+{
+	MCAutoPointer<MCExpression> m_path;
+	MCAutoPointer<MCExpression> m_type;
+
+public:
+	virtual ~MCFileMessageDigestFunc(void) {};
+	virtual Parse_stat parse(MCScriptPoint &sp, Boolean the);
+    virtual void eval_ctxt(MCExecContext &ctxt, MCExecValue &r_value);
+};
+
 class MCMinFunction : public MCParamFunctionCtxt<MCMathEvalMin, EE_MIN_BADSOURCE, PE_MIN_BADPARAM>
 {
 public:
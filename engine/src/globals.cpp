@@ -221,6 +221,10 @@ Boolean MCselectgrouped;
 Boolean MCselectintersect = True;
 MCRectangle MCwbr;
 uint2 MCjpegquality = 100;
+uint2 MCpngcompressionlevel = 6;
+MCImagePNGFilter MCpngfilter = kMCImagePNGFilterDefault;
+Boolean MCjpegprogressive = False;
+MCImageJPEGSubsampling MCjpegchromasubsampling = kMCImageJPEGSubsampling420;
 Export_format MCpaintcompression = EX_PBM;
 uint2 MCrecordchannels = 1;
 uint2 MCrecordsamplesize = 8;
@@ -620,6 +624,10 @@ void X_clear_globals(void)
 	MCselectintersect = True;
 	memset(&MCwbr, 0, sizeof(MCRectangle));
 	MCjpegquality = 100;
+	MCpngcompressionlevel = 6;
+	MCpngfilter = kMCImagePNGFilterDefault;
+	MCjpegprogressive = False;
+	MCjpegchromasubsampling = kMCImageJPEGSubsampling420;
 	MCpaintcompression = EX_PBM;
 	MCrecordformat = 0;
 	MCrecordchannels = 1;
@@ -1536,6 +1544,8 @@ int X_close(void)
 	
 	MCDateTimeFinalize();
 	
+	MCArraysFinalize();
+	
 	MCU_finalize_names();
 	
 	if (MCsysencoding != nil)
@@ -151,6 +151,10 @@ extern Boolean MCselectgrouped;
 extern Boolean MCselectintersect;
 extern MCRectangle MCwbr;
 extern uint2 MCjpegquality;
+extern uint2 MCpngcompressionlevel;
+extern MCImagePNGFilter MCpngfilter;
+extern Boolean MCjpegprogressive;
+extern MCImageJPEGSubsampling MCjpegchromasubsampling;
 extern Export_format MCpaintcompression;
 extern intenum_t MCrecordformat;
 extern uint2 MCsoundchannel;
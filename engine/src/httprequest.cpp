@@ -0,0 +1,621 @@
+/* Copyright (C) 2003-2015 LiveCode Ltd.
+
+ This file is part of LiveCode.
+
+ LiveCode is free software; you can redistribute it and/or modify it under
+ the terms of the GNU General Public License v3 as published by the Free
+ Software Foundation.
+
+ LiveCode is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
+
+#include "prefix.h"
+
+#include "httprequest.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// A header line of a request - continuation lines are recorded separately,
+// and are appended to the value of the preceding line.
+struct MCHttpRequestHeaderLine
+{
+    const char *name;
+    uindex_t name_length;
+    const char *value;
+    uindex_t value_length;
+};
+
+// The request line and header block of a request.
+struct MCHttpRequestHead
+{
+    const char *method;
+    uindex_t method_length;
+    const char *target;
+    uindex_t target_length;
+    const char *version;
+    uindex_t version_length;
+    MCAutoArray<MCHttpRequestHeaderLine> headers;
+
+    // How the body is framed - either a fixed number of bytes or a sequence
+    // of chunks.
+    bool chunked;
+    uindex_t length;
+
+    bool keep_alive;
+    bool close;
+    bool expect_continue;
+};
+
+static bool MCHttpRequestIsTokenChar(char p_char)
+{
+    if (p_char >= 'a' && p_char <= 'z')
+        return true;
+    if (p_char >= 'A' && p_char <= 'Z')
+        return true;
+    if (p_char >= '0' && p_char <= '9')
+        return true;
+    return strchr("!#$%&'*+-.^_`|~", p_char) != nil && p_char != '\0';
+}
+
+static bool MCHttpRequestSpanIsEqualTo(const char *p_span, uindex_t p_length, const char *p_cstring)
+{
+    // Header names and the tokens compared against are ASCII, so folding
+    // 'A'-'Z' is sufficient.
+    for (uindex_t i = 0; i < p_length; i++)
+    {
+        char t_left, t_right;
+        t_left = p_span[i];
+        t_right = p_cstring[i];
+        if (t_right == '\0')
+            return false;
+        if (t_left >= 'A' && t_left <= 'Z')
+            t_left += 'a' - 'A';
+        if (t_right >= 'A' && t_right <= 'Z')
+            t_right += 'a' - 'A';
+        if (t_left != t_right)
+            return false;
+    }
+    return p_cstring[p_length] == '\0';
+}
+
+// Returns true if the comma separated list in p_value contains p_token.
+static bool MCHttpRequestListContains(const char *p_value, uindex_t p_length, const char *p_token)
+{
+    const char *t_end;
+    t_end = p_value + p_length;
+    while (p_value < t_end)
+    {
+        const char *t_item_end;
+        t_item_end = (const char *)memchr(p_value, ',', t_end - p_value);
+        if (t_item_end == nil)
+            t_item_end = t_end;
+
+        const char *t_start, *t_finish;
+        t_start = p_value;
+        t_finish = t_item_end;
+        while (t_start < t_finish && (*t_start == ' ' || *t_start == '\t'))
+            t_start++;
+        while (t_finish > t_start && (t_finish[-1] == ' ' || t_finish[-1] == '\t'))
+            t_finish--;
+
+        if (MCHttpRequestSpanIsEqualTo(t_start, t_finish - t_start, p_token))
+            return true;
+
+        p_value = t_item_end + 1;
+    }
+    return false;
+}
+
+// Find the end of the line starting at p_line, returning the length of the
+// line (without its terminator) and the offset of the next line. Both CRLF
+// and bare LF terminators are accepted.
+static bool MCHttpRequestNextLine(const char *p_buffer, uindex_t p_length, uindex_t p_offset, uindex_t& r_line_length, uindex_t& r_next)
+{
+    const char *t_newline;
+    t_newline = (const char *)memchr(p_buffer + p_offset, '\n', p_length - p_offset);
+    if (t_newline == nil)
+        return false;
+
+    uindex_t t_end;
+    t_end = t_newline - p_buffer;
+    r_next = t_end + 1;
+    if (t_end > p_offset && p_buffer[t_end - 1] == '\r')
+        t_end--;
+    r_line_length = t_end - p_offset;
+    return true;
+}
+
+static bool MCHttpRequestParseHex(const char *p_chars, uindex_t p_length, uindex_t& r_value)
+{
+    if (p_length == 0)
+        return false;
+
+    uindex_t t_value;
+    t_value = 0;
+    for (uindex_t i = 0; i < p_length; i++)
+    {
+        uindex_t t_digit;
+        char t_char;
+        t_char = p_chars[i];
+        if (t_char >= '0' && t_char <= '9')
+            t_digit = t_char - '0';
+        else if (t_char >= 'a' && t_char <= 'f')
+            t_digit = t_char - 'a' + 10;
+        else if (t_char >= 'A' && t_char <= 'F')
+            t_digit = t_char - 'A' + 10;
+        else
+            return false;
+
+        if (t_value > (UINDEX_MAX - t_digit) / 16)
+            return false;
+        t_value = t_value * 16 + t_digit;
+    }
+
+    r_value = t_value;
+    return true;
+}
+
+static bool MCHttpRequestParseDecimal(const char *p_chars, uindex_t p_length, uindex_t& r_value)
+{
+    if (p_length == 0)
+        return false;
+
+    uindex_t t_value;
+    t_value = 0;
+    for (uindex_t i = 0; i < p_length; i++)
+    {
+        if (p_chars[i] < '0' || p_chars[i] > '9')
+            return false;
+
+        uindex_t t_digit;
+        t_digit = p_chars[i] - '0';
+        if (t_value > (UINDEX_MAX - t_digit) / 10)
+            return false;
+        t_value = t_value * 10 + t_digit;
+    }
+
+    r_value = t_value;
+    return true;
+}
+
+// Parse the size from a chunk header line, ignoring any chunk extensions.
+static bool MCHttpRequestParseChunkSize(const char *p_line, uindex_t p_length, uindex_t& r_size)
+{
+    const char *t_size_end;
+    t_size_end = (const char *)memchr(p_line, ';', p_length);
+    if (t_size_end == nil)
+        t_size_end = p_line + p_length;
+    while (t_size_end > p_line && (t_size_end[-1] == ' ' || t_size_end[-1] == '\t'))
+        t_size_end--;
+
+    return MCHttpRequestParseHex(p_line, t_size_end - p_line, r_size);
+}
+
+// Scan the chunks of a chunked body, resuming from where the previous scan
+// stopped. If the body is complete, r_end is set to the offset following it
+// and x_parser . body_length holds the total size of the chunk data.
+static MCHttpRequestParseStatus MCHttpRequestScanChunks(MCHttpRequestParser& x_parser, const char *p_buffer, uindex_t p_length, uindex_t p_max_body_size, uindex_t& r_end)
+{
+    while (x_parser . trailer_start == 0)
+    {
+        uindex_t t_line_length, t_next;
+        if (!MCHttpRequestNextLine(p_buffer, p_length, x_parser . offset, t_line_length, t_next))
+            return p_length - x_parser . offset > kMCHttpRequestMaxHeaderSize ? kMCHttpRequestParseError : kMCHttpRequestParseIncomplete;
+
+        uindex_t t_chunk_size;
+        if (!MCHttpRequestParseChunkSize(p_buffer + x_parser . offset, t_line_length, t_chunk_size))
+            return kMCHttpRequestParseError;
+
+        if (t_chunk_size == 0)
+        {
+            x_parser . offset = t_next;
+            x_parser . trailer_start = t_next;
+            break;
+        }
+
+        if (t_chunk_size > p_max_body_size - x_parser . body_length)
+            return kMCHttpRequestParseTooLarge;
+
+        if (t_chunk_size > UINDEX_MAX - t_next - 2)
+            return kMCHttpRequestParseError;
+
+        // The chunk data is followed by CRLF (or a bare LF).
+        uindex_t t_offset;
+        t_offset = t_next;
+        if (p_length - t_offset < t_chunk_size + 1)
+            return kMCHttpRequestParseIncomplete;
+        t_offset += t_chunk_size;
+        if (p_buffer[t_offset] == '\r')
+        {
+            if (p_length - t_offset < 2)
+                return kMCHttpRequestParseIncomplete;
+            t_offset++;
+        }
+        if (p_buffer[t_offset] != '\n')
+            return kMCHttpRequestParseError;
+
+        x_parser . offset = t_offset + 1;
+        x_parser . body_length += t_chunk_size;
+    }
+
+    // Skip any trailer fields up to the terminating empty line.
+    for(;;)
+    {
+        uindex_t t_line_length, t_next;
+        if (!MCHttpRequestNextLine(p_buffer, p_length, x_parser . offset, t_line_length, t_next))
+            return p_length - x_parser . trailer_start > kMCHttpRequestMaxHeaderSize ? kMCHttpRequestParseError : kMCHttpRequestParseIncomplete;
+
+        x_parser . offset = t_next;
+        if (t_line_length == 0)
+            break;
+    }
+
+    r_end = x_parser . offset;
+    return kMCHttpRequestParseComplete;
+}
+
+// Copy the data of the chunks of a complete chunked body into r_data.
+static void MCHttpRequestCopyChunks(const char *p_buffer, uindex_t p_length, uindex_t p_offset, byte_t *r_data)
+{
+    for(;;)
+    {
+        uindex_t t_line_length, t_next;
+        MCHttpRequestNextLine(p_buffer, p_length, p_offset, t_line_length, t_next);
+
+        uindex_t t_chunk_size;
+        MCHttpRequestParseChunkSize(p_buffer + p_offset, t_line_length, t_chunk_size);
+        if (t_chunk_size == 0)
+            break;
+
+        p_offset = t_next;
+        MCMemoryCopy(r_data, p_buffer + p_offset, t_chunk_size);
+        r_data += t_chunk_size;
+
+        p_offset += t_chunk_size;
+        if (p_buffer[p_offset] == '\r')
+            p_offset++;
+        p_offset++;
+    }
+}
+
+static bool MCHttpRequestStoreSpan(MCArrayRef p_array, const char *p_key, const char *p_span, uindex_t p_length)
+{
+    MCAutoStringRef t_string;
+    return MCStringCreateWithNativeChars((const char_t *)p_span, p_length, &t_string) &&
+            MCArrayStoreValue(p_array, false, MCNAME(p_key), *t_string);
+}
+
+// Build the array of headers, joining continuation lines and repeated
+// headers.
+static bool MCHttpRequestBuildHeaders(const MCHttpRequestHeaderLine *p_lines, uindex_t p_count, MCArrayRef& r_headers)
+{
+    MCAutoArrayRef t_headers;
+    if (!MCArrayCreateMutable(&t_headers))
+        return false;
+
+    uindex_t t_index;
+    t_index = 0;
+    while (t_index < p_count)
+    {
+        const MCHttpRequestHeaderLine& t_line = p_lines[t_index++];
+
+        MCAutoStringRef t_value;
+        if (!MCStringCreateMutable(t_line . value_length, &t_value) ||
+            !MCStringAppendNativeChars(*t_value, (const char_t *)t_line . value, t_line . value_length))
+            return false;
+
+        while (t_index < p_count && p_lines[t_index] . name == nil)
+        {
+            if (!MCStringAppendNativeChar(*t_value, ' ') ||
+                !MCStringAppendNativeChars(*t_value, (const char_t *)p_lines[t_index] . value, p_lines[t_index] . value_length))
+                return false;
+            t_index++;
+        }
+
+        MCNewAutoNameRef t_name;
+        if (!MCNameCreateWithNativeChars((const char_t *)t_line . name, t_line . name_length, &t_name))
+            return false;
+
+        MCValueRef t_existing;
+        if (MCArrayFetchValue(*t_headers, false, *t_name, t_existing))
+        {
+            MCAutoStringRef t_joined;
+            if (!MCStringFormat(&t_joined, "%@, %@", t_existing, *t_value) ||
+                !MCArrayStoreValue(*t_headers, false, *t_name, *t_joined))
+                return false;
+        }
+        else
+        {
+            MCAutoStringRef t_immutable_value;
+            if (!MCStringCopy(*t_value, &t_immutable_value) ||
+                !MCArrayStoreValue(*t_headers, false, *t_name, *t_immutable_value))
+                return false;
+        }
+    }
+
+    return t_headers . MakeImmutable() &&
+            MCArrayCopy(*t_headers, r_headers);
+}
+
+
+// Scan for the end of the header block, resuming from where the previous scan
+// stopped. If it is complete, x_parser . body_start is set to the offset
+// following it.
+static MCHttpRequestParseStatus MCHttpRequestScanHead(MCHttpRequestParser& x_parser, const char *p_buffer, uindex_t p_length)
+{
+    // Clients may send empty lines between requests, which should be ignored.
+    if (x_parser . offset == x_parser . start)
+    {
+        while (x_parser . start < p_length && (p_buffer[x_parser . start] == '\r' || p_buffer[x_parser . start] == '\n'))
+            x_parser . start++;
+        x_parser . offset = x_parser . start;
+    }
+
+    for(;;)
+    {
+        uindex_t t_line_length, t_next;
+        if (!MCHttpRequestNextLine(p_buffer, p_length, x_parser . offset, t_line_length, t_next))
+            return p_length - x_parser . start > kMCHttpRequestMaxHeaderSize ? kMCHttpRequestParseError : kMCHttpRequestParseIncomplete;
+
+        if (t_next - x_parser . start > kMCHttpRequestMaxHeaderSize)
+            return kMCHttpRequestParseError;
+
+        x_parser . offset = t_next;
+        if (t_line_length == 0)
+        {
+            x_parser . body_start = t_next;
+            return kMCHttpRequestParseComplete;
+        }
+    }
+}
+
+// Parse the complete header block between p_start and p_end.
+static bool MCHttpRequestParseHead(const char *p_buffer, uindex_t p_start, uindex_t p_end, MCHttpRequestHead& r_head)
+{
+    // Request line: method SP request-target SP HTTP-version
+    uindex_t t_offset, t_line_length, t_next;
+    t_offset = p_start;
+    MCHttpRequestNextLine(p_buffer, p_end, t_offset, t_line_length, t_next);
+
+    const char *t_line, *t_line_end;
+    t_line = p_buffer + t_offset;
+    t_line_end = t_line + t_line_length;
+
+    r_head . method = t_line;
+    while (t_line < t_line_end && MCHttpRequestIsTokenChar(*t_line))
+        t_line++;
+    r_head . method_length = t_line - r_head . method;
+    if (r_head . method_length == 0 || t_line == t_line_end || *t_line++ != ' ')
+        return false;
+
+    r_head . target = t_line;
+    while (t_line < t_line_end && *t_line != ' ')
+        t_line++;
+    r_head . target_length = t_line - r_head . target;
+    if (r_head . target_length == 0 || t_line == t_line_end || *t_line++ != ' ')
+        return false;
+
+    r_head . version = t_line;
+    r_head . version_length = t_line_end - t_line;
+    if (r_head . version_length != 8 || memcmp(r_head . version, "HTTP/1.", 7) != 0 ||
+        r_head . version[7] < '0' || r_head . version[7] > '9')
+        return false;
+
+    // Header fields, up to the terminating empty line.
+    r_head . chunked = false;
+    r_head . length = 0;
+    r_head . keep_alive = false;
+    r_head . close = false;
+    r_head . expect_continue = false;
+    bool t_has_length;
+    t_has_length = false;
+    for(;;)
+    {
+        t_offset = t_next;
+        MCHttpRequestNextLine(p_buffer, p_end, t_offset, t_line_length, t_next);
+        if (t_line_length == 0)
+            break;
+
+        MCHttpRequestHeaderLine t_header;
+        t_line = p_buffer + t_offset;
+        t_line_end = t_line + t_line_length;
+
+        if (*t_line == ' ' || *t_line == '\t')
+        {
+            // A continuation of the previous header's value.
+            if (r_head . headers . Size() == 0)
+                return false;
+            t_header . name = nil;
+            t_header . name_length = 0;
+        }
+        else
+        {
+            t_header . name = t_line;
+            while (t_line < t_line_end && MCHttpRequestIsTokenChar(*t_line))
+                t_line++;
+            t_header . name_length = t_line - t_header . name;
+            if (t_header . name_length == 0 || t_line == t_line_end || *t_line++ != ':')
+                return false;
+        }
+
+        while (t_line < t_line_end && (*t_line == ' ' || *t_line == '\t'))
+            t_line++;
+        while (t_line_end > t_line && (t_line_end[-1] == ' ' || t_line_end[-1] == '\t'))
+            t_line_end--;
+        t_header . value = t_line;
+        t_header . value_length = t_line_end - t_line;
+
+        if (!r_head . headers . Push(t_header))
+            return false;
+
+        // Note the headers which determine how the request is framed.
+        if (t_header . name == nil)
+            continue;
+
+        if (MCHttpRequestSpanIsEqualTo(t_header . name, t_header . name_length, "Content-Length"))
+        {
+            uindex_t t_length;
+            if (!MCHttpRequestParseDecimal(t_header . value, t_header . value_length, t_length) ||
+                (t_has_length && t_length != r_head . length))
+                return false;
+            t_has_length = true;
+            r_head . length = t_length;
+        }
+        else if (MCHttpRequestSpanIsEqualTo(t_header . name, t_header . name_length, "Transfer-Encoding"))
+        {
+            if (MCHttpRequestListContains(t_header . value, t_header . value_length, "chunked"))
+                r_head . chunked = true;
+            else if (!MCHttpRequestListContains(t_header . value, t_header . value_length, "identity"))
+                return false;
+        }
+        else if (MCHttpRequestSpanIsEqualTo(t_header . name, t_header . name_length, "Connection"))
+        {
+            if (MCHttpRequestListContains(t_header . value, t_header . value_length, "close"))
+                r_head . close = true;
+            if (MCHttpRequestListContains(t_header . value, t_header . value_length, "keep-alive"))
+                r_head . keep_alive = true;
+        }
+        else if (MCHttpRequestSpanIsEqualTo(t_header . name, t_header . name_length, "Expect"))
+        {
+            if (MCHttpRequestSpanIsEqualTo(t_header . value, t_header . value_length, "100-continue"))
+                r_head . expect_continue = true;
+        }
+    }
+
+    // A chunked body takes precedence over any Content-Length (RFC 7230
+    // section 3.3.3).
+    if (r_head . chunked)
+        r_head . length = 0;
+
+    return true;
+}
+
+static MCHttpRequestParseStatus MCHttpRequestParseFrom(MCHttpRequestParser& x_parser, const char *p_buffer, uindex_t p_length, uindex_t p_max_body_size, uindex_t& r_consumed, bool& r_expect_continue, MCArrayRef& r_request)
+{
+    r_expect_continue = false;
+
+    // The header block is parsed as soon as it is complete, to find how the
+    // body is framed; after that only the body is scanned until it is
+    // complete too.
+    MCHttpRequestHead t_head;
+    bool t_have_head;
+    t_have_head = false;
+    if (x_parser . body_start == 0)
+    {
+        MCHttpRequestParseStatus t_status;
+        t_status = MCHttpRequestScanHead(x_parser, p_buffer, p_length);
+        if (t_status != kMCHttpRequestParseComplete)
+            return t_status;
+
+        if (!MCHttpRequestParseHead(p_buffer, x_parser . start, x_parser . body_start, t_head))
+            return kMCHttpRequestParseError;
+        t_have_head = true;
+
+        x_parser . chunked = t_head . chunked;
+        x_parser . expect_continue = t_head . expect_continue;
+        x_parser . body_length = t_head . length;
+    }
+
+    uindex_t t_end;
+    if (x_parser . chunked)
+    {
+        MCHttpRequestParseStatus t_status;
+        t_status = MCHttpRequestScanChunks(x_parser, p_buffer, p_length, p_max_body_size, t_end);
+        if (t_status != kMCHttpRequestParseComplete)
+        {
+            r_expect_continue = x_parser . expect_continue && t_status == kMCHttpRequestParseIncomplete;
+            return t_status;
+        }
+    }
+    else
+    {
+        if (x_parser . body_length > p_max_body_size)
+            return kMCHttpRequestParseTooLarge;
+
+        if (x_parser . body_length > p_length - x_parser . body_start)
+        {
+            r_expect_continue = x_parser . expect_continue && x_parser . body_length > 0;
+            return kMCHttpRequestParseIncomplete;
+        }
+        t_end = x_parser . body_start + x_parser . body_length;
+    }
+
+    // The request is complete, so build its description. The buffer may have
+    // moved since the header block was parsed, so it is parsed again if need
+    // be.
+    if (!t_have_head &&
+        !MCHttpRequestParseHead(p_buffer, x_parser . start, x_parser . body_start, t_head))
+        return kMCHttpRequestParseError;
+
+    MCAutoDataRef t_content;
+    if (x_parser . chunked)
+    {
+        MCAutoByteArray t_bytes;
+        if (!t_bytes . New(x_parser . body_length))
+            return kMCHttpRequestParseError;
+        MCHttpRequestCopyChunks(p_buffer, p_length, x_parser . body_start, t_bytes . Bytes());
+        if (!t_bytes . CreateDataAndRelease(&t_content))
+            return kMCHttpRequestParseError;
+    }
+    else if (!MCDataCreateWithBytes((const byte_t *)p_buffer + x_parser . body_start, x_parser . body_length, &t_content))
+        return kMCHttpRequestParseError;
+
+    const char *t_query;
+    t_query = (const char *)memchr(t_head . target, '?', t_head . target_length);
+
+    uindex_t t_resource_length;
+    if (t_query != nil)
+        t_resource_length = t_query++ - t_head . target;
+    else
+    {
+        t_resource_length = t_head . target_length;
+        t_query = t_head . target + t_head . target_length;
+    }
+
+    // HTTP/1.1 connections persist unless the client asks otherwise, whereas
+    // HTTP/1.0 connections persist only if the client asks.
+    bool t_persist;
+    if (t_head . version[7] == '0')
+        t_persist = t_head . keep_alive && !t_head . close;
+    else
+        t_persist = !t_head . close;
+
+    MCAutoArrayRef t_request, t_header_array;
+    if (!MCArrayCreateMutable(&t_request) ||
+        !MCHttpRequestStoreSpan(*t_request, "method", t_head . method, t_head . method_length) ||
+        !MCHttpRequestStoreSpan(*t_request, "resource", t_head . target, t_resource_length) ||
+        !MCHttpRequestStoreSpan(*t_request, "query", t_query, t_head . target + t_head . target_length - t_query) ||
+        !MCHttpRequestStoreSpan(*t_request, "version", t_head . version, t_head . version_length) ||
+        !MCHttpRequestBuildHeaders(t_head . headers . Ptr(), t_head . headers . Size(), &t_header_array) ||
+        !MCArrayStoreValue(*t_request, false, MCNAME("headers"), *t_header_array) ||
+        !MCArrayStoreValue(*t_request, false, MCNAME("content"), *t_content) ||
+        !MCArrayStoreValue(*t_request, false, MCNAME("keepalive"), t_persist ? kMCTrue : kMCFalse) ||
+        !t_request . MakeImmutable())
+        return kMCHttpRequestParseError;
+
+    r_consumed = t_end;
+    r_request = t_request . Take();
+    return kMCHttpRequestParseComplete;
+}
+
+void MCHttpRequestParserReset(MCHttpRequestParser& x_parser)
+{
+    MCMemoryClear(&x_parser, sizeof(MCHttpRequestParser));
+}
+
+MCHttpRequestParseStatus MCHttpRequestParse(MCHttpRequestParser& x_parser, const char *p_buffer, uindex_t p_length, uindex_t p_max_body_size, uindex_t& r_consumed, bool& r_expect_continue, MCArrayRef& r_request)
+{
+    MCHttpRequestParseStatus t_status;
+    t_status = MCHttpRequestParseFrom(x_parser, p_buffer, p_length, p_max_body_size, r_consumed, r_expect_continue, r_request);
+
+    // Whatever follows a complete (or rejected) request starts afresh.
+    if (t_status != kMCHttpRequestParseIncomplete)
+        MCHttpRequestParserReset(x_parser);
+
+    return t_status;
+}
@@ -0,0 +1,91 @@
+/* Copyright (C) 2003-2015 LiveCode Ltd.
+
+ This file is part of LiveCode.
+
+ LiveCode is free software; you can redistribute it and/or modify it under
+ the terms of the GNU General Public License v3 as published by the Free
+ Software Foundation.
+
+ LiveCode is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
+
+#ifndef __MC_HTTP_REQUEST__
+#define __MC_HTTP_REQUEST__
+
+// The largest request line and header block which will be accepted.
+#define kMCHttpRequestMaxHeaderSize (64 * 1024)
+
+// The largest request body which sockets accept by default.
+#define kMCHttpRequestMaxBodySize (64 * 1024 * 1024)
+
+enum MCHttpRequestParseStatus
+{
+    // The buffer does not yet contain a complete request.
+    kMCHttpRequestParseIncomplete,
+    // The buffer starts with a complete request.
+    kMCHttpRequestParseComplete,
+    // The buffer does not start with a well-formed request.
+    kMCHttpRequestParseError,
+    // The buffer starts with a request whose body is larger than allowed.
+    kMCHttpRequestParseTooLarge,
+};
+
+// The progress made parsing the request at the start of a buffer, so that
+// each call resumes where the previous one stopped rather than scanning the
+// request again from the start. Positions are held as offsets as the buffer
+// may be reallocated between calls.
+struct MCHttpRequestParser
+{
+    // The offset of the request line, after any preceding empty lines.
+    uindex_t start;
+    // The offset up to which the request has been scanned.
+    uindex_t offset;
+    // The offset of the body, or 0 if the header block is incomplete.
+    uindex_t body_start;
+    // The offset of the trailer of a chunked body, or 0 if the last chunk
+    // has not been reached.
+    uindex_t trailer_start;
+    // The length of the body, or the total size of the chunks scanned so far
+    // if it is chunked.
+    uindex_t body_length;
+    bool chunked;
+    bool expect_continue;
+};
+
+// Prepare x_parser for a new request at the start of a buffer.
+void MCHttpRequestParserReset(MCHttpRequestParser& x_parser);
+
+// Parse the HTTP/1.x request at the start of p_buffer, as used by sockets
+// accepted with 'accept http connections'.
+//
+// The buffer must only grow between calls with the same x_parser - if any of
+// it is discarded, x_parser must be reset. It is reset automatically when
+// anything other than kMCHttpRequestParseIncomplete is returned.
+//
+// If the request is complete, r_consumed is set to its length in bytes (any
+// bytes after this belong to the next, pipelined, request) and r_request to
+// an array with keys:
+//   "method"    - the request method
+//   "resource"  - the request target up to any '?'
+//   "query"     - the request target after the '?' (if any)
+//   "version"   - the protocol version, e.g. "HTTP/1.1"
+//   "headers"   - an array of header values keyed by name, repeated headers
+//                 being joined with ", "
+//   "content"   - the body as binary data, with any chunked transfer
+//                 encoding removed
+//   "keepalive" - true if the connection should persist after the response
+//
+// If the request is incomplete, r_expect_continue is set to true when the
+// headers are complete and ask the server to confirm with '100 Continue'
+// before the client sends the body.
+//
+// If the body is (or, when chunked, grows) larger than p_max_body_size then
+// kMCHttpRequestParseTooLarge is returned.
+MCHttpRequestParseStatus MCHttpRequestParse(MCHttpRequestParser& x_parser, const char *p_buffer, uindex_t p_length, uindex_t p_max_body_size, uindex_t& r_consumed, bool& r_expect_continue, MCArrayRef& r_request);
+
+#endif
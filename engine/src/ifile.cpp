@@ -36,6 +36,15 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 #include "module-resources.h"
 
+#if defined(_WIN32)
+#include <windows.h>
+#include <process.h>
+#elif !defined(__EMSCRIPTEN__)
+#include <pthread.h>
+#include <unistd.h>
+#define MC_IMAGE_ENCODE_USE_PTHREADS
+#endif
+
 //////////////////////////////////////////////////////////////////////
 
 // MW-2014-07-17: [[ ImageMetadata ]] Convert array to the metadata struct.
@@ -340,6 +349,130 @@ bool MCImageExport(MCImageBitmap *p_bitmap, Export_format p_format, MCImagePalet
 	return t_success;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+// The maximum number of images to encode at once.
+#define kMCImageEncodeMaxThreads 8
+
+struct MCImageEncodeThread
+{
+#if defined(_WIN32)
+	HANDLE handle;
+#elif defined(MC_IMAGE_ENCODE_USE_PTHREADS)
+	pthread_t handle;
+#endif
+};
+
+static void MCImageEncodeJobRun(MCImageEncodeJob *p_job)
+{
+	p_job -> data = nil;
+	p_job -> size = 0;
+
+	IO_handle t_stream;
+	t_stream = MCS_fakeopenwrite();
+
+	bool t_success;
+	t_success = t_stream != nil;
+	if (t_success)
+		t_success = MCImageExport(p_job -> bitmap, p_job -> format, p_job -> palette_settings, p_job -> dither, p_job -> metadata, t_stream, nil);
+
+	if (t_stream != nil &&
+		MCS_closetakingbuffer(t_stream, p_job -> data, p_job -> size) != IO_NORMAL)
+		t_success = false;
+
+	if (!t_success)
+	{
+		free(p_job -> data);
+		p_job -> data = nil;
+		p_job -> size = 0;
+	}
+
+	p_job -> success = t_success;
+}
+
+#if defined(_WIN32)
+static unsigned int __stdcall MCImageEncodeJobThread(void *p_context)
+{
+	MCImageEncodeJobRun((MCImageEncodeJob *)p_context);
+	return 0;
+}
+#elif defined(MC_IMAGE_ENCODE_USE_PTHREADS)
+static void *MCImageEncodeJobThread(void *p_context)
+{
+	MCImageEncodeJobRun((MCImageEncodeJob *)p_context);
+	return NULL;
+}
+#endif
+
+uindex_t MCImageEncodeJobsGetConcurrency(void)
+{
+	uindex_t t_cores;
+#if defined(_WIN32)
+	SYSTEM_INFO t_info;
+	GetSystemInfo(&t_info);
+	t_cores = t_info . dwNumberOfProcessors;
+#elif defined(MC_IMAGE_ENCODE_USE_PTHREADS) && defined(_SC_NPROCESSORS_ONLN)
+	long t_online;
+	t_online = sysconf(_SC_NPROCESSORS_ONLN);
+	t_cores = t_online > 0 ? (uindex_t)t_online : 1;
+#else
+	t_cores = 1;
+#endif
+
+	return MCMax(1U, MCMin(t_cores, (uindex_t)kMCImageEncodeMaxThreads));
+}
+
+void MCImageEncodeJobsStart(MCImageEncodeJob *p_jobs, uindex_t p_count)
+{
+	for(uindex_t i = 0; i < p_count; i++)
+	{
+		p_jobs[i] . success = false;
+		p_jobs[i] . thread = nil;
+
+#if defined(_WIN32) || defined(MC_IMAGE_ENCODE_USE_PTHREADS)
+		MCImageEncodeThread *t_thread;
+		t_thread = new (nothrow) MCImageEncodeThread;
+		if (t_thread == nil)
+			continue;
+
+		bool t_started;
+#if defined(_WIN32)
+		t_thread -> handle = (HANDLE)_beginthreadex(NULL, 0, MCImageEncodeJobThread, &p_jobs[i], 0, NULL);
+		t_started = t_thread -> handle != NULL;
+#else
+		t_started = pthread_create(&t_thread -> handle, NULL, MCImageEncodeJobThread, &p_jobs[i]) == 0;
+#endif
+		if (t_started)
+			p_jobs[i] . thread = t_thread;
+		else
+			delete t_thread;
+#endif
+	}
+}
+
+void MCImageEncodeJobsFinish(MCImageEncodeJob *p_jobs, uindex_t p_count)
+{
+	for(uindex_t i = 0; i < p_count; i++)
+	{
+		if (p_jobs[i] . thread == nil)
+		{
+			MCImageEncodeJobRun(&p_jobs[i]);
+			continue;
+		}
+
+#if defined(_WIN32)
+		WaitForSingleObject(p_jobs[i] . thread -> handle, INFINITE);
+		CloseHandle(p_jobs[i] . thread -> handle);
+#elif defined(MC_IMAGE_ENCODE_USE_PTHREADS)
+		pthread_join(p_jobs[i] . thread -> handle, NULL);
+#endif
+		delete p_jobs[i] . thread;
+		p_jobs[i] . thread = nil;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void MCImage::reopen(bool p_newfile, bool p_lock_size)
 {
 	if (!opened)
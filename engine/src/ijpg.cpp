@@ -951,6 +951,27 @@ bool MCImageEncodeJPEG(MCImageBitmap *p_image, MCImageMetadata *p_metadata, IO_h
 
 		jpeg_set_defaults(&t_jpeg);
 		jpeg_set_quality(&t_jpeg, MCjpegquality, TRUE);
+
+		// Apply the jpegChromaSubsampling setting by changing the sampling
+		// factors of the luminance component relative to the chroma ones.
+		switch (MCjpegchromasubsampling)
+		{
+			case kMCImageJPEGSubsampling420:
+				t_jpeg.comp_info[0].h_samp_factor = 2;
+				t_jpeg.comp_info[0].v_samp_factor = 2;
+				break;
+			case kMCImageJPEGSubsampling422:
+				t_jpeg.comp_info[0].h_samp_factor = 2;
+				t_jpeg.comp_info[0].v_samp_factor = 1;
+				break;
+			case kMCImageJPEGSubsampling444:
+				t_jpeg.comp_info[0].h_samp_factor = 1;
+				t_jpeg.comp_info[0].v_samp_factor = 1;
+				break;
+		}
+
+		if (MCjpegprogressive)
+			jpeg_simple_progression(&t_jpeg);
         
         if (p_metadata != nil)
         {
@@ -117,6 +117,32 @@ bool MCImageGetMetafileGeometry(IO_handle p_stream, uindex_t &r_width, uindex_t
 bool MCImageImport(IO_handle p_stream, IO_handle p_mask_stream, MCPoint &r_hotspot, MCStringRef &r_name, MCImageCompressedBitmap *&r_compressed, MCImageBitmap *&r_bitmap);
 bool MCImageExport(MCImageBitmap *p_bitmap, Export_format p_format, MCImagePaletteSettings *p_palette_settings, bool p_dither, MCImageMetadata *metadata, IO_handle p_stream, IO_handle p_mask_stream);
 
+// An image export which encodes into memory and so can be run on a worker
+// thread. On success the job's data is the encoded image, which the caller
+// must free.
+struct MCImageEncodeThread;
+struct MCImageEncodeJob
+{
+	MCImageBitmap *bitmap;
+	Export_format format;
+	MCImagePaletteSettings *palette_settings;
+	bool dither;
+	MCImageMetadata *metadata;
+
+	void *data;
+	size_t size;
+	bool success;
+
+	MCImageEncodeThread *thread;
+};
+
+// The number of encoding jobs it is worth running at the same time.
+uindex_t MCImageEncodeJobsGetConcurrency(void);
+// Start each job on its own thread, where possible.
+void MCImageEncodeJobsStart(MCImageEncodeJob *p_jobs, uindex_t p_count);
+// Wait for the jobs to finish, running any which could not be given a thread.
+void MCImageEncodeJobsFinish(MCImageEncodeJob *p_jobs, uindex_t p_count);
+
 bool MCImageDecode(IO_handle p_stream, MCBitmapFrame *&r_frames, uindex_t &r_frame_count);
 bool MCImageDecode(const uint8_t *p_data, uindex_t p_size, MCBitmapFrame *&r_frames, uindex_t &r_frame_count);
 
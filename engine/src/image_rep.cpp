@@ -25,6 +25,7 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #include "image_rep.h"
 
 #include "graphics_util.h"
+#include "pixelkernels.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -678,14 +679,15 @@ bool MCPixelDataImageRep::LoadImageFrames(MCBitmapFrame *&r_frames, uindex_t &r_
 			uint32_t *t_dst_pixel;
 			t_dst_pixel = (uint32_t*)t_dst_ptr;
 			
-			for (uint32_t x = 0; x < m_pixel_width; x++)
-			{
-//				if (x < t_pixel_width && i < t_pixel_count)
-				if (i < t_pixel_count)
-					*t_dst_pixel++ = MCGPixelToNative(m_pixel_format, t_src_ptr[i++]);
-				else
-					*t_dst_pixel++ = MCGPixelPackNative(0, 0, 0, 1);
-			}
+			// Convert as much of the row as there is pixel data for, and fill
+			// the rest with transparent black.
+			uint32_t t_row_count;
+			t_row_count = MCMin(m_pixel_width, t_pixel_count - i);
+			MCPixelRowSwizzle(t_src_ptr + i, m_pixel_format, t_dst_pixel, kMCGPixelFormatNative, t_row_count);
+			i += t_row_count;
+			
+			for (uint32_t x = t_row_count; x < m_pixel_width; x++)
+				t_dst_pixel[x] = MCGPixelPackNative(0, 0, 0, 1);
 			
 			t_dst_ptr += t_frames->image->stride;
 		}
@@ -25,6 +25,7 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #include "image.h"
 
 #include "imagebitmap.h"
+#include "pixelkernels.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -363,26 +364,7 @@ void MCImageBitmapPremultiplyRegion(MCImageBitmap *p_bitmap, int32_t p_sx, int32
 	uint8_t *t_dst_ptr = (uint8_t*)p_pixel_ptr + t_dst_x * 4 + t_dst_y * p_pixel_stride;
 	for (uindex_t y = 0; y < t_height; y++)
 	{
-		uint32_t *t_src_row = (uint32_t*)t_src_ptr;
-		uint32_t *t_dst_row = (uint32_t *)t_dst_ptr;
-		for (uindex_t x = 0; x < t_width; x++)
-		{
-			uint32_t t_pixel = *t_src_row++;
-			uint8_t t_alpha = t_pixel >> 24;
-
-			if (t_alpha == 0)
-				t_pixel = 0;
-			else if (t_alpha != 0xFF)
-			{
-				uint4 u, v;
-				u = ((t_pixel & 0xff00ff) * t_alpha) + 0x800080;
-				u = ((u + ((u >> 8) & 0xff00ff)) >> 8) & 0xff00ff;
-				v = ((t_pixel & 0x00ff00) * t_alpha) + 0x8000;
-				v = ((v + ((v >> 8) & 0x00ff00)) >> 8) & 0x00ff00;
-				t_pixel = (u + v) | (t_alpha << 24);
-			}
-			*t_dst_row++ = t_pixel;
-		}
+		MCPixelRowPremultiply((uint32_t *)t_src_ptr, (uint32_t *)t_dst_ptr, t_width);
 		t_src_ptr += p_bitmap->stride;
 		t_dst_ptr += p_pixel_stride;
 	}
@@ -396,25 +378,7 @@ void MCImageBitmapPremultiply(MCImageBitmap *p_bitmap)
 	uint8_t *t_src_ptr = (uint8_t*) p_bitmap->data;
 	for (uindex_t y = 0; y < p_bitmap->height; y++)
 	{
-		uint32_t *t_src_row = (uint32_t*)t_src_ptr;
-		for (uindex_t x = 0; x < p_bitmap->width; x++)
-		{
-			uint32_t t_pixel = *t_src_row;
-			uint8_t t_alpha = t_pixel >> 24;
-
-			if (t_alpha == 0)
-				t_pixel = 0;
-			else if (t_alpha != 0xFF)
-			{
-				uint4 u, v;
-				u = ((t_pixel & 0xff00ff) * t_alpha) + 0x800080;
-				u = ((u + ((u >> 8) & 0xff00ff)) >> 8) & 0xff00ff;
-				v = ((t_pixel & 0x00ff00) * t_alpha) + 0x8000;
-				v = ((v + ((v >> 8) & 0x00ff00)) >> 8) & 0x00ff00;
-				t_pixel = (u + v) | (t_alpha << 24);
-			}
-			*t_src_row++ = t_pixel;
-		}
+		MCPixelRowPremultiply((uint32_t *)t_src_ptr, (uint32_t *)t_src_ptr, p_bitmap->width);
 		t_src_ptr += p_bitmap->stride;
 	}
 }
@@ -436,19 +400,7 @@ void MCImageBitmapUnpremultiply(MCImageBitmap *p_bitmap)
 	uint8_t *t_src_ptr = (uint8_t*) p_bitmap->data;
 	for (uindex_t y = 0; y < p_bitmap->height; y++)
 	{
-		uint32_t *t_src_row = (uint32_t*)t_src_ptr;
-		for (uindex_t x = 0; x < p_bitmap->width; x++)
-		{
-			uint32_t t_pixel = *t_src_row;
-			uint8_t t_alpha = t_pixel >> 24;
-
-			if (t_alpha == 0)
-				t_pixel = 0;
-			else if (t_alpha != 255)
-				t_pixel = (t_alpha << 24) | packed_divide_bounded(t_pixel, t_alpha);
-
-			*t_src_row++ = t_pixel;
-		}
+		MCPixelRowUnpremultiply((uint32_t *)t_src_ptr, (uint32_t *)t_src_ptr, p_bitmap->width);
 		t_src_ptr += p_bitmap->stride;
 	}
 }
@@ -229,6 +229,39 @@ private:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Sets the result to the hits, misses, bytes used and maximum bytes of the
+// cache of shaped text, or to empty on platforms where the system shapes text
+// itself.
+class MCInternalTextShapeCacheStatistics: public MCStatement
+{
+public:
+	Parse_stat parse(MCScriptPoint& sp)
+	{
+		return PS_NORMAL;
+	}
+
+    void exec_ctxt(MCExecContext &ctxt)
+    {
+        MCGTextShapeCacheStatistics t_statistics;
+        if (!MCGTextShapeCacheGetStatistics(t_statistics))
+        {
+            ctxt.SetTheResultToEmpty();
+            return;
+        }
+        
+        MCAutoStringRef t_statistics_string;
+        if (!MCStringFormat(&t_statistics_string, "%u,%u,%lu,%lu", t_statistics.hits, t_statistics.misses, (unsigned long)t_statistics.bytes_used, (unsigned long)t_statistics.max_bytes))
+        {
+            ctxt.Throw();
+            return;
+        }
+        
+        ctxt.SetTheResultToValue(*t_statistics_string);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
 template<class T> inline MCStatement *class_factory(void)
 {
 	return new T;
@@ -237,6 +270,7 @@ template<class T> inline MCStatement *class_factory(void)
 MCInternalVerbInfo MCinternalverbs_base[] =
 {
 	{ "vectorpath", "getbbox", class_factory<MCInternalVectorPathGetBBox> },
+	{ "textshapecache", "statistics", class_factory<MCInternalTextShapeCacheStatistics> },
     { nullptr, nullptr, nullptr},
 };
 
@@ -31,6 +31,8 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 #include "imageloader.h"
 
+#include "foundation-filters.h"
+
 #define NATIVE_ALPHA_BEFORE ((kMCGPixelFormatNative & kMCGPixelAlphaPositionFirst) == kMCGPixelAlphaPositionFirst)
 
 #define NATIVE_ORDER_BGR ((kMCGPixelFormatNative & kMCGPixelOrderRGB) == 0)
@@ -406,6 +408,213 @@ static void parsemetadata(png_structp png_ptr, png_infop info_ptr, MCImageMetada
     }
 }
 
+// Apply the pngCompressionLevel and pngFilter settings to the encoder.
+static void MCPNGSetEncodeOptions(png_structp p_png)
+{
+	png_set_compression_level(p_png, MCpngcompressionlevel);
+
+	int t_filters;
+	switch (MCpngfilter)
+	{
+		case kMCImagePNGFilterNone:
+			t_filters = PNG_FILTER_NONE;
+			break;
+		case kMCImagePNGFilterSub:
+			t_filters = PNG_FILTER_SUB;
+			break;
+		case kMCImagePNGFilterUp:
+			t_filters = PNG_FILTER_UP;
+			break;
+		case kMCImagePNGFilterAverage:
+			t_filters = PNG_FILTER_AVG;
+			break;
+		case kMCImagePNGFilterPaeth:
+			t_filters = PNG_FILTER_PAETH;
+			break;
+		case kMCImagePNGFilterAdaptive:
+			t_filters = PNG_ALL_FILTERS;
+			break;
+		default:
+			return;
+	}
+
+	png_set_filter(p_png, PNG_FILTER_TYPE_BASE, t_filters);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Truecolor images with at least this many pixels are filtered here and then
+// deflated in parallel blocks, rather than being passed row by row through
+// libpng's single-threaded encoder.
+#define kMCPNGParallelEncodeMinPixels (512 * 1024)
+
+// The maximum size of each IDAT chunk written by the parallel encoder.
+#define kMCPNGMaxIDATChunkSize (1024 * 1024)
+
+static inline uint8_t MCPNGPaethPredictor(uint8_t a, uint8_t b, uint8_t c)
+{
+	int32_t p = int32_t(a) + int32_t(b) - int32_t(c);
+	int32_t pa = p > a ? p - a : a - p;
+	int32_t pb = p > b ? p - b : b - p;
+	int32_t pc = p > c ? p - c : c - p;
+	if (pa <= pb && pa <= pc)
+		return a;
+	if (pb <= pc)
+		return b;
+	return c;
+}
+
+// Apply the filter of the given type (one of the PNG_FILTER_VALUE_* constants)
+// to a row, writing the filtered bytes to r_filtered. The previous row is all
+// zeros for the first row of the image.
+static void MCPNGFilterRow(int p_type, const uint8_t *p_row, const uint8_t *p_prev, uindex_t p_length, uindex_t p_bpp, uint8_t *r_filtered)
+{
+	// The first pixel of each row has no left neighbour, so the left and
+	// upper-left values are zero.
+	switch (p_type)
+	{
+		case PNG_FILTER_VALUE_NONE:
+			MCMemoryCopy(r_filtered, p_row, p_length);
+			break;
+
+		case PNG_FILTER_VALUE_SUB:
+			for (uindex_t i = 0; i < p_bpp; i++)
+				r_filtered[i] = p_row[i];
+			for (uindex_t i = p_bpp; i < p_length; i++)
+				r_filtered[i] = p_row[i] - p_row[i - p_bpp];
+			break;
+
+		case PNG_FILTER_VALUE_UP:
+			for (uindex_t i = 0; i < p_length; i++)
+				r_filtered[i] = p_row[i] - p_prev[i];
+			break;
+
+		case PNG_FILTER_VALUE_AVG:
+			for (uindex_t i = 0; i < p_bpp; i++)
+				r_filtered[i] = p_row[i] - (p_prev[i] >> 1);
+			for (uindex_t i = p_bpp; i < p_length; i++)
+				r_filtered[i] = p_row[i] - ((p_row[i - p_bpp] + p_prev[i]) >> 1);
+			break;
+
+		case PNG_FILTER_VALUE_PAETH:
+			for (uindex_t i = 0; i < p_bpp; i++)
+				r_filtered[i] = p_row[i] - p_prev[i];
+			for (uindex_t i = p_bpp; i < p_length; i++)
+				r_filtered[i] = p_row[i] - MCPNGPaethPredictor(p_row[i - p_bpp], p_prev[i], p_prev[i - p_bpp]);
+			break;
+	}
+}
+
+// The heuristic libpng uses to choose a filter adaptively: the sum of the
+// filtered bytes, treated as signed values.
+static uint32_t MCPNGFilteredRowCost(const uint8_t *p_filtered, uindex_t p_length)
+{
+	uint32_t t_cost = 0;
+	for (uindex_t i = 0; i < p_length; i++)
+		t_cost += p_filtered[i] < 128 ? p_filtered[i] : 256 - p_filtered[i];
+	return t_cost;
+}
+
+// Convert the bitmap to filtered RGB or RGBA scanlines and deflate them into a
+// zlib stream suitable for the image's IDAT chunks.
+static bool MCPNGCompressBitmap(MCImageBitmap *p_bitmap, bool p_opaque, MCDataRef& r_data)
+{
+	uindex_t t_bpp = p_opaque ? 3 : 4;
+	uindex_t t_row_length = p_bitmap->width * t_bpp;
+
+	// Which filter to use for every row, or -1 to choose adaptively. The
+	// default for truecolor images is adaptive, as in libpng.
+	int t_filter;
+	switch (MCpngfilter)
+	{
+		case kMCImagePNGFilterNone:
+			t_filter = PNG_FILTER_VALUE_NONE;
+			break;
+		case kMCImagePNGFilterSub:
+			t_filter = PNG_FILTER_VALUE_SUB;
+			break;
+		case kMCImagePNGFilterUp:
+			t_filter = PNG_FILTER_VALUE_UP;
+			break;
+		case kMCImagePNGFilterAverage:
+			t_filter = PNG_FILTER_VALUE_AVG;
+			break;
+		case kMCImagePNGFilterPaeth:
+			t_filter = PNG_FILTER_VALUE_PAETH;
+			break;
+		default:
+			t_filter = -1;
+			break;
+	}
+
+	// Level 0 stores the data uncompressed, so filtering would only waste time.
+	if (MCpngcompressionlevel == 0)
+		t_filter = PNG_FILTER_VALUE_NONE;
+
+	MCAutoByteArray t_filtered;
+	MCAutoPointer<uint8_t[]> t_rows = new (nothrow) uint8_t[t_row_length * 2];
+	MCAutoPointer<uint8_t[]> t_scratch = new (nothrow) uint8_t[t_row_length];
+	if (!t_rows || !t_scratch ||
+		!t_filtered.New((t_row_length + 1) * p_bitmap->height))
+		return false;
+
+	uint8_t *t_row = t_rows.Get();
+	uint8_t *t_prev = t_rows.Get() + t_row_length;
+	MCMemoryClear(t_prev, t_row_length);
+
+	uint8_t *t_out = t_filtered.Bytes();
+	for (uindex_t y = 0; y < p_bitmap->height; y++)
+	{
+		const uint32_t *t_pixels = (const uint32_t *)((const uint8_t *)p_bitmap->data + y * p_bitmap->stride);
+		uint8_t *t_dst = t_row;
+		for (uindex_t x = 0; x < p_bitmap->width; x++)
+		{
+			uint8_t r, g, b, a;
+			MCGPixelUnpackNative(t_pixels[x], r, g, b, a);
+			t_dst[0] = r;
+			t_dst[1] = g;
+			t_dst[2] = b;
+			if (!p_opaque)
+				t_dst[3] = a;
+			t_dst += t_bpp;
+		}
+
+		if (t_filter != -1)
+		{
+			t_out[0] = t_filter;
+			MCPNGFilterRow(t_filter, t_row, t_prev, t_row_length, t_bpp, t_out + 1);
+		}
+		else
+		{
+			// Try each filter and keep the one with the lowest cost, writing
+			// the best so far straight into the output.
+			uint32_t t_best_cost = UINT32_MAX;
+			for (int t_type = PNG_FILTER_VALUE_NONE; t_type <= PNG_FILTER_VALUE_PAETH; t_type++)
+			{
+				MCPNGFilterRow(t_type, t_row, t_prev, t_row_length, t_bpp, t_scratch.Get());
+				uint32_t t_cost = MCPNGFilteredRowCost(t_scratch.Get(), t_row_length);
+				if (t_cost < t_best_cost)
+				{
+					t_best_cost = t_cost;
+					t_out[0] = t_type;
+					MCMemoryCopy(t_out + 1, t_scratch.Get(), t_row_length);
+				}
+			}
+		}
+
+		t_out += t_row_length + 1;
+		uint8_t *t_tmp = t_prev;
+		t_prev = t_row;
+		t_row = t_tmp;
+	}
+
+	// Deflate on one thread per processor. Threads which can't be started
+	// leave their blocks to the calling thread.
+	return MCFiltersZlibCompressBytes(t_filtered.Bytes(), t_filtered.ByteCount(), MCpngcompressionlevel, 0, r_data);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 bool MCImageEncodePNG(MCImageIndexedBitmap *p_indexed, MCImageMetadata *p_metadata, IO_handle p_stream, uindex_t &r_bytes_written)
 {
 	bool t_success = true;
@@ -480,7 +689,10 @@ bool MCImageEncodePNG(MCImageIndexedBitmap *p_indexed, MCImageMetadata *p_metada
 		}
 	}
 	if (t_success)
+	{
+		MCPNGSetEncodeOptions(t_png_ptr);
 		png_write_info(t_png_ptr, t_info_ptr);
+	}
 
 	if (t_success)
 	{
@@ -529,6 +741,8 @@ bool MCImageEncodePNG(MCImageBitmap *p_bitmap, MCImageMetadata *p_metadata, IO_h
 	png_bytep t_data_ptr = nil;
 	uindex_t t_stride = 0;
 
+	MCDataRef t_idat_data = nil;
+
 	MCImageIndexedBitmap *t_indexed = nil;
 	if (MCImageConvertBitmapToIndexed(p_bitmap, false, t_indexed))
 	{
@@ -572,31 +786,58 @@ bool MCImageEncodePNG(MCImageBitmap *p_bitmap, MCImageMetadata *p_metadata, IO_h
 
 	if (t_success)
 	{
+		MCPNGSetEncodeOptions(t_png_ptr);
 		png_write_info(t_png_ptr, t_info_ptr);
-
-		if (t_fully_opaque)
-			png_set_filler(t_png_ptr, 0, MCPNG_FILLER_POSITION);
-		
-		MCPNGSetNativePixelFormat(t_png_ptr);
 	}
 
-	if (t_success)
+	// Large images are filtered and compressed here, with the deflate work
+	// spread across threads, and the result is written as IDAT chunks.
+	if (t_success &&
+		p_bitmap->width * p_bitmap->height >= kMCPNGParallelEncodeMinPixels)
 	{
-		t_data_ptr = (png_bytep)p_bitmap->data;
-		t_stride = p_bitmap->stride;
-	}
+		t_success = MCPNGCompressBitmap(p_bitmap, t_fully_opaque, t_idat_data);
 
-	if (t_success)
-	{
-		for (uindex_t i = 0; i < p_bitmap->height; i++)
+		if (t_success)
 		{
-			png_write_row(t_png_ptr, t_data_ptr);
-			t_data_ptr += t_stride;
+			const byte_t *t_idat_bytes = MCDataGetBytePtr(t_idat_data);
+			uindex_t t_idat_length = MCDataGetLength(t_idat_data);
+			for (uindex_t t_offset = 0; t_offset < t_idat_length; t_offset += kMCPNGMaxIDATChunkSize)
+				png_write_chunk(t_png_ptr, (png_const_bytep)"IDAT", t_idat_bytes + t_offset,
+								MCMin(t_idat_length - t_offset, (uindex_t)kMCPNGMaxIDATChunkSize));
+
+			// libpng did not write the image data itself, so png_write_end()
+			// would fail - write the IEND chunk directly instead.
+			png_write_chunk(t_png_ptr, (png_const_bytep)"IEND", nil, 0);
 		}
 	}
+	else
+	{
+		if (t_success)
+		{
+			if (t_fully_opaque)
+				png_set_filler(t_png_ptr, 0, MCPNG_FILLER_POSITION);
 
-	if (t_success)
-		png_write_end(t_png_ptr, t_info_ptr);
+			MCPNGSetNativePixelFormat(t_png_ptr);
+		}
+
+		if (t_success)
+		{
+			t_data_ptr = (png_bytep)p_bitmap->data;
+			t_stride = p_bitmap->stride;
+		}
+
+		if (t_success)
+		{
+			for (uindex_t i = 0; i < p_bitmap->height; i++)
+			{
+				png_write_row(t_png_ptr, t_data_ptr);
+				t_data_ptr += t_stride;
+			}
+		}
+
+		if (t_success)
+			png_write_end(t_png_ptr, t_info_ptr);
+	}
 
 	if (t_png_ptr != nil)
 		png_destroy_write_struct(&t_png_ptr, &t_info_ptr);
@@ -604,6 +845,8 @@ bool MCImageEncodePNG(MCImageBitmap *p_bitmap, MCImageMetadata *p_metadata, IO_h
 		MCMemoryDeleteArray(t_png_palette);
 	if (t_png_transparency != nil)
 		MCMemoryDeallocate(t_png_transparency);
+	if (t_idat_data != nil)
+		MCValueRelease(t_idat_data);
 
 	if (t_success)
 		r_bytes_written = t_context.byte_count;
@@ -24,6 +24,7 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #include "image.h"
 
 #include "iquantization.h"
+#include "pixelkernels.h"
 
 //#define IQSQUARELOOKUP
 #define IQDISTLOOKUP
@@ -266,66 +267,9 @@ bool MCImageQuantizeImageBitmap(MCImageBitmap *p_bitmap, MCColor *p_colors, uind
 // to work on bitmap data in-place.
 bool MCImageDitherAlphaInPlace(MCImageBitmap *p_bitmap)
 {
-	uint8_t *t_src_ptr = (uint8_t*)p_bitmap->data;
-
-	int32_t *t_error_buffer;
-	if (!MCMemoryNewArray<int32_t>(p_bitmap->width * 2, t_error_buffer))
+	if (!MCPixelDitherAlpha(p_bitmap->data, p_bitmap->stride, p_bitmap->width, p_bitmap->height))
 		return false;
 
-	int32_t *t_current_errors = t_error_buffer;
-	int32_t *t_next_errors = t_error_buffer + p_bitmap->width;
-
-	for (uint32_t y = 0; y < p_bitmap->height; y++)
-	{
-		uint32_t *t_src_row = (uint32_t*)t_src_ptr;
-
-		uint32_t width = p_bitmap->width;
-		uint32_t t_error_index = 0;
-
-		bool reverse = false;
-		int32_t t_direction = 1;
-
-		if (y & 1)
-		{
-			t_src_row += width - 1;
-
-			reverse = true;
-			t_direction = -1;
-
-			t_error_index = (width - 1);
-		}
-
-		while (width--)
-		{
-			int32_t t_alpha = (int32_t)MCGPixelGetNativeAlpha(*t_src_row) + t_current_errors[t_error_index];
-			int32_t t_newalpha = t_alpha < 128 ? 0 : 255;
-
-			int32_t t_error = t_alpha - t_newalpha;
-			*t_src_row = MCGPixelSetNativeAlpha(*t_src_row, t_newalpha);
-
-			if (width > 0)
-				t_current_errors[t_error_index + t_direction] += (7 * t_error + 8) / 16;
-			if (y + 1 < p_bitmap->height)
-			{
-				if (width + 1 < p_bitmap->width)
-					t_next_errors[t_error_index - t_direction] += (3 * t_error + 8) / 16;
-				t_next_errors[t_error_index] += (5 * t_error + 8) / 16;
-				if (width > 0)
-					t_next_errors[t_error_index + t_direction] += (1 * t_error + 8) / 16;
-			}
-
-			t_src_row += t_direction;
-			t_error_index += t_direction;
-		}
-		int32_t *t_tmp_ptr;
-		t_tmp_ptr = t_next_errors; t_next_errors = t_current_errors; t_current_errors = t_tmp_ptr;
-		MCMemoryClear(t_next_errors, sizeof(int32_t) * p_bitmap->width);
-
-		t_src_ptr += p_bitmap->stride;
-	}
-
-	MCMemoryDeleteArray(t_error_buffer);
-
 	p_bitmap->has_alpha = false;
 
 	return true;
@@ -25,14 +25,11 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #include "uidc.h"
 
 #include "imagebitmap.h"
+#include "pixelkernels.h"
 
 // Universal double comparison threshold
 #define EPS 1e-8
 
-#ifndef __VISUALC__
-#define __forceinline inline
-#endif
-
 // ---------------
 // Resizing 32-32
 // ---------------
@@ -248,190 +245,6 @@ static void resize_seq_32_32(	const uint1* const src_data, const int src_n, cons
 
 // Sizing
 
-static void scaleimage_nearest(void *p_src_ptr, uint4 p_src_stride, void *p_dst_ptr, uint4 p_dst_stride, uint4 p_src_width, uint4 p_src_height, uint4 p_dst_width, uint4 p_dst_height)
-{
-	unsigned int t_ix, t_iy;
-	t_ix = (65536 * p_src_width) / p_dst_width;
-	t_iy = (65536 * p_src_height) / p_dst_height;
-
-	unsigned int t_sy;
-	t_sy = 0;
-
-	unsigned int t_src_stride, t_dst_stride;
-	t_src_stride = p_src_stride >> 2;
-	t_dst_stride = p_dst_stride >> 2;
-
-	unsigned int *t_src_pixel, *t_dst_pixel;
-	t_src_pixel = (unsigned int *)p_src_ptr;
-	t_dst_pixel = (unsigned int *)p_dst_ptr;
-
-	unsigned int t_dy;
-	t_dy = p_dst_height;
-	while(t_dy-- > 0)
-	{
-		unsigned int *t_src_pixel_current;
-		t_src_pixel_current = t_src_pixel + (t_sy >> 16) * t_src_stride;
-
-		unsigned int *t_dst_pixel_current;
-		t_dst_pixel_current = t_dst_pixel;
-
-		unsigned int t_sx;
-		t_sx = 0;
-
-		unsigned int t_dx;
-		t_dx = p_dst_width;
-
-		while(t_dx-- > 0)
-		{
-			*t_dst_pixel_current++ = t_src_pixel_current[t_sx >> 16];
-			t_sx += t_ix;
-		}
-
-		t_sy += t_iy;
-		t_dst_pixel += t_dst_stride;
-	}
-}
-
-static void scaleimage_box(void *p_src_ptr, uint4 p_src_stride, void *p_dst_ptr, uint4 p_dst_stride, uint4 p_src_width, uint4 p_src_height, uint4 p_dst_width, uint4 p_dst_height, bool p_has_alpha)
-{
-	scaleimage_nearest(p_src_ptr, p_src_stride, p_dst_ptr, p_dst_stride, p_src_width, p_src_height, p_dst_width, p_dst_height);
-}
-
-__forceinline unsigned int packed_bilinear_bounded_4(unsigned int x, unsigned char a, unsigned int y, unsigned char b, unsigned z, unsigned char c, unsigned int w, unsigned char d)
-{
-	unsigned int u, v;
-
-	u = (x & 0xff00ff) * a + (y & 0xff00ff) * b + (z & 0xff00ff) * c + (w & 0xff00ff) * d + 0x800080;
-	u = ((u + ((u >> 8) & 0xff00ff)) >> 8) & 0xff00ff;
-
-	v = ((x >> 8) & 0xff00ff) * a + ((y >> 8) & 0xff00ff) * b + ((z >> 8) & 0xff00ff) * c + ((w >> 8) & 0xff00ff) * d + 0x800080;
-	v = (v + ((v >> 8) & 0xff00ff)) & 0xff00ff00;
-
-	return u | v;
-}
-
-__forceinline unsigned int packed_bilinear_combine_4(unsigned char x, unsigned char y, unsigned int f00, unsigned int f10, unsigned int f01, unsigned int f11)
-{
-	unsigned char x_y, ix_y, x_iy, ix_iy;
-
-	unsigned int u;
-	u = x * y + 0x80;
-	u = (u + (u >> 8)) >> 8;
-
-	x_y = u ;
-	ix_y = y - x_y;
-	x_iy = x - x_y;
-	ix_iy = (255 - y) - x_iy;
-
-	return packed_bilinear_bounded_4(f00, ix_iy, f10, x_iy, f01, ix_y, f11, x_y);
-}
-
-static void scaleimage_bilinear(void *p_src_ptr, uint4 p_src_stride, void *p_dst_ptr, uint4 p_dst_stride, uint4 p_src_width, uint4 p_src_height, uint4 p_dst_width, uint4 p_dst_height)
-{
-	unsigned int t_dst_stride;
-	t_dst_stride = p_dst_stride / 4;
-	unsigned int *t_dst_pixel;
-	t_dst_pixel = (unsigned int *)p_dst_ptr;
-
-	unsigned int t_src_stride;
-	t_src_stride = p_src_stride / 4;
-	unsigned int *t_src_pixel;
-	t_src_pixel = (unsigned int *)p_src_ptr;
-
-	unsigned int t_ax;
-	t_ax = p_src_width * 256;
-	int t_bx;
-	t_bx = p_dst_width;
-	unsigned int t_sx;
-	t_sx = t_ax / t_bx;
-	unsigned int t_tx;
-	t_tx = t_ax % t_bx;
-
-	unsigned int t_ay;
-	t_ay = p_src_height * 256;
-	int t_by;
-	t_by = p_dst_height;
-	unsigned int t_sy;
-	t_sy = t_ay / t_by;
-	unsigned int t_ty;
-	t_ty = t_ay % t_by;
-
-	unsigned int t_qy;
-	t_qy = 0;
-	
-	int t_ry;
-	t_ry = -t_by;
-
-	unsigned int t_y;
-	t_y = p_dst_height;
-	while(t_y-- > 0)
-	{
-		unsigned int t_qx;
-		t_qx = 0;
-		
-		int t_rx;
-		t_rx = -t_bx;	
-		
-		unsigned int t_iy, t_fy;
-		t_iy = t_qy / 256;
-		t_fy = t_qy & 0xFF;
-
-		unsigned int *t_src_pixel_0, *t_src_pixel_1;
-		t_src_pixel_0 = t_src_pixel + t_iy * t_src_stride;
-		t_src_pixel_1 = t_src_pixel_0;
-		if (t_iy < p_src_height - 1)
-			t_src_pixel_1 += t_src_stride;
-
-		unsigned int t_x;
-		t_x = p_dst_width;
-
-		unsigned int *t_dst_pixel_current;
-		t_dst_pixel_current = t_dst_pixel;
-
-		while(t_x-- > 0)
-		{
-			unsigned int t_ix, t_fx;
-			t_ix = t_qx / 256;
-			t_fx = t_qx & 0xFF;
-
-			unsigned int t_p00, t_p10, t_p01, t_p11;
-			t_p00 = t_src_pixel_0[t_ix];
-			t_p01 = t_src_pixel_1[t_ix];
-			if (t_ix < p_src_width - 1)
-			{
-				t_p10 = t_src_pixel_0[t_ix + 1];
-				t_p11 = t_src_pixel_1[t_ix + 1];
-			}
-			else
-			{
-				t_p10 = t_p00;
-				t_p11 = t_p01;
-			}
-
-			*t_dst_pixel_current = packed_bilinear_combine_4(t_fx, t_fy, t_p00, t_p10, t_p01, t_p11);
-			t_dst_pixel_current++;
-
-			t_qx += t_sx;
-			t_rx += t_tx;
-			if (t_rx >= 0)
-			{
-				t_qx++;
-				t_rx -= t_bx;
-			}
-		}
-
-		t_dst_pixel += t_dst_stride;
-
-		t_qy += t_sy;
-		t_ry += t_ty;
-		if (t_ry >= 0)
-		{
-			t_qy++;
-			t_ry -= t_by;
-		}
-	}
-}
-
 static void scaleimage_bicubic(void *p_src_ptr, uint4 p_src_stride, void *p_dst_ptr, uint4 p_dst_stride, uint4 p_src_width, uint4 p_src_height, uint4 p_dst_width, uint4 p_dst_height)
 {
 	int i;
@@ -550,12 +363,11 @@ bool MCImageScaleBitmap(MCImageBitmap *p_src_bitmap, uindex_t p_width, uindex_t
 	
 	// MW-2013-04-05: [[ Bug 10812 ]] Make sure we pass whether the image has transparency through to the box
 	//   filter - otherwise nearest is used.
-	if (p_quality == INTERPOLATION_NEAREST)
-		scaleimage_nearest(t_src_ptr, t_src_stride, t_dst_ptr, t_dst_stride, owidth, oheight, p_width, p_height);
-	else if (p_quality == INTERPOLATION_BOX)
-		scaleimage_box(t_src_ptr, t_src_stride, t_dst_ptr, t_dst_stride, owidth, oheight, p_width, p_height, p_src_bitmap -> has_transparency);
+	//   (The box filter currently samples the nearest pixel as well.)
+	if (p_quality == INTERPOLATION_NEAREST || p_quality == INTERPOLATION_BOX)
+		MCPixelScaleNearest(t_src_ptr, t_src_stride, owidth, oheight, t_dst_ptr, t_dst_stride, p_width, p_height);
 	else if (p_quality == INTERPOLATION_BILINEAR)
-		scaleimage_bilinear(t_src_ptr, t_src_stride, t_dst_ptr, t_dst_stride, owidth, oheight, p_width, p_height);
+		MCPixelScaleBilinear(t_src_ptr, t_src_stride, owidth, oheight, t_dst_ptr, t_dst_stride, p_width, p_height);
 	else if (p_quality == INTERPOLATION_BICUBIC)
 		scaleimage_bicubic(t_src_ptr, t_src_stride, t_dst_ptr, t_dst_stride, owidth, oheight, p_width, p_height);
 
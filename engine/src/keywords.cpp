@@ -500,6 +500,7 @@ MCRepeat::MCRepeat()
 	loopvar = NULL;
 	step = NULL;
 	statements = NULL;
+	in_file = false;
 }
 
 MCRepeat::~MCRepeat()
@@ -593,11 +594,40 @@ Parse_stat MCRepeat::parse(MCScriptPoint &sp)
                         }
                         
                         t_is_for_each = true;
+                        
+                        // 'repeat for each line|item <var> in file <expr>'
+                        //  iterates over the chunks of a file without loading
+                        //  it all. If 'file' is not followed by a filename
+                        //  expression then it is a variable.
+                        if (each == FU_LINE || each == FU_ITEM)
+                        {
+                            if (sp.next(type) == PS_NORMAL
+                                    && type == ST_ID
+                                    && sp.token_is_cstring("file"))
+                            {
+                                MCScriptPoint oldsp(sp);
+                                MCerrorlock++;
+                                if (sp.parseexp(False, True, &endcond) == PS_NORMAL
+                                        && sp.is_eol())
+                                    in_file = true;
+                                else
+                                {
+                                    delete endcond;
+                                    endcond = NULL;
+                                    sp = oldsp;
+                                }
+                                MCerrorlock--;
+                            }
+                            
+                            if (!in_file)
+                                sp.backup();
+                        }
 					}
                     
                     // SN-2015-06-18: [[ Bug 15509 ]] Both 'repeat for each' and
                     //  'repeat for <expr> times' need an expression
-                    if (sp.parseexp(False, True, &endcond) != PS_NORMAL)
+                    if (endcond == NULL
+                            && sp.parseexp(False, True, &endcond) != PS_NORMAL)
                     {
                         MCperror->add
                         (PE_REPEAT_BADCOND, sp);
@@ -821,7 +851,9 @@ void MCRepeat::exec_ctxt(MCExecContext& ctxt)
     switch (form)
 	{
         case RF_FOR:
-            if (loopvar != nil)
+            if (in_file)
+                MCKeywordsExecRepeatForEachInFile(ctxt, statements, endcond, loopvar, each, line, pos);
+            else if (loopvar != nil)
                 MCKeywordsExecRepeatFor(ctxt, statements, endcond, loopvar, each, line, pos);
             else
                 MCKeywordsExecRepeatCount(ctxt, statements, endcond, line, pos);
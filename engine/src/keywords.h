@@ -100,6 +100,7 @@ class MCRepeat : public MCStatement
 	MCExpression *step;
 	MCStatement *statements;
 	File_unit each;
+	bool in_file;
 public:
 	MCRepeat();
 	~MCRepeat();
@@ -251,6 +251,7 @@ const static LT accept_table[] =
         {"connections", TT_UNDEFINED, AC_CONNECTIONS},
         {"datagram", TT_UNDEFINED, AC_DATAGRAM},
         {"datagrams", TT_UNDEFINED, AC_DATAGRAM},
+        {"http", TT_UNDEFINED, AC_HTTP},
         {"on", TT_UNDEFINED, AC_ON},
         {"port", TT_UNDEFINED, AC_PORT},
         {"secure", TT_UNDEFINED, AC_SECURE}
@@ -525,6 +526,7 @@ const static LT export_table[] =
 		{"raw", TT_UNDEFINED, EX_RAW},
 		{"rgba", TT_UNDEFINED, EX_RAW_RGBA},
         {"snapshot", TT_UNDEFINED, EX_SNAPSHOT},
+        {"snapshots", TT_UNDEFINED, EX_SNAPSHOTS},
         {"stack", TT_UNDEFINED, EX_STACK},
         {"ulaw", TT_UNDEFINED, EX_ULAW},
         {"vc", TT_UNDEFINED, EX_VIDEO_CLIP},
@@ -936,6 +938,7 @@ const LT factor_table[] =
         {"fifth", TT_CHUNK, CT_FIFTH},
         {"fifthcolor", TT_PROPERTY, P_TOP_COLOR},
         {"fifthpixel", TT_PROPERTY, P_TOP_PIXEL},
+        {"filemessagedigest", TT_FUNCTION, F_FILE_MESSAGE_DIGEST},
         {"filename", TT_PROPERTY, P_FILE_NAME},
         {"files", TT_FUNCTION, F_FILES},
         {"filetype", TT_PROPERTY, P_FILE_TYPE},
@@ -1116,6 +1119,8 @@ const LT factor_table[] =
         {"itemoffset", TT_FUNCTION, F_ITEM_OFFSET},
         {"items", TT_CLASS, CT_ITEM},
 		{"joinstyle", TT_PROPERTY, P_JOIN_STYLE},
+        {"jpegchromasubsampling", TT_PROPERTY, P_JPEG_CHROMA_SUBSAMPLING},
+        {"jpegprogressive", TT_PROPERTY, P_JPEG_PROGRESSIVE},
         {"jpegquality", TT_PROPERTY, P_JPEG_QUALITY},
         {"keyboardtype", TT_PROPERTY, P_KEYBOARD_TYPE},
         {"keys", TT_FUNCTION, F_KEYS},
@@ -1125,6 +1130,7 @@ const LT factor_table[] =
         {"labelwidth", TT_PROPERTY, P_LABEL_WIDTH},
         {"last", TT_CHUNK, CT_LAST},
         {"layer", TT_PROPERTY, P_LAYER},
+        {"layercache", TT_PROPERTY, P_LAYER_CACHE},
         {"layercliprect", TT_PROPERTY, P_LAYER_CLIP_RECT},
 		// MW-2011-08-25: [[ TileCache ]] The layerMode property token.
 		{"layermode", TT_PROPERTY, P_LAYER_MODE},
@@ -1141,6 +1147,7 @@ const LT factor_table[] =
         {"line", TT_CHUNK, CT_LINE},
         {"linedel", TT_PROPERTY, P_LINE_DELIMITER},
         {"linedelimiter", TT_PROPERTY, P_LINE_DELIMITER},
+        {"linediff", TT_FUNCTION, F_LINE_DIFF},
         {"lineinc", TT_PROPERTY, P_LINE_INC},
         {"lineincrement", TT_PROPERTY, P_LINE_INC},
 		{"lineindex", TT_PROPERTY, P_LINE_INDEX},
@@ -1337,6 +1344,7 @@ const LT factor_table[] =
         // JS-2013-05-15: [[ PageRanges ]] New 'pageRanges' field property.
         {"pageranges", TT_PROPERTY, P_PAGE_RANGES},
         {"paintcompression", TT_PROPERTY, P_PAINT_COMPRESSION},
+        {"painttime", TT_PROPERTY, P_PAINT_TIME},
         {"palindromeframes", TT_PROPERTY, P_PALINDROME_FRAMES},
         {"pan", TT_PROPERTY, P_PAN},
         {"paragraph", TT_CHUNK, CT_PARAGRAPH},
@@ -1374,6 +1382,8 @@ const LT factor_table[] =
         {"playloudness", TT_PROPERTY, P_PLAY_LOUDNESS},
         {"playrate", TT_PROPERTY, P_PLAY_RATE},
         {"playselection", TT_PROPERTY, P_PLAY_SELECTION},
+        {"pngcompressionlevel", TT_PROPERTY, P_PNG_COMPRESSION_LEVEL},
+        {"pngfilter", TT_PROPERTY, P_PNG_FILTER},
         {"pointerfocus", TT_PROPERTY, P_POINTER_FOCUS},
         {"points", TT_PROPERTY, P_POINTS},
         {"polysides", TT_PROPERTY, P_POLY_SIDES},
@@ -1486,6 +1496,7 @@ const LT factor_table[] =
         {"resizequality", TT_PROPERTY, P_RESIZE_QUALITY},
         {"result", TT_FUNCTION, F_RESULT},
         {"retainimage", TT_PROPERTY, P_RETAIN_IMAGE},
+        {"retainpaint", TT_PROPERTY, P_RETAIN_PAINT},
         {"retainpostscript", TT_PROPERTY, P_RETAIN_POSTSCRIPT},
         {"returnkeytype", TT_PROPERTY, P_RETURN_KEY_TYPE},
         {"revavailablehandlers", TT_PROPERTY, P_REV_AVAILABLE_HANDLERS},
@@ -0,0 +1,556 @@
+/* Copyright (C) 2003-2017 LiveCode Ltd.
+
+ This file is part of LiveCode.
+
+ LiveCode is free software; you can redistribute it and/or modify it under
+ the terms of the GNU General Public License v3 as published by the Free
+ Software Foundation.
+
+ LiveCode is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
+
+#include "prefix.h"
+
+#include "linediff.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// A line of one of the texts being compared, as a range of its chars.
+struct MCLineDiffLine
+{
+    uindex_t offset;
+    uindex_t length;
+    hash_t hash;
+};
+
+// A pair of line ranges [a_start, a_end) and [b_start, b_end) still to be
+// compared.
+struct MCLineDiffRegion
+{
+    uindex_t a_start;
+    uindex_t a_end;
+    uindex_t b_start;
+    uindex_t b_end;
+};
+
+// The state of a comparison. Lines are replaced by ids, equal lines having
+// equal ids, so that all the searches need only compare integers.
+struct MCLineDiffState
+{
+    const uindex_t *a;
+    const uindex_t *b;
+
+    // Whether each line of a has been deleted / each line of b inserted.
+    bool *a_changed;
+    bool *b_changed;
+
+    // The histogram of the a side of the region being split: the number of
+    // occurrences of each id, the first occurrence (index + 1, or 0) of each
+    // id, and the next occurrence (index + 1, or 0) after each line.
+    uindex_t *count;
+    uindex_t *first;
+    uindex_t *next;
+
+    // The furthest reaching forward and backward paths for each diagonal of
+    // the Myers search, indexed by x - y.
+    index_t *forward;
+    index_t *backward;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<typename CharType>
+static bool MCLineDiffSplitLines(const CharType *p_chars, uindex_t p_length, MCAutoArray<MCLineDiffLine>& r_lines)
+{
+    uindex_t t_count;
+    t_count = 0;
+    for (uindex_t i = 0; i < p_length; i++)
+        if (p_chars[i] == '\n')
+            t_count++;
+    if (p_length != 0 && p_chars[p_length - 1] != '\n')
+        t_count++;
+
+    if (!r_lines.New(t_count))
+        return false;
+
+    uindex_t t_start;
+    t_start = 0;
+    for (uindex_t i = 0; i < t_count; i++)
+    {
+        uindex_t t_end;
+        t_end = t_start;
+        while (t_end < p_length && p_chars[t_end] != '\n')
+            t_end++;
+        if (t_end < p_length)
+            t_end++;
+
+        r_lines[i].offset = t_start;
+        r_lines[i].length = t_end - t_start;
+        r_lines[i].hash = MCHashBytes(p_chars + t_start, (t_end - t_start) * sizeof(CharType));
+
+        t_start = t_end;
+    }
+
+    return true;
+}
+
+// Replace each line of both texts by an id, such that two lines have the same
+// id exactly when their chars are the same.
+template<typename CharType>
+static bool MCLineDiffInternLines(const CharType *p_from, const MCLineDiffLine *p_from_lines, uindex_t p_from_count,
+                                  const CharType *p_to, const MCLineDiffLine *p_to_lines, uindex_t p_to_count,
+                                  uindex_t *r_ids, uindex_t& r_id_count)
+{
+    uindex_t t_line_count;
+    t_line_count = p_from_count + p_to_count;
+
+    // An open-addressed table of the first line (index + 1) with each id, at
+    // most half full.
+    uindex_t t_capacity;
+    t_capacity = 16;
+    while (t_capacity < t_line_count * 2)
+        t_capacity *= 2;
+
+    MCAutoArray<uindex_t> t_table;
+    if (!t_table.New(t_capacity))
+        return false;
+
+    uindex_t t_id_count;
+    t_id_count = 0;
+    for (uindex_t i = 0; i < t_line_count; i++)
+    {
+        const CharType *t_chars;
+        const MCLineDiffLine *t_line;
+        if (i < p_from_count)
+            t_chars = p_from, t_line = &p_from_lines[i];
+        else
+            t_chars = p_to, t_line = &p_to_lines[i - p_from_count];
+
+        uindex_t t_slot;
+        t_slot = t_line->hash & (t_capacity - 1);
+        for (;;)
+        {
+            uindex_t t_entry;
+            t_entry = t_table[t_slot];
+            if (t_entry == 0)
+            {
+                t_table[t_slot] = i + 1;
+                r_ids[i] = t_id_count++;
+                break;
+            }
+
+            const CharType *t_other_chars;
+            const MCLineDiffLine *t_other_line;
+            if (t_entry - 1 < p_from_count)
+                t_other_chars = p_from, t_other_line = &p_from_lines[t_entry - 1];
+            else
+                t_other_chars = p_to, t_other_line = &p_to_lines[t_entry - 1 - p_from_count];
+
+            if (t_other_line->hash == t_line->hash &&
+                t_other_line->length == t_line->length &&
+                MCMemoryCompare(t_other_chars + t_other_line->offset, t_chars + t_line->offset, t_line->length * sizeof(CharType)) == 0)
+            {
+                r_ids[i] = r_ids[t_entry - 1];
+                break;
+            }
+
+            t_slot = (t_slot + 1) & (t_capacity - 1);
+        }
+    }
+
+    r_id_count = t_id_count;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void MCLineDiffMarkChanged(MCLineDiffState& x_state, uindex_t p_a_start, uindex_t p_a_end, uindex_t p_b_start, uindex_t p_b_end)
+{
+    for (uindex_t i = p_a_start; i < p_a_end; i++)
+        x_state.a_changed[i] = true;
+    for (uindex_t i = p_b_start; i < p_b_end; i++)
+        x_state.b_changed[i] = true;
+}
+
+// Find the point at which a shortest edit path through the given region
+// crosses its middle snake, searching forward from the start and backward
+// from the end until the two searches overlap.
+static void MCLineDiffMiddleSnake(MCLineDiffState& x_state, index_t p_a_start, index_t p_a_end, index_t p_b_start, index_t p_b_end, index_t& r_a_mid, index_t& r_b_mid)
+{
+    const uindex_t *a = x_state.a;
+    const uindex_t *b = x_state.b;
+    index_t *t_forward = x_state.forward;
+    index_t *t_backward = x_state.backward;
+
+    index_t t_min_diagonal, t_max_diagonal;
+    t_min_diagonal = p_a_start - p_b_end;
+    t_max_diagonal = p_a_end - p_b_start;
+
+    index_t t_forward_mid, t_backward_mid;
+    t_forward_mid = p_a_start - p_b_start;
+    t_backward_mid = p_a_end - p_b_end;
+
+    index_t t_forward_min, t_forward_max, t_backward_min, t_backward_max;
+    t_forward_min = t_forward_max = t_forward_mid;
+    t_backward_min = t_backward_max = t_backward_mid;
+
+    bool t_odd;
+    t_odd = ((t_forward_mid - t_backward_mid) & 1) != 0;
+
+    t_forward[t_forward_mid] = p_a_start;
+    t_backward[t_backward_mid] = p_a_end;
+
+    for (;;)
+    {
+        // Extend the forward search by one edit on each diagonal.
+        if (t_forward_min > t_min_diagonal)
+            t_forward[--t_forward_min - 1] = -1;
+        else
+            t_forward_min++;
+        if (t_forward_max < t_max_diagonal)
+            t_forward[++t_forward_max + 1] = -1;
+        else
+            t_forward_max--;
+
+        for (index_t d = t_forward_max; d >= t_forward_min; d -= 2)
+        {
+            index_t t_low, t_high;
+            t_low = t_forward[d - 1];
+            t_high = t_forward[d + 1];
+
+            index_t x, y;
+            x = t_low < t_high ? t_high : t_low + 1;
+            y = x - d;
+            while (x < p_a_end && y < p_b_end && a[x] == b[y])
+                x++, y++;
+            t_forward[d] = x;
+
+            if (t_odd && t_backward_min <= d && d <= t_backward_max && t_backward[d] <= x)
+            {
+                r_a_mid = x;
+                r_b_mid = y;
+                return;
+            }
+        }
+
+        // Extend the backward search by one edit on each diagonal.
+        if (t_backward_min > t_min_diagonal)
+            t_backward[--t_backward_min - 1] = INDEX_MAX;
+        else
+            t_backward_min++;
+        if (t_backward_max < t_max_diagonal)
+            t_backward[++t_backward_max + 1] = INDEX_MAX;
+        else
+            t_backward_max--;
+
+        for (index_t d = t_backward_max; d >= t_backward_min; d -= 2)
+        {
+            index_t t_low, t_high;
+            t_low = t_backward[d - 1];
+            t_high = t_backward[d + 1];
+
+            index_t x, y;
+            x = t_low < t_high ? t_low : t_high - 1;
+            y = x - d;
+            while (x > p_a_start && y > p_b_start && a[x - 1] == b[y - 1])
+                x--, y--;
+            t_backward[d] = x;
+
+            if (!t_odd && t_forward_min <= d && d <= t_forward_max && x <= t_forward[d])
+            {
+                r_a_mid = x;
+                r_b_mid = y;
+                return;
+            }
+        }
+    }
+}
+
+// Mark the changes on a shortest edit path through the region, by splitting it
+// recursively at its middle snake. This takes time proportional to the size
+// of the region times the number of edits, and no extra space.
+static void MCLineDiffMyers(MCLineDiffState& x_state, index_t p_a_start, index_t p_a_end, index_t p_b_start, index_t p_b_end)
+{
+    const uindex_t *a = x_state.a;
+    const uindex_t *b = x_state.b;
+
+    while (p_a_start < p_a_end && p_b_start < p_b_end && a[p_a_start] == b[p_b_start])
+        p_a_start++, p_b_start++;
+    while (p_a_start < p_a_end && p_b_start < p_b_end && a[p_a_end - 1] == b[p_b_end - 1])
+        p_a_end--, p_b_end--;
+
+    if (p_a_start == p_a_end || p_b_start == p_b_end)
+    {
+        MCLineDiffMarkChanged(x_state, p_a_start, p_a_end, p_b_start, p_b_end);
+        return;
+    }
+
+    index_t t_a_mid, t_b_mid;
+    MCLineDiffMiddleSnake(x_state, p_a_start, p_a_end, p_b_start, p_b_end, t_a_mid, t_b_mid);
+
+    MCLineDiffMyers(x_state, p_a_start, t_a_mid, p_b_start, t_b_mid);
+    MCLineDiffMyers(x_state, t_a_mid, p_a_end, t_b_mid, p_b_end);
+}
+
+// Mark the changes between the texts by repeatedly splitting regions around
+// the longest common run containing the line which occurs least often in the
+// region of a (taking the occurrence nearest the diagonal of the region). This aligns the texts on their distinctive lines (as in a
+// patience diff) without a full search, so that only regions consisting
+// entirely of frequent lines need the Myers search.
+static bool MCLineDiffHistogram(MCLineDiffState& x_state, uindex_t p_a_count, uindex_t p_b_count)
+{
+    const uindex_t *a = x_state.a;
+    const uindex_t *b = x_state.b;
+
+    // The regions still to be split, as a stack.
+    MCAutoArray<MCLineDiffRegion> t_regions;
+    if (!t_regions.New(16))
+        return false;
+
+    uindex_t t_region_count;
+    t_regions[0] = MCLineDiffRegion{0, p_a_count, 0, p_b_count};
+    t_region_count = 1;
+
+    while (t_region_count > 0)
+    {
+        MCLineDiffRegion t_region;
+        t_region = t_regions[--t_region_count];
+
+        uindex_t t_a_start = t_region.a_start;
+        uindex_t t_a_end = t_region.a_end;
+        uindex_t t_b_start = t_region.b_start;
+        uindex_t t_b_end = t_region.b_end;
+
+        while (t_a_start < t_a_end && t_b_start < t_b_end && a[t_a_start] == b[t_b_start])
+            t_a_start++, t_b_start++;
+        while (t_a_start < t_a_end && t_b_start < t_b_end && a[t_a_end - 1] == b[t_b_end - 1])
+            t_a_end--, t_b_end--;
+
+        if (t_a_start == t_a_end || t_b_start == t_b_end)
+        {
+            MCLineDiffMarkChanged(x_state, t_a_start, t_a_end, t_b_start, t_b_end);
+            continue;
+        }
+
+        for (uindex_t i = t_a_end; i > t_a_start; i--)
+        {
+            uindex_t t_id;
+            t_id = a[i - 1];
+            x_state.next[i - 1] = x_state.first[t_id];
+            x_state.first[t_id] = i;
+            x_state.count[t_id]++;
+        }
+
+        bool t_has_common;
+        t_has_common = false;
+
+        uindex_t t_best_count, t_best_length;
+        t_best_count = kMCLineDiffMaxOccurrences + 1;
+        t_best_length = 0;
+
+        MCLineDiffRegion t_best;
+        t_best = MCLineDiffRegion{0, 0, 0, 0};
+
+        uindex_t j;
+        j = t_b_start;
+        while (j < t_b_end)
+        {
+            uindex_t t_count;
+            t_count = x_state.count[b[j]];
+            if (t_count == 0)
+            {
+                j++;
+                continue;
+            }
+
+            t_has_common = true;
+            if (t_count > t_best_count || t_count > kMCLineDiffMaxOccurrences)
+            {
+                j++;
+                continue;
+            }
+
+            // Extend the match around the occurrence of the line nearest
+            // to the diagonal of the region, so that repeated text is
+            // aligned with its counterpart rather than with another copy.
+            // Lines within any of these runs need not be tried again.
+            uint64_t t_expected;
+            t_expected = t_a_start + uint64_t(j - t_b_start) * (t_a_end - t_a_start) / (t_b_end - t_b_start);
+
+            uindex_t t_next_j, t_nearest_distance;
+            t_next_j = j + 1;
+            t_nearest_distance = UINDEX_MAX;
+
+            MCLineDiffRegion t_nearest;
+            t_nearest = MCLineDiffRegion{0, 0, 0, 0};
+            for (uindex_t t_occurrence = x_state.first[b[j]]; t_occurrence != 0; t_occurrence = x_state.next[t_occurrence - 1])
+            {
+                uindex_t t_match_a_start, t_match_b_start, t_match_a_end, t_match_b_end;
+                t_match_a_start = t_occurrence - 1;
+                t_match_b_start = j;
+                while (t_match_a_start > t_a_start && t_match_b_start > t_b_start &&
+                       a[t_match_a_start - 1] == b[t_match_b_start - 1])
+                    t_match_a_start--, t_match_b_start--;
+
+                t_match_a_end = t_occurrence;
+                t_match_b_end = j + 1;
+                while (t_match_a_end < t_a_end && t_match_b_end < t_b_end &&
+                       a[t_match_a_end] == b[t_match_b_end])
+                    t_match_a_end++, t_match_b_end++;
+
+                uindex_t t_distance;
+                t_distance = uindex_t(t_occurrence - 1 > t_expected ? t_occurrence - 1 - t_expected : t_expected - (t_occurrence - 1));
+                if (t_distance < t_nearest_distance)
+                {
+                    t_nearest_distance = t_distance;
+                    t_nearest = MCLineDiffRegion{t_match_a_start, t_match_a_end, t_match_b_start, t_match_b_end};
+                }
+
+                if (t_match_b_end > t_next_j)
+                    t_next_j = t_match_b_end;
+            }
+
+            if (t_count < t_best_count || t_nearest.a_end - t_nearest.a_start > t_best_length)
+            {
+                t_best_count = t_count;
+                t_best_length = t_nearest.a_end - t_nearest.a_start;
+                t_best = t_nearest;
+            }
+
+            j = t_next_j;
+        }
+
+        for (uindex_t i = t_a_start; i < t_a_end; i++)
+        {
+            x_state.count[a[i]] = 0;
+            x_state.first[a[i]] = 0;
+        }
+
+        if (t_best_length != 0)
+        {
+            if (t_region_count + 2 > t_regions.Size() &&
+                !t_regions.Extend(t_regions.Size() * 2))
+                return false;
+
+            t_regions[t_region_count++] = MCLineDiffRegion{t_best.a_end, t_a_end, t_best.b_end, t_b_end};
+            t_regions[t_region_count++] = MCLineDiffRegion{t_a_start, t_best.a_start, t_b_start, t_best.b_start};
+        }
+        else if (!t_has_common)
+            MCLineDiffMarkChanged(x_state, t_a_start, t_a_end, t_b_start, t_b_end);
+        else
+            MCLineDiffMyers(x_state, t_a_start, t_a_end, t_b_start, t_b_end);
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool MCLineDiffAppendEdit(MCStringRef p_edits, uindex_t p_a_index, char p_operation, uindex_t p_b_index)
+{
+    char t_buffer[64];
+    int t_length;
+    t_length = sprintf(t_buffer, "%u,%c,%u\n", p_a_index, p_operation, p_b_index);
+    return MCStringAppendNativeChars(p_edits, (const char_t *)t_buffer, t_length);
+}
+
+template<typename CharType>
+static bool MCLineDiffCompareChars(const CharType *p_from, uindex_t p_from_length, const CharType *p_to, uindex_t p_to_length, MCStringRef& r_edits)
+{
+    MCAutoArray<MCLineDiffLine> t_from_lines, t_to_lines;
+    if (!MCLineDiffSplitLines(p_from, p_from_length, t_from_lines) ||
+        !MCLineDiffSplitLines(p_to, p_to_length, t_to_lines))
+        return false;
+
+    uindex_t t_a_count, t_b_count;
+    t_a_count = t_from_lines.Size();
+    t_b_count = t_to_lines.Size();
+
+    MCAutoArray<uindex_t> t_ids;
+    if (!t_ids.New(t_a_count + t_b_count))
+        return false;
+
+    uindex_t t_id_count;
+    if (!MCLineDiffInternLines(p_from, t_from_lines.Ptr(), t_a_count,
+                               p_to, t_to_lines.Ptr(), t_b_count,
+                               t_ids.Ptr(), t_id_count))
+        return false;
+
+    MCAutoArray<bool> t_a_changed, t_b_changed;
+    MCAutoArray<uindex_t> t_count, t_first, t_next;
+    MCAutoArray<index_t> t_forward, t_backward;
+    if (!t_a_changed.New(t_a_count) ||
+        !t_b_changed.New(t_b_count) ||
+        !t_count.New(t_id_count) ||
+        !t_first.New(t_id_count) ||
+        !t_next.New(t_a_count) ||
+        !t_forward.New(t_a_count + t_b_count + 3) ||
+        !t_backward.New(t_a_count + t_b_count + 3))
+        return false;
+
+    MCLineDiffState t_state;
+    t_state.a = t_ids.Ptr();
+    t_state.b = t_ids.Ptr() + t_a_count;
+    t_state.a_changed = t_a_changed.Ptr();
+    t_state.b_changed = t_b_changed.Ptr();
+    t_state.count = t_count.Ptr();
+    t_state.first = t_first.Ptr();
+    t_state.next = t_next.Ptr();
+    t_state.forward = t_forward.Ptr() + t_b_count + 1;
+    t_state.backward = t_backward.Ptr() + t_b_count + 1;
+
+    if (!MCLineDiffHistogram(t_state, t_a_count, t_b_count))
+        return false;
+
+    MCAutoStringRef t_edits;
+    if (!MCStringCreateMutable(0, &t_edits))
+        return false;
+
+    uindex_t i, j;
+    i = 0;
+    j = 0;
+    while (i < t_a_count || j < t_b_count)
+    {
+        if (i < t_a_count && t_state.a_changed[i])
+        {
+            if (!MCLineDiffAppendEdit(*t_edits, i + 1, '-', j))
+                return false;
+            i++;
+        }
+        else if (j < t_b_count && t_state.b_changed[j])
+        {
+            if (!MCLineDiffAppendEdit(*t_edits, i, '+', j + 1))
+                return false;
+            j++;
+        }
+        else
+            i++, j++;
+    }
+
+    return MCStringCopy(*t_edits, r_edits);
+}
+
+bool MCLineDiffCompare(MCStringRef p_from, MCStringRef p_to, MCStringRef& r_edits)
+{
+    if (MCStringIsNative(p_from) && MCStringIsNative(p_to))
+        return MCLineDiffCompareChars(MCStringGetNativeCharPtr(p_from), MCStringGetLength(p_from),
+                                      MCStringGetNativeCharPtr(p_to), MCStringGetLength(p_to),
+                                      r_edits);
+
+    MCAutoArray<unichar_t> t_from, t_to;
+    if (!t_from.New(MCStringGetLength(p_from)) ||
+        !t_to.New(MCStringGetLength(p_to)))
+        return false;
+
+    MCStringGetChars(p_from, MCRangeMake(0, t_from.Size()), t_from.Ptr());
+    MCStringGetChars(p_to, MCRangeMake(0, t_to.Size()), t_to.Ptr());
+
+    return MCLineDiffCompareChars(t_from.Ptr(), t_from.Size(), t_to.Ptr(), t_to.Size(), r_edits);
+}
+
+////////////////////////////////////////////////////////////////////////////////
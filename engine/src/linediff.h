@@ -0,0 +1,42 @@
+/* Copyright (C) 2003-2017 LiveCode Ltd.
+
+ This file is part of LiveCode.
+
+ LiveCode is free software; you can redistribute it and/or modify it under
+ the terms of the GNU General Public License v3 as published by the Free
+ Software Foundation.
+
+ LiveCode is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
+
+#ifndef __MC_LINE_DIFF__
+#define __MC_LINE_DIFF__
+
+// Regions where a line occurs more often than this in the source text are
+// left to the Myers search rather than being split by the histogram search.
+#define kMCLineDiffMaxOccurrences 64
+
+// Compute the edits which transform the lines of p_from into the lines of
+// p_to, as used by the diff library.
+//
+// Lines are split on return and keep their terminating return (if any), so
+// a final line without a return differs from the same line with one. Lines
+// are compared exactly.
+//
+// Each line is hashed once and the texts are matched by a histogram search
+// (which anchors each region on its least frequent common line), falling
+// back to a linear-space Myers search for regions in which every common line
+// is frequent.
+//
+// r_edits is a return-delimited list of edits in increasing line order,
+// where within each change deletions precede insertions:
+//   "<a>,-,<b>" - delete line <a> of p_from (<b> lines of p_to precede it)
+//   "<a>,+,<b>" - insert line <b> of p_to after line <a> of p_from
+bool MCLineDiffCompare(MCStringRef p_from, MCStringRef p_to, MCStringRef& r_edits);
+
+#endif
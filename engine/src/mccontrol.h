@@ -44,6 +44,7 @@ enum MCLayerModeHint
 
 struct MCInterfaceMargins;
 union MCBitmapEffect;
+struct MCLayerCache;
 
 typedef MCObjectProxy<MCControl>::Handle MCControlHandle;
 
@@ -66,6 +67,9 @@ protected:
 	// MW-2011-08-24: [[ Layers ]] The layer id of the control.
 	uint32_t m_layer_id;
     MCRectangle m_layer_clip_rect;
+	// The cached rendering of the control, if layerCache is set and it has
+	//   been drawn since it last changed.
+	MCLayerCache *m_layer_cache;
 	
 	// MW-2011-09-21: [[ Layers ]] Whether something about the control has
 	//   changed requiring a recompute the layer attributes.
@@ -93,6 +97,8 @@ protected:
 	bool m_layer_is_sprite : 1;
     
     bool m_layer_has_clip_rect : 1;
+	// Whether the control should be drawn from a cached bitmap (layerCache).
+	bool m_layer_use_cache : 1;
 
 	static int2 defaultmargin;
 	static int2 xoffset;
@@ -243,6 +249,14 @@ public:
 	//   'update_card' is true then the dirty rect of the stack will be updated too.
 	void layer_dirtycontentrect(const MCRectangle& content_rect, bool update_card);
 
+	// Draw the control from its cached bitmap, rendering it first if needed.
+	//   Returns false if the control cannot be cached in the given context.
+	bool layer_drawcached(MCDC *dc);
+	// Discard the cached bitmap of the control.
+	void layer_discardcache(void);
+	// Discard the cached bitmaps of the control and any groups it is in.
+	void layer_flushcache(void);
+
 	// MW-2011-08-24: [[ TileCache ]] Returns the current layer id.
 	uint32_t layer_getid(void) { return m_layer_id; }
 	// MW-2011-08-24: [[ TileCache ]] Set thes layer id.
@@ -370,6 +384,8 @@ public:
 	void SetUnicodeToolTip(MCExecContext& ctxt, MCDataRef p_tooltip);
     void GetLayerClipRect(MCExecContext& ctxt, MCRectangle*& r_layer_clip_rect);
     void SetLayerClipRect(MCExecContext& ctxt, MCRectangle* p_layer_clip_rect);
+    void GetLayerCache(MCExecContext& ctxt, bool& r_setting);
+    void SetLayerCache(MCExecContext& ctxt, bool p_setting);
 	void GetLayerMode(MCExecContext& ctxt, intenum_t& r_mode);
     void SetLayerMode(MCExecContext& ctxt, intenum_t p_mode);
 	void GetEffectiveLayerMode(MCExecContext& ctxt, intenum_t& r_mode);
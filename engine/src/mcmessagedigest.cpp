@@ -19,6 +19,11 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #include <iterator>
 
 #include "globals.h"
+#include "mcio.h"
+#include "osspec.h"
+#include "securemode.h"
+#include "system.h"
+#include "mcmessagedigest.h"
 #include "md5.h"
 #include "sha1.h"
 #include "sha256.h"
@@ -54,95 +59,160 @@ align_buffer_length(size_t p_digest_length)
             ~(sizeof(uint64_t) - 1));
 }
 
+/* The longest digest is SHA-512 / SHA3-512 */
+constexpr size_t kMaxDigestLength = 64;
+
+/* The state of any of the supported hash functions */
+union digest_state_t
+{
+    md5_state_t m_md5;
+    sha1_state_t m_sha1;
+    sha256_ctx m_sha256;
+    sha512_ctx m_sha512;
+    sha3_ctx m_sha3;
+};
+
 /* All message digest hash implementations use the same API, varying
- * only in a few type definitions.  This template generates a function
- * that calls the necessary functions in the correct order. */
-template <typename State, size_t DigestLength,
+ * only in a few type definitions.  This template adapts them to a
+ * common signature operating on a digest_state_t. */
+template <typename State,
           typename Buffer, typename Length,
           void (*Init)(State*),
           void (*Update)(State*, const Buffer*, Length),
           void (*Finish)(State*, byte_t*)>
-static MCAutoDataRef do_digest(MCDataRef p_data)
+struct digest_adaptor
 {
-    State state;
-    byte_t digest[align_buffer_length(DigestLength)];
-    Init(&state);
-    Update(&state, MCDataGetBytePtr(p_data), MCDataGetLength(p_data));
-    Finish(&state, digest);
+    static void init(digest_state_t *x_state)
+    {
+        Init(reinterpret_cast<State*>(x_state));
+    }
 
-    return data_new_from_bytes({digest, DigestLength});
-}
+    static void update(digest_state_t *x_state,
+                       const byte_t *p_bytes,
+                       size_t p_length)
+    {
+        /* Some implementations take a 32-bit length, so feed them
+         * large messages in pieces. */
+        const size_t kMaxUpdate = 1 << 30;
+        while (p_length > 0)
+        {
+            size_t t_length = MCMin(p_length, kMaxUpdate);
+            Update(reinterpret_cast<State*>(x_state), p_bytes, Length(t_length));
+            p_bytes += t_length;
+            p_length -= t_length;
+        }
+    }
 
-static MCAutoDataRef md5_digest(MCDataRef p_data)
-{
-    return do_digest<md5_state_t, 16, byte_t, int,
-                     md5_init, md5_append, md5_finish>(p_data);
-}
+    static void finish(digest_state_t *x_state, byte_t *r_digest)
+    {
+        Finish(reinterpret_cast<State*>(x_state), r_digest);
+    }
+};
 
-static MCAutoDataRef sha1_digest(MCDataRef p_data)
-{
-    return do_digest<sha1_state_t, 20, void, uint32_t,
-                     sha1_init, sha1_append, sha1_finish>(p_data);
-}
+using md5_adaptor =
+    digest_adaptor<md5_state_t, byte_t, int,
+                   md5_init, md5_append, md5_finish>;
 
-template <unsigned bits, void (*Init)(sha256_ctx*)>
-static MCAutoDataRef sha256_digest(MCDataRef p_data)
-{
-    return do_digest<sha256_ctx, bits / 8, byte_t, size_t,
-                     Init, rhash_sha256_update, rhash_sha256_final>(p_data);
-}
+using sha1_adaptor =
+    digest_adaptor<sha1_state_t, void, uint32_t,
+                   sha1_init, sha1_append, sha1_finish>;
 
-template <unsigned bits, void (*Init)(sha512_ctx*)>
-static MCAutoDataRef sha512_digest(MCDataRef p_data)
-{
-    return do_digest<sha512_ctx, bits / 8, byte_t, size_t,
-                     Init, rhash_sha512_update, rhash_sha512_final>(p_data);
-}
+template <void (*Init)(sha256_ctx*)>
+using sha256_adaptor =
+    digest_adaptor<sha256_ctx, byte_t, size_t,
+                   Init, rhash_sha256_update, rhash_sha256_final>;
+
+template <void (*Init)(sha512_ctx*)>
+using sha512_adaptor =
+    digest_adaptor<sha512_ctx, byte_t, size_t,
+                   Init, rhash_sha512_update, rhash_sha512_final>;
 
-template <unsigned bits, void (*Init)(sha3_ctx*)>
-static MCAutoDataRef sha3_digest(MCDataRef p_data)
+template <void (*Init)(sha3_ctx*)>
+using sha3_adaptor =
+    digest_adaptor<sha3_ctx, byte_t, size_t,
+                   Init, rhash_sha3_update, rhash_sha3_final>;
+
+/* SHA-224 and SHA-256 can hash several short messages at once */
+template <void (*Init)(sha256_ctx*)>
+static void sha256_multiple(size_t p_count,
+                            const byte_t * const *p_messages,
+                            const size_t *p_lengths,
+                            byte_t *r_digests)
 {
-    return do_digest<sha3_ctx, bits / 8, byte_t, size_t,
-                     Init, rhash_sha3_update, rhash_sha3_final>(p_data);
+    sha256_ctx t_initial;
+    Init(&t_initial);
+    rhash_sha256_multi(&t_initial, p_count, p_messages, p_lengths, r_digests);
 }
 
 /* ----------------------------------------------------------------
  * Generalised message digest function
  * ---------------------------------------------------------------- */
 
-typedef MCAutoDataRef (*digest_func_t)(MCDataRef p_data);
-
-struct digest_mapping_t
+struct digest_algorithm_t
 {
     const char* m_name;
-    const digest_func_t m_digest_func;
+    size_t m_digest_length;
+    void (*m_init)(digest_state_t*);
+    void (*m_update)(digest_state_t*, const byte_t*, size_t);
+    void (*m_finish)(digest_state_t*, byte_t*);
+    /* Computes the digests of many messages, placing them one after
+     * another in the output, or nullptr to compute them in turn. */
+    void (*m_multiple)(size_t, const byte_t * const *, const size_t *, byte_t *);
 };
 
-static const digest_mapping_t k_digest_map[] =
-{
-    { "md5",      md5_digest  },
-    { "sha-1",    sha1_digest },
-    { "sha-224",  sha256_digest<224, rhash_sha224_init> },
-    { "sha-256",  sha256_digest<256, rhash_sha256_init> },
-    { "sha-384",  sha512_digest<384, rhash_sha384_init> },
-    { "sha-512",  sha512_digest<512, rhash_sha512_init> },
-    { "sha3-224", sha3_digest<224, rhash_sha3_224_init> },
-    { "sha3-256", sha3_digest<256, rhash_sha3_256_init> },
-    { "sha3-384", sha3_digest<384, rhash_sha3_384_init> },
-    { "sha3-512", sha3_digest<512, rhash_sha3_512_init> },
+#define DIGEST_ALGORITHM(name, bits, adaptor, multiple) \
+    { name, (bits) / 8, adaptor::init, adaptor::update, adaptor::finish, multiple }
+
+static const digest_algorithm_t k_digest_map[] =
+{
+    DIGEST_ALGORITHM("md5",      128, md5_adaptor,  nullptr),
+    DIGEST_ALGORITHM("sha-1",    160, sha1_adaptor, nullptr),
+    DIGEST_ALGORITHM("sha-224",  224, sha256_adaptor<rhash_sha224_init>, sha256_multiple<rhash_sha224_init>),
+    DIGEST_ALGORITHM("sha-256",  256, sha256_adaptor<rhash_sha256_init>, sha256_multiple<rhash_sha256_init>),
+    DIGEST_ALGORITHM("sha-384",  384, sha512_adaptor<rhash_sha384_init>, nullptr),
+    DIGEST_ALGORITHM("sha-512",  512, sha512_adaptor<rhash_sha512_init>, nullptr),
+    DIGEST_ALGORITHM("sha3-224", 224, sha3_adaptor<rhash_sha3_224_init>, nullptr),
+    DIGEST_ALGORITHM("sha3-256", 256, sha3_adaptor<rhash_sha3_256_init>, nullptr),
+    DIGEST_ALGORITHM("sha3-384", 384, sha3_adaptor<rhash_sha3_384_init>, nullptr),
+    DIGEST_ALGORITHM("sha3-512", 512, sha3_adaptor<rhash_sha3_512_init>, nullptr),
 };
 
-/* Normalize a message digest name.  Currently, this is limited to
- * conversion to lowercase. */
-static MCAutoStringRef
-normalize_digest_name(MCNameRef p_digest_name)
+#undef DIGEST_ALGORITHM
+
+/* The md5Digest and sha1Digest functions use fixed algorithms */
+static const digest_algorithm_t& k_md5_algorithm = k_digest_map[0];
+static const digest_algorithm_t& k_sha1_algorithm = k_digest_map[1];
+
+/* Find a message digest algorithm by name.  Names are compared
+ * caselessly. */
+static const digest_algorithm_t *
+find_digest_algorithm(MCStringRef p_digest_name)
 {
-    MCAutoStringRef t_string;
-    if (!MCStringMutableCopy(MCNameGetString(p_digest_name), &t_string))
-        return {};
-    if (!MCStringLowercase(*t_string, kMCSystemLocale))
-        return {};
-    return t_string;
+    auto t_mapping =
+        std::find_if(std::begin(k_digest_map), std::end(k_digest_map),
+                     [&](const digest_algorithm_t& p_mapping) {
+                         return MCStringIsEqualToCString(p_digest_name,
+                                                         p_mapping.m_name,
+                                                         kMCStringOptionCompareCaseless);
+                     });
+    if (t_mapping == std::end(k_digest_map))
+        return nullptr;
+
+    return t_mapping;
+}
+
+/* Compute the digest of a block of data in one go */
+static MCAutoDataRef
+digest_data(const digest_algorithm_t& p_algorithm,
+            MCDataRef p_data)
+{
+    digest_state_t t_state;
+    byte_t t_digest[align_buffer_length(kMaxDigestLength)];
+    p_algorithm.m_init(&t_state);
+    p_algorithm.m_update(&t_state, MCDataGetBytePtr(p_data), MCDataGetLength(p_data));
+    p_algorithm.m_finish(&t_state, t_digest);
+
+    return data_new_from_bytes(MCMakeSpan(t_digest, p_algorithm.m_digest_length));
 }
 
 /* Generalized message digest
@@ -153,18 +223,9 @@ static MCAutoDataRef
 MCFiltersMessageDigest(MCDataRef p_data,
                        MCNameRef p_digest_name)
 {
-    MCAutoStringRef t_digest_normalized = normalize_digest_name(p_digest_name);
-    if (!t_digest_normalized.IsSet()) return {};
-
-    MCAutoStringRefAsCString t_digest_chars;
-    if (!t_digest_chars.Lock(*t_digest_normalized)) return {};
-
-    auto t_mapping =
-        std::find_if(std::begin(k_digest_map), std::end(k_digest_map),
-                     [&](const digest_mapping_t& p_mapping) {
-                         return 0 == strcmp(p_mapping.m_name, *t_digest_chars);
-                     });
-    if (t_mapping == std::end(k_digest_map))
+    const digest_algorithm_t *t_algorithm =
+        find_digest_algorithm(MCNameGetString(p_digest_name));
+    if (t_algorithm == nullptr)
     {
         /* No known message digest algorithm of this name */
         /* TODO[2017-02-28] Failing to find a matching algorithm should
@@ -172,7 +233,158 @@ MCFiltersMessageDigest(MCDataRef p_data,
         return {};
     }
 
-    return t_mapping->m_digest_func(p_data);
+    return digest_data(*t_algorithm, p_data);
+}
+
+/* ----------------------------------------------------------------
+ * Incremental message digests
+ * ---------------------------------------------------------------- */
+
+struct MCMessageDigest
+{
+    const digest_algorithm_t *m_algorithm;
+    digest_state_t m_state;
+};
+
+bool
+MCMessageDigestCreate(MCStringRef p_algorithm,
+                      MCMessageDigestRef& r_digest)
+{
+    const digest_algorithm_t *t_algorithm =
+        find_digest_algorithm(p_algorithm);
+    if (t_algorithm == nullptr)
+        return false;
+
+    MCMessageDigestRef t_digest = new (nothrow) MCMessageDigest;
+    if (t_digest == nullptr)
+        return false;
+
+    t_digest->m_algorithm = t_algorithm;
+    t_algorithm->m_init(&t_digest->m_state);
+
+    r_digest = t_digest;
+    return true;
+}
+
+void
+MCMessageDigestDestroy(MCMessageDigestRef p_digest)
+{
+    delete p_digest;
+}
+
+void
+MCMessageDigestUpdate(MCMessageDigestRef p_digest,
+                      const byte_t *p_bytes,
+                      size_t p_length)
+{
+    p_digest->m_algorithm->m_update(&p_digest->m_state, p_bytes, p_length);
+}
+
+bool
+MCMessageDigestUpdateWithStream(MCMessageDigestRef p_digest,
+                                IO_handle p_stream)
+{
+    const uint32_t kChunkSize = 1024 * 1024;
+    MCAutoArray<byte_t> t_buffer;
+    if (!t_buffer.New(kChunkSize))
+        return false;
+
+    for (;;)
+    {
+        /* Handles differ in whether a short read at the end of the
+         * stream succeeds, so whatever was read is always digested,
+         * and a failed read is only an error if it wasn't because the
+         * end of the stream was reached. */
+        uint32_t t_read = 0;
+        bool t_success = p_stream->Read(t_buffer.Ptr(), kChunkSize, t_read);
+        MCMessageDigestUpdate(p_digest, t_buffer.Ptr(), t_read);
+
+        if (!t_success)
+            return p_stream->IsExhausted();
+        if (t_read < kChunkSize)
+            return true;
+    }
+}
+
+bool
+MCMessageDigestUpdateWithFile(MCMessageDigestRef p_digest,
+                              MCStringRef p_path)
+{
+    /* Ask for the file to be memory mapped; reading then just copies
+     * from the mapping rather than going through stdio. */
+    IO_handle t_stream = MCS_open(p_path, kMCOpenFileModeRead, True, False, 0);
+    if (t_stream == nullptr)
+        return false;
+
+    bool t_success = MCMessageDigestUpdateWithStream(p_digest, t_stream);
+
+    MCS_close(t_stream);
+    return t_success;
+}
+
+bool
+MCMessageDigestCopyDigest(MCMessageDigestRef p_digest,
+                          MCDataRef& r_digest)
+{
+    /* Finish a copy of the state so that the digest can continue to
+     * be updated. */
+    digest_state_t t_state = p_digest->m_state;
+    byte_t t_digest[align_buffer_length(kMaxDigestLength)];
+    p_digest->m_algorithm->m_finish(&t_state, t_digest);
+
+    return MCDataCreateWithBytes(t_digest,
+                                 p_digest->m_algorithm->m_digest_length,
+                                 r_digest);
+}
+
+bool
+MCMessageDigestComputeMultiple(MCStringRef p_algorithm,
+                               uindex_t p_count,
+                               const byte_t * const *p_messages,
+                               const size_t *p_lengths,
+                               MCDataRef *r_digests)
+{
+    const digest_algorithm_t *t_algorithm =
+        find_digest_algorithm(p_algorithm);
+    if (t_algorithm == nullptr)
+        return false;
+
+    size_t t_digest_length = t_algorithm->m_digest_length;
+
+    MCAutoArray<byte_t> t_digests;
+    if (!t_digests.New(p_count * t_digest_length))
+        return false;
+
+    if (t_algorithm->m_multiple != nullptr)
+    {
+        t_algorithm->m_multiple(p_count, p_messages, p_lengths, t_digests.Ptr());
+    }
+    else
+    {
+        for (uindex_t i = 0; i < p_count; i++)
+        {
+            digest_state_t t_state;
+            byte_t t_digest[align_buffer_length(kMaxDigestLength)];
+            t_algorithm->m_init(&t_state);
+            t_algorithm->m_update(&t_state, p_messages[i], p_lengths[i]);
+            t_algorithm->m_finish(&t_state, t_digest);
+            MCMemoryCopy(t_digests.Ptr() + i * t_digest_length, t_digest, t_digest_length);
+        }
+    }
+
+    for (uindex_t i = 0; i < p_count; i++)
+    {
+        if (!MCDataCreateWithBytes(t_digests.Ptr() + i * t_digest_length,
+                                   t_digest_length,
+                                   r_digests[i]))
+        {
+            while (i > 0)
+                MCValueRelease(r_digests[--i]);
+            return false;
+        }
+    }
+
+    return true;
 }
 
 /* ----------------------------------------------------------------
@@ -199,12 +411,109 @@ MCFiltersEvalMessageDigest(MCExecContext& ctxt,
     filters_result(ctxt, MCFiltersMessageDigest(p_src, p_digest_name), r_digest);
 }
 
+void
+MCFiltersEvalMessageDigestOfArray(MCExecContext& ctxt,
+                                  MCArrayRef p_src,
+                                  MCNameRef p_digest_name,
+                                  MCArrayRef& r_digests)
+{
+    uindex_t t_count = MCArrayGetCount(p_src);
+
+    MCAutoArray<MCNameRef> t_keys;
+    MCAutoDataRefArray t_messages;
+    MCAutoArray<const byte_t *> t_bytes;
+    MCAutoArray<size_t> t_lengths;
+    MCAutoDataRefArray t_digests;
+    if (!t_keys.New(t_count) || !t_messages.New(t_count) ||
+        !t_bytes.New(t_count) || !t_lengths.New(t_count) ||
+        !t_digests.New(t_count))
+    {
+        ctxt.Throw();
+        return;
+    }
+
+    /* Each element is converted to data just as a single message
+     * would be. */
+    uintptr_t t_iterator = 0;
+    MCNameRef t_key;
+    MCValueRef t_value;
+    for (uindex_t i = 0; MCArrayIterate(p_src, t_iterator, t_key, t_value); i++)
+    {
+        if (!ctxt.ConvertToData(t_value, t_messages[i]))
+        {
+            ctxt.LegacyThrow(EE_MESSAGEDIGEST_BADDATA);
+            return;
+        }
+        t_keys[i] = t_key;
+        t_bytes[i] = MCDataGetBytePtr(t_messages[i]);
+        t_lengths[i] = MCDataGetLength(t_messages[i]);
+    }
+
+    if (!MCMessageDigestComputeMultiple(MCNameGetString(p_digest_name),
+                                        t_count,
+                                        t_bytes.Ptr(),
+                                        t_lengths.Ptr(),
+                                        t_digests.Ptr()))
+    {
+        ctxt.Throw();
+        return;
+    }
+
+    MCAutoArrayRef t_result;
+    bool t_success = MCArrayCreateMutable(&t_result);
+    for (uindex_t i = 0; t_success && i < t_count; i++)
+        t_success = MCArrayStoreValue(*t_result, ctxt.GetCaseSensitive(),
+                                      t_keys[i], t_digests[i]);
+    if (t_success)
+        t_success = t_result.MakeImmutable();
+
+    if (t_success)
+        r_digests = t_result.Take();
+    else
+        ctxt.Throw();
+}
+
+void
+MCFiltersEvalFileMessageDigest(MCExecContext& ctxt,
+                               MCStringRef p_path,
+                               MCNameRef p_digest_name,
+                               MCDataRef& r_digest)
+{
+    if (MCsecuremode & MC_SECUREMODE_DISK)
+    {
+        ctxt.LegacyThrow(EE_DISK_NOPERM);
+        return;
+    }
+
+    MCMessageDigestRef t_digest;
+    if (!MCMessageDigestCreate(MCNameGetString(p_digest_name), t_digest))
+    {
+        ctxt.Throw();
+        return;
+    }
+
+    if (MCMessageDigestUpdateWithFile(t_digest, p_path))
+    {
+        if (!MCMessageDigestCopyDigest(t_digest, r_digest))
+            ctxt.Throw();
+        else
+            ctxt.SetTheResultToEmpty();
+    }
+    else
+    {
+        ctxt.SetTheResultToStaticCString("can't open file");
+        r_digest = MCValueRetain(kMCEmptyData);
+    }
+
+    MCMessageDigestDestroy(t_digest);
+}
+
 void
 MCFiltersEvalMD5Digest(MCExecContext& ctxt,
                        MCDataRef p_src,
                        MCDataRef& r_digest)
 {
-    filters_result(ctxt, md5_digest(p_src), r_digest);
+    filters_result(ctxt, digest_data(k_md5_algorithm, p_src), r_digest);
 }
 
 void
@@ -212,5 +521,5 @@ MCFiltersEvalSHA1Digest(MCExecContext& ctxt,
                         MCDataRef p_src,
                         MCDataRef& r_digest)
 {
-    filters_result(ctxt, sha1_digest(p_src), r_digest);
+    filters_result(ctxt, digest_data(k_sha1_algorithm, p_src), r_digest);
 }
@@ -0,0 +1,65 @@
+/*                                                                     -*-c++-*-
+Copyright (C) 2017 LiveCode Ltd.
+
+This file is part of LiveCode.
+
+LiveCode is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License v3 as published by the Free
+Software Foundation.
+
+LiveCode is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
+
+#ifndef __MC_MESSAGE_DIGEST__
+#define __MC_MESSAGE_DIGEST__
+
+/* An incremental message digest computation, for hashing a message
+ * which is not available as a single block of data. */
+typedef struct MCMessageDigest *MCMessageDigestRef;
+
+/* Start computing a message digest with the named algorithm ("md5",
+ * "sha-1", "sha-256", "sha3-512" etc., compared caselessly).  Returns
+ * false if there is no such algorithm. */
+bool MCMessageDigestCreate(MCStringRef p_algorithm,
+                           MCMessageDigestRef& r_digest);
+
+void MCMessageDigestDestroy(MCMessageDigestRef p_digest);
+
+/* Append bytes to the message being digested. */
+void MCMessageDigestUpdate(MCMessageDigestRef p_digest,
+                           const byte_t *p_bytes,
+                           size_t p_length);
+
+/* Append the contents of a file to the message being digested.  The
+ * file is mapped into memory where possible, and otherwise read in
+ * chunks, so that it never needs to be loaded all at once.  Returns
+ * false if the file cannot be opened or read. */
+bool MCMessageDigestUpdateWithFile(MCMessageDigestRef p_digest,
+                                   MCStringRef p_path);
+
+/* Append the rest of the contents of a stream to the message being
+ * digested, reading it in chunks.  Returns false if the stream cannot
+ * be read to its end. */
+bool MCMessageDigestUpdateWithStream(MCMessageDigestRef p_digest,
+                                     IO_handle p_stream);
+
+/* Compute the digest of the message so far.  The digest may continue
+ * to be updated afterwards. */
+bool MCMessageDigestCopyDigest(MCMessageDigestRef p_digest,
+                               MCDataRef& r_digest);
+
+/* Compute the digests of many messages with the named algorithm,
+ * hashing several messages at once where the algorithm supports it.
+ * Returns false if there is no such algorithm. */
+bool MCMessageDigestComputeMultiple(MCStringRef p_algorithm,
+                                    uindex_t p_count,
+                                    const byte_t * const *p_messages,
+                                    const size_t *p_lengths,
+                                    MCDataRef *r_digests);
+
+#endif
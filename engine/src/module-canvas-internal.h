@@ -173,6 +173,8 @@ struct MCCanvasProperties
 	MCCanvasFloat dash_phase;
 };
 
+struct __MCCanvasDisplayList;
+
 struct __MCCanvasImpl
 {
 	bool paint_changed : 1;
@@ -197,6 +199,9 @@ struct __MCCanvasImpl
 	MCGContextRef context;
     
     MCGPaintRef last_paint;
+	
+	// The display list the canvas operations are being recorded into, if any
+	__MCCanvasDisplayList *recording;
 };
 
 __MCCanvasImpl *MCCanvasGet(MCCanvasRef p_canvas);
@@ -25,6 +25,7 @@
 #include "module-canvas.h"
 #include "module-canvas-internal.h"
 #include "module-engine.h"
+#include "pixelkernels.h"
 
 //////////
 
@@ -2021,15 +2022,8 @@ void MCCanvasImageGetPixels(MCCanvasImageRef p_image, MCDataRef &r_pixels)
 	
 	for (uint32_t y = 0; y < t_raster->height; y++)
 	{
-		uint32_t *t_pixel_ptr;
-		t_pixel_ptr = (uint32_t*)t_pixel_row;
-		
-		for (uint32_t x = 0; x < t_raster->width; x++)
-		{
-			*t_buffer_ptr++ = MCGPixelFromNative(kMCGPixelFormatARGB, *t_pixel_ptr);
-			t_pixel_ptr++;
-		}
-		
+		MCPixelRowSwizzle((uint32_t*)t_pixel_row, kMCGPixelFormatNative, t_buffer_ptr, kMCGPixelFormatARGB, t_raster->width);
+		t_buffer_ptr += t_raster->width;
 		t_pixel_row += t_raster->stride;
 	}
 	
@@ -5030,6 +5024,225 @@ bool MCCanvasPropertiesPop(__MCCanvasImpl &x_canvas)
 	return true;
 }
 
+// Display list recording
+
+enum MCCanvasDisplayListOp
+{
+	kMCCanvasDisplayListOpSetProperties,
+	kMCCanvasDisplayListOpTransform,
+	kMCCanvasDisplayListOpSaveState,
+	kMCCanvasDisplayListOpRestoreState,
+	kMCCanvasDisplayListOpBeginLayer,
+	kMCCanvasDisplayListOpBeginLayerWithEffect,
+	kMCCanvasDisplayListOpEndLayer,
+	kMCCanvasDisplayListOpFill,
+	kMCCanvasDisplayListOpStroke,
+	kMCCanvasDisplayListOpClipToRect,
+	kMCCanvasDisplayListOpClipToPath,
+	kMCCanvasDisplayListOpAddPath,
+	kMCCanvasDisplayListOpMoveTo,
+	kMCCanvasDisplayListOpLineTo,
+	kMCCanvasDisplayListOpQuadraticTo,
+	kMCCanvasDisplayListOpCubicTo,
+	kMCCanvasDisplayListOpClosePath,
+	kMCCanvasDisplayListOpDrawRectOfImage,
+	kMCCanvasDisplayListOpFillText,
+	kMCCanvasDisplayListOpFillTextAligned,
+};
+
+struct MCCanvasDisplayListCommand
+{
+	MCCanvasDisplayListOp op;
+	
+	// The path, effect, image or text the operation uses
+	MCValueRef value;
+	
+	// The properties index, layer isolation or text alignment
+	integer_t params[2];
+	
+	union
+	{
+		MCGAffineTransform transform;
+		MCGRectangle rects[2];
+		MCGPoint points[3];
+	};
+};
+
+struct __MCCanvasDisplayList
+{
+	MCCanvasDisplayListCommand *commands;
+	uindex_t command_count;
+	uindex_t command_capacity;
+	
+	// The distinct property sets in effect for the drawing operations
+	MCCanvasProperties *properties;
+	uindex_t property_count;
+	uindex_t property_capacity;
+	
+	// One more than the index of the properties the canvas will have at this
+	// point of the replay, or zero if a state change has made them unknown
+	uindex_t current_properties;
+	
+	MCGAffineTransform device_transform;
+	
+	// False if the canvas was used in a way which can't be replayed
+	bool replayable;
+};
+
+static inline bool MCCanvasIsRecording(__MCCanvasImpl &x_canvas)
+{
+	return x_canvas.recording != nil && x_canvas.recording->replayable;
+}
+
+static inline void MCCanvasStopRecording(__MCCanvasImpl &x_canvas)
+{
+	if (x_canvas.recording != nil)
+		x_canvas.recording->replayable = false;
+}
+
+static MCCanvasDisplayListCommand *MCCanvasRecord(__MCCanvasImpl &x_canvas, MCCanvasDisplayListOp p_op, MCValueRef p_value = nil)
+{
+	if (!MCCanvasIsRecording(x_canvas))
+		return nil;
+	
+	__MCCanvasDisplayList *t_list;
+	t_list = x_canvas.recording;
+	
+	if (t_list->command_count == t_list->command_capacity &&
+		!MCMemoryResizeArray(MCMax(t_list->command_capacity * 2, 32U), t_list->commands, t_list->command_capacity))
+	{
+		t_list->replayable = false;
+		return nil;
+	}
+	
+	MCCanvasDisplayListCommand *t_command;
+	t_command = &t_list->commands[t_list->command_count++];
+	MCMemoryClear(t_command, sizeof(MCCanvasDisplayListCommand));
+	t_command->op = p_op;
+	
+	// Copy the value so later changes to a mutable one aren't replayed
+	if (p_value != nil && !MCValueCopy(p_value, t_command->value))
+	{
+		t_list->command_count--;
+		t_list->replayable = false;
+		return nil;
+	}
+	
+	return t_command;
+}
+
+static bool MCCanvasPropertiesIsEqualTo(const MCCanvasProperties &p_left, const MCCanvasProperties &p_right)
+{
+	return MCValueIsEqualTo(p_left.paint, p_right.paint) &&
+		p_left.fill_rule == p_right.fill_rule &&
+		p_left.antialias == p_right.antialias &&
+		p_left.opacity == p_right.opacity &&
+		p_left.blend_mode == p_right.blend_mode &&
+		p_left.stippled == p_right.stippled &&
+		p_left.image_filter == p_right.image_filter &&
+		MCValueIsEqualTo(p_left.font, p_right.font) &&
+		p_left.stroke_width == p_right.stroke_width &&
+		p_left.join_style == p_right.join_style &&
+		p_left.cap_style == p_right.cap_style &&
+		p_left.miter_limit == p_right.miter_limit &&
+		MCValueIsEqualTo(p_left.dash_lengths, p_right.dash_lengths) &&
+		p_left.dash_phase == p_right.dash_phase;
+}
+
+// Record the canvas properties ahead of an operation which uses them, if they
+// differ from the ones the replay will already have.
+static void MCCanvasRecordProperties(__MCCanvasImpl &x_canvas)
+{
+	if (!MCCanvasIsRecording(x_canvas))
+		return;
+	
+	__MCCanvasDisplayList *t_list;
+	t_list = x_canvas.recording;
+	
+	if (t_list->current_properties != 0 &&
+		MCCanvasPropertiesIsEqualTo(t_list->properties[t_list->current_properties - 1], x_canvas.props()))
+		return;
+	
+	if (t_list->property_count == t_list->property_capacity &&
+		!MCMemoryResizeArray(MCMax(t_list->property_capacity * 2, 8U), t_list->properties, t_list->property_capacity))
+	{
+		t_list->replayable = false;
+		return;
+	}
+	
+	MCCanvasDisplayListCommand *t_command;
+	t_command = MCCanvasRecord(x_canvas, kMCCanvasDisplayListOpSetProperties);
+	if (t_command == nil)
+		return;
+	
+	MCCanvasPropertiesCopy(x_canvas.props(), t_list->properties[t_list->property_count]);
+	t_command->params[0] = t_list->property_count;
+	t_list->current_properties = ++t_list->property_count;
+}
+
+// Replace the canvas properties with recorded ones, marking only those which
+// differ as needing to be applied to the context.
+static void MCCanvasPropertiesAssign(__MCCanvasImpl &x_canvas, const MCCanvasProperties &p_properties)
+{
+	MCCanvasProperties &t_props = x_canvas.props();
+	
+	if (!MCValueIsEqualTo(t_props.paint, p_properties.paint) || t_props.stippled != p_properties.stippled)
+	{
+		MCValueAssign(t_props.paint, p_properties.paint);
+		t_props.stippled = p_properties.stippled;
+		x_canvas.paint_changed = true;
+	}
+	if (t_props.fill_rule != p_properties.fill_rule)
+	{
+		t_props.fill_rule = p_properties.fill_rule;
+		x_canvas.fill_rule_changed = true;
+	}
+	if (t_props.antialias != p_properties.antialias)
+	{
+		t_props.antialias = p_properties.antialias;
+		x_canvas.antialias_changed = true;
+	}
+	if (t_props.opacity != p_properties.opacity)
+	{
+		t_props.opacity = p_properties.opacity;
+		x_canvas.opacity_changed = true;
+	}
+	if (t_props.blend_mode != p_properties.blend_mode)
+	{
+		t_props.blend_mode = p_properties.blend_mode;
+		x_canvas.blend_mode_changed = true;
+	}
+	if (t_props.stroke_width != p_properties.stroke_width)
+	{
+		t_props.stroke_width = p_properties.stroke_width;
+		x_canvas.stroke_width_changed = true;
+	}
+	if (t_props.join_style != p_properties.join_style)
+	{
+		t_props.join_style = p_properties.join_style;
+		x_canvas.join_style_changed = true;
+	}
+	if (t_props.cap_style != p_properties.cap_style)
+	{
+		t_props.cap_style = p_properties.cap_style;
+		x_canvas.cap_style_changed = true;
+	}
+	if (t_props.miter_limit != p_properties.miter_limit)
+	{
+		t_props.miter_limit = p_properties.miter_limit;
+		x_canvas.miter_limit_changed = true;
+	}
+	if (!MCValueIsEqualTo(t_props.dash_lengths, p_properties.dash_lengths) || t_props.dash_phase != p_properties.dash_phase)
+	{
+		MCValueAssign(t_props.dash_lengths, p_properties.dash_lengths);
+		t_props.dash_phase = p_properties.dash_phase;
+		x_canvas.dashes_changed = true;
+	}
+	
+	t_props.image_filter = p_properties.image_filter;
+	MCValueAssign(t_props.font, p_properties.font);
+}
+
 MC_DLLEXPORT_DEF
 bool MCCanvasCreate(MCGContextRef p_context, MCCanvasRef &r_canvas)
 {
@@ -5384,6 +5597,9 @@ void MCCanvasGetClipBounds(MCCanvasRef p_canvas, MCCanvasRectangleRef &r_bounds)
 	__MCCanvasImpl *t_canvas;
 	t_canvas = MCCanvasGet(p_canvas);
 	
+	// The drawing may depend on the clip, which differs between redraws
+	MCCanvasStopRecording(*t_canvas);
+	
 	MCGRectangle t_bounds;
 	t_bounds = MCGContextGetClipBounds(t_canvas->context);
 	
@@ -5574,13 +5790,16 @@ void MCCanvasApplyChanges(__MCCanvasImpl &x_canvas)
 	}
 }
 
-//////////
-
 void MCCanvasTransform(MCCanvasRef p_canvas, const MCGAffineTransform &p_transform)
 {
 	__MCCanvasImpl *t_canvas;
 	t_canvas = MCCanvasGet(p_canvas);
 	
+	MCCanvasDisplayListCommand *t_command;
+	t_command = MCCanvasRecord(*t_canvas, kMCCanvasDisplayListOpTransform);
+	if (t_command != nil)
+		t_command->transform = p_transform;
+	
 	MCGContextConcatCTM(t_canvas->context, p_transform);
 	// Need to re-apply pattern paint when transform changes
 	if (MCCanvasPaintIsPattern(t_canvas->props().paint))
@@ -5642,6 +5861,7 @@ void MCCanvasSaveState(MCCanvasRef p_canvas)
 	if (!MCCanvasPropertiesPush(*t_canvas))
 		return;
 
+	MCCanvasRecord(*t_canvas, kMCCanvasDisplayListOpSaveState);
 	MCGContextSave(t_canvas->context);
 }
 
@@ -5654,6 +5874,9 @@ void MCCanvasRestoreState(MCCanvasRef p_canvas)
 	if (!MCCanvasPropertiesPop(*t_canvas))
 		return;
 
+	MCCanvasRecord(*t_canvas, kMCCanvasDisplayListOpRestoreState);
+	if (t_canvas->recording != nil)
+		t_canvas->recording->current_properties = 0;
 	MCGContextRestore(t_canvas->context);
 }
 
@@ -5663,10 +5886,12 @@ void MCCanvasBeginLayer(MCCanvasRef p_canvas)
 	__MCCanvasImpl *t_canvas;
 	t_canvas = MCCanvasGet(p_canvas);
 	
+	MCCanvasRecordProperties(*t_canvas);
 	MCCanvasApplyChanges(*t_canvas);
 	if (!MCCanvasPropertiesPush(*t_canvas))
 		return;
 
+	MCCanvasRecord(*t_canvas, kMCCanvasDisplayListOpBeginLayer);
 	MCGContextBegin(t_canvas->context, true);
 }
 
@@ -5695,10 +5920,16 @@ void _MCCanvasBeginLayerWithEffect(MCCanvasEffectRef p_effect, MCCanvasRef p_can
 	__MCCanvasImpl *t_canvas;
 	t_canvas = MCCanvasGet(p_canvas);
 	
+	MCCanvasRecordProperties(*t_canvas);
 	MCCanvasApplyChanges(*t_canvas);
 	if (!MCCanvasPropertiesPush(*t_canvas))
 		return;
 
+	MCCanvasDisplayListCommand *t_command;
+	t_command = MCCanvasRecord(*t_canvas, kMCCanvasDisplayListOpBeginLayerWithEffect, p_effect);
+	if (t_command != nil)
+		t_command->params[0] = p_isolated;
+	
 	MCGBitmapEffects t_effects = MCGBitmapEffects();
 
 	__MCCanvasEffectImpl *t_effect_impl;
@@ -5781,6 +6012,9 @@ void MCCanvasEndLayer(MCCanvasRef p_canvas)
 	if (!MCCanvasPropertiesPop(*t_canvas))
 		return;
 
+	MCCanvasRecord(*t_canvas, kMCCanvasDisplayListOpEndLayer);
+	if (t_canvas->recording != nil)
+		t_canvas->recording->current_properties = 0;
 	MCGContextEnd(t_canvas->context);
 }
 
@@ -5790,6 +6024,8 @@ void MCCanvasFill(MCCanvasRef p_canvas)
 	__MCCanvasImpl *t_canvas;
 	t_canvas = MCCanvasGet(p_canvas);
 	
+	MCCanvasRecordProperties(*t_canvas);
+	MCCanvasRecord(*t_canvas, kMCCanvasDisplayListOpFill);
 	MCCanvasApplyChanges(*t_canvas);
 	MCGContextBegin(t_canvas->context, false);
 	MCGContextFill(t_canvas->context);
@@ -5802,6 +6038,8 @@ void MCCanvasStroke(MCCanvasRef p_canvas)
 	__MCCanvasImpl *t_canvas;
 	t_canvas = MCCanvasGet(p_canvas);
 	
+	MCCanvasRecordProperties(*t_canvas);
+	MCCanvasRecord(*t_canvas, kMCCanvasDisplayListOpStroke);
 	MCCanvasApplyChanges(*t_canvas);
 	MCGContextBegin(t_canvas->context, false);
 	MCGContextStroke(t_canvas->context);
@@ -5814,6 +6052,11 @@ void MCCanvasClipToRect(MCCanvasRectangleRef p_rect, MCCanvasRef p_canvas)
 	__MCCanvasImpl *t_canvas;
 	t_canvas = MCCanvasGet(p_canvas);
 	
+	MCCanvasDisplayListCommand *t_command;
+	t_command = MCCanvasRecord(*t_canvas, kMCCanvasDisplayListOpClipToRect);
+	if (t_command != nil)
+		t_command->rects[0] = *MCCanvasRectangleGet(p_rect);
+	
 	MCGContextClipToRect(t_canvas->context, *MCCanvasRectangleGet(p_rect));
 }
 
@@ -5823,6 +6066,7 @@ void MCCanvasClipToPath(MCCanvasPathRef p_path, MCCanvasRef p_canvas)
     __MCCanvasImpl *t_canvas;
     t_canvas = MCCanvasGet(p_canvas);
     
+    MCCanvasRecord(*t_canvas, kMCCanvasDisplayListOpClipToPath, p_path);
     MCGContextClipToPath(t_canvas->context, *MCCanvasPathGet(p_path));
 }
 
@@ -5832,6 +6076,7 @@ void MCCanvasAddPath(MCCanvasPathRef p_path, MCCanvasRef p_canvas)
 	__MCCanvasImpl *t_canvas;
 	t_canvas = MCCanvasGet(p_canvas);
 	
+	MCCanvasRecord(*t_canvas, kMCCanvasDisplayListOpAddPath, p_path);
 	MCGContextAddPath(t_canvas->context, *MCCanvasPathGet(p_path));
 }
 
@@ -5857,6 +6102,15 @@ void MCCanvasDrawRectOfImage(MCCanvasRef p_canvas, MCCanvasImageRef p_image, con
 	MCImageRep *t_image;
 	t_image = MCCanvasImageGetImageRep(p_image);
 	
+	MCCanvasRecordProperties(*t_canvas);
+	MCCanvasDisplayListCommand *t_command;
+	t_command = MCCanvasRecord(*t_canvas, kMCCanvasDisplayListOpDrawRectOfImage, p_image);
+	if (t_command != nil)
+	{
+		t_command->rects[0] = p_src_rect;
+		t_command->rects[1] = p_dst_rect;
+	}
+	
 	MCCanvasApplyChanges(*t_canvas);
 
     MCImageRepRender(t_image, t_canvas->context, 0, p_src_rect, p_dst_rect, t_canvas->props().image_filter, t_canvas->last_paint);
@@ -5886,6 +6140,11 @@ void MCCanvasMoveTo(MCCanvasPointRef p_point, MCCanvasRef p_canvas)
 	__MCCanvasImpl *t_canvas;
 	t_canvas = MCCanvasGet(p_canvas);
 	
+	MCCanvasDisplayListCommand *t_command;
+	t_command = MCCanvasRecord(*t_canvas, kMCCanvasDisplayListOpMoveTo);
+	if (t_command != nil)
+		t_command->points[0] = *MCCanvasPointGet(p_point);
+	
 	MCGContextMoveTo(t_canvas->context, *MCCanvasPointGet(p_point));
 }
 
@@ -5895,6 +6154,11 @@ void MCCanvasLineTo(MCCanvasPointRef p_point, MCCanvasRef p_canvas)
 	__MCCanvasImpl *t_canvas;
 	t_canvas = MCCanvasGet(p_canvas);
 	
+	MCCanvasDisplayListCommand *t_command;
+	t_command = MCCanvasRecord(*t_canvas, kMCCanvasDisplayListOpLineTo);
+	if (t_command != nil)
+		t_command->points[0] = *MCCanvasPointGet(p_point);
+	
 	MCGContextLineTo(t_canvas->context, *MCCanvasPointGet(p_point));
 }
 
@@ -5904,6 +6168,14 @@ void MCCanvasCurveThroughPoint(MCCanvasPointRef p_through, MCCanvasPointRef p_to
 	__MCCanvasImpl *t_canvas;
 	t_canvas = MCCanvasGet(p_canvas);
 	
+	MCCanvasDisplayListCommand *t_command;
+	t_command = MCCanvasRecord(*t_canvas, kMCCanvasDisplayListOpQuadraticTo);
+	if (t_command != nil)
+	{
+		t_command->points[0] = *MCCanvasPointGet(p_through);
+		t_command->points[1] = *MCCanvasPointGet(p_to);
+	}
+	
 	MCGContextQuadraticTo(t_canvas->context, *MCCanvasPointGet(p_through), *MCCanvasPointGet(p_to));
 }
 
@@ -5913,6 +6185,15 @@ void MCCanvasCurveThroughPoints(MCCanvasPointRef p_through_a, MCCanvasPointRef p
 	__MCCanvasImpl *t_canvas;
 	t_canvas = MCCanvasGet(p_canvas);
 	
+	MCCanvasDisplayListCommand *t_command;
+	t_command = MCCanvasRecord(*t_canvas, kMCCanvasDisplayListOpCubicTo);
+	if (t_command != nil)
+	{
+		t_command->points[0] = *MCCanvasPointGet(p_through_a);
+		t_command->points[1] = *MCCanvasPointGet(p_through_b);
+		t_command->points[2] = *MCCanvasPointGet(p_to);
+	}
+	
 	MCGContextCubicTo(t_canvas->context, *MCCanvasPointGet(p_through_a), *MCCanvasPointGet(p_through_b), *MCCanvasPointGet(p_to));
 }
 
@@ -5922,35 +6203,50 @@ void MCCanvasClosePath(MCCanvasRef p_canvas)
 	__MCCanvasImpl *t_canvas;
 	t_canvas = MCCanvasGet(p_canvas);
 	
+	MCCanvasRecord(*t_canvas, kMCCanvasDisplayListOpClosePath);
 	MCGContextCloseSubpath(t_canvas->context);
 }
 
-MC_DLLEXPORT_DEF
-void MCCanvasFillText(MCStringRef p_text, MCCanvasPointRef p_point, MCCanvasRef p_canvas)
+void MCCanvasFillText(MCCanvasRef p_canvas, MCStringRef p_text, const MCGPoint &p_point)
 {
-	MCGPoint t_point;
-	t_point = *MCCanvasPointGet(p_point);
+	__MCCanvasImpl *t_canvas;
+	t_canvas = MCCanvasGet(p_canvas);
 	
 	MCGContextRef t_context;
-	t_context = MCCanvasGet(p_canvas)->context;
+	t_context = t_canvas->context;
 	
 	MCFontRef t_font;
-	t_font = MCCanvasFontGetMCFont(MCCanvasGetProps(p_canvas).font);
+	t_font = MCCanvasFontGetMCFont(t_canvas->props().font);
+
+	MCCanvasRecordProperties(*t_canvas);
+	MCCanvasDisplayListCommand *t_command;
+	t_command = MCCanvasRecord(*t_canvas, kMCCanvasDisplayListOpFillText, p_text);
+	if (t_command != nil)
+		t_command->points[0] = p_point;
+	
+	MCCanvasApplyChanges(*t_canvas);
+	MCFontDrawText(t_context, p_point.x, p_point.y, p_text, t_font, false, false);
+}
 
-	MCCanvasApplyChanges(*MCCanvasGet(p_canvas));
-	MCFontDrawText(t_context, t_point.x, t_point.y, p_text, t_font, false, false);
+MC_DLLEXPORT_DEF
+void MCCanvasFillText(MCStringRef p_text, MCCanvasPointRef p_point, MCCanvasRef p_canvas)
+{
+	MCCanvasFillText(p_canvas, p_text, *MCCanvasPointGet(p_point));
 }
 
-void MCCanvasFillTextAligned(MCStringRef p_text, integer_t p_halign, integer_t p_valign, MCCanvasRectangleRef p_rect, MCCanvasRef p_canvas)
+void MCCanvasFillTextAligned(MCCanvasRef p_canvas, MCStringRef p_text, integer_t p_halign, integer_t p_valign, const MCGRectangle &p_rect)
 {
+	__MCCanvasImpl *t_canvas;
+	t_canvas = MCCanvasGet(p_canvas);
+	
 	MCFontRef t_font;
-	t_font = MCCanvasFontGetMCFont(MCCanvasGetProps(p_canvas).font);
+	t_font = MCCanvasFontGetMCFont(t_canvas->props().font);
 	
 	MCGContextRef t_context;
-	t_context = MCCanvasGet(p_canvas)->context;
+	t_context = t_canvas->context;
 	
 	MCGRectangle t_rect;
-	t_rect = *MCCanvasRectangleGet(p_rect);
+	t_rect = p_rect;
 	
 	int32_t t_text_width;
 	t_text_width = MCFontMeasureText(t_font, p_text, MCGContextGetDeviceTransform(t_context));
@@ -5987,7 +6283,17 @@ void MCCanvasFillTextAligned(MCStringRef p_text, integer_t p_halign, integer_t p
 			MCUnreachableReturn()
 	}
 	
-	MCCanvasApplyChanges(*MCCanvasGet(p_canvas));
+	MCCanvasRecordProperties(*t_canvas);
+	MCCanvasDisplayListCommand *t_command;
+	t_command = MCCanvasRecord(*t_canvas, kMCCanvasDisplayListOpFillTextAligned, p_text);
+	if (t_command != nil)
+	{
+		t_command->params[0] = p_halign;
+		t_command->params[1] = p_valign;
+		t_command->rects[0] = p_rect;
+	}
+	
+	MCCanvasApplyChanges(*t_canvas);
 	MCFontDrawText(t_context, t_rect.origin.x + t_x, t_rect.origin.y + t_y, p_text, t_font, false, false);
 }
 
@@ -6009,7 +6315,7 @@ void MCCanvasFillTextAligned(MCStringRef p_text, integer_t p_align, MCCanvasRect
 {
 	integer_t t_h_aligh, t_v_align;
 	MCCanvasAlignmentSplit(p_align, t_h_aligh, t_v_align);
-	MCCanvasFillTextAligned(p_text, t_h_aligh, t_v_align, p_rect, p_canvas);
+	MCCanvasFillTextAligned(p_canvas, p_text, t_h_aligh, t_v_align, *MCCanvasRectangleGet(p_rect));
 }
 
 MC_DLLEXPORT_DEF
@@ -6043,6 +6349,152 @@ void MCCanvasPop(uintptr_t p_cookie)
     MCValueRelease(t_canvas);
 }
 
+void MCCanvasPushRecording(MCGContextRef p_gcontext, uintptr_t& r_cookie)
+{
+    MCCanvasPush(p_gcontext, r_cookie);
+    if (s_current_canvas == nil)
+        return;
+    
+    __MCCanvasDisplayList *t_list;
+    if (!MCMemoryNew(t_list))
+        return;
+    
+    t_list -> device_transform = MCGContextGetDeviceTransform(p_gcontext);
+    t_list -> replayable = true;
+    MCCanvasGet(s_current_canvas) -> recording = t_list;
+}
+
+void MCCanvasPopRecording(uintptr_t p_cookie, MCCanvasDisplayListRef& r_list)
+{
+    MCCanvasDisplayListRef t_list;
+    t_list = nil;
+    if (s_current_canvas != nil)
+    {
+        __MCCanvasImpl *t_canvas;
+        t_canvas = MCCanvasGet(s_current_canvas);
+        t_list = t_canvas -> recording;
+        t_canvas -> recording = nil;
+    }
+    
+    MCCanvasPop(p_cookie);
+    
+    if (t_list != nil && !t_list -> replayable)
+    {
+        MCCanvasDisplayListDestroy(t_list);
+        t_list = nil;
+    }
+    
+    r_list = t_list;
+}
+
+void MCCanvasDisplayListDestroy(MCCanvasDisplayListRef p_list)
+{
+    if (p_list == nil)
+        return;
+    
+    for (uindex_t i = 0; i < p_list -> command_count; i++)
+        MCValueRelease(p_list -> commands[i] . value);
+    MCMemoryDeleteArray(p_list -> commands);
+    
+    for (uindex_t i = 0; i < p_list -> property_count; i++)
+        MCCanvasPropertiesClear(p_list -> properties[i]);
+    MCMemoryDeleteArray(p_list -> properties);
+    
+    MCMemoryDelete(p_list);
+}
+
+bool MCCanvasDisplayListCanReplay(MCCanvasDisplayListRef p_list, MCGContextRef p_gcontext)
+{
+    // Only the translation may differ; text layout and image scaling depend on
+    // the rest of the transform.
+    MCGAffineTransform t_transform;
+    t_transform = MCGContextGetDeviceTransform(p_gcontext);
+    return t_transform . a == p_list -> device_transform . a &&
+        t_transform . b == p_list -> device_transform . b &&
+        t_transform . c == p_list -> device_transform . c &&
+        t_transform . d == p_list -> device_transform . d;
+}
+
+void MCCanvasDisplayListReplay(MCCanvasDisplayListRef p_list, MCGContextRef p_gcontext)
+{
+    MCCanvasRef t_canvas;
+    if (!MCCanvasCreate(p_gcontext, t_canvas))
+        return;
+    
+    __MCCanvasImpl *t_canvas_impl;
+    t_canvas_impl = MCCanvasGet(t_canvas);
+    
+    for (uindex_t i = 0; i < p_list -> command_count; i++)
+    {
+        const MCCanvasDisplayListCommand &t_command = p_list -> commands[i];
+        switch (t_command . op)
+        {
+            case kMCCanvasDisplayListOpSetProperties:
+                MCCanvasPropertiesAssign(*t_canvas_impl, p_list -> properties[t_command . params[0]]);
+                break;
+            case kMCCanvasDisplayListOpTransform:
+                MCCanvasTransform(t_canvas, t_command . transform);
+                break;
+            case kMCCanvasDisplayListOpSaveState:
+                MCCanvasSaveState(t_canvas);
+                break;
+            case kMCCanvasDisplayListOpRestoreState:
+                MCCanvasRestoreState(t_canvas);
+                break;
+            case kMCCanvasDisplayListOpBeginLayer:
+                MCCanvasBeginLayer(t_canvas);
+                break;
+            case kMCCanvasDisplayListOpBeginLayerWithEffect:
+                _MCCanvasBeginLayerWithEffect((MCCanvasEffectRef)t_command . value, t_canvas, t_command . params[0] != 0);
+                break;
+            case kMCCanvasDisplayListOpEndLayer:
+                MCCanvasEndLayer(t_canvas);
+                break;
+            case kMCCanvasDisplayListOpFill:
+                MCCanvasFill(t_canvas);
+                break;
+            case kMCCanvasDisplayListOpStroke:
+                MCCanvasStroke(t_canvas);
+                break;
+            case kMCCanvasDisplayListOpClipToRect:
+                MCGContextClipToRect(p_gcontext, t_command . rects[0]);
+                break;
+            case kMCCanvasDisplayListOpClipToPath:
+                MCCanvasClipToPath((MCCanvasPathRef)t_command . value, t_canvas);
+                break;
+            case kMCCanvasDisplayListOpAddPath:
+                MCCanvasAddPath((MCCanvasPathRef)t_command . value, t_canvas);
+                break;
+            case kMCCanvasDisplayListOpMoveTo:
+                MCGContextMoveTo(p_gcontext, t_command . points[0]);
+                break;
+            case kMCCanvasDisplayListOpLineTo:
+                MCGContextLineTo(p_gcontext, t_command . points[0]);
+                break;
+            case kMCCanvasDisplayListOpQuadraticTo:
+                MCGContextQuadraticTo(p_gcontext, t_command . points[0], t_command . points[1]);
+                break;
+            case kMCCanvasDisplayListOpCubicTo:
+                MCGContextCubicTo(p_gcontext, t_command . points[0], t_command . points[1], t_command . points[2]);
+                break;
+            case kMCCanvasDisplayListOpClosePath:
+                MCGContextCloseSubpath(p_gcontext);
+                break;
+            case kMCCanvasDisplayListOpDrawRectOfImage:
+                MCCanvasDrawRectOfImage(t_canvas, (MCCanvasImageRef)t_command . value, t_command . rects[0], t_command . rects[1]);
+                break;
+            case kMCCanvasDisplayListOpFillText:
+                MCCanvasFillText(t_canvas, (MCStringRef)t_command . value, t_command . points[0]);
+                break;
+            case kMCCanvasDisplayListOpFillTextAligned:
+                MCCanvasFillTextAligned(t_canvas, (MCStringRef)t_command . value, t_command . params[0], t_command . params[1], t_command . rects[0]);
+                break;
+        }
+    }
+    
+    MCValueRelease(t_canvas);
+}
+
 extern "C" MC_DLLEXPORT_DEF void MCCanvasThisCanvas(MCCanvasRef& r_canvas)
 {
     if (s_current_canvas == nil)
@@ -6087,6 +6539,7 @@ extern "C" MC_DLLEXPORT_DEF void MCCanvasGetPixelDataOfCanvas(MCCanvasRef p_canv
 {
 	__MCCanvasImpl *t_canvas;
 	t_canvas = MCCanvasGet(p_canvas);
+	MCCanvasStopRecording(*t_canvas);
     
     uint32_t t_width, t_height;
     t_width = MCGContextGetWidth(t_canvas -> context);
@@ -6098,19 +6551,9 @@ extern "C" MC_DLLEXPORT_DEF void MCCanvasGetPixelDataOfCanvas(MCCanvasRef p_canv
     uint32_t t_pixel_count;
     t_pixel_count = t_width * t_height;
     
-    uint32_t *t_my_pixels, *t_data_ptr;
+    uint32_t *t_my_pixels;
     t_my_pixels = new (nothrow) uint32_t[t_pixel_count];
-    memcpy(t_my_pixels, t_pixels, t_pixel_count * sizeof(uint32_t));
-    
-    t_data_ptr = t_my_pixels;
-#if (kMCGPixelFormatNative != kMCGPixelFormatARGB)
-    while (t_pixel_count--)
-    {
-        uint8_t t_r, t_g, t_b, t_a;
-        MCGPixelUnpackNative(*t_data_ptr, t_r, t_g, t_b, t_a);
-        *t_data_ptr++ = MCGPixelPack(kMCGPixelFormatARGB, t_r, t_g, t_b, t_a);
-    }
-#endif
+    MCPixelRowSwizzle((uint32_t *)t_pixels, kMCGPixelFormatNative, t_my_pixels, kMCGPixelFormatARGB, t_pixel_count);
     
     if (!MCDataCreateWithBytesAndRelease((byte_t *)t_my_pixels, t_width * t_height * sizeof(uint32_t), r_data))
         return;
@@ -92,6 +92,20 @@ void MCCanvasModuleFinalize();
 void MCCanvasPush(MCGContextRef gcontext, uintptr_t& r_cookie);
 void MCCanvasPop(uintptr_t p_cookie);
 
+// Display lists hold the operations performed on the current canvas between
+// a recording push and pop, so they can be drawn again without re-running the
+// code which produced them.
+typedef struct __MCCanvasDisplayList *MCCanvasDisplayListRef;
+
+void MCCanvasPushRecording(MCGContextRef gcontext, uintptr_t& r_cookie);
+// Returns nil in r_list if the operations could not be recorded faithfully.
+void MCCanvasPopRecording(uintptr_t p_cookie, MCCanvasDisplayListRef& r_list);
+// A display list can only be replayed on a context whose device transform
+// has the same scale and rotation as the one it was recorded on.
+bool MCCanvasDisplayListCanReplay(MCCanvasDisplayListRef p_list, MCGContextRef p_gcontext);
+void MCCanvasDisplayListReplay(MCCanvasDisplayListRef p_list, MCGContextRef p_gcontext);
+void MCCanvasDisplayListDestroy(MCCanvasDisplayListRef p_list);
+
 ////////////////////////////////////////////////////////////////////////////////
 // Type Definitions
 
@@ -44,6 +44,7 @@
 #include "libscript/script.h"
 #include "filepath.h"
 #include "osspec.h"
+#include "mcmessagedigest.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -1405,6 +1406,105 @@ extern "C" MC_DLLEXPORT_DEF MCStringRef MCEngineExecResolveFilePath(MCStringRef
 
 ////////////////////////////////////////////////////////////////////////////////
 
+typedef struct __MCEngineMessageDigest *MCEngineMessageDigestRef;
+
+struct __MCEngineMessageDigestImpl
+{
+    MCMessageDigestRef digest;
+};
+
+MC_DLLEXPORT_DEF MCTypeInfoRef kMCEngineMessageDigestTypeInfo;
+
+extern "C" MC_DLLEXPORT_DEF MCTypeInfoRef MCEngineMessageDigestTypeInfo()
+{ return kMCEngineMessageDigestTypeInfo; }
+
+static MCMessageDigestRef MCEngineMessageDigestGet(MCEngineMessageDigestRef p_digest)
+{
+    return ((__MCEngineMessageDigestImpl *)MCValueGetExtraBytesPtr(p_digest))->digest;
+}
+
+static void __MCEngineMessageDigestDestroy(MCValueRef p_value)
+{
+    MCMessageDigestDestroy(MCEngineMessageDigestGet((MCEngineMessageDigestRef)p_value));
+}
+
+// A message digest is a reference to the state of a computation, so copies
+// share the same state.
+static bool __MCEngineMessageDigestCopy(MCValueRef p_value, bool p_release, MCValueRef& r_copy)
+{
+    if (p_release)
+        r_copy = p_value;
+    else
+        r_copy = MCValueRetain(p_value);
+    
+    return true;
+}
+
+static bool __MCEngineMessageDigestEqual(MCValueRef p_left, MCValueRef p_right)
+{
+    return p_left == p_right;
+}
+
+static hash_t __MCEngineMessageDigestHash(MCValueRef p_value)
+{
+    return MCHashPointer(p_value);
+}
+
+static bool __MCEngineMessageDigestDescribe(MCValueRef p_value, MCStringRef& r_description)
+{
+    return MCStringCopy(MCSTR("<message digest>"), r_description);
+}
+
+static MCValueCustomCallbacks kMCEngineMessageDigestCustomValueCallbacks =
+{
+    false,
+    __MCEngineMessageDigestDestroy,
+    __MCEngineMessageDigestCopy,
+    __MCEngineMessageDigestEqual,
+    __MCEngineMessageDigestHash,
+    __MCEngineMessageDigestDescribe,
+    nil,
+    nil,
+};
+
+extern "C" MC_DLLEXPORT_DEF void MCEngineEvalMessageDigestWithAlgorithm(MCStringRef p_algorithm, MCEngineMessageDigestRef& r_digest)
+{
+    MCMessageDigestRef t_digest;
+    if (!MCMessageDigestCreate(p_algorithm, t_digest))
+    {
+        MCErrorCreateAndThrow(kMCGenericErrorTypeInfo, "reason", MCSTR("unknown message digest algorithm"), nil);
+        return;
+    }
+    
+    MCEngineMessageDigestRef t_value;
+    if (!MCValueCreateCustom(kMCEngineMessageDigestTypeInfo, sizeof(__MCEngineMessageDigestImpl), t_value))
+    {
+        MCMessageDigestDestroy(t_digest);
+        return;
+    }
+    
+    ((__MCEngineMessageDigestImpl *)MCValueGetExtraBytesPtr(t_value))->digest = t_digest;
+    r_digest = t_value;
+}
+
+extern "C" MC_DLLEXPORT_DEF void MCEngineExecUpdateMessageDigest(MCDataRef p_data, MCEngineMessageDigestRef p_digest)
+{
+    MCMessageDigestUpdate(MCEngineMessageDigestGet(p_digest), MCDataGetBytePtr(p_data), MCDataGetLength(p_data));
+}
+
+extern "C" MC_DLLEXPORT_DEF void MCEngineExecUpdateMessageDigestFromFile(MCStringRef p_path, MCEngineMessageDigestRef p_digest)
+{
+    if (!MCMessageDigestUpdateWithFile(MCEngineMessageDigestGet(p_digest), p_path))
+        MCErrorCreateAndThrow(kMCGenericErrorTypeInfo, "reason", MCSTR("can't open file"), nil);
+}
+
+extern "C" MC_DLLEXPORT_DEF void MCEngineEvalDigestOfMessageDigest(MCEngineMessageDigestRef p_digest, MCDataRef& r_digest)
+{
+    MCMessageDigestCopyDigest(MCEngineMessageDigestGet(p_digest), r_digest);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 MC_DLLEXPORT_DEF MCTypeInfoRef kMCEngineScriptObjectDoesNotExistErrorTypeInfo = nil;
 MC_DLLEXPORT_DEF MCTypeInfoRef kMCEngineScriptObjectNoContextErrorTypeInfo = nil;
 
@@ -1421,6 +1521,9 @@ extern "C" bool com_livecode_engine_Initialize(void)
 	if (!MCNamedCustomTypeInfoCreate(MCNAME("com.livecode.engine.ScriptObject"), kMCNullTypeInfo, &kMCScriptObjectCustomValueCallbacks, kMCEngineScriptObjectTypeInfo))
 		return false;
 	
+	if (!MCNamedCustomTypeInfoCreate(MCNAME("com.livecode.engine.MessageDigest"), kMCNullTypeInfo, &kMCEngineMessageDigestCustomValueCallbacks, kMCEngineMessageDigestTypeInfo))
+		return false;
+	
 	if (!MCStringCreateMutable(0, s_log_buffer))
 		return false;
     
@@ -1433,6 +1536,7 @@ extern "C" void com_livecode_engine_Finalize(void)
 {
     MCValueRelease(s_log_buffer);
     MCValueRelease(kMCEngineScriptObjectTypeInfo);
+    MCValueRelease(kMCEngineMessageDigestTypeInfo);
 	MCValueRelease(kMCEngineScriptObjectDoesNotExistErrorTypeInfo);
 }
 
@@ -26,6 +26,7 @@ typedef struct __MCScriptObject *MCScriptObjectRef;
 extern "C"
 {
     extern MC_DLLEXPORT MCTypeInfoRef kMCEngineScriptObjectTypeInfo;
+    extern MC_DLLEXPORT MCTypeInfoRef kMCEngineMessageDigestTypeInfo;
 
 	extern MC_DLLEXPORT MCTypeInfoRef kMCEngineScriptObjectDoesNotExistErrorTypeInfo;
 	extern MC_DLLEXPORT MCTypeInfoRef kMCEngineScriptObjectNoContextErrorTypeInfo;
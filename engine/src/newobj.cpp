@@ -554,6 +554,8 @@ MCExpression *MCN_new_function(int2 which)
 		return new MCLicensed;
 	case F_LINE_OFFSET:
 		return new MCLineOffset;
+    case F_LINE_DIFF:
+        return new MCLineDiffFunc;
 	case F_LIST_REGISTRY:
 		return new MCListRegistry;
 	case F_LN1:
@@ -600,6 +602,8 @@ MCExpression *MCN_new_function(int2 which)
 		return new MCMerge;
     case F_MESSAGE_DIGEST:
         return new MCMessageDigestFunc;
+    case F_FILE_MESSAGE_DIGEST:
+        return new MCFileMessageDigestFunc;
 	case F_MILLISECS:
 		return new MCMillisecs;
 	case F_MIN:
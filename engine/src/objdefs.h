@@ -790,6 +790,29 @@ enum MCImagePaletteType
 	kMCImagePaletteTypeCustom,
 };
 
+// Row filter applied by the PNG encoder, set by the pngFilter property.
+// The default filter lets libpng choose: adaptive for truecolor images,
+// none for indexed images.
+enum MCImagePNGFilter
+{
+	kMCImagePNGFilterDefault,
+	kMCImagePNGFilterNone,
+	kMCImagePNGFilterSub,
+	kMCImagePNGFilterUp,
+	kMCImagePNGFilterAverage,
+	kMCImagePNGFilterPaeth,
+	kMCImagePNGFilterAdaptive,
+};
+
+// Chroma subsampling applied by the JPEG encoder, set by the
+// jpegChromaSubsampling property.
+enum MCImageJPEGSubsampling
+{
+	kMCImageJPEGSubsampling420,
+	kMCImageJPEGSubsampling422,
+	kMCImageJPEGSubsampling444,
+};
+
 typedef struct _MCImagePaletteSettings
 {
 	MCImagePaletteType type;
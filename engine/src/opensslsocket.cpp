@@ -39,6 +39,7 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 #include "notify.h"
 #include "socket.h"
+#include "httprequest.h"
 #include "system.h"
 
 #if defined(_WINDOWS_DESKTOP) || defined(_WINDOWS_SERVER)
@@ -926,6 +927,13 @@ MCDataRef MCS_read_socket(MCSocket *s, MCExecContext &ctxt, uint4 length, const
 	}
 	else
 	{
+		// Requests arriving on an http socket are parsed by the engine.
+		if (s->http)
+		{
+			MCresult->sets("can't read from this socket");
+			return t_data;
+		}
+
 		MCSocketread *eptr = new (nothrow) MCSocketread(length, until != nil ? strdup(until) : nil, ctxt . GetObject(), mptr);
 		eptr->appendto(s->revents);
 		s->setselect();
@@ -1472,6 +1480,9 @@ MCSocket::MCSocket(MCNameRef n, MCNameRef f, MCObject *o, MCNameRef m, Boolean d
 	sslstate = SSTATE_NONE; // Not on Mac?
 	secure = issecure;
 	resolve_state = kMCSocketStateNew;
+	http = httpcontinue = False;
+	httpserver = nil;
+	MCHttpRequestParserReset(httpparser);
 	init(fd);
 	
 	// MM-2014-06-13: [[ Bug 12567 ]] Added support for specifying an end host name to verify against.
@@ -1491,6 +1502,7 @@ MCSocket::~MCSocket()
 	
 	// MM-2014-06-13: [[ Bug 12567 ]] Added support for specifying an end host name to verify against.
 	MCValueRelease(endhostname);
+	MCValueRelease(httpserver);
 }
 
 void MCSocket::deletereads()
@@ -1501,6 +1513,7 @@ void MCSocket::deletereads()
 		delete eptr;
 	}
 	nread = 0;
+	MCHttpRequestParserReset(httpparser);
 }
 
 void MCSocket::deletewrites()
@@ -1595,14 +1608,20 @@ void MCSocket::acceptone()
 		MCNameRef t_name;
 		MCNameCreate(*n, t_name);
         MCSocket *t_socket;
-        t_socket = new (nothrow) MCSocket(t_name, NULL, object, NULL, False, newfd, False, False,False);
+        t_socket = new (nothrow) MCSocket(t_name, NULL, object, http ? message : NULL, False, newfd, False, False,False);
         if (t_socket != NULL)
         {
+            if (http)
+            {
+                t_socket -> http = True;
+                t_socket -> httpserver = MCValueRetain(name);
+            }
             MCSocketsAppendToSocketList(t_socket);
             t_socket -> connected = True;
             t_socket -> setselect();
         }
-		MCscreen->delaymessage(object, message, *n, MCNameGetString(name));
+		if (!http)
+			MCscreen->delaymessage(object, message, *n, MCNameGetString(name));
 		added = True;
 	}
 }
@@ -1702,16 +1721,24 @@ void MCSocket::readsome()
 				/* UNCHECKED */ MCStringFormat(&n, "%s:%d", t, MCSwapInt16NetworkToHost(addr.sin_port));
 				/* UNCHECKED */ MCNameCreate(*n, &t_name);
                 MCSocket *t_socket;
-                t_socket = new (nothrow) MCSocket(*t_name, NULL, object, NULL, False, newfd, False, False,secure);
+                t_socket = new (nothrow) MCSocket(*t_name, NULL, object, http ? message : NULL, False, newfd, False, False,secure);
                 if (t_socket != NULL)
                 {
+                    if (http)
+                    {
+                        t_socket -> http = True;
+                        t_socket -> httpserver = MCValueRetain(name);
+                    }
                     MCSocketsAppendToSocketList(t_socket);
                     t_socket -> connected = True;
                     if (secure)
                         t_socket -> sslaccept();
                     t_socket -> setselect();
                 }
-				MCscreen->delaymessage(object, message, MCNameGetString(*t_name), MCNameGetString(name));
+				// The message of an http socket is sent for each request rather
+				// than each connection.
+				if (!http)
+					MCscreen->delaymessage(object, message, MCNameGetString(*t_name), MCNameGetString(name));
 				added = True;
 			}
 #endif
@@ -1799,6 +1826,12 @@ void MCSocket::readsome()
 
 void MCSocket::processreadqueue()
 {
+	if (http)
+	{
+		processhttprequests();
+		return;
+	}
+
 	if (!waiting)
 		while (revents != NULL)
 		{
@@ -1835,6 +1868,91 @@ void MCSocket::processreadqueue()
 		}
 }
 
+void MCSocket::processhttprequests()
+{
+	while (nread != 0 && !closing)
+	{
+		uindex_t t_consumed;
+		bool t_expect_continue;
+		MCAutoArrayRef t_request;
+		MCHttpRequestParseStatus t_status;
+		t_status = MCHttpRequestParse(httpparser, rbuffer, nread, kMCHttpRequestMaxBodySize, t_consumed, t_expect_continue, &t_request);
+
+		if (t_status == kMCHttpRequestParseIncomplete)
+		{
+			// Let the client know it can send the body, but only once for
+			// each request.
+			if (t_expect_continue && !httpcontinue)
+			{
+				queuehttpresponse("HTTP/1.1 100 Continue\r\n\r\n");
+				httpcontinue = True;
+			}
+			break;
+		}
+
+		if (t_status == kMCHttpRequestParseError)
+		{
+			// The framing of any further requests can't be trusted, so reject
+			// this one and close the connection once the response is written.
+			deletereads();
+			closing = True;
+			queuehttpresponse("HTTP/1.1 400 Bad Request\r\nConnection: close\r\nContent-Length: 0\r\n\r\n");
+			break;
+		}
+
+		if (t_status == kMCHttpRequestParseTooLarge)
+		{
+			// The rest of the body won't be read, so the connection can't be
+			// used for further requests either.
+			deletereads();
+			closing = True;
+			queuehttpresponse("HTTP/1.1 413 Payload Too Large\r\nConnection: close\r\nContent-Length: 0\r\n\r\n");
+			break;
+		}
+
+		nread -= t_consumed;
+		memmove(rbuffer, rbuffer + t_consumed, nread);
+		httpcontinue = False;
+
+		if (message != nil && object . IsValid())
+		{
+			MCParameter *params = new (nothrow) MCParameter;
+			params->setvalueref_argument(name);
+			params->setnext(new (nothrow) MCParameter);
+			params->getnext()->setvalueref_argument(*t_request);
+			params->getnext()->setnext(new (nothrow) MCParameter);
+			params->getnext()->getnext()->setvalueref_argument(httpserver != nil ? httpserver : kMCEmptyName);
+			MCscreen->addmessage(object, message, curtime, params);
+		}
+		added = True;
+	}
+
+	if (nread == 0 && fd == 0 && object . IsValid())
+	{
+		MCscreen->delaymessage(object, MCM_socket_closed, MCNameGetString(name));
+		added = True;
+	}
+}
+
+// Queue a response generated by the engine, rather than script, on an http
+// socket. Writes with an empty message are removed from the queue once sent
+// without notifying any object.
+void MCSocket::queuehttpresponse(const char *p_response)
+{
+	MCAutoStringRef t_response;
+	if (!MCStringCreateWithCString(p_response, &t_response))
+		return;
+
+	MCSocketwrite *eptr = new (nothrow) MCSocketwrite(*t_response, nil, kMCEmptyName, secure);
+	if (eptr == nil)
+		return;
+
+	eptr->appendto(wevents);
+	setselect();
+	if (connected)
+		writesome();
+}
+
 void MCSocket::writesome()
 {
 #if defined(_WINDOWS_DESKTOP) || defined(_WINDOWS_SERVER)
@@ -1915,6 +2033,13 @@ void MCSocket::doclose()
 {
 	deletewrites();
 
+	// Any partial request left on an http socket can never be completed.
+	if (http)
+	{
+		nread = 0;
+		MCHttpRequestParserReset(httpparser);
+	}
+
 	if (!waiting)
 	{
 		if (error != NULL)
@@ -1944,7 +2069,7 @@ void MCSocket::setselect()
 	if (fd)
 	{
 #if defined(_WINDOWS_DESKTOP) || defined(_WINDOWS_SERVER)
-		if (connected && !closing && ((!shared && revents != NULL) || accepting || datagram))
+		if (connected && !closing && ((!shared && (revents != NULL || http)) || accepting || datagram))
 #else
 
 		if (connected && !closing && ((!shared && revents != NULL) || accepting))
@@ -37,7 +37,8 @@ enum Accept_constants {
 	AC_ON,
 	AC_PORT,
 	AC_DATAGRAM,
-    AC_SECURE
+    AC_SECURE,
+    AC_HTTP
 };
 
 enum Apple_event {
@@ -239,6 +240,7 @@ enum Export_format {
 	EX_RAW_INDEXED,
 	EX_BMP,
     EX_OBJECT,
+    EX_SNAPSHOTS,
 };
 
 enum Factor_rank {
@@ -607,6 +609,10 @@ enum Functions {
     F_EVENT_CONTROL_KEY,
     F_EVENT_OPTION_KEY,
     F_EVENT_SHIFT_KEY,
+    
+    F_FILE_MESSAGE_DIGEST,
+    
+    F_LINE_DIFF,
 };
 
 /* The HT_MIN and HT_MAX elements of the enum delimit the range of the handler
@@ -1761,6 +1767,14 @@ enum Properties {
 	
 	P_SYSTEM_APPEARANCE,
     
+    P_RETAIN_PAINT,
+    P_PAINT_TIME,
+    P_LAYER_CACHE,
+    P_PNG_COMPRESSION_LEVEL,
+    P_PNG_FILTER,
+    P_JPEG_PROGRESSIVE,
+    P_JPEG_CHROMA_SUBSAMPLING,
+    
     __P_LAST,
 };
 
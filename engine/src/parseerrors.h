@@ -1798,6 +1798,15 @@ enum Parse_errors
     
     // {PE-0584} out of memory
     PE_OUTOFMEMORY,
+    
+    // {PE-0585} fileMessageDigest: bad parameters
+    PE_FILEMESSAGEDIGEST_BADPARAM,
+    
+    // {PE-0586} lineDiff: bad parameters
+    PE_LINEDIFF_BADPARAM,
+
+    // {PE-0587} export: expected 'from' and a list of objects
+    PE_EXPORT_BADOBJECTS,
 };
 
 extern const char *MCparsingerrors;
@@ -0,0 +1,648 @@
+/* Copyright (C) 2017 LiveCode Ltd.
+
+This file is part of LiveCode.
+
+LiveCode is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License v3 as published by the Free
+Software Foundation.
+
+LiveCode is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
+
+#include "prefix.h"
+
+#include "pixelkernels.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// The AVX2 kernels are compiled for x86 whatever the baseline instruction
+// set, and used if the processor supports them.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MCPIXEL_AVX2
+#define MCPIXEL_AVX2_TARGET __attribute__((target("avx2")))
+
+static bool MCPixelHasAVX2(void)
+{
+	static const bool s_has_avx2 = __builtin_cpu_supports("avx2");
+	return s_has_avx2;
+}
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Divide each 8-bit channel of x by 255 after scaling by a, rounding to
+// nearest.
+static inline uint32_t MCPixelPackedScaleBounded(uint32_t x, uint8_t a)
+{
+	uint32_t u, v;
+	u = ((x & 0xff00ff) * a) + 0x800080;
+	u = ((u + ((u >> 8) & 0xff00ff)) >> 8) & 0xff00ff;
+	v = ((x & 0x00ff00) * a) + 0x8000;
+	v = ((v + ((v >> 8) & 0x00ff00)) >> 8) & 0x00ff00;
+	return u + v;
+}
+
+// Scale each of the three color channels of x by 255 / a, truncating.
+static inline uint32_t MCPixelPackedDivideBounded(uint32_t x, uint8_t a)
+{
+	uint32_t u, v, w;
+	u = ((((x & 0xff0000) << 8) - (x & 0xff0000)) / a) & 0xff0000;
+	v = ((((x & 0x00ff00) << 8) - (x & 0x00ff00)) / a) & 0x00ff00;
+	w = ((((x & 0x0000ff) << 8) - (x & 0x0000ff)) / a) & 0x0000ff;
+	return u | v | w;
+}
+
+static inline uint32_t MCPixelPremultiply(uint32_t p_pixel)
+{
+	uint8_t t_alpha = p_pixel >> 24;
+	if (t_alpha == 0)
+		return 0;
+	if (t_alpha == 0xFF)
+		return p_pixel;
+	return MCPixelPackedScaleBounded(p_pixel, t_alpha) | (t_alpha << 24);
+}
+
+static inline uint32_t MCPixelUnpremultiply(uint32_t p_pixel)
+{
+	uint8_t t_alpha = p_pixel >> 24;
+	if (t_alpha == 0)
+		return 0;
+	if (t_alpha == 0xFF)
+		return p_pixel;
+	return (t_alpha << 24) | MCPixelPackedDivideBounded(p_pixel, t_alpha);
+}
+
+// The shifts which take each channel of a pixel format to the bottom byte,
+// in red, green, blue, alpha order.
+struct MCPixelChannelShifts
+{
+	uint32_t shift[4];
+};
+
+static MCPixelChannelShifts MCPixelGetChannelShifts(MCGPixelFormat p_format)
+{
+	uint32_t t_masks[4] =
+	{
+		MCGPixelPack(p_format, 0xFF, 0, 0, 0),
+		MCGPixelPack(p_format, 0, 0xFF, 0, 0),
+		MCGPixelPack(p_format, 0, 0, 0xFF, 0),
+		MCGPixelPack(p_format, 0, 0, 0, 0xFF),
+	};
+
+	MCPixelChannelShifts t_shifts;
+	for (uindex_t i = 0; i < 4; i++)
+	{
+		t_shifts.shift[i] = 0;
+		while ((t_masks[i] >> t_shifts.shift[i]) != 0xFF)
+			t_shifts.shift[i] += 8;
+	}
+	return t_shifts;
+}
+
+static inline uint32_t MCPixelSwizzle(uint32_t p_pixel, const MCPixelChannelShifts& p_src, const MCPixelChannelShifts& p_dst)
+{
+	return (((p_pixel >> p_src.shift[0]) & 0xFF) << p_dst.shift[0]) |
+		(((p_pixel >> p_src.shift[1]) & 0xFF) << p_dst.shift[1]) |
+		(((p_pixel >> p_src.shift[2]) & 0xFF) << p_dst.shift[2]) |
+		(((p_pixel >> p_src.shift[3]) & 0xFF) << p_dst.shift[3]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Each vector kernel processes as many whole vectors of pixels as it can and
+// returns the number of pixels it has processed, leaving the rest of the row
+// to the next narrower kernel.
+
+#if defined(__SSE2__)
+
+// Premultiply the 8-bit channels in the 16-bit lanes of p_channels by the
+// matching lanes of p_alpha, dividing by 255 with rounding as in
+// MCPixelPackedScaleBounded.
+static inline __m128i MCPixelScaleChannelsSSE2(__m128i p_channels, __m128i p_alpha)
+{
+	__m128i t_product = _mm_add_epi16(_mm_mullo_epi16(p_channels, p_alpha), _mm_set1_epi16(0x80));
+	return _mm_srli_epi16(_mm_add_epi16(t_product, _mm_srli_epi16(t_product, 8)), 8);
+}
+
+static uindex_t MCPixelRowPremultiplySSE2(const uint32_t *p_src, uint32_t *r_dst, uindex_t p_count)
+{
+	const __m128i t_zero = _mm_setzero_si128();
+	// Scale the alpha channel itself by 255, leaving it unchanged.
+	const __m128i t_alpha_lanes = _mm_set_epi16(0xFF, 0, 0, 0, 0xFF, 0, 0, 0);
+
+	uindex_t i = 0;
+	for (; i + 4 <= p_count; i += 4)
+	{
+		__m128i t_pixels = _mm_loadu_si128((const __m128i *)(p_src + i));
+
+		// Spread each pixel's alpha across the 16-bit lanes of its channels.
+		__m128i t_alpha = _mm_srli_epi32(t_pixels, 24);
+		t_alpha = _mm_or_si128(t_alpha, _mm_slli_epi32(t_alpha, 16));
+		__m128i t_alpha_lo = _mm_or_si128(_mm_unpacklo_epi32(t_alpha, t_alpha), t_alpha_lanes);
+		__m128i t_alpha_hi = _mm_or_si128(_mm_unpackhi_epi32(t_alpha, t_alpha), t_alpha_lanes);
+
+		__m128i t_lo = MCPixelScaleChannelsSSE2(_mm_unpacklo_epi8(t_pixels, t_zero), t_alpha_lo);
+		__m128i t_hi = MCPixelScaleChannelsSSE2(_mm_unpackhi_epi8(t_pixels, t_zero), t_alpha_hi);
+		_mm_storeu_si128((__m128i *)(r_dst + i), _mm_packus_epi16(t_lo, t_hi));
+	}
+	return i;
+}
+
+// Divide one 8-bit channel of each pixel by its alpha, as in
+// MCPixelPackedDivideBounded. The numerator and alpha are exact as floats
+// and the division is correctly rounded, so truncating the quotient gives
+// the same result as integer division.
+static inline __m128i MCPixelDivideChannelSSE2(__m128i p_pixels, int p_shift, __m128 p_alpha)
+{
+	__m128i t_channel = _mm_and_si128(_mm_srli_epi32(p_pixels, p_shift), _mm_set1_epi32(0xFF));
+	__m128i t_scaled = _mm_sub_epi32(_mm_slli_epi32(t_channel, 8), t_channel);
+	__m128i t_quotient = _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(t_scaled), p_alpha));
+	return _mm_slli_epi32(_mm_and_si128(t_quotient, _mm_set1_epi32(0xFF)), p_shift);
+}
+
+static uindex_t MCPixelRowUnpremultiplySSE2(const uint32_t *p_src, uint32_t *r_dst, uindex_t p_count)
+{
+	const __m128i t_zero = _mm_setzero_si128();
+	const __m128i t_one = _mm_set1_epi32(1);
+
+	uindex_t i = 0;
+	for (; i + 4 <= p_count; i += 4)
+	{
+		__m128i t_pixels = _mm_loadu_si128((const __m128i *)(p_src + i));
+		__m128i t_alpha = _mm_srli_epi32(t_pixels, 24);
+
+		// Pixels with zero alpha become zero, so divide them by one instead.
+		__m128i t_transparent = _mm_cmpeq_epi32(t_alpha, t_zero);
+		__m128 t_divisor = _mm_cvtepi32_ps(_mm_or_si128(t_alpha, _mm_and_si128(t_transparent, t_one)));
+
+		__m128i t_result = _mm_slli_epi32(t_alpha, 24);
+		t_result = _mm_or_si128(t_result, MCPixelDivideChannelSSE2(t_pixels, 0, t_divisor));
+		t_result = _mm_or_si128(t_result, MCPixelDivideChannelSSE2(t_pixels, 8, t_divisor));
+		t_result = _mm_or_si128(t_result, MCPixelDivideChannelSSE2(t_pixels, 16, t_divisor));
+		_mm_storeu_si128((__m128i *)(r_dst + i), _mm_andnot_si128(t_transparent, t_result));
+	}
+	return i;
+}
+
+static uindex_t MCPixelRowSwizzleSSE2(const uint32_t *p_src, const MCPixelChannelShifts& p_src_shifts, uint32_t *r_dst, const MCPixelChannelShifts& p_dst_shifts, uindex_t p_count)
+{
+	const __m128i t_mask = _mm_set1_epi32(0xFF);
+	__m128i t_src_shifts[4], t_dst_shifts[4];
+	for (uindex_t c = 0; c < 4; c++)
+	{
+		t_src_shifts[c] = _mm_cvtsi32_si128(p_src_shifts.shift[c]);
+		t_dst_shifts[c] = _mm_cvtsi32_si128(p_dst_shifts.shift[c]);
+	}
+
+	uindex_t i = 0;
+	for (; i + 4 <= p_count; i += 4)
+	{
+		__m128i t_pixels = _mm_loadu_si128((const __m128i *)(p_src + i));
+		__m128i t_result = _mm_setzero_si128();
+		for (uindex_t c = 0; c < 4; c++)
+		{
+			__m128i t_channel = _mm_and_si128(_mm_srl_epi32(t_pixels, t_src_shifts[c]), t_mask);
+			t_result = _mm_or_si128(t_result, _mm_sll_epi32(t_channel, t_dst_shifts[c]));
+		}
+		_mm_storeu_si128((__m128i *)(r_dst + i), t_result);
+	}
+	return i;
+}
+
+static uindex_t MCPixelRowCopyWithMasksSSE2(const uint32_t *p_src, uint32_t *r_dst, uindex_t p_count, uint32_t& x_or_mask, uint32_t& x_and_mask)
+{
+	__m128i t_or = _mm_setzero_si128();
+	__m128i t_and = _mm_set1_epi32(-1);
+
+	uindex_t i = 0;
+	for (; i + 4 <= p_count; i += 4)
+	{
+		__m128i t_pixels = _mm_loadu_si128((const __m128i *)(p_src + i));
+		if (r_dst != nil)
+			_mm_storeu_si128((__m128i *)(r_dst + i), t_pixels);
+		t_or = _mm_or_si128(t_or, t_pixels);
+		t_and = _mm_and_si128(t_and, t_pixels);
+	}
+
+	uint32_t t_ors[4], t_ands[4];
+	_mm_storeu_si128((__m128i *)t_ors, t_or);
+	_mm_storeu_si128((__m128i *)t_ands, t_and);
+	x_or_mask |= t_ors[0] | t_ors[1] | t_ors[2] | t_ors[3];
+	x_and_mask &= t_ands[0] & t_ands[1] & t_ands[2] & t_ands[3];
+	return i;
+}
+
+#endif
+
+#if defined(MCPIXEL_AVX2)
+
+MCPIXEL_AVX2_TARGET
+static inline __m256i MCPixelScaleChannelsAVX2(__m256i p_channels, __m256i p_alpha)
+{
+	__m256i t_product = _mm256_add_epi16(_mm256_mullo_epi16(p_channels, p_alpha), _mm256_set1_epi16(0x80));
+	return _mm256_srli_epi16(_mm256_add_epi16(t_product, _mm256_srli_epi16(t_product, 8)), 8);
+}
+
+// As MCPixelRowPremultiplySSE2, eight pixels at a time. The unpack and pack
+// instructions work within each 128-bit half, so the pixel order is kept.
+MCPIXEL_AVX2_TARGET
+static uindex_t MCPixelRowPremultiplyAVX2(const uint32_t *p_src, uint32_t *r_dst, uindex_t p_count)
+{
+	const __m256i t_zero = _mm256_setzero_si256();
+	const __m256i t_alpha_lanes = _mm256_set_epi16(0xFF, 0, 0, 0, 0xFF, 0, 0, 0, 0xFF, 0, 0, 0, 0xFF, 0, 0, 0);
+
+	uindex_t i = 0;
+	for (; i + 8 <= p_count; i += 8)
+	{
+		__m256i t_pixels = _mm256_loadu_si256((const __m256i *)(p_src + i));
+
+		__m256i t_alpha = _mm256_srli_epi32(t_pixels, 24);
+		t_alpha = _mm256_or_si256(t_alpha, _mm256_slli_epi32(t_alpha, 16));
+		__m256i t_alpha_lo = _mm256_or_si256(_mm256_unpacklo_epi32(t_alpha, t_alpha), t_alpha_lanes);
+		__m256i t_alpha_hi = _mm256_or_si256(_mm256_unpackhi_epi32(t_alpha, t_alpha), t_alpha_lanes);
+
+		__m256i t_lo = MCPixelScaleChannelsAVX2(_mm256_unpacklo_epi8(t_pixels, t_zero), t_alpha_lo);
+		__m256i t_hi = MCPixelScaleChannelsAVX2(_mm256_unpackhi_epi8(t_pixels, t_zero), t_alpha_hi);
+		_mm256_storeu_si256((__m256i *)(r_dst + i), _mm256_packus_epi16(t_lo, t_hi));
+	}
+	return i;
+}
+
+MCPIXEL_AVX2_TARGET
+static inline __m256i MCPixelDivideChannelAVX2(__m256i p_pixels, int p_shift, __m256 p_alpha)
+{
+	__m256i t_channel = _mm256_and_si256(_mm256_srli_epi32(p_pixels, p_shift), _mm256_set1_epi32(0xFF));
+	__m256i t_scaled = _mm256_sub_epi32(_mm256_slli_epi32(t_channel, 8), t_channel);
+	__m256i t_quotient = _mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(t_scaled), p_alpha));
+	return _mm256_slli_epi32(_mm256_and_si256(t_quotient, _mm256_set1_epi32(0xFF)), p_shift);
+}
+
+MCPIXEL_AVX2_TARGET
+static uindex_t MCPixelRowUnpremultiplyAVX2(const uint32_t *p_src, uint32_t *r_dst, uindex_t p_count)
+{
+	const __m256i t_zero = _mm256_setzero_si256();
+	const __m256i t_one = _mm256_set1_epi32(1);
+
+	uindex_t i = 0;
+	for (; i + 8 <= p_count; i += 8)
+	{
+		__m256i t_pixels = _mm256_loadu_si256((const __m256i *)(p_src + i));
+		__m256i t_alpha = _mm256_srli_epi32(t_pixels, 24);
+
+		__m256i t_transparent = _mm256_cmpeq_epi32(t_alpha, t_zero);
+		__m256 t_divisor = _mm256_cvtepi32_ps(_mm256_or_si256(t_alpha, _mm256_and_si256(t_transparent, t_one)));
+
+		__m256i t_result = _mm256_slli_epi32(t_alpha, 24);
+		t_result = _mm256_or_si256(t_result, MCPixelDivideChannelAVX2(t_pixels, 0, t_divisor));
+		t_result = _mm256_or_si256(t_result, MCPixelDivideChannelAVX2(t_pixels, 8, t_divisor));
+		t_result = _mm256_or_si256(t_result, MCPixelDivideChannelAVX2(t_pixels, 16, t_divisor));
+		_mm256_storeu_si256((__m256i *)(r_dst + i), _mm256_andnot_si256(t_transparent, t_result));
+	}
+	return i;
+}
+
+MCPIXEL_AVX2_TARGET
+static uindex_t MCPixelRowSwizzleAVX2(const uint32_t *p_src, const MCPixelChannelShifts& p_src_shifts, uint32_t *r_dst, const MCPixelChannelShifts& p_dst_shifts, uindex_t p_count)
+{
+	const __m256i t_mask = _mm256_set1_epi32(0xFF);
+	__m128i t_src_shifts[4], t_dst_shifts[4];
+	for (uindex_t c = 0; c < 4; c++)
+	{
+		t_src_shifts[c] = _mm_cvtsi32_si128(p_src_shifts.shift[c]);
+		t_dst_shifts[c] = _mm_cvtsi32_si128(p_dst_shifts.shift[c]);
+	}
+
+	uindex_t i = 0;
+	for (; i + 8 <= p_count; i += 8)
+	{
+		__m256i t_pixels = _mm256_loadu_si256((const __m256i *)(p_src + i));
+		__m256i t_result = _mm256_setzero_si256();
+		for (uindex_t c = 0; c < 4; c++)
+		{
+			__m256i t_channel = _mm256_and_si256(_mm256_srl_epi32(t_pixels, t_src_shifts[c]), t_mask);
+			t_result = _mm256_or_si256(t_result, _mm256_sll_epi32(t_channel, t_dst_shifts[c]));
+		}
+		_mm256_storeu_si256((__m256i *)(r_dst + i), t_result);
+	}
+	return i;
+}
+
+MCPIXEL_AVX2_TARGET
+static uindex_t MCPixelRowCopyWithMasksAVX2(const uint32_t *p_src, uint32_t *r_dst, uindex_t p_count, uint32_t& x_or_mask, uint32_t& x_and_mask)
+{
+	__m256i t_or = _mm256_setzero_si256();
+	__m256i t_and = _mm256_set1_epi32(-1);
+
+	uindex_t i = 0;
+	for (; i + 8 <= p_count; i += 8)
+	{
+		__m256i t_pixels = _mm256_loadu_si256((const __m256i *)(p_src + i));
+		if (r_dst != nil)
+			_mm256_storeu_si256((__m256i *)(r_dst + i), t_pixels);
+		t_or = _mm256_or_si256(t_or, t_pixels);
+		t_and = _mm256_and_si256(t_and, t_pixels);
+	}
+
+	uint32_t t_ors[8], t_ands[8];
+	_mm256_storeu_si256((__m256i *)t_ors, t_or);
+	_mm256_storeu_si256((__m256i *)t_ands, t_and);
+	for (uindex_t j = 0; j < 8; j++)
+	{
+		x_or_mask |= t_ors[j];
+		x_and_mask &= t_ands[j];
+	}
+	return i;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+void MCPixelRowPremultiply(const uint32_t *p_src, uint32_t *r_dst, uindex_t p_count)
+{
+	uindex_t i = 0;
+#if defined(MCPIXEL_AVX2)
+	if (MCPixelHasAVX2())
+		i = MCPixelRowPremultiplyAVX2(p_src, r_dst, p_count);
+#endif
+#if defined(__SSE2__)
+	i += MCPixelRowPremultiplySSE2(p_src + i, r_dst + i, p_count - i);
+#endif
+	for (; i < p_count; i++)
+		r_dst[i] = MCPixelPremultiply(p_src[i]);
+}
+
+void MCPixelRowUnpremultiply(const uint32_t *p_src, uint32_t *r_dst, uindex_t p_count)
+{
+	uindex_t i = 0;
+#if defined(MCPIXEL_AVX2)
+	if (MCPixelHasAVX2())
+		i = MCPixelRowUnpremultiplyAVX2(p_src, r_dst, p_count);
+#endif
+#if defined(__SSE2__)
+	i += MCPixelRowUnpremultiplySSE2(p_src + i, r_dst + i, p_count - i);
+#endif
+	for (; i < p_count; i++)
+		r_dst[i] = MCPixelUnpremultiply(p_src[i]);
+}
+
+void MCPixelRowSwizzle(const uint32_t *p_src, MCGPixelFormat p_src_format, uint32_t *r_dst, MCGPixelFormat p_dst_format, uindex_t p_count)
+{
+	if (p_src_format == p_dst_format)
+	{
+		if (p_src != r_dst)
+			MCMemoryMove(r_dst, p_src, p_count * sizeof(uint32_t));
+		return;
+	}
+
+	MCPixelChannelShifts t_src_shifts = MCPixelGetChannelShifts(p_src_format);
+	MCPixelChannelShifts t_dst_shifts = MCPixelGetChannelShifts(p_dst_format);
+
+	uindex_t i = 0;
+#if defined(MCPIXEL_AVX2)
+	if (MCPixelHasAVX2())
+		i = MCPixelRowSwizzleAVX2(p_src, t_src_shifts, r_dst, t_dst_shifts, p_count);
+#endif
+#if defined(__SSE2__)
+	i += MCPixelRowSwizzleSSE2(p_src + i, t_src_shifts, r_dst + i, t_dst_shifts, p_count - i);
+#endif
+	for (; i < p_count; i++)
+		r_dst[i] = MCPixelSwizzle(p_src[i], t_src_shifts, t_dst_shifts);
+}
+
+void MCPixelRowCopyWithMasks(const uint32_t *p_src, uint32_t *r_dst, uindex_t p_count, uint32_t& x_or_mask, uint32_t& x_and_mask)
+{
+	uindex_t i = 0;
+#if defined(MCPIXEL_AVX2)
+	if (MCPixelHasAVX2())
+		i = MCPixelRowCopyWithMasksAVX2(p_src, r_dst, p_count, x_or_mask, x_and_mask);
+#endif
+#if defined(__SSE2__)
+	i += MCPixelRowCopyWithMasksSSE2(p_src + i, r_dst != nil ? r_dst + i : nil, p_count - i, x_or_mask, x_and_mask);
+#endif
+	uint32_t t_or_mask = x_or_mask;
+	uint32_t t_and_mask = x_and_mask;
+	for (; i < p_count; i++)
+	{
+		uint32_t t_pixel = p_src[i];
+		if (r_dst != nil)
+			r_dst[i] = t_pixel;
+		t_or_mask |= t_pixel;
+		t_and_mask &= t_pixel;
+	}
+	x_or_mask = t_or_mask;
+	x_and_mask = t_and_mask;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void MCPixelScaleNearest(const void *p_src_ptr, uindex_t p_src_stride, uindex_t p_src_width, uindex_t p_src_height, void *p_dst_ptr, uindex_t p_dst_stride, uindex_t p_dst_width, uindex_t p_dst_height)
+{
+	uint32_t t_ix, t_iy;
+	t_ix = (65536 * p_src_width) / p_dst_width;
+	t_iy = (65536 * p_src_height) / p_dst_height;
+
+	uint32_t t_sy;
+	t_sy = 0;
+
+	const uint8_t *t_src_ptr = (const uint8_t *)p_src_ptr;
+	uint8_t *t_dst_ptr = (uint8_t *)p_dst_ptr;
+	for (uindex_t y = 0; y < p_dst_height; y++)
+	{
+		const uint32_t *t_src_row = (const uint32_t *)(t_src_ptr + (t_sy >> 16) * p_src_stride);
+		uint32_t *t_dst_row = (uint32_t *)t_dst_ptr;
+
+		uint32_t t_sx;
+		t_sx = 0;
+		for (uindex_t x = 0; x < p_dst_width; x++)
+		{
+			t_dst_row[x] = t_src_row[t_sx >> 16];
+			t_sx += t_ix;
+		}
+
+		t_sy += t_iy;
+		t_dst_ptr += p_dst_stride;
+	}
+}
+
+static inline uint32_t MCPixelPackedBilinearBounded(uint32_t x, uint8_t a, uint32_t y, uint8_t b, uint32_t z, uint8_t c, uint32_t w, uint8_t d)
+{
+	uint32_t u, v;
+
+	u = (x & 0xff00ff) * a + (y & 0xff00ff) * b + (z & 0xff00ff) * c + (w & 0xff00ff) * d + 0x800080;
+	u = ((u + ((u >> 8) & 0xff00ff)) >> 8) & 0xff00ff;
+
+	v = ((x >> 8) & 0xff00ff) * a + ((y >> 8) & 0xff00ff) * b + ((z >> 8) & 0xff00ff) * c + ((w >> 8) & 0xff00ff) * d + 0x800080;
+	v = (v + ((v >> 8) & 0xff00ff)) & 0xff00ff00;
+
+	return u | v;
+}
+
+// Split the fractional offsets x and y (out of 255) into weights for the four
+// surrounding pixels, which always sum to 255.
+static inline void MCPixelBilinearWeights(uint8_t x, uint8_t y, uint8_t& r_00, uint8_t& r_10, uint8_t& r_01, uint8_t& r_11)
+{
+	uint32_t u;
+	u = x * y + 0x80;
+	u = (u + (u >> 8)) >> 8;
+
+	r_11 = u;
+	r_01 = y - r_11;
+	r_10 = x - r_11;
+	r_00 = (255 - y) - r_10;
+}
+
+void MCPixelScaleBilinear(const void *p_src_ptr, uindex_t p_src_stride, uindex_t p_src_width, uindex_t p_src_height, void *p_dst_ptr, uindex_t p_dst_stride, uindex_t p_dst_width, uindex_t p_dst_height)
+{
+	// Step through the source in 1/256ths of a pixel, distributing the
+	// remainder of the step with a Bresenham-style error term.
+	uint32_t t_ax = p_src_width * 256;
+	int32_t t_bx = p_dst_width;
+	uint32_t t_sx = t_ax / t_bx;
+	uint32_t t_tx = t_ax % t_bx;
+
+	uint32_t t_ay = p_src_height * 256;
+	int32_t t_by = p_dst_height;
+	uint32_t t_sy = t_ay / t_by;
+	uint32_t t_ty = t_ay % t_by;
+
+	uint32_t t_qy = 0;
+	int32_t t_ry = -t_by;
+
+	const uint8_t *t_src_ptr = (const uint8_t *)p_src_ptr;
+	uint8_t *t_dst_ptr = (uint8_t *)p_dst_ptr;
+	for (uindex_t y = 0; y < p_dst_height; y++)
+	{
+		uint32_t t_iy = t_qy / 256;
+		uint8_t t_fy = t_qy & 0xFF;
+
+		const uint32_t *t_src_row_0 = (const uint32_t *)(t_src_ptr + t_iy * p_src_stride);
+		const uint32_t *t_src_row_1 = t_src_row_0;
+		if (t_iy < p_src_height - 1)
+			t_src_row_1 = (const uint32_t *)(t_src_ptr + (t_iy + 1) * p_src_stride);
+
+		uint32_t *t_dst_row = (uint32_t *)t_dst_ptr;
+
+		uint32_t t_qx = 0;
+		int32_t t_rx = -t_bx;
+		for (uindex_t x = 0; x < p_dst_width; x++)
+		{
+			uint32_t t_ix = t_qx / 256;
+			uint8_t t_fx = t_qx & 0xFF;
+
+			uint32_t t_p00, t_p10, t_p01, t_p11;
+			t_p00 = t_src_row_0[t_ix];
+			t_p01 = t_src_row_1[t_ix];
+			if (t_ix < p_src_width - 1)
+			{
+				t_p10 = t_src_row_0[t_ix + 1];
+				t_p11 = t_src_row_1[t_ix + 1];
+			}
+			else
+			{
+				t_p10 = t_p00;
+				t_p11 = t_p01;
+			}
+
+			uint8_t t_w00, t_w10, t_w01, t_w11;
+			MCPixelBilinearWeights(t_fx, t_fy, t_w00, t_w10, t_w01, t_w11);
+			t_dst_row[x] = MCPixelPackedBilinearBounded(t_p00, t_w00, t_p10, t_w10, t_p01, t_w01, t_p11, t_w11);
+
+			t_qx += t_sx;
+			t_rx += t_tx;
+			if (t_rx >= 0)
+			{
+				t_qx++;
+				t_rx -= t_bx;
+			}
+		}
+
+		t_dst_ptr += p_dst_stride;
+
+		t_qy += t_sy;
+		t_ry += t_ty;
+		if (t_ry >= 0)
+		{
+			t_qy++;
+			t_ry -= t_by;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Error diffusion carries state from each pixel to the next, so this kernel
+// has no vector form. Rows are processed in alternate directions to avoid
+// directional artifacts.
+bool MCPixelDitherAlpha(uint32_t *x_pixels, uindex_t p_stride, uindex_t p_width, uindex_t p_height)
+{
+	uint8_t *t_src_ptr = (uint8_t*)x_pixels;
+
+	int32_t *t_error_buffer;
+	if (!MCMemoryNewArray<int32_t>(p_width * 2, t_error_buffer))
+		return false;
+
+	int32_t *t_current_errors = t_error_buffer;
+	int32_t *t_next_errors = t_error_buffer + p_width;
+
+	for (uint32_t y = 0; y < p_height; y++)
+	{
+		uint32_t *t_src_row = (uint32_t*)t_src_ptr;
+
+		uint32_t width = p_width;
+		uint32_t t_error_index = 0;
+
+		int32_t t_direction = 1;
+
+		if (y & 1)
+		{
+			t_src_row += width - 1;
+			t_direction = -1;
+			t_error_index = (width - 1);
+		}
+
+		while (width--)
+		{
+			int32_t t_alpha = (int32_t)MCGPixelGetNativeAlpha(*t_src_row) + t_current_errors[t_error_index];
+			int32_t t_newalpha = t_alpha < 128 ? 0 : 255;
+
+			int32_t t_error = t_alpha - t_newalpha;
+			*t_src_row = MCGPixelSetNativeAlpha(*t_src_row, t_newalpha);
+
+			if (width > 0)
+				t_current_errors[t_error_index + t_direction] += (7 * t_error + 8) / 16;
+			if (y + 1 < p_height)
+			{
+				if (width + 1 < p_width)
+					t_next_errors[t_error_index - t_direction] += (3 * t_error + 8) / 16;
+				t_next_errors[t_error_index] += (5 * t_error + 8) / 16;
+				if (width > 0)
+					t_next_errors[t_error_index + t_direction] += (1 * t_error + 8) / 16;
+			}
+
+			t_src_row += t_direction;
+			t_error_index += t_direction;
+		}
+		int32_t *t_tmp_ptr;
+		t_tmp_ptr = t_next_errors; t_next_errors = t_current_errors; t_current_errors = t_tmp_ptr;
+		MCMemoryClear(t_next_errors, sizeof(int32_t) * p_width);
+
+		t_src_ptr += p_stride;
+	}
+
+	MCMemoryDeleteArray(t_error_buffer);
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
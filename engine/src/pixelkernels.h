@@ -0,0 +1,67 @@
+/* Copyright (C) 2017 LiveCode Ltd.
+
+This file is part of LiveCode.
+
+LiveCode is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License v3 as published by the Free
+Software Foundation.
+
+LiveCode is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
+
+#ifndef __MC_PIXEL_KERNELS_H__
+#define __MC_PIXEL_KERNELS_H__
+
+#include "graphics.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// The kernels below work on rows or blocks of 32-bit pixels. Except for the
+// swizzle, they expect the alpha channel in the top byte of each pixel, which
+// is the case for the native pixel format on all supported platforms.
+//
+// Where the processor supports it, rows are processed several pixels at a
+// time with SSE2 or AVX2 instructions. The results are exactly the same as
+// processing each pixel on its own.
+
+// Convert a row of pixels with straight alpha to premultiplied alpha. The
+// source and destination may be the same.
+void MCPixelRowPremultiply(const uint32_t *p_src, uint32_t *r_dst, uindex_t p_count);
+
+// Convert a row of pixels with premultiplied alpha to straight alpha. The
+// source and destination may be the same.
+void MCPixelRowUnpremultiply(const uint32_t *p_src, uint32_t *r_dst, uindex_t p_count);
+
+// Convert a row of pixels from one pixel format to another. The source and
+// destination may be the same.
+void MCPixelRowSwizzle(const uint32_t *p_src, MCGPixelFormat p_src_format, uint32_t *r_dst, MCGPixelFormat p_dst_format, uindex_t p_count);
+
+// Copy a row of pixels, accumulating the bitwise or and and of the pixels
+// into x_or_mask and x_and_mask. If r_dst is nil, the masks are computed
+// without copying.
+void MCPixelRowCopyWithMasks(const uint32_t *p_src, uint32_t *r_dst, uindex_t p_count, uint32_t& x_or_mask, uint32_t& x_and_mask);
+
+//////////
+
+// Resample the source pixels to the destination size, taking the nearest
+// source pixel for each destination pixel.
+void MCPixelScaleNearest(const void *p_src_ptr, uindex_t p_src_stride, uindex_t p_src_width, uindex_t p_src_height, void *p_dst_ptr, uindex_t p_dst_stride, uindex_t p_dst_width, uindex_t p_dst_height);
+
+// Resample the source pixels to the destination size, interpolating linearly
+// between the four nearest source pixels.
+void MCPixelScaleBilinear(const void *p_src_ptr, uindex_t p_src_stride, uindex_t p_src_width, uindex_t p_src_height, void *p_dst_ptr, uindex_t p_dst_stride, uindex_t p_dst_width, uindex_t p_dst_height);
+
+//////////
+
+// Reduce the alpha channel of the pixels to fully opaque or fully transparent,
+// using Floyd-Steinberg error diffusion.
+bool MCPixelDitherAlpha(uint32_t *x_pixels, uindex_t p_stride, uindex_t p_width, uindex_t p_height);
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif
@@ -309,6 +309,10 @@ static MCPropertyInfo kMCPropertyInfoTable[] =
 	DEFINE_RW_CUSTOM_PROPERTY(P_SELECTION_HANDLE_COLOR, InterfaceNamedColor, Interface, SelectionHandleColor)
 	DEFINE_RW_PROPERTY(P_WINDOW_BOUNDING_RECT, Rectangle, Interface, WindowBoundingRect)
 	DEFINE_RW_PROPERTY(P_JPEG_QUALITY, UInt16, Interface, JpegQuality)
+	DEFINE_RW_PROPERTY(P_JPEG_PROGRESSIVE, Bool, Interface, JpegProgressive)
+	DEFINE_RW_ENUM_PROPERTY(P_JPEG_CHROMA_SUBSAMPLING, InterfaceJpegChromaSubsampling, Interface, JpegChromaSubsampling)
+	DEFINE_RW_PROPERTY(P_PNG_COMPRESSION_LEVEL, UInt16, Interface, PngCompressionLevel)
+	DEFINE_RW_ENUM_PROPERTY(P_PNG_FILTER, InterfacePngFilter, Interface, PngFilter)
 	DEFINE_RW_PROPERTY(P_RELAYER_GROUPED_CONTROLS, Bool, Interface, RelayerGroupedControls)
 
 	DEFINE_RW_PROPERTY(P_VC_SHARED_MEMORY, Bool, Legacy, VcSharedMemory)
@@ -850,6 +854,10 @@ Parse_stat MCProperty::parse(MCScriptPoint &sp, Boolean the)
 	case P_SELECTION_HANDLE_COLOR:
 	case P_WINDOW_BOUNDING_RECT:
 	case P_JPEG_QUALITY:
+	case P_JPEG_PROGRESSIVE:
+	case P_JPEG_CHROMA_SUBSAMPLING:
+	case P_PNG_COMPRESSION_LEVEL:
+	case P_PNG_FILTER:
 	case P_LZW_KEY:
 	case P_RECORDING:
 	case P_RECORD_FORMAT:
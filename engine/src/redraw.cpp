@@ -267,6 +267,8 @@ MCRectangle MCControl::layer_getcontentrect(void)
 
 void MCControl::layer_redrawall(void)
 {
+	layer_flushcache();
+
 	if (!opened)
 		return;
 
@@ -289,6 +291,8 @@ void MCControl::layer_redrawall(void)
 
 void MCControl::layer_redrawrect(const MCRectangle& p_dirty_rect)
 {
+	layer_flushcache();
+
 	if (!opened)
 		return;
 
@@ -318,6 +322,8 @@ void MCControl::layer_redrawrect(const MCRectangle& p_dirty_rect)
 
 void MCControl::layer_transientchangedandredrawall(int32_t p_old_transient)
 {
+	layer_flushcache();
+
 	if (!opened)
 		return;
 
@@ -340,6 +346,8 @@ void MCControl::layer_transientchangedandredrawall(int32_t p_old_transient)
 
 void MCControl::layer_setrect(const MCRectangle& p_new_rect, bool p_redraw_all)
 {
+	layer_flushcache();
+
 	if (!opened)
 	{
 		setrect(p_new_rect);
@@ -382,6 +390,8 @@ void MCControl::layer_setrect(const MCRectangle& p_new_rect, bool p_redraw_all)
 
 void MCControl::layer_rectchanged(const MCRectangle& p_old_rect, bool p_redraw_all)
 {
+	layer_flushcache();
+
 	if (!opened)
 		return;
 
@@ -425,6 +435,8 @@ void MCControl::layer_rectchanged(const MCRectangle& p_old_rect, bool p_redraw_a
 
 void MCControl::layer_effectiverectchangedandredrawall(const MCRectangle& p_old_effective_rect)
 {
+	layer_flushcache();
+
 	if (!opened)
 		return;
 
@@ -449,6 +461,8 @@ void MCControl::layer_effectschanged(const MCRectangle& p_old_effective_rect)
 //   changed, else focus border might be not included in our calculation.
 void MCControl::layer_visibilitychanged(const MCRectangle& p_old_effective_rect)
 {
+	layer_flushcache();
+
 	if (!opened)
 		return;
 
@@ -491,6 +505,8 @@ void MCControl::layer_contentoriginchanged(int32_t p_dx, int32_t p_dy)
 
 void MCControl::layer_scrolled(void)
 {
+	layer_flushcache();
+
 	if (!opened)
 		return;
 		
@@ -518,6 +534,8 @@ void MCControl::layer_scrolled(void)
 
 void MCControl::layer_dirtycontentrect(const MCRectangle& p_updated_rect, bool p_update_card)
 {
+	layer_flushcache();
+
 	if (MCU_empty_rect(p_updated_rect))
 		return;
 
@@ -751,6 +769,269 @@ void MCControl::layer_changeeffectiverect(const MCRectangle& p_old_effective_rec
 	}
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//
+//  Layer caches
+//
+//  A control with layerCache set keeps a bitmap of itself, rendered at the
+//  current device scale without its ink and blendLevel applied, and is drawn
+//  from that bitmap until something happens which would cause it to be redrawn.
+//  This means that scenery which is expensive to render doesn't have to be
+//  rendered again when other objects move over it.
+//
+//  The caches of all controls are kept in a list, most recently used first, and
+//  the least recently used are discarded when they would take up more than the
+//  compositor cache limit of the stack being drawn - or the limit it would have
+//  if the stack doesn't use the compositor.
+//
+
+struct MCLayerCache
+{
+	MCControl *control;
+	MCGImageRef image;
+	// The effective rect and device scale the image was rendered for.
+	MCRectangle rect;
+	MCGFloat x_scale;
+	MCGFloat y_scale;
+	size_t byte_size;
+	MCLayerCache *previous;
+	MCLayerCache *next;
+};
+
+// The most and least recently used caches.
+static MCLayerCache *s_layer_caches = nil;
+static MCLayerCache *s_layer_caches_last = nil;
+static size_t s_layer_caches_byte_size = 0;
+
+static void MCLayerCacheUnlink(MCLayerCache *p_cache)
+{
+	if (p_cache -> previous != nil)
+		p_cache -> previous -> next = p_cache -> next;
+	else
+		s_layer_caches = p_cache -> next;
+	if (p_cache -> next != nil)
+		p_cache -> next -> previous = p_cache -> previous;
+	else
+		s_layer_caches_last = p_cache -> previous;
+	p_cache -> previous = nil;
+	p_cache -> next = nil;
+}
+
+static void MCLayerCacheLinkFirst(MCLayerCache *p_cache)
+{
+	p_cache -> previous = nil;
+	p_cache -> next = s_layer_caches;
+	if (s_layer_caches != nil)
+		s_layer_caches -> previous = p_cache;
+	else
+		s_layer_caches_last = p_cache;
+	s_layer_caches = p_cache;
+}
+
+void MCRedrawFlushLayerCaches(void)
+{
+	while(s_layer_caches != nil)
+		s_layer_caches -> control -> layer_discardcache();
+}
+
+void MCRedrawTrimLayerCaches(size_t p_limit)
+{
+	while(s_layer_caches_last != nil && s_layer_caches_byte_size > p_limit)
+		s_layer_caches_last -> control -> layer_discardcache();
+}
+
+void MCRedrawFlushLayerCachesWithin(MCObject *p_object)
+{
+	MCLayerCache *t_cache;
+	t_cache = s_layer_caches;
+	while(t_cache != nil)
+	{
+		MCLayerCache *t_next;
+		t_next = t_cache -> next;
+
+		MCObject *t_parent;
+		t_parent = t_cache -> control -> getparent();
+		while(t_parent != nil && t_parent != p_object)
+			t_parent = t_parent -> getparent();
+
+		if (t_parent != nil)
+			t_cache -> control -> layer_discardcache();
+
+		t_cache = t_next;
+	}
+}
+
+void MCControl::layer_discardcache(void)
+{
+	if (m_layer_cache == nil)
+		return;
+
+	MCLayerCacheUnlink(m_layer_cache);
+	s_layer_caches_byte_size -= m_layer_cache -> byte_size;
+
+	MCGImageRelease(m_layer_cache -> image);
+	delete m_layer_cache;
+	m_layer_cache = nil;
+}
+
+void MCControl::layer_flushcache(void)
+{
+	// Any change to a control changes the content of the groups it is in, so
+	// their caches must go too.
+	MCObject *t_object;
+	t_object = this;
+	while(t_object != nil && t_object -> gettype() >= CT_GROUP)
+	{
+		static_cast<MCControl *>(t_object) -> layer_discardcache();
+		t_object = t_object -> getparent();
+	}
+}
+
+bool MCControl::layer_drawcached(MCDC *dc)
+{
+	// Only contexts with a simple scale in device space can be drawn from a
+	// cache.
+	if (dc -> gettype() != CONTEXT_TYPE_SCREEN)
+		return false;
+
+	MCGAffineTransform t_transform;
+	t_transform = dc -> getdevicetransform();
+	if (t_transform . b != 0.0f || t_transform . c != 0.0f ||
+		t_transform . a <= 0.0f || t_transform . d <= 0.0f)
+		return false;
+
+	MCRectangle t_rect;
+	t_rect = geteffectiverect();
+
+	// If the control has been drawn at a different scale since it was cached,
+	// render it again.
+	if (m_layer_cache != nil &&
+		(!MCU_equal_rect(m_layer_cache -> rect, t_rect) ||
+		 m_layer_cache -> x_scale != t_transform . a ||
+		 m_layer_cache -> y_scale != t_transform . d))
+		layer_discardcache();
+
+	if (m_layer_cache == nil)
+	{
+		uint32_t t_width, t_height;
+		t_width = ceilf(t_rect . width * t_transform . a);
+		t_height = ceilf(t_rect . height * t_transform . d);
+		if (t_width == 0 || t_height == 0)
+			return false;
+
+		// The caches share the memory budget of the stack's tilecache.
+		size_t t_limit;
+		if (getstack() -> view_gettilecache() != nil)
+			t_limit = MCTileCacheGetCacheLimit(getstack() -> view_gettilecache());
+		else
+			t_limit = getstack() -> view_getdefaultcompositorcachelimit();
+
+		// Controls which would take up more than half of the cache are drawn
+		// normally.
+		size_t t_byte_size;
+		t_byte_size = size_t(t_width) * t_height * sizeof(uint32_t);
+		if (t_byte_size > t_limit / 2)
+			return false;
+
+		MCRedrawTrimLayerCaches(t_limit - t_byte_size);
+
+		MCGContextRef t_context;
+		if (!MCGContextCreate(t_width, t_height, true, t_context))
+			return false;
+
+		MCGContextScaleCTM(t_context, t_transform . a, t_transform . d);
+		MCGContextTranslateCTM(t_context, -t_rect . x, -t_rect . y);
+
+		MCGraphicsContext *t_gfxcontext;
+		t_gfxcontext = new (nothrow) MCGraphicsContext(t_context);
+		if (t_gfxcontext == nil)
+		{
+			MCGContextRelease(t_context);
+			return false;
+		}
+
+		// Render the control normally, but with the ink and blendLevel that
+		// leave its content as it is - those are applied when the cached
+		// image is drawn.
+		uint1 t_ink, t_blend_level;
+		t_ink = ink;
+		t_blend_level = blendlevel;
+		ink = GXcopy;
+		blendlevel = 100;
+		draw(t_gfxcontext, t_rect, false, false);
+		ink = t_ink;
+		blendlevel = t_blend_level;
+
+		delete t_gfxcontext;
+
+		MCGImageRef t_image;
+		t_image = nil;
+		bool t_success;
+		t_success = MCGContextCopyImage(t_context, t_image);
+		MCGContextRelease(t_context);
+
+		MCLayerCache *t_cache;
+		t_cache = nil;
+		if (t_success)
+		{
+			t_cache = new (nothrow) MCLayerCache;
+			t_success = t_cache != nil;
+		}
+
+		if (!t_success)
+		{
+			if (t_image != nil)
+				MCGImageRelease(t_image);
+			return false;
+		}
+
+		t_cache -> control = this;
+		t_cache -> image = t_image;
+		t_cache -> rect = t_rect;
+		t_cache -> x_scale = t_transform . a;
+		t_cache -> y_scale = t_transform . d;
+		t_cache -> byte_size = t_byte_size;
+		MCLayerCacheLinkFirst(t_cache);
+		s_layer_caches_byte_size += t_byte_size;
+
+		m_layer_cache = t_cache;
+	}
+	else
+	{
+		MCLayerCacheUnlink(m_layer_cache);
+		MCLayerCacheLinkFirst(m_layer_cache);
+	}
+
+	// If the control is on the device pixel grid the cached image maps exactly
+	// onto it; otherwise it must be filtered.
+	MCGPoint t_origin;
+	t_origin = MCGPointApplyAffineTransform(MCGPointMake(t_rect . x, t_rect . y), t_transform);
+
+	MCGImageFilter t_filter;
+	if (t_origin . x == floorf(t_origin . x) && t_origin . y == floorf(t_origin . y))
+		t_filter = kMCGImageFilterNone;
+	else
+		t_filter = kMCGImageFilterLow;
+
+	MCGRectangle t_dst;
+	t_dst = MCGRectangleMake(t_rect . x, t_rect . y,
+							 MCGImageGetWidth(m_layer_cache -> image) / t_transform . a,
+							 MCGImageGetHeight(m_layer_cache -> image) / t_transform . d);
+
+	dc -> setopacity(getopacity());
+	dc -> setfunction(getink());
+
+	MCGContextRef t_gcontext;
+	if (!dc -> lockgcontext(t_gcontext))
+		return false;
+
+	MCGContextDrawImage(t_gcontext, m_layer_cache -> image, t_dst, t_filter);
+
+	dc -> unlockgcontext(t_gcontext);
+
+	return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 void MCCard::layer_added(MCControl *p_control, MCControl *p_previous, MCControl *p_next)
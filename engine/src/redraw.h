@@ -38,4 +38,15 @@ void MCRedrawEnableScreenUpdates(void);
 
 void MCRedrawDoUpdateScreen(void);
 
+// Discard the cached renderings of all controls with layerCache set.
+void MCRedrawFlushLayerCaches(void);
+
+// Discard the least recently used cached renderings of controls until they
+// take up no more than the given number of bytes.
+void MCRedrawTrimLayerCaches(size_t p_limit);
+
+// Discard the cached renderings of the controls within the given object, as
+// they may inherit a property of it which has changed.
+void MCRedrawFlushLayerCachesWithin(MCObject *p_object);
+
 #endif
@@ -17,6 +17,7 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #include "prefix.h"
 
 #include "sha1.h"
+#include "shacommon.h"
 
 #define rol(value, bits) (((value) << (bits)) | ((value) >> (32 - (bits))))
 
@@ -86,6 +87,66 @@ static void sha1_transform(uint32_t state[5], const uint8_t buffer[64])
     state[4] += e;
 }
 
+#if defined(SHA_SHANI)
+/* One group of four rounds using the x86 SHA extensions: expand the
+ * message schedule from the fifth group on, fold the message words into
+ * E, then run the rounds for function F. */
+#define SHANI_ROUNDS(g, F) \
+    if (g >= 4) \
+        w[g&3] = _mm_sha1msg2_epu32(_mm_xor_si128(_mm_sha1msg1_epu32(w[g&3], w[(g+1)&3]), w[(g+2)&3]), w[(g+3)&3]); \
+    if (g == 0) \
+        e[0] = _mm_add_epi32(e[0], w[0]); \
+    else \
+        e[g&1] = _mm_sha1nexte_epu32(e[g&1], w[g&3]); \
+    e[(g+1)&1] = abcd; \
+    abcd = _mm_sha1rnds4_epu32(abcd, e[g&1], F);
+
+SHA_SHANI_TARGET
+static void sha1_transform_shani(uint32_t state[5], const uint8_t *buffer, size_t blocks)
+{
+    const __m128i byte_swap = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+    __m128i abcd, abcd_save, e[2], e_save, w[4];
+
+    abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)state), 0x1B);
+    e[0] = _mm_set_epi32(state[4], 0, 0, 0);
+
+    for (; blocks != 0; blocks--, buffer += 64)
+    {
+        abcd_save = abcd;
+        e_save = e[0];
+
+        for (int i = 0; i < 4; i++)
+            w[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(buffer + i * 16)), byte_swap);
+
+        SHANI_ROUNDS( 0, 0) SHANI_ROUNDS( 1, 0) SHANI_ROUNDS( 2, 0) SHANI_ROUNDS( 3, 0) SHANI_ROUNDS( 4, 0)
+        SHANI_ROUNDS( 5, 1) SHANI_ROUNDS( 6, 1) SHANI_ROUNDS( 7, 1) SHANI_ROUNDS( 8, 1) SHANI_ROUNDS( 9, 1)
+        SHANI_ROUNDS(10, 2) SHANI_ROUNDS(11, 2) SHANI_ROUNDS(12, 2) SHANI_ROUNDS(13, 2) SHANI_ROUNDS(14, 2)
+        SHANI_ROUNDS(15, 3) SHANI_ROUNDS(16, 3) SHANI_ROUNDS(17, 3) SHANI_ROUNDS(18, 3) SHANI_ROUNDS(19, 3)
+
+        e[0] = _mm_sha1nexte_epu32(e[0], e_save);
+        abcd = _mm_add_epi32(abcd, abcd_save);
+    }
+
+    _mm_storeu_si128((__m128i *)state, _mm_shuffle_epi32(abcd, 0x1B));
+    state[4] = (uint32_t)_mm_extract_epi32(e[0], 3);
+}
+#endif
+
+/* Process a run of 64-byte blocks, using the SHA extensions if the
+ * processor has them. */
+static void sha1_transform_blocks(uint32_t state[5], const uint8_t *buffer, size_t blocks)
+{
+#if defined(SHA_SHANI)
+    if (sha_cpu_has_shani())
+    {
+        sha1_transform_shani(state, buffer, blocks);
+        return;
+    }
+#endif
+    for (; blocks != 0; blocks--, buffer += 64)
+        sha1_transform(state, buffer);
+}
+
 void sha1_init(sha1_state_t* context)
 {
     /* SHA1 initialization constants */
@@ -107,9 +168,9 @@ void sha1_append(sha1_state_t *context, const void *data, uint32_t len)
 	if ((j + len) > 63)
 	{
 		memcpy(&context->buffer[j], data, (i = 64-j));
-		sha1_transform(context->state, context->buffer);
-		for(; i + 63 < len; i += 64)
-			sha1_transform(context->state, (const uint8_t *)data + i);
+		sha1_transform_blocks(context->state, context->buffer, 1);
+		sha1_transform_blocks(context->state, (const uint8_t *)data + i, (len - i) / 64);
+		i += (len - i) & ~63;
 		j = 0;
 	}
 	else
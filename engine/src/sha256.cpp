@@ -20,6 +20,10 @@
 #include <string.h>
 #include "sha256.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 /* SHA-224 and SHA-256 constants for 64 rounds. These words represent
  * the first 32 bits of the fractional parts of the cube
  * roots of the first 64 prime numbers. */
@@ -161,6 +165,77 @@ static void rhash_sha256_process_block(unsigned hash[8], unsigned block[16])
 	hash[4] += E, hash[5] += F, hash[6] += G, hash[7] += H;
 }
 
+#if defined(SHA_SHANI)
+/**
+ * Process a run of 512-bit blocks using the x86 SHA extensions.
+ *
+ * @param hash algorithm state
+ * @param msg the message blocks to process, which need not be aligned
+ * @param blocks the number of blocks to process
+ */
+/* Four rounds using the x86 SHA extensions, expanding the message
+ * schedule W[t] = sigma1(W[t-2]) + W[t-7] + sigma0(W[t-15]) + W[t-16]
+ * from the fifth group on. */
+#define SHANI_ROUNDS(i) { \
+	__m128i wk; \
+	if (i < 4) \
+		w[i & 3] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(msg + i * 16)), byte_swap); \
+	else \
+		w[i & 3] = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]), \
+			_mm_alignr_epi8(w[(i + 3) & 3], w[(i + 2) & 3], 4)), w[(i + 3) & 3]); \
+	wk = _mm_add_epi32(w[i & 3], _mm_loadu_si128((const __m128i*)&rhash_k256[i * 4])); \
+	state1 = _mm_sha256rnds2_epu32(state1, state0, wk); \
+	state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(wk, 0x0E)); }
+
+SHA_SHANI_TARGET
+static void rhash_sha256_process_blocks_shani(unsigned hash[8], const unsigned char *msg, size_t blocks)
+{
+	const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+	__m128i state0, state1, abef_save, cdgh_save, tmp, w[4];
+
+	/* The SHA-256 instructions keep the state as ABEF and CDGH */
+	tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&hash[0]), 0xB1);
+	state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&hash[4]), 0x1B);
+	state0 = _mm_alignr_epi8(tmp, state1, 8);
+	state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+	for (; blocks != 0; blocks--, msg += sha256_block_size) {
+		abef_save = state0;
+		cdgh_save = state1;
+
+		SHANI_ROUNDS(0);  SHANI_ROUNDS(1);  SHANI_ROUNDS(2);  SHANI_ROUNDS(3);
+		SHANI_ROUNDS(4);  SHANI_ROUNDS(5);  SHANI_ROUNDS(6);  SHANI_ROUNDS(7);
+		SHANI_ROUNDS(8);  SHANI_ROUNDS(9);  SHANI_ROUNDS(10); SHANI_ROUNDS(11);
+		SHANI_ROUNDS(12); SHANI_ROUNDS(13); SHANI_ROUNDS(14); SHANI_ROUNDS(15);
+
+		state0 = _mm_add_epi32(state0, abef_save);
+		state1 = _mm_add_epi32(state1, cdgh_save);
+	}
+
+	tmp = _mm_shuffle_epi32(state0, 0x1B);
+	state1 = _mm_shuffle_epi32(state1, 0xB1);
+	_mm_storeu_si128((__m128i*)&hash[0], _mm_blend_epi16(tmp, state1, 0xF0));
+	_mm_storeu_si128((__m128i*)&hash[4], _mm_alignr_epi8(state1, tmp, 8));
+}
+#endif
+
+/**
+ * Process the block buffered in the context, using the SHA extensions
+ * if the processor has them.
+ *
+ * @param ctx the algorithm context containing current hashing state
+ */
+static void rhash_sha256_process_message(sha256_ctx *ctx)
+{
+#if defined(SHA_SHANI)
+	if (sha_cpu_has_shani()) {
+		rhash_sha256_process_blocks_shani(ctx->hash, (const unsigned char*)ctx->message, 1);
+		return;
+	}
+#endif
+	rhash_sha256_process_block(ctx->hash, ctx->message);
+}
+
 /**
  * Calculate message hash.
  * Can be called repeatedly with chunks of the message to be hashed.
@@ -181,10 +256,18 @@ void rhash_sha256_update(sha256_ctx *ctx, const unsigned char *msg, size_t size)
 		if (size < left) return;
 
 		/* process partial block */
-		rhash_sha256_process_block(ctx->hash, (unsigned*)ctx->message);
+		rhash_sha256_process_message(ctx);
 		msg  += left;
 		size -= left;
 	}
+#if defined(SHA_SHANI)
+	if (size >= sha256_block_size && sha_cpu_has_shani()) {
+		size_t blocks = size / sha256_block_size;
+		rhash_sha256_process_blocks_shani(ctx->hash, msg, blocks);
+		msg  += blocks * sha256_block_size;
+		size -= blocks * sha256_block_size;
+	}
+#endif
 	while (size >= sha256_block_size) {
 		unsigned* aligned_message_block;
 		if (IS_ALIGNED_32(msg)) {
@@ -228,7 +311,7 @@ void rhash_sha256_final(sha256_ctx *ctx, unsigned char* result)
 		while (index < 16) {
 			ctx->message[index++] = 0;
 		}
-		rhash_sha256_process_block(ctx->hash, ctx->message);
+		rhash_sha256_process_message(ctx);
 		index = 0;
 	}
 	while (index < 14) {
@@ -236,7 +319,209 @@ void rhash_sha256_final(sha256_ctx *ctx, unsigned char* result)
 	}
 	ctx->message[14] = be2me_32( (unsigned)(ctx->length >> 29) );
 	ctx->message[15] = be2me_32( (unsigned)(ctx->length << 3) );
-	rhash_sha256_process_block(ctx->hash, ctx->message);
+	rhash_sha256_process_message(ctx);
 
 	if (result) be32_copy(result, 0, ctx->hash, ctx->digest_length);
 }
+
+#if defined(__SSE2__)
+/* The multi-buffer kernel hashes four independent messages at once, one
+ * in each 32-bit lane of the SSE2 registers, so that hashing many short
+ * messages is not limited by the latency of a single message's rounds. */
+#define SHA256_MB_LANES 4
+
+#define MB_ROTR(x, n) _mm_or_si128(_mm_srli_epi32((x), (n)), _mm_slli_epi32((x), 32 - (n)))
+#define MB_Ch(x,y,z)  _mm_xor_si128(_mm_and_si128((x), (y)), _mm_andnot_si128((x), (z)))
+#define MB_Maj(x,y,z) _mm_or_si128(_mm_and_si128((x), (y)), _mm_and_si128((z), _mm_or_si128((x), (y))))
+#define MB_Sigma0(x) _mm_xor_si128(_mm_xor_si128(MB_ROTR((x), 2), MB_ROTR((x), 13)), MB_ROTR((x), 22))
+#define MB_Sigma1(x) _mm_xor_si128(_mm_xor_si128(MB_ROTR((x), 6), MB_ROTR((x), 11)), MB_ROTR((x), 25))
+#define MB_sigma0(x) _mm_xor_si128(_mm_xor_si128(MB_ROTR((x), 7), MB_ROTR((x), 18)), _mm_srli_epi32((x), 3))
+#define MB_sigma1(x) _mm_xor_si128(_mm_xor_si128(MB_ROTR((x), 17), MB_ROTR((x), 19)), _mm_srli_epi32((x), 10))
+
+/* The progress of the message being hashed in one lane */
+typedef struct sha256_mb_lane
+{
+	const unsigned char *msg; /* the full blocks of the message left to process */
+	size_t blocks;            /* the number of full blocks left */
+	unsigned char tail[2 * sha256_block_size]; /* the padded final block(s) */
+	size_t tail_blocks;       /* the number of tail blocks left */
+	size_t tail_index;        /* the next tail block to process */
+	size_t index;             /* the index of the message in the batch */
+	int active;               /* non-zero if the lane holds a message */
+} sha256_mb_lane;
+
+/**
+ * Start hashing a message in a lane of the multi-buffer kernel.
+ */
+static void rhash_sha256_mb_start(sha256_mb_lane *lane, unsigned state[8][SHA256_MB_LANES], int l,
+	const sha256_ctx *initial, size_t index, const unsigned char *msg, size_t size)
+{
+	size_t rem = size % sha256_block_size;
+	uint64_t bits = (uint64_t)size << 3;
+	int i;
+
+	lane->msg = msg;
+	lane->blocks = size / sha256_block_size;
+	lane->tail_blocks = (rem + 9 <= sha256_block_size) ? 1 : 2;
+	lane->tail_index = 0;
+	lane->index = index;
+	lane->active = 1;
+
+	memset(lane->tail, 0, sizeof(lane->tail));
+	if (rem != 0)
+		memcpy(lane->tail, msg + size - rem, rem);
+	lane->tail[rem] = 0x80;
+	for (i = 0; i < 8; i++)
+		lane->tail[lane->tail_blocks * sha256_block_size - 1 - i] = (unsigned char)(bits >> (i * 8));
+
+	for (i = 0; i < 8; i++)
+		state[i][l] = initial->hash[i];
+}
+
+/**
+ * Calculate the hashes of a batch of messages four at a time.
+ */
+static void rhash_sha256_multi_sse2(const sha256_ctx *initial, size_t count,
+	const unsigned char * const *msgs, const size_t *sizes, unsigned char *results)
+{
+	static const unsigned char zero_block[sha256_block_size] = { 0 };
+	unsigned state[8][SHA256_MB_LANES];
+	sha256_mb_lane lanes[SHA256_MB_LANES];
+	size_t next = 0;
+	int active = 0;
+	int l, t;
+
+	memset(state, 0, sizeof(state));
+	for (l = 0; l < SHA256_MB_LANES; l++) {
+		lanes[l].active = 0;
+		if (next < count) {
+			rhash_sha256_mb_start(&lanes[l], state, l, initial, next, msgs[next], sizes[next]);
+			next++;
+			active++;
+		}
+	}
+
+	while (active > 0) {
+		const unsigned char *blocks[SHA256_MB_LANES];
+		__m128i W[16], A, B, C, D, E, F, G, H;
+
+		for (l = 0; l < SHA256_MB_LANES; l++) {
+			if (!lanes[l].active)
+				blocks[l] = zero_block;
+			else if (lanes[l].blocks != 0)
+				blocks[l] = lanes[l].msg;
+			else
+				blocks[l] = lanes[l].tail + lanes[l].tail_index * sha256_block_size;
+		}
+
+		for (t = 0; t < 16; t++) {
+			unsigned w[SHA256_MB_LANES];
+			for (l = 0; l < SHA256_MB_LANES; l++) {
+				memcpy(&w[l], blocks[l] + t * 4, 4);
+				w[l] = be2me_32(w[l]);
+			}
+			W[t] = _mm_loadu_si128((const __m128i*)w);
+		}
+
+		A = _mm_loadu_si128((const __m128i*)state[0]);
+		B = _mm_loadu_si128((const __m128i*)state[1]);
+		C = _mm_loadu_si128((const __m128i*)state[2]);
+		D = _mm_loadu_si128((const __m128i*)state[3]);
+		E = _mm_loadu_si128((const __m128i*)state[4]);
+		F = _mm_loadu_si128((const __m128i*)state[5]);
+		G = _mm_loadu_si128((const __m128i*)state[6]);
+		H = _mm_loadu_si128((const __m128i*)state[7]);
+
+		for (t = 0; t < 64; t++) {
+			__m128i T1, T2;
+			if (t >= 16) {
+				W[t & 15] = _mm_add_epi32(_mm_add_epi32(W[t & 15], MB_sigma0(W[(t - 15) & 15])),
+					_mm_add_epi32(W[(t - 7) & 15], MB_sigma1(W[(t - 2) & 15])));
+			}
+			T1 = _mm_add_epi32(_mm_add_epi32(H, MB_Sigma1(E)),
+				_mm_add_epi32(MB_Ch(E, F, G), _mm_add_epi32(_mm_set1_epi32((int)rhash_k256[t]), W[t & 15])));
+			T2 = _mm_add_epi32(MB_Sigma0(A), MB_Maj(A, B, C));
+			H = G; G = F; F = E;
+			E = _mm_add_epi32(D, T1);
+			D = C; C = B; B = A;
+			A = _mm_add_epi32(T1, T2);
+		}
+
+		_mm_storeu_si128((__m128i*)state[0], _mm_add_epi32(A, _mm_loadu_si128((const __m128i*)state[0])));
+		_mm_storeu_si128((__m128i*)state[1], _mm_add_epi32(B, _mm_loadu_si128((const __m128i*)state[1])));
+		_mm_storeu_si128((__m128i*)state[2], _mm_add_epi32(C, _mm_loadu_si128((const __m128i*)state[2])));
+		_mm_storeu_si128((__m128i*)state[3], _mm_add_epi32(D, _mm_loadu_si128((const __m128i*)state[3])));
+		_mm_storeu_si128((__m128i*)state[4], _mm_add_epi32(E, _mm_loadu_si128((const __m128i*)state[4])));
+		_mm_storeu_si128((__m128i*)state[5], _mm_add_epi32(F, _mm_loadu_si128((const __m128i*)state[5])));
+		_mm_storeu_si128((__m128i*)state[6], _mm_add_epi32(G, _mm_loadu_si128((const __m128i*)state[6])));
+		_mm_storeu_si128((__m128i*)state[7], _mm_add_epi32(H, _mm_loadu_si128((const __m128i*)state[7])));
+
+		for (l = 0; l < SHA256_MB_LANES; l++) {
+			sha256_mb_lane *lane = &lanes[l];
+			unsigned hash[8];
+			int i;
+
+			if (!lane->active)
+				continue;
+
+			if (lane->blocks != 0) {
+				lane->msg += sha256_block_size;
+				lane->blocks--;
+				continue;
+			}
+
+			if (++lane->tail_index < lane->tail_blocks)
+				continue;
+
+			/* The message is complete, so output its hash and start the
+			 * next one in this lane */
+			for (i = 0; i < 8; i++)
+				hash[i] = state[i][l];
+			be32_copy(results + lane->index * initial->digest_length, 0, hash, initial->digest_length);
+
+			lane->active = 0;
+			active--;
+			if (next < count) {
+				rhash_sha256_mb_start(lane, state, l, initial, next, msgs[next], sizes[next]);
+				next++;
+				active++;
+			}
+		}
+	}
+}
+#endif
+
+/**
+ * Calculate the hashes of a batch of messages, each starting from the
+ * state of the given (freshly initialized) context.
+ *
+ * @param initial the initialized context giving the variant of the hash
+ * @param count the number of messages
+ * @param msgs the messages
+ * @param sizes the lengths of the messages
+ * @param results count calculated hashes, each initial->digest_length bytes
+ */
+void rhash_sha256_multi(const sha256_ctx *initial, size_t count,
+	const unsigned char * const *msgs, const size_t *sizes, unsigned char *results)
+{
+	size_t i;
+
+#if defined(__SSE2__)
+	/* The SHA extensions beat the multi-buffer kernel when available */
+	int use_multi_buffer = count > 1;
+#if defined(SHA_SHANI)
+	if (sha_cpu_has_shani())
+		use_multi_buffer = 0;
+#endif
+	if (use_multi_buffer) {
+		rhash_sha256_multi_sse2(initial, count, msgs, sizes, results);
+		return;
+	}
+#endif
+
+	for (i = 0; i < count; i++) {
+		sha256_ctx ctx = *initial;
+		rhash_sha256_update(&ctx, msgs[i], sizes[i]);
+		rhash_sha256_final(&ctx, results + i * initial->digest_length);
+	}
+}
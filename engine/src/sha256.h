@@ -23,6 +23,8 @@ void rhash_sha224_init(sha256_ctx *ctx);
 void rhash_sha256_init(sha256_ctx *ctx);
 void rhash_sha256_update(sha256_ctx *ctx, const unsigned char* data, size_t length);
 void rhash_sha256_final(sha256_ctx *ctx, unsigned char result[32]);
+void rhash_sha256_multi(const sha256_ctx *initial, size_t count,
+	const unsigned char * const *msgs, const size_t *sizes, unsigned char *results);
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -74,3 +74,27 @@ IS_ALIGNED(const void *p) { return (uintptr_t(p) % sizeof(T)) == 0; }
 #define ROTR32(dword, n) ((dword) >> (n) ^ ((dword) << (32 - (n))))
 #define ROTL64(qword, n) ((qword) << (n) ^ ((qword) >> (64 - (n))))
 #define ROTR64(qword, n) ((qword) >> (n) ^ ((qword) << (64 - (n))))
+
+/* The SHA extensions kernels are compiled for x86 whatever the baseline
+ * instruction set, and used if the processor supports them. */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#include <immintrin.h>
+#define SHA_SHANI
+#define SHA_SHANI_TARGET __attribute__((target("sha,ssse3,sse4.1")))
+
+static inline bool
+sha_cpu_has_shani(void)
+{
+	static const bool s_has_shani = [] {
+		unsigned int a, b, c, d;
+		if (!__get_cpuid(1, &a, &b, &c, &d) ||
+		    (c & bit_SSSE3) == 0 || (c & bit_SSE4_1) == 0)
+			return false;
+		if (!__get_cpuid_count(7, 0, &a, &b, &c, &d))
+			return false;
+		return (b & bit_SHA) != 0;
+	}();
+	return s_has_shani;
+}
+#endif
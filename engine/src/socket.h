@@ -19,6 +19,7 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 #include "dllst.h"
 #include "object.h"
+#include "httprequest.h"
 
 #if defined(_WINDOWS_DESKTOP) || defined(_WINDOWS_SERVER)
 #include <winsock2.h>
@@ -144,6 +145,15 @@ public:
 	MCNameRef endhostname;
     MCNewAutoNameRef from;
     
+	// Sockets accepted with 'accept http connections' parse incoming requests
+	// natively - message is sent for each request, and httpserver is the name
+	// of the listening socket.
+	Boolean http;
+	Boolean httpcontinue;
+	MCNameRef httpserver;
+	// The progress made parsing the request at the start of rbuffer.
+	MCHttpRequestParser httpparser;
+    
 	MCSocket(MCNameRef n, MCNameRef f, MCObject *o, MCNameRef m, Boolean d, MCSocketHandle sock, Boolean a, Boolean s, Boolean issecure);
 
 	void setselect();
@@ -172,6 +182,8 @@ public:
 	void readsome();
 	void writesome();
 	void processreadqueue();
+	void processhttprequests();
+	void queuehttpresponse(const char *p_response);
 
 	//ssl methods
 	//ssl specific
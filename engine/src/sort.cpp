@@ -0,0 +1,721 @@
+/* Copyright (C) 2003-2015 LiveCode Ltd.
+
+This file is part of LiveCode.
+
+LiveCode is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License v3 as published by the Free
+Software Foundation.
+
+LiveCode is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
+
+#include "prefix.h"
+
+#include "sort.h"
+
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <process.h>
+#elif !defined(__EMSCRIPTEN__)
+#include <pthread.h>
+#include <unistd.h>
+#define MC_SORT_USE_PTHREADS
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Inputs smaller than this are sorted on the calling thread.
+#define kMCSortParallelThreshold 65536
+
+// The maximum number of threads to sort with.
+#define kMCSortMaxThreads 8
+
+// Ranges smaller than this are sorted by comparison rather than by radix.
+#define kMCSortRadixThreshold 32
+
+// Ranges which still need sorting after the first this many bytes have been
+// radix sorted are sorted by comparison, which bounds the recursion depth.
+#define kMCSortMaxRadixDepth 64
+
+// The size of each block of key storage.
+#define kMCSortBlockSize (64 * 1024)
+
+struct MCSortNumberEntry
+{
+    uint64_t key;
+    uindex_t index;
+};
+
+struct MCSortSpanEntry
+{
+    const byte_t *bytes;
+    uindex_t length;
+    uindex_t index;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Map a double to an unsigned integer with the same ordering, so that numbers
+// can be radix sorted.
+static inline uint64_t MCSortKeyFromNumber(double p_number)
+{
+    // Make sure -0 and 0 are equal.
+    if (p_number == 0)
+        p_number = 0;
+
+    uint64_t t_bits;
+    memcpy(&t_bits, &p_number, sizeof(t_bits));
+    if ((t_bits & 0x8000000000000000ULL) != 0)
+        return ~t_bits;
+    return t_bits | 0x8000000000000000ULL;
+}
+
+// Sort by an LSD radix sort of 8 bits at a time - each pass is stable, so the
+// whole sort is too. Passes in which all the keys have the same byte are
+// skipped. The sorted entries end up in x_entries.
+static void MCSortNumberEntries(MCSortNumberEntry *x_entries, MCSortNumberEntry *p_temp, uindex_t p_count)
+{
+    if (p_count < 2)
+        return;
+
+    uindex_t t_counts[8][256];
+    memset(t_counts, 0, sizeof(t_counts));
+    for(uindex_t i = 0; i < p_count; i++)
+    {
+        uint64_t t_key;
+        t_key = x_entries[i] . key;
+        for(uindex_t t_pass = 0; t_pass < 8; t_pass++)
+            t_counts[t_pass][(t_key >> (t_pass * 8)) & 0xff] += 1;
+    }
+
+    MCSortNumberEntry *t_from, *t_to;
+    t_from = x_entries;
+    t_to = p_temp;
+    for(uindex_t t_pass = 0; t_pass < 8; t_pass++)
+    {
+        uindex_t *t_pass_counts;
+        t_pass_counts = t_counts[t_pass];
+        if (t_pass_counts[(t_from[0] . key >> (t_pass * 8)) & 0xff] == p_count)
+            continue;
+
+        uindex_t t_offsets[256];
+        uindex_t t_offset;
+        t_offset = 0;
+        for(uindex_t i = 0; i < 256; i++)
+        {
+            t_offsets[i] = t_offset;
+            t_offset += t_pass_counts[i];
+        }
+
+        for(uindex_t i = 0; i < p_count; i++)
+            t_to[t_offsets[(t_from[i] . key >> (t_pass * 8)) & 0xff]++] = t_from[i];
+
+        std::swap(t_from, t_to);
+    }
+
+    if (t_from != x_entries)
+        memcpy(x_entries, t_from, p_count * sizeof(MCSortNumberEntry));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Compare two spans from the given byte offset, which is no greater than the
+// length of either.
+static inline compare_t MCSortCompareSpans(const MCSortSpanEntry& p_left, const MCSortSpanEntry& p_right, uindex_t p_depth)
+{
+    uindex_t t_length;
+    t_length = MCMin(p_left . length, p_right . length) - p_depth;
+    if (t_length != 0)
+    {
+        int t_result;
+        t_result = memcmp(p_left . bytes + p_depth, p_right . bytes + p_depth, t_length);
+        if (t_result != 0)
+            return t_result;
+    }
+
+    return MCCompare(p_left . length, p_right . length);
+}
+
+static void MCSortSpanEntriesByComparison(MCSortSpanEntry *x_entries, uindex_t p_count, uindex_t p_depth, bool p_descending)
+{
+    if (p_descending)
+        std::stable_sort(x_entries, x_entries + p_count, [p_depth](const MCSortSpanEntry& p_left, const MCSortSpanEntry& p_right) {
+            return MCSortCompareSpans(p_left, p_right, p_depth) > 0;
+        });
+    else
+        std::stable_sort(x_entries, x_entries + p_count, [p_depth](const MCSortSpanEntry& p_left, const MCSortSpanEntry& p_right) {
+            return MCSortCompareSpans(p_left, p_right, p_depth) < 0;
+        });
+}
+
+// Sort by a stable MSD radix sort, one byte at a time. Spans which end at the
+// current byte form their own bucket, which sorts before (or, descending,
+// after) all the others and needs no further sorting.
+static void MCSortSpanEntries(MCSortSpanEntry *x_entries, MCSortSpanEntry *p_temp, uindex_t p_count, uindex_t p_depth, bool p_descending)
+{
+    while (p_count > 1)
+    {
+        if (p_count < kMCSortRadixThreshold || p_depth >= kMCSortMaxRadixDepth)
+        {
+            MCSortSpanEntriesByComparison(x_entries, p_count, p_depth, p_descending);
+            return;
+        }
+
+        // Bucket 0 holds the spans which end here, bucket b + 1 those with
+        // byte b at this depth.
+        uindex_t t_counts[257];
+        memset(t_counts, 0, sizeof(t_counts));
+        for(uindex_t i = 0; i < p_count; i++)
+        {
+            if (x_entries[i] . length == p_depth)
+                t_counts[0] += 1;
+            else
+                t_counts[x_entries[i] . bytes[p_depth] + 1] += 1;
+        }
+
+        // If all the spans are in the same bucket there is nothing to
+        // distribute - either they are all equal, or the next byte decides.
+        uindex_t t_first_bucket;
+        t_first_bucket = x_entries[0] . length == p_depth ? 0 : x_entries[0] . bytes[p_depth] + 1;
+        if (t_counts[t_first_bucket] == p_count)
+        {
+            if (t_first_bucket == 0)
+                return;
+            p_depth += 1;
+            continue;
+        }
+
+        uindex_t t_offsets[257];
+        uindex_t t_offset;
+        t_offset = 0;
+        for(uindex_t i = 0; i < 257; i++)
+        {
+            uindex_t t_bucket;
+            t_bucket = p_descending ? (i == 256 ? 0 : 256 - i) : i;
+            t_offsets[t_bucket] = t_offset;
+            t_offset += t_counts[t_bucket];
+        }
+
+        for(uindex_t i = 0; i < p_count; i++)
+        {
+            uindex_t t_bucket;
+            t_bucket = x_entries[i] . length == p_depth ? 0 : x_entries[i] . bytes[p_depth] + 1;
+            p_temp[t_offsets[t_bucket]++] = x_entries[i];
+        }
+        memcpy(x_entries, p_temp, p_count * sizeof(MCSortSpanEntry));
+
+        // The offsets now mark the end of each bucket.
+        for(uindex_t t_bucket = 1; t_bucket < 257; t_bucket++)
+            if (t_counts[t_bucket] > 1)
+            {
+                uindex_t t_start;
+                t_start = t_offsets[t_bucket] - t_counts[t_bucket];
+                MCSortSpanEntries(x_entries + t_start, p_temp + t_start, t_counts[t_bucket], p_depth + 1, p_descending);
+            }
+
+        return;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Runs a number of tasks, each on its own thread if possible. Any task whose
+// thread cannot be started is run on the calling thread.
+struct MCSortTask
+{
+    void (*function)(MCSortTask *);
+
+    // Sort the entries in [start, start + count).
+    void *entries;
+    void *temp;
+    uindex_t start;
+    uindex_t count;
+    bool descending;
+
+    // Merge [start, middle) with [middle, start + count).
+    uindex_t middle;
+
+#if defined(_WIN32)
+    HANDLE thread;
+#elif defined(MC_SORT_USE_PTHREADS)
+    pthread_t thread;
+#endif
+    bool threaded;
+};
+
+#if defined(_WIN32)
+static unsigned int __stdcall MCSortTaskThread(void *p_context)
+{
+    MCSortTask *t_task;
+    t_task = (MCSortTask *)p_context;
+    t_task -> function(t_task);
+    return 0;
+}
+#elif defined(MC_SORT_USE_PTHREADS)
+static void *MCSortTaskThread(void *p_context)
+{
+    MCSortTask *t_task;
+    t_task = (MCSortTask *)p_context;
+    t_task -> function(t_task);
+    return NULL;
+}
+#endif
+
+static void MCSortRunTasks(MCSortTask *p_tasks, uindex_t p_count)
+{
+    // The last task is always run on this thread.
+    for(uindex_t i = 0; i + 1 < p_count; i++)
+    {
+        p_tasks[i] . threaded = false;
+#if defined(_WIN32)
+        p_tasks[i] . thread = (HANDLE)_beginthreadex(NULL, 0, MCSortTaskThread, &p_tasks[i], 0, NULL);
+        p_tasks[i] . threaded = p_tasks[i] . thread != NULL;
+#elif defined(MC_SORT_USE_PTHREADS)
+        p_tasks[i] . threaded = pthread_create(&p_tasks[i] . thread, NULL, MCSortTaskThread, &p_tasks[i]) == 0;
+#endif
+        if (!p_tasks[i] . threaded)
+            p_tasks[i] . function(&p_tasks[i]);
+    }
+
+    if (p_count > 0)
+        p_tasks[p_count - 1] . function(&p_tasks[p_count - 1]);
+
+    for(uindex_t i = 0; i + 1 < p_count; i++)
+    {
+        if (!p_tasks[i] . threaded)
+            continue;
+#if defined(_WIN32)
+        WaitForSingleObject(p_tasks[i] . thread, INFINITE);
+        CloseHandle(p_tasks[i] . thread);
+#elif defined(MC_SORT_USE_PTHREADS)
+        pthread_join(p_tasks[i] . thread, NULL);
+#endif
+    }
+}
+
+static uindex_t MCSortThreadCount(uindex_t p_item_count)
+{
+    if (p_item_count < kMCSortParallelThreshold)
+        return 1;
+
+    uindex_t t_cores;
+#if defined(_WIN32)
+    SYSTEM_INFO t_info;
+    GetSystemInfo(&t_info);
+    t_cores = t_info . dwNumberOfProcessors;
+#elif defined(MC_SORT_USE_PTHREADS) && defined(_SC_NPROCESSORS_ONLN)
+    long t_online;
+    t_online = sysconf(_SC_NPROCESSORS_ONLN);
+    t_cores = t_online > 0 ? (uindex_t)t_online : 1;
+#else
+    t_cores = 1;
+#endif
+
+    // Keep each thread's share of the items reasonably large.
+    return MCMax(1U, MCMin(MCMin(t_cores, (uindex_t)kMCSortMaxThreads), p_item_count / (kMCSortParallelThreshold / 2)));
+}
+
+static void MCSortNumberTask(MCSortTask *p_task)
+{
+    MCSortNumberEntries((MCSortNumberEntry *)p_task -> entries + p_task -> start, (MCSortNumberEntry *)p_task -> temp + p_task -> start, p_task -> count);
+}
+
+static void MCSortSpanTask(MCSortTask *p_task)
+{
+    MCSortSpanEntries((MCSortSpanEntry *)p_task -> entries + p_task -> start, (MCSortSpanEntry *)p_task -> temp + p_task -> start, p_task -> count, 0, p_task -> descending);
+}
+
+// Merge two adjacent sorted runs into the temporary buffer, preferring the
+// left run on ties to keep the sort stable.
+static void MCSortNumberMergeTask(MCSortTask *p_task)
+{
+    MCSortNumberEntry *t_entries, *t_temp;
+    t_entries = (MCSortNumberEntry *)p_task -> entries;
+    t_temp = (MCSortNumberEntry *)p_task -> temp;
+    std::merge(t_entries + p_task -> start, t_entries + p_task -> middle,
+               t_entries + p_task -> middle, t_entries + p_task -> start + p_task -> count,
+               t_temp + p_task -> start,
+               [](const MCSortNumberEntry& p_left, const MCSortNumberEntry& p_right) {
+                   return p_left . key < p_right . key;
+               });
+}
+
+static void MCSortSpanMergeTask(MCSortTask *p_task)
+{
+    MCSortSpanEntry *t_entries, *t_temp;
+    t_entries = (MCSortSpanEntry *)p_task -> entries;
+    t_temp = (MCSortSpanEntry *)p_task -> temp;
+    if (p_task -> descending)
+        std::merge(t_entries + p_task -> start, t_entries + p_task -> middle,
+                   t_entries + p_task -> middle, t_entries + p_task -> start + p_task -> count,
+                   t_temp + p_task -> start,
+                   [](const MCSortSpanEntry& p_left, const MCSortSpanEntry& p_right) {
+                       return MCSortCompareSpans(p_left, p_right, 0) > 0;
+                   });
+    else
+        std::merge(t_entries + p_task -> start, t_entries + p_task -> middle,
+                   t_entries + p_task -> middle, t_entries + p_task -> start + p_task -> count,
+                   t_temp + p_task -> start,
+                   [](const MCSortSpanEntry& p_left, const MCSortSpanEntry& p_right) {
+                       return MCSortCompareSpans(p_left, p_right, 0) < 0;
+                   });
+}
+
+// Sort the entries by splitting them into one run per thread, sorting the runs
+// in parallel and then merging pairs of runs (again in parallel) until one is
+// left.
+template<typename T>
+static bool MCSortEntries(T *x_entries, uindex_t p_count, bool p_descending, void (*p_sort)(MCSortTask *), void (*p_merge)(MCSortTask *))
+{
+    MCAutoArray<T> t_temp;
+    if (!t_temp . New(p_count))
+        return false;
+
+    uindex_t t_thread_count;
+    t_thread_count = MCSortThreadCount(p_count);
+
+    MCAutoArray<MCSortTask> t_tasks;
+    MCAutoArray<uindex_t> t_runs;
+    if (!t_tasks . New(t_thread_count) ||
+        !t_runs . New(t_thread_count + 1))
+        return false;
+
+    for(uindex_t i = 0; i <= t_thread_count; i++)
+        t_runs[i] = (uindex_t)(((uint64_t)p_count * i) / t_thread_count);
+
+    for(uindex_t i = 0; i < t_thread_count; i++)
+    {
+        t_tasks[i] . function = p_sort;
+        t_tasks[i] . entries = x_entries;
+        t_tasks[i] . temp = t_temp . Ptr();
+        t_tasks[i] . start = t_runs[i];
+        t_tasks[i] . count = t_runs[i + 1] - t_runs[i];
+        t_tasks[i] . descending = p_descending;
+    }
+    MCSortRunTasks(t_tasks . Ptr(), t_thread_count);
+
+    T *t_from, *t_to;
+    t_from = x_entries;
+    t_to = t_temp . Ptr();
+
+    uindex_t t_run_count;
+    t_run_count = t_thread_count;
+    while (t_run_count > 1)
+    {
+        uindex_t t_task_count;
+        t_task_count = 0;
+        for(uindex_t i = 0; i < t_run_count; i += 2)
+        {
+            MCSortTask& t_task = t_tasks[t_task_count++];
+            t_task . entries = t_from;
+            t_task . temp = t_to;
+            t_task . start = t_runs[i];
+            t_task . descending = p_descending;
+            if (i + 1 < t_run_count)
+            {
+                t_task . function = p_merge;
+                t_task . middle = t_runs[i + 1];
+                t_task . count = t_runs[i + 2] - t_runs[i];
+            }
+            else
+            {
+                // An odd run out is just copied across.
+                t_task . function = nil;
+                t_task . count = t_runs[i + 1] - t_runs[i];
+                memcpy(t_to + t_task . start, t_from + t_task . start, t_task . count * sizeof(T));
+                t_task_count -= 1;
+            }
+        }
+        MCSortRunTasks(t_tasks . Ptr(), t_task_count);
+
+        // Remove the boundaries between the runs which were merged.
+        uindex_t t_new_run_count;
+        t_new_run_count = 0;
+        for(uindex_t i = 0; i < t_run_count; i += 2)
+            t_runs[++t_new_run_count] = t_runs[MCMin(i + 2, t_run_count)];
+        t_run_count = t_new_run_count;
+
+        std::swap(t_from, t_to);
+    }
+
+    if (t_from != x_entries)
+        memcpy(x_entries, t_from, p_count * sizeof(T));
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+MCSortKeys::MCSortKeys(void)
+{
+    m_count = 0;
+    m_numeric = false;
+    m_numbers = nil;
+    m_spans = nil;
+    m_native = nil;
+    m_has_native = false;
+    m_has_unicode = false;
+    m_blocks = nil;
+    m_block_count = 0;
+    m_block_frontier = nil;
+    m_block_available = 0;
+}
+
+MCSortKeys::~MCSortKeys(void)
+{
+    MCMemoryDeleteArray(m_numbers);
+    MCMemoryDeleteArray(m_spans);
+    MCMemoryDeleteArray(m_native);
+    for(uindex_t i = 0; i < m_block_count; i++)
+        MCMemoryDeallocate(m_blocks[i]);
+    MCMemoryDeleteArray(m_blocks);
+}
+
+bool MCSortKeys::Initialize(uindex_t p_count, bool p_numeric)
+{
+    m_count = p_count;
+    m_numeric = p_numeric;
+    if (p_numeric)
+        return MCMemoryNewArray(p_count, m_numbers);
+    return MCMemoryNewArray(p_count, m_spans) &&
+            MCMemoryNewArray(p_count, m_native);
+}
+
+void MCSortKeys::SetNumber(uindex_t p_index, double p_number)
+{
+    m_numbers[p_index] = p_number;
+}
+
+void MCSortKeys::SetBytes(uindex_t p_index, const byte_t *p_bytes, uindex_t p_length)
+{
+    m_spans[p_index] . bytes = p_bytes;
+    m_spans[p_index] . length = p_length;
+}
+
+byte_t *MCSortKeys::Allocate(size_t p_size)
+{
+    if (p_size > m_block_available)
+    {
+        if (!MCMemoryResizeArray(m_block_count + 1, m_blocks, m_block_count))
+            return nil;
+
+        size_t t_block_size;
+        t_block_size = MCMax(p_size, (size_t)kMCSortBlockSize);
+        if (!MCMemoryAllocate(t_block_size, m_blocks[m_block_count - 1]))
+        {
+            m_block_count -= 1;
+            return nil;
+        }
+
+        m_block_frontier = m_blocks[m_block_count - 1];
+        m_block_available = t_block_size;
+    }
+
+    byte_t *t_bytes;
+    t_bytes = m_block_frontier;
+    m_block_frontier += p_size;
+    m_block_available -= p_size;
+    return t_bytes;
+}
+
+bool MCSortKeys::SetString(uindex_t p_index, MCStringRef p_string)
+{
+    uindex_t t_length;
+    t_length = MCStringGetLength(p_string);
+
+    // Native strings are used as they are, and compared bytewise as
+    // MCStringCompareTo does.
+    if (MCStringIsNative(p_string))
+    {
+        const char_t *t_chars;
+        t_chars = MCStringGetNativeCharPtr(p_string);
+        SetBytes(p_index, t_chars, t_length);
+
+        for(uindex_t i = 0; i < t_length; i++)
+            if (t_chars[i] >= 0x80)
+            {
+                m_native[p_index] = true;
+                m_has_native = true;
+                break;
+            }
+
+        return true;
+    }
+
+    // Other strings are converted to UTF-8, whose bytewise order is the same
+    // as codepoint order.
+    const unichar_t *t_chars;
+    t_chars = MCStringGetCharPtr(p_string);
+
+    byte_t *t_bytes;
+    t_bytes = Allocate(t_length * 3);
+    if (t_bytes == nil)
+        return false;
+
+    uindex_t t_size;
+    t_size = 0;
+    for(uindex_t i = 0; i < t_length; i++)
+    {
+        codepoint_t t_codepoint;
+        t_codepoint = t_chars[i];
+        if (MCUnicodeCodepointIsHighSurrogate(t_codepoint) &&
+            i + 1 < t_length &&
+            MCUnicodeCodepointIsLowSurrogate(t_chars[i + 1]))
+        {
+            t_codepoint = MCUnicodeSurrogatesToCodepoint(t_codepoint, t_chars[i + 1]);
+            i += 1;
+        }
+
+        if (t_codepoint < 0x80)
+            t_bytes[t_size++] = t_codepoint;
+        else if (t_codepoint < 0x800)
+        {
+            t_bytes[t_size++] = 0xc0 | (t_codepoint >> 6);
+            t_bytes[t_size++] = 0x80 | (t_codepoint & 0x3f);
+        }
+        else if (t_codepoint < 0x10000)
+        {
+            t_bytes[t_size++] = 0xe0 | (t_codepoint >> 12);
+            t_bytes[t_size++] = 0x80 | ((t_codepoint >> 6) & 0x3f);
+            t_bytes[t_size++] = 0x80 | (t_codepoint & 0x3f);
+        }
+        else
+        {
+            t_bytes[t_size++] = 0xf0 | (t_codepoint >> 18);
+            t_bytes[t_size++] = 0x80 | ((t_codepoint >> 12) & 0x3f);
+            t_bytes[t_size++] = 0x80 | ((t_codepoint >> 6) & 0x3f);
+            t_bytes[t_size++] = 0x80 | (t_codepoint & 0x3f);
+        }
+    }
+
+    // Give back the space which wasn't needed.
+    m_block_frontier -= t_length * 3 - t_size;
+    m_block_available += t_length * 3 - t_size;
+
+    SetBytes(p_index, t_bytes, t_size);
+    m_has_unicode = true;
+
+    return true;
+}
+
+bool MCSortKeys::SetCollationKey(uindex_t p_index, MCUnicodeCollatorRef p_collator, MCStringRef p_string)
+{
+    byte_t *t_key;
+    uindex_t t_key_length;
+    if (!MCUnicodeCreateSortKeyWithCollator(p_collator, MCStringGetCharPtr(p_string), MCStringGetLength(p_string), t_key, t_key_length))
+        return false;
+
+    byte_t *t_bytes;
+    t_bytes = Allocate(t_key_length);
+    if (t_bytes != nil)
+    {
+        MCMemoryCopy(t_bytes, t_key, t_key_length);
+        SetBytes(p_index, t_bytes, t_key_length);
+    }
+
+    MCMemoryDeleteArray(t_key);
+
+    return t_bytes != nil;
+}
+
+bool MCSortKeys::ConvertNativeKeysToUTF8(void)
+{
+    for(uindex_t i = 0; i < m_count; i++)
+    {
+        if (!m_native[i])
+            continue;
+
+        byte_t *t_bytes;
+        t_bytes = Allocate(m_spans[i] . length * 3);
+        if (t_bytes == nil)
+            return false;
+
+        uindex_t t_size;
+        t_size = 0;
+        for(uindex_t j = 0; j < m_spans[i] . length; j++)
+        {
+            codepoint_t t_codepoint;
+            t_codepoint = MCUnicodeMapFromNative(m_spans[i] . bytes[j]);
+            if (t_codepoint < 0x80)
+                t_bytes[t_size++] = t_codepoint;
+            else if (t_codepoint < 0x800)
+            {
+                t_bytes[t_size++] = 0xc0 | (t_codepoint >> 6);
+                t_bytes[t_size++] = 0x80 | (t_codepoint & 0x3f);
+            }
+            else
+            {
+                t_bytes[t_size++] = 0xe0 | (t_codepoint >> 12);
+                t_bytes[t_size++] = 0x80 | ((t_codepoint >> 6) & 0x3f);
+                t_bytes[t_size++] = 0x80 | (t_codepoint & 0x3f);
+            }
+        }
+
+        m_block_frontier -= m_spans[i] . length * 3 - t_size;
+        m_block_available += m_spans[i] . length * 3 - t_size;
+
+        SetBytes(i, t_bytes, t_size);
+    }
+
+    return true;
+}
+
+bool MCSortKeys::Sort(bool p_descending, uindex_t *r_order)
+{
+    if (m_numeric)
+    {
+        MCAutoArray<MCSortNumberEntry> t_entries;
+        if (!t_entries . New(m_count))
+            return false;
+
+        // Descending order is ascending order of the inverted keys, which
+        // keeps equal items in their original order.
+        for(uindex_t i = 0; i < m_count; i++)
+        {
+            t_entries[i] . key = MCSortKeyFromNumber(m_numbers[i]);
+            if (p_descending)
+                t_entries[i] . key = ~t_entries[i] . key;
+            t_entries[i] . index = i;
+        }
+
+        if (!MCSortEntries(t_entries . Ptr(), m_count, false, MCSortNumberTask, MCSortNumberMergeTask))
+            return false;
+
+        for(uindex_t i = 0; i < m_count; i++)
+            r_order[i] = t_entries[i] . index;
+
+        return true;
+    }
+
+    // If native and non-native strings are being sorted together they must
+    // all be compared by codepoint.
+    if (m_has_native && m_has_unicode &&
+        !ConvertNativeKeysToUTF8())
+        return false;
+
+    MCAutoArray<MCSortSpanEntry> t_entries;
+    if (!t_entries . New(m_count))
+        return false;
+
+    for(uindex_t i = 0; i < m_count; i++)
+    {
+        t_entries[i] . bytes = m_spans[i] . bytes;
+        t_entries[i] . length = m_spans[i] . length;
+        t_entries[i] . index = i;
+    }
+
+    if (!MCSortEntries(t_entries . Ptr(), m_count, p_descending, MCSortSpanTask, MCSortSpanMergeTask))
+        return false;
+
+    for(uindex_t i = 0; i < m_count; i++)
+        r_order[i] = t_entries[i] . index;
+
+    return true;
+}
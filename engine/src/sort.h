@@ -0,0 +1,84 @@
+/* Copyright (C) 2003-2015 LiveCode Ltd.
+
+ This file is part of LiveCode.
+
+ LiveCode is free software; you can redistribute it and/or modify it under
+ the terms of the GNU General Public License v3 as published by the Free
+ Software Foundation.
+
+ LiveCode is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
+
+#ifndef __MC_SORT__
+#define __MC_SORT__
+
+// The sort engine used by the 'sort' command.
+//
+// The key of each item is computed once, up front, into a compact form -
+// either a double or a span of bytes which orders correctly under a bytewise
+// comparison (native chars, UTF-8, binary data or a collation key). A stable
+// permutation of the items is then computed by radix sorting the keys, split
+// across several threads for large inputs.
+class MCSortKeys
+{
+public:
+    MCSortKeys(void);
+    ~MCSortKeys(void);
+
+    // Allocate storage for the keys of p_count items, which are either all
+    // numbers or all byte spans.
+    bool Initialize(uindex_t p_count, bool p_numeric);
+
+    // Set the key of an item to a number.
+    void SetNumber(uindex_t p_index, double p_number);
+
+    // Set the key of an item to a span of bytes. The bytes are referenced, not
+    // copied, so must remain valid until Sort has been called.
+    void SetBytes(uindex_t p_index, const byte_t *p_bytes, uindex_t p_length);
+
+    // Set the key of an item to a string, ordered by codepoint. As with
+    // SetBytes, the string must remain valid until Sort has been called.
+    bool SetString(uindex_t p_index, MCStringRef p_string);
+
+    // Set the key of an item to the collation key of a string.
+    bool SetCollationKey(uindex_t p_index, MCUnicodeCollatorRef p_collator, MCStringRef p_string);
+
+    // Compute the sorted order of the items into r_order, which must have room
+    // for one index per item. Items with equal keys keep their relative order.
+    bool Sort(bool p_descending, uindex_t *r_order);
+
+private:
+    struct Span
+    {
+        const byte_t *bytes;
+        uindex_t length;
+    };
+
+    byte_t *Allocate(size_t p_size);
+    bool ConvertNativeKeysToUTF8(void);
+
+    uindex_t m_count;
+    bool m_numeric;
+    double *m_numbers;
+    Span *m_spans;
+
+    // Native string keys containing non-ASCII chars - these must be converted
+    // to UTF-8 if any string key is not native, so that all keys are ordered
+    // by codepoint.
+    bool *m_native;
+    bool m_has_native;
+    bool m_has_unicode;
+
+    // Storage for the bytes of keys which are not referenced.
+    byte_t **m_blocks;
+    uindex_t m_block_count;
+    byte_t *m_block_frontier;
+    size_t m_block_available;
+};
+
+#endif
@@ -343,6 +343,40 @@ static void MCServerOutputUnicodeChars(const unichar_t *p_chars, uint32_t p_char
 	MCS_write(t_output, 1, t_output_count, IO_stdout);
 }
 
+// Write out chars held as UTF-8 when the output encoding is UTF-8, performing
+// any end of line conversion as it goes. The runs between line endings need no
+// mapping, so are written as they are.
+static void MCServerOutputUTF8Bytes(const byte_t *p_bytes, uindex_t p_byte_count)
+{
+	if (MCserveroutputlineendings == kMCSOutputLineEndingsLF)
+	{
+		MCS_write(p_bytes, 1, p_byte_count, IO_stdout);
+		return;
+	}
+	
+	while(p_byte_count > 0)
+	{
+		const byte_t *t_line_end;
+		t_line_end = (const byte_t *)memchr(p_bytes, 10, p_byte_count);
+		if (t_line_end == nil)
+		{
+			MCS_write(p_bytes, 1, p_byte_count, IO_stdout);
+			break;
+		}
+		
+		MCS_write(p_bytes, 1, t_line_end - p_bytes, IO_stdout);
+		
+		char t_output[2];
+		uint32_t t_output_count;
+		t_output_count = 0;
+		MCServerOutputLineEnding(t_output, t_output_count);
+		MCS_write(t_output, 1, t_output_count, IO_stdout);
+		
+		p_byte_count -= t_line_end - p_bytes + 1;
+		p_bytes = t_line_end + 1;
+	}
+}
+
 static void MCServerOutputUnicodeMarkup(const unichar_t *p_chars, uint32_t p_char_count, bool p_is_content)
 {
 	// Our buffer has a certain amout of 'slop' to account for one-to-many char
@@ -422,6 +456,20 @@ void MCServerPutOutput(MCStringRef s)
     }
     else
     {
+        // Strings held as UTF-8 don't need to be converted to UTF-16 and back
+        // for UTF-8 output.
+        if (MCserveroutputtextencoding == kMCSOutputTextEncodingUTF8)
+        {
+            const byte_t *t_bytes;
+            uindex_t t_byte_count;
+            t_bytes = MCStringGetUTF8BytePtrAndLength(s, t_byte_count);
+            if (t_bytes != nil)
+            {
+                MCServerOutputUTF8Bytes(t_bytes, t_byte_count);
+                return;
+            }
+        }
+        
         const unichar_t *t_chars;
         uindex_t t_length;
         t_chars = MCStringGetCharPtr(s);
@@ -245,6 +245,14 @@ public:
 			return 0;
 		return t_info . st_size;
 	}
+
+	virtual bool IsRegularFile(void)
+	{
+		struct _stat64 t_info;
+		if (_fstat64(fileno(m_stream), &t_info) != 0)
+			return false;
+		return (t_info . st_mode & _S_IFMT) == _S_IFREG;
+	}
 	
 	virtual void *GetFilePointer(void)
 	{
@@ -497,6 +497,8 @@ public:
 	// IM-2013-01-03: [[ FullscreenMode ]] Set / get the compositor cache limit
 	uint32_t view_getcompositorcachelimit(void);
 	void view_setcompositorcachelimit(uint32_t p_limit);
+	// The compositor cache limit the stack would have with accelerated rendering on.
+	uint32_t view_getdefaultcompositorcachelimit(void);
 	
 	// IM-2013-01-03: [[ FullscreenMode ]] Set / get the compositor tile size
 	uint32_t view_getcompositortilesize(void);
@@ -513,6 +515,8 @@ public:
 	
 	void view_flushtilecache(void);
 	void view_activatetilecache(void);
+	// Fetch the tilecache configuration for the current platform (and screen size on mobile).
+	void view_gettilecachedefaults(int32_t& r_tile_size, int32_t& r_cache_limit, MCTileCacheCompositorType& r_compositor_type);
 	void view_compacttilecache(void);
 	
 	// IM-2014-01-24: [[ HiDPI ]] Update the tilecache viewport to match the view rect at the current backing scale
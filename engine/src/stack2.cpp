@@ -2830,6 +2830,7 @@ void MCStack::dirtyall(void)
 	// MW-2011-09-08: [[ TileCache ]] A 'dirtyall' request means wipe all cached
 	//   data.
 	view_flushtilecache();
+	MCRedrawFlushLayerCaches();
 
 	// MW-2011-09-21: [[ Layers ]] Make sure all the layers on the current card
 	//   recompute their id's and other attrs.
@@ -647,6 +647,59 @@ bool MCStack::view_getacceleratedrendering(void)
 	return m_view_tilecache != nil;
 }
 
+void MCStack::view_gettilecachedefaults(int32_t& r_tile_size, int32_t& r_cache_limit, MCTileCacheCompositorType& r_compositor_type)
+{
+#ifdef _SERVER
+	// We don't have accelerated rendering on Server
+	r_compositor_type = kMCTileCacheCompositorNone;
+	r_tile_size = 0;
+	r_cache_limit = 0;
+#else
+#ifdef _MAC_DESKTOP
+	r_compositor_type = kMCTileCacheCompositorCoreGraphics;
+	r_tile_size = 32;
+	r_cache_limit = 32 * 1024 * 1024;
+#elif defined(_WINDOWS_DESKTOP) || defined(_LINUX_DESKTOP) || defined(__EMSCRIPTEN__)
+	r_compositor_type = kMCTileCacheCompositorSoftware;
+	r_tile_size = 32;
+	r_cache_limit = 32 * 1024 * 1024;
+#elif defined(_IOS_MOBILE) || defined(_ANDROID_MOBILE)
+	r_compositor_type = kMCTileCacheCompositorStaticOpenGL;
+	
+	const MCDisplay *t_display;
+	MCscreen -> getdisplays(t_display, false);
+	
+	MCRectangle t_viewport;
+	t_viewport = t_display -> viewport;
+	
+	// IM-2014-01-30: [[ HiDPI ]] Use backing-surface size to determine small, medium, or large
+	t_viewport = MCRectangleGetScaledBounds(t_viewport, view_getbackingscale());
+	
+	bool t_small_screen, t_medium_screen;
+	t_small_screen = MCMin(t_viewport . width, t_viewport . height) <= 480 && MCMax(t_viewport . width, t_viewport . height) <= 640;
+	t_medium_screen = MCMin(t_viewport . width, t_viewport . height) <= 768 && MCMax(t_viewport . width, t_viewport . height) <= 1024;
+	
+	if (t_small_screen)
+		r_tile_size = 32, r_cache_limit = 16 * 1024 * 1024;
+	else if (t_medium_screen)
+		r_tile_size = 64, r_cache_limit = 32 * 1024 * 1024;
+	else
+		r_tile_size = 64, r_cache_limit = 64 * 1024 * 1024;
+#else
+#   error "No tile cache implementation defined for this platform"
+#endif
+#endif /* !_SERVER */
+}
+
+uint32_t MCStack::view_getdefaultcompositorcachelimit(void)
+{
+	int32_t t_tile_size;
+	int32_t t_cache_limit;
+	MCTileCacheCompositorType t_compositor_type;
+	view_gettilecachedefaults(t_tile_size, t_cache_limit, t_compositor_type);
+	return t_cache_limit;
+}
+
 void MCStack::view_setacceleratedrendering(bool p_value)
 {
 #ifdef _SERVER
@@ -676,39 +729,7 @@ void MCStack::view_setacceleratedrendering(bool p_value)
 	int32_t t_tile_size;
 	int32_t t_cache_limit;
 	MCTileCacheCompositorType t_compositor_type;
-#ifdef _MAC_DESKTOP
-	t_compositor_type = kMCTileCacheCompositorCoreGraphics;
-	t_tile_size = 32;
-	t_cache_limit = 32 * 1024 * 1024;
-#elif defined(_WINDOWS_DESKTOP) || defined(_LINUX_DESKTOP) || defined(__EMSCRIPTEN__)
-	t_compositor_type = kMCTileCacheCompositorSoftware;
-	t_tile_size = 32;
-	t_cache_limit = 32 * 1024 * 1024;
-#elif defined(_IOS_MOBILE) || defined(_ANDROID_MOBILE)
-	t_compositor_type = kMCTileCacheCompositorStaticOpenGL;
-	
-	const MCDisplay *t_display;
-	MCscreen -> getdisplays(t_display, false);
-	
-	MCRectangle t_viewport;
-	t_viewport = t_display -> viewport;
-	
-	// IM-2014-01-30: [[ HiDPI ]] Use backing-surface size to determine small, medium, or large
-	t_viewport = MCRectangleGetScaledBounds(t_viewport, view_getbackingscale());
-	
-	bool t_small_screen, t_medium_screen;
-	t_small_screen = MCMin(t_viewport . width, t_viewport . height) <= 480 && MCMax(t_viewport . width, t_viewport . height) <= 640;
-	t_medium_screen = MCMin(t_viewport . width, t_viewport . height) <= 768 && MCMax(t_viewport . width, t_viewport . height) <= 1024;
-	
-	if (t_small_screen)
-		t_tile_size = 32, t_cache_limit = 16 * 1024 * 1024;
-	else if (t_medium_screen)
-		t_tile_size = 64, t_cache_limit = 32 * 1024 * 1024;
-	else
-		t_tile_size = 64, t_cache_limit = 64 * 1024 * 1024;
-#else
-#   error "No tile cache implementation defined for this platform"
-#endif
+	view_gettilecachedefaults(t_tile_size, t_cache_limit, t_compositor_type);
 	
 	MCTileCacheCreate(t_tile_size, t_cache_limit, m_view_tilecache);
 	view_updatetilecacheviewport();
@@ -765,6 +786,9 @@ void MCStack::view_setcompositorcachelimit(uint32_t p_limit)
 	if (m_view_tilecache != nil)
 	{
 		MCTileCacheSetCacheLimit(m_view_tilecache, p_limit);
+		// Layer caches share the compositor cache limit, so make sure they
+		// fit within the new one.
+		MCRedrawTrimLayerCaches(p_limit);
 		dirtyall();
 	}
 }
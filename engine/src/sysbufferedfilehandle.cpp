@@ -0,0 +1,188 @@
+/* Copyright (C) 2003-2015 LiveCode Ltd.
+
+This file is part of LiveCode.
+
+LiveCode is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License v3 as published by the Free
+Software Foundation.
+
+LiveCode is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
+
+#include "prefix.h"
+
+#include "system.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+MCBufferedFileHandle::MCBufferedFileHandle(MCSystemFileHandle *p_source)
+{
+    m_source = p_source;
+    m_buffer = NULL;
+    m_offset = 0;
+    m_length = 0;
+    m_is_eof = false;
+}
+
+void MCBufferedFileHandle::Close(void)
+{
+    m_source -> Close();
+    free(m_buffer);
+    delete this;
+}
+
+bool MCBufferedFileHandle::Fill(uint32_t& r_read)
+{
+    bool t_success;
+    t_success = Refill(r_read);
+    m_is_eof = r_read == 0 && m_source -> IsExhausted();
+    return t_success;
+}
+
+bool MCBufferedFileHandle::Read(void *p_buffer, uint32_t p_length, uint32_t& r_read)
+{
+    uint32_t t_done;
+    t_done = MCMin(p_length, GetByteCount());
+    if (t_done != 0)
+        memcpy(p_buffer, m_buffer + m_offset, t_done);
+    m_offset += t_done;
+
+    // Large reads go straight to the source, small ones through the
+    // buffer.
+    bool t_success;
+    t_success = true;
+    if (t_done < p_length)
+    {
+        uint32_t t_read;
+        t_read = 0;
+        if (p_length - t_done >= kMCBufferedFileHandleSize)
+            t_success = m_source -> Read((char *)p_buffer + t_done, p_length - t_done, t_read);
+        else
+        {
+            t_success = Refill(t_read);
+            t_read = MCMin(p_length - t_done, GetByteCount());
+            if (t_read != 0)
+                memcpy((char *)p_buffer + t_done, m_buffer + m_offset, t_read);
+            m_offset += t_read;
+        }
+        t_done += t_read;
+    }
+
+    m_is_eof = t_done < p_length && m_source -> IsExhausted();
+
+    r_read = t_done;
+    return t_done == p_length || (t_success && !m_is_eof);
+}
+
+bool MCBufferedFileHandle::Write(const void *p_buffer, uint32_t p_length)
+{
+    if (!Unread())
+        return false;
+
+    return m_source -> Write(p_buffer, p_length);
+}
+
+bool MCBufferedFileHandle::Seek(int64_t p_offset, int p_dir)
+{
+    if (p_dir == kMCSystemFileSeekCurrent)
+        p_offset -= GetByteCount();
+
+    m_offset = m_length = 0;
+    m_is_eof = false;
+
+    return m_source -> Seek(p_offset, p_dir);
+}
+
+bool MCBufferedFileHandle::PutBack(char p_char)
+{
+    if (m_offset == 0)
+        return m_length == 0 && m_source -> PutBack(p_char);
+
+    m_buffer[--m_offset] = p_char;
+    m_is_eof = false;
+    return true;
+}
+
+int64_t MCBufferedFileHandle::Tell(void)
+{
+    return m_source -> Tell() - GetByteCount();
+}
+
+uint64_t MCBufferedFileHandle::GetFileSize(void)
+{
+    return m_source -> GetFileSize();
+}
+
+void *MCBufferedFileHandle::GetFilePointer(void)
+{
+    return m_source -> GetFilePointer();
+}
+
+bool MCBufferedFileHandle::TakeBuffer(void*& r_buffer, size_t& r_length)
+{
+    return false;
+}
+
+bool MCBufferedFileHandle::Truncate(void)
+{
+    if (!Unread())
+        return false;
+
+    return m_source -> Truncate();
+}
+
+bool MCBufferedFileHandle::Sync(void)
+{
+    return m_source -> Sync();
+}
+
+bool MCBufferedFileHandle::Flush(void)
+{
+    return m_source -> Flush();
+}
+
+bool MCBufferedFileHandle::Refill(uint32_t& r_read)
+{
+    r_read = 0;
+
+    if (m_buffer == NULL)
+    {
+        m_buffer = (char *)malloc(kMCBufferedFileHandleSize);
+        if (m_buffer == NULL)
+            return false;
+    }
+
+    if (m_offset != 0)
+    {
+        memmove(m_buffer, m_buffer + m_offset, m_length - m_offset);
+        m_length -= m_offset;
+        m_offset = 0;
+    }
+
+    if (m_length == kMCBufferedFileHandleSize)
+        return true;
+
+    bool t_success;
+    t_success = m_source -> Read(m_buffer + m_length, kMCBufferedFileHandleSize - m_length, r_read);
+    m_length += r_read;
+
+    return t_success;
+}
+
+bool MCBufferedFileHandle::Unread(void)
+{
+    if (GetByteCount() != 0 &&
+        !m_source -> Seek(-(int64_t)GetByteCount(), kMCSystemFileSeekCurrent))
+        return false;
+
+    m_offset = m_length = 0;
+    m_is_eof = false;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -66,6 +66,8 @@ struct MCSystemFolderEntry
 typedef bool (*MCSystemListFolderEntriesCallback)(void *p_context, const MCSystemFolderEntry *p_entry);
 typedef bool (*MCSystemHostResolveCallback)(void *p_context, MCStringRef p_host);
 
+class MCBufferedFileHandle;
+
 struct MCSystemFileHandle
 {
     virtual void Close(void) = 0;
@@ -97,6 +99,19 @@ struct MCSystemFileHandle
     
     virtual bool TakeBuffer(void*& r_buffer, size_t& r_length) = 0;
 
+    // Returns the handle as a read-ahead buffer, if it is one.
+    virtual MCBufferedFileHandle *GetReadBuffer(void)
+    {
+        return nil;
+    }
+
+    // Returns true if the handle is a regular file on disk, which can be read
+    // ahead without blocking (unlike pipes, FIFOs and character devices).
+    virtual bool IsRegularFile(void)
+    {
+        return false;
+    }
+
     // Polymorphic - needs virtual destructor
     virtual ~MCSystemFileHandle()
     {
@@ -313,6 +328,12 @@ public:
         MCMemoryFileHandle::Close();
     }
     
+    // Only regular files are mapped into memory.
+    bool IsRegularFile(void)
+    {
+        return true;
+    }
+    
 private:
     int m_fd;
     void *m_buffer;
@@ -322,6 +343,87 @@ private:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// The size of the read-ahead buffer kept by an MCBufferedFileHandle.
+#define kMCBufferedFileHandleSize 65536
+
+// MCBufferedFileHandle reads ahead from another handle, so that text can be
+// decoded and searched in bulk rather than a byte at a time. It behaves like
+// the handle it wraps: seeking, telling and writing all take account of the
+// bytes which have been read ahead but not yet consumed.
+class MCBufferedFileHandle: public MCSystemFileHandle
+{
+public:
+    MCBufferedFileHandle(MCSystemFileHandle *p_source);
+    
+    void Close(void);
+    
+    MCBufferedFileHandle *GetReadBuffer(void)
+    {
+        return this;
+    }
+    
+    // The bytes which have been read ahead and not yet consumed.
+    const byte_t *GetBytes(void)
+    {
+        return (const byte_t *)m_buffer + m_offset;
+    }
+    
+    uint32_t GetByteCount(void)
+    {
+        return m_length - m_offset;
+    }
+    
+    bool IsFull(void)
+    {
+        return m_offset == 0 && m_length == kMCBufferedFileHandleSize;
+    }
+    
+    void Consume(uint32_t p_count)
+    {
+        m_offset += MCMin(p_count, GetByteCount());
+    }
+    
+    // Read as many more bytes from the source as are available and fit in
+    // the buffer. If none could be read because the source is at its end,
+    // the handle becomes exhausted. Returns false if the source reported an
+    // error or reached its end.
+    bool Fill(uint32_t& r_read);
+    
+    virtual bool IsExhausted(void)
+    {
+        return m_is_eof;
+    }
+    
+    bool Read(void *p_buffer, uint32_t p_length, uint32_t& r_read);
+    bool Write(const void *p_buffer, uint32_t p_length);
+    bool Seek(int64_t p_offset, int p_dir);
+    bool PutBack(char p_char);
+    int64_t Tell(void);
+    uint64_t GetFileSize(void);
+    void *GetFilePointer(void);
+    bool TakeBuffer(void*& r_buffer, size_t& r_length);
+    bool Truncate(void);
+    bool Sync(void);
+    bool Flush(void);
+    
+private:
+    // Move the unconsumed bytes to the start of the buffer and read more
+    // from the source after them.
+    bool Refill(uint32_t& r_read);
+    
+    // Return the source to the position of the first unconsumed byte, and
+    // drop the buffer.
+    bool Unread(void);
+    
+    MCSystemFileHandle *m_source;
+    char *m_buffer;
+    uint32_t m_offset;
+    uint32_t m_length;
+    bool m_is_eof;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
 class MCCustomFileHandle: public MCSystemFileHandle
 {
 public:
@@ -30,6 +30,7 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 #include "graphicscontext.h"
 #include "graphics_util.h"
+#include "pixelkernels.h"
 
 #ifdef _HAS_QSORT_R
 #define stdc_qsort(a, b, c, d, e) qsort_r(a, b, c, e, d)
@@ -846,16 +847,9 @@ static void MCTileCacheCopyTileBits(int32_t p_size, uint32_t *p_dst_ptr, const u
 	t_and_mask = 0xffffffff;
 	for(uint32_t y = p_size; y > 0; y--)
 	{
-		for(uint32_t x = p_size; x > 0; x--)
-		{
-			uint32_t t_pixel;
-			t_pixel = *p_src_ptr++;
-			*p_dst_ptr++ = t_pixel;
-			t_or_mask |= t_pixel;
-			t_and_mask &= t_pixel;
-		}
-		
-		p_src_ptr += p_src_advance;
+		MCPixelRowCopyWithMasks(p_src_ptr, p_dst_ptr, p_size, t_or_mask, t_and_mask);
+		p_src_ptr += p_size + p_src_advance;
+		p_dst_ptr += p_size;
 	}
 	
 	r_or_mask = t_or_mask;
@@ -928,8 +922,7 @@ static void MCTileCacheFillTile(MCTileCacheRef self, uint32_t p_index, MCImageBi
 		// Just compute or/and masks (no need to copy).
 		t_and_bits = 0xffffffff;
 		t_or_bits = 0;
-		for(uint32_t i = 0; i < t_src_stride * self -> tile_size; i++)
-			t_and_bits &= t_src_bits[i], t_or_bits |= t_src_bits[i];
+		MCPixelRowCopyWithMasks(t_src_bits, nil, t_src_stride * self -> tile_size, t_or_bits, t_and_bits);
 	
 		// Use direct access to context back-buffer.
 		t_tile_ptr = (void *)t_src_bits;
@@ -27,6 +27,7 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #define kMCEncodedValueTypeNumber 4
 #define kMCEncodedValueTypeLegacyArray 5
 #define kMCEncodedValueTypeArray 6
+#define kMCEncodedValueTypeIndexedArray 7
 
 typedef enum
 {
@@ -63,8 +63,10 @@ MCWidgetBase::MCWidgetBase(void)
     m_instance = nil;
     m_children = nil;
     m_annotations = nil;
+    m_display_list = nil;
     m_has_timer = false;
     m_timer_deferred = false;
+    m_display_list_invalidated = false;
 }
 
 MCWidgetBase::~MCWidgetBase(void)
@@ -122,6 +124,8 @@ void MCWidgetBase::Destroy(void)
     
     MCValueRelease(m_annotations);
     m_annotations = nil;
+    
+    InvalidateDisplayList(false);
 }
 
 MCWidgetRef MCWidgetBase::AsWidget(void)
@@ -346,8 +350,25 @@ bool MCWidgetBase::OnPaint(MCGContextRef p_gcontext)
     bool t_success;
     t_success = true;
     
+    MCWidget *t_widget;
+    t_widget = GetHost();
+    
+    // A retained display list can be replayed as long as the widget is drawn
+    // at the same scale; otherwise OnPaint must run (and be recorded) again.
+    if (m_display_list != nil && !MCCanvasDisplayListCanReplay(m_display_list, p_gcontext))
+        InvalidateDisplayList(false);
+    
+    bool t_record;
+    t_record = m_display_list == nil && t_widget != nil && t_widget -> getretainpaint();
+    
     uintptr_t t_cookie;
-    MCCanvasPush(p_gcontext, t_cookie);
+    if (t_record)
+    {
+        m_display_list_invalidated = false;
+        MCCanvasPushRecording(p_gcontext, t_cookie);
+    }
+    else
+        MCCanvasPush(p_gcontext, t_cookie);
     
     MCGRectangle t_frame;
     t_frame = GetFrame();
@@ -356,8 +377,8 @@ bool MCWidgetBase::OnPaint(MCGContextRef p_gcontext)
     MCGContextClipToRect(p_gcontext, t_frame);
     MCGContextTranslateCTM(p_gcontext, t_frame . origin . x, t_frame . origin . y);
     
-    MCWidget *t_widget;
-    t_widget = GetHost();
+    bool t_dispatched;
+    t_dispatched = false;
     
     bool t_view_rendered;
     t_view_rendered = false;
@@ -372,7 +393,15 @@ bool MCWidgetBase::OnPaint(MCGContextRef p_gcontext)
 	}
 	
 	if (t_success && !t_view_rendered)
-		t_success = DispatchRestricted(MCNAME("OnPaint"));
+	{
+		if (m_display_list != nil)
+			MCCanvasDisplayListReplay(m_display_list, p_gcontext);
+		else
+		{
+			t_success = DispatchRestricted(MCNAME("OnPaint"));
+			t_dispatched = true;
+		}
+	}
     
     if (m_children != nil)
     {
@@ -386,7 +415,20 @@ bool MCWidgetBase::OnPaint(MCGContextRef p_gcontext)
     }
     MCGContextRestore(p_gcontext);
     
-    MCCanvasPop(t_cookie);
+    if (t_record)
+    {
+        MCCanvasDisplayListRef t_list;
+        MCCanvasPopRecording(t_cookie, t_list);
+        
+        // Only keep drawing which completed and which nothing has changed
+        // since it was made.
+        if (t_success && t_dispatched && !m_display_list_invalidated)
+            m_display_list = t_list;
+        else
+            MCCanvasDisplayListDestroy(t_list);
+    }
+    else
+        MCCanvasPop(t_cookie);
     
     return t_success;
 }
@@ -693,6 +735,20 @@ void MCWidgetBase::RedrawRect(MCGRectangle *p_area)
     MCWidgetAsBase(t_owner) -> RedrawRect(p_area);
 }
 
+void MCWidgetBase::InvalidateDisplayList(bool p_recursive)
+{
+    m_display_list_invalidated = true;
+    if (m_display_list != nil)
+    {
+        MCCanvasDisplayListDestroy(m_display_list);
+        m_display_list = nil;
+    }
+    
+    if (p_recursive && m_children != nil)
+        for(uindex_t i = 0; i < MCProperListGetLength(m_children); i++)
+            MCWidgetAsBase(MCProperListFetchElementAtIndex(m_children, i)) -> InvalidateDisplayList(true);
+}
+
 void MCWidgetBase::TriggerAll()
 {
     if (IsRoot())
@@ -1448,9 +1504,15 @@ bool MCWidgetSetAnnotation(MCWidgetRef self, MCNameRef p_annotation, MCValueRef
 
 void MCWidgetRedrawAll(MCWidgetRef self)
 {
+    MCWidgetAsBase(self) -> InvalidateDisplayList(false);
     return MCWidgetAsBase(self) -> RedrawRect(nil);
 }
 
+void MCWidgetInvalidateDisplayList(MCWidgetRef self)
+{
+    MCWidgetAsBase(self) -> InvalidateDisplayList(true);
+}
+
 void MCWidgetTriggerAll(MCWidgetRef self)
 {
     return MCWidgetAsBase(self) -> TriggerAll();
@@ -97,6 +97,10 @@ public:
     void RedrawRect(MCGRectangle *area);
     void TriggerAll();
     
+    // Discard the drawing retained from the last OnPaint, optionally
+    // doing the same for all the widget's children.
+    void InvalidateDisplayList(bool p_recursive);
+    
     bool CopyChildren(MCProperListRef& r_children);
     void PlaceWidget(MCWidgetRef child, MCWidgetRef relative_to, bool put_below);
     void UnplaceWidget(MCWidgetRef child);
@@ -170,11 +174,19 @@ private:
     // The annotations of this widget (a mutable array - or nil if none).
     MCArrayRef m_annotations;
     
+    // The drawing recorded from the widget's last OnPaint (if the host
+    // retains paint - nil otherwise).
+    struct __MCCanvasDisplayList *m_display_list;
+    
     // If true, then the widget has an active timer that should be cancelled.
     bool m_has_timer : 1;
     
     // If true, then the widget has deferred a timer until browse mode is entered.
     bool m_timer_deferred : 1;
+    
+    // If true, then the display list has been invalidated since the current
+    // OnPaint started recording it.
+    bool m_display_list_invalidated : 1;
 };
 
 class MCWidgetRoot: public MCWidgetBase
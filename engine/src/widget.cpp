@@ -74,6 +74,8 @@ MCWidgetRef MCcurrentwidget;
 MCPropertyInfo MCWidget::kProperties[] =
 {
 	DEFINE_RO_OBJ_PROPERTY(P_KIND, Name, MCWidget, Kind)
+	DEFINE_RW_OBJ_PROPERTY(P_RETAIN_PAINT, Bool, MCWidget, RetainPaint)
+	DEFINE_RO_OBJ_PROPERTY(P_PAINT_TIME, Double, MCWidget, PaintTime)
 };
 
 MCObjectPropertyTable MCWidget::kPropertyTable =
@@ -90,6 +92,8 @@ MCWidget::MCWidget(void)
     m_kind = nil;
     m_rep = nil;
     m_widget = nil;
+    m_retain_paint = false;
+    m_paint_time = 0;
 }
 
 MCWidget::MCWidget(const MCWidget& p_other) :
@@ -98,6 +102,8 @@ MCWidget::MCWidget(const MCWidget& p_other) :
     m_kind = nil;
     m_rep = nil;
     m_widget = nil;
+    m_retain_paint = p_other . m_retain_paint;
+    m_paint_time = 0;
 }
 
 MCWidget::~MCWidget(void)
@@ -353,7 +359,10 @@ void MCWidget::timer(MCNameRef p_message, MCParameter *p_parameters)
 void MCWidget::recompute(void)
 {
     if (m_widget != nil)
+    {
+        MCWidgetInvalidateDisplayList(m_widget);
         MCwidgeteventmanager->event_recompute(this);
+    }
 }
 
 static void lookup_name_for_prop(Properties p_which, MCNameRef& r_name)
@@ -463,6 +472,7 @@ bool MCWidget::getprop(MCExecContext& ctxt, uint32_t p_part_id, Properties p_whi
 		case P_UNICODE_TOOL_TIP:
         case P_LAYER_MODE:
         case P_LAYER_CLIP_RECT:
+        case P_LAYER_CACHE:
             
         // Development mode only
         case P_REV_AVAILABLE_HANDLERS:
@@ -470,6 +480,8 @@ bool MCWidget::getprop(MCExecContext& ctxt, uint32_t p_part_id, Properties p_whi
     
         case P_KIND:
         case P_THEME_CONTROL_TYPE:
+        case P_RETAIN_PAINT:
+        case P_PAINT_TIME:
 			return MCControl::getprop(ctxt, p_part_id, p_which, p_index, p_effective, r_value);
             
         default:
@@ -572,9 +584,11 @@ bool MCWidget::setprop(MCExecContext& ctxt, uint32_t p_part_id, Properties p_whi
         case P_ENABLED:
         case P_DISABLED:
         case P_LAYER_CLIP_RECT:
+        case P_LAYER_CACHE:
             
         case P_KIND:
         case P_THEME_CONTROL_TYPE:
+        case P_RETAIN_PAINT:
 			return MCControl::setprop(ctxt, p_part_id, p_which, p_index, p_effective, p_value);
             
         default:
@@ -666,6 +680,10 @@ bool MCWidget::setcustomprop(MCExecContext& ctxt, MCNameRef p_set_name, MCNameRe
             return false;
     }
     
+    // The property may change the widget's appearance, whether or not it
+    // asks to be redrawn.
+    MCWidgetInvalidateDisplayList(m_widget);
+    
     if (t_set_type != nil &&
         !MCExtensionConvertFromScriptType(ctxt, t_set_type, InOut(t_value)))
     {
@@ -734,7 +752,10 @@ void MCWidget::toolchanged(Tool p_new_tool)
 	MCControl::toolchanged(p_new_tool);
 
 	if (m_widget != nil)
+	{
+		MCWidgetInvalidateDisplayList(m_widget);
 		MCwidgeteventmanager -> event_toolchanged(this, p_new_tool);
+	}
 }
 
 void MCWidget::layerchanged()
@@ -742,7 +763,10 @@ void MCWidget::layerchanged()
 	MCControl::layerchanged();
 
 	if (m_widget != nil)
+	{
+		MCWidgetInvalidateDisplayList(m_widget);
 		MCwidgeteventmanager -> event_layerchanged(this);
+	}
 }
 
 void MCWidget::visibilitychanged(bool p_visible)
@@ -758,7 +782,10 @@ void MCWidget::geometrychanged(const MCRectangle &p_rect)
 	MCControl::geometrychanged(p_rect);
 
 	if (m_widget != nil)
+	{
+		MCWidgetInvalidateDisplayList(m_widget);
 		MCwidgeteventmanager -> event_setrect(this, p_rect);
+	}
 }
 
 Boolean MCWidget::del(bool p_check_flag)
@@ -985,7 +1012,11 @@ void MCWidget::draw(MCDC *dc, const MCRectangle& p_dirty, bool p_isolated, bool
         {
             MCGContextRef t_gcontext;
             t_gcontext = ((MCGraphicsContext *)dc) -> getgcontextref();
+            
+            real64_t t_start_time;
+            t_start_time = MCS_time();
             MCwidgeteventmanager->event_paint(this, t_gcontext);
+            m_paint_time = (MCS_time() - t_start_time) * 1000.0;
         }
         else
         {
@@ -1113,6 +1144,26 @@ void MCWidget::GetKind(MCExecContext& ctxt, MCNameRef& r_kind)
     r_kind = MCValueRetain(m_kind);
 }
 
+void MCWidget::GetRetainPaint(MCExecContext& ctxt, bool& r_setting)
+{
+    r_setting = m_retain_paint;
+}
+
+void MCWidget::SetRetainPaint(MCExecContext& ctxt, bool p_setting)
+{
+    if (m_retain_paint == p_setting)
+        return;
+    
+    m_retain_paint = p_setting;
+    if (m_widget != nil)
+        MCWidgetInvalidateDisplayList(m_widget);
+}
+
+void MCWidget::GetPaintTime(MCExecContext& ctxt, double& r_time)
+{
+    r_time = m_paint_time;
+}
+
 void MCWidget::GetState(MCExecContext& ctxt, MCArrayRef& r_state)
 {
     MCAutoValueRef t_value;
@@ -102,6 +102,7 @@ bool MCWidgetSetAnnotation(MCWidgetRef widget, MCNameRef annotation, MCValueRef
 bool MCWidgetPost(MCWidgetRef widget, MCNameRef event, MCProperListRef args);
 
 void MCWidgetRedrawAll(MCWidgetRef widget);
+void MCWidgetInvalidateDisplayList(MCWidgetRef widget);
 void MCWidgetScheduleTimerIn(MCWidgetRef widget, double timeout);
 void MCWidgetCancelTimer(MCWidgetRef widget);
 void MCWidgetTriggerAll(MCWidgetRef widget);
@@ -206,6 +207,9 @@ public:
     
     void GetKind(MCExecContext& ctxt, MCNameRef& r_kind);
     void GetState(MCExecContext& ctxt, MCArrayRef& r_state);
+    void GetRetainPaint(MCExecContext& ctxt, bool& r_setting);
+    void SetRetainPaint(MCExecContext& ctxt, bool p_setting);
+    void GetPaintTime(MCExecContext& ctxt, double& r_time);
     
     // Bind a widget to a kind and rep.
     void bind(MCNameRef p_kind, MCValueRef p_rep);
@@ -217,6 +221,8 @@ public:
     
     bool isInRunMode();
     
+    bool getretainpaint(void) const { return m_retain_paint; }
+    
     void SetFocused(bool p_setting);
     
 protected:
@@ -233,6 +239,13 @@ private:
     
     // The LCB Widget object.
     MCWidgetRef m_widget;
+    
+    // If true, the widget's OnPaint drawing is recorded and replayed until
+    // the widget redraws or its properties change.
+    bool m_retain_paint : 1;
+    
+    // The time taken by the last paint of the widget, in milliseconds.
+    real64_t m_paint_time;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,80 @@
+/* Copyright (C) 2017 LiveCode Ltd.
+
+This file is part of LiveCode.
+
+LiveCode is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License v3 as published by the Free
+Software Foundation.
+
+LiveCode is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
+
+#include "gtest/gtest.h"
+
+#include "prefix.h"
+#include "graphics.h"
+
+#include <vector>
+
+// Draw a rectangle with a glow and drop shadow large enough for the blur
+// passes to be split into bands, and return the pixels.
+static std::vector<uint32_t> DrawWithEffects(uint32_t p_max_threads)
+{
+	const uint32_t kSize = 640;
+	std::vector<uint32_t> t_pixels(kSize * kSize, 0);
+
+	// Blurred masks are cached, so start from an empty cache each time.
+	MCGraphicsCompact();
+	MCGBlurSetMaxThreadCount(p_max_threads);
+
+	MCGContextRef t_context;
+	EXPECT_TRUE(MCGContextCreateWithPixels(kSize, kSize, kSize * sizeof(uint32_t), t_pixels.data(), true, t_context));
+	if (t_context == nullptr)
+		return t_pixels;
+
+	MCGBitmapEffects t_effects;
+	t_effects.has_outer_glow = true;
+	t_effects.outer_glow.color = MCGColorMakeRGBA(1, 0, 0, 1);
+	t_effects.outer_glow.blend_mode = kMCGBlendModeSourceOver;
+	t_effects.outer_glow.size = 37;
+	t_effects.has_drop_shadow = true;
+	t_effects.drop_shadow.color = MCGColorMakeRGBA(0, 0, 0, 0.5);
+	t_effects.drop_shadow.blend_mode = kMCGBlendModeSourceOver;
+	t_effects.drop_shadow.size = 21;
+	t_effects.drop_shadow.spread = 0.25;
+	t_effects.drop_shadow.x_offset = 7;
+	t_effects.drop_shadow.y_offset = 11;
+
+	MCGRectangle t_shape = MCGRectangleMake(80, 60, 470, 510);
+	MCGContextBeginWithEffects(t_context, t_shape, t_effects);
+	MCGContextSetFillRGBAColor(t_context, 0, 0.5, 1, 1);
+	MCGContextAddRectangle(t_context, t_shape);
+	MCGContextFill(t_context);
+	MCGContextEnd(t_context);
+
+	MCGContextRelease(t_context);
+
+	MCGBlurSetMaxThreadCount(0);
+	return t_pixels;
+}
+
+TEST(blur, banded_matches_serial)
+//
+// Checks that blurring with passes split across threads gives exactly the
+// same pixels as blurring on a single thread.
+//
+{
+	std::vector<uint32_t> t_serial = DrawWithEffects(1);
+	std::vector<uint32_t> t_banded = DrawWithEffects(0);
+
+	ASSERT_EQ(t_serial.size(), t_banded.size());
+	EXPECT_TRUE(t_serial == t_banded);
+
+	// Make sure the effects were drawn at all.
+	EXPECT_NE(t_serial[5 * 640 + 5], t_serial[320 * 640 + 320]);
+}
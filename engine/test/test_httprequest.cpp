@@ -0,0 +1,194 @@
+/* Copyright (C) 2003-2017 LiveCode Ltd.
+
+This file is part of LiveCode.
+
+LiveCode is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License v3 as published by the Free
+Software Foundation.
+
+LiveCode is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
+
+#include "gtest/gtest.h"
+
+#include "prefix.h"
+#include "httprequest.h"
+
+static MCHttpRequestParseStatus Parse(const char *p_request, uindex_t& r_consumed, MCArrayRef& r_request)
+{
+    MCHttpRequestParser t_parser;
+    MCHttpRequestParserReset(t_parser);
+    bool t_expect_continue;
+    return MCHttpRequestParse(t_parser, p_request, strlen(p_request), kMCHttpRequestMaxBodySize, r_consumed, t_expect_continue, r_request);
+}
+
+static bool ElementIsEqualTo(MCArrayRef p_array, const char *p_key, const char *p_value)
+{
+    MCValueRef t_value;
+    if (!MCArrayFetchValue(p_array, false, MCNAME(p_key), t_value))
+        return false;
+
+    if (MCValueGetTypeCode(t_value) == kMCValueTypeCodeData)
+        return MCDataGetLength((MCDataRef)t_value) == strlen(p_value) &&
+                memcmp(MCDataGetBytePtr((MCDataRef)t_value), p_value, strlen(p_value)) == 0;
+
+    return MCValueGetTypeCode(t_value) == kMCValueTypeCodeString &&
+            MCStringIsEqualToCString((MCStringRef)t_value, p_value, kMCStringOptionCompareExact);
+}
+
+static MCArrayRef FetchHeaders(MCArrayRef p_request)
+{
+    MCValueRef t_headers;
+    if (!MCArrayFetchValue(p_request, false, MCNAME("headers"), t_headers))
+        return kMCEmptyArray;
+    return (MCArrayRef)t_headers;
+}
+
+static bool FetchKeepAlive(MCArrayRef p_request)
+{
+    MCValueRef t_value;
+    return MCArrayFetchValue(p_request, false, MCNAME("keepalive"), t_value) &&
+            t_value == kMCTrue;
+}
+
+TEST(httprequest, simple_get)
+{
+    const char *t_text = "GET /path/file.html?a=1&b=2 HTTP/1.1\r\nHost: localhost\r\nAccept: */*\r\n\r\n";
+
+    uindex_t t_consumed;
+    MCAutoArrayRef t_request;
+    ASSERT_EQ(Parse(t_text, t_consumed, &t_request), kMCHttpRequestParseComplete);
+    EXPECT_EQ(t_consumed, strlen(t_text));
+
+    EXPECT_TRUE(ElementIsEqualTo(*t_request, "method", "GET"));
+    EXPECT_TRUE(ElementIsEqualTo(*t_request, "resource", "/path/file.html"));
+    EXPECT_TRUE(ElementIsEqualTo(*t_request, "query", "a=1&b=2"));
+    EXPECT_TRUE(ElementIsEqualTo(*t_request, "version", "HTTP/1.1"));
+    EXPECT_TRUE(ElementIsEqualTo(*t_request, "content", ""));
+    EXPECT_TRUE(ElementIsEqualTo(FetchHeaders(*t_request), "host", "localhost"));
+    EXPECT_TRUE(ElementIsEqualTo(FetchHeaders(*t_request), "Accept", "*/*"));
+    EXPECT_TRUE(FetchKeepAlive(*t_request));
+}
+
+TEST(httprequest, incomplete)
+{
+    const char *t_text = "POST /form HTTP/1.1\r\nContent-Length: 10\r\n\r\n12345";
+
+    uindex_t t_consumed;
+    MCAutoArrayRef t_request;
+    EXPECT_EQ(Parse("GET / HTTP/1.1\r\nHost: x\r\n", t_consumed, &t_request), kMCHttpRequestParseIncomplete);
+    EXPECT_EQ(Parse(t_text, t_consumed, &t_request), kMCHttpRequestParseIncomplete);
+
+    MCHttpRequestParser t_parser;
+    MCHttpRequestParserReset(t_parser);
+    bool t_expect_continue;
+    const char *t_continue = "PUT /x HTTP/1.1\r\nExpect: 100-continue\r\nContent-Length: 4\r\n\r\n";
+    EXPECT_EQ(MCHttpRequestParse(t_parser, t_continue, strlen(t_continue), kMCHttpRequestMaxBodySize, t_consumed, t_expect_continue, &t_request), kMCHttpRequestParseIncomplete);
+    EXPECT_TRUE(t_expect_continue);
+}
+
+TEST(httprequest, pipelined)
+{
+    const char *t_text = "POST /a HTTP/1.1\r\nContent-Length: 5\r\n\r\nhelloGET /b HTTP/1.0\r\n\r\n";
+
+    uindex_t t_consumed;
+    MCAutoArrayRef t_first;
+    ASSERT_EQ(Parse(t_text, t_consumed, &t_first), kMCHttpRequestParseComplete);
+    EXPECT_TRUE(ElementIsEqualTo(*t_first, "content", "hello"));
+
+    uindex_t t_second_consumed;
+    MCAutoArrayRef t_second;
+    ASSERT_EQ(Parse(t_text + t_consumed, t_second_consumed, &t_second), kMCHttpRequestParseComplete);
+    EXPECT_EQ(t_consumed + t_second_consumed, strlen(t_text));
+    EXPECT_TRUE(ElementIsEqualTo(*t_second, "resource", "/b"));
+    EXPECT_TRUE(ElementIsEqualTo(*t_second, "query", ""));
+    EXPECT_FALSE(FetchKeepAlive(*t_second));
+}
+
+TEST(httprequest, chunked)
+{
+    const char *t_text = "POST /upload HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                         "5;ext=1\r\nhello\r\n7\r\n, world\r\n0\r\nTrailer: x\r\n\r\n";
+
+    uindex_t t_consumed;
+    MCAutoArrayRef t_request;
+    ASSERT_EQ(Parse(t_text, t_consumed, &t_request), kMCHttpRequestParseComplete);
+    EXPECT_EQ(t_consumed, strlen(t_text));
+    EXPECT_TRUE(ElementIsEqualTo(*t_request, "content", "hello, world"));
+
+    MCAutoArrayRef t_partial;
+    EXPECT_EQ(Parse("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhel", t_consumed, &t_partial), kMCHttpRequestParseIncomplete);
+}
+
+TEST(httprequest, headers)
+{
+    const char *t_text = "GET / HTTP/1.1\r\nX-Folded: one\r\n  two\r\nX-List: a\r\nx-list: b\r\nConnection: close\r\n\r\n";
+
+    uindex_t t_consumed;
+    MCAutoArrayRef t_request;
+    ASSERT_EQ(Parse(t_text, t_consumed, &t_request), kMCHttpRequestParseComplete);
+    EXPECT_TRUE(ElementIsEqualTo(FetchHeaders(*t_request), "X-Folded", "one two"));
+    EXPECT_TRUE(ElementIsEqualTo(FetchHeaders(*t_request), "X-List", "a, b"));
+    EXPECT_FALSE(FetchKeepAlive(*t_request));
+}
+
+TEST(httprequest, malformed)
+{
+    uindex_t t_consumed;
+    MCAutoArrayRef t_request;
+    EXPECT_EQ(Parse("GET /\r\n\r\n", t_consumed, &t_request), kMCHttpRequestParseError);
+    EXPECT_EQ(Parse("GET / FTP/1.0\r\n\r\n", t_consumed, &t_request), kMCHttpRequestParseError);
+    EXPECT_EQ(Parse("GET / HTTP/1.1\r\nNo colon\r\n\r\n", t_consumed, &t_request), kMCHttpRequestParseError);
+    EXPECT_EQ(Parse("POST / HTTP/1.1\r\nContent-Length: x\r\n\r\n", t_consumed, &t_request), kMCHttpRequestParseError);
+    EXPECT_EQ(Parse("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n", t_consumed, &t_request), kMCHttpRequestParseError);
+}
+
+TEST(httprequest, incremental)
+{
+    const char *t_text = "\r\nPOST /upload HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: chunked\r\n\r\n"
+                         "5\r\nhello\r\n7\r\n, world\r\n0\r\n\r\n";
+
+    // Feed the request a byte at a time, as it might arrive from a socket.
+    MCHttpRequestParser t_parser;
+    MCHttpRequestParserReset(t_parser);
+    uindex_t t_length;
+    for(t_length = 0; t_length < strlen(t_text); t_length++)
+    {
+        uindex_t t_consumed;
+        bool t_expect_continue;
+        MCAutoArrayRef t_partial;
+        ASSERT_EQ(MCHttpRequestParse(t_parser, t_text, t_length, kMCHttpRequestMaxBodySize, t_consumed, t_expect_continue, &t_partial), kMCHttpRequestParseIncomplete);
+    }
+
+    uindex_t t_consumed;
+    bool t_expect_continue;
+    MCAutoArrayRef t_request;
+    ASSERT_EQ(MCHttpRequestParse(t_parser, t_text, t_length, kMCHttpRequestMaxBodySize, t_consumed, t_expect_continue, &t_request), kMCHttpRequestParseComplete);
+    EXPECT_EQ(t_consumed, strlen(t_text));
+    EXPECT_TRUE(ElementIsEqualTo(*t_request, "resource", "/upload"));
+    EXPECT_TRUE(ElementIsEqualTo(*t_request, "content", "hello, world"));
+    EXPECT_TRUE(ElementIsEqualTo(FetchHeaders(*t_request), "Host", "x"));
+}
+
+TEST(httprequest, too_large)
+{
+    MCHttpRequestParser t_parser;
+    MCHttpRequestParserReset(t_parser);
+    uindex_t t_consumed;
+    bool t_expect_continue;
+    MCAutoArrayRef t_request;
+
+    const char *t_fixed = "POST / HTTP/1.1\r\nContent-Length: 11\r\n\r\n";
+    EXPECT_EQ(MCHttpRequestParse(t_parser, t_fixed, strlen(t_fixed), 10, t_consumed, t_expect_continue, &t_request), kMCHttpRequestParseTooLarge);
+
+    const char *t_chunked = "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n6\r\nhello,\r\n5\r\n";
+    EXPECT_EQ(MCHttpRequestParse(t_parser, t_chunked, strlen(t_chunked), 10, t_consumed, t_expect_continue, &t_request), kMCHttpRequestParseTooLarge);
+
+    const char *t_limit = "POST / HTTP/1.1\r\nContent-Length: 10\r\n\r\n0123456789";
+    EXPECT_EQ(MCHttpRequestParse(t_parser, t_limit, strlen(t_limit), 10, t_consumed, t_expect_continue, &t_request), kMCHttpRequestParseComplete);
+}
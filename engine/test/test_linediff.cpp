@@ -0,0 +1,139 @@
+/* Copyright (C) 2003-2017 LiveCode Ltd.
+
+This file is part of LiveCode.
+
+LiveCode is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License v3 as published by the Free
+Software Foundation.
+
+LiveCode is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
+
+#include "gtest/gtest.h"
+
+#include "prefix.h"
+#include "linediff.h"
+
+static bool EditsAreEqualTo(const char *p_from, const char *p_to, const char *p_edits)
+{
+    MCAutoStringRef t_edits;
+    if (!MCLineDiffCompare(MCSTR(p_from), MCSTR(p_to), &t_edits))
+        return false;
+    return MCStringIsEqualToCString(*t_edits, p_edits, kMCStringOptionCompareExact);
+}
+
+// Apply a list of edits to the lines of p_from, giving the lines of the
+// result joined together. Both texts must end with a return.
+static bool ApplyEdits(MCStringRef p_from, MCStringRef p_to, MCStringRef p_edits, MCStringRef& r_result)
+{
+    MCAutoProperListRef t_from_lines, t_to_lines, t_edits;
+    if (!MCStringSplitByDelimiter(p_from, MCSTR("\n"), kMCStringOptionCompareExact, &t_from_lines) ||
+        !MCStringSplitByDelimiter(p_to, MCSTR("\n"), kMCStringOptionCompareExact, &t_to_lines) ||
+        !MCStringSplitByDelimiter(p_edits, MCSTR("\n"), kMCStringOptionCompareExact, &t_edits))
+        return false;
+
+    MCAutoStringRef t_result;
+    if (!MCStringCreateMutable(0, &t_result))
+        return false;
+
+    uindex_t t_next_line;
+    t_next_line = 0;
+    for (uindex_t i = 0; i < MCProperListGetLength(*t_edits); i++)
+    {
+        MCAutoStringRefAsCString t_edit;
+        if (!t_edit.Lock((MCStringRef)MCProperListFetchElementAtIndex(*t_edits, i)))
+            return false;
+        if ((*t_edit)[0] == '\0')
+            continue;
+
+        unsigned int t_a, t_b;
+        char t_operation;
+        if (sscanf(*t_edit, "%u,%c,%u", &t_a, &t_operation, &t_b) != 3)
+            return false;
+
+        uindex_t t_copy_to;
+        t_copy_to = t_operation == '-' ? t_a - 1 : t_a;
+        for (; t_next_line < t_copy_to; t_next_line++)
+            if (!MCStringAppendFormat(*t_result, "%@\n", MCProperListFetchElementAtIndex(*t_from_lines, t_next_line)))
+                return false;
+
+        if (t_operation == '-')
+            t_next_line++;
+        else if (!MCStringAppendFormat(*t_result, "%@\n", MCProperListFetchElementAtIndex(*t_to_lines, t_b - 1)))
+            return false;
+    }
+
+    for (; t_next_line + 1 < MCProperListGetLength(*t_from_lines); t_next_line++)
+        if (!MCStringAppendFormat(*t_result, "%@\n", MCProperListFetchElementAtIndex(*t_from_lines, t_next_line)))
+            return false;
+
+    return MCStringCopy(*t_result, r_result);
+}
+
+TEST(linediff, simple)
+{
+    EXPECT_TRUE(EditsAreEqualTo("", "", ""));
+    EXPECT_TRUE(EditsAreEqualTo("a\nb\nc\n", "a\nb\nc\n", ""));
+    EXPECT_TRUE(EditsAreEqualTo("", "a\nb\n", "0,+,1\n0,+,2\n"));
+    EXPECT_TRUE(EditsAreEqualTo("a\nb\n", "", "1,-,0\n2,-,0\n"));
+    EXPECT_TRUE(EditsAreEqualTo("a\nb\nc\n", "a\nc\n", "2,-,1\n"));
+    EXPECT_TRUE(EditsAreEqualTo("a\nc\n", "a\nb\nc\n", "1,+,2\n"));
+    EXPECT_TRUE(EditsAreEqualTo("a\nb\nc\n", "a\nx\nc\n", "2,-,1\n2,+,2\n"));
+}
+
+TEST(linediff, terminating_newline)
+{
+    EXPECT_TRUE(EditsAreEqualTo("a\nb\n", "a\nb", "2,-,1\n2,+,2\n"));
+    EXPECT_TRUE(EditsAreEqualTo("a\nb", "a\nb\nc", "2,-,1\n2,+,2\n2,+,3\n"));
+    EXPECT_TRUE(EditsAreEqualTo("a\r\nb\r\n", "a\nb\n", "1,-,0\n2,-,0\n2,+,1\n2,+,2\n"));
+}
+
+TEST(linediff, unicode)
+{
+    // Lines compare equal whether they are stored as native or unicode chars.
+    static const unichar_t kTo[] = {'c', 'a', 'f', 0xe9, '\n', 'x', '\n', 0x2603, '\n'};
+
+    MCAutoStringRef t_from, t_to;
+    ASSERT_TRUE(MCStringCreateWithNativeChars((const char_t *)"caf\xe9\nx\n", 7, &t_from));
+    ASSERT_TRUE(MCStringCreateWithChars(kTo, sizeof(kTo) / sizeof(kTo[0]), &t_to));
+
+    MCAutoStringRef t_edits;
+    ASSERT_TRUE(MCLineDiffCompare(*t_from, *t_to, &t_edits));
+    EXPECT_TRUE(MCStringIsEqualToCString(*t_edits, "2,+,3\n", kMCStringOptionCompareExact));
+}
+
+TEST(linediff, large)
+{
+    // Two texts of 20000 lines, the second having every seventh line
+    // removed, every eleventh changed and a block of repeated lines added.
+    MCAutoStringRef t_from, t_to;
+    ASSERT_TRUE(MCStringCreateMutable(0, &t_from));
+    ASSERT_TRUE(MCStringCreateMutable(0, &t_to));
+    for (uindex_t i = 0; i < 20000; i++)
+    {
+        ASSERT_TRUE(MCStringAppendFormat(*t_from, "line %u\n", i % 5000));
+        if (i % 7 == 0)
+            continue;
+        if (i % 11 == 0)
+            ASSERT_TRUE(MCStringAppendFormat(*t_to, "changed %u\n", i));
+        else
+            ASSERT_TRUE(MCStringAppendFormat(*t_to, "line %u\n", i % 5000));
+        if (i == 10000)
+        {
+            for (uindex_t j = 0; j < 200; j++)
+                ASSERT_TRUE(MCStringAppend(*t_to, MCSTR("}\n")));
+        }
+    }
+
+    MCAutoStringRef t_edits;
+    ASSERT_TRUE(MCLineDiffCompare(*t_from, *t_to, &t_edits));
+
+    MCAutoStringRef t_result;
+    ASSERT_TRUE(ApplyEdits(*t_from, *t_to, *t_edits, &t_result));
+    EXPECT_TRUE(MCStringIsEqualTo(*t_result, *t_to, kMCStringOptionCompareExact));
+}
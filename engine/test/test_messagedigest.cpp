@@ -0,0 +1,238 @@
+/* Copyright (C) 2003-2017 LiveCode Ltd.
+
+This file is part of LiveCode.
+
+LiveCode is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License v3 as published by the Free
+Software Foundation.
+
+LiveCode is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
+
+#include "gtest/gtest.h"
+
+#include "prefix.h"
+#include "system.h"
+#include "mcmessagedigest.h"
+
+static bool DigestIsEqualTo(MCDataRef p_digest, const char *p_hex)
+{
+    size_t t_length = strlen(p_hex) / 2;
+    if (MCDataGetLength(p_digest) != t_length)
+        return false;
+
+    for (size_t i = 0; i < t_length; i++)
+    {
+        unsigned int t_byte;
+        if (sscanf(p_hex + i * 2, "%2x", &t_byte) != 1 ||
+            MCDataGetByteAtIndex(p_digest, i) != t_byte)
+            return false;
+    }
+    return true;
+}
+
+static void Digest(const char *p_algorithm, const char *p_message, MCDataRef& r_digest)
+{
+    MCMessageDigestRef t_digest;
+    ASSERT_TRUE(MCMessageDigestCreate(MCSTR(p_algorithm), t_digest));
+    MCMessageDigestUpdate(t_digest, (const byte_t *)p_message, strlen(p_message));
+    ASSERT_TRUE(MCMessageDigestCopyDigest(t_digest, r_digest));
+    MCMessageDigestDestroy(t_digest);
+}
+
+TEST(messagedigest, known_answers)
+{
+    const char *t_message = "abc";
+
+    MCAutoDataRef t_md5, t_sha1, t_sha256, t_sha512, t_sha3;
+    Digest("MD5", t_message, &t_md5);
+    Digest("sha-1", t_message, &t_sha1);
+    Digest("SHA-256", t_message, &t_sha256);
+    Digest("sha-512", t_message, &t_sha512);
+    Digest("sha3-256", t_message, &t_sha3);
+
+    EXPECT_TRUE(DigestIsEqualTo(*t_md5, "900150983cd24fb0d6963f7d28e17f72"));
+    EXPECT_TRUE(DigestIsEqualTo(*t_sha1, "a9993e364706816aba3e25717850c26c9cd0d89d"));
+    EXPECT_TRUE(DigestIsEqualTo(*t_sha256, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+    EXPECT_TRUE(DigestIsEqualTo(*t_sha512, "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+                                           "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f"));
+    EXPECT_TRUE(DigestIsEqualTo(*t_sha3, "3a985da74fe225b2045c172d6bd390bd855f086e3e9d525b46bfe24511431532"));
+}
+
+TEST(messagedigest, unknown_algorithm)
+{
+    MCMessageDigestRef t_digest;
+    EXPECT_FALSE(MCMessageDigestCreate(MCSTR("sha-999"), t_digest));
+}
+
+TEST(messagedigest, incremental)
+{
+    const char *t_message = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+
+    MCMessageDigestRef t_digest;
+    ASSERT_TRUE(MCMessageDigestCreate(MCSTR("sha-256"), t_digest));
+
+    /* Taking the digest part way through must not disturb the state */
+    MCMessageDigestUpdate(t_digest, (const byte_t *)t_message, 5);
+    MCAutoDataRef t_partial;
+    ASSERT_TRUE(MCMessageDigestCopyDigest(t_digest, &t_partial));
+    for (const char *t_char = t_message + 5; *t_char != '\0'; t_char++)
+        MCMessageDigestUpdate(t_digest, (const byte_t *)t_char, 1);
+
+    MCAutoDataRef t_result;
+    ASSERT_TRUE(MCMessageDigestCopyDigest(t_digest, &t_result));
+    MCMessageDigestDestroy(t_digest);
+
+    MCAutoDataRef t_prefix;
+    Digest("sha-256", "abcdb", &t_prefix);
+    EXPECT_TRUE(MCDataIsEqualTo(*t_partial, *t_prefix));
+    EXPECT_TRUE(DigestIsEqualTo(*t_result, "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"));
+}
+
+TEST(messagedigest, multiple)
+{
+    /* Enough messages of varied lengths to fill every lane of the
+     * multi-buffer kernel several times over, including messages
+     * needing one and two padding blocks. */
+    const uindex_t kCount = 23;
+    byte_t t_buffer[300];
+    for (size_t i = 0; i < sizeof(t_buffer); i++)
+        t_buffer[i] = byte_t(i * 7 + 1);
+
+    const byte_t *t_messages[kCount];
+    size_t t_lengths[kCount];
+    for (uindex_t i = 0; i < kCount; i++)
+    {
+        t_messages[i] = t_buffer + i;
+        t_lengths[i] = (i * 29) % 200;
+    }
+
+    const char *t_algorithms[] = { "sha-224", "sha-256", "md5", "sha3-384" };
+    for (const char *t_algorithm : t_algorithms)
+    {
+        MCDataRef t_digests[kCount];
+        ASSERT_TRUE(MCMessageDigestComputeMultiple(MCSTR(t_algorithm), kCount,
+                                                   t_messages, t_lengths, t_digests));
+
+        for (uindex_t i = 0; i < kCount; i++)
+        {
+            MCMessageDigestRef t_digest;
+            ASSERT_TRUE(MCMessageDigestCreate(MCSTR(t_algorithm), t_digest));
+            MCMessageDigestUpdate(t_digest, t_messages[i], t_lengths[i]);
+            MCAutoDataRef t_expected;
+            ASSERT_TRUE(MCMessageDigestCopyDigest(t_digest, &t_expected));
+            MCMessageDigestDestroy(t_digest);
+
+            EXPECT_TRUE(MCDataIsEqualTo(t_digests[i], *t_expected)) << t_algorithm << " " << i;
+            MCValueRelease(t_digests[i]);
+        }
+    }
+}
+
+/* Reads as the stdio file handle does, failing when fewer bytes than
+ * requested are read, rather than as a mapped file does. */
+class ShortReadFailsFileHandle: public MCMemoryFileHandle
+{
+public:
+    ShortReadFailsFileHandle(const void *p_data, size_t p_length)
+        : MCMemoryFileHandle(p_data, p_length)
+    {
+    }
+
+    bool Read(void *p_buffer, uint32_t p_length, uint32_t& r_read)
+    {
+        MCMemoryFileHandle::Read(p_buffer, p_length, r_read);
+        return r_read == p_length;
+    }
+};
+
+/* Fails to read without reaching the end, as on a read error. */
+class ReadErrorFileHandle: public MCMemoryFileHandle
+{
+public:
+    ReadErrorFileHandle(void)
+        : MCMemoryFileHandle("", 0)
+    {
+    }
+
+    bool Read(void *p_buffer, uint32_t p_length, uint32_t& r_read)
+    {
+        r_read = 0;
+        return false;
+    }
+
+    bool IsExhausted(void)
+    {
+        return false;
+    }
+};
+
+static void DigestStream(IO_handle p_stream, MCDataRef& r_digest)
+{
+    MCMessageDigestRef t_digest;
+    ASSERT_TRUE(MCMessageDigestCreate(MCSTR("sha-256"), t_digest));
+    EXPECT_TRUE(MCMessageDigestUpdateWithStream(t_digest, p_stream));
+    ASSERT_TRUE(MCMessageDigestCopyDigest(t_digest, r_digest));
+    MCMessageDigestDestroy(t_digest);
+}
+
+TEST(messagedigest, stream)
+{
+    /* More than one chunk, with a short final chunk. */
+    const size_t kLength = 1024 * 1024 + 3;
+    MCAutoArray<byte_t> t_buffer;
+    ASSERT_TRUE(t_buffer.New(kLength));
+    for (size_t i = 0; i < kLength; i++)
+        t_buffer[i] = byte_t(i * 13);
+
+    MCMessageDigestRef t_digest;
+    ASSERT_TRUE(MCMessageDigestCreate(MCSTR("sha-256"), t_digest));
+    MCMessageDigestUpdate(t_digest, t_buffer.Ptr(), kLength);
+    MCAutoDataRef t_expected;
+    ASSERT_TRUE(MCMessageDigestCopyDigest(t_digest, &t_expected));
+    MCMessageDigestDestroy(t_digest);
+
+    MCMemoryFileHandle t_mapped(t_buffer.Ptr(), kLength);
+    MCAutoDataRef t_mapped_digest;
+    DigestStream(&t_mapped, &t_mapped_digest);
+    EXPECT_TRUE(MCDataIsEqualTo(*t_mapped_digest, *t_expected));
+
+    ShortReadFailsFileHandle t_stdio(t_buffer.Ptr(), kLength);
+    MCAutoDataRef t_stdio_digest;
+    DigestStream(&t_stdio, &t_stdio_digest);
+    EXPECT_TRUE(MCDataIsEqualTo(*t_stdio_digest, *t_expected));
+
+    ShortReadFailsFileHandle t_small("abc", 3);
+    MCAutoDataRef t_small_digest;
+    DigestStream(&t_small, &t_small_digest);
+    EXPECT_TRUE(DigestIsEqualTo(*t_small_digest, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+}
+
+TEST(messagedigest, stream_empty)
+{
+    const char *kEmptySha256 = "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855";
+
+    MCMemoryFileHandle t_mapped("", 0);
+    MCAutoDataRef t_mapped_digest;
+    DigestStream(&t_mapped, &t_mapped_digest);
+    EXPECT_TRUE(DigestIsEqualTo(*t_mapped_digest, kEmptySha256));
+
+    ShortReadFailsFileHandle t_stdio("", 0);
+    MCAutoDataRef t_stdio_digest;
+    DigestStream(&t_stdio, &t_stdio_digest);
+    EXPECT_TRUE(DigestIsEqualTo(*t_stdio_digest, kEmptySha256));
+}
+
+TEST(messagedigest, stream_error)
+{
+    MCMessageDigestRef t_digest;
+    ASSERT_TRUE(MCMessageDigestCreate(MCSTR("sha-256"), t_digest));
+    ReadErrorFileHandle t_stream;
+    EXPECT_FALSE(MCMessageDigestUpdateWithStream(t_digest, &t_stream));
+    MCMessageDigestDestroy(t_digest);
+}
@@ -0,0 +1,236 @@
+/* Copyright (C) 2017 LiveCode Ltd.
+
+This file is part of LiveCode.
+
+LiveCode is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License v3 as published by the Free
+Software Foundation.
+
+LiveCode is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
+
+#include "gtest/gtest.h"
+
+#include "prefix.h"
+#include "pixelkernels.h"
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+// Straightforward per-channel versions of the kernels to check against.
+static uint32_t ReferencePremultiply(uint32_t p_pixel)
+{
+	uint32_t t_alpha = p_pixel >> 24;
+	uint32_t t_result = t_alpha << 24;
+	for (int s = 0; s < 24; s += 8)
+	{
+		uint32_t t_value = ((p_pixel >> s) & 0xFF) * t_alpha + 0x80;
+		t_result |= ((t_value + (t_value >> 8)) >> 8) << s;
+	}
+	return t_result;
+}
+
+static uint32_t ReferenceUnpremultiply(uint32_t p_pixel)
+{
+	uint32_t t_alpha = p_pixel >> 24;
+	if (t_alpha == 0)
+		return 0;
+	uint32_t t_result = t_alpha << 24;
+	for (int s = 0; s < 24; s += 8)
+		t_result |= ((((p_pixel >> s) & 0xFF) * 255 / t_alpha) & 0xFF) << s;
+	return t_result;
+}
+
+// Fill a buffer with pixels covering every alpha value, with a mixture of
+// valid and invalid premultiplied color values.
+static std::vector<uint32_t> TestPixels(uindex_t p_count)
+{
+	std::vector<uint32_t> t_pixels(p_count);
+	uint32_t t_seed = 12345;
+	for (uindex_t i = 0; i < p_count; i++)
+	{
+		t_seed = t_seed * 1103515245 + 12345;
+		t_pixels[i] = (t_seed >> 8) ^ (uint32_t(i) << 24);
+	}
+	return t_pixels;
+}
+
+TEST(pixelkernels, premultiply)
+{
+	// Odd lengths and offsets exercise every combination of vector and
+	// scalar code.
+	std::vector<uint32_t> t_src = TestPixels(256 * 64 + 7);
+	for (uindex_t t_offset = 0; t_offset < 9; t_offset++)
+	{
+		uindex_t t_count = t_src.size() - t_offset;
+		std::vector<uint32_t> t_dst(t_count);
+		MCPixelRowPremultiply(t_src.data() + t_offset, t_dst.data(), t_count);
+		for (uindex_t i = 0; i < t_count; i++)
+			ASSERT_EQ(ReferencePremultiply(t_src[t_offset + i]), t_dst[i]) << "pixel " << i;
+	}
+}
+
+TEST(pixelkernels, unpremultiply)
+{
+	std::vector<uint32_t> t_src = TestPixels(256 * 64 + 7);
+	for (uindex_t t_offset = 0; t_offset < 9; t_offset++)
+	{
+		uindex_t t_count = t_src.size() - t_offset;
+		std::vector<uint32_t> t_dst(t_count);
+		MCPixelRowUnpremultiply(t_src.data() + t_offset, t_dst.data(), t_count);
+		for (uindex_t i = 0; i < t_count; i++)
+			ASSERT_EQ(ReferenceUnpremultiply(t_src[t_offset + i]), t_dst[i]) << "pixel " << i;
+	}
+}
+
+TEST(pixelkernels, unpremultiply_exhaustive)
+{
+	// Every valid premultiplied channel value for every alpha.
+	std::vector<uint32_t> t_src;
+	for (uint32_t a = 0; a < 256; a++)
+		for (uint32_t c = 0; c <= a; c++)
+			t_src.push_back((a << 24) | (c << 16) | ((a - c) << 8) | (c / 2));
+
+	std::vector<uint32_t> t_dst(t_src.size());
+	MCPixelRowUnpremultiply(t_src.data(), t_dst.data(), t_src.size());
+	for (uindex_t i = 0; i < t_src.size(); i++)
+		ASSERT_EQ(ReferenceUnpremultiply(t_src[i]), t_dst[i]) << "pixel " << i;
+
+	// Premultiplying in place and back gives the original opaque pixels.
+	std::vector<uint32_t> t_opaque = TestPixels(1001);
+	for (uint32_t& t_pixel : t_opaque)
+		t_pixel |= 0xFF000000;
+	std::vector<uint32_t> t_round_trip(t_opaque);
+	MCPixelRowPremultiply(t_round_trip.data(), t_round_trip.data(), t_round_trip.size());
+	MCPixelRowUnpremultiply(t_round_trip.data(), t_round_trip.data(), t_round_trip.size());
+	EXPECT_EQ(t_opaque, t_round_trip);
+}
+
+TEST(pixelkernels, swizzle)
+{
+	const MCGPixelFormat t_formats[] =
+		{ kMCGPixelFormatBGRA, kMCGPixelFormatRGBA, kMCGPixelFormatABGR, kMCGPixelFormatARGB };
+
+	std::vector<uint32_t> t_src = TestPixels(1037);
+	for (MCGPixelFormat t_src_format : t_formats)
+		for (MCGPixelFormat t_dst_format : t_formats)
+		{
+			std::vector<uint32_t> t_dst(t_src.size());
+			MCPixelRowSwizzle(t_src.data(), t_src_format, t_dst.data(), t_dst_format, t_src.size());
+			for (uindex_t i = 0; i < t_src.size(); i++)
+			{
+				uint8_t r, g, b, a;
+				MCGPixelUnpack(t_src_format, t_src[i], r, g, b, a);
+				ASSERT_EQ(MCGPixelPack(t_dst_format, r, g, b, a), t_dst[i])
+					<< "formats " << t_src_format << " " << t_dst_format << " pixel " << i;
+			}
+		}
+}
+
+TEST(pixelkernels, copy_with_masks)
+{
+	std::vector<uint32_t> t_src(1031, 0x80402010);
+	t_src[1030] = 0x01000000;
+
+	std::vector<uint32_t> t_dst(t_src.size());
+	uint32_t t_or = 0, t_and = 0xFFFFFFFF;
+	MCPixelRowCopyWithMasks(t_src.data(), t_dst.data(), t_src.size(), t_or, t_and);
+	EXPECT_EQ(t_src, t_dst);
+	EXPECT_EQ(0x81402010u, t_or);
+	EXPECT_EQ(0x00000000u, t_and);
+
+	t_or = 0, t_and = 0xFFFFFFFF;
+	MCPixelRowCopyWithMasks(t_src.data(), nil, 1030, t_or, t_and);
+	EXPECT_EQ(0x80402010u, t_or);
+	EXPECT_EQ(0x80402010u, t_and);
+}
+
+TEST(pixelkernels, scale)
+{
+	// Scaling a constant image gives the same constant.
+	std::vector<uint32_t> t_src(37 * 23, 0xC0804020);
+	std::vector<uint32_t> t_dst(101 * 11);
+	MCPixelScaleBilinear(t_src.data(), 37 * 4, 37, 23, t_dst.data(), 101 * 4, 101, 11);
+	for (uint32_t t_pixel : t_dst)
+		ASSERT_EQ(0xC0804020u, t_pixel);
+
+	// Scaling by a whole factor with nearest picks the top-left pixels.
+	for (uindex_t i = 0; i < t_src.size(); i++)
+		t_src[i] = i;
+	std::vector<uint32_t> t_half(18 * 11);
+	MCPixelScaleNearest(t_src.data(), 37 * 4, 36, 22, t_half.data(), 18 * 4, 18, 11);
+	for (uindex_t y = 0; y < 11; y++)
+		for (uindex_t x = 0; x < 18; x++)
+			ASSERT_EQ(y * 2 * 37 + x * 2, t_half[y * 18 + x]);
+}
+
+TEST(pixelkernels, dither_alpha)
+{
+	std::vector<uint32_t> t_pixels(64 * 64);
+	for (uindex_t i = 0; i < t_pixels.size(); i++)
+		t_pixels[i] = (uint32_t((i % 64) * 4) << 24) | 0x123456;
+
+	ASSERT_TRUE(MCPixelDitherAlpha(t_pixels.data(), 64 * 4, 64, 64));
+
+	// Every pixel is fully opaque or fully transparent, the color is kept
+	// and the proportion of opaque pixels follows the original alpha.
+	uindex_t t_opaque_left = 0, t_opaque_right = 0;
+	for (uindex_t i = 0; i < t_pixels.size(); i++)
+	{
+		uint32_t t_alpha = t_pixels[i] >> 24;
+		ASSERT_TRUE(t_alpha == 0 || t_alpha == 255);
+		ASSERT_EQ(0x123456u, t_pixels[i] & 0xFFFFFF);
+		if (t_alpha == 255)
+			(i % 64 < 32 ? t_opaque_left : t_opaque_right) += 1;
+	}
+	EXPECT_LT(t_opaque_left, t_opaque_right);
+}
+
+// Measure the throughput of each kernel over a 1024x1024 image. This is a
+// benchmark rather than a test: it fails only if a kernel is broken badly
+// enough to process nothing.
+TEST(pixelkernels, throughput)
+{
+	const uindex_t kWidth = 1024;
+	const uindex_t kHeight = 1024;
+	const int kRepeatCount = 10;
+
+	std::vector<uint32_t> t_src = TestPixels(kWidth * kHeight);
+	std::vector<uint32_t> t_dst(kWidth * kHeight);
+
+	auto t_measure = [&](const char *p_name, uindex_t p_pixels, std::function<void()> p_kernel)
+	{
+		auto t_start = std::chrono::steady_clock::now();
+		for (int i = 0; i < kRepeatCount; i++)
+			p_kernel();
+		std::chrono::duration<double> t_elapsed = std::chrono::steady_clock::now() - t_start;
+
+		double t_rate = p_pixels * kRepeatCount / t_elapsed.count() / 1e6;
+		printf("[ PIXELS   ] %-12s %8.1f Mpixel/s\n", p_name, t_rate);
+		RecordProperty(p_name, int(t_rate));
+		EXPECT_GT(t_rate, 0.0);
+	};
+
+	t_measure("premultiply", kWidth * kHeight, [&] {
+		MCPixelRowPremultiply(t_src.data(), t_dst.data(), t_src.size()); });
+	t_measure("unpremultiply", kWidth * kHeight, [&] {
+		MCPixelRowUnpremultiply(t_src.data(), t_dst.data(), t_src.size()); });
+	t_measure("swizzle", kWidth * kHeight, [&] {
+		MCPixelRowSwizzle(t_src.data(), kMCGPixelFormatBGRA, t_dst.data(), kMCGPixelFormatARGB, t_src.size()); });
+	t_measure("copy", kWidth * kHeight, [&] {
+		uint32_t t_or = 0, t_and = 0xFFFFFFFF;
+		MCPixelRowCopyWithMasks(t_src.data(), t_dst.data(), t_src.size(), t_or, t_and); });
+	t_measure("nearest", kWidth * kHeight, [&] {
+		MCPixelScaleNearest(t_src.data(), kWidth * 4, kWidth / 2, kHeight / 2, t_dst.data(), kWidth * 4, kWidth, kHeight); });
+	t_measure("bilinear", kWidth * kHeight, [&] {
+		MCPixelScaleBilinear(t_src.data(), kWidth * 4, kWidth / 2, kHeight / 2, t_dst.data(), kWidth * 4, kWidth, kHeight); });
+	t_measure("dither", kWidth * kHeight, [&] {
+		MCPixelDitherAlpha(t_dst.data(), kWidth * 4, kWidth, kHeight); });
+}
@@ -217,6 +217,7 @@ public:
 
 class MCTextChunkIterator_Delimited : public MCTextChunkIterator
 {
+protected:
     // store the number of codeunits matched in text when searching for
     //  delimiter, so that we can increment the range appropriately.
     uindex_t m_delimiter_length;
@@ -284,6 +285,37 @@ public:
     virtual bool Next();
 };
 
+struct MCSystemFileHandle;
+
+// Iterates over the lines or items of a text file, decoding it a block at a
+// time so that only the current block and chunk are held in memory. The
+// iterator owns (and closes) the stream.
+class MCTextChunkIterator_File : public MCTextChunkIterator_Delimited
+{
+    MCSystemFileHandle *m_stream;
+    intenum_t m_encoding;
+    bool m_at_end;
+    bool m_pending_return;
+    bool m_failed;
+    // The offset in the window from which the search for the next
+    // delimiter resumes after a refill.
+    uindex_t m_search_offset;
+    
+    bool Refill(uindex_t p_consumed);
+public:
+    MCTextChunkIterator_File(MCSystemFileHandle *p_stream, intenum_t p_encoding, MCChunkType p_chunk_type, MCStringRef p_delimiter);
+    ~MCTextChunkIterator_File();
+    
+    // Returns true if Next() returned false because the file could not be
+    // read.
+    bool HasFailed() const
+    {
+        return m_failed;
+    }
+    
+    virtual bool Next();
+};
+
 MCTextChunkIterator *MCChunkCreateTextChunkIterator(MCStringRef p_text, MCRange *p_range, MCChunkType p_chunk_type, MCStringRef p_line_delimiter, MCStringRef p_item_delimiter, MCStringOptions p_options);
 
 MCChunkType MCChunkTypeSimplify(MCStringRef p_string, MCChunkType p_type);
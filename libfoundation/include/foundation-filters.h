@@ -35,4 +35,50 @@ bool MCFiltersUrlDecode(MCStringRef p_source, MCStringRef& r_result);
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Compression levels range from 0 (store only) to 9 (smallest output), as in
+// zlib. The default level is that used by MCFiltersCompress.
+#define kMCFiltersCompressionLevelDefault -1
+#define kMCFiltersCompressionLevelMax 9
+
+extern "C" {
+
+// Percent-encode p_length bytes, as MCFiltersUrlEncode does with the UTF-8
+// bytes of its source.
+MC_DLLEXPORT bool MCFiltersUrlEncodeBytes(const byte_t *p_bytes, uindex_t p_length, MCStringRef& r_result);
+
+// Decode p_length percent-encoded chars, as MCFiltersUrlDecode does, creating
+// the result from the decoded bytes in the given encoding.
+MC_DLLEXPORT bool MCFiltersUrlDecodeChars(const char_t *p_chars, uindex_t p_length, MCStringEncoding p_encoding, MCStringRef& r_result);
+
+// Compress p_source in gzip format at the given level, on the calling thread.
+MC_DLLEXPORT bool MCFiltersCompressWithLevel(MCDataRef p_source, int p_level, MCDataRef& r_result);
+
+// Compress p_source as MCFiltersCompressWithLevel does, but using up to
+// p_max_threads threads (0 meaning one per processor). Large inputs are split
+// into blocks which are deflated on several threads at once - the result is
+// still a single gzip member, so can be decompressed by any gzip reader. If no
+// threads can be started the blocks are deflated on the calling thread.
+MC_DLLEXPORT bool MCFiltersCompressWithLevelAndThreads(MCDataRef p_source, int p_level, uindex_t p_max_threads, MCDataRef& r_result);
+
+// Compress p_length bytes in zlib format at the given level, using up to
+// p_max_threads threads in the same way as
+// MCFiltersCompressWithLevelAndThreads.
+MC_DLLEXPORT bool MCFiltersZlibCompressBytes(const byte_t *p_bytes, uindex_t p_length, int p_level, uindex_t p_max_threads, MCDataRef& r_result);
+
+// Create a write-only stream which compresses the data written to it in gzip
+// format at the given level, writing the compressed data to p_target as it is
+// produced. Once all the data has been written, MCFiltersCompressStreamFinish
+// flushes the remaining output and writes the gzip trailer - releasing the
+// stream without finishing it leaves the output incomplete.
+MC_DLLEXPORT bool MCFiltersCompressStreamCreate(MCStreamRef p_target, int p_level, MCStreamRef& r_stream);
+MC_DLLEXPORT bool MCFiltersCompressStreamFinish(MCStreamRef p_stream);
+
+// Create a read-only stream which decompresses the gzip data read from
+// p_source. Concatenated gzip members are decompressed in sequence.
+MC_DLLEXPORT bool MCFiltersDecompressStreamCreate(MCStreamRef p_source, MCStreamRef& r_stream);
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 #endif
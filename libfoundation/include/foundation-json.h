@@ -0,0 +1,43 @@
+/* Copyright (C) 2003-2015 LiveCode Ltd.
+
+ This file is part of LiveCode.
+
+ LiveCode is free software; you can redistribute it and/or modify it under
+ the terms of the GNU General Public License v3 as published by the Free
+ Software Foundation.
+
+ LiveCode is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
+
+#ifndef __MC_FOUNDATION_JSON__
+#define __MC_FOUNDATION_JSON__
+
+#ifndef __MC_FOUNDATION__
+#include <foundation.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+extern "C" {
+
+// Parse the JSON text p_json (RFC 7159), returning the first top-level value.
+// JSON objects become arrays, JSON arrays become proper lists, numbers become
+// (real) numbers and null becomes kMCNull. If the text is not well-formed, a
+// generic error describing the problem and its location is thrown.
+MC_DLLEXPORT bool MCJSONImport(MCStringRef p_json, MCValueRef& r_value);
+
+// Format p_value as JSON text. The value may be a string, number, boolean,
+// proper list, array or null - if it (or any value it contains) is of any
+// other type, a generic error is thrown.
+MC_DLLEXPORT bool MCJSONExport(MCValueRef p_value, MCStringRef& r_json);
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif
@@ -2339,6 +2339,11 @@ MC_DLLEXPORT const char_t *MCStringGetNativeCharPtr(MCStringRef string);
 // The native length may be different from the string char count.
 MC_DLLEXPORT const char_t *MCStringGetNativeCharPtrAndLength(MCStringRef self, uindex_t& r_native_length);
 
+// Return a pointer to the UTF-8 backing-store if the string is held as UTF-8.
+// Strings created from long UTF-8 text are held this way until their chars are
+// needed; if the method returns nil, the string must be converted instead.
+MC_DLLEXPORT const byte_t *MCStringGetUTF8BytePtrAndLength(MCStringRef self, uindex_t& r_byte_count);
+
 // Returns the Unicode codepoint at the given index
 MC_DLLEXPORT codepoint_t MCStringGetCodepointAtIndex(MCStringRef string, uindex_t index);
 
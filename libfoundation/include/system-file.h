@@ -111,10 +111,21 @@ enum MCSFileOpenMode
 
 MC_DLLEXPORT bool MCSFileCreateStream(MCStringRef p_filename, intenum_t p_mode, MCStreamRef& r_stream);
 
+/* Create a read-only stream over the contents of a file, which is
+ * mapped into memory rather than read.  The stream supports skipping,
+ * marking, resetting and seeking to any position within the file.
+ * The file must not be truncated while the stream exists. */
+MC_DLLEXPORT bool MCSFileCreateMappedStream(MCStringRef p_filename, MCStreamRef& r_stream);
+
 #ifdef __MCS_INTERNAL_API__
 
 bool __MCSFileCreateStream (MCStringRef p_native_path, intenum_t p_mode, MCStreamRef & r_stream);
 
+/* Map the whole of a file into memory read-only.  An empty file gives
+ * a nil base and zero length. */
+bool __MCSFileMap (MCStringRef p_native_path, const void *& r_base, size_t & r_length);
+void __MCSFileUnmap (const void *p_base, size_t p_length);
+
 #endif
 
 /* ================================================================
@@ -34,6 +34,11 @@ MC_DLLEXPORT bool MCSStreamGetStandardError(MCStreamRef & r_stderr);
 
 bool __MCSStreamCreateWithStdio (FILE *, MCStreamRef & r_stream);
 
+/* Create a stream for a stdio stream which is known to be open on a
+ * file.  As well as the operations supported by all stdio streams,
+ * the stream can be skipped, marked and reset. */
+bool __MCSStreamCreateWithStdioFile (FILE *, MCStreamRef & r_stream);
+
 #endif
 
 /* ================================================================
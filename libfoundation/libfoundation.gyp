@@ -5,6 +5,7 @@
 		'module_test_dependencies':
 		[
 			'libFoundation',
+			'../prebuilt/thirdparty.gyp:thirdparty_prebuilt_z',
 		],
         'module_test_include_dirs':
         [
@@ -16,12 +17,15 @@
 			'test/environment.cpp',
             'test/test_foreign.cpp',
 			'test/test_hash.cpp',
+			'test/test_filters.cpp',
+			'test/test_json.cpp',
             'test/test_memory.cpp',
             'test/test_name.cpp',
 			'test/test_proper-list.cpp',
 			'test/test_string.cpp',
 			'test/test_typeconvert.cpp',
             'test/test_system-library.cpp',
+            'test/test_system-file.cpp',
 		],
 	},
 
@@ -65,6 +69,7 @@
 				'include/foundation-chunk.h',
 				'include/foundation-filters.h',
 				'include/foundation-inline.h',
+				'include/foundation-json.h',
 				'include/foundation-locale.h',
 				'include/foundation-math.h',
 				'include/foundation-objc.h',
@@ -101,6 +106,7 @@
 				'src/foundation-java-private.cpp',
 				'src/foundation-java-private.h',
 				'src/foundation-handler.cpp',
+				'src/foundation-json.cpp',
 				'src/foundation-list.cpp',
 				'src/foundation-locale.cpp',
 				'src/foundation-math.cpp',
@@ -342,6 +348,15 @@
 							],
 						},
 					],
+					[
+						'OS == "linux"',
+						{
+							'libraries':
+							[
+								'-lpthread',
+							],
+						},
+					],
 					[
 						'OS == "win"',
 						{
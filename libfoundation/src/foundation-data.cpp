@@ -180,7 +180,10 @@ bool MCDataConvertStringToData(MCStringRef string, MCDataRef& r_data)
     if (!MCStringNativeCopy(string, t_native_copy))
         return false;
 
-    if (t_native_copy -> references != 1 || MCStringIsMutable(t_native_copy))
+    // The chars can only be taken if nothing else references them (which is
+    // never the case for a slice).
+    if (t_native_copy -> references != 1 || MCStringIsMutable(t_native_copy) ||
+        (t_native_copy -> flags & kMCStringFlagIsSlice) != 0)
     {
         uindex_t t_native_length;
         const byte_t *t_data = (const byte_t *)MCStringGetNativeCharPtrAndLength(t_native_copy, t_native_length);
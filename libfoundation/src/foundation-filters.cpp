@@ -17,22 +17,155 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #include <foundation.h>
 
 #include "foundation-auto.h"
+#include "foundation-filters.h"
 #include "foundation-private.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 
-inline uint8_t isvalid(uint8_t x)
+// The SSSE3 base64 kernels are compiled for x86 whatever the baseline
+// instruction set, and used if the processor supports them.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <tmmintrin.h>
+#define MCFILTERS_SSSE3
+#define MCFILTERS_SSSE3_TARGET __attribute__((target("ssse3")))
+
+static bool MCFiltersHasSSSE3(void)
+{
+    static const bool s_has_ssse3 = __builtin_cpu_supports("ssse3");
+    return s_has_ssse3;
+}
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+static const char_t kMCFiltersBase64Chars[64] =
+{
+	'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M',
+	'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z',
+	'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm',
+	'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z',
+	'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/',
+};
+
+// The value of each base64 char, or 0xff if the char is not one.
+static const uint8_t kMCFiltersBase64Values[256] =
+{
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+	0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+	0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+	0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+#if defined(MCFILTERS_SSSE3)
+// Decode 16 base64 chars to 12 bytes, writing 16 bytes to p_dst. Returns
+// false if any of the chars is not a base64 char.
+MCFILTERS_SSSE3_TARGET
+static inline bool MCFiltersBase64DecodeBlockSSSE3(const char_t *p_src, byte_t *p_dst)
+{
+	__m128i t_input;
+	t_input = _mm_loadu_si128((const __m128i *)p_src);
+
+	// Classify each char by its high and low nibbles - the chars in each
+	// high nibble row which are valid are given by a bit in the mask for the
+	// low nibble.
+	const __m128i t_nibble_mask = _mm_set1_epi8(0x0f);
+	__m128i t_high, t_low;
+	t_high = _mm_and_si128(_mm_srli_epi32(t_input, 4), t_nibble_mask);
+	t_low = _mm_and_si128(t_input, t_nibble_mask);
+
+	const __m128i t_row_masks = _mm_setr_epi8(
+		(char)0xa8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8,
+		(char)0xf8, (char)0xf8, (char)0xf0, 0x54, 0x50, 0x50, 0x50, 0x54);
+	const __m128i t_row_bits = _mm_setr_epi8(
+		0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80, 0, 0, 0, 0, 0, 0, 0, 0);
+	__m128i t_invalid;
+	t_invalid = _mm_cmpeq_epi8(_mm_and_si128(_mm_shuffle_epi8(t_row_masks, t_low),
+	                                         _mm_shuffle_epi8(t_row_bits, t_high)),
+	                           _mm_setzero_si128());
+	if (_mm_movemask_epi8(t_invalid) != 0)
+		return false;
+
+	// Map the chars to their values - the offset depends on the high nibble,
+	// except for '/' which shares its row with '+'.
+	const __m128i t_offsets = _mm_setr_epi8(
+		0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	__m128i t_is_slash, t_offset;
+	t_is_slash = _mm_cmpeq_epi8(t_input, _mm_set1_epi8('/'));
+	t_offset = _mm_or_si128(_mm_andnot_si128(t_is_slash, _mm_shuffle_epi8(t_offsets, t_high)),
+	                        _mm_and_si128(t_is_slash, _mm_set1_epi8(16)));
+	__m128i t_values;
+	t_values = _mm_add_epi8(t_input, t_offset);
+
+	// Pack the four 6-bit values of each 32-bit lane into 24 bits, then
+	// gather the bytes.
+	__m128i t_packed;
+	t_packed = _mm_maddubs_epi16(t_values, _mm_set1_epi32(0x01400140));
+	t_packed = _mm_madd_epi16(t_packed, _mm_set1_epi32(0x00011000));
+	t_packed = _mm_shuffle_epi8(t_packed, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+	_mm_storeu_si128((__m128i *)p_dst, t_packed);
+
+	return true;
+}
+
+MCFILTERS_SSSE3_TARGET
+static void MCFiltersBase64DecodeBlocksSSSE3(const char_t*& x_src, uindex_t& x_length, byte_t*& x_dst)
 {
-	return ((x >= 'A' && x <= 'Z') || (x >= 'a' && x <= 'z') ||
-	        (x >= '0' && x <= '9') || x == '+' || x == '/');
+	while (x_length >= 16 && MCFiltersBase64DecodeBlockSSSE3(x_src, x_dst))
+	{
+		x_src += 16;
+		x_length -= 16;
+		x_dst += 12;
+	}
 }
+#endif
 
-inline uint8_t val(uint8_t x)
+// Decode as many complete groups of four base64 chars from the start of the
+// source as possible.
+static void MCFiltersBase64DecodeGroups(const char_t*& x_src, uindex_t& x_length, byte_t*& x_dst)
 {
-	return (x >= 'A' && x <= 'Z' ? x - 'A' :
-	        (x >= 'a' && x <= 'z' ? x - 'a' + 26 :
-	         (x >= '0' && x <= '9' ? x - '0' + 52 :
-	          (x == '+' ? 62 : (x == '/' ? 63 : 0)))));
+#if defined(MCFILTERS_SSSE3)
+	// The block decoder writes 16 bytes for every 12 it decodes, which is
+	// within the output buffer as that is as long as the input.
+	if (MCFiltersHasSSSE3())
+		MCFiltersBase64DecodeBlocksSSSE3(x_src, x_length, x_dst);
+#endif
+
+	while (x_length >= 4)
+	{
+		uint32_t t_a, t_b, t_c, t_d;
+		t_a = kMCFiltersBase64Values[x_src[0]];
+		t_b = kMCFiltersBase64Values[x_src[1]];
+		t_c = kMCFiltersBase64Values[x_src[2]];
+		t_d = kMCFiltersBase64Values[x_src[3]];
+		if ((t_a | t_b | t_c | t_d) == 0xff)
+			break;
+
+		uint32_t t_group;
+		t_group = (t_a << 18) | (t_b << 12) | (t_c << 6) | t_d;
+		x_dst[0] = uint8_t(t_group >> 16);
+		x_dst[1] = uint8_t(t_group >> 8);
+		x_dst[2] = uint8_t(t_group);
+
+		x_src += 4;
+		x_length -= 4;
+		x_dst += 3;
+	}
 }
 
 bool MCFiltersBase64Decode(MCStringRef p_src, MCDataRef& r_dst)
@@ -57,6 +190,12 @@ bool MCFiltersBase64Decode(MCStringRef p_src, MCDataRef& r_dst)
     
 	while (l)
 	{
+		// Groups which are entirely base64 chars are decoded quickly - only
+		// groups containing other chars or padding need to be handled here.
+		MCFiltersBase64DecodeGroups(s, l, p);
+		if (l == 0)
+			break;
+
 		uint16_t i = 0;
 		int16_t pad = -1;
 		uint32_t d;
@@ -67,22 +206,23 @@ bool MCFiltersBase64Decode(MCStringRef p_src, MCDataRef& r_dst)
 				c[i] = *s++;
 			else
 				c[i] = '=';
-			if (c[i] && isvalid(c[i]))
+			if (kMCFiltersBase64Values[c[i]] != 0xff)
 			{
+				c[i] = kMCFiltersBase64Values[c[i]];
 				i++;
 				continue;
 			}
 			if (c[i] && c[i] != '=')
 				continue;
-			while ((!c[i] || c[i] == '=') && i < 4)
+			while (i < 4)
 			{
 				pad++;
 				c[i++] = 0;
-				c[i] = '=';
 			}
+			c[4] = '=';
 		}
         
-		d = (val(c[0]) << 18) | (val(c[1]) << 12) | (val(c[2]) << 6) | val(c[3]);
+		d = (c[0] << 18) | (c[1] << 12) | (c[2] << 6) | c[3];
         
 		if (pad < 2)
 			*p++ = (d & 0xff0000) >> 16;
@@ -92,10 +232,7 @@ bool MCFiltersBase64Decode(MCStringRef p_src, MCDataRef& r_dst)
 			*p++ = d & 0xff;
         
 		if (c[4] == '=')
-		{
-			*p = 0;
 			break;
-		}
 	}
     
     
@@ -106,84 +243,117 @@ bool MCFiltersBase64Decode(MCStringRef p_src, MCDataRef& r_dst)
 
 //////////
 
-inline uint8_t lav(uint8_t x)
+#if defined(MCFILTERS_SSSE3)
+// Encode 12 bytes to 16 base64 chars, reading 16 bytes from p_src.
+MCFILTERS_SSSE3_TARGET
+static inline void MCFiltersBase64EncodeBlockSSSE3(const byte_t *p_src, char_t *p_dst)
+{
+	__m128i t_input;
+	t_input = _mm_loadu_si128((const __m128i *)p_src);
+
+	// Spread each group of three bytes over a 32-bit lane, then shift each
+	// 6-bit value into its own byte.
+	t_input = _mm_shuffle_epi8(t_input, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+	__m128i t_high, t_low, t_values;
+	t_high = _mm_mulhi_epu16(_mm_and_si128(t_input, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+	t_low = _mm_mullo_epi16(_mm_and_si128(t_input, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+	t_values = _mm_or_si128(t_high, t_low);
+
+	// Map each value to its char by adding an offset which depends on its
+	// range: 0-25 use index 13, 26-51 index 0, 52-61 indices 1-10, 62 index
+	// 11 and 63 index 12.
+	const __m128i t_offsets = _mm_setr_epi8(
+		'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+	__m128i t_index;
+	t_index = _mm_subs_epu8(t_values, _mm_set1_epi8(51));
+	t_index = _mm_or_si128(t_index, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), t_values), _mm_set1_epi8(13)));
+	_mm_storeu_si128((__m128i *)p_dst, _mm_add_epi8(t_values, _mm_shuffle_epi8(t_offsets, t_index)));
+}
+
+MCFILTERS_SSSE3_TARGET
+static void MCFiltersBase64EncodeBlocksSSSE3(const byte_t*& x_src, uindex_t& x_groups, uindex_t p_readable, char_t*& x_dst)
 {
-	return (x <= 25 ? x + 'A' : (x >= 26 && x <= 51 ? x + 'a' - 26 :
-	                             (x >= 52 && x <= 61 ? x + '0' - 52 :
-	                              (x == 62 ? '+' : (x == 63 ? '/' : '?')))));
+	while (x_groups >= 4 && p_readable >= 16)
+	{
+		MCFiltersBase64EncodeBlockSSSE3(x_src, x_dst);
+		x_src += 12;
+		x_groups -= 4;
+		p_readable -= 12;
+		x_dst += 16;
+	}
+}
+#endif
+
+// Encode the given number of complete three byte groups. The source must have
+// p_readable bytes available.
+static void MCFiltersBase64EncodeGroups(const byte_t*& x_src, uindex_t p_groups, uindex_t p_readable, char_t*& x_dst)
+{
+#if defined(MCFILTERS_SSSE3)
+	if (MCFiltersHasSSSE3())
+		MCFiltersBase64EncodeBlocksSSSE3(x_src, p_groups, p_readable, x_dst);
+#endif
+
+	while (p_groups--)
+	{
+		x_dst[0] = kMCFiltersBase64Chars[x_src[0] >> 2];
+		x_dst[1] = kMCFiltersBase64Chars[((x_src[0] & 0x3) << 4) | (x_src[1] >> 4)];
+		x_dst[2] = kMCFiltersBase64Chars[((x_src[1] & 0xf) << 2) | (x_src[2] >> 6)];
+		x_dst[3] = kMCFiltersBase64Chars[x_src[2] & 0x3f];
+		x_src += 3;
+		x_dst += 4;
+	}
 }
 
+// Encoded data is broken into lines of 18 groups (72 chars).
+#define kMCFiltersBase64GroupsPerLine 18
+
 bool MCFiltersBase64Encode(MCDataRef p_src, MCStringRef& r_dst)
 {
 	MCAutoNativeCharArray buffer;
 	uint32_t size;
     
-	const char_t *s = nil;
+	const byte_t *s = nil;
 	char_t *p = nil;
     
 	size = MCDataGetLength(p_src);
-	s = (char_t *)MCDataGetBytePtr(p_src);
+	s = MCDataGetBytePtr(p_src);
     
-	uint32_t newsize = size * 4 / 3 + size / 54 + 5;
-	if (!buffer.New(newsize))
+	uint32_t t_groups = (size + 2) / 3;
+	if (!buffer.New(t_groups * 4 + t_groups / kMCFiltersBase64GroupsPerLine))
 		return false;
     
 	p = buffer.Chars();
-	char_t *linestart = p;
-    
-	while (size)
+
+	uindex_t t_line_groups = 0;
+	while (size >= 3)
 	{
-		uint8_t c[3];
-		uint8_t d;
-		int16_t i = 0;
-		int16_t pad = -1;
-        
-		while (i < 3)
-		{
-			if (size)
-			{
-				c[i++] = *s++;
-				size--;
-			}
-			else
-			{
-				c[i++] = 0;
-				pad++;
-			}
-		}
-        
-		d = c[0] >> 2;
-		*p++ = lav(d);
-        
-		if (pad < 2)
-		{
-			d = ((c[0] & 0x3) << 4) | (c[1] >> 4);
-			*p++ = lav(d);
-		}
-		else
-			*p++ = '=';
-        
-		if (pad < 1)
-		{
-			d = ((c[1] & 0xf) << 2) | (c[2] >> 6);
-			*p++ = lav(d);
-		}
-		else
-			*p++ = '=';
-        
-		if (pad < 0)
-		{
-			d = c[2] & 0x3f;
-			*p++ = lav(d);
-		}
-		else
-			*p++ = '=';
-		if (p - linestart == 72)
+		uindex_t t_count;
+		t_count = MCMin(size / 3, uindex_t(kMCFiltersBase64GroupsPerLine - t_line_groups));
+		MCFiltersBase64EncodeGroups(s, t_count, size, p);
+		size -= t_count * 3;
+
+		t_line_groups += t_count;
+		if (t_line_groups == kMCFiltersBase64GroupsPerLine)
 		{
 			*p++ = '\n';
-			linestart = p;
+			t_line_groups = 0;
 		}
 	}
+
+	if (size != 0)
+	{
+		// The final group is padded with '='.
+		uint8_t c1;
+		c1 = size > 1 ? s[1] : 0;
+		*p++ = kMCFiltersBase64Chars[s[0] >> 2];
+		*p++ = kMCFiltersBase64Chars[((s[0] & 0x3) << 4) | (c1 >> 4)];
+		*p++ = size > 1 ? kMCFiltersBase64Chars[(c1 & 0xf) << 2] : '=';
+		*p++ = '=';
+
+		if (++t_line_groups == kMCFiltersBase64GroupsPerLine)
+			*p++ = '\n';
+	}
     
 	buffer.Shrink(p - buffer.Chars());
 	return buffer.CreateStringAndRelease(r_dst);
@@ -193,50 +363,445 @@ bool MCFiltersBase64Encode(MCDataRef p_src, MCStringRef& r_dst)
 
 #include "zlib.h"
 
+#if defined(_WIN32)
+#include <windows.h>
+#include <process.h>
+#include <atomic>
+#define MCFILTERS_PARALLEL_DEFLATE
+#elif !defined(__EMSCRIPTEN__)
+#include <pthread.h>
+#include <unistd.h>
+#include <atomic>
+#define MCFILTERS_PARALLEL_DEFLATE
+#endif
+
 #define GZIP_HEAD_CRC     0x02 /* bit 1 set: header CRC present */
 #define GZIP_EXTRA_FIELD  0x04 /* bit 2 set: extra field present */
 #define GZIP_ORIG_NAME    0x08 /* bit 3 set: original file name present */
 #define GZIP_COMMENT      0x10 /* bit 4 set: file comment present */
 #define GZIP_RESERVED     0xE0
 #define GZIP_HEADER_SIZE 10
+#define GZIP_TRAILER_SIZE 8
 static char_t gzip_header[GZIP_HEADER_SIZE] = { (char_t)0x1f, (char_t)0x8b,
     Z_DEFLATED, 0, 0, 0, 0, 0, 0, 3 };
 
+// When more than one thread is allowed, inputs larger than this are deflated
+// in blocks of this size, several at a time on separate threads.
+#define kMCFiltersDeflateBlockSize (1024 * 1024)
+
+// Each block is primed with the input preceding it, so that matches can span
+// block boundaries just as they would in a single deflate stream.
+#define kMCFiltersDeflateWindowSize 32768
+
+// The size of the buffers used by compression and decompression streams.
+#define kMCFiltersStreamBufferSize 65536
+
+static int MCFiltersGetZlibLevel(int p_level)
+{
+    if (p_level < 0)
+        return Z_DEFAULT_COMPRESSION;
+    if (p_level > kMCFiltersCompressionLevelMax)
+        return kMCFiltersCompressionLevelMax;
+    return p_level;
+}
+
+static void MCFiltersStoreGzipTrailer(byte_t *r_trailer, uint32_t p_crc, uint32_t p_size)
+{
+    uint32_t t_value;
+    t_value = MCSwapInt32HostToLittle(p_crc);
+    memcpy(r_trailer, &t_value, 4);
+    t_value = MCSwapInt32HostToLittle(p_size);
+    memcpy(r_trailer + 4, &t_value, 4);
+}
+
+// Skip the gzip member header starting at p_offset, returning the offset of
+// the deflate data following it.
+static bool MCFiltersSkipGzipHeader(const char_t *p_src, uindex_t p_src_len, uindex_t p_offset, bool p_check_magic, uindex_t& r_start)
+{
+    if (p_src_len - p_offset < GZIP_HEADER_SIZE)
+        return false;
+
+    const char_t *sptr = p_src + p_offset;
+    if (p_check_magic &&
+        (sptr[0] != gzip_header[0] || sptr[1] != gzip_header[1] ||
+         sptr[2] != gzip_header[2] || (sptr[3] & GZIP_RESERVED) != 0))
+        return false;
+
+    uindex_t startindex = p_offset + GZIP_HEADER_SIZE;
+    if (sptr[3] & GZIP_EXTRA_FIELD)
+    { /* skip the extra field */
+        if (p_src_len - startindex < 2)
+            return false;
+        uint16_t len;
+        memcpy(&len, &p_src[startindex], 2);
+        len = MCSwapInt16LittleToHost(len);
+        startindex += 2 + len;
+    }
+    if (sptr[3] & GZIP_ORIG_NAME) /* skip the original file name */
+        while (startindex < p_src_len && p_src[startindex++])
+            ;
+    if (sptr[3] & GZIP_COMMENT)   /* skip the .gz file comment */
+        while (startindex < p_src_len && p_src[startindex++])
+            ;
+    if (sptr[3] & GZIP_HEAD_CRC) /* skip the header crc */
+        startindex += 2;
+
+    if (startindex > p_src_len)
+        return false;
+
+    r_start = startindex;
+    return true;
+}
+
+//////////
+
+struct MCFiltersDeflateBlock
+{
+    const byte_t *input;
+    uindex_t length;
+    const byte_t *dictionary;
+    uindex_t dictionary_length;
+    bool last;
+    bool use_adler32;
+
+    byte_t *output;
+    uindex_t output_length;
+    uint32_t checksum;
+    bool success;
+};
+
+// Deflate a block of input as part of a raw deflate stream. Every block but
+// the last ends with a sync flush, so that it finishes on a byte boundary and
+// the blocks can simply be concatenated.
+static void MCFiltersDeflateBlockRun(MCFiltersDeflateBlock& x_block, int p_level)
+{
+    x_block . success = false;
+    x_block . output = nil;
+    if (x_block . use_adler32)
+        x_block . checksum = adler32(adler32(0L, Z_NULL, 0), x_block . input, x_block . length);
+    else
+        x_block . checksum = crc32(crc32(0L, Z_NULL, 0), x_block . input, x_block . length);
+
+    z_stream zstrm;
+    memset((char *)&zstrm, 0, sizeof(z_stream));
+    if (deflateInit2(&zstrm, p_level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return;
+
+    bool t_success;
+    t_success = true;
+
+    if (x_block . dictionary_length != 0)
+        t_success = deflateSetDictionary(&zstrm, x_block . dictionary, x_block . dictionary_length) == Z_OK;
+
+    // The bound doesn't account for the empty stored block which ends a sync
+    // flush.
+    uLong t_bound = 0;
+    if (t_success)
+    {
+        t_bound = deflateBound(&zstrm, x_block . length) + 16;
+        t_success = MCMemoryAllocate(t_bound, x_block . output);
+    }
+
+    if (t_success)
+    {
+        zstrm.next_in = (Bytef *)x_block . input;
+        zstrm.avail_in = x_block . length;
+        zstrm.next_out = x_block . output;
+        zstrm.avail_out = t_bound;
+
+        int t_result;
+        t_result = deflate(&zstrm, x_block . last ? Z_FINISH : Z_SYNC_FLUSH);
+        if (x_block . last)
+            t_success = t_result == Z_STREAM_END;
+        else
+            t_success = t_result == Z_OK && zstrm.avail_in == 0 && zstrm.avail_out != 0;
+    }
+
+    deflateEnd(&zstrm);
+
+    if (!t_success)
+    {
+        MCMemoryDeallocate(x_block . output);
+        x_block . output = nil;
+        return;
+    }
+
+    x_block . output_length = zstrm.total_out;
+    x_block . success = true;
+}
+
+#if defined(MCFILTERS_PARALLEL_DEFLATE)
+// The blocks being deflated by a set of workers, each of which takes the next
+// block which hasn't been started until there are none left.
+struct MCFiltersDeflateJob
+{
+    MCFiltersDeflateBlock *blocks;
+    uindex_t count;
+    int level;
+    std::atomic<uindex_t> next;
+};
+
+struct MCFiltersDeflateWorker
+{
+    MCFiltersDeflateJob *job;
+#if defined(_WIN32)
+    HANDLE thread;
+#else
+    pthread_t thread;
+#endif
+    bool threaded;
+};
+
+static void MCFiltersDeflateWorkerRun(MCFiltersDeflateJob *p_job)
+{
+    for(;;)
+    {
+        uindex_t t_index = p_job -> next++;
+        if (t_index >= p_job -> count)
+            break;
+        MCFiltersDeflateBlockRun(p_job -> blocks[t_index], p_job -> level);
+    }
+}
+
+#if defined(_WIN32)
+static unsigned int __stdcall MCFiltersDeflateWorkerThread(void *p_context)
+{
+    MCFiltersDeflateWorkerRun(((MCFiltersDeflateWorker *)p_context) -> job);
+    return 0;
+}
+#else
+static void *MCFiltersDeflateWorkerThread(void *p_context)
+{
+    MCFiltersDeflateWorkerRun(((MCFiltersDeflateWorker *)p_context) -> job);
+    return NULL;
+}
+#endif
+#endif
+
+// Returns the number of threads to deflate p_count blocks on, given the
+// maximum the caller allows - 0 meaning one per processor.
+static uindex_t MCFiltersDeflateThreadCount(uindex_t p_max_threads, uindex_t p_count)
+{
+#if defined(MCFILTERS_PARALLEL_DEFLATE)
+    uindex_t t_cores;
+#if defined(_WIN32)
+    SYSTEM_INFO t_info;
+    GetSystemInfo(&t_info);
+    t_cores = t_info . dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long t_online;
+    t_online = sysconf(_SC_NPROCESSORS_ONLN);
+    t_cores = t_online > 0 ? uindex_t(t_online) : 1;
+#else
+    t_cores = 1;
+#endif
+
+    if (p_max_threads == 0 || p_max_threads > t_cores)
+        p_max_threads = t_cores;
+
+    return MCMax(1U, MCMin(p_max_threads, p_count));
+#else
+    return 1;
+#endif
+}
+
+// Deflate the blocks on up to p_thread_count threads, including the calling
+// thread. If a thread can't be started, the blocks it would have deflated are
+// taken by the threads that did start.
+static void MCFiltersDeflateBlocks(MCFiltersDeflateBlock *x_blocks, uindex_t p_count, int p_level, uindex_t p_thread_count)
+{
+#if defined(MCFILTERS_PARALLEL_DEFLATE)
+    MCAutoArray<MCFiltersDeflateWorker> t_workers;
+    if (p_thread_count > 1 && t_workers . New(p_thread_count - 1))
+    {
+        MCFiltersDeflateJob t_job;
+        t_job . blocks = x_blocks;
+        t_job . count = p_count;
+        t_job . level = p_level;
+        t_job . next = 0;
+
+        for (uindex_t i = 0; i < t_workers . Size(); i++)
+        {
+            MCFiltersDeflateWorker& t_worker = t_workers[i];
+            t_worker . job = &t_job;
+#if defined(_WIN32)
+            t_worker . thread = (HANDLE)_beginthreadex(NULL, 0, MCFiltersDeflateWorkerThread, &t_worker, 0, NULL);
+            t_worker . threaded = t_worker . thread != NULL;
+#else
+            t_worker . threaded = pthread_create(&t_worker . thread, NULL, MCFiltersDeflateWorkerThread, &t_worker) == 0;
+#endif
+        }
+
+        // The calling thread deflates blocks too.
+        MCFiltersDeflateWorkerRun(&t_job);
+
+        for (uindex_t i = 0; i < t_workers . Size(); i++)
+        {
+            if (!t_workers[i] . threaded)
+                continue;
+#if defined(_WIN32)
+            WaitForSingleObject(t_workers[i] . thread, INFINITE);
+            CloseHandle(t_workers[i] . thread);
+#else
+            pthread_join(t_workers[i] . thread, NULL);
+#endif
+        }
+        return;
+    }
+#endif
+
+    for (uindex_t i = 0; i < p_count; i++)
+        MCFiltersDeflateBlockRun(x_blocks[i], p_level);
+}
+
+// Deflate p_length bytes as a single raw deflate stream, into a buffer with
+// room for a header before it and a trailer after it. The checksum is the crc32
+// (for gzip) or adler32 (for zlib) of the input.
+static bool MCFiltersDeflateWithLevel(const byte_t *p_input, uindex_t p_length, int p_level, uindex_t p_max_threads, bool p_use_adler32, uindex_t p_header_size, uindex_t p_trailer_size, MCAutoByteArray& r_buffer, uint32_t& r_checksum)
+{
+    uindex_t t_block_count;
+    t_block_count = MCMax(1U, (p_length + kMCFiltersDeflateBlockSize - 1) / kMCFiltersDeflateBlockSize);
+
+    // On a single thread the input is deflated as one block, which gives the
+    // same output as zlib would.
+    uindex_t t_thread_count;
+    t_thread_count = MCFiltersDeflateThreadCount(p_max_threads, t_block_count);
+    if (t_thread_count == 1)
+        t_block_count = 1;
+
+    MCAutoArray<MCFiltersDeflateBlock> t_blocks;
+    if (!t_blocks . New(t_block_count))
+        return false;
+
+    for (uindex_t i = 0; i < t_block_count; i++)
+    {
+        uindex_t t_offset;
+        t_offset = i * kMCFiltersDeflateBlockSize;
+
+        MCFiltersDeflateBlock& t_block = t_blocks[i];
+        t_block . input = p_input + t_offset;
+        t_block . length = t_block_count == 1 ? p_length : MCMin(p_length - t_offset, uindex_t(kMCFiltersDeflateBlockSize));
+        t_block . dictionary_length = MCMin(t_offset, uindex_t(kMCFiltersDeflateWindowSize));
+        t_block . dictionary = t_block . input - t_block . dictionary_length;
+        t_block . last = i == t_block_count - 1;
+        t_block . use_adler32 = p_use_adler32;
+    }
+
+    MCFiltersDeflateBlocks(t_blocks . Ptr(), t_block_count, MCFiltersGetZlibLevel(p_level), t_thread_count);
+
+    bool t_success;
+    t_success = true;
+
+    uindex_t t_size;
+    t_size = p_header_size + p_trailer_size;
+    for (uindex_t i = 0; i < t_block_count && t_success; i++)
+    {
+        t_success = t_blocks[i] . success &&
+                    t_blocks[i] . output_length <= UINDEX_MAX - t_size;
+        if (t_success)
+            t_size += t_blocks[i] . output_length;
+    }
+
+    if (t_success)
+        t_success = r_buffer . New(t_size);
+
+    if (t_success)
+    {
+        byte_t *t_output;
+        t_output = r_buffer . Bytes() + p_header_size;
+
+        uint32_t t_checksum;
+        t_checksum = t_blocks[0] . checksum;
+        for (uindex_t i = 0; i < t_block_count; i++)
+        {
+            if (i != 0)
+            {
+                if (p_use_adler32)
+                    t_checksum = adler32_combine(t_checksum, t_blocks[i] . checksum, t_blocks[i] . length);
+                else
+                    t_checksum = crc32_combine(t_checksum, t_blocks[i] . checksum, t_blocks[i] . length);
+            }
+            memcpy(t_output, t_blocks[i] . output, t_blocks[i] . output_length);
+            t_output += t_blocks[i] . output_length;
+        }
+
+        r_checksum = t_checksum;
+    }
+
+    for (uindex_t i = 0; i < t_block_count; i++)
+        MCMemoryDeallocate(t_blocks[i] . output);
+
+    return t_success;
+}
+
+MC_DLLEXPORT_DEF
+bool MCFiltersCompressWithLevel(MCDataRef p_source, int p_level, MCDataRef& r_result)
+{
+    return MCFiltersCompressWithLevelAndThreads(p_source, p_level, 1, r_result);
+}
+
+MC_DLLEXPORT_DEF
+bool MCFiltersCompressWithLevelAndThreads(MCDataRef p_source, int p_level, uindex_t p_max_threads, MCDataRef& r_result)
+{
+    uindex_t t_src_len = MCDataGetLength(p_source);
+
+    MCAutoByteArray t_buffer;
+    uint32_t t_crc;
+    if (!MCFiltersDeflateWithLevel(MCDataGetBytePtr(p_source), t_src_len, p_level, p_max_threads, false, GZIP_HEADER_SIZE, GZIP_TRAILER_SIZE, t_buffer, t_crc))
+        return false;
+
+    memcpy(t_buffer . Bytes(), gzip_header, GZIP_HEADER_SIZE);
+    MCFiltersStoreGzipTrailer(t_buffer . Bytes() + t_buffer . ByteCount() - GZIP_TRAILER_SIZE, t_crc, t_src_len);
+
+    return t_buffer.CreateDataAndRelease(r_result);
+}
+
+MC_DLLEXPORT_DEF
+bool MCFiltersZlibCompressBytes(const byte_t *p_bytes, uindex_t p_length, int p_level, uindex_t p_max_threads, MCDataRef& r_result)
+{
+    MCAutoByteArray t_buffer;
+    uint32_t t_adler;
+    if (!MCFiltersDeflateWithLevel(p_bytes, p_length, p_level, p_max_threads, true, 2, 4, t_buffer, t_adler))
+        return false;
+
+    // The header records the window size and, as zlib does, how hard the
+    // compressor tried.
+    int t_level;
+    t_level = MCFiltersGetZlibLevel(p_level);
+    if (t_level == Z_DEFAULT_COMPRESSION)
+        t_level = 6;
+
+    uint32_t t_level_flags;
+    if (t_level < 2)
+        t_level_flags = 0;
+    else if (t_level < 6)
+        t_level_flags = 1;
+    else if (t_level == 6)
+        t_level_flags = 2;
+    else
+        t_level_flags = 3;
+
+    uint32_t t_header;
+    t_header = ((Z_DEFLATED + ((MAX_WBITS - 8) << 4)) << 8) | (t_level_flags << 6);
+    t_header += 31 - (t_header % 31);
+
+    byte_t *t_bytes;
+    t_bytes = t_buffer . Bytes();
+    t_bytes[0] = byte_t(t_header >> 8);
+    t_bytes[1] = byte_t(t_header);
+
+    t_bytes += t_buffer . ByteCount() - 4;
+    t_bytes[0] = byte_t(t_adler >> 24);
+    t_bytes[1] = byte_t(t_adler >> 16);
+    t_bytes[2] = byte_t(t_adler >> 8);
+    t_bytes[3] = byte_t(t_adler);
+
+    return t_buffer.CreateDataAndRelease(r_result);
+}
+
 bool MCFiltersCompress(MCDataRef p_source, MCDataRef& r_result)
 {
-	const byte_t *t_src_ptr = MCDataGetBytePtr(p_source);
-	uindex_t t_src_len = MCDataGetLength(p_source);
-    
-	uint32_t size = t_src_len + 12 + GZIP_HEADER_SIZE + 8;
-	size += size / 999;  //dest must be "0.1% larger than (source) plus 12 bytes"
-	MCAutoByteArray t_buffer;
-	if (!t_buffer.New(size))
-		return false;
-    
-	memcpy(t_buffer.Bytes(), gzip_header, GZIP_HEADER_SIZE);
-	z_stream zstrm;
-	memset((char *)&zstrm, 0, sizeof(z_stream));
-	zstrm.next_in = (unsigned char *)t_src_ptr;
-	zstrm.avail_in = t_src_len;
-	zstrm.next_out = (unsigned char *)t_buffer.Bytes() + GZIP_HEADER_SIZE;
-	zstrm.avail_out = size - GZIP_HEADER_SIZE - 8;
-	if (deflateInit2(&zstrm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, 0) != Z_OK
-        || deflate(&zstrm, Z_FINISH) != Z_STREAM_END
-        || deflateEnd(&zstrm) != Z_OK)
-	{
-		return false;
-	}
-	uint32_t osize = zstrm.total_out + GZIP_HEADER_SIZE;
-	uint32_t check = crc32(0L, Z_NULL, 0);
-	check = crc32(check, (unsigned char *)t_src_ptr, t_src_len);
-    check = MCSwapInt32HostToLittle(check);
-	memcpy(t_buffer.Bytes() + osize, &check, 4);
-	check = t_src_len;
-    check = MCSwapInt32HostToLittle(check);
-	memcpy(t_buffer.Bytes() + osize + 4, &check, 4);
-    
-	t_buffer.Shrink(osize + 8);
-	return t_buffer.CreateDataAndRelease(r_result);
+    return MCFiltersCompressWithLevel(p_source, kMCFiltersCompressionLevelDefault, r_result);
 }
 
 bool MCFiltersIsCompressed(MCDataRef p_source)
@@ -253,37 +818,21 @@ bool MCFiltersDecompress(MCDataRef p_source, MCDataRef& r_result)
 {
 	const char_t *t_src_ptr = MCDataGetBytePtr(p_source);
 	uindex_t t_src_len = MCDataGetLength(p_source);
-    
-	const char_t *sptr = t_src_ptr;
-    
-	uint32_t startindex = 10;
-	if (sptr[3] & GZIP_EXTRA_FIELD)
-	{ /* skip the extra field */
-		uint16_t len;
-		memcpy(&len, &sptr[startindex], 2);
-        len = MCSwapInt16LittleToHost(len);
-		startindex += len;
-	}
-	if (sptr[3] & GZIP_ORIG_NAME) /* skip the original file name */
-		while (startindex < t_src_len && sptr[startindex++])
-			;
-	if (sptr[3] & GZIP_COMMENT)   /* skip the .gz file comment */
-		while (startindex < t_src_len && sptr[startindex++])
-			;
-	if (sptr[3] & GZIP_HEAD_CRC) /* skip the header crc */
-		startindex += 2;
+
+	if (t_src_len < GZIP_HEADER_SIZE + GZIP_TRAILER_SIZE)
+		return false;
+
+	// The size recorded in the trailer of the last member is only a hint, as
+	// the data may consist of several members. Deflate can't expand data by
+	// more than 1032:1, so anything larger must be corrupt.
 	uint32_t size;
-	memcpy(&size, &sptr[t_src_len - 4], 4);
-    size = MCSwapInt32LittleToHost(size);
+	memcpy(&size, &t_src_ptr[t_src_len - 4], 4);
+	size = MCSwapInt32LittleToHost(size);
+	if (size / 1032 > t_src_len)
+		size = t_src_len;
 	if (size == 0)
-	{
-		r_result = MCValueRetain(kMCEmptyData);
-		return true;
-	}
-	if (t_src_len < (startindex + 8))
-	{
-		return false;
-	}
+		size = 1;
+
 	MCAutoByteArray t_buffer;
 	if (!t_buffer.New(size))
 	{
@@ -291,34 +840,564 @@ bool MCFiltersDecompress(MCDataRef p_source, MCDataRef& r_result)
 		//MCabortscript = False;
 		return false;
 	}
-    
+
 	z_stream zstrm;
 	memset((char *)&zstrm, 0, sizeof(z_stream));
-	zstrm.next_in = (unsigned char *)sptr + startindex;
-	zstrm.avail_in = t_src_len - startindex - 8;
-	zstrm.next_out = (unsigned char *)t_buffer.Bytes();
-	zstrm.avail_out = size;
-	int err;
-	if (inflateInit2(&zstrm, -MAX_WBITS) != Z_OK
-	    || ((err = inflate(&zstrm, Z_FINISH)) != Z_STREAM_END
-	        && err != Z_OK && err != Z_BUF_ERROR) // bug on OS X returns this error
-        || inflateEnd(&zstrm) != Z_OK)
+	if (inflateInit2(&zstrm, -MAX_WBITS) != Z_OK)
 		return false;
-    
-	return t_buffer.CreateDataAndRelease(r_result);
-}
 
-////////////////////////////////////////////////////////////////////////////////
+	bool t_success;
+	t_success = true;
 
-static const char * const url_table[256] =
-{
-    "%00", "%01", "%02", "%03", "%04", "%05", "%06", "%07", "%08", "%09",
-    "%0D%0A", "%0B", "%0C", "%0D", "%0E", "%0F", "%10", "%11", "%12",
-    "%13", "%14", "%15", "%16", "%17", "%18", "%19", "%1A", "%1B", "%1C",
-    "%1D", "%1E", "%1F", "+", "%21", "%22", "%23", "%24", "%25", "%26",
-    "%27", "%28", "%29", "*", "%2B", "%2C", "-", ".", "%2F", "0", "1",
-    "2", "3", "4", "5", "6", "7", "8", "9", "%3A", "%3B", "%3C", "%3D",
-    "%3E", "%3F", "%40", "A", "B", "C", "D", "E", "F", "G", "H", "I", "J",
+	uindex_t t_offset, t_output_length;
+	t_offset = 0;
+	t_output_length = 0;
+	for(;;)
+	{
+		uindex_t t_start;
+		if (!MCFiltersSkipGzipHeader(t_src_ptr, t_src_len, t_offset, t_offset != 0, t_start))
+		{
+			// Anything other than another member after the first is ignored.
+			t_success = t_offset != 0;
+			break;
+		}
+
+		inflateReset(&zstrm);
+		zstrm.next_in = (unsigned char *)t_src_ptr + t_start;
+		zstrm.avail_in = t_src_len - t_start;
+
+		int err;
+		do
+		{
+			if (t_output_length == t_buffer.ByteCount())
+			{
+				uindex_t t_new_size;
+				t_new_size = t_buffer.ByteCount() + t_buffer.ByteCount() / 2 + 4096;
+				if (t_new_size < t_buffer.ByteCount() || !t_buffer.Extend(t_new_size))
+				{
+					t_success = false;
+					break;
+				}
+			}
+
+			zstrm.next_out = (unsigned char *)t_buffer.Bytes() + t_output_length;
+			zstrm.avail_out = t_buffer.ByteCount() - t_output_length;
+			err = inflate(&zstrm, Z_NO_FLUSH);
+			t_output_length = t_buffer.ByteCount() - zstrm.avail_out;
+		}
+		while (err == Z_OK || (err == Z_BUF_ERROR && zstrm.avail_out == 0));
+
+		// Truncated data is decompressed as far as possible (the OS X zlib
+		// reports this as Z_BUF_ERROR).
+		if (!t_success || (err != Z_STREAM_END && err != Z_BUF_ERROR))
+		{
+			t_success = false;
+			break;
+		}
+		if (err != Z_STREAM_END)
+			break;
+
+		t_offset = t_src_len - zstrm.avail_in;
+		if (t_src_len - t_offset < GZIP_TRAILER_SIZE + GZIP_HEADER_SIZE)
+			break;
+		t_offset += GZIP_TRAILER_SIZE;
+	}
+
+	inflateEnd(&zstrm);
+
+	if (!t_success)
+		return false;
+
+	if (t_output_length == 0)
+	{
+		r_result = MCValueRetain(kMCEmptyData);
+		return true;
+	}
+
+	t_buffer.Shrink(t_output_length);
+	return t_buffer.CreateDataAndRelease(r_result);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct __MCFiltersCompressStream
+{
+    MCStreamRef target;
+    z_stream zstrm;
+    byte_t *buffer;
+    uint32_t crc;
+    uint32_t size;
+    bool finished;
+};
+
+static bool __MCFiltersCompressStreamDeflate(__MCFiltersCompressStream *self, int p_flush)
+{
+    for(;;)
+    {
+        self -> zstrm.next_out = self -> buffer;
+        self -> zstrm.avail_out = kMCFiltersStreamBufferSize;
+
+        int t_result;
+        t_result = deflate(&self -> zstrm, p_flush);
+        if (t_result != Z_OK && t_result != Z_STREAM_END && t_result != Z_BUF_ERROR)
+            return MCErrorThrowGeneric(MCSTR("compression failed"));
+
+        size_t t_produced;
+        t_produced = kMCFiltersStreamBufferSize - self -> zstrm.avail_out;
+        if (t_produced != 0 &&
+            !MCStreamWrite(self -> target, self -> buffer, t_produced))
+            return false;
+
+        if (t_result == Z_STREAM_END)
+            return true;
+
+        if (p_flush != Z_FINISH && self -> zstrm.avail_in == 0 && self -> zstrm.avail_out != 0)
+            return true;
+    }
+}
+
+static void __MCFiltersCompressStreamDestroy(MCStreamRef p_stream)
+{
+    __MCFiltersCompressStream *self;
+    self = (__MCFiltersCompressStream *)MCStreamGetExtraBytesPtr(p_stream);
+
+    if (!self -> finished)
+        deflateEnd(&self -> zstrm);
+    MCMemoryDeleteArray(self -> buffer);
+    MCValueRelease(self -> target);
+}
+
+static bool __MCFiltersCompressStreamIsFinished(MCStreamRef p_stream, bool& r_finished)
+{
+    __MCFiltersCompressStream *self;
+    self = (__MCFiltersCompressStream *)MCStreamGetExtraBytesPtr(p_stream);
+    r_finished = self -> finished;
+    return true;
+}
+
+static bool __MCFiltersCompressStreamGetAvailableForWrite(MCStreamRef p_stream, size_t& r_amount)
+{
+    __MCFiltersCompressStream *self;
+    self = (__MCFiltersCompressStream *)MCStreamGetExtraBytesPtr(p_stream);
+    r_amount = self -> finished ? 0 : SIZE_MAX;
+    return true;
+}
+
+static bool __MCFiltersCompressStreamWrite(MCStreamRef p_stream, const void *p_buffer, size_t p_amount)
+{
+    __MCFiltersCompressStream *self;
+    self = (__MCFiltersCompressStream *)MCStreamGetExtraBytesPtr(p_stream);
+    if (self -> finished)
+        return false;
+
+    const byte_t *t_input;
+    t_input = (const byte_t *)p_buffer;
+    while (p_amount != 0)
+    {
+        uInt t_length;
+        t_length = uInt(MCMin(p_amount, size_t(1) << 30));
+
+        self -> crc = crc32(self -> crc, t_input, t_length);
+        self -> size += t_length;
+
+        self -> zstrm.next_in = (Bytef *)t_input;
+        self -> zstrm.avail_in = t_length;
+        if (!__MCFiltersCompressStreamDeflate(self, Z_NO_FLUSH))
+            return false;
+
+        t_input += t_length;
+        p_amount -= t_length;
+    }
+
+    return true;
+}
+
+static const MCStreamCallbacks kMCFiltersCompressStreamCallbacks =
+{
+    __MCFiltersCompressStreamDestroy,
+    __MCFiltersCompressStreamIsFinished,
+    nil,
+    nil,
+    __MCFiltersCompressStreamGetAvailableForWrite,
+    __MCFiltersCompressStreamWrite,
+    nil,
+    nil,
+    nil,
+    nil,
+    nil,
+};
+
+MC_DLLEXPORT_DEF
+bool MCFiltersCompressStreamCreate(MCStreamRef p_target, int p_level, MCStreamRef& r_stream)
+{
+    if (!MCStreamIsWritable(p_target))
+        return MCErrorThrowGeneric(MCSTR("stream is not writable"));
+
+    if (!MCStreamWrite(p_target, gzip_header, GZIP_HEADER_SIZE))
+        return false;
+
+    MCStreamRef t_stream;
+    if (!MCStreamCreate(&kMCFiltersCompressStreamCallbacks, sizeof(__MCFiltersCompressStream), t_stream))
+        return false;
+
+    __MCFiltersCompressStream *self;
+    self = (__MCFiltersCompressStream *)MCStreamGetExtraBytesPtr(t_stream);
+    memset(&self -> zstrm, 0, sizeof(z_stream));
+    self -> target = MCValueRetain(p_target);
+    self -> buffer = nil;
+    self -> crc = crc32(0L, Z_NULL, 0);
+    self -> size = 0;
+
+    self -> finished = false;
+
+    // Ending a zeroed z_stream is harmless, so the stream can be released
+    // whichever of these fails.
+    if (!MCMemoryNewArray(kMCFiltersStreamBufferSize, self -> buffer) ||
+        deflateInit2(&self -> zstrm, MCFiltersGetZlibLevel(p_level), Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        MCValueRelease(t_stream);
+        return MCErrorThrowOutOfMemory();
+    }
+
+    r_stream = t_stream;
+    return true;
+}
+
+MC_DLLEXPORT_DEF
+bool MCFiltersCompressStreamFinish(MCStreamRef p_stream)
+{
+    if (MCStreamGetCallbacks(p_stream) != &kMCFiltersCompressStreamCallbacks)
+        return MCErrorThrowGeneric(MCSTR("stream is not a compression stream"));
+
+    __MCFiltersCompressStream *self;
+    self = (__MCFiltersCompressStream *)MCStreamGetExtraBytesPtr(p_stream);
+    if (self -> finished)
+        return true;
+
+    self -> zstrm.next_in = nil;
+    self -> zstrm.avail_in = 0;
+    bool t_success;
+    t_success = __MCFiltersCompressStreamDeflate(self, Z_FINISH);
+
+    deflateEnd(&self -> zstrm);
+    self -> finished = true;
+
+    byte_t t_trailer[GZIP_TRAILER_SIZE];
+    MCFiltersStoreGzipTrailer(t_trailer, self -> crc, self -> size);
+    return t_success &&
+            MCStreamWrite(self -> target, t_trailer, GZIP_TRAILER_SIZE);
+}
+
+//////////
+
+struct __MCFiltersDecompressStream
+{
+    MCStreamRef source;
+    z_stream zstrm;
+    byte_t *input;
+    byte_t *output;
+    size_t output_start;
+    size_t output_end;
+    uint32_t crc;
+    uint32_t size;
+    bool in_member;
+    bool finished;
+};
+
+// Ensure there is some input buffered, returning false in r_available if the
+// source has no more data.
+static bool __MCFiltersDecompressStreamRefill(__MCFiltersDecompressStream *self, bool& r_available)
+{
+    if (self -> zstrm.avail_in != 0)
+    {
+        r_available = true;
+        return true;
+    }
+
+    size_t t_amount;
+    if (!MCStreamGetAvailableForRead(self -> source, t_amount))
+        return false;
+
+    t_amount = MCMin(t_amount, size_t(kMCFiltersStreamBufferSize));
+    if (t_amount == 0)
+    {
+        r_available = false;
+        return true;
+    }
+
+    if (!MCStreamRead(self -> source, self -> input, t_amount))
+        return false;
+
+    self -> zstrm.next_in = self -> input;
+    self -> zstrm.avail_in = uInt(t_amount);
+    r_available = true;
+    return true;
+}
+
+// Read exactly p_amount bytes of (uncompressed) input, such as part of a
+// header or trailer.
+static bool __MCFiltersDecompressStreamFetch(__MCFiltersDecompressStream *self, byte_t *r_bytes, size_t p_amount)
+{
+    while (p_amount != 0)
+    {
+        bool t_available;
+        if (!__MCFiltersDecompressStreamRefill(self, t_available))
+            return false;
+        if (!t_available)
+            return MCErrorThrowGeneric(MCSTR("compressed data is truncated"));
+
+        size_t t_count;
+        t_count = MCMin(p_amount, size_t(self -> zstrm.avail_in));
+        MCMemoryCopy(r_bytes, self -> zstrm.next_in, t_count);
+        self -> zstrm.next_in += t_count;
+        self -> zstrm.avail_in -= uInt(t_count);
+        r_bytes += t_count;
+        p_amount -= t_count;
+    }
+    return true;
+}
+
+static bool __MCFiltersDecompressStreamSkipString(__MCFiltersDecompressStream *self)
+{
+    byte_t t_char;
+    do
+    {
+        if (!__MCFiltersDecompressStreamFetch(self, &t_char, 1))
+            return false;
+    }
+    while (t_char != 0);
+    return true;
+}
+
+// Read the header of the next gzip member, if there is one.
+static bool __MCFiltersDecompressStreamBeginMember(__MCFiltersDecompressStream *self, bool& r_found)
+{
+    bool t_available;
+    if (!__MCFiltersDecompressStreamRefill(self, t_available))
+        return false;
+    if (!t_available)
+    {
+        r_found = false;
+        return true;
+    }
+
+    byte_t t_header[GZIP_HEADER_SIZE];
+    if (!__MCFiltersDecompressStreamFetch(self, t_header, GZIP_HEADER_SIZE))
+        return false;
+
+    if (t_header[0] != gzip_header[0] || t_header[1] != gzip_header[1] ||
+        t_header[2] != gzip_header[2] || (t_header[3] & GZIP_RESERVED) != 0)
+        return MCErrorThrowGeneric(MCSTR("data is not compressed"));
+
+    byte_t t_field[2];
+    if (t_header[3] & GZIP_EXTRA_FIELD)
+    {
+        if (!__MCFiltersDecompressStreamFetch(self, t_field, 2))
+            return false;
+
+        uint16_t t_length;
+        t_length = t_field[0] | (t_field[1] << 8);
+        while (t_length != 0)
+        {
+            byte_t t_skip[256];
+            size_t t_count;
+            t_count = MCMin(size_t(t_length), sizeof(t_skip));
+            if (!__MCFiltersDecompressStreamFetch(self, t_skip, t_count))
+                return false;
+            t_length -= t_count;
+        }
+    }
+    if ((t_header[3] & GZIP_ORIG_NAME) && !__MCFiltersDecompressStreamSkipString(self))
+        return false;
+    if ((t_header[3] & GZIP_COMMENT) && !__MCFiltersDecompressStreamSkipString(self))
+        return false;
+    if ((t_header[3] & GZIP_HEAD_CRC) && !__MCFiltersDecompressStreamFetch(self, t_field, 2))
+        return false;
+
+    inflateReset(&self -> zstrm);
+    self -> crc = crc32(0L, Z_NULL, 0);
+    self -> size = 0;
+    self -> in_member = true;
+    r_found = true;
+    return true;
+}
+
+static bool __MCFiltersDecompressStreamEndMember(__MCFiltersDecompressStream *self)
+{
+    byte_t t_trailer[GZIP_TRAILER_SIZE];
+    if (!__MCFiltersDecompressStreamFetch(self, t_trailer, GZIP_TRAILER_SIZE))
+        return false;
+
+    uint32_t t_crc, t_size;
+    memcpy(&t_crc, t_trailer, 4);
+    memcpy(&t_size, t_trailer + 4, 4);
+    if (MCSwapInt32LittleToHost(t_crc) != self -> crc ||
+        MCSwapInt32LittleToHost(t_size) != self -> size)
+        return MCErrorThrowGeneric(MCSTR("compressed data is corrupt"));
+
+    self -> in_member = false;
+    return true;
+}
+
+// Decompress more data into the output buffer if it is empty.
+static bool __MCFiltersDecompressStreamFill(__MCFiltersDecompressStream *self)
+{
+    while (self -> output_start == self -> output_end && !self -> finished)
+    {
+        if (!self -> in_member)
+        {
+            bool t_found;
+            if (!__MCFiltersDecompressStreamBeginMember(self, t_found))
+                return false;
+            if (!t_found)
+            {
+                self -> finished = true;
+                break;
+            }
+        }
+
+        bool t_available;
+        if (!__MCFiltersDecompressStreamRefill(self, t_available))
+            return false;
+        if (!t_available)
+            return MCErrorThrowGeneric(MCSTR("compressed data is truncated"));
+
+        self -> zstrm.next_out = self -> output;
+        self -> zstrm.avail_out = kMCFiltersStreamBufferSize;
+
+        int t_result;
+        t_result = inflate(&self -> zstrm, Z_NO_FLUSH);
+        if (t_result != Z_OK && t_result != Z_STREAM_END)
+            return MCErrorThrowGeneric(MCSTR("compressed data is corrupt"));
+
+        self -> output_start = 0;
+        self -> output_end = kMCFiltersStreamBufferSize - self -> zstrm.avail_out;
+        self -> crc = crc32(self -> crc, self -> output, uInt(self -> output_end));
+        self -> size += uint32_t(self -> output_end);
+
+        if (t_result == Z_STREAM_END &&
+            !__MCFiltersDecompressStreamEndMember(self))
+            return false;
+    }
+    return true;
+}
+
+static void __MCFiltersDecompressStreamDestroy(MCStreamRef p_stream)
+{
+    __MCFiltersDecompressStream *self;
+    self = (__MCFiltersDecompressStream *)MCStreamGetExtraBytesPtr(p_stream);
+
+    inflateEnd(&self -> zstrm);
+    MCMemoryDeleteArray(self -> input);
+    MCMemoryDeleteArray(self -> output);
+    MCValueRelease(self -> source);
+}
+
+static bool __MCFiltersDecompressStreamIsFinished(MCStreamRef p_stream, bool& r_finished)
+{
+    __MCFiltersDecompressStream *self;
+    self = (__MCFiltersDecompressStream *)MCStreamGetExtraBytesPtr(p_stream);
+    if (!__MCFiltersDecompressStreamFill(self))
+        return false;
+    r_finished = self -> output_start == self -> output_end;
+    return true;
+}
+
+static bool __MCFiltersDecompressStreamGetAvailableForRead(MCStreamRef p_stream, size_t& r_amount)
+{
+    __MCFiltersDecompressStream *self;
+    self = (__MCFiltersDecompressStream *)MCStreamGetExtraBytesPtr(p_stream);
+    if (!__MCFiltersDecompressStreamFill(self))
+        return false;
+    r_amount = self -> output_end - self -> output_start;
+    return true;
+}
+
+static bool __MCFiltersDecompressStreamRead(MCStreamRef p_stream, void *p_buffer, size_t p_amount)
+{
+    __MCFiltersDecompressStream *self;
+    self = (__MCFiltersDecompressStream *)MCStreamGetExtraBytesPtr(p_stream);
+
+    byte_t *t_buffer;
+    t_buffer = (byte_t *)p_buffer;
+    while (p_amount != 0)
+    {
+        if (!__MCFiltersDecompressStreamFill(self))
+            return false;
+        if (self -> output_start == self -> output_end)
+            return false;
+
+        size_t t_count;
+        t_count = MCMin(p_amount, self -> output_end - self -> output_start);
+        MCMemoryCopy(t_buffer, self -> output + self -> output_start, t_count);
+        self -> output_start += t_count;
+        t_buffer += t_count;
+        p_amount -= t_count;
+    }
+    return true;
+}
+
+static const MCStreamCallbacks kMCFiltersDecompressStreamCallbacks =
+{
+    __MCFiltersDecompressStreamDestroy,
+    __MCFiltersDecompressStreamIsFinished,
+    __MCFiltersDecompressStreamGetAvailableForRead,
+    __MCFiltersDecompressStreamRead,
+    nil,
+    nil,
+    nil,
+    nil,
+    nil,
+    nil,
+    nil,
+};
+
+MC_DLLEXPORT_DEF
+bool MCFiltersDecompressStreamCreate(MCStreamRef p_source, MCStreamRef& r_stream)
+{
+    if (!MCStreamIsReadable(p_source))
+        return MCErrorThrowGeneric(MCSTR("stream is not readable"));
+
+    MCStreamRef t_stream;
+    if (!MCStreamCreate(&kMCFiltersDecompressStreamCallbacks, sizeof(__MCFiltersDecompressStream), t_stream))
+        return false;
+
+    __MCFiltersDecompressStream *self;
+    self = (__MCFiltersDecompressStream *)MCStreamGetExtraBytesPtr(t_stream);
+    memset(&self -> zstrm, 0, sizeof(z_stream));
+    self -> source = MCValueRetain(p_source);
+    self -> input = nil;
+    self -> output = nil;
+    self -> output_start = 0;
+    self -> output_end = 0;
+    self -> in_member = false;
+    self -> finished = false;
+
+    // Ending a zeroed z_stream is harmless, so the stream can be released
+    // whichever of these fails.
+    if (!MCMemoryNewArray(kMCFiltersStreamBufferSize, self -> input) ||
+        !MCMemoryNewArray(kMCFiltersStreamBufferSize, self -> output) ||
+        inflateInit2(&self -> zstrm, -MAX_WBITS) != Z_OK)
+    {
+        MCValueRelease(t_stream);
+        return MCErrorThrowOutOfMemory();
+    }
+
+    r_stream = t_stream;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static const char * const url_table[256] =
+{
+    "%00", "%01", "%02", "%03", "%04", "%05", "%06", "%07", "%08", "%09",
+    "%0D%0A", "%0B", "%0C", "%0D", "%0E", "%0F", "%10", "%11", "%12",
+    "%13", "%14", "%15", "%16", "%17", "%18", "%19", "%1A", "%1B", "%1C",
+    "%1D", "%1E", "%1F", "+", "%21", "%22", "%23", "%24", "%25", "%26",
+    "%27", "%28", "%29", "*", "%2B", "%2C", "-", ".", "%2F", "0", "1",
+    "2", "3", "4", "5", "6", "7", "8", "9", "%3A", "%3B", "%3C", "%3D",
+    "%3E", "%3F", "%40", "A", "B", "C", "D", "E", "F", "G", "H", "I", "J",
     "K", "L", "M", "N", "O", "P", "Q", "R", "S", "T", "U", "V", "W", "X",
     "Y", "Z", "%5B", "%5C", "%5D", "%5E", "_", "%60", "a", "b", "c", "d",
     "e", "f", "g", "h", "i", "j", "k", "l", "m", "n", "o", "p", "q", "r",
@@ -338,112 +1417,255 @@ static const char * const url_table[256] =
     "%F7", "%F8", "%F9", "%FA", "%FB", "%FC", "%FD", "%FE", "%FF"
 };
 
+// The length of each entry in url_table.
+static const uint8_t kMCFiltersUrlEncodedLengths[256] =
+{
+	3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 6, 3, 3, 3, 3, 3,
+	3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+	1, 3, 3, 3, 3, 3, 3, 3, 3, 3, 1, 3, 3, 1, 1, 3,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 3, 3, 3, 3, 3,
+	3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 3, 3, 3, 1,
+	3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 3, 3, 3, 3,
+	3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+	3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+	3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+	3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+	3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+	3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+	3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+	3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+};
+
+// The value of each hex digit, non-digits counting as zero.
+static const uint8_t kMCFiltersHexValues[256] =
+{
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  0,  0,  0,  0,  0,  0,
+	 0, 10, 11, 12, 13, 14, 15,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0, 10, 11, 12, 13, 14, 15,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+	 0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+};
+
+static bool MCFiltersBytesAreASCII(const byte_t *p_bytes, uindex_t p_length)
+{
+	uindex_t i = 0;
+
+#if defined(__SSE2__)
+	for(; i + 16 <= p_length; i += 16)
+		if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(p_bytes + i))) != 0)
+			return false;
+#endif
+
+	for(; i < p_length; i++)
+		if (p_bytes[i] >= 0x80)
+			return false;
+
+	return true;
+}
+
+#if defined(__SSE2__)
+// Returns a mask with a bit set for each of the 16 bytes which url encoding
+// leaves unchanged - ASCII letters and digits, and '*', '-', '.' and '_'.
+// Bytes of 0x80 and above are negative, so fall outside all the ranges.
+static inline int MCFiltersUrlUnreservedMaskSSE2(__m128i p_block)
+{
+	__m128i t_letter, t_digit, t_punct, t_folded;
+	t_folded = _mm_or_si128(p_block, _mm_set1_epi8(0x20));
+	t_letter = _mm_and_si128(_mm_cmpgt_epi8(t_folded, _mm_set1_epi8('a' - 1)),
+	                         _mm_cmplt_epi8(t_folded, _mm_set1_epi8('z' + 1)));
+	t_digit = _mm_and_si128(_mm_cmpgt_epi8(p_block, _mm_set1_epi8('0' - 1)),
+	                        _mm_cmplt_epi8(p_block, _mm_set1_epi8('9' + 1)));
+	t_punct = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(p_block, _mm_set1_epi8('*')),
+	                                    _mm_cmpeq_epi8(p_block, _mm_set1_epi8('-'))),
+	                       _mm_or_si128(_mm_cmpeq_epi8(p_block, _mm_set1_epi8('.')),
+	                                    _mm_cmpeq_epi8(p_block, _mm_set1_epi8('_'))));
+	return _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(t_letter, t_digit), t_punct));
+}
+#endif
+
+MC_DLLEXPORT_DEF
+bool MCFiltersUrlEncodeBytes(const byte_t *p_bytes, uindex_t p_length, MCStringRef& r_result)
+{
+	// Size the result exactly, so that it needs no checks while encoding.
+	uindex_t t_size = 0;
+	for (uindex_t i = 0; i < p_length; i++)
+	{
+		t_size += kMCFiltersUrlEncodedLengths[p_bytes[i]];
+		if (t_size < kMCFiltersUrlEncodedLengths[p_bytes[i]])
+			return MCErrorThrowOutOfMemory();
+	}
+
+	MCAutoNativeCharArray buffer;
+	if (!buffer . New(t_size))
+		return false;
+
+	const byte_t *sptr = p_bytes;
+	const byte_t *eptr = p_bytes + p_length;
+	char_t *dptr = buffer . Chars();
+	while (sptr < eptr)
+	{
+#if defined(__SSE2__)
+		// Copy runs of chars which don't need encoding 16 at a time. Each
+		// input byte produces at least one char, so there is room to store
+		// the whole block.
+		while (eptr - sptr >= 16)
+		{
+			__m128i t_block;
+			t_block = _mm_loadu_si128((const __m128i *)sptr);
+			_mm_storeu_si128((__m128i *)dptr, t_block);
+
+			int t_mask;
+			t_mask = MCFiltersUrlUnreservedMaskSSE2(t_block);
+			if (t_mask != 0xffff)
+			{
+				int t_run;
+				t_run = __builtin_ctz(~t_mask);
+				sptr += t_run;
+				dptr += t_run;
+				break;
+			}
+
+			sptr += 16;
+			dptr += 16;
+		}
+		if (sptr == eptr)
+			break;
+#endif
+
+		uint8_t t_length;
+		t_length = kMCFiltersUrlEncodedLengths[*sptr];
+		if (t_length == 1)
+			*dptr = url_table[*sptr][0];
+		else
+			MCMemoryCopy(dptr, url_table[*sptr], t_length);
+		dptr += t_length;
+		sptr++;
+	}
+
+	return buffer . CreateStringAndRelease(r_result);
+}
+
 bool MCFiltersUrlEncode(MCStringRef p_source, MCStringRef& r_result)
 {
+	// The UTF-8 encoding of an ASCII native string is the string itself.
+	uindex_t t_native_length;
+	const char_t *t_native_chars;
+	t_native_chars = MCStringGetNativeCharPtrAndLength(p_source, t_native_length);
+	if (t_native_chars != nil &&
+		MCFiltersBytesAreASCII(t_native_chars, t_native_length))
+		return MCFiltersUrlEncodeBytes(t_native_chars, t_native_length, r_result);
+
 	MCAutoStringRefAsUTF8String t_utf8_string;
-	const char *s;
-	uindex_t l;
-	uindex_t size;
     
     // SN-2014-11-13: [[ Bug 14015 ]] We don't want to nativise the string,
     // but rather to encode it in UTF-8 and write the bytes (a '%' will be added).
 	if (!t_utf8_string.Lock (p_source))
         return false;
-    
-	s = *t_utf8_string;
-	l = t_utf8_string.Size();
-	size = l + 1;
-	size += size / 4;
-    
-    MCAutoNativeCharArray buffer;
-    if (!buffer . New(size))
-        return false;
-    
-    char_t *dptr = buffer . Chars();
-    while (l--)
-    {
-        if (dptr - buffer . Chars() + 7 > size)
-        {
-            uint32_t newsize = size + size / 4 + 7;
-            uint32_t offset = dptr - buffer . Chars();
-            if (!buffer . Extend(newsize))
-                return false;
-            dptr = buffer . Chars() + offset;
-            size = newsize;
-        }
-        const char_t *sptr = (const char_t *)url_table[(uint8_t)*s++];
-        do
-        {
-            *dptr++ = *sptr++;
-        }
-        while (*sptr);
-    }
-    
-    buffer . Shrink(dptr - buffer . Chars());
-    
-    return buffer . CreateStringAndRelease(r_result);
+
+	return MCFiltersUrlEncodeBytes((const byte_t *)*t_utf8_string, t_utf8_string.Size(), r_result);
 }
 
-bool MCFiltersUrlDecode(MCStringRef p_source, MCStringRef& r_result)
+MC_DLLEXPORT_DEF
+bool MCFiltersUrlDecodeChars(const char_t *p_chars, uindex_t p_length, MCStringEncoding p_encoding, MCStringRef& r_result)
 {
-    // SN-2014-11-13: [[ Bug 14015 ]] We don't want to use a nativised string, but
-    // bytes, as we can get UTF-8 characters (now usable in 7.0)
     MCAutoByteArray t_buffer;
-    char_t *t_srcptr;
-    uindex_t t_srclen;
-    
-    if (!MCStringConvertToNative(p_source, t_srcptr, t_srclen))
-        return false;
-    
-    if (!t_buffer . New(t_srclen))
-	{
-		MCMemoryDeleteArray (t_srcptr);
+    if (!t_buffer . New(p_length))
         return false;
-	}
-    
-    const uint8_t *sptr = (uint8_t *)t_srcptr;
-    const uint8_t *eptr = sptr + t_srclen;
+
+    const uint8_t *sptr = p_chars;
+    const uint8_t *eptr = sptr + p_length;
     uint8_t *dptr = (uint8_t*)t_buffer . Bytes();
     while (sptr < eptr)
     {
+#if defined(__SSE2__)
+        // Copy runs of chars which aren't escapes 16 at a time - the output
+        // is never longer than the input, so there is room for the block.
+        while (eptr - sptr >= 16)
+        {
+            __m128i t_block;
+            t_block = _mm_loadu_si128((const __m128i *)sptr);
+            _mm_storeu_si128((__m128i *)dptr, t_block);
+
+            int t_mask;
+            t_mask = _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(t_block, _mm_set1_epi8('%')),
+                                                                 _mm_cmpeq_epi8(t_block, _mm_set1_epi8('+'))),
+                                                    _mm_cmpeq_epi8(t_block, _mm_set1_epi8('\r'))));
+            if (t_mask != 0)
+            {
+                int t_run;
+                t_run = __builtin_ctz(t_mask);
+                sptr += t_run;
+                dptr += t_run;
+                break;
+            }
+
+            sptr += 16;
+            dptr += 16;
+        }
+        if (sptr == eptr)
+            break;
+#endif
+
         if (*sptr == '%')
         {
-            uint8_t source = MCNativeCharUppercase(*++sptr);
+            // Missing or invalid hex digits count as zero.
             uint8_t value = 0;
-            if (isdigit(source))
-                value = (source - '0') << 4;
-            else
-                if (source >= 'A' && source <= 'F')
-                    value = (source - 'A' + 10) << 4;
-            source = MCNativeCharUppercase(*++sptr);
-            if (isdigit(source))
-                value += source - '0';
-            else
-                if (source >= 'A' && source <= 'F')
-                    value += source - 'A' + 10;
+            if (eptr - sptr > 1)
+                value = kMCFiltersHexValues[sptr[1]] << 4;
+            if (eptr - sptr > 2)
+                value += kMCFiltersHexValues[sptr[2]];
             if (value != 13)
                 *dptr++ = value;
+            sptr += MCMin(eptr - sptr, ptrdiff_t(3));
+            continue;
         }
+
+        if (*sptr == '+')
+            *dptr++ = ' ';
         else
-            if (*sptr == '+')
-                *dptr++ = ' ';
+            if (*sptr == '\r')
+            {
+                if (eptr - sptr > 1 && *(sptr + 1) == '\n')
+                    sptr++;
+                *dptr++ = '\n';
+            }
             else
-                if (*sptr == '\r')
-                {
-                    if (*(sptr + 1) == '\n')
-                        sptr++;
-                    *dptr++ = '\n';
-                }
-                else
-                    *dptr++ = *sptr;
+                *dptr++ = *sptr;
         sptr++;
     }
-    t_buffer.Shrink(dptr - t_buffer.Bytes());
-    
-    MCMemoryDeleteArray(t_srcptr);
-    
+
+    // ASCII is the same in every encoding, and is quickest to create as native.
+    if (MCFiltersBytesAreASCII(t_buffer . Bytes(), dptr - t_buffer . Bytes()))
+        p_encoding = kMCStringEncodingNative;
+
+    return MCStringCreateWithBytes(t_buffer . Bytes(), dptr - t_buffer . Bytes(), p_encoding, false, r_result);
+}
+
+bool MCFiltersUrlDecode(MCStringRef p_source, MCStringRef& r_result)
+{
+    // SN-2014-11-13: [[ Bug 14015 ]] We don't want to use a nativised string, but
+    // bytes, as we can get UTF-8 characters (now usable in 7.0)
+    MCAutoStringRefAsNativeChars t_native;
+    const char_t *t_srcptr;
+    uindex_t t_srclen;
+    if (!t_native . Lock(p_source, t_srcptr, t_srclen))
+        return false;
+
     // SN-2014-11-13: [[ Bug 14015 ]] The string is UTF-8 encoded, not native.
-    return MCStringCreateWithBytes(t_buffer . Bytes(), t_buffer.ByteCount(), kMCStringEncodingUTF8, false, r_result);
+    return MCFiltersUrlDecodeChars(t_srcptr, t_srclen, kMCStringEncodingUTF8, r_result);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,966 @@
+/* Copyright (C) 2003-2015 LiveCode Ltd.
+
+ This file is part of LiveCode.
+
+ LiveCode is free software; you can redistribute it and/or modify it under
+ the terms of the GNU General Public License v3 as published by the Free
+ Software Foundation.
+
+ LiveCode is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
+
+#include <foundation.h>
+#include <foundation-auto.h>
+#include <foundation-json.h>
+
+#include "foundation-private.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+// The maximum number of values which may be pending while parsing nested
+// structures - each enclosing JSON array counts once and each enclosing JSON
+// object twice (the object and the key of the member being parsed).
+#define kMCJSONMaxNesting 500
+
+// The longest number literal which is accepted (matching the maximum length
+// of a real accepted by the type conversion functions).
+#define kMCJSONMaxNumberLength 384
+
+// Overloads used by the parser to create values from the chars of the source
+// string, which are either native or UTF-16.
+
+static inline bool MCJSONCreateString(const char_t *p_chars, uindex_t p_count, MCStringRef& r_string)
+{
+    return MCStringCreateWithNativeChars(p_chars, p_count, r_string);
+}
+
+static inline bool MCJSONCreateString(const unichar_t *p_chars, uindex_t p_count, MCStringRef& r_string)
+{
+    return MCStringCreateWithChars(p_chars, p_count, r_string);
+}
+
+static inline bool MCJSONCreateName(const char_t *p_chars, uindex_t p_count, MCNameRef& r_name)
+{
+    return MCNameCreateWithNativeChars(p_chars, p_count, r_name);
+}
+
+static inline bool MCJSONCreateName(const unichar_t *p_chars, uindex_t p_count, MCNameRef& r_name)
+{
+    return MCNameCreateWithChars(p_chars, p_count, r_name);
+}
+
+static inline bool MCJSONAppendChars(MCStringRef x_string, const char_t *p_chars, uindex_t p_count)
+{
+    return MCStringAppendNativeChars(x_string, p_chars, p_count);
+}
+
+static inline bool MCJSONAppendChars(MCStringRef x_string, const unichar_t *p_chars, uindex_t p_count)
+{
+    return MCStringAppendChars(x_string, p_chars, p_count);
+}
+
+// Returns the index of the first char at or after p_offset which cannot be
+// copied verbatim into a string - a quote, a backslash or a control char - or
+// p_length if there is none.
+static uindex_t MCJSONFindStringSpecial(const char_t *p_chars, uindex_t p_offset, uindex_t p_length)
+{
+    uindex_t i = p_offset;
+
+#if defined(__SSE2__)
+    // Check 16 chars at a time - a char is less than 0x20 if its minimum with
+    // 0x1f is itself.
+    const __m128i t_quote = _mm_set1_epi8('"');
+    const __m128i t_backslash = _mm_set1_epi8('\\');
+    const __m128i t_control = _mm_set1_epi8(0x1f);
+    for(; i + 16 <= p_length; i += 16)
+    {
+        __m128i t_block;
+        t_block = _mm_loadu_si128((const __m128i *)(p_chars + i));
+
+        __m128i t_special;
+        t_special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(t_block, t_quote),
+                                              _mm_cmpeq_epi8(t_block, t_backslash)),
+                                 _mm_cmpeq_epi8(_mm_min_epu8(t_block, t_control), t_block));
+
+        int t_mask;
+        t_mask = _mm_movemask_epi8(t_special);
+        if (t_mask != 0)
+            return i + __builtin_ctz(t_mask);
+    }
+#endif
+
+    for(; i < p_length; i++)
+        if (p_chars[i] == '"' || p_chars[i] == '\\' || p_chars[i] < 0x20)
+            return i;
+
+    return p_length;
+}
+
+static uindex_t MCJSONFindStringSpecial(const unichar_t *p_chars, uindex_t p_offset, uindex_t p_length)
+{
+    for(uindex_t i = p_offset; i < p_length; i++)
+        if (p_chars[i] == '"' || p_chars[i] == '\\' || p_chars[i] < 0x20)
+            return i;
+
+    return p_length;
+}
+
+static inline bool MCJSONIsWhitespace(uint32_t p_char)
+{
+    return p_char == ' ' || p_char == '\t' || p_char == '\r' || p_char == '\n';
+}
+
+static inline bool MCJSONIsDigit(uint32_t p_char)
+{
+    return p_char >= '0' && p_char <= '9';
+}
+
+static inline int MCJSONHexDigitValue(uint32_t p_char)
+{
+    if (p_char >= '0' && p_char <= '9')
+        return p_char - '0';
+    if (p_char >= 'a' && p_char <= 'f')
+        return p_char - 'a' + 10;
+    if (p_char >= 'A' && p_char <= 'F')
+        return p_char - 'A' + 10;
+    return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// A recursive descent JSON parser over the chars of a string. Elements of JSON
+// arrays are accumulated on a shared stack so that each proper list can be
+// created in one step once its last element has been parsed.
+template<typename CharType>
+class MCJSONParser
+{
+public:
+    MCJSONParser(const CharType *p_chars, uindex_t p_length)
+        : m_chars(p_chars), m_length(p_length), m_offset(0),
+          m_stack(nullptr), m_stack_count(0), m_stack_capacity(0)
+    {
+    }
+
+    ~MCJSONParser(void)
+    {
+        for(uindex_t i = 0; i < m_stack_count; i++)
+            MCValueRelease(m_stack[i]);
+        MCMemoryDeleteArray(m_stack);
+    }
+
+    bool Parse(MCValueRef& r_value)
+    {
+        SkipWhitespace();
+        if (m_offset == m_length)
+            return ThrowEndOfInput();
+
+        MCAutoValueRef t_value;
+        if (!ParseValue(0, &t_value))
+            return false;
+
+        SkipWhitespace();
+        if (m_offset != m_length)
+            return ThrowCharError(m_offset, "Unexpected character '", "' after JSON data");
+
+        r_value = t_value . Take();
+        return true;
+    }
+
+private:
+    void SkipWhitespace(void)
+    {
+        while(m_offset < m_length && MCJSONIsWhitespace(m_chars[m_offset]))
+            m_offset += 1;
+    }
+
+    //////////
+
+    // Throw a syntax error at the given char, using the same line and column
+    // numbering as the original script parser.
+    bool ThrowSyntaxError(uindex_t p_offset, MCStringRef p_message)
+    {
+        uindex_t t_line, t_column;
+        t_line = 1;
+        t_column = 0;
+        for(uindex_t i = 0; i <= p_offset && i < m_length; i++)
+        {
+            if (m_chars[i] == '\r' || m_chars[i] == '\n')
+            {
+                t_line += 1;
+                t_column = 1;
+            }
+            else
+                t_column += 1;
+        }
+
+        MCAutoStringRef t_error;
+        if (MCStringFormat(&t_error, "syntax error: %u:%u %@", t_line, t_column, p_message))
+            MCErrorThrowGeneric(*t_error);
+
+        return false;
+    }
+
+    bool ThrowError(uindex_t p_offset, const char *p_message)
+    {
+        MCAutoStringRef t_message;
+        if (!MCStringCreateWithCString(p_message, &t_message))
+            return false;
+        return ThrowSyntaxError(p_offset, *t_message);
+    }
+
+    bool ThrowEndOfInput(void)
+    {
+        return ThrowError(m_length != 0 ? m_length - 1 : 0, "unexpected end of input");
+    }
+
+    // Format a char for inclusion in an error message - control chars are
+    // shown in "\uXXXX" format, and other chars literally.
+    bool FormatChar(CharType p_char, MCStringRef& r_string)
+    {
+        if (p_char > 0x1f)
+            return MCJSONCreateString(&p_char, 1, r_string);
+        return MCStringFormat(r_string, "\\u%X", p_char);
+    }
+
+    // Throw an error of the form <prefix><char at p_offset><suffix>.
+    bool ThrowCharError(uindex_t p_offset, const char *p_prefix, const char *p_suffix)
+    {
+        MCAutoStringRef t_char, t_message;
+        if (!FormatChar(m_chars[p_offset], &t_char) ||
+            !MCStringFormat(&t_message, "%s%@%s", p_prefix, *t_char, p_suffix))
+            return false;
+        return ThrowSyntaxError(p_offset, *t_message);
+    }
+
+    // Throw an error for a char which cannot start the expected token.
+    bool ThrowUnexpectedToken(uindex_t p_offset)
+    {
+        CharType t_char;
+        t_char = m_chars[p_offset];
+        if (t_char == '{' || t_char == '}' || t_char == '[' || t_char == ']' ||
+            t_char == ':' || t_char == ',' || t_char == '"' || t_char == '-' ||
+            t_char == 't' || t_char == 'f' || t_char == 'n' || MCJSONIsDigit(t_char))
+            return ThrowCharError(p_offset, "unexpected '", "'");
+        return ThrowCharError(p_offset, "Unexpected character '", "'");
+    }
+
+    //////////
+
+    bool Push(MCValueRef p_value)
+    {
+        if (m_stack_count == m_stack_capacity)
+        {
+            uindex_t t_capacity;
+            t_capacity = m_stack_capacity;
+            if (!MCMemoryResizeArray(m_stack_capacity != 0 ? m_stack_capacity * 2 : 64, m_stack, t_capacity))
+                return false;
+            m_stack_capacity = t_capacity;
+        }
+
+        m_stack[m_stack_count++] = p_value;
+        return true;
+    }
+
+    bool ParseValue(uindex_t p_nesting, MCValueRef& r_value)
+    {
+        switch(m_chars[m_offset])
+        {
+            case '"':
+                return ParseString(r_value);
+
+            case '[':
+                return ParseArray(p_nesting, r_value);
+
+            case '{':
+                return ParseObject(p_nesting, r_value);
+
+            case 't':
+                return ParseLiteral("true", kMCTrue, r_value);
+
+            case 'f':
+                return ParseLiteral("false", kMCFalse, r_value);
+
+            case 'n':
+                return ParseLiteral("null", kMCNull, r_value);
+
+            case '-':
+            case '0': case '1': case '2': case '3': case '4':
+            case '5': case '6': case '7': case '8': case '9':
+                return ParseNumber(r_value);
+
+            default:
+                return ThrowUnexpectedToken(m_offset);
+        }
+    }
+
+    bool ParseLiteral(const char *p_literal, MCValueRef p_value, MCValueRef& r_value)
+    {
+        uindex_t t_length;
+        t_length = strlen(p_literal);
+        if (m_length - m_offset < t_length)
+            return ThrowEndOfInput();
+
+        for(uindex_t i = 0; i < t_length; i++)
+            if (m_chars[m_offset + i] != (CharType)p_literal[i])
+            {
+                MCAutoStringRef t_token, t_message;
+                if (!MCJSONCreateString(m_chars + m_offset, t_length, &t_token) ||
+                    !MCStringFormat(&t_message, "invalid token '%@'", *t_token))
+                    return false;
+                return ThrowSyntaxError(m_offset + t_length - 1, *t_message);
+            }
+
+        m_offset += t_length;
+        r_value = MCValueRetain(p_value);
+        return true;
+    }
+
+    bool ParseNumber(MCValueRef& r_value)
+    {
+        uindex_t t_start;
+        t_start = m_offset;
+
+        if (m_chars[m_offset] == '-')
+            m_offset += 1;
+
+        if (m_offset == m_length)
+            return ThrowEndOfInput();
+
+        // Integer part
+        bool t_is_integer;
+        t_is_integer = true;
+        if (m_chars[m_offset] == '0')
+            m_offset += 1;
+        else if (MCJSONIsDigit(m_chars[m_offset]))
+        {
+            while(m_offset < m_length && MCJSONIsDigit(m_chars[m_offset]))
+                m_offset += 1;
+        }
+        else
+            return ThrowCharError(m_offset, "unexpected '", "' at start of number integer part");
+
+        // Fractional part
+        if (m_offset < m_length && m_chars[m_offset] == '.')
+        {
+            t_is_integer = false;
+            m_offset += 1;
+            if (m_offset == m_length)
+                return ThrowEndOfInput();
+            if (!MCJSONIsDigit(m_chars[m_offset]))
+                return ThrowCharError(m_offset, "unexpected '", "' at start of number fractional part");
+            while(m_offset < m_length && MCJSONIsDigit(m_chars[m_offset]))
+                m_offset += 1;
+        }
+
+        // Exponent part
+        if (m_offset < m_length && (m_chars[m_offset] == 'e' || m_chars[m_offset] == 'E'))
+        {
+            t_is_integer = false;
+            m_offset += 1;
+            if (m_offset == m_length)
+                return ThrowEndOfInput();
+            if (m_chars[m_offset] == '+' || m_chars[m_offset] == '-')
+            {
+                m_offset += 1;
+                if (m_offset == m_length)
+                    return ThrowEndOfInput();
+                if (!MCJSONIsDigit(m_chars[m_offset]))
+                    return ThrowCharError(m_offset, "unexpected '", "' in number exponent part");
+            }
+            else if (!MCJSONIsDigit(m_chars[m_offset]))
+                return ThrowCharError(m_offset, "unexpected '", "' at start of number exponent part");
+            while(m_offset < m_length && MCJSONIsDigit(m_chars[m_offset]))
+                m_offset += 1;
+        }
+
+        // Numbers are not self-delimiting, so check the char which follows
+        if (m_offset < m_length)
+        {
+            CharType t_terminal;
+            t_terminal = m_chars[m_offset];
+            if (t_terminal != ']' && t_terminal != '}' && t_terminal != ',' &&
+                !MCJSONIsWhitespace(t_terminal))
+                return ThrowCharError(m_offset, "bad number terminal '", "'");
+        }
+
+        uindex_t t_length;
+        t_length = m_offset - t_start;
+
+        // Short integers are exactly representable, so can be computed
+        // directly. Note that "-0" becomes 0, as it always has.
+        double t_number;
+        if (t_is_integer && t_length <= 15)
+        {
+            uindex_t i;
+            i = t_start;
+            bool t_negative;
+            t_negative = m_chars[i] == '-';
+            if (t_negative)
+                i += 1;
+
+            int64_t t_integer;
+            t_integer = 0;
+            for(; i < m_offset; i++)
+                t_integer = t_integer * 10 + (m_chars[i] - '0');
+
+            t_number = (double)(t_negative ? -t_integer : t_integer);
+        }
+        else
+        {
+            if (t_length > kMCJSONMaxNumberLength)
+            {
+                MCAutoStringRef t_token, t_message;
+                if (!MCJSONCreateString(m_chars + t_start, t_length, &t_token) ||
+                    !MCStringFormat(&t_message, "unsupported number format '%@'", *t_token))
+                    return false;
+                return ThrowSyntaxError(m_offset - 1, *t_message);
+            }
+
+            char t_buffer[kMCJSONMaxNumberLength + 1];
+            for(uindex_t i = 0; i < t_length; i++)
+                t_buffer[i] = (char)m_chars[t_start + i];
+            t_buffer[t_length] = '\0';
+
+            t_number = strtod(t_buffer, nullptr);
+        }
+
+        return MCNumberCreateWithReal(t_number, (MCNumberRef&)r_value);
+    }
+
+    // Scan the string starting at the current (quote) char. If it contains no
+    // escapes, its chars are referenced by r_start and r_count; otherwise they
+    // are accumulated into r_escaped.
+    bool ScanString(uindex_t& r_start, uindex_t& r_count, MCStringRef& r_escaped)
+    {
+        m_offset += 1;
+
+        uindex_t t_start;
+        t_start = m_offset;
+
+        uindex_t t_special;
+        t_special = MCJSONFindStringSpecial(m_chars, m_offset, m_length);
+        if (t_special == m_length)
+            return ThrowEndOfInput();
+
+        if (m_chars[t_special] == '"')
+        {
+            r_start = t_start;
+            r_count = t_special - t_start;
+            r_escaped = nullptr;
+            m_offset = t_special + 1;
+            return true;
+        }
+
+        MCAutoStringRef t_string;
+        if (!MCStringCreateMutable(t_special - t_start + 16, &t_string) ||
+            !MCJSONAppendChars(*t_string, m_chars + t_start, t_special - t_start))
+            return false;
+
+        m_offset = t_special;
+        for(;;)
+        {
+            CharType t_char;
+            t_char = m_chars[m_offset];
+            if (t_char == '"')
+            {
+                m_offset += 1;
+                break;
+            }
+
+            if (t_char < 0x20)
+                return ThrowCharError(m_offset, "Unescaped control character '", "' in string");
+
+            // t_char must be a backslash
+            m_offset += 1;
+            if (m_offset == m_length)
+                return ThrowEndOfInput();
+
+            unichar_t t_unescaped;
+            switch(m_chars[m_offset])
+            {
+                case '"':
+                case '\\':
+                case '/':
+                    t_unescaped = m_chars[m_offset];
+                    break;
+                case 'n':
+                    t_unescaped = '\n';
+                    break;
+                case 'r':
+                    t_unescaped = '\r';
+                    break;
+                case 't':
+                    t_unescaped = '\t';
+                    break;
+                case 'b':
+                    t_unescaped = 0x08;
+                    break;
+                case 'f':
+                    t_unescaped = 0x0c;
+                    break;
+                case 'u':
+                {
+                    // Each escape is a single UTF-16 code unit, so a surrogate
+                    // pair is formed from two consecutive escapes.
+                    t_unescaped = 0;
+                    for(uindex_t i = 1; i <= 4; i++)
+                    {
+                        if (m_offset + i == m_length)
+                            return ThrowEndOfInput();
+
+                        int t_digit;
+                        t_digit = MCJSONHexDigitValue(m_chars[m_offset + i]);
+                        if (t_digit < 0)
+                        {
+                            MCAutoStringRef t_hex, t_char_string, t_message;
+                            if (!MCJSONCreateString(m_chars + m_offset + 1, i - 1, &t_hex) ||
+                                !FormatChar(m_chars[m_offset + i], &t_char_string) ||
+                                !MCStringFormat(&t_message, "illegal escape sequence '\\u%@%@'", *t_hex, *t_char_string))
+                                return false;
+                            return ThrowSyntaxError(m_offset + i, *t_message);
+                        }
+
+                        t_unescaped = (unichar_t)((t_unescaped << 4) | t_digit);
+                    }
+                    m_offset += 4;
+                }
+                break;
+                default:
+                    return ThrowCharError(m_offset, "illegal escape sequence '\\", "'");
+            }
+
+            if (!MCStringAppendChar(*t_string, t_unescaped))
+                return false;
+
+            m_offset += 1;
+
+            uindex_t t_run_end;
+            t_run_end = MCJSONFindStringSpecial(m_chars, m_offset, m_length);
+            if (t_run_end == m_length)
+                return ThrowEndOfInput();
+
+            if (!MCJSONAppendChars(*t_string, m_chars + m_offset, t_run_end - m_offset))
+                return false;
+
+            m_offset = t_run_end;
+        }
+
+        r_escaped = t_string . Take();
+        return true;
+    }
+
+    bool ParseString(MCValueRef& r_value)
+    {
+        uindex_t t_start, t_count;
+        MCStringRef t_escaped;
+        if (!ScanString(t_start, t_count, t_escaped))
+            return false;
+
+        if (t_escaped != nullptr)
+            return MCStringCopyAndRelease(t_escaped, (MCStringRef&)r_value);
+
+        return MCJSONCreateString(m_chars + t_start, t_count, (MCStringRef&)r_value);
+    }
+
+    bool ParseKey(MCNameRef& r_key)
+    {
+        uindex_t t_start, t_count;
+        MCStringRef t_escaped;
+        if (!ScanString(t_start, t_count, t_escaped))
+            return false;
+
+        if (t_escaped != nullptr)
+        {
+            bool t_success;
+            t_success = MCNameCreate(t_escaped, r_key);
+            MCValueRelease(t_escaped);
+            return t_success;
+        }
+
+        return MCJSONCreateName(m_chars + t_start, t_count, r_key);
+    }
+
+    bool ParseArray(uindex_t p_nesting, MCValueRef& r_value)
+    {
+        if (p_nesting > kMCJSONMaxNesting)
+            return ThrowError(m_offset, "too many nested values");
+
+        m_offset += 1;
+        SkipWhitespace();
+        if (m_offset == m_length)
+            return ThrowEndOfInput();
+
+        if (m_chars[m_offset] == ']')
+        {
+            m_offset += 1;
+            r_value = MCValueRetain(kMCEmptyProperList);
+            return true;
+        }
+
+        uindex_t t_base;
+        t_base = m_stack_count;
+        for(;;)
+        {
+            MCValueRef t_element;
+            if (!ParseValue(p_nesting + 1, t_element))
+                return false;
+
+            if (!Push(t_element))
+            {
+                MCValueRelease(t_element);
+                return false;
+            }
+
+            SkipWhitespace();
+            if (m_offset == m_length)
+                return ThrowEndOfInput();
+
+            if (m_chars[m_offset] == ']')
+            {
+                m_offset += 1;
+                break;
+            }
+
+            if (m_chars[m_offset] != ',')
+                return ThrowUnexpectedToken(m_offset);
+
+            m_offset += 1;
+            SkipWhitespace();
+            if (m_offset == m_length)
+                return ThrowEndOfInput();
+        }
+
+        // Move the elements off the stack into the new list, which takes
+        // ownership of them.
+        uindex_t t_count;
+        t_count = m_stack_count - t_base;
+
+        MCValueRef *t_elements;
+        if (!MCMemoryNewArray(t_count, t_elements))
+            return false;
+
+        MCMemoryCopy(t_elements, m_stack + t_base, t_count * sizeof(MCValueRef));
+        m_stack_count = t_base;
+
+        if (!MCProperListCreateAndRelease(t_elements, t_count, (MCProperListRef&)r_value))
+        {
+            for(uindex_t i = 0; i < t_count; i++)
+                MCValueRelease(t_elements[i]);
+            MCMemoryDeleteArray(t_elements);
+            return false;
+        }
+
+        return true;
+    }
+
+    bool ParseObject(uindex_t p_nesting, MCValueRef& r_value)
+    {
+        if (p_nesting > kMCJSONMaxNesting)
+            return ThrowError(m_offset, "too many nested values");
+
+        m_offset += 1;
+        SkipWhitespace();
+        if (m_offset == m_length)
+            return ThrowEndOfInput();
+
+        if (m_chars[m_offset] == '}')
+        {
+            m_offset += 1;
+            r_value = MCValueRetain(kMCEmptyArray);
+            return true;
+        }
+
+        MCAutoArrayRef t_array;
+        if (!MCArrayCreateMutable(&t_array))
+            return false;
+
+        for(;;)
+        {
+            if (m_chars[m_offset] != '"')
+            {
+                CharType t_char;
+                t_char = m_chars[m_offset];
+                if (t_char == 't' || t_char == 'f' || t_char == 'n' ||
+                    t_char == '-' || MCJSONIsDigit(t_char))
+                    return ThrowError(m_offset, "expected string");
+                return ThrowUnexpectedToken(m_offset);
+            }
+
+            MCNewAutoNameRef t_key;
+            if (!ParseKey(&t_key))
+                return false;
+
+            SkipWhitespace();
+            if (m_offset == m_length)
+                return ThrowEndOfInput();
+
+            if (m_chars[m_offset] != ':')
+                return ThrowUnexpectedToken(m_offset);
+
+            m_offset += 1;
+            SkipWhitespace();
+            if (m_offset == m_length)
+                return ThrowEndOfInput();
+
+            MCAutoValueRef t_value;
+            if (!ParseValue(p_nesting + 2, &t_value))
+                return false;
+
+            // Keys are stored caselessly, as they are by the array syntax.
+            if (!MCArrayStoreValue(*t_array, false, *t_key, *t_value))
+                return false;
+
+            SkipWhitespace();
+            if (m_offset == m_length)
+                return ThrowEndOfInput();
+
+            if (m_chars[m_offset] == '}')
+            {
+                m_offset += 1;
+                break;
+            }
+
+            if (m_chars[m_offset] != ',')
+                return ThrowUnexpectedToken(m_offset);
+
+            m_offset += 1;
+            SkipWhitespace();
+            if (m_offset == m_length)
+                return ThrowEndOfInput();
+        }
+
+        if (!t_array . MakeImmutable())
+            return false;
+
+        r_value = t_array . Take();
+        return true;
+    }
+
+    const CharType *m_chars;
+    uindex_t m_length;
+    uindex_t m_offset;
+
+    MCValueRef *m_stack;
+    uindex_t m_stack_count;
+    uindex_t m_stack_capacity;
+};
+
+MC_DLLEXPORT_DEF
+bool MCJSONImport(MCStringRef p_json, MCValueRef& r_value)
+{
+    __MCAssertIsString(p_json);
+
+    // Parse the chars of the string in place if possible.
+    const char_t *t_native_chars;
+    t_native_chars = MCStringGetNativeCharPtr(p_json);
+    if (t_native_chars != nullptr)
+    {
+        MCJSONParser<char_t> t_parser(t_native_chars, MCStringGetLength(p_json));
+        return t_parser . Parse(r_value);
+    }
+
+    const unichar_t *t_chars;
+    t_chars = MCStringGetCharPtr(p_json);
+    if (t_chars != nullptr)
+    {
+        MCJSONParser<unichar_t> t_parser(t_chars, MCStringGetLength(p_json));
+        return t_parser . Parse(r_value);
+    }
+
+    MCAutoArray<unichar_t> t_buffer;
+    if (!t_buffer . New(MCStringGetLength(p_json)))
+        return false;
+
+    MCStringGetChars(p_json, MCRangeMake(0, t_buffer . Size()), t_buffer . Ptr());
+
+    MCJSONParser<unichar_t> t_parser(t_buffer . Ptr(), t_buffer . Size());
+    return t_parser . Parse(r_value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Returns the escape sequence for a char in an exported string, or nil if
+// the char is exported as-is. Other control chars are not escaped, as they
+// never have been.
+static inline const char *MCJSONEscapeForChar(uint32_t p_char)
+{
+    switch(p_char)
+    {
+        case '\\':
+            return "\\\\";
+        case '"':
+            return "\\\"";
+        case '\n':
+            return "\\n";
+        case '\r':
+            return "\\r";
+        case '\t':
+            return "\\t";
+        case 0x08:
+            return "\\b";
+        case 0x0c:
+            return "\\f";
+        default:
+            return nullptr;
+    }
+}
+
+// Append the chars of p_string to x_json, escaping as necessary. Runs of chars
+// which need no escaping are copied directly from the source string.
+template<typename CharType>
+static bool MCJSONExportChars(MCStringRef x_json, MCStringRef p_string, const CharType *p_chars, uindex_t p_length)
+{
+    uindex_t t_run_start;
+    t_run_start = 0;
+    for(uindex_t i = 0; i < p_length; i++)
+    {
+        const char *t_escape;
+        t_escape = MCJSONEscapeForChar(p_chars[i]);
+        if (t_escape == nullptr)
+            continue;
+
+        if (!MCStringAppendSubstring(x_json, p_string, MCRangeMakeMinMax(t_run_start, i)) ||
+            !MCStringAppendNativeChars(x_json, (const char_t *)t_escape, 2))
+            return false;
+
+        t_run_start = i + 1;
+    }
+
+    return MCStringAppendSubstring(x_json, p_string, MCRangeMakeMinMax(t_run_start, p_length));
+}
+
+static bool MCJSONExportString(MCStringRef x_json, MCStringRef p_string)
+{
+    if (!MCStringAppendNativeChar(x_json, '"'))
+        return false;
+
+    bool t_success;
+    const char_t *t_native_chars;
+    const unichar_t *t_chars;
+    t_native_chars = MCStringGetNativeCharPtr(p_string);
+    if (t_native_chars != nullptr)
+        t_success = MCJSONExportChars(x_json, p_string, t_native_chars, MCStringGetLength(p_string));
+    else if ((t_chars = MCStringGetCharPtr(p_string)) != nullptr)
+        t_success = MCJSONExportChars(x_json, p_string, t_chars, MCStringGetLength(p_string));
+    else
+    {
+        MCAutoArray<unichar_t> t_buffer;
+        t_success = t_buffer . New(MCStringGetLength(p_string));
+        if (t_success)
+        {
+            MCStringGetChars(p_string, MCRangeMake(0, t_buffer . Size()), t_buffer . Ptr());
+            t_success = MCJSONExportChars(x_json, p_string, t_buffer . Ptr(), t_buffer . Size());
+        }
+    }
+
+    return t_success &&
+            MCStringAppendNativeChar(x_json, '"');
+}
+
+static bool MCJSONExportValue(MCStringRef x_json, MCValueRef p_value)
+{
+    if (p_value == nullptr || p_value == kMCNull)
+        return MCStringAppendNativeChars(x_json, (const char_t *)"null", 4);
+
+    switch(MCValueGetTypeCode(p_value))
+    {
+        case kMCValueTypeCodeString:
+            return MCJSONExportString(x_json, (MCStringRef)p_value);
+
+        case kMCValueTypeCodeNumber:
+        {
+            char t_buffer[64];
+            int t_length;
+            if (MCNumberIsInteger((MCNumberRef)p_value))
+                t_length = snprintf(t_buffer, sizeof(t_buffer), "%d", MCNumberFetchAsInteger((MCNumberRef)p_value));
+            else
+                t_length = snprintf(t_buffer, sizeof(t_buffer), "%g", MCNumberFetchAsReal((MCNumberRef)p_value));
+            return MCStringAppendNativeChars(x_json, (const char_t *)t_buffer, t_length);
+        }
+
+        case kMCValueTypeCodeBoolean:
+            if (p_value == kMCTrue)
+                return MCStringAppendNativeChars(x_json, (const char_t *)"true", 4);
+            return MCStringAppendNativeChars(x_json, (const char_t *)"false", 5);
+
+        case kMCValueTypeCodeProperList:
+        {
+            MCProperListRef t_list;
+            t_list = (MCProperListRef)p_value;
+
+            if (!MCStringAppendNativeChar(x_json, '['))
+                return false;
+
+            for(uindex_t i = 0; i < MCProperListGetLength(t_list); i++)
+            {
+                if (i != 0 && !MCStringAppendNativeChar(x_json, ','))
+                    return false;
+
+                if (!MCJSONExportValue(x_json, MCProperListFetchElementAtIndex(t_list, i)))
+                    return false;
+            }
+
+            return MCStringAppendNativeChar(x_json, ']');
+        }
+
+        case kMCValueTypeCodeArray:
+        {
+            if (!MCStringAppendNativeChar(x_json, '{'))
+                return false;
+
+            uintptr_t t_iterator;
+            t_iterator = 0;
+            MCNameRef t_key;
+            MCValueRef t_element;
+            bool t_first;
+            t_first = true;
+            while(MCArrayIterate((MCArrayRef)p_value, t_iterator, t_key, t_element))
+            {
+                if (!t_first && !MCStringAppendNativeChar(x_json, ','))
+                    return false;
+                t_first = false;
+
+                if (!MCJSONExportString(x_json, MCNameGetString(t_key)) ||
+                    !MCStringAppendNativeChars(x_json, (const char_t *)": ", 2) ||
+                    !MCJSONExportValue(x_json, t_element))
+                    return false;
+            }
+
+            return MCStringAppendNativeChar(x_json, '}');
+        }
+
+        default:
+            return MCErrorThrowGeneric(MCSTR("Unsupported value type for JSON"));
+    }
+}
+
+MC_DLLEXPORT_DEF
+bool MCJSONExport(MCValueRef p_value, MCStringRef& r_json)
+{
+    MCAutoStringRef t_json;
+    if (!MCStringCreateMutable(0, &t_json))
+        return false;
+
+    if (!MCJSONExportValue(*t_json, p_value))
+        return false;
+
+    if (!t_json . MakeImmutable())
+        return false;
+
+    r_json = t_json . Take();
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
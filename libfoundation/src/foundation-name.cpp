@@ -296,6 +296,11 @@ bool MCNameCreate(MCStringRef p_string, MCNameRef& r_name)
 	if (t_success)
 		t_success = MCStringCopy(p_string, t_name -> string);
 
+	// Names last a long time, so they shouldn't keep alive the chars of a
+	// string the given one is a slice of.
+	if (t_success)
+		t_success = __MCStringUnslice(t_name -> string);
+
 	// Now add the name to the table and fill in the rest of the fields.
 	if (t_success)
 	{
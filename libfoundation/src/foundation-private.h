@@ -176,7 +176,13 @@ enum
     // If set, the string has been converted to a number
     kMCStringFlagHasNumber = 1 << 6,
     // If set, indicates that the string can be losslessly nativized
-    kMCStringFlagCanBeNative = 1 << 7
+    kMCStringFlagCanBeNative = 1 << 7,
+    // If set then the string is a slice (i.e. its chars are within those of
+    // its parent, which it keeps alive).
+    kMCStringFlagIsSlice = 1 << 8,
+    // If set then the string holds its chars as UTF-8 bytes (with the byte
+    // count in capacity), which are decoded when the chars are first needed.
+    kMCStringFlagIsUTF8 = 1 << 9
 };
 
 enum
@@ -264,7 +270,12 @@ struct __MCString: public __MCValue
                 unichar_t *chars;
                 char_t *native_chars;
             };
-            double numeric_value;
+            union
+            {
+                double numeric_value;
+                MCStringRef parent;
+                byte_t *utf8_bytes;
+            };
             uindex_t capacity;
             /* The padding is here to ensure the size of the struct is 32-bytes
              * on all platforms. This ensures consistency between Win and UNIX
@@ -279,7 +290,12 @@ struct __MCString: public __MCValue
                 unichar_t *chars;
                 char_t *native_chars;
             };
-            double numeric_value;
+            union
+            {
+                double numeric_value;
+                MCStringRef parent;
+                byte_t *utf8_bytes;
+            };
 #endif
         };
     };
@@ -540,6 +556,9 @@ hash_t __MCStringHash(__MCString *string);
 bool __MCStringIsEqualTo(__MCString *string, __MCString *other_string);
 bool __MCStringCopyDescription(__MCString *string, MCStringRef& r_string);
 bool __MCStringImmutableCopy(__MCString *string, bool release, __MCString*& r_immutable_value);
+// Replaces the given immutable string with a copy owning its chars if it is a
+// slice, rather than sharing those of the string it was sliced from.
+bool __MCStringUnslice(__MCString*& x_string);
 
 bool __MCNameInitialize(void);
 void __MCNameFinalize(void);
@@ -72,6 +72,89 @@ static bool __MCStringResolveIndirect(__MCString *self);
 // Makes direct mutable string indirect, referencing r_new_string.
 static bool __MCStringCopyMutable(__MCString *self, __MCString*& r_new_string);
 
+// Returns true if the string is a slice.
+static bool __MCStringIsSlice(__MCString *self);
+
+// Creates an immutable string referencing the given range of chars of the
+// given immutable string.
+static bool __MCStringCreateSlice(__MCString *self, MCRange p_range, __MCString*& r_string);
+
+// Gives the given slice its own copy of its chars, releasing its parent.
+static bool __MCStringResolveSlice(__MCString *self);
+
+// Creates an immutable string holding a copy of the chars of the given slice,
+// leaving the slice (and its parent) as they are.
+static bool __MCStringCopyUnsliced(__MCString *self, __MCString*& r_string);
+
+// Frees the chars of the given direct string, or releases its parent if it is
+// a slice.
+static void __MCStringDeleteChars(__MCString *self);
+
+// Returns true if a substring of the given string in the given range should
+// share its chars, rather than copy them: the string must be immutable and the
+// substring neither too short nor too small a part of the chars it would keep
+// alive.
+static bool __MCStringCanSlice(__MCString *self, MCRange p_range);
+
+// Returns the length of the string whose chars a slice of the given string
+// would share.
+static uindex_t __MCStringGetSliceOriginalLength(__MCString *self);
+
+// Ensures the chars of the given direct string are followed by an implicit NUL,
+// making the string own its chars if it is a slice which doesn't end at the end
+// of its parent.
+static bool __MCStringEnsureTerminated(__MCString *self);
+
+// Substrings shorter than this are always copied: copying them costs about the
+// same as creating a slice, and the copy doesn't keep the original chars alive.
+#define kMCStringSliceMinLength 64
+
+// Substrings which are more than this many times shorter than the string they
+// are taken from are always copied, so that small substrings don't keep huge
+// strings alive.
+#define kMCStringSliceMaxRatio 256
+
+// Returns true if the string holds its chars as UTF-8.
+static bool __MCStringIsUTF8(__MCString *self);
+
+// Returns true if the given bytes are valid UTF-8 which is better kept as it
+// is than decoded, setting r_char_count to the number of UTF-16 chars they
+// encode.
+static bool __MCStringCanKeepUTF8(const byte_t *p_bytes, uindex_t p_byte_count, uindex_t& r_char_count);
+
+// Creates an immutable string holding a copy of the given UTF-8 bytes.
+static bool __MCStringCreateWithUTF8(const byte_t *p_bytes, uindex_t p_byte_count, uindex_t p_char_count, MCStringRef& r_string);
+
+// Returns the chars decoded from the UTF-8 bytes of the given string, or nil
+// if they haven't been decoded yet.
+static unichar_t *__MCStringGetUTF8Chars(__MCString *self);
+
+// Sets the chars decoded from the UTF-8 bytes of the given string, returning
+// false if another thread has already set them.
+static bool __MCStringPublishUTF8Chars(__MCString *self, unichar_t *p_chars);
+
+// Decodes the chars in the given range of the given string held as UTF-8 into
+// r_chars, using its index to find where the range starts.
+static void __MCStringMapUTF8Range(__MCString *self, MCRange p_range, unichar_t *r_chars);
+
+// Makes the given direct string, which nothing else references, hold its
+// chars only, freeing its UTF-8 bytes.
+static bool __MCStringResolveUTF8(__MCString *self);
+
+// Sets x_self to the direct string holding the chars of the given string,
+// decoding them first if they are held as UTF-8. Operations which read the
+// chars of a string they are given resolve it this way.
+static bool __MCStringResolveChars(__MCString*& x_self);
+
+// Strings holding fewer UTF-8 bytes than this are decoded straight away, as
+// they are likely to be needed as chars soon after.
+#define kMCStringUTF8MinByteCount 64
+
+// The bytes of a string held as UTF-8 are followed by an index holding where
+// every this many chars starts, so that a char or range can be found without
+// decoding the whole string.
+#define kMCStringUTF8IndexStride 64
+
 // Copy the given unicode chars into the target unicode buffer and return true
 // if all the chars being copied in could be native.
 static bool __MCStringCopyChars(unichar_t *target, const unichar_t *source, uindex_t count, bool target_can_be_native);
@@ -337,8 +420,13 @@ bool MCStringCreateWithBytes(const byte_t *p_bytes, uindex_t p_byte_count, MCStr
             
         case kMCStringEncodingUTF8:
         {
-            unichar_t *t_chars;
+            // Keep the UTF-8 if possible, so that the chars are only decoded
+            // if they are needed.
             uindex_t t_char_count;
+            if (__MCStringCanKeepUTF8(p_bytes, p_byte_count, t_char_count))
+                return __MCStringCreateWithUTF8(p_bytes, p_byte_count, t_char_count, r_string);
+            
+            unichar_t *t_chars;
             t_char_count = MCUnicodeCharsMapFromUTF8(p_bytes, p_byte_count, nil, 0);
             if (!MCMemoryNewArray(t_char_count, t_chars))
                 return false;
@@ -1324,6 +1412,14 @@ bool MCStringCopy(MCStringRef self, MCStringRef& r_new_string)
 	// If the string is immutable we can just bump the reference count.
 	if (!MCStringIsMutable(self))
 	{
+        // If the string is a slice using less than half of the chars of a
+        // parent nothing else references, the copy gets its own chars so that
+        // the parent's aren't kept alive any longer than they need to be.
+        if (__MCStringIsSlice(self) &&
+            self -> parent -> references == 1 &&
+            self -> char_count < self -> parent -> char_count / 2)
+            return __MCStringCopyUnsliced(self, r_new_string);
+        
 		r_new_string = self;
 		MCValueRetain(self);
 		return true;
@@ -1411,10 +1507,16 @@ bool MCStringMutableCopyAndRelease(MCStringRef self, MCStringRef& r_new_string)
 {
 	__MCAssertIsString(self);
 
-	if (self -> references == 1)
+	// A slice doesn't own its chars, so it can't be changed in place; its
+	// mutable copy is made in the same way as for a shared string.
+	if (self -> references == 1 && !__MCStringIsSlice(self))
 	{
 		if (!MCStringIsMutable(self))
         {
+            if (__MCStringIsUTF8(self) &&
+                !__MCStringResolveUTF8(self))
+                return false;
+            
 			self -> flags |= kMCStringFlagIsMutable;
             //self -> capacity = self -> char_count;
         }
@@ -1443,8 +1545,31 @@ bool MCStringCopySubstring(MCStringRef self, MCRange p_range, MCStringRef& r_sub
     // Avoid copying in case the substring is actually the whole string
     if (p_range . offset == 0 && self -> char_count < p_range . length)
         return MCStringCopy(self, r_substring);
+    
+    // A substring of a string held as UTF-8 is decoded from the bytes it
+    // covers, so the rest of the string doesn't need to be.
+    if (__MCStringIsUTF8(self) && __MCStringGetUTF8Chars(self) == nil)
+    {
+        __MCStringClampRange(self, p_range);
+        
+        MCAutoArray<unichar_t> t_chars;
+        if (!t_chars . New(p_range . length))
+            return false;
+        
+        __MCStringMapUTF8Range(self, p_range, t_chars . Ptr());
+        return MCStringCreateWithChars(t_chars . Ptr(), p_range . length, r_substring);
+    }
+    
+    if (!__MCStringResolveChars(self))
+        return false;
 
 	__MCStringClampRange(self, p_range);
+    
+    // Substrings of immutable strings share the original's chars if they
+    // are long enough, and not so short that keeping the original alive
+    // would waste memory.
+    if (__MCStringCanSlice(self, p_range))
+        return __MCStringCreateSlice(self, p_range, r_substring);
 	
     if (__MCStringIsNative(self))
         return MCStringCreateWithNativeChars(self -> native_chars + p_range . offset, p_range . length, r_substring);
@@ -1469,8 +1594,8 @@ bool MCStringMutableCopySubstring(MCStringRef self, MCRange p_range, MCStringRef
 {
 	__MCAssertIsString(self);
 
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return false;
     
     __MCStringClampRange(self, p_range);
     
@@ -1624,7 +1749,9 @@ const unichar_t *MCStringGetCharPtr(MCStringRef self)
 		if (!__MCStringResolveIndirect(self))
 			return nil;
     
-	if (!__MCStringUnnativize(self))
+	if (!__MCStringResolveChars(self) ||
+	    !__MCStringUnnativize(self) ||
+	    !__MCStringEnsureTerminated(self))
 	{
 		return nil;
 	}
@@ -1644,6 +1771,9 @@ const char_t *MCStringGetNativeCharPtr(MCStringRef self)
 			if (!__MCStringResolveIndirect(self))
 				return nil;
         
+        if (!__MCStringEnsureTerminated(self))
+            return nil;
+        
         return self -> native_chars;
     }
     
@@ -1655,7 +1785,8 @@ const char_t *MCStringGetNativeCharPtrAndLength(MCStringRef self, uindex_t& r_ch
 {
 	__MCAssertIsString(self);
 
-	if (__MCStringNativize(self, r_char_count))
+	if (__MCStringNativize(self, r_char_count) &&
+	    __MCStringEnsureTerminated(self))
 	{
 		return self->native_chars;
 	}
@@ -1665,6 +1796,21 @@ const char_t *MCStringGetNativeCharPtrAndLength(MCStringRef self, uindex_t& r_ch
 	}
 }
 
+MC_DLLEXPORT_DEF
+const byte_t *MCStringGetUTF8BytePtrAndLength(MCStringRef self, uindex_t& r_byte_count)
+{
+	__MCAssertIsString(self);
+
+    if (__MCStringIsIndirect(self))
+        self = self -> string;
+    
+    if (!__MCStringIsUTF8(self))
+        return nil;
+    
+    r_byte_count = self -> capacity;
+    return self -> utf8_bytes;
+}
+
 MC_DLLEXPORT_DEF
 unichar_t MCStringGetCharAtIndex(MCStringRef self, uindex_t p_index)
 {
@@ -1672,9 +1818,24 @@ unichar_t MCStringGetCharAtIndex(MCStringRef self, uindex_t p_index)
 
     if (__MCStringIsIndirect(self))
         self = self -> string;
+    
+    /* Allow trailing null character (which the chars of a slice are not
+     * followed by) */
+    MCAssert(p_index <= __MCStringGetLength(self));
+    if (p_index == self -> char_count)
+        return 0;
 
-    /* Allow trailing null character */
-    MCAssert(p_index <= MCStringGetLength(self));
+    // A single char of a string held as UTF-8 is found using its index, rather
+    // than decoding all the others.
+    if (__MCStringIsUTF8(self) && __MCStringGetUTF8Chars(self) == nil)
+    {
+        unichar_t t_char;
+        __MCStringMapUTF8Range(self, MCRangeMake(p_index, 1), &t_char);
+        return t_char;
+    }
+    
+    if (!__MCStringResolveChars(self))
+        return 0;
 
     if (__MCStringIsNative(self))
         return MCUnicodeCharMapFromNative(self -> native_chars[p_index]);
@@ -1690,14 +1851,17 @@ char_t MCStringGetNativeCharAtIndex(MCStringRef self, uindex_t p_index)
     if (__MCStringIsIndirect(self))
         self = self -> string;
 
-    /* Allow trailing null character */
+    /* Allow trailing null character (which the chars of a slice are not
+     * followed by) */
     MCAssert(p_index <= __MCStringGetLength(self));
+    if (p_index == self -> char_count)
+        return 0;
 
     if (__MCStringIsNative(self))
         return self -> native_chars[p_index];
     
 	char_t t_native_char;
-	if (MCUnicodeCharMapToNative(self -> chars[p_index], t_native_char))
+	if (MCUnicodeCharMapToNative(MCStringGetCharAtIndex(self, p_index), t_native_char))
 		return t_native_char;
 	return '?';
 }
@@ -1710,8 +1874,31 @@ codepoint_t MCStringGetCodepointAtIndex(MCStringRef self, uindex_t p_index)
     if (__MCStringIsIndirect(self))
         self = self -> string;
     
-    /* Allow trailing null character */
-    MCAssert(p_index <= MCStringGetLength(self));
+    /* Allow trailing null character (which the chars of a slice are not
+     * followed by) */
+    MCAssert(p_index <= __MCStringGetLength(self));
+    if (p_index == self -> char_count)
+        return 0;
+    
+    // The codeunits of a string held as UTF-8 are found using its index, as
+    // for a single char.
+    if (__MCStringIsUTF8(self) && __MCStringGetUTF8Chars(self) == nil)
+    {
+        MCRange t_range;
+        t_range = MCRangeMake(p_index, MCMin(2U, self -> char_count - p_index));
+        
+        unichar_t t_chars[2];
+        __MCStringMapUTF8Range(self, t_range, t_chars);
+        if (t_range . length == 2 &&
+            MCUnicodeCodepointIsLeadingSurrogate(t_chars[0]) &&
+            MCUnicodeCodepointIsTrailingSurrogate(t_chars[1]))
+            return MCUnicodeSurrogatesToCodepoint(t_chars[0], t_chars[1]);
+        
+        return t_chars[0];
+    }
+    
+    if (!__MCStringResolveChars(self))
+        return 0;
 	
 	// If the string is native, map the native encoded char to unicode and
 	// return.
@@ -1724,6 +1911,7 @@ codepoint_t MCStringGetCodepointAtIndex(MCStringRef self, uindex_t p_index)
 	// If the codeunit at the given index is a leading surrogate, and the next
 	// one is a trailing surrogate then build the pair into a codepoint.
 	if (MCUnicodeCodepointIsLeadingSurrogate(self->chars[p_index]) &&
+		p_index + 1 < self->char_count &&
 		MCUnicodeCodepointIsTrailingSurrogate(self->chars[p_index+1]))
 	{
 		return MCUnicodeSurrogatesToCodepoint(self->chars[p_index], self->chars[p_index+1]);
@@ -1741,6 +1929,18 @@ uindex_t MCStringGetChars(MCStringRef self, MCRange p_range, unichar_t *p_chars)
     if (__MCStringIsIndirect(self))
         self = self -> string;
     
+    // A range of the chars of a string held as UTF-8 is decoded from the bytes
+    // it covers.
+    if (__MCStringIsUTF8(self) && __MCStringGetUTF8Chars(self) == nil)
+    {
+        __MCStringClampRange(self, p_range);
+        __MCStringMapUTF8Range(self, p_range, p_chars);
+        return p_range . length;
+    }
+    
+    if (!__MCStringResolveChars(self))
+        return 0;
+    
 	uindex_t t_count;
 	t_count = 0;
 
@@ -1764,8 +1964,8 @@ uindex_t MCStringGetNativeChars(MCStringRef self, MCRange p_range, char_t *p_cha
 {
 	__MCAssertIsString(self);
 
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return 0;
     
 	uindex_t t_count;
 	t_count = 0;
@@ -2210,8 +2410,8 @@ static bool __MCStringFetchCodepointBefore(MCStringRef self, uindex_t& x_index,
 {
     __MCAssertIsString(self);
     
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return false;
     
     if (x_index > self -> char_count)
         return false;
@@ -2241,8 +2441,8 @@ static bool __MCStringFetchCodepointAfter(MCStringRef self, uindex_t& x_index, c
 {
     __MCAssertIsString(self);
     
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return false;
         
     if (x_index >= self -> char_count)
         return false;
@@ -2785,10 +2985,23 @@ bool MCStringConvertToUTF8(MCStringRef p_string, char*& r_utf8string, uindex_t&
 {
 	__MCAssertIsString(p_string);
 
+    // Strings held as UTF-8 already have the bytes that are needed.
+    uindex_t t_byte_count;
+    const byte_t *t_utf8_bytes;
+    t_utf8_bytes = MCStringGetUTF8BytePtrAndLength(p_string, t_byte_count);
+    if (t_utf8_bytes != nil)
+    {
+        if (!MCMemoryNewArray(t_byte_count + 1, r_utf8string))
+            return false;
+        
+        MCMemoryCopy(r_utf8string, t_utf8_bytes, t_byte_count);
+        r_utf8_chars = t_byte_count;
+        return true;
+    }
+    
 	// Allocate an array of chars one byte bigger than needed. As the allocated array
 	// is filled with zeros, this will naturally NUL terminate the string.
     uindex_t t_length;
-    uindex_t t_byte_count;
     unichar_t* t_unichars;
 	t_length = MCStringGetLength(p_string);
     
@@ -2937,8 +3150,8 @@ hash_t MCStringHash(MCStringRef self, MCStringOptions p_options)
 {
 	__MCAssertIsString(self);
 
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return 0;
     
     if (__MCStringIsNative(self))
         return __MCNativeOp_Hash(self -> native_chars,
@@ -2966,13 +3179,25 @@ bool MCStringIsEqualTo(MCStringRef self, MCStringRef p_other, MCStringOptions p_
     if (__MCStringIsEmpty(self) != __MCStringIsEmpty(p_other))
         return false;
 
+    // Only valid UTF-8 is held as such, so two such strings are exactly equal
+    // if and only if their bytes are.
+    if (p_options == kMCStringOptionCompareExact &&
+        __MCStringIsUTF8(self) &&
+        __MCStringIsUTF8(p_other))
+        return self -> capacity == p_other -> capacity &&
+               MCMemoryCompare(self -> utf8_bytes, p_other -> utf8_bytes, self -> capacity) == 0;
+
     bool self_native, other_native;
     self_native = __MCStringIsNative(self);
     other_native = __MCStringIsNative(p_other);
-    
+
     if ((self_native && __MCStringCantBeEqualToNative(p_other, p_options)) || (other_native && __MCStringCantBeEqualToNative(self, p_options)))
         return false;
-    
+
+    if (!__MCStringResolveChars(self) ||
+        !__MCStringResolveChars(p_other))
+        return false;
+
     if (self_native && other_native)
     {
         return __MCNativeOp_IsEqualTo(self -> native_chars,
@@ -3023,8 +3248,8 @@ bool MCStringIsInteger(MCStringRef self)
 {
     __MCAssertIsString(self);
     
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return false;
     
     if (__MCStringIsNative(self))
         return __MCStringIsInteger(self->native_chars, self->char_count);
@@ -3038,11 +3263,11 @@ bool MCStringSubstringIsEqualTo(MCStringRef self, MCRange p_sub, MCStringRef p_o
 	__MCAssertIsString(self);
 	__MCAssertIsString(p_other);
 
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return false;
     
-    if (__MCStringIsIndirect(p_other))
-        p_other = p_other -> string;
+    if (!__MCStringResolveChars(p_other))
+        return false;
     
 	__MCStringClampRange(self, p_sub);
     
@@ -3073,11 +3298,11 @@ bool MCStringSubstringIsEqualToSubstring(MCStringRef self, MCRange p_sub, MCStri
 	__MCAssertIsString(self);
 	__MCAssertIsString(p_other);
 
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return false;
     
-    if (__MCStringIsIndirect(p_other))
-        p_other = p_other -> string;
+    if (!__MCStringResolveChars(p_other))
+        return false;
     
 	__MCStringClampRange(self, p_sub);
     __MCStringClampRange(p_other, p_other_sub);
@@ -3151,11 +3376,11 @@ compare_t MCStringCompareTo(MCStringRef self, MCStringRef p_other, MCStringOptio
 	__MCAssertIsString(self);
 	__MCAssertIsString(p_other);
 
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return 0;
     
-    if (__MCStringIsIndirect(p_other))
-        p_other = p_other -> string;
+    if (!__MCStringResolveChars(p_other))
+        return 0;
     
     if (__MCStringIsNative(self) &&
         __MCStringIsNative(p_other))
@@ -3176,11 +3401,11 @@ bool MCStringBeginsWith(MCStringRef self, MCStringRef p_prefix, MCStringOptions
 	__MCAssertIsString(self);
 	__MCAssertIsString(p_prefix);
 
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return false;
     
-    if (__MCStringIsIndirect(p_prefix))
-        p_prefix = p_prefix -> string;
+    if (!__MCStringResolveChars(p_prefix))
+        return false;
     
     if (__MCStringIsNative(self))
     {
@@ -3211,11 +3436,11 @@ bool MCStringSharedPrefix(MCStringRef self, MCRange p_range, MCStringRef p_prefi
 	__MCAssertIsString(self);
 	__MCAssertIsString(p_prefix);
 
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return false;
     
-    if (__MCStringIsIndirect(p_prefix))
-        p_prefix = p_prefix -> string;
+    if (!__MCStringResolveChars(p_prefix))
+        return false;
     
     __MCStringClampRange(self, p_range);
     
@@ -3278,11 +3503,11 @@ bool MCStringEndsWith(MCStringRef self, MCStringRef p_suffix, MCStringOptions p_
 	__MCAssertIsString(self);
 	__MCAssertIsString(p_suffix);
 
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return false;
     
-    if (__MCStringIsIndirect(p_suffix))
-        p_suffix = p_suffix -> string;
+    if (!__MCStringResolveChars(p_suffix))
+        return false;
     
     if (__MCStringIsNative(self))
     {
@@ -3314,11 +3539,11 @@ bool MCStringSharedSuffix(MCStringRef self, MCRange p_range, MCStringRef p_suffi
 	__MCAssertIsString(self);
 	__MCAssertIsString(p_suffix);
 
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return false;
     
-    if (__MCStringIsIndirect(p_suffix))
-        p_suffix = p_suffix -> string;
+    if (!__MCStringResolveChars(p_suffix))
+        return false;
     
     __MCStringClampRange(self, p_range);
     
@@ -3384,11 +3609,11 @@ bool MCStringContains(MCStringRef self, MCStringRef p_needle, MCStringOptions p_
     if (MCStringIsEmpty(p_needle))
         return false;
     
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return false;
     
-    if (__MCStringIsIndirect(p_needle))
-        p_needle = p_needle -> string;
+    if (!__MCStringResolveChars(p_needle))
+        return false;
 
     if (__MCStringIsNative(self))
     {
@@ -3414,16 +3639,16 @@ bool MCStringSubstringContains(MCStringRef self, MCRange p_range, MCStringRef p_
 	__MCAssertIsString(self);
 	__MCAssertIsString(p_needle);
 
-    if (__MCStringIsIndirect(p_needle))
-        p_needle = p_needle -> string;
+    if (!__MCStringResolveChars(p_needle))
+        return false;
     
     // SN-2014-09-05: [[ Bug 13346 ]] Empty is *never* contained in a string. In the loop, a commong string of length 0
     // will be found, which unfortunaly matches the length of the empty needle.
     if (__MCStringIsEmpty(p_needle))
         return false;
     
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return false;
     
 	__MCStringClampRange(self, p_range);
 
@@ -3465,11 +3690,11 @@ bool MCStringFirstIndexOfStringInRange(MCStringRef self, MCStringRef p_needle, M
 	__MCAssertIsString(self);
 	__MCAssertIsString(p_needle);
 
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return false;
     
-    if (__MCStringIsIndirect(p_needle))
-        p_needle = p_needle -> string;
+    if (!__MCStringResolveChars(p_needle))
+        return false;
     
     __MCStringClampRange(self, p_range);
     
@@ -3523,8 +3748,8 @@ bool MCStringFirstIndexOfCharInRange(MCStringRef self, codepoint_t p_needle, MCR
 {
 	__MCAssertIsString(self);
 
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return false;
     
     __MCStringClampRange(self, p_range);
     
@@ -3570,11 +3795,11 @@ bool MCStringLastIndexOfStringInRange(MCStringRef self, MCStringRef p_needle, MC
 	__MCAssertIsString(self);
 	__MCAssertIsString(p_needle);
 
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return false;
     
-    if (__MCStringIsIndirect(p_needle))
-        p_needle = p_needle -> string;
+    if (!__MCStringResolveChars(p_needle))
+        return false;
     
     __MCStringClampRange(self, p_range);
     
@@ -3607,8 +3832,8 @@ bool MCStringLastIndexOfChar(MCStringRef self, codepoint_t p_needle, uindex_t p_
 {
 	__MCAssertIsString(self);
 
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return false;
     
 	// Make sure the after index is in range.
 	p_before = MCMin(p_before, self -> char_count);
@@ -3702,11 +3927,11 @@ bool MCStringFind(MCStringRef self, MCRange p_range, MCStringRef p_needle, MCStr
 	__MCAssertIsString(self);
 	__MCAssertIsString(p_needle);
 
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return false;
     
-    if (__MCStringIsIndirect(p_needle))
-        p_needle = p_needle -> string;
+    if (!__MCStringResolveChars(p_needle))
+        return false;
     
     __MCStringClampRange(self, p_range);
     
@@ -3715,8 +3940,8 @@ bool MCStringFind(MCStringRef self, MCRange p_range, MCStringRef p_needle, MCStr
 
 static uindex_t MCStringCountStrChars(MCStringRef self, MCRange p_range, const void *p_needle_chars, uindex_t p_needle_char_count, bool p_needle_native, MCStringOptions p_options)
 {
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return 0;
     
 	// Keep track of how many occurrences have been found.
 	uindex_t t_count;
@@ -3762,8 +3987,8 @@ uindex_t MCStringCount(MCStringRef self, MCRange p_range, MCStringRef p_needle,
 	__MCAssertIsString(self);
 	__MCAssertIsString(p_needle);
 
-    if (__MCStringIsIndirect(p_needle))
-        p_needle = p_needle -> string;
+    if (!__MCStringResolveChars(p_needle))
+        return 0;
     
     if (MCStringIsNative(self))
     {
@@ -4133,14 +4358,14 @@ bool MCStringDelimitedOffset(MCStringRef self,
 	__MCAssertIsString(p_needle);
 	__MCAssertIsString(p_delimiter);
     
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return false;
     
-    if (__MCStringIsIndirect(p_needle))
-        p_needle = p_needle -> string;
+    if (!__MCStringResolveChars(p_needle))
+        return false;
     
-    if (__MCStringIsIndirect(p_delimiter))
-        p_delimiter = p_delimiter -> string;
+    if (!__MCStringResolveChars(p_delimiter))
+        return false;
     
     __MCStringClampRange(self, p_range);
     
@@ -4229,11 +4454,11 @@ bool MCStringForwardDelimitedRegion(MCStringRef self,
 	__MCAssertIsString(self);
 	__MCAssertIsString(p_delimiter);
     
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return false;
     
-    if (__MCStringIsIndirect(p_delimiter))
-        p_delimiter = p_delimiter -> string;
+    if (!__MCStringResolveChars(p_delimiter))
+        return false;
     
     __MCStringClampRange(self, p_range);
     
@@ -4394,8 +4619,8 @@ bool MCStringAppend(MCStringRef self, MCStringRef p_suffix)
 {
 	MCAssert(MCStringIsMutable(self));
 
-    if (__MCStringIsIndirect(p_suffix))
-        p_suffix = p_suffix -> string;
+    if (!__MCStringResolveChars(p_suffix))
+        return false;
     
     // Only do the append now if self != suffix.
 	if (self != p_suffix)
@@ -4417,8 +4642,8 @@ bool MCStringAppendSubstring(MCStringRef self, MCStringRef p_suffix, MCRange p_r
 {
 	MCAssert(MCStringIsMutable(self));
   
-    if (__MCStringIsIndirect(p_suffix))
-        p_suffix = p_suffix -> string;
+    if (!__MCStringResolveChars(p_suffix))
+        return false;
 
 	// Only do the append now if self != suffix.
 	if (self != p_suffix)
@@ -4555,8 +4780,8 @@ bool MCStringPrepend(MCStringRef self, MCStringRef p_prefix)
 {
 	MCAssert(MCStringIsMutable(self));
     
-    if (__MCStringIsIndirect(p_prefix))
-        p_prefix = p_prefix -> string;
+    if (!__MCStringResolveChars(p_prefix))
+        return false;
     
  	// Only do the prepend now if self != prefix.
 	if (self != p_prefix)
@@ -4578,8 +4803,8 @@ bool MCStringPrependSubstring(MCStringRef self, MCStringRef p_prefix, MCRange p_
 {
 	MCAssert(MCStringIsMutable(self));
 
-    if (__MCStringIsIndirect(p_prefix))
-        p_prefix = p_prefix -> string;
+    if (!__MCStringResolveChars(p_prefix))
+        return false;
     
     // Only do the prepend now if self != prefix.
 	if (self != p_prefix)
@@ -4711,8 +4936,8 @@ bool MCStringInsert(MCStringRef self, uindex_t p_at, MCStringRef p_substring)
 {
 	MCAssert(MCStringIsMutable(self));
 
-    if (__MCStringIsIndirect(p_substring))
-        p_substring = p_substring -> string;
+    if (!__MCStringResolveChars(p_substring))
+        return false;
     
 	// Only do the insert now if self != substring.
 	if (self != p_substring)
@@ -4734,8 +4959,8 @@ bool MCStringInsertSubstring(MCStringRef self, uindex_t p_at, MCStringRef p_subs
 {
 	MCAssert(MCStringIsMutable(self));
 
-    if (__MCStringIsIndirect(p_substring))
-        p_substring = p_substring -> string;
+    if (!__MCStringResolveChars(p_substring))
+        return false;
     
 	// Only do the insert now if self != substring.
 	if (self != p_substring)
@@ -5044,8 +5269,8 @@ bool MCStringReplace(MCStringRef self, MCRange p_range, MCStringRef p_replacemen
 {
 	__MCAssertIsMutableString(self);
 
-    if (__MCStringIsIndirect(p_replacement))
-        p_replacement = p_replacement -> string;
+    if (!__MCStringResolveChars(p_replacement))
+        return false;
     
 	// Only do the replace now if self != substring.
 	if (self != p_replacement)
@@ -5072,8 +5297,8 @@ bool MCStringPad(MCStringRef self, uindex_t p_at, uindex_t p_count, MCStringRef
         if (!__MCStringResolveIndirect(self))
             return false;
     
-    if (__MCStringIsIndirect(p_value))
-        p_value = p_value -> string;
+    if (p_value != nil && !__MCStringResolveChars(p_value))
+        return false;
     
 	if (!__MCStringExpandAt(self, p_at, p_count * (p_value != nil ? p_value -> char_count : 1)))
 		return false;
@@ -5236,7 +5461,7 @@ bool MCStringSplitNative(MCStringRef self, MCStringRef p_elem_del, MCStringRef p
             split_find_end_of_element_native(t_sptr, t_eptr, p_elem_del -> native_chars, p_elem_del -> char_count, t_element_end, p_options);
             
             MCAutoStringRef t_string;
-            if (!MCStringCreateWithNativeChars(t_sptr, t_element_end - t_sptr, &t_string))
+            if (!MCStringCopySubstring(self, MCRangeMakeMinMax(t_sptr - self -> native_chars, t_element_end - self -> native_chars), &t_string))
                 return false;
             
             if (!MCArrayStoreValueAtIndex(*t_array, t_index, *t_string))
@@ -5270,7 +5495,7 @@ bool MCStringSplitNative(MCStringRef self, MCStringRef p_elem_del, MCStringRef p
 				t_key_end += p_key_del -> char_count;
 
 			MCAutoStringRef t_string;
-			if (!MCStringCreateWithNativeChars(t_key_end, t_element_end - t_key_end, &t_string))
+			if (!MCStringCopySubstring(self, MCRangeMakeMinMax(t_key_end - self -> native_chars, t_element_end - self -> native_chars), &t_string))
 				return false;
             
 			if (!MCArrayStoreValue(*t_array, true, *t_name, *t_string))
@@ -5477,8 +5702,8 @@ bool MCStringSplit(MCStringRef self, MCStringRef p_elem_del, MCStringRef p_key_d
 		__MCAssertIsString(p_key_del);
 
 
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return false;
     
     // SN-2014-03-24: [[ SplitWithStrings ]] No longer checks whether the delimiter is actually 1-char long.
 	if (self -> char_count == 0)
@@ -5497,8 +5722,8 @@ bool MCStringSplit(MCStringRef self, MCStringRef p_elem_del, MCStringRef p_key_d
 	if (!MCArrayCreateMutable(&t_array))
 		return false;
     
-    if (__MCStringIsIndirect(p_elem_del))
-        p_elem_del = p_elem_del -> string;
+    if (!__MCStringResolveChars(p_elem_del))
+        return false;
     
 	const void *t_echar, *t_kchar;
     bool del_native, key_native;
@@ -5507,8 +5732,8 @@ bool MCStringSplit(MCStringRef self, MCStringRef p_elem_del, MCStringRef p_key_d
 
 	if (p_key_del != nil)
     {
-        if (__MCStringIsIndirect(p_key_del))
-            p_key_del = p_key_del -> string;
+        if (!__MCStringResolveChars(p_key_del))
+            return false;
         
         key_native = __MCStringIsNative(p_key_del);
 		t_kchar = p_key_del -> chars;
@@ -5602,8 +5827,8 @@ bool MCStringSplitByDelimiter(MCStringRef self, MCStringRef p_elem_del, MCString
 	__MCAssertIsString(self);
 	__MCAssertIsString(p_elem_del);
 
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return false;
     
     // SN-2014-03-24: [[ SplitWithStrings ]] No longer checks whether the delimiter is actually 1-char long.
 	if (self -> char_count == 0)
@@ -5618,8 +5843,8 @@ bool MCStringSplitByDelimiter(MCStringRef self, MCStringRef p_elem_del, MCString
             return MCStringSplitByDelimiterNative(self, p_elem_del, p_options, r_list);
     }
     
-    if (__MCStringIsIndirect(p_elem_del))
-        p_elem_del = p_elem_del -> string;
+    if (!__MCStringResolveChars(p_elem_del))
+        return false;
     
 	const void *t_echar;
     bool del_native;
@@ -5697,7 +5922,7 @@ MCStringSplitByDelimiterNative(MCStringRef self, MCStringRef p_elem_del, MCStrin
         split_find_end_of_element_native(t_sptr, t_eptr, p_elem_del -> native_chars, p_elem_del -> char_count, t_element_end, p_options);
         
         MCAutoStringRef t_string;
-        if (!MCStringCreateWithNativeChars(t_sptr, t_element_end - t_sptr, &t_string))
+        if (!MCStringCopySubstring(self, MCRangeMakeMinMax(t_sptr - self -> native_chars, t_element_end - self -> native_chars), &t_string))
         {
             return false;
         }
@@ -5786,6 +6011,9 @@ bool MCStringFindAndReplace(MCStringRef self, MCStringRef p_pattern, MCStringRef
     if (__MCStringIsIndirect(self))
         if (!__MCStringResolveIndirect(self))
             return false;
+
+    if (!__MCStringResolveChars(p_replacement))
+        return false;
     
     if (__MCStringIsNative(self))
     {
@@ -5892,6 +6120,10 @@ bool MCStringWildcardMatch(MCStringRef source, MCRange source_range, MCStringRef
 	__MCAssertIsString(source);
 	__MCAssertIsString(pattern);
 
+    if (!__MCStringResolveChars(source) ||
+        !__MCStringResolveChars(pattern))
+        return false;
+
     bool source_native = MCStringIsNative(source);
     
     const void *source_chars;
@@ -5914,10 +6146,7 @@ void __MCStringDestroy(__MCString *self)
     }
     else
     {
-        if (__MCStringIsNative(self))
-            MCMemoryDeleteArray(self -> native_chars);
-        else
-            MCMemoryDeleteArray(self -> chars);
+        __MCStringDeleteChars(self);
     }
 }
 
@@ -6103,6 +6332,9 @@ static bool __MCStringNativize(MCStringRef self, uindex_t & r_char_count)
 		return false;
 	}
     
+    if (!__MCStringResolveChars(self))
+        return false;
+    
     bool t_not_native;
     t_not_native = false;
     
@@ -6122,7 +6354,7 @@ static bool __MCStringNativize(MCStringRef self, uindex_t & r_char_count)
     if (!t_not_native)
     {
 		uindex_t t_ignored;
-        MCMemoryDeleteArray(self -> chars);
+        __MCStringDeleteChars(self);
 		chars.Take(self -> native_chars, t_ignored);
         __MCStringChanged(self, true, true, true);
         self -> flags &= ~kMCStringFlagIsNotNative;
@@ -6171,7 +6403,7 @@ static bool __MCStringNativize(MCStringRef self, uindex_t & r_char_count)
     }
     
     uindex_t t_ignored;
-    MCMemoryDeleteArray(self -> chars);
+    __MCStringDeleteChars(self);
 	chars.Take(self -> native_chars, t_ignored);
 	self -> native_chars[t_char_range.length] = '\0';
     
@@ -6205,7 +6437,7 @@ static bool __MCStringUnnativize(MCStringRef self)
 	}
     
 	MCStrCharsMapFromNative(chars, self -> native_chars, t_char_count);
-	MCMemoryDeleteArray(self -> native_chars);
+	__MCStringDeleteChars(self);
 	self -> chars = chars;
 	self -> char_count = t_char_count;
 	// Set the NUL char.
@@ -6295,8 +6527,8 @@ bool MCStringIsValidSurrogatePair(MCStringRef self, uindex_t p_index)
 {
 	__MCAssertIsString(self);
 
-    if (__MCStringIsIndirect(self))
-        self = self -> string;
+    if (!__MCStringResolveChars(self))
+        return false;
     
     if (__MCStringIsNative(self))
         return false;
@@ -6768,6 +7000,9 @@ __MCStringCreateWithStrings(MCStringRef& r_string, bool p_has_separator, unichar
     if (__MCStringIsIndirect(p_two))
         p_two = p_two->string;
     
+    if (t_success)
+        t_success = __MCStringResolveChars(p_one) && __MCStringResolveChars(p_two);
+    
     // Calculate the required length and is-native status of the result string
     uindex_t t_one_length, t_two_length;
     t_one_length = __MCStringGetLength(p_one);
@@ -6914,6 +7149,9 @@ bool MCStringNormalizedCopyNFC(MCStringRef self, MCStringRef &r_string)
 {
 	__MCAssertIsString(self);
 
+    if (!__MCStringResolveChars(self))
+        return false;
+
     if (MCStringIsNative(self))
         return MCStringCopy(self, r_string);
     
@@ -6947,6 +7185,9 @@ bool MCStringNormalizedCopyNFKC(MCStringRef self, MCStringRef &r_string)
 {
 	__MCAssertIsString(self);
 
+    if (!__MCStringResolveChars(self))
+        return false;
+
     // Native strings are already normalized
     if (MCStringIsNative(self))
         return MCStringCopy(self, r_string);
@@ -6987,7 +7228,9 @@ bool MCStringSetNumericValue(MCStringRef self, double p_value)
     if (__MCStringIsIndirect(self))
         self = self -> string;
     
-    if (MCStringIsMutable(self))
+    // Slices use the space for the numeric value to reference their parent,
+    // and strings held as UTF-8 use it for their bytes.
+    if (MCStringIsMutable(self) || __MCStringIsSlice(self) || __MCStringIsUTF8(self))
         return false;
     
     self -> numeric_value = p_value;
@@ -7128,6 +7371,9 @@ static void __MCStringCheck(MCStringRef self)
     if (__MCStringCanBeNative(self))
         return;
     
+    if (!__MCStringResolveChars(self))
+        return;
+    
     bool t_can_be_native;
     t_can_be_native = true;
     
@@ -7140,7 +7386,8 @@ static void __MCStringCheck(MCStringRef self)
             break;
         }
         
-        if (!MCUnicodeIsGraphemeClusterBoundary(self -> chars[i], self -> chars[i + 1]))
+        if (i + 1 < self -> char_count &&
+            !MCUnicodeIsGraphemeClusterBoundary(self -> chars[i], self -> chars[i + 1]))
         {
             __MCStringSetFlags(self, kMCStringFlagNoChange, false, false);
             t_can_be_native = false;
@@ -7250,10 +7497,19 @@ static bool __MCStringResolveIndirect(__MCString *self)
 	MCStringRef t_string;
 	t_string = self -> string;
     
-	// If the string only has a single reference, then re-absorb; otherwise
-	// copy.
-	if (self -> string -> references == 1)
+    if (!__MCStringResolveChars(t_string))
+        return false;
+    
+	// If the string only has a single reference (and owns its chars), then
+	// re-absorb; otherwise copy.
+	if (self -> string -> references == 1 && !__MCStringIsSlice(t_string))
 	{
+        // Nothing else uses the string, so it can drop any UTF-8 bytes before
+        // its chars are taken.
+        if (__MCStringIsUTF8(t_string) &&
+            !__MCStringResolveUTF8(t_string))
+            return false;
+        
         self -> char_count = t_string -> char_count;
         self -> capacity = t_string -> capacity;
         self -> flags |= t_string -> flags;
@@ -7357,3 +7613,496 @@ static bool __MCStringCopyMutable(__MCString *self, __MCString*& r_new_string)
     r_new_string = t_string;
     return true;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Returns true if the string is a slice.
+static bool __MCStringIsSlice(__MCString *self)
+{
+    return (self -> flags & kMCStringFlagIsSlice) != 0;
+}
+
+// Makes the chars of the given direct immutable string shareable by moving
+// them into a new string, which 'self' then becomes a slice of.
+static bool __MCStringShareChars(__MCString *self)
+{
+    MCAssert(!__MCStringIsIndirect(self) && !__MCStringIsSlice(self));
+    MCAssert(!MCStringIsMutable(self));
+    
+    // The new string owns the chars, and is only ever referenced by slices so
+    // its buffer never changes.
+    MCStringRef t_string;
+    if (!__MCValueCreate(kMCValueTypeCodeString, t_string))
+        return false;
+    
+    t_string -> flags |= self -> flags & (kMCStringFlagIsNotNative | kMCStringFlagCanBeNative);
+    t_string -> char_count = self -> char_count;
+    t_string -> chars = self -> chars;
+    
+    // 'self' keeps its chars ptr but now references the new string (which
+    // overwrites any numeric value).
+    self -> flags &= ~kMCStringFlagHasNumber;
+    self -> flags |= kMCStringFlagIsSlice;
+    self -> capacity = 0;
+    self -> parent = t_string;
+    return true;
+}
+
+static bool __MCStringCanSlice(__MCString *self, MCRange p_range)
+{
+    MCAssert(!__MCStringIsIndirect(self));
+    
+    // The chars of a mutable string can change so they can't be shared.
+    if (MCStringIsMutable(self))
+        return false;
+    
+    if (p_range . length < kMCStringSliceMinLength)
+        return false;
+    
+    if (__MCStringGetSliceOriginalLength(self) / kMCStringSliceMaxRatio > p_range . length)
+        return false;
+    
+    // Strings of unicode chars are only marked as such if they can't be
+    // native, so a substring whose chars all have native equivalents is
+    // copied (as native chars) instead.
+    if (!__MCStringCanBeNative(self))
+    {
+        for (uindex_t i = 0; i < p_range . length; i++)
+        {
+            char_t t_native;
+            if (!MCUnicodeCharMapToNative(self -> chars[p_range . offset + i], t_native))
+                return true;
+        }
+        
+        return false;
+    }
+    
+    return true;
+}
+
+static uindex_t __MCStringGetSliceOriginalLength(__MCString *self)
+{
+    if (__MCStringIsSlice(self))
+        return self -> parent -> char_count;
+    
+    return self -> char_count;
+}
+
+static bool __MCStringEnsureTerminated(__MCString *self)
+{
+    if (!__MCStringIsSlice(self))
+        return true;
+    
+    // A slice which extends to the end of its parent is followed by the
+    // parent's implicit NUL.
+    MCStringRef t_parent;
+    t_parent = self -> parent;
+    if (__MCStringIsNative(self) ?
+            self -> native_chars + self -> char_count == t_parent -> native_chars + t_parent -> char_count :
+            self -> chars + self -> char_count == t_parent -> chars + t_parent -> char_count)
+        return true;
+    
+    return __MCStringResolveSlice(self);
+}
+
+static bool __MCStringCreateSlice(__MCString *self, MCRange p_range, __MCString*& r_string)
+{
+    MCAssert(!__MCStringIsIndirect(self) && !MCStringIsMutable(self));
+    MCAssert(p_range . offset + p_range . length <= self -> char_count);
+    
+    // Slices always reference the string which owns the chars, rather than
+    // another slice.
+    if (!__MCStringIsSlice(self) &&
+        !__MCStringShareChars(self))
+        return false;
+    
+    MCStringRef t_string;
+    if (!__MCValueCreate(kMCValueTypeCodeString, t_string))
+        return false;
+    
+    t_string -> flags |= kMCStringFlagIsSlice;
+    t_string -> flags |= self -> flags & (kMCStringFlagIsNotNative | kMCStringFlagCanBeNative);
+    t_string -> char_count = p_range . length;
+    
+    if (__MCStringIsNative(self))
+        t_string -> native_chars = self -> native_chars + p_range . offset;
+    else
+        t_string -> chars = self -> chars + p_range . offset;
+    
+    t_string -> parent = MCValueRetain(self -> parent);
+    
+    r_string = t_string;
+    return true;
+}
+
+static bool __MCStringResolveSlice(__MCString *self)
+{
+    // Make sure we are a slice.
+    MCAssert(__MCStringIsSlice(self));
+    
+    size_t t_char_size;
+    t_char_size = __MCStringIsNative(self) ? sizeof(char_t) : sizeof(unichar_t);
+    
+    // The chars are always copied: the parent is immutable and its buffer may
+    // be in use elsewhere, so it is never changed.
+    byte_t *t_buffer;
+    if (!MCMemoryNewArray((self -> char_count + 1) * t_char_size, t_buffer))
+        return false;
+    
+    MCMemoryCopy(t_buffer, self -> chars, self -> char_count * t_char_size);
+    
+    MCValueRelease(self -> parent);
+    
+    if (__MCStringIsNative(self))
+    {
+        self -> native_chars = (char_t *)t_buffer;
+        self -> native_chars[self -> char_count] = '\0';
+    }
+    else
+    {
+        self -> chars = (unichar_t *)t_buffer;
+        self -> chars[self -> char_count] = '\0';
+    }
+    
+    self -> flags &= ~kMCStringFlagIsSlice;
+    self -> capacity = 0;
+    
+    return true;
+}
+
+static bool __MCStringCopyUnsliced(__MCString *self, __MCString*& r_string)
+{
+    MCAssert(__MCStringIsSlice(self));
+    
+    if (__MCStringIsNative(self))
+        return MCStringCreateWithNativeChars(self -> native_chars, self -> char_count, r_string);
+    
+    return MCStringCreateWithChars(self -> chars, self -> char_count, r_string);
+}
+
+static void __MCStringDeleteChars(__MCString *self)
+{
+    MCAssert(!__MCStringIsIndirect(self));
+    
+    if (__MCStringIsSlice(self))
+    {
+        MCValueRelease(self -> parent);
+        self -> flags &= ~kMCStringFlagIsSlice;
+    }
+    else if (__MCStringIsUTF8(self))
+    {
+        MCMemoryDeleteArray(__MCStringGetUTF8Chars(self));
+        MCMemoryDeleteArray(self -> utf8_bytes);
+        self -> flags &= ~kMCStringFlagIsUTF8;
+    }
+    else if (__MCStringIsNative(self))
+        MCMemoryDeleteArray(self -> native_chars);
+    else
+        MCMemoryDeleteArray(self -> chars);
+    
+    self -> chars = nil;
+}
+
+bool __MCStringUnslice(__MCString*& x_string)
+{
+    MCAssert(!MCStringIsMutable(x_string));
+    
+    if (!__MCStringIsSlice(x_string))
+        return true;
+    
+    MCStringRef t_string;
+    if (!__MCStringCopyUnsliced(x_string, t_string))
+        return false;
+    
+    MCValueRelease(x_string);
+    x_string = t_string;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static bool __MCStringIsUTF8(__MCString *self)
+{
+    return (self -> flags & kMCStringFlagIsUTF8) != 0;
+}
+
+static bool __MCStringCanKeepUTF8(const byte_t *p_bytes, uindex_t p_byte_count, uindex_t& r_char_count)
+{
+    // The index holds byte offsets in all but the lowest bit of its entries.
+    if (p_byte_count < kMCStringUTF8MinByteCount ||
+        p_byte_count > UINT32_MAX >> 1)
+        return false;
+    
+    uindex_t t_char_count;
+    t_char_count = 0;
+    
+    bool t_can_be_native;
+    t_can_be_native = true;
+    
+    uindex_t t_index;
+    t_index = 0;
+    while (t_index < p_byte_count)
+    {
+        byte_t t_lead;
+        t_lead = p_bytes[t_index];
+        if (t_lead < 0x80)
+        {
+            t_index += 1;
+            t_char_count += 1;
+            continue;
+        }
+        
+        uindex_t t_length;
+        codepoint_t t_codepoint, t_min_codepoint;
+        if ((t_lead & 0xE0) == 0xC0)
+        {
+            t_length = 2;
+            t_codepoint = t_lead & 0x1F;
+            t_min_codepoint = 0x80;
+        }
+        else if ((t_lead & 0xF0) == 0xE0)
+        {
+            t_length = 3;
+            t_codepoint = t_lead & 0x0F;
+            t_min_codepoint = 0x800;
+        }
+        else if ((t_lead & 0xF8) == 0xF0)
+        {
+            t_length = 4;
+            t_codepoint = t_lead & 0x07;
+            t_min_codepoint = 0x10000;
+        }
+        else
+            return false;
+        
+        if (p_byte_count - t_index < t_length)
+            return false;
+        
+        for (uindex_t i = 1; i < t_length; i++)
+        {
+            if ((p_bytes[t_index + i] & 0xC0) != 0x80)
+                return false;
+            t_codepoint = (t_codepoint << 6) | (p_bytes[t_index + i] & 0x3F);
+        }
+        
+        // Overlong sequences, surrogates and codepoints outside the unicode
+        // range are invalid. (The decoder accepts some of these, so such bytes
+        // are decoded straight away to get the same result.)
+        if (t_codepoint < t_min_codepoint ||
+            (t_codepoint >= 0xD800 && t_codepoint < 0xE000) ||
+            t_codepoint > 0x10FFFF)
+            return false;
+        
+        if (t_codepoint < 0x10000)
+        {
+            char_t t_native;
+            if (t_can_be_native &&
+                !MCUnicodeCharMapToNative(unichar_t(t_codepoint), t_native))
+                t_can_be_native = false;
+            t_char_count += 1;
+        }
+        else
+        {
+            t_can_be_native = false;
+            t_char_count += 2;
+        }
+        
+        t_index += t_length;
+    }
+    
+    // Text which can be native takes least space as native chars, and text
+    // which is mostly in scripts needing three bytes per char in UTF-8 takes
+    // less space as UTF-16.
+    if (t_can_be_native || p_byte_count >= t_char_count * 2)
+        return false;
+    
+    r_char_count = t_char_count;
+    return true;
+}
+
+// Returns the number of bytes in the UTF-8 sequence starting with the given
+// (valid) lead byte.
+static uindex_t __MCStringGetUTF8SequenceLength(byte_t p_lead)
+{
+    if (p_lead < 0x80)
+        return 1;
+    if (p_lead < 0xE0)
+        return 2;
+    if (p_lead < 0xF0)
+        return 3;
+    return 4;
+}
+
+// Returns the index of the given string held as UTF-8. Each entry holds the
+// offset of the bytes encoding the char it is for, shifted up by one; the low
+// bit is set if that char is the trailing surrogate of the pair they encode.
+static uint32_t *__MCStringGetUTF8Index(__MCString *self)
+{
+    return (uint32_t *)(self -> utf8_bytes + ((self -> capacity + 3) & ~3));
+}
+
+static bool __MCStringCreateWithUTF8(const byte_t *p_bytes, uindex_t p_byte_count, uindex_t p_char_count, MCStringRef& r_string)
+{
+    __MCString *self;
+    if (!__MCValueCreate(kMCValueTypeCodeString, self))
+        return false;
+    
+    // The index follows the bytes, aligned so its entries can be read
+    // directly.
+    uindex_t t_entry_count;
+    t_entry_count = (p_char_count + kMCStringUTF8IndexStride - 1) / kMCStringUTF8IndexStride;
+    if (!MCMemoryNewArray(((p_byte_count + 3) & ~3) + t_entry_count * sizeof(uint32_t), self -> utf8_bytes))
+    {
+        MCMemoryDelete(self);
+        return false;
+    }
+    
+    MCMemoryCopy(self -> utf8_bytes, p_bytes, p_byte_count);
+    
+    // The string is known not to be native, so it is marked as such - this
+    // means code which only needs to know that doesn't need the chars.
+    self -> flags |= kMCStringFlagIsUTF8 | kMCStringFlagIsNotNative;
+    self -> char_count = p_char_count;
+    self -> capacity = p_byte_count;
+    self -> chars = nil;
+    
+    // The index is built straight away so that, like the bytes, it never
+    // changes once the string has been created.
+    uint32_t *t_index;
+    t_index = __MCStringGetUTF8Index(self);
+    
+    uindex_t t_char, t_entry;
+    t_char = 0;
+    t_entry = 0;
+    for (uindex_t t_offset = 0; t_offset < p_byte_count; )
+    {
+        uindex_t t_length;
+        t_length = __MCStringGetUTF8SequenceLength(p_bytes[t_offset]);
+        
+        uindex_t t_next_char;
+        t_next_char = t_char + (t_length == 4 ? 2 : 1);
+        for (; t_entry * kMCStringUTF8IndexStride < t_next_char; t_entry++)
+            t_index[t_entry] = (t_offset << 1) | (t_entry * kMCStringUTF8IndexStride != t_char ? 1 : 0);
+        
+        t_char = t_next_char;
+        t_offset += t_length;
+    }
+    
+    r_string = self;
+    return true;
+}
+
+static unichar_t *__MCStringGetUTF8Chars(__MCString *self)
+{
+    MCAssert(__MCStringIsUTF8(self));
+    
+#if defined(__WINDOWS__)
+    return (unichar_t *)InterlockedCompareExchangePointer((PVOID volatile *)&self -> chars, nil, nil);
+#else
+    return __atomic_load_n(&self -> chars, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static bool __MCStringPublishUTF8Chars(__MCString *self, unichar_t *p_chars)
+{
+    MCAssert(__MCStringIsUTF8(self));
+    
+#if defined(__WINDOWS__)
+    return InterlockedCompareExchangePointer((PVOID volatile *)&self -> chars, p_chars, nil) == nil;
+#else
+    unichar_t *t_expected;
+    t_expected = nil;
+    return __atomic_compare_exchange_n(&self -> chars, &t_expected, p_chars, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static void __MCStringMapUTF8Range(__MCString *self, MCRange p_range, unichar_t *r_chars)
+{
+    MCAssert(__MCStringIsUTF8(self));
+    MCAssert(p_range . offset + p_range . length <= self -> char_count);
+    
+    if (p_range . length == 0)
+        return;
+    
+    // Start from the indexed char at or before the range, which is one char
+    // further back if it is the trailing surrogate of a pair.
+    uint32_t t_entry;
+    t_entry = __MCStringGetUTF8Index(self)[p_range . offset / kMCStringUTF8IndexStride];
+    
+    uindex_t t_offset, t_char;
+    t_offset = t_entry >> 1;
+    t_char = (p_range . offset / kMCStringUTF8IndexStride) * kMCStringUTF8IndexStride - (t_entry & 1);
+    
+    uindex_t t_end;
+    t_end = p_range . offset + p_range . length;
+    while (t_char < t_end)
+    {
+        const byte_t *t_bytes;
+        t_bytes = self -> utf8_bytes + t_offset;
+        
+        uindex_t t_length;
+        t_length = __MCStringGetUTF8SequenceLength(t_bytes[0]);
+        
+        codepoint_t t_codepoint;
+        if (t_length == 1)
+            t_codepoint = t_bytes[0];
+        else
+        {
+            t_codepoint = t_bytes[0] & (0x7F >> t_length);
+            for (uindex_t i = 1; i < t_length; i++)
+                t_codepoint = (t_codepoint << 6) | (t_bytes[i] & 0x3F);
+        }
+        
+        unichar_t t_units[2];
+        uindex_t t_unit_count;
+        t_unit_count = MCUnicodeCodepointToSurrogates(t_codepoint, t_units[0], t_units[1]) ? 2 : 1;
+        
+        for (uindex_t i = 0; i < t_unit_count; i++, t_char++)
+            if (t_char >= p_range . offset && t_char < t_end)
+                *r_chars++ = t_units[i];
+        
+        t_offset += t_length;
+    }
+}
+
+static bool __MCStringResolveUTF8(__MCString *self)
+{
+    MCAssert(__MCStringIsUTF8(self));
+    
+    if (!__MCStringResolveChars(self))
+        return false;
+    
+    MCMemoryDeleteArray(self -> utf8_bytes);
+    
+    self -> utf8_bytes = nil;
+    self -> capacity = 0;
+    self -> flags &= ~kMCStringFlagIsUTF8;
+    
+    return true;
+}
+
+static bool __MCStringResolveChars(__MCString*& x_self)
+{
+    if (__MCStringIsIndirect(x_self))
+        x_self = x_self -> string;
+    
+    if (!__MCStringIsUTF8(x_self) ||
+        __MCStringGetUTF8Chars(x_self) != nil)
+        return true;
+    
+    // The string is immutable and may be in use elsewhere, so its bytes are
+    // left as they are and the chars are decoded into a new buffer which is
+    // then published atomically. If another thread publishes its chars first,
+    // they are used instead.
+    unichar_t *t_chars;
+    if (!MCMemoryNewArray(x_self -> char_count + 1, t_chars))
+        return false;
+    
+    MCUnicodeCharsMapFromUTF8(x_self -> utf8_bytes, x_self -> capacity, t_chars, x_self -> char_count);
+    t_chars[x_self -> char_count] = 0;
+    
+    if (!__MCStringPublishUTF8Chars(x_self, t_chars))
+        MCMemoryDeleteArray(t_chars);
+    
+    return true;
+}
@@ -22,6 +22,7 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <errno.h>
 #include <dirent.h>
 
@@ -583,14 +584,15 @@ __MCSFileCreateStream (MCStringRef p_native_path,
 
 	if (!t_success)
 	{
+		int t_save_errno = errno;
 		if (t_fd >= 0)
 			close (t_fd);
-		return false; /* FIXME proper error */
+		return __MCSFileThrowOpenErrorWithErrno (p_native_path, t_save_errno);
 	}
 
 	/* Store the newly created cstdio stream in a new MCStream instance. */
 	MCStreamRef t_stream;
-	if (!__MCSStreamCreateWithStdio (t_cstream, t_stream))
+	if (!__MCSStreamCreateWithStdioFile (t_cstream, t_stream))
 	{
 		/* UNCHECKED */ fclose (t_cstream);
 		return false;
@@ -600,6 +602,73 @@ __MCSFileCreateStream (MCStringRef p_native_path,
 	return true;
 }
 
+/* ================================================================
+ * File mapping
+ * ================================================================ */
+
+bool
+__MCSFileMap (MCStringRef p_native_path,
+              const void *& r_base,
+              size_t & r_length)
+{
+	MCAutoStringRefAsSysString t_path_sys;
+	if (!t_path_sys.Lock(p_native_path))
+		return false;
+
+	int t_fd = open (*t_path_sys, O_RDONLY);
+	if (t_fd < 0)
+		return __MCSFileThrowOpenErrorWithErrno (p_native_path, errno);
+
+	/* Only regular files have a fixed size which can be mapped */
+	struct stat t_stat_buf;
+	if (0 != fstat (t_fd, &t_stat_buf))
+	{
+		int t_save_errno = errno;
+		close (t_fd);
+		return __MCSFileThrowReadErrorWithErrno (p_native_path, t_save_errno);
+	}
+
+	if (!S_ISREG (t_stat_buf.st_mode))
+	{
+		close (t_fd);
+		return __MCSFileThrowIOErrorWithErrno (p_native_path, MCSTR("Failed to map '%{path}': not a regular file"), 0);
+	}
+
+	if (uint64_t(t_stat_buf.st_size) > SIZE_MAX)
+	{
+		close (t_fd);
+		return __MCSFileThrowIOErrorWithErrno (p_native_path, MCSTR("File '%{path}' is too large"), 0);
+	}
+
+	/* mmap(2) refuses to create an empty mapping */
+	size_t t_length = size_t(t_stat_buf.st_size);
+	void *t_base = NULL;
+	if (t_length > 0)
+	{
+		t_base = mmap (NULL, t_length, PROT_READ, MAP_PRIVATE, t_fd, 0);
+		if (MAP_FAILED == t_base)
+		{
+			int t_save_errno = errno;
+			close (t_fd);
+			return __MCSFileThrowIOErrorWithErrno (p_native_path, MCSTR("Failed to map '%{path}' into memory: %{description}"), t_save_errno);
+		}
+	}
+
+	/* The mapping keeps the file open */
+	/* UNCHECKED */ close (t_fd);
+
+	r_base = t_base;
+	r_length = t_length;
+	return true;
+}
+
+void
+__MCSFileUnmap (const void *p_base,
+                size_t p_length)
+{
+	/* UNCHECKED */ munmap (const_cast<void *>(p_base), p_length);
+}
+
 /* ================================================================
  * Filesystem operations
  * ================================================================ */
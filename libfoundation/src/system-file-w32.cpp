@@ -762,7 +762,7 @@ __MCSFileCreateStream (MCStringRef p_native_path,
 	}
 	else if (p_mode & kMCSFileOpenModeRead)
 	{
-		t_stream_mode = "r";
+		t_stream_mode = "rb";
 	}
 	else if (p_mode & kMCSFileOpenModeWrite)
 	{
@@ -783,15 +783,101 @@ __MCSFileCreateStream (MCStringRef p_native_path,
 
 	/* Store the newly-created cstdio stream in a new MCStream instance. */
 	MCStreamRef t_stream;
-	if (!__MCSStreamCreateWithStdio (t_cstream, t_stream))
+	if (!__MCSStreamCreateWithStdioFile (t_cstream, t_stream))
 	{
 		/* UNCHECKED */ fclose (t_cstream); /* Also closes underlying handle */
+		return false;
 	}
 
 	r_stream = t_stream;
 	return true;
 }
 
+/* ================================================================
+ * File mapping
+ * ================================================================ */
+
+bool
+__MCSFileMap (MCStringRef p_native_path,
+              const void *& r_base,
+              size_t & r_length)
+{
+	MCAutoStringRefAsWString t_path_w32;
+	if (!t_path_w32.Lock(p_native_path))
+		return false;
+
+	HANDLE t_handle;
+	t_handle = CreateFileW (*t_path_w32,            /* filename */
+	                        GENERIC_READ,           /* desired access */
+	                        FILE_SHARE_READ,        /* share mode */
+	                        NULL,                   /* security attr. */
+	                        OPEN_EXISTING,          /* creation disp. */
+	                        FILE_ATTRIBUTE_NORMAL,  /* flags & attrs. */
+	                        NULL);                  /* template file */
+
+	if (t_handle == INVALID_HANDLE_VALUE)
+	{
+		return __MCSFileThrowOpenErrorWithErrorCode (p_native_path, GetLastError());
+	}
+
+	LARGE_INTEGER t_file_size_struct;
+	if (!GetFileSizeEx (t_handle, &t_file_size_struct))
+	{
+		DWORD t_error = GetLastError();
+		/* UNCHECKED */ CloseHandle (t_handle);
+		return __MCSFileThrowIOErrorWithErrorCode (p_native_path, MCSTR("Failed to map '%{path}'; GetFileSizeEx() failed: %{description}"), t_error);
+	}
+
+	if (t_file_size_struct.QuadPart < 0 || uint64_t(t_file_size_struct.QuadPart) > SIZE_MAX)
+	{
+		/* UNCHECKED */ CloseHandle (t_handle);
+		return __MCSFileThrowIOErrorWithErrorCode (p_native_path, MCSTR("File '%{path}' is too large"), 0);
+	}
+
+	/* CreateFileMappingW() refuses to map an empty file */
+	size_t t_length = size_t(t_file_size_struct.QuadPart);
+	void *t_base = NULL;
+	if (t_length > 0)
+	{
+		/* Save the error before closing the mapping, which can
+		 * replace it. */
+		DWORD t_error = 0;
+
+		HANDLE t_mapping;
+		t_mapping = CreateFileMappingW (t_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (NULL != t_mapping)
+		{
+			t_base = MapViewOfFile (t_mapping, FILE_MAP_READ, 0, 0, 0);
+			if (NULL == t_base)
+				t_error = GetLastError();
+
+			/* The view keeps the mapping open */
+			/* UNCHECKED */ CloseHandle (t_mapping);
+		}
+		else
+			t_error = GetLastError();
+
+		if (NULL == t_base)
+		{
+			/* UNCHECKED */ CloseHandle (t_handle);
+			return __MCSFileThrowIOErrorWithErrorCode (p_native_path, MCSTR("Failed to map '%{path}' into memory: %{description}"), t_error);
+		}
+	}
+
+	/* UNCHECKED */ CloseHandle (t_handle);
+
+	r_base = t_base;
+	r_length = t_length;
+	return true;
+}
+
+void
+__MCSFileUnmap (const void *p_base,
+                size_t p_length)
+{
+	/* UNCHECKED */ UnmapViewOfFile (p_base);
+}
+
 /* ================================================================
  * Filesystem operations
  * ================================================================ */
@@ -161,6 +161,176 @@ MCSFileCreateStream (MCStringRef p_path,
 	return __MCSFileCreateStream (t_native_path, p_mode, r_stream);
 }
 
+/* ================================================================
+ * Mapped file streams
+ * ================================================================ */
+
+struct __MCSMappedFileStream
+{
+	/* The path the stream was created with, for error messages */
+	MCStringRef m_path;
+	const byte_t *m_base;
+	size_t m_length;
+	size_t m_pointer;
+	size_t m_mark;
+};
+
+static __MCSMappedFileStream *
+__MCSMappedFileStreamFromStreamRef (MCStreamRef p_stream)
+{
+	return (__MCSMappedFileStream *) MCStreamGetExtraBytesPtr (p_stream);
+}
+
+static bool
+__MCSMappedFileStreamThrowEOFError (__MCSMappedFileStream *self)
+{
+	return MCErrorCreateAndThrow (kMCSFileEndOfFileErrorTypeInfo,
+	                              "path", self->m_path,
+	                              NULL);
+}
+
+static void
+__MCSMappedFileStreamDestroy (MCStreamRef p_stream)
+{
+	__MCSMappedFileStream *self = __MCSMappedFileStreamFromStreamRef (p_stream);
+
+	if (NULL != self->m_base)
+		__MCSFileUnmap (self->m_base, self->m_length);
+	MCValueRelease (self->m_path);
+}
+
+static bool
+__MCSMappedFileStreamIsFinished (MCStreamRef p_stream,
+                                 bool & r_finished)
+{
+	__MCSMappedFileStream *self = __MCSMappedFileStreamFromStreamRef (p_stream);
+	r_finished = (self->m_pointer == self->m_length);
+	return true;
+}
+
+static bool
+__MCSMappedFileStreamGetAvailableForRead (MCStreamRef p_stream,
+                                          size_t & r_amount)
+{
+	__MCSMappedFileStream *self = __MCSMappedFileStreamFromStreamRef (p_stream);
+	r_amount = self->m_length - self->m_pointer;
+	return true;
+}
+
+static bool
+__MCSMappedFileStreamRead (MCStreamRef p_stream,
+                           void *x_buffer,
+                           size_t p_amount)
+{
+	__MCSMappedFileStream *self = __MCSMappedFileStreamFromStreamRef (p_stream);
+
+	if (p_amount > self->m_length - self->m_pointer)
+		return __MCSMappedFileStreamThrowEOFError (self);
+
+	MCMemoryCopy (x_buffer, self->m_base + self->m_pointer, p_amount);
+	self->m_pointer += p_amount;
+	return true;
+}
+
+static bool
+__MCSMappedFileStreamSkip (MCStreamRef p_stream,
+                           size_t p_amount)
+{
+	__MCSMappedFileStream *self = __MCSMappedFileStreamFromStreamRef (p_stream);
+
+	if (p_amount > self->m_length - self->m_pointer)
+		return __MCSMappedFileStreamThrowEOFError (self);
+
+	self->m_pointer += p_amount;
+	return true;
+}
+
+/* The whole file is always available, so the read limit doesn't
+ * matter. */
+static bool
+__MCSMappedFileStreamMark (MCStreamRef p_stream,
+                           size_t p_limit)
+{
+	__MCSMappedFileStream *self = __MCSMappedFileStreamFromStreamRef (p_stream);
+	self->m_mark = self->m_pointer;
+	return true;
+}
+
+static bool
+__MCSMappedFileStreamReset (MCStreamRef p_stream)
+{
+	__MCSMappedFileStream *self = __MCSMappedFileStreamFromStreamRef (p_stream);
+	self->m_pointer = self->m_mark;
+	return true;
+}
+
+static bool
+__MCSMappedFileStreamTell (MCStreamRef p_stream,
+                           filepos_t & r_position)
+{
+	__MCSMappedFileStream *self = __MCSMappedFileStreamFromStreamRef (p_stream);
+	return MCNarrow (self->m_pointer, r_position);
+}
+
+static bool
+__MCSMappedFileStreamSeek (MCStreamRef p_stream,
+                           filepos_t p_position)
+{
+	__MCSMappedFileStream *self = __MCSMappedFileStreamFromStreamRef (p_stream);
+
+	if (p_position < 0 || uint64_t(p_position) > self->m_length)
+		return __MCSMappedFileStreamThrowEOFError (self);
+
+	self->m_pointer = size_t(p_position);
+	return true;
+}
+
+static MCStreamCallbacks __kMCSMappedFileStreamCallbacks = {
+	__MCSMappedFileStreamDestroy,
+	__MCSMappedFileStreamIsFinished,
+	__MCSMappedFileStreamGetAvailableForRead,
+	__MCSMappedFileStreamRead,
+	nil,
+	nil,
+	__MCSMappedFileStreamSkip,
+	__MCSMappedFileStreamMark,
+	__MCSMappedFileStreamReset,
+	__MCSMappedFileStreamTell,
+	__MCSMappedFileStreamSeek,
+};
+
+MC_DLLEXPORT_DEF bool
+MCSFileCreateMappedStream (MCStringRef p_path,
+                           MCStreamRef & r_stream)
+{
+	MCS_FILE_CONVERT_PATH(p_path, t_native_path);
+
+	const void *t_base;
+	size_t t_length;
+	if (!__MCSFileMap (t_native_path, t_base, t_length))
+		return false;
+
+	MCStreamRef t_stream;
+	if (!MCStreamCreate (&__kMCSMappedFileStreamCallbacks,
+	                     sizeof (__MCSMappedFileStream),
+	                     t_stream))
+	{
+		if (NULL != t_base)
+			__MCSFileUnmap (t_base, t_length);
+		return false;
+	}
+
+	__MCSMappedFileStream *self = __MCSMappedFileStreamFromStreamRef (t_stream);
+	self->m_path = MCValueRetain (p_path);
+	self->m_base = (const byte_t *) t_base;
+	self->m_length = t_length;
+	self->m_pointer = 0;
+	self->m_mark = 0;
+
+	r_stream = t_stream;
+	return true;
+}
+
 /* ================================================================
  * File system operations
  * ================================================================ */
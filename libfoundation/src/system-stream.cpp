@@ -26,6 +26,8 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #include <foundation-auto.h>
 
 #include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 
 #ifdef __WINDOWS__
 #  if defined(_CRT_DISABLE_PERFCRIT_LOCKS) && !defined(_DLL)
@@ -34,6 +36,11 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #    define fseeko _fseeki64
 #  endif
 #  define ftello _ftelli64
+#  define fileno _fileno
+#  define fstat _fstati64
+typedef struct _stati64 __MCSStdioStat;
+#else
+typedef struct stat __MCSStdioStat;
 #endif
 
 /*
@@ -48,6 +55,10 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
  * 2) Use e.g. MCSStreamGetStandardOutput() to obtain one of the three
  *    "standard" streams.
  *
+ * Streams created with __MCSStreamCreateWithStdioFile() are known to
+ * be backed by a file, so they are given a large buffer and also
+ * support skipping and marking.
+ *
  * FIXME known issues:
  *
  * 1) MCStreamIsReadable() returns true for write-only streams, and
@@ -157,12 +168,33 @@ __MCSStreamThrowEOFError (void)
  * C stdio stream structure and accessors
  * ================================================================ */
 
-/* Forward declaration for the vtable */
+/* Forward declarations for the vtables */
 extern MCStreamCallbacks __kMCSStdioStreamCallbacks;
+extern MCStreamCallbacks __kMCSStdioFileStreamCallbacks;
+
+/* The size of the buffer given to file streams.  This is much larger
+ * than the default stdio buffer so that reading a file a few bytes at
+ * a time doesn't cost a system call every few kilobytes. */
+#define kMCSStdioFileStreamBufferSize (64 * 1024)
+
+/* The direction of the last transfer on a stdio stream, used to
+ * decide when a positioning call is needed to interleave reads and
+ * writes. */
+enum __MCSStdioStreamDirection
+{
+	kMCSStdioStreamDirectionNone,
+	kMCSStdioStreamDirectionRead,
+	kMCSStdioStreamDirectionWrite,
+};
 
 struct __MCSStdioStream
 {
 	FILE *m_cstream;
+	/* Position recorded by MCStreamMark() (file streams only) */
+	filepos_t m_mark;
+	/* Direction of the last read or write since the stream was
+	 * created or last repositioned */
+	__MCSStdioStreamDirection m_direction;
 };
 
 /* Helper function for obtaining the __MCSStdioStream pointer from a
@@ -172,7 +204,8 @@ static __MCSStdioStream *
 __MCSStdioStreamFromStreamRef (MCStreamRef p_stream)
 {
 	MCAssert (p_stream);
-	MCAssert (&__kMCSStdioStreamCallbacks == MCStreamGetCallbacks (p_stream));
+	MCAssert (&__kMCSStdioStreamCallbacks == MCStreamGetCallbacks (p_stream) ||
+	          &__kMCSStdioFileStreamCallbacks == MCStreamGetCallbacks (p_stream));
 
 	return (__MCSStdioStream *) MCStreamGetExtraBytesPtr (p_stream);
 }
@@ -190,17 +223,35 @@ __MCSStdioStreamGetCStream (MCStreamRef p_stream)
  * ================================================================ */
 
 /* The C library specification requires a file positioning function
- * (even if it's a no-op) to interleave when switching from reading a
- * file stream to writing it.  We ignore a possible error from
- * fseek(3) here, because it doesn't make any difference whether it
- * succeeds or not. */
+ * (even if it's a no-op) to interleave when switching between reading
+ * and writing a file stream.  Seeking by zero bytes from the current
+ * position leaves the stream where it is, but discards the read
+ * buffer, so it is only done when the direction changes.  We ignore a
+ * possible error from fseek(3) here, because it doesn't make any
+ * difference whether it succeeds or not. */
 static bool
-__MCSStdioStreamInterleave (MCStreamRef p_stream)
+__MCSStdioStreamInterleave (MCStreamRef p_stream,
+                            __MCSStdioStreamDirection p_direction)
 {
-	/* UNCHECKED */ fseek (__MCSStdioStreamGetCStream (p_stream), 0, SEEK_END);
+	__MCSStdioStream *self = __MCSStdioStreamFromStreamRef (p_stream);
+
+	if (self->m_direction != kMCSStdioStreamDirectionNone &&
+	    self->m_direction != p_direction)
+		/* UNCHECKED */ fseek (self->m_cstream, 0, SEEK_CUR);
+
+	self->m_direction = p_direction;
 	return true;
 }
 
+/* Record that the stream has been repositioned, which also interleaves
+ * reads and writes. */
+static void
+__MCSStdioStreamRepositioned (MCStreamRef p_stream)
+{
+	__MCSStdioStreamFromStreamRef (p_stream)->m_direction =
+		kMCSStdioStreamDirectionNone;
+}
+
 static void
 __MCSStdioStreamDestroy (MCStreamRef p_stream)
 {
@@ -216,7 +267,7 @@ __MCSStdioStreamDestroy (MCStreamRef p_stream)
 
 /* Read p_amount bytes from p_stream into x_buffer.  If less than
  * p_amount bytes are available, fail, discarding any bytes that were
- * successfully read.
+ * successfully read (the contents of x_buffer are then undefined).
  *
  * FIXME see the "known issues" at the top of this file.
  */
@@ -228,15 +279,12 @@ __MCSStdioStreamRead (MCStreamRef p_stream,
 	bool t_success = true;
 	FILE *t_stream = __MCSStdioStreamGetCStream (p_stream);
 
-	if (!__MCSStdioStreamInterleave (p_stream))
+	if (!__MCSStdioStreamInterleave (p_stream, kMCSStdioStreamDirectionRead))
 		return false;
 
-	byte_t *t_buffer = nullptr;
+	byte_t *t_buffer = (byte_t *) x_buffer;
 	size_t t_total_read = 0;
 
-	if (t_success)
-		t_success = MCMemoryNewArray (p_amount, t_buffer);
-
 	errno = 0;
 	while (t_success)
 	{
@@ -266,11 +314,6 @@ __MCSStdioStreamRead (MCStreamRef p_stream,
 		}
 	}
 
-	/* On success, copy the data that was read into place */
-	if (t_success)
-		MCMemoryCopy (x_buffer, t_buffer, p_amount);
-
-	MCMemoryDeleteArray (t_buffer);
 	return t_success;
 }
 
@@ -287,7 +330,7 @@ __MCSStdioStreamWrite (MCStreamRef p_stream,
 	bool t_success = true;
 	FILE *t_stream = __MCSStdioStreamGetCStream (p_stream);
 
-	if (!__MCSStdioStreamInterleave (p_stream))
+	if (!__MCSStdioStreamInterleave (p_stream, kMCSStdioStreamDirectionWrite))
 		return false;
 
 	size_t t_total_written = 0;
@@ -342,6 +385,7 @@ __MCSStdioStreamSeek (MCStreamRef p_stream,
 	if (status != 0)
 		return __MCSStreamThrowIOError (MCSTR("Failed to seek in stream: %{description}"), errno);
 
+	__MCSStdioStreamRepositioned (p_stream);
 	return true;
 }
 
@@ -375,27 +419,172 @@ MCStreamCallbacks __kMCSStdioStreamCallbacks = {
     __MCSStdioStreamSeek,
 };
 
+/* ================================================================
+ * File stream implementation callback functions
+ * ================================================================ */
+
+/* Get the number of bytes between the current position of a file
+ * stream and the end of the file.  Fails without throwing if the
+ * stream isn't backed by a regular file, because then its length
+ * isn't known. */
+static bool
+__MCSStdioFileStreamGetRemaining (MCStreamRef p_stream,
+                                  filepos_t & r_remaining)
+{
+	FILE *t_stream = __MCSStdioStreamGetCStream (p_stream);
+
+	__MCSStdioStat t_stat_buf;
+	if (0 != fstat (fileno (t_stream), &t_stat_buf) ||
+	    S_IFREG != (t_stat_buf.st_mode & S_IFMT))
+		return false;
+
+	filepos_t t_offset;
+	if (!__MCSStdioStreamTell (p_stream, t_offset))
+		return false;
+
+	r_remaining = (t_offset < t_stat_buf.st_size) ? t_stat_buf.st_size - t_offset : 0;
+	return true;
+}
+
+/* feof(3) only becomes true once a read has failed, so instead look
+ * ahead by a byte. */
+static bool
+__MCSStdioFileStreamIsFinished (MCStreamRef p_stream,
+                                bool & r_finished)
+{
+	FILE *t_stream = __MCSStdioStreamGetCStream (p_stream);
+
+	if (!__MCSStdioStreamInterleave (p_stream, kMCSStdioStreamDirectionRead))
+		return false;
+
+	int t_char = getc (t_stream);
+	if (EOF == t_char)
+	{
+		if (ferror (t_stream))
+		{
+			int t_save_errno = errno;
+			clearerr (t_stream);
+			return __MCSStreamThrowIOError (MCSTR("Failed to read from stream: %{description}"), t_save_errno);
+		}
+
+		r_finished = true;
+		return true;
+	}
+
+	ungetc (t_char, t_stream);
+	r_finished = false;
+	return true;
+}
+
+static bool
+__MCSStdioFileStreamGetAvailableForRead (MCStreamRef p_stream,
+                                         size_t & r_amount)
+{
+	filepos_t t_remaining;
+	if (!__MCSStdioFileStreamGetRemaining (p_stream, t_remaining))
+		return false;
+
+	r_amount = size_t(MCMin (uint64_t(t_remaining), uint64_t(SIZE_MAX)));
+	return true;
+}
+
+/* Skipping past the end of a regular file is an end-of-file error,
+ * just as reading past it would be. */
+static bool
+__MCSStdioFileStreamSkip (MCStreamRef p_stream,
+                          size_t p_amount)
+{
+	FILE *t_stream = __MCSStdioStreamGetCStream (p_stream);
+
+	filepos_t t_remaining;
+	if (__MCSStdioFileStreamGetRemaining (p_stream, t_remaining) &&
+	    filepos_t(p_amount) > t_remaining)
+		return __MCSStreamThrowEOFError();
+
+	errno = 0;
+	if (0 != fseeko (t_stream, p_amount, SEEK_CUR))
+		return __MCSStreamThrowIOError (MCSTR("Failed to skip in stream: %{description}"), errno);
+
+	__MCSStdioStreamRepositioned (p_stream);
+	return true;
+}
+
+/* Files can be repositioned freely, so the read limit doesn't
+ * matter. */
+static bool
+__MCSStdioFileStreamMark (MCStreamRef p_stream,
+                          size_t p_limit)
+{
+	__MCSStdioStream *self = __MCSStdioStreamFromStreamRef (p_stream);
+	return __MCSStdioStreamTell (p_stream, self->m_mark);
+}
+
+static bool
+__MCSStdioFileStreamReset (MCStreamRef p_stream)
+{
+	__MCSStdioStream *self = __MCSStdioStreamFromStreamRef (p_stream);
+	return __MCSStdioStreamSeek (p_stream, self->m_mark);
+}
+
+MCStreamCallbacks __kMCSStdioFileStreamCallbacks = {
+    __MCSStdioStreamDestroy,
+    __MCSStdioFileStreamIsFinished,
+    __MCSStdioFileStreamGetAvailableForRead,
+    __MCSStdioStreamRead,
+    nil,
+    __MCSStdioStreamWrite,
+    __MCSStdioFileStreamSkip,
+    __MCSStdioFileStreamMark,
+    __MCSStdioFileStreamReset,
+    __MCSStdioStreamTell,
+    __MCSStdioStreamSeek,
+};
+
 /* ================================================================
  * Stdio stream creation
  * ================================================================ */
 
-bool
-__MCSStreamCreateWithStdio (FILE *p_cstream,
-                            MCStreamRef & r_stream)
+static bool
+__MCSStreamCreateWithCallbacks (MCStreamCallbacks *p_callbacks,
+                                FILE *p_cstream,
+                                MCStreamRef & r_stream)
 {
 	MCStreamRef t_stream;
-	if (!MCStreamCreate (&__kMCSStdioStreamCallbacks,
+	if (!MCStreamCreate (p_callbacks,
 	                     sizeof (__MCSStdioStream),
 	                     t_stream))
 		return false;
 
 	__MCSStdioStream *t_state = __MCSStdioStreamFromStreamRef (t_stream);
 	t_state->m_cstream = p_cstream;
+	t_state->m_mark = 0;
+	t_state->m_direction = kMCSStdioStreamDirectionNone;
 
 	r_stream = t_stream;
 	return true;
 }
 
+bool
+__MCSStreamCreateWithStdio (FILE *p_cstream,
+                            MCStreamRef & r_stream)
+{
+	return __MCSStreamCreateWithCallbacks (&__kMCSStdioStreamCallbacks,
+	                                       p_cstream, r_stream);
+}
+
+bool
+__MCSStreamCreateWithStdioFile (FILE *p_cstream,
+                                MCStreamRef & r_stream)
+{
+	/* This must happen before any other operation on the stream.  If
+	 * it fails, the default buffer is used, which is merely slower. */
+	/* UNCHECKED */ setvbuf (p_cstream, NULL, _IOFBF,
+	                         kMCSStdioFileStreamBufferSize);
+
+	return __MCSStreamCreateWithCallbacks (&__kMCSStdioFileStreamCallbacks,
+	                                       p_cstream, r_stream);
+}
+
 /* ================================================================
  * Standard streams
  * ================================================================ */
@@ -0,0 +1,303 @@
+/* Copyright (C) 2003-2015 LiveCode Ltd.
+
+This file is part of LiveCode.
+
+LiveCode is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License v3 as published by the Free
+Software Foundation.
+
+LiveCode is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
+
+#include "gtest/gtest.h"
+
+#include "foundation.h"
+#include "foundation-auto.h"
+#include "foundation-filters.h"
+
+#include "zlib.h"
+
+// Create data which compresses moderately well, like text does.
+static bool CreateSampleData(uindex_t p_length, MCDataRef& r_data)
+{
+    MCAutoByteArray t_bytes;
+    if (!t_bytes . New(p_length))
+        return false;
+
+    uint32_t t_seed = 12345;
+    for (uindex_t i = 0; i < p_length; i++)
+    {
+        t_seed = t_seed * 1103515245 + 12345;
+        t_bytes . Bytes()[i] = 'a' + (t_seed >> 16) % 8;
+    }
+
+    return t_bytes . CreateDataAndRelease(r_data);
+}
+
+static void ExpectRoundTrip(MCDataRef p_data, int p_level, uindex_t p_max_threads = 1)
+{
+    MCAutoDataRef t_compressed;
+    ASSERT_TRUE(MCFiltersCompressWithLevelAndThreads(p_data, p_level, p_max_threads, &t_compressed));
+    EXPECT_TRUE(MCFiltersIsCompressed(*t_compressed));
+
+    MCAutoDataRef t_decompressed;
+    ASSERT_TRUE(MCFiltersDecompress(*t_compressed, &t_decompressed));
+    EXPECT_TRUE(MCDataIsEqualTo(p_data, *t_decompressed)) << "level " << p_level;
+}
+
+TEST(filters, compress_levels)
+{
+    MCAutoDataRef t_data;
+    ASSERT_TRUE(CreateSampleData(100000, &t_data));
+
+    for (int t_level = kMCFiltersCompressionLevelDefault; t_level <= kMCFiltersCompressionLevelMax; t_level++)
+        ExpectRoundTrip(*t_data, t_level);
+
+    ExpectRoundTrip(kMCEmptyData, kMCFiltersCompressionLevelDefault);
+
+    MCAutoDataRef t_stored, t_best;
+    ASSERT_TRUE(MCFiltersCompressWithLevel(*t_data, 0, &t_stored));
+    ASSERT_TRUE(MCFiltersCompressWithLevel(*t_data, 9, &t_best));
+    EXPECT_GT(MCDataGetLength(*t_stored), MCDataGetLength(*t_data));
+    EXPECT_LT(MCDataGetLength(*t_best), MCDataGetLength(*t_data) / 2);
+}
+
+TEST(filters, compress_blocks)
+{
+    // Several blocks, the last of which is partial.
+    MCAutoDataRef t_data;
+    ASSERT_TRUE(CreateSampleData(5 * 1024 * 1024 + 1234, &t_data));
+    ExpectRoundTrip(*t_data, kMCFiltersCompressionLevelDefault, 0);
+    ExpectRoundTrip(*t_data, 1, 0);
+    ExpectRoundTrip(*t_data, kMCFiltersCompressionLevelDefault, 2);
+    ExpectRoundTrip(*t_data, kMCFiltersCompressionLevelDefault);
+}
+
+TEST(filters, zlib_compress)
+{
+    // Several blocks, so that the adler32 checksums of the blocks are combined.
+    MCAutoDataRef t_data;
+    ASSERT_TRUE(CreateSampleData(3 * 1024 * 1024 + 99, &t_data));
+
+    for (int t_level = kMCFiltersCompressionLevelDefault; t_level <= kMCFiltersCompressionLevelMax; t_level += 4)
+    {
+        MCAutoDataRef t_compressed;
+        ASSERT_TRUE(MCFiltersZlibCompressBytes(MCDataGetBytePtr(*t_data), MCDataGetLength(*t_data), t_level, 0, &t_compressed));
+
+        uLongf t_length = MCDataGetLength(*t_data);
+        MCAutoByteArray t_decompressed;
+        ASSERT_TRUE(t_decompressed . New(t_length));
+        ASSERT_EQ(Z_OK, uncompress(t_decompressed . Bytes(), &t_length, MCDataGetBytePtr(*t_compressed), MCDataGetLength(*t_compressed))) << "level " << t_level;
+        ASSERT_EQ(MCDataGetLength(*t_data), t_length);
+        EXPECT_EQ(0, memcmp(t_decompressed . Bytes(), MCDataGetBytePtr(*t_data), t_length));
+    }
+}
+
+TEST(filters, zlib_compress_single_thread)
+{
+    // On one thread the input is deflated as a single block, exactly as zlib
+    // itself would deflate it.
+    MCAutoDataRef t_data;
+    ASSERT_TRUE(CreateSampleData(3 * 1024 * 1024 + 99, &t_data));
+
+    MCAutoDataRef t_compressed;
+    ASSERT_TRUE(MCFiltersZlibCompressBytes(MCDataGetBytePtr(*t_data), MCDataGetLength(*t_data), 6, 1, &t_compressed));
+
+    uLongf t_length = compressBound(MCDataGetLength(*t_data));
+    MCAutoByteArray t_expected;
+    ASSERT_TRUE(t_expected . New(t_length));
+    ASSERT_EQ(Z_OK, compress2(t_expected . Bytes(), &t_length, MCDataGetBytePtr(*t_data), MCDataGetLength(*t_data), 6));
+    ASSERT_EQ(t_length, MCDataGetLength(*t_compressed));
+    EXPECT_EQ(0, memcmp(t_expected . Bytes(), MCDataGetBytePtr(*t_compressed), t_length));
+}
+
+TEST(filters, decompress_members)
+{
+    MCAutoDataRef t_first, t_second;
+    ASSERT_TRUE(MCDataCreateWithBytes((const byte_t *)"hello, ", 7, &t_first));
+    ASSERT_TRUE(MCDataCreateWithBytes((const byte_t *)"world", 5, &t_second));
+
+    MCAutoDataRef t_first_compressed, t_second_compressed;
+    ASSERT_TRUE(MCFiltersCompress(*t_first, &t_first_compressed));
+    ASSERT_TRUE(MCFiltersCompress(*t_second, &t_second_compressed));
+
+    MCAutoDataRef t_concatenated;
+    ASSERT_TRUE(MCDataMutableCopy(*t_first_compressed, &t_concatenated));
+    ASSERT_TRUE(MCDataAppend(*t_concatenated, *t_second_compressed));
+
+    MCAutoDataRef t_decompressed;
+    ASSERT_TRUE(MCFiltersDecompress(*t_concatenated, &t_decompressed));
+    ASSERT_EQ(MCDataGetLength(*t_decompressed), 12U);
+    EXPECT_EQ(memcmp(MCDataGetBytePtr(*t_decompressed), "hello, world", 12), 0);
+}
+
+TEST(filters, compress_stream)
+{
+    MCAutoDataRef t_data;
+    ASSERT_TRUE(CreateSampleData(300000, &t_data));
+
+    MCAutoValueRefBase<MCStreamRef> t_output;
+    ASSERT_TRUE(MCMemoryOutputStreamCreate(&t_output));
+
+    MCAutoValueRefBase<MCStreamRef> t_compress;
+    ASSERT_TRUE(MCFiltersCompressStreamCreate(*t_output, 6, &t_compress));
+
+    // Write in uneven pieces.
+    uindex_t t_offset = 0;
+    while (t_offset < MCDataGetLength(*t_data))
+    {
+        uindex_t t_count = MCMin(MCDataGetLength(*t_data) - t_offset, 7001U);
+        ASSERT_TRUE(MCStreamWrite(*t_compress, MCDataGetBytePtr(*t_data) + t_offset, t_count));
+        t_offset += t_count;
+    }
+    ASSERT_TRUE(MCFiltersCompressStreamFinish(*t_compress));
+
+    void *t_buffer;
+    size_t t_size;
+    ASSERT_TRUE(MCMemoryOutputStreamFinish(*t_output, t_buffer, t_size));
+
+    MCAutoDataRef t_compressed;
+    ASSERT_TRUE(MCDataCreateWithBytesAndRelease((byte_t *)t_buffer, t_size, &t_compressed));
+
+    MCAutoDataRef t_decompressed;
+    ASSERT_TRUE(MCFiltersDecompress(*t_compressed, &t_decompressed));
+    EXPECT_TRUE(MCDataIsEqualTo(*t_data, *t_decompressed));
+}
+
+TEST(filters, decompress_stream)
+{
+    MCAutoDataRef t_data;
+    ASSERT_TRUE(CreateSampleData(300000, &t_data));
+
+    // Two members, to check they are read in sequence.
+    MCAutoDataRef t_member, t_compressed;
+    ASSERT_TRUE(MCFiltersCompress(*t_data, &t_member));
+    ASSERT_TRUE(MCDataMutableCopy(*t_member, &t_compressed));
+    ASSERT_TRUE(MCDataAppend(*t_compressed, *t_member));
+
+    MCAutoValueRefBase<MCStreamRef> t_input;
+    ASSERT_TRUE(MCMemoryInputStreamCreate(MCDataGetBytePtr(*t_compressed), MCDataGetLength(*t_compressed), &t_input));
+
+    MCAutoValueRefBase<MCStreamRef> t_decompress;
+    ASSERT_TRUE(MCFiltersDecompressStreamCreate(*t_input, &t_decompress));
+
+    MCAutoByteArray t_output;
+    ASSERT_TRUE(t_output . New(2 * MCDataGetLength(*t_data)));
+    ASSERT_TRUE(MCStreamRead(*t_decompress, t_output . Bytes(), t_output . ByteCount()));
+
+    bool t_finished;
+    ASSERT_TRUE(MCStreamIsFinished(*t_decompress, t_finished));
+    EXPECT_TRUE(t_finished);
+
+    EXPECT_EQ(memcmp(t_output . Bytes(), MCDataGetBytePtr(*t_data), MCDataGetLength(*t_data)), 0);
+    EXPECT_EQ(memcmp(t_output . Bytes() + MCDataGetLength(*t_data), MCDataGetBytePtr(*t_data), MCDataGetLength(*t_data)), 0);
+}
+
+TEST(filters, decompress_stream_corrupt)
+{
+    MCAutoDataRef t_data, t_compressed;
+    ASSERT_TRUE(CreateSampleData(1000, &t_data));
+    ASSERT_TRUE(MCFiltersCompress(*t_data, &t_compressed));
+
+    // Damage the crc in the trailer.
+    MCAutoByteArray t_bytes;
+    ASSERT_TRUE(t_bytes . New(MCDataGetLength(*t_compressed)));
+    memcpy(t_bytes . Bytes(), MCDataGetBytePtr(*t_compressed), t_bytes . ByteCount());
+    t_bytes . Bytes()[t_bytes . ByteCount() - 8] ^= 1;
+
+    MCAutoValueRefBase<MCStreamRef> t_input;
+    ASSERT_TRUE(MCMemoryInputStreamCreate(t_bytes . Bytes(), t_bytes . ByteCount(), &t_input));
+
+    MCAutoValueRefBase<MCStreamRef> t_decompress;
+    ASSERT_TRUE(MCFiltersDecompressStreamCreate(*t_input, &t_decompress));
+
+    byte_t t_output[1000];
+    EXPECT_FALSE(MCStreamRead(*t_decompress, t_output, sizeof(t_output)));
+
+    MCAutoErrorRef t_error;
+    EXPECT_TRUE(MCErrorCatch(&t_error));
+}
+
+static bool Base64Encode(const char *p_bytes, MCStringRef& r_result)
+{
+    MCAutoDataRef t_data;
+    return MCDataCreateWithBytes((const byte_t *)p_bytes, strlen(p_bytes), &t_data) &&
+            MCFiltersBase64Encode(*t_data, r_result);
+}
+
+static void ExpectBase64Decodes(const char *p_text, const char *p_expected)
+{
+    MCAutoStringRef t_text;
+    ASSERT_TRUE(MCStringCreateWithCString(p_text, &t_text));
+
+    MCAutoDataRef t_decoded;
+    ASSERT_TRUE(MCFiltersBase64Decode(*t_text, &t_decoded));
+    EXPECT_EQ(MCDataGetLength(*t_decoded), strlen(p_expected)) << p_text;
+    EXPECT_EQ(memcmp(MCDataGetBytePtr(*t_decoded), p_expected, MCDataGetLength(*t_decoded)), 0) << p_text;
+}
+
+TEST(filters, base64_encode)
+{
+    MCAutoStringRef t_one, t_two, t_three;
+    ASSERT_TRUE(Base64Encode("f", &t_one));
+    ASSERT_TRUE(Base64Encode("fo", &t_two));
+    ASSERT_TRUE(Base64Encode("foo", &t_three));
+    EXPECT_TRUE(MCStringIsEqualToCString(*t_one, "Zg==", kMCStringOptionCompareExact));
+    EXPECT_TRUE(MCStringIsEqualToCString(*t_two, "Zm8=", kMCStringOptionCompareExact));
+    EXPECT_TRUE(MCStringIsEqualToCString(*t_three, "Zm9v", kMCStringOptionCompareExact));
+
+    // Lines are broken after 72 chars, including after the last line.
+    char t_bytes[109];
+    memset(t_bytes, '~', 108);
+    t_bytes[108] = '\0';
+
+    MCAutoStringRef t_lines;
+    ASSERT_TRUE(Base64Encode(t_bytes, &t_lines));
+    ASSERT_EQ(MCStringGetLength(*t_lines), 146U);
+    EXPECT_EQ(MCStringGetCharAtIndex(*t_lines, 72), '\n');
+    EXPECT_EQ(MCStringGetCharAtIndex(*t_lines, 145), '\n');
+}
+
+TEST(filters, base64_decode)
+{
+    ExpectBase64Decodes("Zm9vYmFy", "foobar");
+    ExpectBase64Decodes("Zm9v\nYmFy\n", "foobar");
+    ExpectBase64Decodes("Zm 9v*Ym Fy", "foobar");
+    ExpectBase64Decodes("Zm8=", "fo");
+    ExpectBase64Decodes("Zg==Zm9v", "f");
+    ExpectBase64Decodes("Zm9vYmFyZm9vYmFyZm9vYmFyZm9vYmFy", "foobarfoobarfoobarfoobar");
+    ExpectBase64Decodes("Zm9vYmFyZm9vYm!FyZm9vYmFyZm9vYmFy", "foobarfoobarfoobarfoobar");
+}
+
+TEST(filters, url_encode)
+{
+    MCAutoStringRef t_source, t_encoded;
+    ASSERT_TRUE(MCStringCreateWithCString("a-Z_0.9* ~/\n", &t_source));
+    ASSERT_TRUE(MCFiltersUrlEncode(*t_source, &t_encoded));
+    EXPECT_TRUE(MCStringIsEqualToCString(*t_encoded, "a-Z_0.9*+%7E%2F%0D%0A", kMCStringOptionCompareExact));
+
+    // Non-ASCII chars are encoded as UTF-8.
+    const unichar_t t_chars[] = { 'x', 0xe9 };
+    MCAutoStringRef t_unicode, t_unicode_encoded;
+    ASSERT_TRUE(MCStringCreateWithChars(t_chars, 2, &t_unicode));
+    ASSERT_TRUE(MCFiltersUrlEncode(*t_unicode, &t_unicode_encoded));
+    EXPECT_TRUE(MCStringIsEqualToCString(*t_unicode_encoded, "x%C3%A9", kMCStringOptionCompareExact));
+}
+
+TEST(filters, url_decode)
+{
+    MCAutoStringRef t_source, t_decoded;
+    ASSERT_TRUE(MCStringCreateWithCString("abcdefghijklmnopqrstuvwxyz+%41%2f%0D%0A%c3%a9\r\nx%4", &t_source));
+    ASSERT_TRUE(MCFiltersUrlDecode(*t_source, &t_decoded));
+
+    const unichar_t t_expected_chars[] = { 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm',
+        'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z', ' ', 'A', '/', '\n', 0xe9, '\n', 'x', '@' };
+    MCAutoStringRef t_expected;
+    ASSERT_TRUE(MCStringCreateWithChars(t_expected_chars, sizeof(t_expected_chars) / sizeof(t_expected_chars[0]), &t_expected));
+    EXPECT_TRUE(MCStringIsEqualTo(*t_decoded, *t_expected, kMCStringOptionCompareExact));
+}
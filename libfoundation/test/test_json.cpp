@@ -0,0 +1,137 @@
+/* Copyright (C) 2003-2015 LiveCode Ltd.
+
+This file is part of LiveCode.
+
+LiveCode is free software; you can redistribute it and/or modify it under
+the terms of the GNU General Public License v3 as published by the Free
+Software Foundation.
+
+LiveCode is distributed in the hope that it will be useful, but WITHOUT ANY
+WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+for more details.
+
+You should have received a copy of the GNU General Public License
+along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
+
+#include "gtest/gtest.h"
+
+#include "foundation.h"
+#include "foundation-auto.h"
+#include "foundation-json.h"
+
+static bool JSONImport(const char *p_json, MCValueRef& r_value)
+{
+    MCAutoStringRef t_json;
+    if (!MCStringCreateWithCString(p_json, &t_json))
+        return false;
+    return MCJSONImport(*t_json, r_value);
+}
+
+static void ExpectImportFails(const char *p_json)
+{
+    MCAutoValueRef t_value;
+    EXPECT_FALSE(JSONImport(p_json, &t_value)) << p_json;
+
+    MCAutoErrorRef t_error;
+    EXPECT_TRUE(MCErrorCatch(&t_error)) << p_json;
+}
+
+TEST(json, import_scalars)
+{
+    MCAutoValueRef t_value;
+    ASSERT_TRUE(JSONImport(" 42 ", &t_value));
+    ASSERT_EQ(MCValueGetTypeCode(*t_value), kMCValueTypeCodeNumber);
+    EXPECT_EQ(MCNumberFetchAsReal((MCNumberRef)*t_value), 42.0);
+
+    MCAutoValueRef t_real;
+    ASSERT_TRUE(JSONImport("-1.5e3", &t_real));
+    EXPECT_EQ(MCNumberFetchAsReal((MCNumberRef)*t_real), -1500.0);
+
+    MCAutoValueRef t_true, t_null;
+    ASSERT_TRUE(JSONImport("true", &t_true));
+    EXPECT_EQ(*t_true, kMCTrue);
+    ASSERT_TRUE(JSONImport("null", &t_null));
+    EXPECT_EQ(*t_null, kMCNull);
+}
+
+TEST(json, import_string_escapes)
+{
+    MCAutoValueRef t_value;
+    ASSERT_TRUE(JSONImport("\"a\\tb\\u00e9\\ud83d\\ude00\\\"\"", &t_value));
+    ASSERT_EQ(MCValueGetTypeCode(*t_value), kMCValueTypeCodeString);
+
+    const unichar_t t_expected[] = { 'a', '\t', 'b', 0xe9, 0xd83d, 0xde00, '"' };
+    MCAutoStringRef t_expected_string;
+    ASSERT_TRUE(MCStringCreateWithChars(t_expected, sizeof(t_expected) / sizeof(t_expected[0]), &t_expected_string));
+    EXPECT_TRUE(MCStringIsEqualTo((MCStringRef)*t_value, *t_expected_string, kMCStringOptionCompareExact));
+}
+
+TEST(json, import_structures)
+{
+    MCAutoValueRef t_value;
+    ASSERT_TRUE(JSONImport("{\"list\": [1, [], {}, \"x\"], \"key\": null}", &t_value));
+    ASSERT_EQ(MCValueGetTypeCode(*t_value), kMCValueTypeCodeArray);
+
+    MCNewAutoNameRef t_list_name;
+    ASSERT_TRUE(MCNameCreateWithNativeChars((const char_t *)"list", 4, &t_list_name));
+
+    MCValueRef t_list;
+    ASSERT_TRUE(MCArrayFetchValue((MCArrayRef)*t_value, false, *t_list_name, t_list));
+    ASSERT_EQ(MCValueGetTypeCode(t_list), kMCValueTypeCodeProperList);
+    ASSERT_EQ(MCProperListGetLength((MCProperListRef)t_list), 4U);
+    EXPECT_EQ(MCValueGetTypeCode(MCProperListFetchElementAtIndex((MCProperListRef)t_list, 1)), kMCValueTypeCodeProperList);
+    EXPECT_EQ(MCValueGetTypeCode(MCProperListFetchElementAtIndex((MCProperListRef)t_list, 2)), kMCValueTypeCodeArray);
+}
+
+TEST(json, import_errors)
+{
+    ExpectImportFails("");
+    ExpectImportFails("-");
+    ExpectImportFails("[1,]");
+    ExpectImportFails("{1:2}");
+    ExpectImportFails("01");
+    ExpectImportFails("\"abc");
+    ExpectImportFails("\"a\tb\"");
+    ExpectImportFails("\"\\q\"");
+    ExpectImportFails("nul");
+    ExpectImportFails("[] x");
+}
+
+TEST(json, import_nesting_limit)
+{
+    char t_json[1024];
+
+    memset(t_json, '[', 500);
+    memset(t_json + 500, ']', 500);
+    t_json[1000] = '\0';
+
+    MCAutoValueRef t_value;
+    EXPECT_TRUE(JSONImport(t_json, &t_value));
+
+    memset(t_json, '[', 502);
+    memset(t_json + 502, ']', 502);
+    t_json[1004] = '\0';
+    ExpectImportFails(t_json);
+}
+
+TEST(json, export_roundtrip)
+{
+    const char *t_json = "[1,2.5,\"a\\\"b\\\\c\\n\",true,false,null,{\"k\": []}]";
+
+    MCAutoValueRef t_value;
+    ASSERT_TRUE(JSONImport(t_json, &t_value));
+
+    MCAutoStringRef t_exported;
+    ASSERT_TRUE(MCJSONExport(*t_value, &t_exported));
+    EXPECT_TRUE(MCStringIsEqualToCString(*t_exported, t_json, kMCStringOptionCompareExact));
+}
+
+TEST(json, export_unsupported)
+{
+    MCAutoStringRef t_exported;
+    EXPECT_FALSE(MCJSONExport(kMCEmptyData, &t_exported));
+
+    MCAutoErrorRef t_error;
+    EXPECT_TRUE(MCErrorCatch(&t_error));
+}
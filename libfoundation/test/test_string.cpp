@@ -20,6 +20,8 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #include "foundation-unicode.h"
 #include "foundation-auto.h"
 
+#include <string>
+
 
 TEST(string, creation)
 //
@@ -185,3 +187,283 @@ TEST(string, surrogate_unicode_props)
     const int kSPUA_B_Upper = 0x10FFFD + 1; // non-inclusive
     check_bidi_of_surrogate_range(kSPUA_B_Lower, kSPUA_B_Upper);
 }
+
+// Creates a string of the given length made from the chars of the alphabet.
+static void create_long_string(uindex_t p_length, bool p_unicode, MCStringRef& r_string)
+{
+	MCAutoStringRef t_string;
+	ASSERT_TRUE(MCStringCreateMutable(p_length, &t_string));
+	for (uindex_t i = 0; i < p_length; i++)
+		ASSERT_TRUE(MCStringAppendNativeChar(*t_string, 'a' + i % 26));
+	if (p_unicode)
+		ASSERT_TRUE(MCStringAppendChar(*t_string, 0x263A));
+	ASSERT_TRUE(MCStringCopy(*t_string, r_string));
+}
+
+TEST(string, substring_slices)
+//
+// Checks that long substrings (which share the chars of the original string)
+// behave in the same way as copies.
+//
+{
+	for (int t_unicode = 0; t_unicode < 2; t_unicode++)
+	{
+		MCAutoStringRef t_string;
+		create_long_string(1000, t_unicode != 0, &t_string);
+
+		MCAutoStringRef t_substring;
+		ASSERT_TRUE(MCStringCopySubstring(*t_string, MCRangeMake(100, 200), &t_substring));
+		ASSERT_EQ(200u, MCStringGetLength(*t_substring));
+		EXPECT_EQ('w', MCStringGetNativeCharAtIndex(*t_substring, 0));
+		EXPECT_EQ(0, MCStringGetNativeCharAtIndex(*t_substring, 200));
+
+		// The chars are terminated even though the original string continues.
+		EXPECT_EQ(200u, strlen(MCStringGetCString(*t_substring)));
+		EXPECT_EQ(0, MCStringGetCharPtr(*t_substring)[200]);
+
+		// Substrings of substrings.
+		MCAutoStringRef t_nested, t_expected;
+		ASSERT_TRUE(MCStringCopySubstring(*t_substring, MCRangeMake(50, 100), &t_nested));
+		ASSERT_TRUE(MCStringCopySubstring(*t_string, MCRangeMake(150, 100), &t_expected));
+		EXPECT_TRUE(MCStringIsEqualTo(*t_nested, *t_expected, kMCStringOptionCompareExact));
+		EXPECT_EQ(MCStringHash(*t_nested, kMCStringOptionCompareExact), MCStringHash(*t_expected, kMCStringOptionCompareExact));
+
+		// A substring which runs to the end of the original.
+		MCAutoStringRef t_tail;
+		ASSERT_TRUE(MCStringCopySubstring(*t_string, MCRangeMake(900, 1000), &t_tail));
+		ASSERT_EQ(MCStringGetLength(*t_string) - 900, MCStringGetLength(*t_tail));
+		EXPECT_EQ(MCStringGetCharAtIndex(*t_string, 900), MCStringGetCharAtIndex(*t_tail, 0));
+
+		// Changing a mutable copy of a substring changes nothing else.
+		MCAutoStringRef t_mutable;
+		ASSERT_TRUE(MCStringMutableCopy(*t_substring, &t_mutable));
+		ASSERT_TRUE(MCStringReplace(*t_mutable, MCRangeMake(0, 10), MCSTR("!")));
+		EXPECT_EQ('!', MCStringGetNativeCharAtIndex(*t_mutable, 0));
+		EXPECT_EQ('w', MCStringGetNativeCharAtIndex(*t_substring, 0));
+		EXPECT_EQ('w', MCStringGetNativeCharAtIndex(*t_string, 100));
+
+		// Names made from substrings are the same as those made from copies.
+		MCNewAutoNameRef t_name, t_expected_name;
+		ASSERT_TRUE(MCNameCreate(*t_nested, &t_name));
+		ASSERT_TRUE(MCNameCreate(*t_expected, &t_expected_name));
+		EXPECT_EQ(*t_name, *t_expected_name);
+	}
+}
+
+TEST(string, substring_slice_outlives_original)
+//
+// Checks that a substring remains valid once the original string has gone.
+//
+{
+	MCStringRef t_string;
+	create_long_string(1000, false, t_string);
+
+	MCAutoStringRef t_substring, t_copy;
+	ASSERT_TRUE(MCStringCopySubstring(t_string, MCRangeMake(26, 400), &t_substring));
+	MCValueRelease(t_string);
+
+	// Copying compacts the substring now that nothing else uses the chars,
+	// leaving the substring itself unchanged.
+	ASSERT_TRUE(MCStringCopy(*t_substring, &t_copy));
+	EXPECT_NE(*t_substring, *t_copy);
+	ASSERT_EQ(400u, MCStringGetLength(*t_copy));
+	EXPECT_EQ('a', MCStringGetNativeCharAtIndex(*t_copy, 0));
+	EXPECT_EQ('j', MCStringGetNativeCharAtIndex(*t_copy, 399));
+	EXPECT_EQ(400u, strlen(MCStringGetCString(*t_copy)));
+	EXPECT_TRUE(MCStringIsEqualTo(*t_substring, *t_copy, kMCStringOptionCompareExact));
+}
+
+TEST(string, split_slices)
+//
+// Checks that splitting a string gives the right elements when they share the
+// chars of the string.
+//
+{
+	for (int t_unicode = 0; t_unicode < 2; t_unicode++)
+	{
+		MCAutoStringRef t_line, t_text;
+		create_long_string(100, t_unicode != 0, &t_line);
+		ASSERT_TRUE(MCStringFormat(&t_text, "%@\n%@\nshort\n%@", *t_line, *t_line, *t_line));
+
+		MCAutoProperListRef t_list;
+		ASSERT_TRUE(MCStringSplitByDelimiter(*t_text, MCSTR("\n"), kMCStringOptionCompareExact, &t_list));
+		ASSERT_EQ(4u, MCProperListGetLength(*t_list));
+		for (uindex_t i = 0; i < 4; i++)
+		{
+			MCStringRef t_element = (MCStringRef)MCProperListFetchElementAtIndex(*t_list, i);
+			EXPECT_TRUE(MCStringIsEqualTo(t_element, i == 2 ? MCSTR("short") : *t_line, kMCStringOptionCompareExact));
+		}
+
+		MCAutoArrayRef t_array;
+		ASSERT_TRUE(MCStringSplit(*t_text, MCSTR("\n"), nil, kMCStringOptionCompareExact, &t_array));
+		ASSERT_EQ(4u, MCArrayGetCount(*t_array));
+		MCValueRef t_element;
+		ASSERT_TRUE(MCArrayFetchValueAtIndex(*t_array, 4, t_element));
+		EXPECT_TRUE(MCStringIsEqualTo((MCStringRef)t_element, *t_line, kMCStringOptionCompareExact));
+		EXPECT_EQ(MCStringGetLength(*t_line), strlen(MCStringGetCString((MCStringRef)t_element)));
+	}
+}
+
+// Create a string from UTF-8 text made of the given piece repeated, along with
+// the same string created from UTF-16 chars.
+static void create_utf8_string(const char *p_piece, const unichar_t *p_piece_chars, uindex_t p_piece_length, uindex_t p_repeat, MCStringRef& r_string, MCStringRef& r_expected)
+{
+	std::string t_bytes;
+	MCAutoStringRef t_expected;
+	ASSERT_TRUE(MCStringCreateMutable(0, &t_expected));
+	for (uindex_t i = 0; i < p_repeat; i++)
+	{
+		t_bytes += p_piece;
+		ASSERT_TRUE(MCStringAppendChars(*t_expected, p_piece_chars, p_piece_length));
+	}
+
+	ASSERT_TRUE(MCStringCreateWithBytes((const byte_t *)t_bytes.data(), t_bytes.size(), kMCStringEncodingUTF8, false, r_string));
+	ASSERT_TRUE(MCStringCopy(*t_expected, r_expected));
+}
+
+TEST(string, utf8_strings)
+//
+// Checks that strings created from long UTF-8 text, which keep the UTF-8 until
+// the chars are needed, behave in the same way as those created from UTF-16.
+//
+{
+	// Latin, cyrillic and a char outside the BMP.
+	const char *t_piece = "abc \xD0\x96 \xF0\x9F\x98\x80 ";
+	const unichar_t t_piece_chars[] = { 'a', 'b', 'c', ' ', 0x0416, ' ', 0xD83D, 0xDE00, ' ' };
+
+	MCAutoStringRef t_string, t_expected;
+	create_utf8_string(t_piece, t_piece_chars, 9, 20, &t_string, &t_expected);
+
+	// Strings for each of the checks below, so each starts out as UTF-8.
+	MCAutoStringRef t_other, t_prefixed, t_sliced, t_appended, t_split, t_unused[5];
+	create_utf8_string(t_piece, t_piece_chars, 9, 20, &t_other, &t_unused[0]);
+	create_utf8_string(t_piece, t_piece_chars, 9, 20, &t_prefixed, &t_unused[1]);
+	create_utf8_string(t_piece, t_piece_chars, 9, 20, &t_sliced, &t_unused[2]);
+	create_utf8_string(t_piece, t_piece_chars, 9, 20, &t_appended, &t_unused[3]);
+	create_utf8_string(t_piece, t_piece_chars, 9, 20, &t_split, &t_unused[4]);
+
+	uindex_t t_byte_count;
+	ASSERT_NE(nullptr, MCStringGetUTF8BytePtrAndLength(*t_string, t_byte_count));
+	EXPECT_EQ(20 * strlen(t_piece), t_byte_count);
+
+	// None of these need the chars.
+	EXPECT_EQ(MCStringGetLength(*t_expected), MCStringGetLength(*t_string));
+	EXPECT_FALSE(MCStringIsNative(*t_string));
+	EXPECT_FALSE(MCStringIsEmpty(*t_string));
+	EXPECT_TRUE(MCStringIsEqualTo(*t_string, *t_other, kMCStringOptionCompareExact));
+
+	MCAutoDataRef t_data;
+	ASSERT_TRUE(MCStringEncode(*t_string, kMCStringEncodingUTF8, false, &t_data));
+	ASSERT_EQ(t_byte_count, MCDataGetLength(*t_data));
+	EXPECT_EQ(0, memcmp(MCStringGetUTF8BytePtrAndLength(*t_string, t_byte_count), MCDataGetBytePtr(*t_data), t_byte_count));
+	ASSERT_NE(nullptr, MCStringGetUTF8BytePtrAndLength(*t_string, t_byte_count));
+
+	// These do, and give the same results as for the UTF-16 string. The bytes
+	// are kept once the chars have been decoded.
+	EXPECT_EQ(0x0416, MCStringGetCharAtIndex(*t_string, 4));
+	EXPECT_EQ(0x1F600u, MCStringGetCodepointAtIndex(*t_string, 6));
+	EXPECT_EQ(0x1F600u, MCStringGetCodepointAtIndex(*t_other, 6));
+	ASSERT_NE(nullptr, MCStringGetUTF8BytePtrAndLength(*t_other, t_byte_count));
+
+	EXPECT_TRUE(MCStringIsEqualTo(*t_string, *t_expected, kMCStringOptionCompareExact));
+	EXPECT_TRUE(MCStringIsEqualTo(*t_other, *t_expected, kMCStringOptionCompareCaseless));
+	EXPECT_EQ(MCStringHash(*t_expected, kMCStringOptionCompareExact), MCStringHash(*t_other, kMCStringOptionCompareExact));
+	EXPECT_EQ(0, memcmp(MCStringGetCharPtr(*t_string), MCStringGetCharPtr(*t_expected), MCStringGetLength(*t_expected) * sizeof(unichar_t)));
+
+	EXPECT_TRUE(MCStringBeginsWith(*t_prefixed, MCSTR("abc"), kMCStringOptionCompareExact));
+	MCAutoStringRef t_substring, t_expected_substring;
+	ASSERT_TRUE(MCStringCopySubstring(*t_sliced, MCRangeMake(9, 18), &t_substring));
+	ASSERT_TRUE(MCStringCopySubstring(*t_expected, MCRangeMake(9, 18), &t_expected_substring));
+	EXPECT_TRUE(MCStringIsEqualTo(*t_substring, *t_expected_substring, kMCStringOptionCompareExact));
+
+	MCAutoStringRef t_mutable;
+	ASSERT_TRUE(MCStringMutableCopy(*t_appended, &t_mutable));
+	ASSERT_TRUE(MCStringAppend(*t_mutable, *t_other));
+	ASSERT_EQ(2 * MCStringGetLength(*t_expected), MCStringGetLength(*t_mutable));
+	EXPECT_EQ(0x0416, MCStringGetCharAtIndex(*t_mutable, MCStringGetLength(*t_expected) + 4));
+
+	MCAutoProperListRef t_list, t_expected_list;
+	ASSERT_TRUE(MCStringSplitByDelimiter(*t_split, MCSTR(" "), kMCStringOptionCompareExact, &t_list));
+	ASSERT_TRUE(MCStringSplitByDelimiter(*t_expected, MCSTR(" "), kMCStringOptionCompareExact, &t_expected_list));
+	EXPECT_TRUE(MCProperListIsEqualTo(*t_list, *t_expected_list));
+}
+
+TEST(string, utf8_string_index)
+//
+// Checks that chars and ranges of chars of a string held as UTF-8, which are
+// found using its index rather than by decoding the whole string, are the same
+// as those of the string created from UTF-16.
+//
+{
+	// A piece whose length in chars isn't a factor of the index stride, so
+	// that indexed chars fall on either half of surrogate pairs.
+	const char *t_piece = "abc \xD0\x96\xF0\x9F\x98\x80";
+	const unichar_t t_piece_chars[] = { 'a', 'b', 'c', ' ', 0x0416, 0xD83D, 0xDE00 };
+
+	MCAutoStringRef t_string, t_expected;
+	create_utf8_string(t_piece, t_piece_chars, 7, 100, &t_string, &t_expected);
+
+	uindex_t t_length;
+	t_length = MCStringGetLength(*t_expected);
+	ASSERT_EQ(t_length, MCStringGetLength(*t_string));
+
+	for (uindex_t i = 0; i < t_length; i++)
+	{
+		EXPECT_EQ(MCStringGetCharAtIndex(*t_expected, i), MCStringGetCharAtIndex(*t_string, i)) << i;
+		EXPECT_EQ(MCStringGetCodepointAtIndex(*t_expected, i), MCStringGetCodepointAtIndex(*t_string, i)) << i;
+	}
+
+	for (uindex_t t_offset = 0; t_offset < t_length; t_offset += 29)
+	{
+		MCRange t_range;
+		t_range = MCRangeMake(t_offset, 150);
+
+		MCAutoStringRef t_substring, t_expected_substring;
+		ASSERT_TRUE(MCStringCopySubstring(*t_string, t_range, &t_substring));
+		ASSERT_TRUE(MCStringCopySubstring(*t_expected, t_range, &t_expected_substring));
+		EXPECT_TRUE(MCStringIsEqualTo(*t_substring, *t_expected_substring, kMCStringOptionCompareExact)) << t_offset;
+
+		unichar_t t_chars[150], t_expected_chars[150];
+		uindex_t t_count;
+		t_count = MCStringGetChars(*t_string, t_range, t_chars);
+		ASSERT_EQ(MCStringGetChars(*t_expected, t_range, t_expected_chars), t_count);
+		EXPECT_EQ(0, memcmp(t_chars, t_expected_chars, t_count * sizeof(unichar_t))) << t_offset;
+	}
+
+	// None of those needed the whole string to be decoded, but it is the same
+	// when it is.
+	EXPECT_EQ(0, memcmp(MCStringGetCharPtr(*t_string), MCStringGetCharPtr(*t_expected), t_length * sizeof(unichar_t)));
+}
+
+TEST(string, utf8_string_fallbacks)
+//
+// Checks that UTF-8 text is decoded straight away when it is short, invalid, or
+// takes less space in another form.
+//
+{
+	struct { const char *piece; uindex_t repeat; } t_cases[] =
+	{
+		// Short
+		{ "abc \xD0\x96 ", 2 },
+		// Can be native
+		{ "caf\xC3\xA9 ", 20 },
+		// Mostly three byte chars
+		{ "\xE4\xB8\xAD\xE6\x96\x87", 20 },
+		// Overlong encoding and an encoded surrogate
+		{ "abc \xD0\x96 \xC0\xAF", 20 },
+		{ "abc \xD0\x96 \xED\xA0\x80", 20 },
+	};
+
+	for (auto& t_case : t_cases)
+	{
+		std::string t_bytes;
+		for (uindex_t i = 0; i < t_case . repeat; i++)
+			t_bytes += t_case . piece;
+
+		MCAutoStringRef t_string;
+		ASSERT_TRUE(MCStringCreateWithBytes((const byte_t *)t_bytes.data(), t_bytes.size(), kMCStringEncodingUTF8, false, &t_string));
+
+		uindex_t t_byte_count;
+		EXPECT_EQ(nullptr, MCStringGetUTF8BytePtrAndLength(*t_string, t_byte_count)) << t_case . piece;
+	}
+}
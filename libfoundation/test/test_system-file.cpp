@@ -0,0 +1,163 @@
+/* Copyright (C) 2017 LiveCode Ltd.
+
+ This file is part of LiveCode.
+
+ LiveCode is free software; you can redistribute it and/or modify it under
+ the terms of the GNU General Public License v3 as published by the Free
+ Software Foundation.
+
+ LiveCode is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
+
+#include "gtest/gtest.h"
+
+#include "foundation.h"
+#include "foundation-auto.h"
+#include "foundation-system.h"
+
+static const char *kTestFile = "test_system-file.tmp";
+
+// Write a file containing the bytes 0, 1, 2, ... (modulo 256).
+static void CreateTestFile(uindex_t p_length)
+{
+    MCAutoByteArray t_bytes;
+    ASSERT_TRUE(t_bytes.New(p_length));
+    for (uindex_t i = 0; i < p_length; i++)
+        t_bytes.Bytes()[i] = byte_t(i);
+
+    MCAutoDataRef t_data;
+    ASSERT_TRUE(t_bytes.CreateData(&t_data));
+    ASSERT_TRUE(MCSFileSetContents(MCSTR(kTestFile), *t_data));
+}
+
+// Check that a readable, seekable and markable stream over the test file
+// behaves in the same way whichever kind of stream it is.
+static void CheckInputStream(MCStreamRef p_stream, uindex_t p_length)
+{
+    ASSERT_TRUE(MCStreamIsReadable(p_stream));
+    ASSERT_TRUE(MCStreamIsSeekable(p_stream));
+    ASSERT_TRUE(MCStreamIsMarkable(p_stream));
+
+    byte_t t_buffer[4];
+    ASSERT_TRUE(MCStreamRead(p_stream, t_buffer, 4));
+    EXPECT_EQ(0, t_buffer[0]);
+    EXPECT_EQ(3, t_buffer[3]);
+
+    size_t t_available;
+    ASSERT_TRUE(MCStreamGetAvailableForRead(p_stream, t_available));
+    EXPECT_EQ(p_length - 4, t_available);
+
+    // Mark, read ahead and then come back
+    ASSERT_TRUE(MCStreamMark(p_stream, 0));
+    ASSERT_TRUE(MCStreamSkip(p_stream, 1000));
+    ASSERT_TRUE(MCStreamRead(p_stream, t_buffer, 1));
+    EXPECT_EQ(byte_t(1004), t_buffer[0]);
+    ASSERT_TRUE(MCStreamReset(p_stream));
+
+    filepos_t t_position;
+    ASSERT_TRUE(MCStreamTell(p_stream, t_position));
+    EXPECT_EQ(4, t_position);
+
+    // Seek to the last byte
+    ASSERT_TRUE(MCStreamSeek(p_stream, p_length - 1));
+    bool t_finished;
+    ASSERT_TRUE(MCStreamIsFinished(p_stream, t_finished));
+    EXPECT_FALSE(t_finished);
+    ASSERT_TRUE(MCStreamRead(p_stream, t_buffer, 1));
+    EXPECT_EQ(byte_t(p_length - 1), t_buffer[0]);
+    ASSERT_TRUE(MCStreamIsFinished(p_stream, t_finished));
+    EXPECT_TRUE(t_finished);
+
+    // Reading or skipping past the end is an error
+    EXPECT_FALSE(MCStreamRead(p_stream, t_buffer, 1));
+    MCAutoErrorRef t_read_error;
+    EXPECT_TRUE(MCErrorCatch(&t_read_error));
+
+    ASSERT_TRUE(MCStreamSeek(p_stream, p_length - 2));
+    EXPECT_FALSE(MCStreamSkip(p_stream, 3));
+    MCAutoErrorRef t_skip_error;
+    EXPECT_TRUE(MCErrorCatch(&t_skip_error));
+}
+
+TEST(system_file, input_stream)
+{
+    const uindex_t kLength = 200000;
+    CreateTestFile(kLength);
+
+    MCAutoValueRefBase<MCStreamRef> t_stream;
+    ASSERT_TRUE(MCSFileCreateStream(MCSTR(kTestFile), kMCSFileOpenModeRead, &t_stream));
+    CheckInputStream(*t_stream, kLength);
+}
+
+TEST(system_file, mapped_stream)
+{
+    const uindex_t kLength = 200000;
+    CreateTestFile(kLength);
+
+    MCAutoValueRefBase<MCStreamRef> t_stream;
+    ASSERT_TRUE(MCSFileCreateMappedStream(MCSTR(kTestFile), &t_stream));
+    EXPECT_FALSE(MCStreamIsWritable(*t_stream));
+    CheckInputStream(*t_stream, kLength);
+
+    // Seeking past the end is an error
+    EXPECT_FALSE(MCStreamSeek(*t_stream, kLength + 1));
+    MCAutoErrorRef t_error;
+    EXPECT_TRUE(MCErrorCatch(&t_error));
+}
+
+TEST(system_file, mapped_stream_empty)
+{
+    CreateTestFile(0);
+
+    MCAutoValueRefBase<MCStreamRef> t_stream;
+    ASSERT_TRUE(MCSFileCreateMappedStream(MCSTR(kTestFile), &t_stream));
+
+    bool t_finished;
+    ASSERT_TRUE(MCStreamIsFinished(*t_stream, t_finished));
+    EXPECT_TRUE(t_finished);
+}
+
+TEST(system_file, output_stream)
+{
+    {
+        MCAutoValueRefBase<MCStreamRef> t_stream;
+        ASSERT_TRUE(MCSFileCreateStream(MCSTR(kTestFile), kMCSFileOpenModeWrite, &t_stream));
+        for (uindex_t i = 0; i < 100000; i++)
+            ASSERT_TRUE(MCStreamWriteUInt16(*t_stream, uint16_t(i)));
+    }
+
+    MCAutoValueRefBase<MCStreamRef> t_stream;
+    ASSERT_TRUE(MCSFileCreateStream(MCSTR(kTestFile), kMCSFileOpenModeRead, &t_stream));
+    for (uindex_t i = 0; i < 100000; i++)
+    {
+        uint16_t t_value;
+        ASSERT_TRUE(MCStreamReadUInt16(*t_stream, t_value));
+        ASSERT_EQ(uint16_t(i), t_value);
+    }
+
+    bool t_finished;
+    ASSERT_TRUE(MCStreamIsFinished(*t_stream, t_finished));
+    EXPECT_TRUE(t_finished);
+}
+
+TEST(system_file, missing_file)
+{
+    MCSFileDelete(MCSTR(kTestFile));
+    MCAutoErrorRef t_delete_error;
+    MCErrorCatch(&t_delete_error);
+
+    MCAutoValueRefBase<MCStreamRef> t_stream;
+    EXPECT_FALSE(MCSFileCreateStream(MCSTR(kTestFile), kMCSFileOpenModeRead, &t_stream));
+    MCAutoErrorRef t_stream_error;
+    EXPECT_TRUE(MCErrorCatch(&t_stream_error));
+
+    MCAutoValueRefBase<MCStreamRef> t_mapped_stream;
+    EXPECT_FALSE(MCSFileCreateMappedStream(MCSTR(kTestFile), &t_mapped_stream));
+    MCAutoErrorRef t_mapped_error;
+    EXPECT_TRUE(MCErrorCatch(&t_mapped_error));
+}
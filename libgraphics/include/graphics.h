@@ -596,6 +596,18 @@ typedef bool (*MCGFontLayoutTextCallback)(void *context, const MCGFont &p_font,
 
 bool MCGFontLayoutText(const MCGFont &p_font, const unichar_t *p_text, uindex_t p_char_count, bool p_rtl, MCGFontLayoutTextCallback p_callback, void *p_context);
 
+// The usage of the cache of shaped glyph runs shared by text layout, measuring
+// and drawing. Returns false on platforms where the system shapes text itself.
+struct MCGTextShapeCacheStatistics
+{
+	uint32_t hits;
+	uint32_t misses;
+	size_t bytes_used;
+	size_t max_bytes;
+};
+
+bool MCGTextShapeCacheGetStatistics(MCGTextShapeCacheStatistics &r_statistics);
+
 ////////////////////////////////////////////////////////////////////////////////
 
 inline bool MCGPointIsEqual(const MCGPoint &p_a, const MCGPoint &p_b)
@@ -802,6 +814,10 @@ void MCGraphicsInitialize(void);
 void MCGraphicsFinalize(void);
 void MCGraphicsCompact(void);
 
+// Sets the maximum number of threads a blur pass is split across. A count of
+// 1 blurs on the calling thread only, and 0 restores the default.
+void MCGBlurSetMaxThreadCount(uint32_t p_count);
+
 ////////////////////////////////////////////////////////////////////////////////
 
 bool MCGPaintCreateWithNone(MCGPaintRef& r_paint);
@@ -14,6 +14,21 @@
 #include <SkMask.h>
 #include <SkColorPriv.h>
 
+#include <mutex>
+
+#if !defined(__EMSCRIPTEN__)
+#include <algorithm>
+#include <condition_variable>
+#if defined(_WIN32)
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+#define MCGBLUR_PARALLEL_BANDS
+#endif
+
 #   define SkScalarFloor(x)    SkScalarFloorToInt(x)
 #   define SkScalarCeil(x)     SkScalarCeilToInt(x)
 #   define SkScalarRound(x)    SkScalarRoundToInt(x)
@@ -320,6 +335,500 @@ static int boxBlurInterp(const uint8_t* src, int src_y_stride, uint8_t* dst,
     return new_width;
 }
 
+/**
+ * This function performs a box blur in Y, of the given radius, producing
+ * exactly the same values as a transposed pass of boxBlur would. Rather than
+ * keeping one running sum and walking down a column at a time, it keeps a
+ * running sum for every column and walks down the rows, so that each step is
+ * a simple loop over contiguous memory which the compiler can vectorize.
+ * Only columns [x_start, x_end) are processed, using the same range of the
+ * sums buffer; src is width * height bytes and dst must be at least
+ * width * (height + 2 * radius) bytes.
+ */
+static int boxBlurVertical(const uint8_t* src, uint8_t* dst, uint32_t* sums,
+                           int radius, int width, int height,
+                           int x_start, int x_end)
+{
+    int diameter = radius * 2;
+    int kernelSize = diameter + 1;
+    uint32_t scale = (1 << 24) / kernelSize;
+    int new_height = height + diameter;
+    int count = x_end - x_start;
+    uint32_t* sum = sums + x_start;
+    for (int x = 0; x < count; ++x)
+        sum[x] = 0;
+    for (int y = 0; y < new_height; ++y) {
+        uint8_t* dptr = dst + y * width + x_start;
+        const uint8_t* right = y < height ? src + y * width + x_start : NULL;
+        const uint8_t* left = y >= diameter ? src + (y - diameter) * width + x_start : NULL;
+        if (right != NULL && left != NULL) {
+            for (int x = 0; x < count; ++x) {
+                uint32_t t_sum = sum[x] + right[x];
+                dptr[x] = (t_sum * scale) >> 24;
+                sum[x] = t_sum - left[x];
+            }
+            continue;
+        }
+        if (right != NULL) {
+            for (int x = 0; x < count; ++x)
+                sum[x] += right[x];
+        }
+        for (int x = 0; x < count; ++x)
+            dptr[x] = (sum[x] * scale) >> 24;
+        if (left != NULL) {
+            for (int x = 0; x < count; ++x)
+                sum[x] -= left[x];
+        }
+    }
+    return new_height;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Masks with fewer pixels than this are blurred on the calling thread.
+#define kMCGBlurParallelMinPixels (256 * 256)
+
+// The maximum number of threads a single pass is split across.
+#define kMCGBlurParallelMaxThreads 8
+
+// Bands of columns are a multiple of this many bytes wide, so that the
+// threads don't share cache lines when writing.
+#define kMCGBlurParallelColumnAlign 64
+
+#if defined(MCGBLUR_PARALLEL_BANDS)
+
+// The bands of large passes are processed by a pool of worker threads, which
+// is started the first time it is needed and kept for all later passes. Only
+// one pass at a time uses the pool; any others (and all passes, if no worker
+// could be started) run on the calling thread.
+
+typedef void (*MCGBlurBandCallback)(const void *p_context, int p_start, int p_end);
+
+struct MCGBlurWorker
+{
+#if defined(_WIN32)
+	HANDLE thread;
+#else
+	pthread_t thread;
+#endif
+};
+
+static std::mutex s_blur_pool_lock;
+static std::condition_variable s_blur_pool_wake;
+static std::condition_variable s_blur_pool_done;
+static std::mutex s_blur_pool_busy;
+
+static MCGBlurWorker s_blur_workers[kMCGBlurParallelMaxThreads - 1];
+static int s_blur_worker_count = 0;
+static bool s_blur_pool_started = false;
+static bool s_blur_pool_quit = false;
+static uint32_t s_blur_max_threads = 0;
+
+// The pass the pool is running: the bands still to be claimed, and the number
+// which have not yet finished.
+static MCGBlurBandCallback s_blur_job_callback = NULL;
+static const void *s_blur_job_context = NULL;
+static int s_blur_job_length = 0;
+static int s_blur_job_band_length = 0;
+static int s_blur_job_next = 0;
+static int s_blur_job_unfinished = 0;
+static uint32_t s_blur_job_generation = 0;
+
+static int MCGBlurProcessorCount(void)
+{
+#if defined(_WIN32)
+	SYSTEM_INFO t_info;
+	GetSystemInfo(&t_info);
+	return int(t_info . dwNumberOfProcessors);
+#else
+	long t_count;
+	t_count = sysconf(_SC_NPROCESSORS_ONLN);
+	return t_count > 0 ? int(t_count) : 1;
+#endif
+}
+
+// Processes the unclaimed bands of the current pass. Called, and returns,
+// with the pool locked.
+static void MCGBlurPoolRunBands(std::unique_lock<std::mutex>& x_lock)
+{
+	while (s_blur_job_next < s_blur_job_length)
+	{
+		int t_start, t_end;
+		t_start = s_blur_job_next;
+		t_end = std::min(t_start + s_blur_job_band_length, s_blur_job_length);
+		s_blur_job_next = t_end;
+
+		MCGBlurBandCallback t_callback;
+		const void *t_context;
+		t_callback = s_blur_job_callback;
+		t_context = s_blur_job_context;
+
+		x_lock . unlock();
+		t_callback(t_context, t_start, t_end);
+		x_lock . lock();
+
+		if (--s_blur_job_unfinished == 0)
+			s_blur_pool_done . notify_all();
+	}
+}
+
+static void MCGBlurWorkerRun(void)
+{
+	std::unique_lock<std::mutex> t_lock(s_blur_pool_lock);
+
+	uint32_t t_generation;
+	t_generation = s_blur_job_generation;
+	for(;;)
+	{
+		s_blur_pool_wake . wait(t_lock, [&] { return s_blur_pool_quit || s_blur_job_generation != t_generation; });
+		if (s_blur_pool_quit)
+			return;
+
+		t_generation = s_blur_job_generation;
+		MCGBlurPoolRunBands(t_lock);
+	}
+}
+
+#if defined(_WIN32)
+static unsigned int __stdcall MCGBlurWorkerThread(void *p_context)
+{
+	MCGBlurWorkerRun();
+	return 0;
+}
+#else
+static void *MCGBlurWorkerThread(void *p_context)
+{
+	MCGBlurWorkerRun();
+	return NULL;
+}
+#endif
+
+// Starts the workers, if they have not been started before, and returns the
+// number of threads (including the calling one) a pass may be split across.
+// Called with the pool locked.
+static int MCGBlurPoolGetThreadCount(void)
+{
+	if (!s_blur_pool_started)
+	{
+		s_blur_pool_started = true;
+
+		int t_wanted;
+		t_wanted = std::min(MCGBlurProcessorCount(), kMCGBlurParallelMaxThreads) - 1;
+		while (s_blur_worker_count < t_wanted)
+		{
+			MCGBlurWorker& t_worker = s_blur_workers[s_blur_worker_count];
+#if defined(_WIN32)
+			t_worker . thread = (HANDLE)_beginthreadex(NULL, 0, MCGBlurWorkerThread, NULL, 0, NULL);
+			if (t_worker . thread == NULL)
+				break;
+#else
+			if (pthread_create(&t_worker . thread, NULL, MCGBlurWorkerThread, NULL) != 0)
+				break;
+#endif
+			s_blur_worker_count++;
+		}
+	}
+
+	int t_thread_count;
+	t_thread_count = s_blur_worker_count + 1;
+	if (s_blur_max_threads != 0)
+		t_thread_count = std::min(t_thread_count, int(s_blur_max_threads));
+	return t_thread_count;
+}
+
+// Runs the bands of a pass on the pool and the calling thread, returning once
+// they have all finished. Called with the pool locked.
+static void MCGBlurPoolRun(std::unique_lock<std::mutex>& x_lock, MCGBlurBandCallback p_callback, const void *p_context, int p_length, int p_band_length)
+{
+	s_blur_job_callback = p_callback;
+	s_blur_job_context = p_context;
+	s_blur_job_length = p_length;
+	s_blur_job_band_length = p_band_length;
+	s_blur_job_next = 0;
+	s_blur_job_unfinished = (p_length + p_band_length - 1) / p_band_length;
+	s_blur_job_generation++;
+	s_blur_pool_wake . notify_all();
+
+	MCGBlurPoolRunBands(x_lock);
+	s_blur_pool_done . wait(x_lock, [] { return s_blur_job_unfinished == 0; });
+
+	s_blur_job_callback = NULL;
+	s_blur_job_context = NULL;
+}
+
+template<typename T>
+static void MCGBlurInvokeBand(const void *p_context, int p_start, int p_end)
+{
+	(*static_cast<const T *>(p_context))(p_start, p_end);
+}
+
+#endif
+
+void MCGBlurSetMaxThreadCount(uint32_t p_count)
+{
+#if defined(MCGBLUR_PARALLEL_BANDS)
+	std::lock_guard<std::mutex> t_lock(s_blur_pool_lock);
+	s_blur_max_threads = p_count;
+#endif
+}
+
+void MCGBlurPoolFinalize(void)
+{
+#if defined(MCGBLUR_PARALLEL_BANDS)
+	{
+		std::lock_guard<std::mutex> t_lock(s_blur_pool_lock);
+		s_blur_pool_quit = true;
+		s_blur_pool_wake . notify_all();
+	}
+
+	for (int i = 0; i < s_blur_worker_count; i++)
+	{
+#if defined(_WIN32)
+		WaitForSingleObject(s_blur_workers[i] . thread, INFINITE);
+		CloseHandle(s_blur_workers[i] . thread);
+#else
+		pthread_join(s_blur_workers[i] . thread, NULL);
+#endif
+	}
+
+	std::lock_guard<std::mutex> t_lock(s_blur_pool_lock);
+	s_blur_worker_count = 0;
+	s_blur_pool_started = false;
+	s_blur_pool_quit = false;
+#endif
+}
+
+// Splits [0, p_length) into bands and calls p_callback(start, end) for each,
+// spreading them across the pool when the mask is large enough to make it
+// worthwhile. The result is the same however the bands are processed.
+template<typename T>
+static void MCGBlurForEachBand(int p_length, int p_pixels, int p_alignment, const T& p_callback)
+{
+#if defined(MCGBLUR_PARALLEL_BANDS)
+	if (p_pixels >= kMCGBlurParallelMinPixels && s_blur_pool_busy . try_lock())
+	{
+		bool t_done;
+		t_done = false;
+
+		{
+			std::unique_lock<std::mutex> t_lock(s_blur_pool_lock);
+
+			int t_thread_count;
+			t_thread_count = MCGBlurPoolGetThreadCount();
+
+			int t_band_length;
+			t_band_length = 0;
+			if (t_thread_count > 1)
+			{
+				t_band_length = (p_length + t_thread_count - 1) / t_thread_count;
+				t_band_length = (t_band_length + p_alignment - 1) / p_alignment * p_alignment;
+			}
+
+			if (t_band_length > 0 && t_band_length < p_length)
+			{
+				MCGBlurPoolRun(t_lock, MCGBlurInvokeBand<T>, &p_callback, p_length, t_band_length);
+				t_done = true;
+			}
+		}
+
+		s_blur_pool_busy . unlock();
+
+		if (t_done)
+			return;
+	}
+#endif
+
+	p_callback(0, p_length);
+}
+
+// Horizontal (non-transposing) box blur, with the rows split into bands.
+static int boxBlurRows(const uint8_t* src, int src_y_stride, uint8_t* dst,
+                       int radius, int width, int height)
+{
+	int t_new_width;
+	t_new_width = width + radius * 2;
+	MCGBlurForEachBand(height, t_new_width * height, 1, [&](int p_start, int p_end) {
+		boxBlur(src + p_start * src_y_stride, src_y_stride, dst + p_start * t_new_width,
+				radius, radius, width, p_end - p_start, false);
+	});
+	return t_new_width;
+}
+
+// Vertical box blur, with the columns split into bands.
+static int boxBlurColumns(const uint8_t* src, uint8_t* dst, uint32_t* sums,
+                          int radius, int width, int height)
+{
+	MCGBlurForEachBand(width, width * (height + radius * 2), kMCGBlurParallelColumnAlign, [&](int p_start, int p_end) {
+		boxBlurVertical(src, dst, sums, radius, width, height, p_start, p_end);
+	});
+	return height + radius * 2;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//  Blurred mask cache.
+//
+//  Layer effects blur the alpha of the layer every time the area they cover is
+//  redrawn. Unless the control has changed, that mask is the same as last time
+//  so we keep the results of recent blurs keyed by the parameters and the full
+//  content of the source mask. Any change to the geometry or content of the
+//  control changes the source mask and so misses the cache.
+//
+
+#ifdef __MOBILE
+#define kMCGBlurCacheMaxBytes (2 * 1024 * 1024)
+#else
+#define kMCGBlurCacheMaxBytes (8 * 1024 * 1024)
+#endif
+
+#define kMCGBlurCacheMaxEntries 16
+
+// Masks with fewer pixels than this are quicker to blur than to look up.
+#define kMCGBlurCacheMinPixels (64 * 64)
+
+struct MCGBlurCacheEntry
+{
+	// The blur parameters.
+	int rx, ry, x_spread, y_spread, wx, wy;
+
+	// The source mask, without any row padding.
+	int src_width, src_height;
+	uint8_t *src_pixels;
+
+	// The blurred mask.
+	size_t dst_size;
+	uint8_t *dst_pixels;
+
+	// The value of the cache clock when the entry was last used.
+	uint32_t last_used;
+};
+
+static std::mutex s_blur_cache_lock;
+static MCGBlurCacheEntry s_blur_cache[kMCGBlurCacheMaxEntries];
+static size_t s_blur_cache_bytes = 0;
+static uint32_t s_blur_cache_clock = 0;
+
+static void MCGBlurCacheDiscardEntry(MCGBlurCacheEntry& x_entry)
+{
+	if (x_entry . src_pixels == NULL)
+		return;
+
+	s_blur_cache_bytes -= x_entry . src_width * x_entry . src_height + x_entry . dst_size;
+
+	MCMemoryDeallocate(x_entry . src_pixels);
+	MCMemoryDeallocate(x_entry . dst_pixels);
+	MCMemoryClear(&x_entry, sizeof(MCGBlurCacheEntry));
+}
+
+static bool MCGBlurCacheEntryMatches(const MCGBlurCacheEntry& p_entry, const MCGBlurCacheEntry& p_key, const SkMask& p_src)
+{
+	if (p_entry . src_pixels == NULL ||
+		p_entry . rx != p_key . rx || p_entry . ry != p_key . ry ||
+		p_entry . x_spread != p_key . x_spread || p_entry . y_spread != p_key . y_spread ||
+		p_entry . wx != p_key . wx || p_entry . wy != p_key . wy ||
+		p_entry . src_width != p_key . src_width || p_entry . src_height != p_key . src_height)
+		return false;
+
+	for (int y = 0; y < p_key . src_height; y++)
+		if (!MCMemoryEqual(p_entry . src_pixels + y * p_key . src_width, p_src . fImage + y * p_src . fRowBytes, p_key . src_width))
+			return false;
+
+	return true;
+}
+
+// Copies the cached result for the given source mask into r_pixels, if there
+// is one.
+static bool MCGBlurCacheLookup(const MCGBlurCacheEntry& p_key, const SkMask& p_src, size_t p_dst_size, uint8_t*& r_pixels)
+{
+	std::lock_guard<std::mutex> t_lock(s_blur_cache_lock);
+
+	for (int i = 0; i < kMCGBlurCacheMaxEntries; i++)
+	{
+		MCGBlurCacheEntry& t_entry = s_blur_cache[i];
+		if (!MCGBlurCacheEntryMatches(t_entry, p_key, p_src) ||
+			t_entry . dst_size != p_dst_size)
+			continue;
+
+		uint8_t *t_pixels;
+		t_pixels = SkMask::AllocImage(p_dst_size);
+		if (t_pixels == NULL)
+			return false;
+
+		MCMemoryCopy(t_pixels, t_entry . dst_pixels, p_dst_size);
+		t_entry . last_used = ++s_blur_cache_clock;
+
+		r_pixels = t_pixels;
+		return true;
+	}
+
+	return false;
+}
+
+static void MCGBlurCacheInsert(const MCGBlurCacheEntry& p_key, const SkMask& p_src, const uint8_t *p_dst_pixels, size_t p_dst_size)
+{
+	size_t t_size;
+	t_size = p_key . src_width * p_key . src_height + p_dst_size;
+	if (t_size > kMCGBlurCacheMaxBytes / 4)
+		return;
+
+	MCGBlurCacheEntry t_entry;
+	t_entry = p_key;
+	t_entry . src_pixels = NULL;
+	t_entry . dst_pixels = NULL;
+	t_entry . dst_size = p_dst_size;
+	if (!MCMemoryAllocate(p_key . src_width * p_key . src_height, t_entry . src_pixels) ||
+		!MCMemoryAllocate(p_dst_size, t_entry . dst_pixels))
+	{
+		MCMemoryDeallocate(t_entry . src_pixels);
+		return;
+	}
+
+	for (int y = 0; y < p_key . src_height; y++)
+		MCMemoryCopy(t_entry . src_pixels + y * p_key . src_width, p_src . fImage + y * p_src . fRowBytes, p_key . src_width);
+	MCMemoryCopy(t_entry . dst_pixels, p_dst_pixels, p_dst_size);
+
+	std::lock_guard<std::mutex> t_lock(s_blur_cache_lock);
+
+	// Evict the least recently used entries until there is room for the new
+	// one, and a free slot to put it in.
+	for (;;)
+	{
+		int t_free, t_oldest;
+		t_free = t_oldest = -1;
+		for (int i = 0; i < kMCGBlurCacheMaxEntries; i++)
+		{
+			if (s_blur_cache[i] . src_pixels == NULL)
+				t_free = i;
+			else if (t_oldest == -1 || s_blur_cache[i] . last_used < s_blur_cache[t_oldest] . last_used)
+				t_oldest = i;
+		}
+
+		if (t_free != -1 && s_blur_cache_bytes + t_size <= kMCGBlurCacheMaxBytes)
+		{
+			t_entry . last_used = ++s_blur_cache_clock;
+			s_blur_cache[t_free] = t_entry;
+			s_blur_cache_bytes += t_size;
+			return;
+		}
+
+		MCGBlurCacheDiscardEntry(s_blur_cache[t_oldest]);
+	}
+}
+
+void MCGBlurCacheCompact(void)
+{
+	std::lock_guard<std::mutex> t_lock(s_blur_cache_lock);
+	for (int i = 0; i < kMCGBlurCacheMaxEntries; i++)
+		MCGBlurCacheDiscardEntry(s_blur_cache[i]);
+}
+
+void MCGBlurCacheFinalize(void)
+{
+	MCGBlurCacheCompact();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 // pass 0 is (radius + (3 - 0 - 1)) / (3 - 0) = (radius + 2) / 3  (4)
 // radius -= p0_radius
 // pass 1 is (radius + (3 - 1 - 1)) / (3 - 1) = (radius + 1) / 2  (3)
@@ -375,7 +884,22 @@ bool MCGBlurBox(const SkMask& p_src, SkScalar p_x_radius, SkScalar p_y_radius, S
 	
 	const uint8_t *sp;
 	sp = p_src . fImage;
-	
+
+	MCGBlurCacheEntry t_key;
+	t_key . rx = rx;
+	t_key . ry = ry;
+	t_key . x_spread = x_spread;
+	t_key . y_spread = y_spread;
+	t_key . wx = wx;
+	t_key . wy = wy;
+	t_key . src_width = sw;
+	t_key . src_height = sh;
+
+	bool t_cacheable;
+	t_cacheable = sw * sh >= kMCGBlurCacheMinPixels;
+	if (t_cacheable && MCGBlurCacheLookup(t_key, p_src, t_dst_size, r_dst . fImage))
+		return true;
+
 	uint8_t *dp;
 	dp = SkMask::AllocImage(t_dst_size);
 	if (dp == nil)
@@ -392,6 +916,63 @@ bool MCGBlurBox(const SkMask& p_src, SkScalar p_x_radius, SkScalar p_y_radius, S
 	int w, h;
 	w = sw;
 	h = sh;
+	if (wx == 255 && wy == 255 && t_pass_count == 3)
+	{
+		// The common case of integer radii is done as three passes in X over
+		// the rows, followed by three passes in Y over the columns, rather than
+		// transposing so that all the passes can be done in X. This gives the
+		// same result as the general case below but the passes in Y can be
+		// vectorized, and both kinds of pass can be split into bands.
+		uint32_t *t_sums;
+		t_sums = NULL;
+		if (!MCMemoryNewArray(r_dst . fBounds . width(), t_sums))
+		{
+			SkMask::FreeImage(tp);
+			SkMask::FreeImage(dp);
+			return false;
+		}
+
+		const uint8_t *t_src;
+		int t_src_stride;
+		t_src = sp;
+		t_src_stride = p_src . fRowBytes;
+		if (x_spread != 0 || y_spread != 0)
+		{
+			dilateDistanceXY(sp, dp, x_spread, y_spread, w, h, w, h);
+			t_src = dp;
+			t_src_stride = w;
+		}
+
+		int r, t_pass_radius;
+		r = rx;
+		t_pass_radius = (r + 2) / 3;
+		r -= t_pass_radius;
+		w = boxBlurRows(t_src, t_src_stride, tp, t_pass_radius, w, h);
+		t_pass_radius = (r + 1) / 2;
+		r -= t_pass_radius;
+		w = boxBlurRows(tp, w, dp, t_pass_radius, w, h);
+		w = boxBlurRows(dp, w, tp, r, w, h);
+
+		r = ry;
+		t_pass_radius = (r + 2) / 3;
+		r -= t_pass_radius;
+		h = boxBlurColumns(tp, dp, t_sums, t_pass_radius, w, h);
+		t_pass_radius = (r + 1) / 2;
+		r -= t_pass_radius;
+		h = boxBlurColumns(dp, tp, t_sums, t_pass_radius, w, h);
+		h = boxBlurColumns(tp, dp, t_sums, r, w, h);
+
+		MCMemoryDeleteArray(t_sums);
+		SkMask::FreeImage(tp);
+
+		if (t_cacheable)
+			MCGBlurCacheInsert(t_key, p_src, dp, t_dst_size);
+
+		r_dst . fImage = dp;
+
+		return true;
+	}
+
 	if (wx == 255)
 	{
 		if (t_pass_count == 3)
@@ -524,6 +1105,9 @@ bool MCGBlurBox(const SkMask& p_src, SkScalar p_x_radius, SkScalar p_y_radius, S
 	}
 	
 	SkMask::FreeImage(tp);
+
+	if (t_cacheable)
+		MCGBlurCacheInsert(t_key, p_src, dp, t_dst_size);
 	
 	r_dst . fImage = dp;
 	
@@ -71,6 +71,16 @@ void MCGPlatformFinalize(void)
     s_measure_data = NULL;
 }
 
+void MCGPlatformCompact(void)
+{
+}
+
+bool MCGTextShapeCacheGetStatistics(MCGTextShapeCacheStatistics &r_statistics)
+{
+    // Text is shaped by the system, which does its own caching.
+    return false;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 // Creates an SkTypeface from a CTFontRef
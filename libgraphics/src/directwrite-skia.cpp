@@ -426,6 +426,16 @@ void MCGPlatformFinalize(void)
 		s_DWFactory->Release();
 }
 
+void MCGPlatformCompact(void)
+{
+}
+
+bool MCGTextShapeCacheGetStatistics(MCGTextShapeCacheStatistics &r_statistics)
+{
+	// Text is shaped by the system, which does its own caching.
+	return false;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 bool MCGDWSetFontFiles(MCProperListRef p_files)
@@ -629,6 +629,10 @@ enum MCGBlurType
 
 bool MCGBlurBox(const SkMask& p_src, SkScalar p_x_radius, SkScalar p_y_radius, SkScalar p_x_spread, SkScalar p_y_spread, SkMask& r_dst);
 
+void MCGBlurCacheFinalize(void);
+void MCGBlurCacheCompact(void);
+void MCGBlurPoolFinalize(void);
+
 ////////////////////////////////////////////////////////////////////////////////
 
 typedef struct __MCGCacheTable *MCGCacheTableRef;
@@ -653,6 +657,7 @@ MCGFloat __MCGContextMeasurePlatformText(MCGContextRef self, const unichar_t *p_
 
 void MCGPlatformInitialize(void);
 void MCGPlatformFinalize(void);
+void MCGPlatformCompact(void);
 
 void MCGTextMeasureCacheInitialize(void);
 void MCGTextMeasureCacheFinalize(void);
@@ -148,14 +148,21 @@ static MCGCacheTableRef s_hb_face_cache = nil;
 #define kMCHarfbuzzFaceCacheByteSize kMCHarfbuzzFaceCacheTableSize * 256
 #define kMCHarfbuzzFaceCacheMaxOccupancy kMCHarfbuzzFaceCacheTableSize * 0.5
 
+static void MCHarfbuzzShapeCacheInitialize(void);
+static void MCHarfbuzzShapeCacheFinalize(void);
+
 void MCGPlatformInitialize(void)
 {
     s_hb_face_cache = nil;
     /* UNCHECKED */ MCGCacheTableCreate(kMCHarfbuzzFaceCacheTableSize, kMCHarfbuzzFaceCacheMaxOccupancy, kMCHarfbuzzFaceCacheByteSize, s_hb_face_cache);
+    MCHarfbuzzShapeCacheInitialize();
 }
 
 void MCGPlatformFinalize(void)
 {
+    // The shaped runs hold references to fallback typefaces, so release them
+    // before the faces.
+    MCHarfbuzzShapeCacheFinalize();
     MCGCacheTableDestroy(s_hb_face_cache);
     s_hb_face_cache = nil;
 }
@@ -515,6 +522,340 @@ static bool MCHarfbuzzShape(const unichar_t* p_text, uindex_t p_char_count, bool
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// Shaping dominates the cost of drawing and measuring text, and fields shape
+// the same runs again every time they redraw. The results of shaping whole
+// strings are kept in a cache shared by layout, measuring and drawing, with
+// the least recently used discarded once it exceeds its byte limit.
+
+#ifdef __MOBILE
+#define kMCHarfbuzzShapeCacheByteSize (2 * 1024 * 1024)
+#else
+#define kMCHarfbuzzShapeCacheByteSize (8 * 1024 * 1024)
+#endif
+
+#define kMCHarfbuzzShapeCacheBucketCount 4096
+
+// Long strings are rarely drawn repeatedly and would push out many short ones.
+#define kMCHarfbuzzShapeCacheMaxCharCount 4096
+
+struct MCHarfbuzzShapedRun
+{
+	// The fallback font the run was shaped with - the fid is nil if the run
+	// uses the requested font.
+	MCGFont fallback_font;
+	
+	uindex_t char_start;
+	uindex_t char_count;
+	
+	uindex_t glyph_count;
+	hb_glyph_info_t *infos;
+	hb_glyph_position_t *positions;
+};
+
+struct MCHarfbuzzShapeCacheEntry
+{
+	MCHarfbuzzShapeCacheEntry *next_in_bucket;
+	MCHarfbuzzShapeCacheEntry *more_recent;
+	MCHarfbuzzShapeCacheEntry *less_recent;
+	
+	hash_t hash;
+	uint32_t typeface_id;
+	uint16_t size;
+	bool rtl;
+	unichar_t *chars;
+	uindex_t char_count;
+	
+	MCHarfbuzzShapedRun *runs;
+	uindex_t run_count;
+	
+	size_t byte_size;
+};
+
+struct MCHarfbuzzShapeCache
+{
+	MCHarfbuzzShapeCacheEntry **buckets;
+	MCHarfbuzzShapeCacheEntry *most_recent;
+	MCHarfbuzzShapeCacheEntry *least_recent;
+	size_t bytes_used;
+	
+	uint32_t hits;
+	uint32_t misses;
+};
+
+static MCHarfbuzzShapeCache s_shape_cache;
+
+static void MCHarfbuzzShapeCacheEntryDestroy(MCHarfbuzzShapeCacheEntry *p_entry)
+{
+	for (uindex_t i = 0; i < p_entry->run_count; i++)
+	{
+		MCMemoryDeleteArray(p_entry->runs[i].infos);
+		MCMemoryDeleteArray(p_entry->runs[i].positions);
+		if (p_entry->runs[i].fallback_font.fid != nil)
+			((SkTypeface *)p_entry->runs[i].fallback_font.fid)->unref();
+	}
+	
+	MCMemoryDeleteArray(p_entry->runs);
+	MCMemoryDeleteArray(p_entry->chars);
+	MCMemoryDelete(p_entry);
+}
+
+static void MCHarfbuzzShapeCacheRemove(MCHarfbuzzShapeCacheEntry *p_entry)
+{
+	MCHarfbuzzShapeCacheEntry **t_link;
+	t_link = &s_shape_cache.buckets[p_entry->hash % kMCHarfbuzzShapeCacheBucketCount];
+	while (*t_link != p_entry)
+		t_link = &(*t_link)->next_in_bucket;
+	*t_link = p_entry->next_in_bucket;
+	
+	if (p_entry->more_recent != nil)
+		p_entry->more_recent->less_recent = p_entry->less_recent;
+	else
+		s_shape_cache.most_recent = p_entry->less_recent;
+	
+	if (p_entry->less_recent != nil)
+		p_entry->less_recent->more_recent = p_entry->more_recent;
+	else
+		s_shape_cache.least_recent = p_entry->more_recent;
+	
+	p_entry->next_in_bucket = p_entry->more_recent = p_entry->less_recent = nil;
+	s_shape_cache.bytes_used -= p_entry->byte_size;
+}
+
+// Add an entry as the most recently used, discarding the least recently used
+// entries until the cache is within its size.
+static void MCHarfbuzzShapeCacheInsert(MCHarfbuzzShapeCacheEntry *p_entry)
+{
+	MCHarfbuzzShapeCacheEntry **t_bucket;
+	t_bucket = &s_shape_cache.buckets[p_entry->hash % kMCHarfbuzzShapeCacheBucketCount];
+	p_entry->next_in_bucket = *t_bucket;
+	*t_bucket = p_entry;
+	
+	p_entry->less_recent = s_shape_cache.most_recent;
+	if (s_shape_cache.most_recent != nil)
+		s_shape_cache.most_recent->more_recent = p_entry;
+	else
+		s_shape_cache.least_recent = p_entry;
+	s_shape_cache.most_recent = p_entry;
+	
+	s_shape_cache.bytes_used += p_entry->byte_size;
+	
+	while (s_shape_cache.bytes_used > kMCHarfbuzzShapeCacheByteSize && s_shape_cache.least_recent != p_entry)
+	{
+		MCHarfbuzzShapeCacheEntry *t_discard;
+		t_discard = s_shape_cache.least_recent;
+		MCHarfbuzzShapeCacheRemove(t_discard);
+		MCHarfbuzzShapeCacheEntryDestroy(t_discard);
+	}
+}
+
+static MCHarfbuzzShapeCacheEntry *MCHarfbuzzShapeCacheLookup(hash_t p_hash, uint32_t p_typeface_id, uint16_t p_size, bool p_rtl, const unichar_t *p_text, uindex_t p_char_count)
+{
+	for (MCHarfbuzzShapeCacheEntry *t_entry = s_shape_cache.buckets[p_hash % kMCHarfbuzzShapeCacheBucketCount]; t_entry != nil; t_entry = t_entry->next_in_bucket)
+		if (t_entry->hash == p_hash &&
+			t_entry->typeface_id == p_typeface_id &&
+			t_entry->size == p_size &&
+			t_entry->rtl == p_rtl &&
+			t_entry->char_count == p_char_count &&
+			MCMemoryEqual(t_entry->chars, p_text, p_char_count * sizeof(unichar_t)))
+			return t_entry;
+	
+	return nil;
+}
+
+static void MCHarfbuzzShapeCacheInitialize(void)
+{
+	MCMemoryClear(s_shape_cache);
+	/* UNCHECKED */ MCMemoryNewArray(kMCHarfbuzzShapeCacheBucketCount, s_shape_cache.buckets);
+}
+
+static void MCHarfbuzzShapeCacheCompact(void)
+{
+	while (s_shape_cache.least_recent != nil)
+	{
+		MCHarfbuzzShapeCacheEntry *t_discard;
+		t_discard = s_shape_cache.least_recent;
+		MCHarfbuzzShapeCacheRemove(t_discard);
+		MCHarfbuzzShapeCacheEntryDestroy(t_discard);
+	}
+}
+
+static void MCHarfbuzzShapeCacheFinalize(void)
+{
+	if (s_shape_cache.buckets == nil)
+		return;
+	
+#ifdef _DEBUG
+	MCLog("Text shape cache: %u hits, %u misses", s_shape_cache.hits, s_shape_cache.misses);
+#endif
+	
+	MCHarfbuzzShapeCacheCompact();
+	MCMemoryDeleteArray(s_shape_cache.buckets);
+	s_shape_cache.buckets = nil;
+}
+
+struct _shape_record_context_t
+{
+	const MCGFont *font;
+	const unichar_t *text;
+	MCHarfbuzzShapeCacheEntry *entry;
+	bool success;
+};
+
+static bool _shape_record_callback(void *context, const hb_glyph_info_t *p_infos, const hb_glyph_position_t *p_positions, uindex_t p_glyph_count, const unichar_t *p_chars, uindex_t p_char_count, const MCGFont &p_font)
+{
+	_shape_record_context_t *self;
+	self = (_shape_record_context_t*)context;
+	
+	MCHarfbuzzShapeCacheEntry *t_entry;
+	t_entry = self->entry;
+	
+	uindex_t t_index;
+	t_index = t_entry->run_count;
+	if (!MCMemoryResizeArray(t_index + 1, t_entry->runs, t_entry->run_count))
+	{
+		self->success = false;
+		return false;
+	}
+	
+	MCHarfbuzzShapedRun &t_run = t_entry->runs[t_index];
+	if (!MCMemoryNewArray(p_glyph_count, t_run.infos) ||
+		!MCMemoryNewArray(p_glyph_count, t_run.positions))
+	{
+		self->success = false;
+		return false;
+	}
+	
+	MCMemoryCopy(t_run.infos, p_infos, p_glyph_count * sizeof(hb_glyph_info_t));
+	MCMemoryCopy(t_run.positions, p_positions, p_glyph_count * sizeof(hb_glyph_position_t));
+	t_run.glyph_count = p_glyph_count;
+	t_run.char_start = p_chars - self->text;
+	t_run.char_count = p_char_count;
+	
+	// Runs shaped with a fallback font are passed a font which only lives as
+	// long as the shaping, so keep a copy (and the typeface) with the run.
+	if (&p_font != self->font)
+	{
+		t_run.fallback_font = p_font;
+		((SkTypeface *)p_font.fid)->ref();
+	}
+	
+	t_entry->byte_size += sizeof(MCHarfbuzzShapedRun) + p_glyph_count * (sizeof(hb_glyph_info_t) + sizeof(hb_glyph_position_t));
+	
+	return true;
+}
+
+static void MCHarfbuzzShapeCacheReplay(MCHarfbuzzShapeCacheEntry *p_entry, const unichar_t *p_text, const MCGFont &p_font, MCHarfbuzzShapeCallback p_callback, void *p_context)
+{
+	for (uindex_t i = 0; i < p_entry->run_count; i++)
+	{
+		const MCHarfbuzzShapedRun &t_run = p_entry->runs[i];
+		if (!p_callback(p_context,
+						t_run.infos,
+						t_run.positions,
+						t_run.glyph_count,
+						p_text + t_run.char_start,
+						t_run.char_count,
+						t_run.fallback_font.fid != nil ? t_run.fallback_font : p_font))
+			break;
+	}
+}
+
+// Shape a string, reusing the result of shaping it before in the same font if
+// possible.
+static bool MCHarfbuzzShapeCached(const unichar_t* p_text, uindex_t p_char_count, bool p_rtl, const MCGFont &p_font, MCHarfbuzzShapeCallback p_callback, void *p_context)
+{
+	if (s_shape_cache.buckets == nil || p_font.fid == nil ||
+		p_char_count == 0 || p_char_count > kMCHarfbuzzShapeCacheMaxCharCount)
+		return MCHarfbuzzShape(p_text, p_char_count, p_rtl, p_font, false, p_callback, p_context);
+	
+	// Use the typeface's unique id as a typeface may be freed and another
+	// allocated at the same address.
+	uint32_t t_typeface_id;
+	t_typeface_id = ((SkTypeface *)p_font.fid)->uniqueID();
+	
+	hash_t t_hash;
+	t_hash = MCHashBytes(p_text, p_char_count * sizeof(unichar_t));
+	t_hash = MCHashBytesStream(t_hash, &t_typeface_id, sizeof(t_typeface_id));
+	t_hash = MCHashBytesStream(t_hash, &p_font.size, sizeof(p_font.size));
+	t_hash = MCHashBytesStream(t_hash, &p_rtl, sizeof(p_rtl));
+	
+	MCHarfbuzzShapeCacheEntry *t_entry;
+	t_entry = MCHarfbuzzShapeCacheLookup(t_hash, t_typeface_id, p_font.size, p_rtl, p_text, p_char_count);
+	if (t_entry != nil)
+	{
+		s_shape_cache.hits++;
+		
+		// Take the entry out of the cache while replaying it, in case the
+		// callback shapes more text and causes it to be discarded.
+		MCHarfbuzzShapeCacheRemove(t_entry);
+		MCHarfbuzzShapeCacheReplay(t_entry, p_text, p_font, p_callback, p_context);
+		MCHarfbuzzShapeCacheInsert(t_entry);
+		return true;
+	}
+	
+	s_shape_cache.misses++;
+	
+	if (!MCMemoryNew(t_entry) ||
+		!MCMemoryNewArray(p_char_count, t_entry->chars))
+	{
+		MCMemoryDelete(t_entry);
+		return MCHarfbuzzShape(p_text, p_char_count, p_rtl, p_font, false, p_callback, p_context);
+	}
+	
+	MCMemoryCopy(t_entry->chars, p_text, p_char_count * sizeof(unichar_t));
+	t_entry->char_count = p_char_count;
+	t_entry->hash = t_hash;
+	t_entry->typeface_id = t_typeface_id;
+	t_entry->size = p_font.size;
+	t_entry->rtl = p_rtl;
+	t_entry->byte_size = sizeof(MCHarfbuzzShapeCacheEntry) + p_char_count * sizeof(unichar_t);
+	
+	_shape_record_context_t t_record;
+	t_record.font = &p_font;
+	t_record.text = p_text;
+	t_record.entry = t_entry;
+	t_record.success = true;
+	
+	bool t_success;
+	t_success = MCHarfbuzzShape(p_text, p_char_count, p_rtl, p_font, false, _shape_record_callback, &t_record);
+	
+	if (!t_record.success)
+	{
+		MCHarfbuzzShapeCacheEntryDestroy(t_entry);
+		return MCHarfbuzzShape(p_text, p_char_count, p_rtl, p_font, false, p_callback, p_context);
+	}
+	
+	// The entry is only cached once the callback is done with it, for the same
+	// reason as above.
+	MCHarfbuzzShapeCacheReplay(t_entry, p_text, p_font, p_callback, p_context);
+	
+	if (t_success)
+		MCHarfbuzzShapeCacheInsert(t_entry);
+	else
+		MCHarfbuzzShapeCacheEntryDestroy(t_entry);
+	
+	return t_success;
+}
+
+void MCGPlatformCompact(void)
+{
+	MCHarfbuzzShapeCacheCompact();
+}
+
+bool MCGTextShapeCacheGetStatistics(MCGTextShapeCacheStatistics &r_statistics)
+{
+	if (s_shape_cache.buckets == nil)
+		return false;
+	
+	r_statistics.hits = s_shape_cache.hits;
+	r_statistics.misses = s_shape_cache.misses;
+	r_statistics.bytes_used = s_shape_cache.bytes_used;
+	r_statistics.max_bytes = kMCHarfbuzzShapeCacheByteSize;
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 struct _draw_text_context_t
 {
 	SkCanvas *canvas;
@@ -564,7 +905,7 @@ void MCGContextDrawPlatformText(MCGContextRef self, const unichar_t *p_text, uin
 	t_context.paint = t_paint;
 	t_context.location = p_location;
 
-	/* UNCHECKED */ MCHarfbuzzShape(p_text, p_length / 2, p_rtl, p_font, false, _draw_text_callback, &t_context);
+	/* UNCHECKED */ MCHarfbuzzShapeCached(p_text, p_length / 2, p_rtl, p_font, _draw_text_callback, &t_context);
 
 	self -> is_valid = true;
 }
@@ -595,7 +936,7 @@ MCGFloat __MCGContextMeasurePlatformText(MCGContextRef self, const unichar_t *p_
 	MCGFloat t_width;
 	t_width = 0.0;
 	
-	/* UNCHECKED */ MCHarfbuzzShape(p_text, p_length / 2, false, p_font, false, _measure_text_callback, &t_width);
+	/* UNCHECKED */ MCHarfbuzzShapeCached(p_text, p_length / 2, false, p_font, _measure_text_callback, &t_width);
 
 	return t_width;
 }
@@ -651,7 +992,7 @@ bool MCGContextMeasurePlatformTextImageBounds(MCGContextRef self, const unichar_
 	t_context.location = MCGPointMake(0,0);
 	t_context.bounds = SkRect::MakeEmpty();
 
-	/* UNCHECKED */ MCHarfbuzzShape(p_text, p_length / 2, false, p_font, false, _measure_image_bounds_callback, &t_context);
+	/* UNCHECKED */ MCHarfbuzzShapeCached(p_text, p_length / 2, false, p_font, _measure_image_bounds_callback, &t_context);
 
 	r_bounds = MCGRectangleFromSkRect(t_context.bounds);
 
@@ -707,7 +1048,7 @@ bool MCGFontLayoutText(const MCGFont &p_font, const unichar_t *p_text, uindex_t
 	t_context.success = true;
 
 	bool t_success;
-	t_success = MCHarfbuzzShape(p_text, p_char_count, p_rtl, p_font, false, _layout_text_callback, &t_context);
+	t_success = MCHarfbuzzShapeCached(p_text, p_char_count, p_rtl, p_font, _layout_text_callback, &t_context);
 		return t_success && t_context.success;
 }
 
@@ -131,6 +131,16 @@ void MCGPlatformFinalize(void)
 {
 	lnx_pango_finalize();
 }
+
+void MCGPlatformCompact(void)
+{
+}
+
+bool MCGTextShapeCacheGetStatistics(MCGTextShapeCacheStatistics &r_statistics)
+{
+	// Text is shaped by the system, which does its own caching.
+	return false;
+}
 ////////////////////////////////////////////////////////////////////////////////
 
 void MCGContextDrawPlatformText(MCGContextRef self, const unichar_t *p_text, uindex_t p_length, MCGPoint p_location, const MCGFont &p_font, bool p_rtl)
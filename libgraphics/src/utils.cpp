@@ -45,6 +45,8 @@ void MCGraphicsFinalize(void)
     
 	MCGPlatformFinalize();
 	MCGTextMeasureCacheFinalize();
+	MCGBlurCacheFinalize();
+	MCGBlurPoolFinalize();
 	MCGBlendModesFinalize();
     
 #ifdef _DEBUG
@@ -54,7 +56,9 @@ void MCGraphicsFinalize(void)
 
 void MCGraphicsCompact(void)
 {
+	MCGPlatformCompact();
 	MCGTextMeasureCacheCompact();
+	MCGBlurCacheCompact();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
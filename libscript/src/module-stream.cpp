@@ -17,6 +17,9 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 #include <foundation.h>
 #include <foundation-system.h>
+#include <foundation-filters.h>
+
+#include <math.h>
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -38,6 +41,120 @@ MCStreamExecWriteToStream(MCDataRef p_data,
 	}
 }
 
+extern "C" MC_DLLEXPORT_DEF void
+MCStreamExecReadFromStream(uindex_t p_count,
+                           MCStreamRef p_stream,
+                           MCDataRef & r_data)
+{
+	if (!MCStreamIsReadable (p_stream))
+	{
+		MCErrorCreateAndThrow (kMCGenericErrorTypeInfo, "reason", MCSTR("stream is not readable"), NULL);
+		return;
+	}
+
+	byte_t *t_buffer;
+	if (!MCMemoryNewArray (p_count, t_buffer))
+		return;
+
+	if (!MCStreamRead (p_stream, t_buffer, p_count))
+	{
+		MCMemoryDeleteArray (t_buffer);
+
+		/* Not all streams set an error when they run out of data */
+		if (!MCErrorIsPending())
+			MCErrorCreateAndThrow (kMCGenericErrorTypeInfo, "reason", MCSTR("not enough data in stream"), NULL);
+		return;
+	}
+
+	/* UNCHECKED */ MCDataCreateWithBytesAndRelease (t_buffer, p_count, r_data);
+}
+
+extern "C" MC_DLLEXPORT_DEF void
+MCStreamExecIsFinished(MCStreamRef p_stream,
+                       bool & r_finished)
+{
+	if (!MCStreamIsFinished (p_stream, r_finished) &&
+	    !MCErrorIsPending())
+	{
+		MCErrorCreateAndThrow (kMCGenericErrorTypeInfo, "reason", MCSTR("stream cannot detect its end"), NULL);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+extern "C" MC_DLLEXPORT_DEF void
+MCStreamExecGetPosition(MCStreamRef p_stream,
+                        double & r_position)
+{
+	if (!MCStreamIsSeekable (p_stream))
+	{
+		MCErrorCreateAndThrow (kMCGenericErrorTypeInfo, "reason", MCSTR("stream is not seekable"), NULL);
+		return;
+	}
+
+	filepos_t t_position;
+	if (!MCStreamTell (p_stream, t_position))
+		return;
+
+	r_position = double(t_position);
+}
+
+extern "C" MC_DLLEXPORT_DEF void
+MCStreamExecSetPosition(double p_position,
+                        MCStreamRef p_stream)
+{
+	if (!MCStreamIsSeekable (p_stream))
+	{
+		MCErrorCreateAndThrow (kMCGenericErrorTypeInfo, "reason", MCSTR("stream is not seekable"), NULL);
+		return;
+	}
+
+	if (p_position < 0 || p_position != floor (p_position) ||
+	    p_position > double(INT64_MAX))
+	{
+		MCErrorCreateAndThrow (kMCGenericErrorTypeInfo, "reason", MCSTR("stream position must be a non-negative integer"), NULL);
+		return;
+	}
+
+	if (!MCStreamSeek (p_stream, filepos_t(p_position)) &&
+	    !MCErrorIsPending())
+	{
+		MCErrorCreateAndThrow (kMCGenericErrorTypeInfo, "reason", MCSTR("stream position is out of range"), NULL);
+	}
+}
+
+extern "C" MC_DLLEXPORT_DEF void
+MCStreamExecMarkStream(MCStreamRef p_stream)
+{
+	if (!MCStreamIsMarkable (p_stream))
+	{
+		MCErrorCreateAndThrow (kMCGenericErrorTypeInfo, "reason", MCSTR("stream is not markable"), NULL);
+		return;
+	}
+
+	if (!MCStreamMark (p_stream, SIZE_MAX) &&
+	    !MCErrorIsPending())
+	{
+		MCErrorCreateAndThrow (kMCGenericErrorTypeInfo, "reason", MCSTR("failed to mark stream"), NULL);
+	}
+}
+
+extern "C" MC_DLLEXPORT_DEF void
+MCStreamExecResetStream(MCStreamRef p_stream)
+{
+	if (!MCStreamIsMarkable (p_stream))
+	{
+		MCErrorCreateAndThrow (kMCGenericErrorTypeInfo, "reason", MCSTR("stream is not markable"), NULL);
+		return;
+	}
+
+	if (!MCStreamReset (p_stream) &&
+	    !MCErrorIsPending())
+	{
+		MCErrorCreateAndThrow (kMCGenericErrorTypeInfo, "reason", MCSTR("failed to reset stream"), NULL);
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 extern "C" MC_DLLEXPORT_DEF void
@@ -52,6 +169,71 @@ MCStreamExecGetStandardError (MCStreamRef & r_stream)
 	MCSStreamGetStandardError (r_stream);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+extern "C" MC_DLLEXPORT_DEF void
+MCStreamExecCreateFileInputStream (MCStringRef p_path,
+                                   MCStreamRef & r_stream)
+{
+	if (!MCSFileCreateStream (p_path, kMCSFileOpenModeRead, r_stream) &&
+	    !MCErrorIsPending())
+	{
+		MCErrorCreateAndThrow (kMCGenericErrorTypeInfo, "reason", MCSTR("failed to open file"), NULL);
+	}
+}
+
+extern "C" MC_DLLEXPORT_DEF void
+MCStreamExecCreateFileOutputStream (MCStringRef p_path,
+                                    MCStreamRef & r_stream)
+{
+	if (!MCSFileCreateStream (p_path, kMCSFileOpenModeWrite, r_stream) &&
+	    !MCErrorIsPending())
+	{
+		MCErrorCreateAndThrow (kMCGenericErrorTypeInfo, "reason", MCSTR("failed to open file"), NULL);
+	}
+}
+
+extern "C" MC_DLLEXPORT_DEF void
+MCStreamExecCreateMappedFileStream (MCStringRef p_path,
+                                    MCStreamRef & r_stream)
+{
+	if (!MCSFileCreateMappedStream (p_path, r_stream) &&
+	    !MCErrorIsPending())
+	{
+		MCErrorCreateAndThrow (kMCGenericErrorTypeInfo, "reason", MCSTR("failed to open file"), NULL);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+extern "C" MC_DLLEXPORT_DEF void
+MCStreamExecCreateCompressStream (MCStreamRef p_target,
+                                  integer_t p_level,
+                                  MCStreamRef & r_stream)
+{
+	if (p_level < kMCFiltersCompressionLevelDefault ||
+	    p_level > kMCFiltersCompressionLevelMax)
+	{
+		MCErrorCreateAndThrow (kMCGenericErrorTypeInfo, "reason", MCSTR("compression level must be from 0 to 9"), NULL);
+		return;
+	}
+
+	MCFiltersCompressStreamCreate (p_target, p_level, r_stream);
+}
+
+extern "C" MC_DLLEXPORT_DEF void
+MCStreamExecFinishCompressStream (MCStreamRef p_stream)
+{
+	MCFiltersCompressStreamFinish (p_stream);
+}
+
+extern "C" MC_DLLEXPORT_DEF void
+MCStreamExecCreateDecompressStream (MCStreamRef p_source,
+                                    MCStreamRef & r_stream)
+{
+	MCFiltersDecompressStreamCreate (p_source, r_stream);
+}
+
 ////////////////////////////////////////////////////////////////
 
 extern "C" bool com_livecode_stream_Initialize (void)
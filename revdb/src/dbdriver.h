@@ -192,6 +192,17 @@ public:
 	virtual int getVersion(void) = 0;
 };
 
+class DBConnection3: public DBConnection2
+{
+public:
+	// This method executes <p_query> once for each of <p_row_count> rows, stopping at the first row that fails.
+	// The arguments of each row follow those of the previous row in <p_arguments>, and <p_row_lengths> gives
+	// the number of arguments of each row. On return <r_affected_rows> holds the affected row count of each
+	// row that succeeded and <r_executed_count> the number of such rows. If False is returned, the row at index
+	// <r_executed_count> failed and getErrorMessage() returns its error. Drivers that can do so undo the effects
+	// of all rows when one fails, without disturbing any transaction the caller has open.
+	virtual Bool sqlExecuteBatch(char *p_query, DBString *p_arguments, int *p_row_lengths, int p_row_count, unsigned int *r_affected_rows, int &r_executed_count) = 0;
+};
 
 
 ///////////////////////////////////////////////////////////////////////////////
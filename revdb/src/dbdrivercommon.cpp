@@ -110,6 +110,34 @@ bool CDBConnection::isLegacy(void)
 	return getConnectionType() > 0; 
 }
 
+Bool CDBConnection::sqlExecuteBatch(char *p_query, DBString *p_arguments, int *p_row_lengths, int p_row_count, unsigned int *r_affected_rows, int &r_executed_count)
+{
+	return executeBatchRows(this, p_query, p_arguments, p_row_lengths, p_row_count, r_affected_rows, r_executed_count);
+}
+
+// This is also used by revdb directly for drivers which predate DBConnection3, so
+// it must only use the DBConnection interface of <p_connection>.
+Bool CDBConnection::executeBatchRows(DBConnection *p_connection, char *p_query, DBString *p_arguments, int *p_row_lengths, int p_row_count, unsigned int *r_affected_rows, int &r_executed_count)
+{
+	r_executed_count = 0;
+
+	DBString *t_row_arguments;
+	t_row_arguments = p_arguments;
+	for (int i = 0; i < p_row_count; i++)
+	{
+		unsigned int t_affected_rows;
+		t_affected_rows = 0;
+		if (!p_connection -> sqlExecute(p_query, t_row_arguments, p_row_lengths[i], t_affected_rows))
+			return False;
+
+		r_affected_rows[i] = t_affected_rows;
+		r_executed_count += 1;
+		t_row_arguments += p_row_lengths[i];
+	}
+
+	return True;
+}
+
 // p_input - input query
 // p_output - output buffer (allocated by caller)
 // p_callback - place-holder processing function (provided by caller)
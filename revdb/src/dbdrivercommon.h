@@ -189,7 +189,7 @@ inline bool DBBuffer::append(const char *p_bytes, int p_count)
 
 ///////////////////////////////////////////////////////////////////////////////
 
-class CDBConnection: public DBConnection2
+class CDBConnection: public DBConnection3
 {
 public:
 	CDBConnection();
@@ -207,6 +207,10 @@ public:
 	static bool processQuery(const char *p_input, DBBuffer& p_output, ProcessQueryCallback p_callback, void *p_callback_context);
 	bool isLegacy(void);
 
+	// Default batch execution, which runs sqlExecute for each row in the connection's current commit mode.
+	virtual Bool sqlExecuteBatch(char *p_query, DBString *p_arguments, int *p_row_lengths, int p_row_count, unsigned int *r_affected_rows, int &r_executed_count);
+	static Bool executeBatchRows(DBConnection *p_connection, char *p_query, DBString *p_arguments, int *p_row_lengths, int p_row_count, unsigned int *r_affected_rows, int &r_executed_count);
+
 protected:
 	void addCursor(DBCursor *newcursor);
 	void closeCursors();
@@ -57,6 +57,7 @@ public:
 	Bool connect(char **args, int numargs);
 	void disconnect();
 	Bool sqlExecute(char *query, DBString *args, int numargs, unsigned int &affectedrows);
+	Bool sqlExecuteBatch(char *p_query, DBString *p_arguments, int *p_row_lengths, int p_row_count, unsigned int *r_affected_rows, int &r_executed_count);
 	DBCursor *sqlQuery(char *query, DBString *args, int numargs, int p_rows);
 	MYSQL *getMySQL() {return &mysql;}
 	const char *getconnectionstring();
@@ -67,7 +68,7 @@ public:
 	Bool IsError();
 	void getTables(char *buffer, int *bufsize);
 	int getConnectionType(void) { return -1; }
-	int getVersion(void) { return 2; }
+	int getVersion(void) { return 3; }
 protected:
 	bool BindVariables(MYSQL_STMT *p_statement, DBString *p_arguments, int p_argument_count, int *p_placeholders, int p_placeholder_count, MYSQL_BIND **p_bind);
 	bool ExecuteQuery(char *p_query, DBString *p_arguments, int p_argument_count);
@@ -83,6 +83,7 @@ public:
 	Bool connect( char **args, int numargs);
 	void disconnect();
 	Bool sqlExecute(char *query, DBString *args, int numargs, unsigned int &affectedrows);
+	Bool sqlExecuteBatch(char *p_query, DBString *p_arguments, int *p_row_lengths, int p_row_count, unsigned int *r_affected_rows, int &r_executed_count);
 	DBCursor *sqlQuery(char *query, DBString *args, int numargs, int p_rows);
 	void getTables(char *buffer, int *bufsize);
 	HDBC getHDBC() {return hdbc;}
@@ -94,7 +95,7 @@ public:
 	char *getErrorMessage(Bool p_last);
 	Bool IsError();
 	cursor_type_t getCursorType(void) { return m_cursor_type; }
-	int getVersion(void) { return 2; }
+	int getVersion(void) { return 3; }
 	int getConnectionType(void) { return -1; }
 protected:
 	void SetError(SQLHSTMT tcursor);
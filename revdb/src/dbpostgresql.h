@@ -128,6 +128,7 @@ public:
 	Bool connect(char **args, int numargs);
 	void disconnect();
 	Bool sqlExecute(char *query, DBString *args, int numargs, unsigned int &affectedrows);
+	Bool sqlExecuteBatch(char *p_query, DBString *p_arguments, int *p_row_lengths, int p_row_count, unsigned int *r_affected_rows, int &r_executed_count);
 	DBCursor *sqlQuery(char *query, DBString *args, int numargs, int p_rows);
 	void getTables(char *buffer, int *bufsize);
 	const char *getconnectionstring();
@@ -137,7 +138,7 @@ public:
 	char *getErrorMessage(Bool p_last);
 	Bool IsError();
 	int getConnectionType(void) { return -1; }
-	int getVersion(void) { return 2; }
+	int getVersion(void) { return 3; }
 protected:
 	PGconn *dbconn;
 	PGresult *ExecuteQuery(char *p_query, DBString *p_arguments, int p_argument_count);
@@ -84,6 +84,8 @@ class DBConnection_SQLITE : public CDBConnection
 
 		Bool sqlExecute(char *query, DBString *args, int numargs, unsigned int &affectedrows);
 
+		Bool sqlExecuteBatch(char *p_query, DBString *p_arguments, int *p_row_lengths, int p_row_count, unsigned int *r_affected_rows, int &r_executed_count);
+
 		DBCursor *sqlQuery(char *query, DBString *args, int numargs, int p_rows);
 
 		void transBegin();
@@ -96,10 +98,11 @@ class DBConnection_SQLITE : public CDBConnection
 		const char *getconnectionstring();
 
 		int getConnectionType(void) { return -1; }
-		int getVersion(void) { return 2; }
+		int getVersion(void) { return 3; }
 
 	protected:
 		char *BindVariables(char *query, int oldsize, DBString *args, int numargs, int &newsize);
+		Bool executePreparedBatch(sqlite3_stmt *p_statement, DBString *p_arguments, int *p_row_lengths, int p_row_count, unsigned int *r_affected_rows, int &r_executed_count);
 		void setErrorStr(const char *msg);
 
 		SqliteDatabase mDB;
@@ -212,6 +212,61 @@ Bool DBConnection_MYSQL::sqlExecute(char *p_query, DBString *p_arguments, int p_
 }
 
 
+/*Method to execute a statement once for each row of arguments. If the connection has no
+transaction open the rows are run in their own transaction, and otherwise they are run inside a
+savepoint of it, so either way all the rows are rolled back if one of them fails. Rows which
+change tables of a non-transactional engine, such as MyISAM, can not be rolled back.*/
+Bool DBConnection_MYSQL::sqlExecuteBatch(char *p_query, DBString *p_arguments, int *p_row_lengths, int p_row_count, unsigned int *r_affected_rows, int &r_executed_count)
+{
+	r_executed_count = 0;
+
+	if (!isConnected)
+		return False;
+
+	const char *t_begin, *t_commit, *t_rollback_to, *t_release;
+	if ((getMySQL() -> server_status & SERVER_STATUS_IN_TRANS) == 0)
+	{
+		t_begin = "START TRANSACTION";
+		t_commit = "COMMIT";
+		t_rollback_to = "ROLLBACK";
+		t_release = NULL;
+	}
+	else
+	{
+		t_begin = "SAVEPOINT revdb_batch";
+		t_commit = "RELEASE SAVEPOINT revdb_batch";
+		t_rollback_to = "ROLLBACK TO SAVEPOINT revdb_batch";
+		t_release = "RELEASE SAVEPOINT revdb_batch";
+	}
+
+	if (mysql_query(getMySQL(), t_begin) != 0)
+	{
+		errorMessageSet(mysql_error(getMySQL()));
+		return False;
+	}
+
+	Bool t_success;
+	t_success = executeBatchRows(this, p_query, p_arguments, p_row_lengths, p_row_count, r_affected_rows, r_executed_count);
+
+	if (t_success && mysql_query(getMySQL(), t_commit) != 0)
+	{
+		errorMessageSet(mysql_error(getMySQL()));
+		t_success = False;
+	}
+
+	// Rolling back leaves the error message of the failing row in place, as it is
+	// only set by sqlExecute.
+	if (!t_success)
+	{
+		mysql_query(getMySQL(), t_rollback_to);
+		if (t_release != NULL)
+			mysql_query(getMySQL(), t_release);
+	}
+
+	return t_success;
+}
+
+
 /*Method to execute sql statements like SELECT and return Cursor
 Inputs:
 query- string containing sql query
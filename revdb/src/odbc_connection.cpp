@@ -265,6 +265,54 @@ Bool DBConnection_ODBC::sqlExecute(char *p_query, DBString *p_arguments, int p_a
 	return t_result;
 }
 
+/*Method to execute a statement once for each row of arguments. If the connection is in
+auto-commit mode it is switched to manual commit for the duration of the batch, so all the rows
+are committed together or rolled back if one of them fails. Otherwise the caller's transaction
+is already open and the rows are run in it.*/
+Bool DBConnection_ODBC::sqlExecuteBatch(char *p_query, DBString *p_arguments, int *p_row_lengths, int p_row_count, unsigned int *r_affected_rows, int &r_executed_count)
+{
+	r_executed_count = 0;
+
+	if (!isConnected)
+		return False;
+
+	SQLUINTEGER t_autocommit;
+	t_autocommit = SQL_AUTOCOMMIT_ON;
+	if (!SQL_SUCCEEDED(SQLGetConnectAttr(hdbc, SQL_ATTR_AUTOCOMMIT, &t_autocommit, 0, NULL)))
+	{
+		SetError(SQL_NULL_HSTMT);
+		return False;
+	}
+
+	if (t_autocommit == SQL_AUTOCOMMIT_OFF)
+		return executeBatchRows(this, p_query, p_arguments, p_row_lengths, p_row_count, r_affected_rows, r_executed_count);
+
+	if (!SQL_SUCCEEDED(SQLSetConnectAttr(hdbc, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER)SQL_AUTOCOMMIT_OFF, 0)))
+	{
+		SetError(SQL_NULL_HSTMT);
+		return False;
+	}
+
+	Bool t_success;
+	t_success = executeBatchRows(this, p_query, p_arguments, p_row_lengths, p_row_count, r_affected_rows, r_executed_count);
+
+	if (t_success && !SQL_SUCCEEDED(SQLEndTran(SQL_HANDLE_DBC, hdbc, SQL_COMMIT)))
+	{
+		SetError(SQL_NULL_HSTMT);
+		t_success = False;
+	}
+
+	// Rolling back leaves the error message of the failing row in place, as it is
+	// only set by sqlExecute.
+	if (!t_success)
+		SQLEndTran(SQL_HANDLE_DBC, hdbc, SQL_ROLLBACK);
+
+	SQLSetConnectAttr(hdbc, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER)SQL_AUTOCOMMIT_ON, 0);
+
+	return t_success;
+}
+
+
 /*Method to execute sql statements like SELECT and return Cursor
 Inputs:
 query- string containing sql query
@@ -371,6 +371,211 @@ Bool DBConnection_POSTGRESQL::sqlExecute(char *p_query, DBString *p_arguments, i
 }
 
 
+// Replaces each placeholder of a batch query with the corresponding $N parameter of
+// the prepared statement, recording the highest parameter number used.
+static bool batchQueryCallback(void *p_context, int p_placeholder, DBBuffer &p_output)
+{
+	int *t_parameter_count;
+	t_parameter_count = (int *)p_context;
+
+	char t_parameter[16];
+	int t_length;
+	t_length = sprintf(t_parameter, "$%d", p_placeholder);
+
+	if (!p_output . append(t_parameter, t_length))
+		return false;
+
+	if (p_placeholder > *t_parameter_count)
+		*t_parameter_count = p_placeholder;
+
+	return true;
+}
+
+/*Method to execute a statement once for each row of arguments. The statement is prepared once
+and then executed with the parameters of each row. If the connection is idle the rows are run
+in their own transaction, and if the caller has a transaction open they are run inside a
+savepoint of it, so either way all the rows are rolled back if one of them fails.*/
+Bool DBConnection_POSTGRESQL::sqlExecuteBatch(char *p_query, DBString *p_arguments, int *p_row_lengths, int p_row_count, unsigned int *r_affected_rows, int &r_executed_count)
+{
+	r_executed_count = 0;
+
+	if (!isConnected)
+		return False;
+
+	const char *t_begin, *t_commit, *t_rollback;
+	switch(PQtransactionStatus(dbconn))
+	{
+	case PQTRANS_IDLE:
+		t_begin = "BEGIN";
+		t_commit = "COMMIT";
+		t_rollback = "ROLLBACK";
+		break;
+
+	case PQTRANS_INTRANS:
+		t_begin = "SAVEPOINT revdb_batch";
+		t_commit = "RELEASE SAVEPOINT revdb_batch";
+		t_rollback = "ROLLBACK TO SAVEPOINT revdb_batch; RELEASE SAVEPOINT revdb_batch";
+		break;
+
+	default:
+		// The connection is busy or its transaction has already failed, so just run the
+		// rows and let the server report the error.
+		return executeBatchRows(this, p_query, p_arguments, p_row_lengths, p_row_count, r_affected_rows, r_executed_count);
+	}
+
+	// Convert the :N placeholders of the query into the $N parameters of a prepared statement.
+	int t_parameter_count;
+	t_parameter_count = 0;
+
+	DBBuffer t_query_buffer(strlen(p_query) + 1);
+	if (!processQuery(p_query, t_query_buffer, batchQueryCallback, &t_parameter_count) || !t_query_buffer . append("", 1))
+	{
+		errorMessageSet("revdb,insufficient memory");
+		return False;
+	}
+
+	PGresult *t_postgres_result;
+	t_postgres_result = PQexec(dbconn, t_begin);
+
+	Bool t_success;
+	t_success = PQresultStatus(t_postgres_result) == PGRES_COMMAND_OK;
+	PQclear(t_postgres_result);
+
+	if (!t_success)
+	{
+		errorMessageSet(PQerrorMessage(dbconn));
+		return False;
+	}
+
+	bool t_prepared;
+	t_postgres_result = PQprepare(dbconn, "revdb_batch", t_query_buffer . borrow(), t_parameter_count, NULL);
+	t_prepared = PQresultStatus(t_postgres_result) == PGRES_COMMAND_OK;
+	PQclear(t_postgres_result);
+
+	t_success = t_prepared;
+	if (!t_success)
+		errorMessageSet(PQerrorMessage(dbconn));
+
+	const char **t_values;
+	int *t_lengths, *t_formats;
+	t_values = NULL;
+	t_lengths = NULL;
+	t_formats = NULL;
+
+	if (t_success && t_parameter_count != 0)
+	{
+		t_values = (const char **)malloc(sizeof(const char *) * t_parameter_count);
+		t_lengths = (int *)malloc(sizeof(int) * t_parameter_count);
+		t_formats = (int *)malloc(sizeof(int) * t_parameter_count);
+
+		t_success = t_values != NULL && t_lengths != NULL && t_formats != NULL;
+		if (!t_success)
+			errorMessageSet("revdb,insufficient memory");
+	}
+
+	DBString *t_row_arguments;
+	t_row_arguments = p_arguments;
+	for (int i = 0; t_success && i < p_row_count; i++)
+	{
+		if (p_row_lengths[i] < t_parameter_count)
+		{
+			errorMessageSet("revdb,too few parameters for placeholders");
+			t_success = False;
+			break;
+		}
+
+		// Text parameters are passed as C strings, so each one is copied into a buffer of
+		// its own with a terminating null. Binary parameters are passed as they are.
+		int t_filled;
+		for (t_filled = 0; t_success && t_filled < t_parameter_count; t_filled++)
+		{
+			int j = t_filled;
+			DBString &t_argument = t_row_arguments[j];
+			t_lengths[j] = t_argument . length;
+			t_formats[j] = t_argument . isbinary ? 1 : 0;
+			if (t_argument . isbinary)
+				t_values[j] = t_argument . sptr;
+			else
+			{
+				char *t_value;
+				t_value = (char *)malloc(t_argument . length + 1);
+				if (t_value != NULL)
+				{
+					memcpy(t_value, t_argument . sptr, t_argument . length);
+					t_value[t_argument . length] = '\0';
+				}
+				else
+				{
+					errorMessageSet("revdb,insufficient memory");
+					t_success = False;
+				}
+				t_values[j] = t_value;
+			}
+		}
+
+		if (t_success)
+		{
+			t_postgres_result = PQexecPrepared(dbconn, "revdb_batch", t_parameter_count, t_values, t_lengths, t_formats, 0);
+
+			ExecStatusType t_status;
+			t_status = PQresultStatus(t_postgres_result);
+			if (t_status == PGRES_COMMAND_OK)
+			{
+				const char *t_affected_rows;
+				t_affected_rows = PQcmdTuples(t_postgres_result);
+				r_affected_rows[i] = *t_affected_rows == '\0' ? 0 : atol(t_affected_rows);
+			}
+			else if (t_status == PGRES_TUPLES_OK)
+				r_affected_rows[i] = 0;
+			else
+			{
+				errorMessageSet(PQerrorMessage(dbconn));
+				t_success = False;
+			}
+			PQclear(t_postgres_result);
+		}
+
+		for (int j = 0; j < t_filled; j++)
+			if (t_formats[j] == 0)
+				free((void *)t_values[j]);
+
+		if (t_success)
+		{
+			r_executed_count += 1;
+			t_row_arguments += p_row_lengths[i];
+		}
+	}
+
+	free(t_values);
+	free(t_lengths);
+	free(t_formats);
+
+	if (t_success)
+	{
+		t_postgres_result = PQexec(dbconn, t_commit);
+		t_success = PQresultStatus(t_postgres_result) == PGRES_COMMAND_OK;
+		PQclear(t_postgres_result);
+
+		if (t_success)
+			errorMessageSet(NULL);
+		else
+			errorMessageSet(PQerrorMessage(dbconn));
+	}
+
+	// Rolling back leaves the error message of the failing row in place, as it is
+	// only set by the steps above.
+	if (!t_success && PQtransactionStatus(dbconn) != PQTRANS_IDLE)
+		PQclear(PQexec(dbconn, t_rollback));
+
+	// Prepared statements outlive the transaction they were prepared in, so the
+	// statement is released whether or not the batch succeeded.
+	if (t_prepared)
+		PQclear(PQexec(dbconn, "DEALLOCATE revdb_batch"));
+
+	return t_success;
+}
+
+
 /*Method to execute sql statements like SELECT and return Cursor
 Inputs:
 query- string containing sql query
@@ -1077,6 +1077,321 @@ void REVDB_Execute(char *p_arguments[], int p_argument_count, char **p_return_st
 }
 
 
+// A single parameter value of a batch execution, as extracted from the rows array
+// passed to REVDB_ExecuteBatch.
+struct BatchCell
+{
+	int row;
+	int column;
+	Bool is_binary;
+	ExternalString value;
+};
+
+static int BatchCellCompare(const void *a, const void *b)
+{
+	const BatchCell *t_cell_a, *t_cell_b;
+	t_cell_a = (const BatchCell *)a;
+	t_cell_b = (const BatchCell *)b;
+
+	if (t_cell_a -> row != t_cell_b -> row)
+		return t_cell_a -> row < t_cell_b -> row ? -1 : 1;
+
+	if (t_cell_a -> column != t_cell_b -> column)
+		return t_cell_a -> column < t_cell_b -> column ? -1 : 1;
+
+	return 0;
+}
+
+/// @brief Utility function to parse a key of a batch rows array.
+/// @param p_key null terminated key of the form "row,column". The key, or the column part of it, may be
+/// prefixed by "*b" to indicate the value is binary.
+/// @return true if the key is well formed, false otherwise.
+static bool ParseBatchKey(const char *p_key, int &r_row, int &r_column, Bool &r_is_binary)
+{
+	r_is_binary = False;
+	if (p_key[0] == '*' && p_key[1] == 'b')
+	{
+		r_is_binary = True;
+		p_key += 2;
+	}
+
+	char *t_end_pointer;
+	long t_row;
+	t_row = strtol(p_key, &t_end_pointer, 10);
+	if (t_end_pointer == p_key || *t_end_pointer != ',')
+		return false;
+
+	p_key = t_end_pointer + 1;
+	if (p_key[0] == '*' && p_key[1] == 'b')
+	{
+		r_is_binary = True;
+		p_key += 2;
+	}
+
+	long t_column;
+	t_column = strtol(p_key, &t_end_pointer, 10);
+	if (t_end_pointer == p_key || *t_end_pointer != '\0')
+		return false;
+
+	r_row = (int)t_row;
+	r_column = (int)t_column;
+	return true;
+}
+
+/// @brief Executes one SQL statement once for each row of an array of parameters.
+/// @param connectionId The integer connection id to use.
+/// @param query The SQL query to execute, containing :1, :2, ... placeholders.
+/// @param rowsArrayName The name of an array whose keys are of the form "row,column". The
+/// element with key "r,c" is substituted for placeholder :c when executing row r. Prefixing the
+/// key, or its column part, with "*b" marks the value as binary. Row and column numbers must be
+/// positive and the columns of each row must run from 1 without gaps.
+/// @param resultsArrayName (optional) The name of a variable that will receive an array keyed by
+/// row number containing the number of affected rows for each row executed, or the error message
+/// of the row that failed.
+/// @return Either an error string or the total number of rows affected.
+///
+/// The connection is looked up once and the rows are executed in ascending row order by the
+/// driver's sqlExecuteBatch, stopping at the first row that fails, in which case an error string
+/// of the form "revdberr,row <n>,<driver error>" is returned. The bundled drivers undo all the
+/// rows of a failed batch, using a transaction of their own when none is open and otherwise a
+/// savepoint, so the caller's own transaction is left intact; ODBC has no savepoints and runs
+/// the rows in the caller's transaction. Drivers which predate sqlExecuteBatch execute each row
+/// in the connection's current commit mode.
+void REVDB_ExecuteBatch(char *p_arguments[], int p_argument_count, char **p_return_string, Bool *p_pass, Bool *p_error)
+{
+	*p_error = True;
+	*p_pass = False;
+
+	if (p_argument_count != 3 && p_argument_count != 4)
+	{
+		*p_return_string = istrdup(errors[REVDBERR_SYNTAX]);
+		return;
+	}
+
+	*p_error = False;
+	int t_connection_id;
+	t_connection_id = atoi(p_arguments[0]);
+
+	DBConnection *t_connection;
+	t_connection = (DBConnection *)connectionlist.find(t_connection_id);
+
+	char *t_query;
+	t_query = p_arguments[1];
+
+	if (t_connection == NULL)
+	{
+		*p_return_string = istrdup(errors[REVDBERR_BADCONNECTION]);
+		*p_error = True;
+		return;
+	}
+
+	int t_return_value;
+	int t_element_count;
+	t_element_count = 0;
+	GetArray(p_arguments[2], &t_element_count, NULL, NULL, &t_return_value);
+
+	char **t_array_keys;
+	t_array_keys = NULL;
+
+	ExternalString *t_array_values;
+	t_array_values = NULL;
+
+	BatchCell *t_cells;
+	t_cells = NULL;
+
+	int t_cell_count;
+	t_cell_count = 0;
+
+	bool t_valid;
+	t_valid = true;
+
+	if (t_element_count != 0)
+	{
+		t_array_keys = (char **)malloc(sizeof(char *) * t_element_count);
+		t_array_values = (ExternalString *)malloc(sizeof(ExternalString) * t_element_count);
+		t_cells = (BatchCell *)malloc(sizeof(BatchCell) * t_element_count);
+		GetArray(p_arguments[2], &t_element_count, t_array_values, t_array_keys, &t_return_value);
+
+		// Elements whose keys are not of the form "row,column" are ignored, in the same way
+		// as non-integer keys are ignored by BindVariables.
+		for (int i = 0; i < t_element_count; i++)
+		{
+			BatchCell &t_cell = t_cells[t_cell_count];
+			if (!ParseBatchKey(t_array_keys[i], t_cell . row, t_cell . column, t_cell . is_binary))
+				continue;
+
+			t_cell . value = t_array_values[i];
+			t_cell_count += 1;
+		}
+
+		// Keys are unordered so sort the cells by row and then by column, so that each
+		// row's values are contiguous and in placeholder order.
+		qsort(t_cells, t_cell_count, sizeof(BatchCell), BatchCellCompare);
+
+		// As each row's values are bound by position, the columns of a row must be exactly
+		// 1 to n. Anything else, including a column given twice, would bind the wrong values.
+		for (int i = 0; i < t_cell_count && t_valid; i++)
+		{
+			if (t_cells[i] . row <= 0)
+				t_valid = false;
+			else if (i == 0 || t_cells[i] . row != t_cells[i - 1] . row)
+				t_valid = t_cells[i] . column == 1;
+			else
+				t_valid = t_cells[i] . column == t_cells[i - 1] . column + 1;
+		}
+	}
+
+	if (!t_valid)
+	{
+		*p_return_string = istrdup(errors[REVDBERR_BADCOLUMNNUM]);
+		*p_error = True;
+
+		free(t_cells);
+		free(t_array_keys);
+		free(t_array_values);
+		return;
+	}
+
+	int t_row_count;
+	t_row_count = 0;
+	for (int i = 0; i < t_cell_count; i++)
+		if (i == 0 || t_cells[i] . row != t_cells[i - 1] . row)
+			t_row_count += 1;
+
+	// OK-2008-12-09: As with BindVariables, duplicate the value buffers so the engine
+	// cannot change them while the driver is using them.
+	DBString *t_values;
+	t_values = new (nothrow) DBString[t_cell_count > 0 ? t_cell_count : 1];
+	for (int i = 0; i < t_cell_count; i++)
+	{
+		char *t_new_buffer;
+		t_new_buffer = (char *)malloc(t_cells[i] . value . length);
+		memcpy(t_new_buffer, t_cells[i] . value . buffer, t_cells[i] . value . length);
+
+		t_values[i] . Set(t_new_buffer, t_cells[i] . value . length, t_cells[i] . is_binary);
+	}
+
+	// The row number and argument count of each row, in execution order.
+	int *t_row_numbers;
+	t_row_numbers = (int *)malloc(sizeof(int) * (t_row_count + 1));
+
+	int *t_row_lengths;
+	t_row_lengths = (int *)malloc(sizeof(int) * (t_row_count + 1));
+
+	unsigned int *t_affected_rows;
+	t_affected_rows = (unsigned int *)malloc(sizeof(unsigned int) * (t_row_count + 1));
+
+	int t_row_index;
+	t_row_index = -1;
+	for (int i = 0; i < t_cell_count; i++)
+	{
+		if (i == 0 || t_cells[i] . row != t_cells[i - 1] . row)
+		{
+			t_row_index += 1;
+			t_row_numbers[t_row_index] = t_cells[i] . row;
+			t_row_lengths[t_row_index] = 0;
+		}
+		t_row_lengths[t_row_index] += 1;
+	}
+
+	int t_executed_count;
+	t_executed_count = 0;
+
+	Bool t_result;
+	if (((CDBConnection *)t_connection) -> isLegacy() || static_cast<DBConnection2 *>(t_connection) -> getVersion() < 3)
+		t_result = CDBConnection::executeBatchRows(t_connection, t_query, t_values, t_row_lengths, t_row_count, t_affected_rows, t_executed_count);
+	else
+		t_result = static_cast<DBConnection3 *>(t_connection) -> sqlExecuteBatch(t_query, t_values, t_row_lengths, t_row_count, t_affected_rows, t_executed_count);
+
+	for (int i = 0; i < t_cell_count; i++)
+		free((void *)t_values[i] . sptr);
+
+	char **t_result_keys;
+	t_result_keys = (char **)malloc(sizeof(char *) * (t_row_count + 1));
+
+	ExternalString *t_result_values;
+	t_result_values = (ExternalString *)malloc(sizeof(ExternalString) * (t_row_count + 1));
+
+	int t_result_count;
+	t_result_count = 0;
+
+	unsigned int t_total_affected_rows;
+	t_total_affected_rows = 0;
+
+	for (int i = 0; i < t_executed_count; i++)
+	{
+		t_total_affected_rows += t_affected_rows[i];
+
+		t_result_keys[t_result_count] = (char *)malloc(INTSTRSIZE);
+		sprintf(t_result_keys[t_result_count], "%d", t_row_numbers[i]);
+
+		char *t_row_value;
+		t_row_value = (char *)malloc(INTSTRSIZE);
+		sprintf(t_row_value, "%u", t_affected_rows[i]);
+
+		t_result_values[t_result_count] . buffer = t_row_value;
+		t_result_values[t_result_count] . length = strlen(t_row_value);
+		t_result_count += 1;
+	}
+
+	char *t_error;
+	t_error = NULL;
+
+	if (!t_result)
+	{
+		// Drivers are not required to set an error message, so fall back to a generic one.
+		const char *t_message;
+		t_message = t_connection -> getErrorMessage();
+		if (t_message == NULL || *t_message == '\0')
+			t_message = "Unable to execute query";
+
+		t_error = (char *)malloc(INTSTRSIZE + strlen(t_message) + 16);
+
+		// A batch can fail after all its rows have run, for example when committing it.
+		if (t_executed_count < t_row_count)
+		{
+			t_result_keys[t_result_count] = (char *)malloc(INTSTRSIZE);
+			sprintf(t_result_keys[t_result_count], "%d", t_row_numbers[t_executed_count]);
+			t_result_values[t_result_count] . buffer = istrdup(t_message);
+			t_result_values[t_result_count] . length = strlen(t_message);
+			t_result_count += 1;
+
+			sprintf(t_error, "revdberr,row %d,%s", t_row_numbers[t_executed_count], t_message);
+		}
+		else
+			sprintf(t_error, "revdberr,%s", t_message);
+	}
+
+	if (p_argument_count == 4)
+		SetArray(p_arguments[3], t_result_count, t_result_values, t_result_keys, &t_return_value);
+
+	if (t_error != NULL)
+		*p_return_string = t_error;
+	else
+	{
+		char *t_return_string;
+		t_return_string = (char *)malloc(INTSTRSIZE);
+		sprintf(t_return_string, "%u", t_total_affected_rows);
+		*p_return_string = t_return_string;
+	}
+
+	for (int i = 0; i < t_result_count; i++)
+	{
+		free(t_result_keys[i]);
+		free((void *)t_result_values[i] . buffer);
+	}
+	free(t_result_keys);
+	free(t_result_values);
+
+	free(t_affected_rows);
+	free(t_row_lengths);
+	free(t_row_numbers);
+	delete[] t_values;
+	free(t_cells);
+	free(t_array_keys);
+	free(t_array_values);
+}
+
 /// @brief Executes an sql query and returns a result set id
 /// @param connectionId The integer connection id to use
 /// @param query The SQL query to execute.
@@ -2268,6 +2583,7 @@ EXTERNAL_BEGIN_DECLARATIONS("revDB")
 	EXTERNAL_DECLARE_FUNCTION("revdb_commit", REVDB_Commit)
 	EXTERNAL_DECLARE_FUNCTION("revdb_rollback", REVDB_Rollback)
 	EXTERNAL_DECLARE_FUNCTION("revdb_execute", REVDB_Execute)
+	EXTERNAL_DECLARE_FUNCTION("revdb_executebatch", REVDB_ExecuteBatch)
 	EXTERNAL_DECLARE_FUNCTION("revdb_query", REVDB_Query)
 	EXTERNAL_DECLARE_FUNCTION("revdb_queryblob", REVDB_Query)
 	EXTERNAL_DECLARE_FUNCTION("revdb_closecursor", REVDB_CloseCursor)
@@ -2307,6 +2623,7 @@ EXTERNAL_BEGIN_DECLARATIONS("revDB")
 	EXTERNAL_DECLARE_COMMAND("revCommitDatabase", REVDB_Commit)
 	EXTERNAL_DECLARE_COMMAND("revRollBackDatabase", REVDB_Rollback)
 	EXTERNAL_DECLARE_COMMAND("revExecuteSQL", REVDB_Execute)
+	EXTERNAL_DECLARE_COMMAND("revExecuteSQLBatch", REVDB_ExecuteBatch)
 	EXTERNAL_DECLARE_FUNCTION("revQueryDatabase", REVDB_Query)
 	EXTERNAL_DECLARE_FUNCTION("revQueryDatabaseBLOB", REVDB_Query)
 	EXTERNAL_DECLARE_COMMAND("revCloseCursor", REVDB_CloseCursor)
@@ -26,6 +26,7 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #include <sqlitedecode.h>
 
 #include <assert.h>
+#include <ctype.h>
 #include <errno.h>
 #include <stdint.h>
 
@@ -663,6 +664,169 @@ int DBConnection_SQLITE::basicExec(const char *q, unsigned int *rows)
 	return t_return_value;
 }
 
+// Placeholder callback used by sqlExecuteBatch which replaces :N by the numbered parameter
+// ?N, so that the query can be prepared once and each row's values bound to it.
+static bool batchQueryCallback(void *p_context, int p_placeholder, DBBuffer& p_output)
+{
+	char t_parameter[16];
+	sprintf(t_parameter, "?%d", p_placeholder);
+	return p_output . append(t_parameter, strlen(t_parameter));
+}
+
+static int bindBatchValue(sqlite3_stmt *p_statement, int p_index, const DBString& p_value, bool p_binary_enabled)
+{
+	// A zero length value must still be bound as an empty value rather than NULL, as it is
+	// when substituted by BindVariables.
+	const char *t_bytes;
+	t_bytes = p_value . length != 0 ? p_value . sptr : "";
+
+	if (!p_value . isbinary)
+		return sqlite3_bind_text(p_statement, p_index, t_bytes, p_value . length, SQLITE_STATIC);
+
+	if (p_binary_enabled)
+		return sqlite3_bind_blob(p_statement, p_index, t_bytes, p_value . length, SQLITE_STATIC);
+
+	// Without binary support, binary values are stored in the same encoding that
+	// queryCallback uses.
+	unsigned char *t_encoded;
+	t_encoded = (unsigned char *)malloc(2 + (257 * (int64_t)p_value . length) / 254);
+	if (t_encoded == NULL)
+		return SQLITE_NOMEM;
+
+	int t_encoded_length;
+	t_encoded_length = sqlite_encode_binary((const unsigned char *)p_value . sptr, p_value . length, t_encoded);
+
+	int t_status;
+	t_status = sqlite3_bind_text(p_statement, p_index, (const char *)t_encoded, t_encoded_length, SQLITE_TRANSIENT);
+	free(t_encoded);
+
+	return t_status;
+}
+
+/*Method to execute a statement once for each row of arguments. The rows are run inside a
+savepoint, so that the batch nests within any transaction the caller has open and all its rows
+are rolled back if one of them fails.*/
+Bool DBConnection_SQLITE::sqlExecuteBatch(char *p_query, DBString *p_arguments, int *p_row_lengths, int p_row_count, unsigned int *r_affected_rows, int &r_executed_count)
+{
+	MDEBUG0("SQLite::sqlExecuteBatch\n");
+	r_executed_count = 0;
+
+	if (!isConnected)
+	{
+		mIsError = true;
+		setErrorStr("Not connected");
+		return False;
+	}
+
+	if (basicExec("SAVEPOINT revdb_batch") != SQLITE_OK)
+		return False;
+
+	DBBuffer t_query_buffer(strlen(p_query) + 1);
+	bool t_parsed;
+	t_parsed = processQuery(p_query, t_query_buffer, batchQueryCallback, NULL) && t_query_buffer . append("", 1);
+
+	sqlite3_stmt *t_statement;
+	t_statement = NULL;
+
+	const char *t_tail;
+	t_tail = NULL;
+
+	Bool t_success;
+	if (!t_parsed)
+	{
+		mIsError = true;
+		setErrorStr("Unable to execute query");
+		t_success = False;
+	}
+	else if (sqlite3_prepare_v2(mDB.getHandle(), t_query_buffer . borrow(), -1, &t_statement, &t_tail) != SQLITE_OK)
+	{
+		mIsError = true;
+		setErrorStr(sqlite3_errmsg(mDB.getHandle()));
+		t_success = False;
+	}
+	else
+	{
+		while (*t_tail != '\0' && isspace((unsigned char)*t_tail))
+			t_tail++;
+
+		// An empty query, or one containing several statements, cannot be run as a single
+		// prepared statement so each row is executed in full instead.
+		if (t_statement == NULL || *t_tail != '\0')
+			t_success = executeBatchRows(this, p_query, p_arguments, p_row_lengths, p_row_count, r_affected_rows, r_executed_count);
+		else
+			t_success = executePreparedBatch(t_statement, p_arguments, p_row_lengths, p_row_count, r_affected_rows, r_executed_count);
+	}
+
+	sqlite3_finalize(t_statement);
+
+	if (t_success && basicExec("RELEASE revdb_batch") != SQLITE_OK)
+		t_success = False;
+
+	// Don't use basicExec to undo the batch, as that would replace the error of the failing row.
+	if (!t_success)
+		sqlite3_exec(mDB.getHandle(), "ROLLBACK TO revdb_batch; RELEASE revdb_batch", 0, 0, 0);
+
+	return t_success;
+}
+
+Bool DBConnection_SQLITE::executePreparedBatch(sqlite3_stmt *p_statement, DBString *p_arguments, int *p_row_lengths, int p_row_count, unsigned int *r_affected_rows, int &r_executed_count)
+{
+	int t_parameter_count;
+	t_parameter_count = sqlite3_bind_parameter_count(p_statement);
+
+	DBString *t_row_arguments;
+	t_row_arguments = p_arguments;
+	for (int i = 0; i < p_row_count; i++)
+	{
+		// As with queryCallback, a placeholder beyond the row's arguments is an error.
+		if (p_row_lengths[i] < t_parameter_count)
+		{
+			mIsError = true;
+			setErrorStr("Unable to execute query: missing placeholder value");
+			return False;
+		}
+
+		int t_status;
+		t_status = SQLITE_OK;
+		for (int j = 0; j < t_parameter_count && t_status == SQLITE_OK; j++)
+			t_status = bindBatchValue(p_statement, j + 1, t_row_arguments[j], IsBinaryEnabled());
+
+		// Count changes in the same way as basicExec, so that each row reports the same
+		// affected row count as sqlExecute would.
+		int t_changed_row_count;
+		t_changed_row_count = 0;
+
+		bool t_has_rows;
+		t_has_rows = false;
+
+		if (t_status == SQLITE_OK)
+		{
+			sqlite3_update_hook(mDB.getHandle(), dataChangeCallback, &t_changed_row_count);
+			while ((t_status = sqlite3_step(p_statement)) == SQLITE_ROW)
+				t_has_rows = true;
+			sqlite3_update_hook(mDB.getHandle(), NULL, NULL);
+		}
+
+		if (t_status != SQLITE_DONE && t_status != SQLITE_OK)
+		{
+			mIsError = true;
+			setErrorStr(sqlite3_errmsg(mDB.getHandle()));
+			sqlite3_reset(p_statement);
+			return False;
+		}
+
+		sqlite3_reset(p_statement);
+		sqlite3_clear_bindings(p_statement);
+
+		r_affected_rows[i] = t_has_rows ? 0 : t_changed_row_count;
+		r_executed_count += 1;
+		t_row_arguments += p_row_lengths[i];
+	}
+
+	mIsError = false;
+	return True;
+}
+
 void DBConnection_SQLITE::setErrorStr(const char *msg)
 {
 	MDEBUG("\nsetErrorStr(%s)\n", msg);
@@ -73,13 +73,14 @@ Bool ReadFile(char *filename,  Bool wellformed);
 Bool Validate();
 void CopyDocument(CXMLDocument *tdocument,Bool truecopy = False);
 void New();
+Bool CopyNode(xmlNodePtr tnode);
 unsigned int GetID() {return id;}
 void Write(char **data,  int *length,Bool isformatted);
 Bool GetElementByPath(CXMLElement *telement, char *tpath);
 Bool GetRootElement(CXMLElement *telement);
 xmlDocPtr GetDocPtr() {return doc;}
 // MDW-2013-07-09: [[ RevXmlXPath ]]
-xmlXPathContextPtr GetXPathContext() {return xpathContext;}
+xmlXPathContextPtr GetXPathContext();
 // MDW-2013-09-03: [[ RevXmlXslt ]]
 xsltStylesheetPtr GetXsltContext() {return xsltID;}
 Bool AddDTD(char *data, unsigned long tlength);
@@ -19,10 +19,12 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #include <cmath> 
 #include <ctime>
 #include <vector>
+#include <string>
 
 #include <revolution/external.h>
 #include <revolution/support.h>
 #include <libxml/xpath.h>
+#include <libxml/xmlreader.h>
 #include <libxslt/transform.h>
 #include <libxslt/xsltutils.h>
 
@@ -154,9 +156,6 @@ class XMLDocumentList
 		VXMLDocList::iterator theIterator;
 		for (theIterator = doclist.begin(); theIterator != doclist.end(); theIterator++){
 			CXMLDocument *curobject = (CXMLDocument *)(*theIterator);
-			// MDW-2013-07-09: [[ RevXmlXPath ]]
-			if (NULL != curobject->GetXPathContext())
-				xmlXPathFreeContext(curobject->GetXPathContext());
 			// MDW-2013-09-04: [[ RevXmlXslt ]]
 			if (NULL != curobject->GetXsltContext())
 				xsltFreeStylesheet(curobject->GetXsltContext());
@@ -211,9 +210,12 @@ void REVXML_INIT()
 
 }
 
+static void XML_XPathCacheClear();
+
 void REVXML_QUIT()
 {
 		doclist.clear();
+		XML_XPathCacheClear();
 }
 
 //------------------------------------UTILITY FUNCTIONS--------------------------
@@ -2493,6 +2495,116 @@ xpathNodeBufGetContent(xmlBufferPtr buffer, xmlNodePtr cur, char *cDelimiter)
     return(0);
 }
 
+/**
+ * XPath compilation cache
+ *
+ * Compiled XPath expressions are independent of any document, so the most
+ * recently used ones are kept here and reused by subsequent evaluations of the
+ * same expression rather than being parsed again.
+ */
+#define XPATH_CACHE_SIZE 32
+
+struct XPathCacheEntry
+{
+	char *expression;
+	xmlXPathCompExprPtr compiled;
+	unsigned int last_used;
+};
+
+static XPathCacheEntry s_xpath_cache[XPATH_CACHE_SIZE];
+static unsigned int s_xpath_cache_clock = 0;
+
+static xmlXPathCompExprPtr XML_XPathCompile(const char *pExpression)
+{
+	s_xpath_cache_clock += 1;
+
+	int t_victim = 0;
+	for (int i = 0; i < XPATH_CACHE_SIZE; ++i)
+	{
+		XPathCacheEntry &t_entry = s_xpath_cache[i];
+		if (NULL != t_entry.expression && 0 == strcmp(t_entry.expression, pExpression))
+		{
+			t_entry.last_used = s_xpath_cache_clock;
+			return t_entry.compiled;
+		}
+		if (t_entry.last_used < s_xpath_cache[t_victim].last_used)
+			t_victim = i;
+	}
+
+	xmlXPathCompExprPtr t_compiled = xmlXPathCompile((const xmlChar *)pExpression);
+	if (NULL == t_compiled)
+		return NULL;
+
+	// evict the least recently used expression
+	XPathCacheEntry &t_entry = s_xpath_cache[t_victim];
+	if (NULL != t_entry.compiled)
+		xmlXPathFreeCompExpr(t_entry.compiled);
+	free(t_entry.expression);
+	t_entry.expression = istrdup(pExpression);
+	t_entry.compiled = t_compiled;
+	t_entry.last_used = s_xpath_cache_clock;
+
+	return t_compiled;
+}
+
+static void XML_XPathCacheClear()
+{
+	for (int i = 0; i < XPATH_CACHE_SIZE; ++i)
+	{
+		XPathCacheEntry &t_entry = s_xpath_cache[i];
+		if (NULL != t_entry.compiled)
+			xmlXPathFreeCompExpr(t_entry.compiled);
+		free(t_entry.expression);
+		t_entry.expression = NULL;
+		t_entry.compiled = NULL;
+		t_entry.last_used = 0;
+	}
+	s_xpath_cache_clock = 0;
+}
+
+/**
+ * XML_XPathEvaluate
+ * @pDocID : xml tree id
+ * @pExpression : xpath to evaluate
+ * @rError : set to the error string if evaluation fails
+ *
+ * Evaluates the (cached) compiled expression using the document's
+ * persistent XPath context. The caller must free the returned object.
+ */
+static xmlXPathObjectPtr XML_XPathEvaluate(const char *pDocID, const char *pExpression, const char *&rError)
+{
+	rError = NULL;
+
+	int docID = atoi(pDocID);
+	CXMLDocument *xmlDocument = doclist.find(docID);
+	if (NULL == xmlDocument)
+	{
+		rError = xmlerrors[XMLERR_BADDOCID];
+		return NULL;
+	}
+
+	if (NULL == xmlDocument->GetDocPtr())
+	{
+		rError = xmlerrors[XPATHERR_BADDOCPOINTER];
+		return NULL;
+	}
+
+	xmlXPathContextPtr ctx = xmlDocument->GetXPathContext();
+	if (NULL == ctx)
+	{
+		rError = xmlerrors[XPATHERR_BADDOCCONTEXT];
+		return NULL;
+	}
+
+	xmlXPathCompExprPtr compiled = XML_XPathCompile(pExpression);
+	if (NULL == compiled)
+		return NULL;
+
+	// evaluate relative to the document root, as a fresh context would
+	ctx->node = NULL;
+	return xmlXPathCompiledEval(compiled, ctx);
+}
+
 /**
  * XML_ObjectPtr_to_Xpaths
  *
@@ -2501,49 +2613,39 @@ xpathNodeBufGetContent(xmlBufferPtr buffer, xmlNodePtr cur, char *cDelimiter)
  */
 static char *XML_ObjectPtr_to_Xpaths(xmlXPathObjectPtr pObject, char *pLineDelimiter)
 {
-	int iBufferSize = 8192;
-	if (NULL != pObject)
+	if (NULL == pObject)
+		return NULL;
+
+	xmlNodeSetPtr nodes = XML_Object_to_NodeSet(pObject);
+	if (NULL == nodes)
+		return NULL;
+
+	xmlBufferPtr buffer = xmlBufferCreateSize(8192);
+	if (NULL == buffer)
+		return NULL;
+
+	for (int i = 0; i < nodes->nodeNr; ++i)
 	{
-		xmlNodeSetPtr nodes = XML_Object_to_NodeSet(pObject);
-		if (NULL != nodes)
+		xmlNodePtr cur = nodes->nodeTab[i];
+		if (NULL != cur)
 		{
-    			int i;
-			xmlNodePtr cur;
-		    	int size = (nodes) ? nodes->nodeNr : 0;
-			char *buffer = (char*)malloc(iBufferSize);
-			*buffer = (char)0; // null-terminate to start things off
-
-			for(i = 0; i < size; ++i)
+			xmlChar *cPtr = xmlGetNodePath(cur);
+			if (NULL != cPtr)
 			{
-				cur = nodes->nodeTab[i];
-				if (NULL != cur)
-				{
-					xmlChar *cPtr = xmlGetNodePath(cur);
-					if (NULL != cPtr)
-					{
-						// make more room if needed
-						if (strlen(buffer) + strlen((char*)cPtr) > iBufferSize)
-						{
-							iBufferSize += strlen((char*)cPtr) + iBufferSize;
-							buffer = (char*)realloc(buffer, iBufferSize);
-						}
-						strncat(buffer, (char*)cPtr, strlen((char*)cPtr));
-						strcat(buffer, pLineDelimiter);
-						free((char*)cPtr);
-					}
-				}
+				xmlBufferCat(buffer, cPtr);
+				xmlBufferCat(buffer, (xmlChar *)pLineDelimiter);
+				xmlFree(cPtr);
 			}
-			return (buffer);
 		}
-		else
-			return(NULL);
 	}
-	else
-		return(NULL);
+
+	char *result = istrdup((const char *)xmlBufferContent(buffer));
+	xmlBufferFree(buffer);
+	return result;
 }
 
 /**
- * XML_ObjectPtr_to_Xpaths
+ * XML_ObjectPtr_to_Data
  *
  * @pObject
  * @pElementDelimiter : delimiter between returned elements
@@ -2551,45 +2653,93 @@ static char *XML_ObjectPtr_to_Xpaths(xmlXPathObjectPtr pObject, char *pLineDelim
  */
 static char *XML_ObjectPtr_to_Data(xmlXPathObjectPtr pObject, char *pElementDelimiter, char *pLineDelimiter)
 {
-	int iBufferSize = 8192;
-	if (NULL != pObject)
+	if (NULL == pObject)
+		return NULL;
+
+	xmlNodeSetPtr nodes = XML_Object_to_NodeSet(pObject);
+	if (NULL == nodes)
+		return NULL;
+
+	xmlBufferPtr buffer = xmlBufferCreateSize(8192);
+	if (NULL == buffer)
+		return NULL;
+
+	for (int i = 0; i < nodes->nodeNr; ++i)
 	{
-		xmlNodeSetPtr nodes = XML_Object_to_NodeSet(pObject);
-		if (NULL != nodes)
+		xmlNodePtr cur = nodes->nodeTab[i];
+		if (NULL != cur)
 		{
-    			int i;
-			xmlNodePtr cur;
-		    	int size = (nodes) ? nodes->nodeNr : 0;
-			char *buffer = (char*)malloc(iBufferSize);
-			*buffer = (char)0; // null-terminate to start things off
-
-			for(i = 0; i < size; ++i)
+			xmlChar *cPtr = xpathNodeGetContent(cur, pElementDelimiter);
+			if (NULL != cPtr)
 			{
-				cur = nodes->nodeTab[i];
-				if (NULL != cur)
-				{
-					xmlChar *cPtr = xpathNodeGetContent(cur, pElementDelimiter);
-					if (NULL != cPtr)
-					{
-						// make more room if needed
-						if (strlen(buffer) + strlen((char*)cPtr) > iBufferSize)
-						{
-							buffer = (char*)realloc(buffer, iBufferSize * 2);
-							iBufferSize = iBufferSize * 2;
-						}
-						strncat(buffer, (char*)cPtr, strlen((char*)cPtr));
-						strcat(buffer, pLineDelimiter);
-						free((char*)cPtr);
-					}
-				}
+				xmlBufferCat(buffer, cPtr);
+				xmlBufferCat(buffer, (xmlChar *)pLineDelimiter);
+				xmlFree(cPtr);
 			}
-			return (buffer);
 		}
+	}
+
+	char *result = istrdup((const char *)xmlBufferContent(buffer));
+	xmlBufferFree(buffer);
+	return result;
+}
+
+/**
+ * XML_ObjectPtr_to_Array
+ *
+ * @pObject
+ * @pArrayName : name of the variable to set
+ * @pElementDelimiter : delimiter between data elements, or NULL to return node paths
+ *
+ * Sets the named variable to an array with one element per node, keyed
+ * from 1, without building an intermediate delimited string.
+ * Returns the number of elements, or -1 if the object is not a node set.
+ */
+static int XML_ObjectPtr_to_Array(xmlXPathObjectPtr pObject, const char *pArrayName, char *pElementDelimiter)
+{
+	if (NULL == pObject)
+		return -1;
+
+	xmlNodeSetPtr nodes = XML_Object_to_NodeSet(pObject);
+	if (NULL == nodes)
+		return -1;
+
+	int count = 0;
+	char **keys = (char **)malloc(sizeof(char *) * (nodes->nodeNr + 1));
+	ExternalString *values = (ExternalString *)malloc(sizeof(ExternalString) * (nodes->nodeNr + 1));
+
+	for (int i = 0; i < nodes->nodeNr; ++i)
+	{
+		xmlNodePtr cur = nodes->nodeTab[i];
+		if (NULL == cur)
+			continue;
+
+		xmlChar *cPtr;
+		if (NULL == pElementDelimiter)
+			cPtr = xmlGetNodePath(cur);
 		else
-			return(NULL);
+			cPtr = xpathNodeGetContent(cur, pElementDelimiter);
+
+		keys[count] = (char *)malloc(INTSTRSIZE);
+		sprintf(keys[count], "%d", count + 1);
+		values[count].buffer = (NULL != cPtr) ? (const char *)cPtr : XMLNULLSTRING;
+		values[count].length = (NULL != cPtr) ? xmlStrlen(cPtr) : 0;
+		count += 1;
 	}
-	else
-		return(NULL);
+
+	int retvalue;
+	SetArray(pArrayName, count, values, keys, &retvalue);
+
+	for (int i = 0; i < count; ++i)
+	{
+		free(keys[i]);
+		if (values[i].buffer != XMLNULLSTRING)
+			xmlFree((xmlChar *)values[i].buffer);
+	}
+	free(keys);
+	free(values);
+
+	return count;
 }
 
 /**
@@ -2609,48 +2759,24 @@ void XML_EvalXPath(char *args[], int nargs, char **retstring, Bool *pass, Bool *
 	*pass = False;
 	*error = False;
 
-	int docID = atoi(args[0]);
-	CXMLDocument *xmlDocument = doclist.find(docID);
-	if (NULL != xmlDocument)
+	const char *xpatherror;
+	xmlXPathObjectPtr result = XML_XPathEvaluate(args[0], args[1], xpatherror);
+	if (NULL != result)
 	{
-		xmlDocPtr xmlDoc = xmlDocument->GetDocPtr();
-		if (NULL != xmlDoc)
-		{
-			xmlXPathContextPtr ctx = xmlXPathNewContext(xmlDoc);
-			if (NULL != ctx)
-			{
-				xmlChar *str = (xmlChar *)args[1];
-
-				xmlXPathObjectPtr result = xmlXPathEvalExpression(str, ctx);
-				if (NULL != result)
-				{
-					char *cDelimiter;
-					if (nargs > 2)
-						cDelimiter = args[2];
-					else
-						cDelimiter = (char *)"\n";
-					char *xpaths = XML_ObjectPtr_to_Xpaths(result, cDelimiter);
-					if (NULL != xpaths)
-					{
-						*retstring = istrdup(xpaths);
-						free(xpaths);
-					}
-					else
-					{
-						*retstring = istrdup(xmlerrors[XPATHERR_CANTRESOLVE]);
-					}
-					xmlXPathFreeObject(result);
-				}
-				xmlXPathFreeContext(ctx);
-			}
-			else
-				*retstring = istrdup(xmlerrors[XPATHERR_BADDOCCONTEXT]);
-		}
+		char *cDelimiter;
+		if (nargs > 2)
+			cDelimiter = args[2];
 		else
-			*retstring = istrdup(xmlerrors[XPATHERR_BADDOCPOINTER]);
+			cDelimiter = (char *)"\n";
+		char *xpaths = XML_ObjectPtr_to_Xpaths(result, cDelimiter);
+		if (NULL != xpaths)
+			*retstring = xpaths;
+		else
+			*retstring = istrdup(xmlerrors[XPATHERR_CANTRESOLVE]);
+		xmlXPathFreeObject(result);
 	}
-	else
-		*retstring = istrdup(xmlerrors[XMLERR_BADDOCID]);
+	else if (NULL != xpatherror)
+		*retstring = istrdup(xpatherror);
 }
 
 /**
@@ -2670,53 +2796,438 @@ void XML_XPathDataFromQuery(char *args[], int nargs, char **retstring, Bool *pas
 	*pass = False;
 	*error = False;
 
-	int docID = atoi(args[0]);
-	CXMLDocument *xmlDocument = doclist.find(docID);
-	if (NULL != xmlDocument)
+	const char *xpatherror;
+	xmlXPathObjectPtr result = XML_XPathEvaluate(args[0], args[1], xpatherror);
+	if (NULL != result)
+	{
+		char *charDelimiter;
+		char *lineDelimiter;
+		if (nargs > 2)
+			charDelimiter = args[2];
+		else
+			charDelimiter = (char *)"\n";
+		if (nargs > 3)
+			lineDelimiter = args[3];
+		else
+			lineDelimiter = (char *)"\n";
+		char *xpaths = XML_ObjectPtr_to_Data(result, charDelimiter, lineDelimiter);
+		if (NULL != xpaths)
+			*retstring = xpaths;
+		else
+			*retstring = istrdup(xmlerrors[XPATHERR_CANTRESOLVE]);
+		xmlXPathFreeObject(result);
+	}
+	else if (NULL != xpatherror)
+		*retstring = istrdup(xpatherror);
+}
+
+/**
+ * XML_EvalXPathIntoArray
+ * @pDocID : xml tree id
+ * @pExpression : xpath to evaluate
+ * @pArrayName : name of the variable to receive the paths
+ *
+ * Sets the named variable to a numerically keyed array of the paths which
+ * are the result of evaluating the expression against the xml tree, and
+ * returns the number of paths in the result.
+ *
+ * revXMLEvaluateXPathIntoArray tDocID, "/bookstore/books/[price<50]", "tPaths"
+ */
+void XML_EvalXPathIntoArray(char *args[], int nargs, char **retstring, Bool *pass, Bool *error)
+{
+	*pass = False;
+	*error = False;
+
+	if (3 != nargs)
+	{
+		*retstring = istrdup(xmlerrors[XMLERR_BADARGUMENTS]);
+		return;
+	}
+
+	const char *xpatherror;
+	xmlXPathObjectPtr result = XML_XPathEvaluate(args[0], args[1], xpatherror);
+	if (NULL != result)
 	{
-		xmlDocPtr xmlDoc = xmlDocument->GetDocPtr();
-		if (NULL != xmlDoc)
+		int count = XML_ObjectPtr_to_Array(result, args[2], NULL);
+		if (count >= 0)
 		{
-			xmlXPathContextPtr ctx = xmlXPathNewContext(xmlDoc);
-			if (NULL != ctx)
-			{
-				xmlChar *str = (xmlChar *)args[1];
+			*retstring = (char *)malloc(INTSTRSIZE);
+			sprintf(*retstring, "%d", count);
+		}
+		else
+			*retstring = istrdup(xmlerrors[XPATHERR_CANTRESOLVE]);
+		xmlXPathFreeObject(result);
+	}
+	else if (NULL != xpatherror)
+		*retstring = istrdup(xpatherror);
+}
+
+/**
+ * XML_XPathDataFromQueryIntoArray
+ * @pDocID : xml tree id
+ * @pExpression : xpath to evaluate
+ * @pArrayName : name of the variable to receive the data
+ * @pElementDelimiter : [optional] delimiter between data elements (default="")
+ *
+ * Sets the named variable to a numerically keyed array of the data which
+ * is the result of evaluating the expression against the xml tree, and
+ * returns the number of nodes in the result.
+ *
+ * revXMLDataFromXPathQueryIntoArray tDocID, "/bookstore/books/[price<30]title", "tTitles"
+ */
+void XML_XPathDataFromQueryIntoArray(char *args[], int nargs, char **retstring, Bool *pass, Bool *error)
+{
+	*pass = False;
+	*error = False;
+
+	if (3 != nargs && 4 != nargs)
+	{
+		*retstring = istrdup(xmlerrors[XMLERR_BADARGUMENTS]);
+		return;
+	}
+
+	const char *xpatherror;
+	xmlXPathObjectPtr result = XML_XPathEvaluate(args[0], args[1], xpatherror);
+	if (NULL != result)
+	{
+		char *charDelimiter;
+		if (nargs > 3)
+			charDelimiter = args[3];
+		else
+			charDelimiter = XMLNULLSTRING;
+		int count = XML_ObjectPtr_to_Array(result, args[2], charDelimiter);
+		if (count >= 0)
+		{
+			*retstring = (char *)malloc(INTSTRSIZE);
+			sprintf(*retstring, "%d", count);
+		}
+		else
+			*retstring = istrdup(xmlerrors[XPATHERR_CANTRESOLVE]);
+		xmlXPathFreeObject(result);
+	}
+	else if (NULL != xpatherror)
+		*retstring = istrdup(xpatherror);
+}
+
+// Streaming of large documents
+//
+// revXMLStreamFile reads a document with libxml's xmlTextReader rather than
+// building a tree for the whole document, so only the element currently
+// being matched is held in memory.
+
+struct XMLStreamBatch
+{
+	char *data;
+	int length;
+	int alloc;
+	int count;
+	vector<unsigned int> trees;
+};
+
+static void XML_StreamAppend(XMLStreamBatch &x_batch, const char *p_chars, int p_length)
+{
+	if (x_batch.length + p_length + 1 > x_batch.alloc)
+	{
+		int t_alloc = x_batch.alloc == 0 ? 4096 : x_batch.alloc;
+		while (x_batch.length + p_length + 1 > t_alloc)
+			t_alloc *= 2;
+		x_batch.data = (char *)realloc(x_batch.data, t_alloc);
+		x_batch.alloc = t_alloc;
+	}
+	memcpy(x_batch.data + x_batch.length, p_chars, p_length);
+	x_batch.length += p_length;
+	x_batch.data[x_batch.length] = '\0';
+}
 
-				xmlXPathObjectPtr result = xmlXPathEvalExpression(str, ctx);
-				if (NULL != result)
+/* Appends the serialized element p_xml to the batch as a single line. Line
+breaks in content are replaced by character references, those in CDATA
+sections are moved outside of the section and those in markup and comments
+are replaced by spaces, so that the line parses back to the same element.
+*/
+static void XML_StreamAppendLine(XMLStreamBatch &x_batch, const char *p_xml)
+{
+	enum { kContent, kTag, kCData, kComment, kProcessingInstruction } t_state = kContent;
+
+	const char *t_run = p_xml;
+	const char *t_ptr = p_xml;
+	while (*t_ptr != '\0')
+	{
+		const char *t_replacement = NULL;
+		int t_skip = 1;
+		switch (t_state)
+		{
+			case kContent:
+				if (*t_ptr == '<')
 				{
-					char *charDelimiter;
-					char *lineDelimiter;
-					if (nargs > 2)
-						charDelimiter = args[2];
-					else
-						charDelimiter = (char *)"\n";
-					if (nargs > 3)
-						lineDelimiter = args[3];
+					if (strncmp(t_ptr, "<![CDATA[", 9) == 0)
+						t_state = kCData, t_skip = 9;
+					else if (strncmp(t_ptr, "<!--", 4) == 0)
+						t_state = kComment, t_skip = 4;
+					else if (strncmp(t_ptr, "<?", 2) == 0)
+						t_state = kProcessingInstruction, t_skip = 2;
 					else
-						lineDelimiter = (char *)"\n";
-					char *xpaths = XML_ObjectPtr_to_Data(result, charDelimiter, lineDelimiter);
-					if (NULL != xpaths)
+						t_state = kTag;
+				}
+				else if (*t_ptr == '\n')
+					t_replacement = "&#10;";
+				else if (*t_ptr == '\r')
+					t_replacement = "&#13;";
+				break;
+
+			case kCData:
+				if (strncmp(t_ptr, "]]>", 3) == 0)
+					t_state = kContent, t_skip = 3;
+				else if (*t_ptr == '\n')
+					t_replacement = "]]>&#10;<![CDATA[";
+				else if (*t_ptr == '\r')
+					t_replacement = "]]>&#13;<![CDATA[";
+				break;
+
+			case kTag:
+				if (*t_ptr == '>')
+					t_state = kContent;
+				else if (*t_ptr == '\n' || *t_ptr == '\r')
+					t_replacement = " ";
+				break;
+
+			case kComment:
+				if (strncmp(t_ptr, "-->", 3) == 0)
+					t_state = kContent, t_skip = 3;
+				else if (*t_ptr == '\n' || *t_ptr == '\r')
+					t_replacement = " ";
+				break;
+
+			case kProcessingInstruction:
+				if (strncmp(t_ptr, "?>", 2) == 0)
+					t_state = kContent, t_skip = 2;
+				else if (*t_ptr == '\n' || *t_ptr == '\r')
+					t_replacement = " ";
+				break;
+		}
+
+		if (t_replacement != NULL)
+		{
+			XML_StreamAppend(x_batch, t_run, t_ptr - t_run);
+			XML_StreamAppend(x_batch, t_replacement, strlen(t_replacement));
+			t_run = t_ptr + 1;
+		}
+		t_ptr += t_skip;
+	}
+	XML_StreamAppend(x_batch, t_run, t_ptr - t_run);
+}
+
+/* Splits an element path such as "/catalog/book" into its steps. A step
+of "*" matches any element. If the path starts with "//" then the steps
+match at any depth, otherwise they must match from the root element.
+*/
+static bool XML_StreamParsePath(const char *p_path, vector<string> &r_steps, bool &r_anywhere)
+{
+	r_anywhere = strncmp(p_path, "//", 2) == 0;
+	if (r_anywhere)
+		p_path += 2;
+	else if (*p_path == '/')
+		p_path += 1;
+
+	while (*p_path != '\0')
+	{
+		const char *t_end = strchr(p_path, '/');
+		if (t_end == NULL)
+			t_end = p_path + strlen(p_path);
+		if (t_end == p_path)
+			return false;
+		r_steps.push_back(string(p_path, t_end - p_path));
+		p_path = *t_end == '/' ? t_end + 1 : t_end;
+	}
+
+	return !r_steps.empty();
+}
+
+static bool XML_StreamPathMatches(const vector<string> &p_steps, bool p_anywhere, const vector<string> &p_elements)
+{
+	if (p_elements.size() < p_steps.size() || (!p_anywhere && p_elements.size() != p_steps.size()))
+		return false;
+
+	size_t t_offset = p_elements.size() - p_steps.size();
+	for (size_t i = 0; i < p_steps.size(); i++)
+		if (p_steps[i] != "*" && p_steps[i] != p_elements[t_offset + i])
+			return false;
+
+	return true;
+}
+
+static void XML_StreamDispatch(const char *p_callback, XMLStreamBatch &x_batch)
+{
+	if (x_batch.count == 0)
+		return;
+
+	int retvalue = 0;
+	SetGlobal("xmlvariable", x_batch.data, &retvalue);
+
+	char *mcmessage = (char *)malloc(strlen(p_callback) + 192);
+	sprintf(mcmessage,"global xmlvariable;try;send \"%s xmlvariable,%d\" to current card of stack the topstack;catch errno;end try;put 0 into xmlvariable",
+		p_callback, x_batch.count);
+	SendCardMessage(mcmessage, &retvalue);
+	free(mcmessage);
+
+	// The trees of a batch only live for the duration of its callback.
+	for (size_t i = 0; i < x_batch.trees.size(); i++)
+		doclist.erase(x_batch.trees[i]);
+	x_batch.trees.clear();
+
+	x_batch.length = 0;
+	if (x_batch.data != NULL)
+		x_batch.data[0] = '\0';
+	x_batch.count = 0;
+}
+
+/*
+Function: XML_StreamFile - stream the elements of an xml file matching a path to a callback
+Input: [0]=file path
+[1]=element path (ie. /catalog/book or //book, where a step of * matches any element)
+[2]=name of the message to send for each batch of matching elements
+[3]=(optional) number of elements in each batch (default 100)
+[4]=(optional) "text" to send each element as a line of xml (default), or
+"tree" to send each element as a temporary xml tree
+Output: number of matching elements or error string
+Example: revXMLStreamFile "feed.xml", "//entry", "processEntries", 500, "tree"
+The callback is sent with the return delimited list of elements (or tree ids)
+and the number of elements in the batch. Trees are deleted after the callback
+returns.
+*/
+void XML_StreamFile(char *args[], int nargs, char **retstring, Bool *pass, Bool *error)
+{
+	*pass = False;
+	*error = False;
+
+	if (nargs < 3 || nargs > 5)
+	{
+		*error = True;
+		*retstring = istrdup(xmlerrors[XMLERR_BADARGUMENTS]);
+		return;
+	}
+
+	if (!SecurityCanAccessFile(args[0]))
+	{
+		*error = True;
+		*retstring = istrdup(xmlerrors[XMLERR_NOFILEPERMS]);
+		return;
+	}
+
+	vector<string> t_steps;
+	bool t_anywhere;
+	if (!XML_StreamParsePath(args[1], t_steps, t_anywhere))
+	{
+		*retstring = istrdup(xmlerrors[XMLERR_BADELEMENT]);
+		return;
+	}
+
+	int t_batch_size = 100;
+	if (nargs >= 4 && *args[3] != '\0')
+		t_batch_size = atoi(args[3]);
+	if (t_batch_size < 1)
+		t_batch_size = 1;
+
+	bool t_as_trees = nargs >= 5 && util_strnicmp(args[4], "tree", 4) == 0;
+
+	char *t_resolved_path;
+	t_resolved_path = os_path_resolve(args[0]);
+	char *t_native_path;
+	t_native_path = os_path_to_native(t_resolved_path);
+
+	xmlTextReaderPtr t_reader = xmlReaderForFile(t_native_path, NULL, XML_PARSE_HUGE);
+
+	free(t_native_path);
+	free(t_resolved_path);
+
+	if (t_reader == NULL)
+	{
+		*retstring = istrdup(xmlerrors[XMLERR_BADXML]);
+		return;
+	}
+
+	XMLStreamBatch t_batch;
+	t_batch.data = NULL;
+	t_batch.length = 0;
+	t_batch.alloc = 0;
+	t_batch.count = 0;
+
+	vector<string> t_elements;
+	int t_match_count = 0;
+
+	int t_status = xmlTextReaderRead(t_reader);
+	while (t_status == 1)
+	{
+		int t_type = xmlTextReaderNodeType(t_reader);
+		if (t_type == XML_READER_TYPE_ELEMENT)
+		{
+			bool t_is_empty = xmlTextReaderIsEmptyElement(t_reader) == 1;
+			t_elements.push_back((const char *)xmlTextReaderConstName(t_reader));
+
+			if (XML_StreamPathMatches(t_steps, t_anywhere, t_elements))
+			{
+				if (t_batch.count != 0)
+					XML_StreamAppend(t_batch, "\n", 1);
+
+				if (t_as_trees)
+				{
+					xmlNodePtr t_node = xmlTextReaderExpand(t_reader);
+					CXMLDocument *newdoc = new (nothrow) CXMLDocument;
+					if (t_node != NULL && newdoc != NULL && newdoc->CopyNode(t_node))
 					{
-						*retstring = istrdup(xpaths);
-						free(xpaths);
+						doclist.add(newdoc);
+						t_batch.trees.push_back(newdoc->GetID());
+
+						char t_id[INTSTRSIZE];
+						sprintf(t_id, "%u", newdoc->GetID());
+						XML_StreamAppend(t_batch, t_id, strlen(t_id));
 					}
 					else
+						delete newdoc;
+				}
+				else
+				{
+					xmlChar *t_xml = xmlTextReaderReadOuterXml(t_reader);
+					if (t_xml != NULL)
 					{
-						*retstring = istrdup(xmlerrors[XPATHERR_CANTRESOLVE]);
+						XML_StreamAppendLine(t_batch, (const char *)t_xml);
+						xmlFree(t_xml);
 					}
-					xmlXPathFreeObject(result);
 				}
-				xmlXPathFreeContext(ctx);
+
+				t_match_count += 1;
+				t_batch.count += 1;
+				if (t_batch.count == t_batch_size)
+					XML_StreamDispatch(args[2], t_batch);
+
+				// Skip over the matched element's subtree, allowing the reader to
+				// release it.
+				t_elements.pop_back();
+				t_status = xmlTextReaderNext(t_reader);
+				continue;
 			}
-			else
-				*retstring = istrdup(xmlerrors[XPATHERR_BADDOCCONTEXT]);
+
+			if (t_is_empty)
+				t_elements.pop_back();
 		}
-		else
-			*retstring = istrdup(xmlerrors[XPATHERR_BADDOCPOINTER]);
+		else if (t_type == XML_READER_TYPE_END_ELEMENT)
+			t_elements.pop_back();
+
+		t_status = xmlTextReaderRead(t_reader);
 	}
-	else
-		*retstring = istrdup(xmlerrors[XMLERR_BADDOCID]);
+
+	XML_StreamDispatch(args[2], t_batch);
+	free(t_batch.data);
+
+	xmlFreeTextReader(t_reader);
+
+	if (t_status < 0)
+	{
+		*retstring = istrdup(xmlerrors[XMLERR_BADXML]);
+		return;
+	}
+
+	*retstring = (char *)malloc(INTSTRSIZE);
+	sprintf(*retstring, "%d", t_match_count);
 }
 
 // MDW-2013-08-09: [[ RevXmlXslt ]]
@@ -3097,6 +3608,10 @@ EXTERNAL_BEGIN_DECLARATIONS("revXML")
 // MDW-2013-06-22: [[ RevXmlXPath ]]
 	EXTERNAL_DECLARE_FUNCTION("revXMLEvaluateXPath", XML_EvalXPath)
 	EXTERNAL_DECLARE_FUNCTION("revXMLDataFromXPathQuery", XML_XPathDataFromQuery)
+	EXTERNAL_DECLARE_COMMAND("revXMLEvaluateXPathIntoArray", XML_EvalXPathIntoArray)
+	EXTERNAL_DECLARE_COMMAND("revXMLDataFromXPathQueryIntoArray", XML_XPathDataFromQueryIntoArray)
+
+	EXTERNAL_DECLARE_COMMAND("revXMLStreamFile", XML_StreamFile)
 
 // MDW-2013-08-09: [[ RevXmlXslt ]]
 	EXTERNAL_DECLARE_FUNCTION("xsltApplyStylesheet", XML_xsltApplyStylesheet)
@@ -230,6 +230,20 @@ void CXMLDocument::New()
 	doc = xmlNewDoc((xmlChar *) "1.0");
 }
 
+/*CopyNode - creates a new document whose root element is a copy of tnode
+and its subtree
+returns false on error
+*/
+Bool CXMLDocument::CopyNode(xmlNodePtr tnode)
+{
+	New();
+	xmlNodePtr t_copy = xmlDocCopyNode(tnode, doc, 1);
+	if (t_copy == NULL)
+		return False;
+	xmlDocSetRootElement(doc, t_copy);
+	return True;
+}
+
 /*Read - parse xml data and create xml tree
 data - points to xml data to parse
 tlength - length of xml data to parse
@@ -358,18 +372,42 @@ void CXMLDocument::Write(char **data,int *tlength,Bool isformatted)
 /*Free - frees xml document*/
 void CXMLDocument::Free()
 {
-	if (!isinited()) return;
-	xmlFreeDoc(doc);
-	doc = NULL;
+	// The XPath context is released regardless of whether there is a document
+	// as it is only valid for the document it was created for.
 	if (NULL != xpathContext)
 		xmlXPathFreeContext(xpathContext);
 	xpathContext = NULL;
+	if (!isinited()) return;
+	xmlFreeDoc(doc);
+	doc = NULL;
 	// MDW-2013-09-04: [[ RevXmlXslt ]]
 	if (NULL != xsltID)
 		xsltFreeStylesheet(xsltID);
 	xsltID = NULL;
 }
 
+/*GetXPathContext - returns the XPath evaluation context for the document,
+creating it on first use so that it is reused by subsequent evaluations.
+returns NULL if there is no document
+*/
+xmlXPathContextPtr CXMLDocument::GetXPathContext()
+{
+	if (!isinited()) return NULL;
+
+	// The document may have been replaced (e.g. by CopyDocument) since the
+	// context was created, in which case it must be recreated.
+	if (NULL != xpathContext && xpathContext->doc != doc)
+	{
+		xmlXPathFreeContext(xpathContext);
+		xpathContext = NULL;
+	}
+
+	if (NULL == xpathContext)
+		xpathContext = xmlXPathNewContext(doc);
+
+	return xpathContext;
+}
+
 /*CopyDocument - copies xml tree of other CXMLDocument
 truecopy - if true this is set to point to xmltree of tdocument, 
 otherwise this is set to point to a copy of xmltree in tdocument
@@ -50,6 +50,15 @@
 						],
 					},
 				],
+				[
+					'OS == "linux"',
+					{
+						'libraries':
+						[
+							'-lpthread',
+						],
+					},
+				],
 				[
 					'OS == "android"',
 					{
@@ -110,6 +119,7 @@
 							'-Wl,-Bstatic',
 							'-lstdc++',
 							'-Wl,-Bdynamic',
+							'-lpthread',
 						],
 					},
 				],
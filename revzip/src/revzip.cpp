@@ -21,11 +21,20 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #include <sstream>
 #include <cstring>
 #include <cstdlib>
+#include <cstdio>
+#include <ctime>
+#include <new>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include <fcntl.h>
 #include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 
 #include <zip.h>
+#include <zlib.h>
 
 #include <revolution/external.h>
 #include <revolution/support.h>
@@ -36,7 +45,11 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 #endif
 
 #ifdef _WINDOWS
+#include <windows.h>
+#include <process.h>
 #define stricmp _stricmp
+#else
+#include <pthread.h>
 #endif
 
 #ifdef _LINUX
@@ -51,6 +64,10 @@ along with LiveCode.  If not see <http://www.gnu.org/licenses/>.  */
 
 #define REVZIP_READ_BUFFER_SIZE 8192
 
+// Items are extracted to variables in chunks of this size, so that the
+// operation can still be cancelled between chunks.
+#define REVZIP_EXTRACT_CHUNK_SIZE (1024 * 1024)
+
 typedef std::map<std::string, struct zip *> zipmap_t;
 typedef zipmap_t::iterator zipmap_iterator_t;
 typedef zipmap_t::const_iterator zipmap_const_iterator_t;
@@ -99,6 +116,386 @@ void* imemdup(const void *p_sptr, size_t p_size)
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+//
+// Parallel compression
+//
+// When more than one compression thread has been requested with
+// revZipSetCompressionThreads, items added with revZipAddItemWithData and
+// revZipAddItemWithFile are deflated by worker threads as soon as they are
+// added. Each such item is given to libzip as a source which reports itself
+// as already deflated, so zip_close just copies the compressed data of each
+// item into the archive, in order, waiting for any item which is still
+// being compressed.
+
+struct DeflateJob
+{
+	// The input - either a buffer of data or the path of a file to read.
+	unsigned char *data;
+	size_t size;
+	char *filename;
+
+	// The output, valid once done is set.
+	unsigned char *compressed;
+	size_t compressed_size;
+	uLong crc;
+	time_t mtime;
+	int error;
+	bool done;
+
+	// The position of the next read from the compressed data.
+	size_t read_offset;
+};
+
+// A worker thread, which deflates jobs until the queue is empty. Finished
+// workers are joined before their slot is reused, and all the workers are
+// joined once an archive has been written.
+struct DeflateWorker
+{
+#ifdef _WINDOWS
+	HANDLE thread;
+#else
+	pthread_t thread;
+#endif
+	bool running;
+	bool joinable;
+};
+
+static std::mutex s_deflate_mutex;
+static std::condition_variable s_deflate_condition;
+static std::list<DeflateJob *> s_deflate_queue;
+static std::list<DeflateWorker> s_deflate_workers;
+static uint32_t s_deflate_thread_limit = 1;
+static uint32_t s_deflate_thread_count = 0;
+
+static FILE *revZipOpenFile(const char *p_path)
+{
+#ifdef _WINDOWS
+	// The path is UTF-8 encoded, so convert to UTF-16 for the wide file API.
+	int t_length = MultiByteToWideChar(CP_UTF8, 0, p_path, -1, NULL, 0);
+	if (t_length == 0)
+		return NULL;
+	wchar_t *t_wide_path = (wchar_t *)malloc(t_length * sizeof(wchar_t));
+	MultiByteToWideChar(CP_UTF8, 0, p_path, -1, t_wide_path, t_length);
+	FILE *t_file = _wfopen(t_wide_path, L"rb");
+	free(t_wide_path);
+	return t_file;
+#else
+	return fopen(p_path, "rb");
+#endif
+}
+
+static bool revZipReadFile(const char *p_path, unsigned char *&r_data, size_t &r_size, time_t &r_mtime)
+{
+	FILE *t_file = revZipOpenFile(p_path);
+	if (t_file == NULL)
+		return false;
+
+	struct stat t_stat;
+	bool t_success = fstat(fileno(t_file), &t_stat) == 0;
+
+	unsigned char *t_data = NULL;
+	if (t_success)
+	{
+		t_data = (unsigned char *)malloc(t_stat . st_size > 0 ? t_stat . st_size : 1);
+		t_success = t_data != NULL;
+	}
+
+	if (t_success && t_stat . st_size > 0)
+		t_success = fread(t_data, 1, t_stat . st_size, t_file) == (size_t)t_stat . st_size;
+
+	fclose(t_file);
+
+	if (!t_success)
+	{
+		free(t_data);
+		return false;
+	}
+
+	r_data = t_data;
+	r_size = t_stat . st_size;
+	r_mtime = t_stat . st_mtime;
+	return true;
+}
+
+// Deflate the job's input into a raw deflate stream, as stored in a zip archive,
+// using the same settings as libzip.
+static void revZipDeflateJob(DeflateJob *p_job)
+{
+	if (p_job -> filename != NULL &&
+		!revZipReadFile(p_job -> filename, p_job -> data, p_job -> size, p_job -> mtime))
+	{
+		p_job -> error = ZIP_ER_READ;
+		return;
+	}
+
+	p_job -> crc = crc32(crc32(0, Z_NULL, 0), p_job -> data, p_job -> size);
+
+	z_stream t_stream;
+	memset(&t_stream, 0, sizeof(z_stream));
+	if (deflateInit2(&t_stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK)
+	{
+		p_job -> error = ZIP_ER_ZLIB;
+		return;
+	}
+
+	size_t t_bound = deflateBound(&t_stream, p_job -> size);
+	p_job -> compressed = (unsigned char *)malloc(t_bound);
+	if (p_job -> compressed == NULL)
+	{
+		deflateEnd(&t_stream);
+		p_job -> error = ZIP_ER_MEMORY;
+		return;
+	}
+
+	t_stream . next_in = p_job -> data;
+	t_stream . avail_in = p_job -> size;
+	t_stream . next_out = p_job -> compressed;
+	t_stream . avail_out = t_bound;
+	if (deflate(&t_stream, Z_FINISH) != Z_STREAM_END)
+		p_job -> error = ZIP_ER_ZLIB;
+	p_job -> compressed_size = t_stream . total_out;
+	deflateEnd(&t_stream);
+
+	// The input is no longer needed, only the compressed data is kept until
+	// the archive is written.
+	free(p_job -> data);
+	p_job -> data = NULL;
+}
+
+static void revZipDeflateWorker(DeflateWorker *p_worker)
+{
+	std::unique_lock<std::mutex> t_lock(s_deflate_mutex);
+	while (!s_deflate_queue . empty())
+	{
+		DeflateJob *t_job = s_deflate_queue . front();
+		s_deflate_queue . pop_front();
+
+		t_lock . unlock();
+		revZipDeflateJob(t_job);
+		t_lock . lock();
+
+		t_job -> done = true;
+		s_deflate_condition . notify_all();
+	}
+
+	// Workers only live while there is work to do.
+	s_deflate_thread_count -= 1;
+	p_worker -> running = false;
+}
+
+#ifdef _WINDOWS
+static unsigned int __stdcall revZipDeflateWorkerThread(void *p_context)
+{
+	revZipDeflateWorker((DeflateWorker *)p_context);
+	return 0;
+}
+#else
+static void *revZipDeflateWorkerThread(void *p_context)
+{
+	revZipDeflateWorker((DeflateWorker *)p_context);
+	return NULL;
+}
+#endif
+
+static void revZipDeflateWorkerJoin(DeflateWorker &p_worker)
+{
+	if (!p_worker . joinable)
+		return;
+
+#ifdef _WINDOWS
+	WaitForSingleObject(p_worker . thread, INFINITE);
+	CloseHandle(p_worker . thread);
+#else
+	pthread_join(p_worker . thread, NULL);
+#endif
+	p_worker . joinable = false;
+}
+
+// Starts a worker thread in a free slot, which is called with the deflate
+// mutex held. Returns false if the thread could not be created.
+static bool revZipDeflateWorkerStart(void)
+{
+	DeflateWorker *t_worker = NULL;
+	for (std::list<DeflateWorker>::iterator t_iter = s_deflate_workers . begin(); t_iter != s_deflate_workers . end(); ++t_iter)
+		if (!t_iter -> running)
+		{
+			t_worker = &(*t_iter);
+			break;
+		}
+
+	if (t_worker == NULL)
+	{
+		DeflateWorker t_new_worker;
+		memset(&t_new_worker, 0, sizeof(DeflateWorker));
+		s_deflate_workers . push_back(t_new_worker);
+		t_worker = &s_deflate_workers . back();
+	}
+
+	// A worker which is no longer running has released the mutex for the last
+	// time, so it can be joined while the mutex is held.
+	revZipDeflateWorkerJoin(*t_worker);
+
+	t_worker -> running = true;
+#ifdef _WINDOWS
+	t_worker -> thread = (HANDLE)_beginthreadex(NULL, 0, revZipDeflateWorkerThread, t_worker, 0, NULL);
+	t_worker -> joinable = t_worker -> thread != NULL;
+#else
+	t_worker -> joinable = pthread_create(&t_worker -> thread, NULL, revZipDeflateWorkerThread, t_worker) == 0;
+#endif
+	t_worker -> running = t_worker -> joinable;
+
+	return t_worker -> joinable;
+}
+
+// Waits for all the workers to finish the queue and exit.
+static void revZipDeflateWorkersJoin(void)
+{
+	std::list<DeflateWorker> t_workers;
+	{
+		std::lock_guard<std::mutex> t_lock(s_deflate_mutex);
+		t_workers . splice(t_workers . end(), s_deflate_workers);
+	}
+
+	for (std::list<DeflateWorker>::iterator t_iter = t_workers . begin(); t_iter != t_workers . end(); ++t_iter)
+		revZipDeflateWorkerJoin(*t_iter);
+}
+
+static void revZipDeflateJobPush(DeflateJob *p_job)
+{
+	std::lock_guard<std::mutex> t_lock(s_deflate_mutex);
+	s_deflate_queue . push_back(p_job);
+
+	if (s_deflate_thread_count < s_deflate_thread_limit && revZipDeflateWorkerStart())
+		s_deflate_thread_count += 1;
+
+	// If no worker could be started, compress on this thread.
+	if (s_deflate_thread_count == 0)
+	{
+		s_deflate_queue . pop_back();
+		revZipDeflateJob(p_job);
+		p_job -> done = true;
+	}
+}
+
+static void revZipDeflateJobWait(DeflateJob *p_job)
+{
+	std::unique_lock<std::mutex> t_lock(s_deflate_mutex);
+	while (!p_job -> done)
+		s_deflate_condition . wait(t_lock);
+}
+
+static void revZipDeflateJobFree(DeflateJob *p_job)
+{
+	revZipDeflateJobWait(p_job);
+	free(p_job -> data);
+	free(p_job -> filename);
+	free(p_job -> compressed);
+	delete p_job;
+}
+
+static ssize_t revZipDeflateSourceCallback(void *p_state, void *p_data, size_t p_length, enum zip_source_cmd p_cmd)
+{
+	DeflateJob *t_job = (DeflateJob *)p_state;
+
+	switch (p_cmd)
+	{
+		case ZIP_SOURCE_OPEN:
+			revZipDeflateJobWait(t_job);
+			if (t_job -> error != 0)
+				return -1;
+			t_job -> read_offset = 0;
+			return 0;
+
+		case ZIP_SOURCE_READ:
+		{
+			size_t t_available = t_job -> compressed_size - t_job -> read_offset;
+			if (p_length > t_available)
+				p_length = t_available;
+			memcpy(p_data, t_job -> compressed + t_job -> read_offset, p_length);
+			t_job -> read_offset += p_length;
+			return p_length;
+		}
+
+		case ZIP_SOURCE_CLOSE:
+			return 0;
+
+		case ZIP_SOURCE_STAT:
+		{
+			if (p_length < sizeof(struct zip_stat))
+				return -1;
+
+			revZipDeflateJobWait(t_job);
+			if (t_job -> error != 0)
+				return -1;
+
+			// Reporting a compression method other than 'store' causes libzip
+			// to copy the data as is, rather than compressing it again.
+			struct zip_stat *t_stat = (struct zip_stat *)p_data;
+			zip_stat_init(t_stat);
+			t_stat -> mtime = t_job -> mtime;
+			t_stat -> crc = t_job -> crc;
+			t_stat -> size = t_job -> size;
+			t_stat -> comp_size = t_job -> compressed_size;
+			t_stat -> comp_method = ZIP_CM_DEFLATE;
+			return sizeof(struct zip_stat);
+		}
+
+		case ZIP_SOURCE_ERROR:
+		{
+			if (p_length < sizeof(int) * 2)
+				return -1;
+			int *t_error = (int *)p_data;
+			t_error[0] = t_job -> error;
+			t_error[1] = 0;
+			return sizeof(int) * 2;
+		}
+
+		case ZIP_SOURCE_FREE:
+			revZipDeflateJobFree(t_job);
+			return 0;
+
+		default:
+			return -1;
+	}
+}
+
+// Creates a source which deflates the given data (taking ownership of it), or
+// the contents of the given file, on a worker thread.
+static struct zip_source *revZipDeflateSourceCreate(struct zip *p_archive, char *p_data, size_t p_size, const char *p_filename)
+{
+	DeflateJob *t_job = new (std::nothrow) DeflateJob;
+	if (t_job == NULL)
+		return NULL;
+
+	memset(t_job, 0, sizeof(DeflateJob));
+	t_job -> data = (unsigned char *)p_data;
+	t_job -> size = p_size;
+	t_job -> filename = p_filename != NULL ? strdup(p_filename) : NULL;
+	t_job -> mtime = time(NULL);
+
+	struct zip_source *t_source = zip_source_function(p_archive, revZipDeflateSourceCallback, t_job);
+	if (t_source == NULL)
+	{
+		t_job -> data = NULL;
+		free(t_job -> filename);
+		delete t_job;
+		return NULL;
+	}
+
+	revZipDeflateJobPush(t_job);
+	return t_source;
+}
+
+static bool revZipParallelCompressionEnabled(void)
+{
+	std::lock_guard<std::mutex> t_lock(s_deflate_mutex);
+	return s_deflate_thread_limit > 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+
 int zip_progress_callback(void *p_context, struct zip *p_archive, const char *p_item, 
 						   int p_type, unsigned long p_item_progress, unsigned long p_item_total, 
 						   unsigned long p_global_progress, unsigned long p_global_total)
@@ -256,6 +653,10 @@ void revZipCloseArchive(char *p_arguments[], int p_argument_count, char **r_resu
 		s_operation_cancelled = false;
 		t_err = zip_close(t_archive);
 		s_operation_in_progress = false;
+
+		// Any items added with parallel compression have been written by now,
+		// so the worker threads can be joined.
+		revZipDeflateWorkersJoin();
 		
 		if (s_operation_cancelled)
 		{
@@ -374,7 +775,19 @@ static void revZipAddItemWithDataAndCompression(char *p_arguments[], int p_argum
 		{
 			char* t_data = NULL;
 			t_data = (char*) imemdup(mcData.buffer, mcData.length);
-			if (((t_source = zip_source_buffer(t_archive, t_data, mcData.length, 1)) == NULL) ||
+
+			// Compressed items are deflated on a worker thread if parallel
+			// compression is enabled.
+			if (p_compressed && revZipParallelCompressionEnabled())
+			{
+				t_source = revZipDeflateSourceCreate(t_archive, t_data, mcData.length, NULL);
+				if (t_source == NULL)
+					free(t_data);
+			}
+			else
+				t_source = zip_source_buffer(t_archive, t_data, mcData.length, 1);
+
+			if ((t_source == NULL) ||
 				 (zip_add(t_archive, p_arguments[1], t_source) < 0))
 			{
 				zip_source_free(t_source);
@@ -452,7 +865,14 @@ static void revZipAddItemWithFileAndCompression(char *p_arguments[], int p_argum
 	t_source = NULL;
 	if (t_result == NULL)
 	{
-		if (((t_source = zip_source_filename(t_archive, t_filepath, 0, 0)) == NULL) ||
+		// Compressed items are read and deflated on a worker thread if parallel
+		// compression is enabled.
+		if (p_compressed && revZipParallelCompressionEnabled())
+			t_source = revZipDeflateSourceCreate(t_archive, NULL, 0, t_filepath);
+		else
+			t_source = zip_source_filename(t_archive, t_filepath, 0, 0);
+
+		if ((t_source == NULL) ||
 			 (zip_add(t_archive, p_arguments[1], t_source) < 0))
 		{
 			zip_source_free(t_source);
@@ -550,7 +970,9 @@ void revZipExtractItemToVariable(char *p_arguments[], int p_argument_count, char
 	char *t_data = NULL;
 	if (t_result == NULL)
 	{
-		t_data = (char *)malloc(t_stat . size);
+		// The item is decompressed directly into a buffer of its final size.
+		// Empty items still need a (non-NULL) buffer.
+		t_data = (char *)malloc(t_stat . size > 0 ? t_stat . size : 1);
 		if (t_data == NULL)
 		{
 			t_result = strdup("ziperr,out of memory");
@@ -578,16 +1000,20 @@ void revZipExtractItemToVariable(char *p_arguments[], int p_argument_count, char
 		
 		s_operation_in_progress = true;
 		s_operation_cancelled = false;
-		do
+		while(t_read != t_stat . size && !s_operation_cancelled)
 		{
+			size_t t_chunk;
+			t_chunk = t_stat . size - t_read;
+			if (t_chunk > REVZIP_EXTRACT_CHUNK_SIZE)
+				t_chunk = REVZIP_EXTRACT_CHUNK_SIZE;
+
 			ssize_t t_bytes_read;
-			t_bytes_read = zip_fread(t_file, t_data + t_read, REVZIP_READ_BUFFER_SIZE);
+			t_bytes_read = zip_fread(t_file, t_data + t_read, t_chunk);
 			if (t_bytes_read <= 0)
 				break;
 
 			t_read += t_bytes_read;
 		}
-		while(t_read != t_stat . size && !s_operation_cancelled);
 		s_operation_in_progress = false;
 
 		if (s_operation_cancelled)
@@ -1464,6 +1890,49 @@ void revZipSetProgressCallback(char *p_arguments[], int p_argument_count, char *
 	*r_result = t_result;
 }
 
+void revZipSetCompressionThreads(char *p_arguments[], int p_argument_count, char **r_result, Bool *r_pass, Bool *r_err)
+{
+	char *t_result = NULL;
+	Bool t_error = False;
+
+	if (p_argument_count != 1)
+	{
+		t_result = strdup("ziperr,illegal arguments");
+		t_error = True;
+	}
+
+	int t_count = 0;
+	if (t_result == NULL)
+	{
+		char *t_end;
+		t_count = strtol(p_arguments[0], &t_end, 10);
+		if (t_end == p_arguments[0] || *t_end != '\0' || t_count < 0)
+		{
+			t_result = strdup("ziperr,illegal thread count");
+			t_error = True;
+		}
+	}
+
+	if (t_result == NULL)
+	{
+		// A count of 0 means use one thread per processor.
+		if (t_count == 0)
+			t_count = std::thread::hardware_concurrency();
+		if (t_count < 1)
+			t_count = 1;
+
+		std::lock_guard<std::mutex> t_lock(s_deflate_mutex);
+		s_deflate_thread_limit = t_count;
+	}
+
+	if (t_result == NULL)
+		t_result = strdup("");
+
+	*r_pass = False;
+	*r_err = t_error;
+	*r_result = t_result;
+}
+
 void revZipCancel(char *p_arguments[], int p_argument_count, char **r_result, Bool *r_pass, Bool *r_err)
 {
 	char *t_result = NULL;
@@ -1511,6 +1980,7 @@ EXTERNAL_BEGIN_DECLARATIONS("revZip")
 	EXTERNAL_DECLARE_FUNCTION_UTF8("revZipDescribeItem", revZipDescribeItem)
 	EXTERNAL_DECLARE_COMMAND_UTF8("revZipSetProgressCallback", revZipSetProgressCallback)
 	EXTERNAL_DECLARE_COMMAND("revZipCancel", revZipCancel)
+	EXTERNAL_DECLARE_COMMAND("revZipSetCompressionThreads", revZipSetCompressionThreads)
 EXTERNAL_END_DECLARATIONS
 
 #ifdef _WINDOWS